@@ -0,0 +1,54 @@
+#include "allocation_counter.hh"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> _Allocations{ 0 };
+
+/**********************************************************************/
+size_t allocationCount() noexcept
+{
+	return _Allocations.load(std::memory_order_relaxed);
+}
+
+/**********************************************************************/
+void* operator new(std::size_t size)
+{
+	_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (auto ptr = std::malloc(size == 0 ? 1 : size))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+/**********************************************************************/
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+/**********************************************************************/
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+/**********************************************************************/
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+/**********************************************************************/
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+/**********************************************************************/
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
@@ -0,0 +1,12 @@
+#ifndef __YAGI_BENCH_ALLOCATION_COUNTER__
+#define __YAGI_BENCH_ALLOCATION_COUNTER__
+
+#include <cstddef>
+
+/*!
+ * \brief	Number of heap allocations made by the process
+ *			Counted by the global operator new of the benchmark
+ */
+size_t allocationCount() noexcept;
+
+#endif
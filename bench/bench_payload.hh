@@ -0,0 +1,182 @@
+#ifndef __YAGI_BENCH_PAYLOAD__
+#define __YAGI_BENCH_PAYLOAD__
+
+#include "yagiarchitecture.hh"
+#include "mock_logger_test.h"
+#include "mock_symbol_test.h"
+#include "mock_type_test.h"
+#include "mock_loader_test.h"
+#include "ghidra.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#define BENCH_FUNC_ADDR 0x401000
+#define BENCH_FUNC_NAME "bench"
+
+/*!
+ * \brief	Root of Ghidra processors, same layout as unit tests
+ */
+static inline std::string benchGhidraDirectory()
+{
+	auto env = std::getenv("GHIDRADIRTEST");
+	return env != nullptr ? env : YAGI_BENCH_GHIDRA_DIR;
+}
+
+/*!
+ * \brief	Generate a x86 32 bits function made of a chain of blocks
+ *			Each block test and update the first stack parameter
+ *			so every block merge a new varnode into the parameter
+ *
+ *			cmp dword ptr [esp+4], i
+ *			jne next
+ *			add dword ptr [esp+4], i
+ *		next:
+ *			...
+ *			mov eax, dword ptr [esp+4]
+ *			ret
+ *
+ * \param	blocks	number of blocks
+ */
+static inline std::vector<uint8_t> buildBranchPayload(size_t blocks)
+{
+	std::vector<uint8_t> payload;
+	for (size_t i = 0; i < blocks; i++)
+	{
+		auto imm = static_cast<uint8_t>(i & 0x7f);
+		payload.insert(payload.end(), { 0x83, 0x7C, 0x24, 0x04, imm });
+		payload.insert(payload.end(), { 0x75, 0x05 });
+		payload.insert(payload.end(), { 0x83, 0x44, 0x24, 0x04, imm });
+	}
+	payload.insert(payload.end(), { 0x8B, 0x44, 0x24, 0x04, 0xC3 });
+	return payload;
+}
+
+/*!
+ * \brief	A function to decompile and the processor it runs on
+ */
+struct BenchPayload
+{
+	const char* name;
+	const char* sleighId;
+	const char* callingConvention;
+	uint64_t address;
+	std::vector<uint8_t> bytes;
+};
+
+/*!
+ * \brief	Sample payloads of the unit tests
+ *			Mapped at the same address as the tests
+ */
+static inline const std::vector<BenchPayload>& benchSamples()
+{
+	static const std::vector<BenchPayload> samples = {
+		{
+			"x86_32", "x86:LE:32:default:windows", "__stdcall", 0xaaaaaaaa,
+			{
+				0x53, 0x6A, 0x09, 0x8B, 0xD9, 0xE8, 0x3E, 0x58,
+				0x03, 0x00, 0x83, 0xC4, 0x04, 0x85, 0xC0, 0x74,
+				0x14, 0xC7, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC7,
+				0x40, 0x04, 0x01, 0x00, 0x00, 0x00, 0x83, 0xC0,
+				0x08, 0x88, 0x18, 0x5B, 0xC3, 0x33, 0xC0, 0x5B,
+				0xC3, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC
+			}
+		},
+		{
+			"x86_64", "x86:LE:64:default:windows", "__fastcall", 0xaaaaaaaa,
+			{
+				0x48, 0x89, 0x54, 0x24, 0x10, 0x48, 0x89, 0x4C,
+				0x24, 0x08, 0x57, 0x48, 0x8B, 0x44, 0x24, 0x18,
+				0xC7, 0x40, 0x04, 0x00, 0x00, 0x00, 0x00, 0x33,
+				0xC0, 0x5F, 0xC3, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC
+			}
+		},
+		{
+			"ARM_32", "ARM:LE:32:v7", "__stdcall", 0xaaaaaaaa,
+			{
+				0x10, 0x30, 0x9F, 0xE5, 0x00, 0x20, 0xD3, 0xE5,
+				0x00, 0x00, 0x52, 0xE3, 0x01, 0x20, 0xA0, 0x03,
+				0x00, 0x20, 0xC3, 0x05, 0x1E, 0xFF, 0x2F, 0xE1,
+				0x7C, 0x08, 0x01, 0x00, 0x24, 0x00, 0x9F, 0xE5
+			}
+		},
+		{
+			"MIPS_32", "MIPS:BE:32:default", "__stdcall", 0xaaaaaaaa,
+			{
+				0x3C, 0x1C, 0x00, 0x03, 0x27, 0x9C, 0x55, 0x68, 0x03, 0x99, 0xE0, 0x21, 0x27, 0xBD, 0xFF, 0xE0, 0x8F, 0x99, 0x81, 0x0C, 0xAF, 0xB0, 0x00, 0x18,
+				0x00, 0x80, 0x80, 0x25, 0x24, 0x04, 0x00, 0x04, 0xAF, 0xBC, 0x00, 0x10, 0xAF, 0xBF, 0x00, 0x1C,
+				0x04, 0x11, 0xD4, 0xEF, 0x02, 0x00, 0x28, 0x25, 0x1A, 0x00, 0x00, 0x09, 0x8F, 0xBF, 0x00, 0x1C,
+				0x00, 0x10, 0x20, 0x80, 0x24, 0x05, 0xFF, 0xFF, 0x00, 0x82, 0x20, 0x21, 0x00, 0x40, 0x18, 0x25,
+				0xAC, 0x65, 0x00, 0x00, 0x24, 0x63, 0x00, 0x04, 0x14, 0x64, 0xFF, 0xFD, 0x8F, 0xBF, 0x00, 0x1C,
+				0x8F, 0xB0, 0x00, 0x18, 0x03, 0xE0, 0x00, 0x08, 0x27, 0xBD, 0x00, 0x20, 0x3C, 0x1C, 0x00, 0x03
+			}
+		}
+	};
+	return samples;
+}
+
+/*!
+ * \brief	Build the architecture of a payload without initializing it
+ *	\param	payload	function to map, must outlive the architecture
+ */
+static inline std::unique_ptr<yagi::YagiArchitecture> buildBenchArchitecture(const BenchPayload& payload)
+{
+	auto address = payload.address;
+	auto size = payload.bytes.size();
+	return std::make_unique<yagi::YagiArchitecture>(
+		"bench",
+		payload.sleighId,
+		std::make_unique<MockLoaderFactory>([&payload](uint1* ptr, int4 size, const Address& addr) {
+			std::memset(ptr, 0, size);
+			auto offset = addr.getOffset() - payload.address;
+			if (addr.getOffset() >= payload.address && offset < payload.bytes.size())
+			{
+				std::memcpy(ptr, payload.bytes.data() + offset, std::min<size_t>(size, payload.bytes.size() - offset));
+			}
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([address, size](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == address)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					address, BENCH_FUNC_NAME, size, true, false, false, false
+				);
+			}
+			return std::nullopt;
+		},
+		[address, size](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					address, BENCH_FUNC_NAME, size, true, false, false, false
+				)
+			);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		payload.callingConvention
+	);
+}
+
+/*!
+ * \brief	Build an initialized architecture for a payload
+ *	\param	payload	function to map, must outlive the architecture
+ */
+static inline std::unique_ptr<yagi::YagiArchitecture> buildInitializedArchitecture(const BenchPayload& payload)
+{
+	auto arch = buildBenchArchitecture(payload);
+	DocumentStorage store;
+	arch->init(store);
+	return arch;
+}
+
+/*!
+ * \brief	Synthetic x86 32 bits payload mapped at BENCH_FUNC_ADDR
+ * \param	blocks	number of blocks (see buildBranchPayload)
+ */
+static inline BenchPayload buildBranchBenchPayload(size_t blocks)
+{
+	return { "branch", "x86:LE:32:default:windows", "__stdcall", BENCH_FUNC_ADDR, buildBranchPayload(blocks) };
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include <benchmark/benchmark.h>
+#include "bench_payload.hh"
+#include "allocation_counter.hh"
+#include "profile.hh"
+
+#include <sstream>
+
+/*!
+ * \brief	Report heap allocations per iteration
+ * \param	start	allocation count before the loop
+ */
+static void _ReportAllocations(benchmark::State& state, size_t start)
+{
+	state.counters["allocs"] = benchmark::Counter(
+		static_cast<double>(allocationCount() - start),
+		benchmark::Counter::kAvgIterations
+	);
+}
+
+/*!
+ * \brief	Find the function of the payload in an initialized architecture
+ */
+static Funcdata* _FindFunction(yagi::YagiArchitecture& arch, const BenchPayload& payload)
+{
+	return arch.symboltab->getGlobalScope()->findFunction(
+		Address(arch.getDefaultCodeSpace(), payload.address)
+	);
+}
+
+/*!
+ * \brief	Load the sleigh specification and build the default action
+ *			Paid once per worker and per architecture
+ */
+static void BM_ArchitectureInit(benchmark::State& state, const BenchPayload& payload)
+{
+	yagi::ghidra::init(benchGhidraDirectory());
+
+	auto start = allocationCount();
+	for (auto _ : state)
+	{
+		auto arch = buildInitializedArchitecture(payload);
+		benchmark::DoNotOptimize(arch.get());
+	}
+	_ReportAllocations(state, start);
+}
+
+/*!
+ * \brief	Analysis of an already loaded function
+ *			Time spent into Yagi stages is reported per iteration
+ */
+static void BM_PerformActions(benchmark::State& state, const BenchPayload& payload)
+{
+	yagi::ghidra::init(benchGhidraDirectory());
+
+	auto arch = buildInitializedArchitecture(payload);
+	auto func = _FindFunction(*arch, payload);
+	arch->resetStageTimings();
+
+	auto start = allocationCount();
+	for (auto _ : state)
+	{
+		arch->clearAnalysis(func);
+		benchmark::DoNotOptimize(arch->performActions(*func));
+	}
+	_ReportAllocations(state, start);
+
+	for (auto& timing : arch->getStageTimings())
+	{
+		state.counters[timing.name + "_ms"] = benchmark::Counter(timing.milliseconds, benchmark::Counter::kAvgIterations);
+	}
+}
+
+/*!
+ * \brief	Analysis of an already loaded function into a profile
+ *			Compared to BM_PerformActions, gives the cost of the instrumentation
+ */
+static void BM_ProfiledActions(benchmark::State& state, const BenchPayload& payload)
+{
+	yagi::ghidra::init(benchGhidraDirectory());
+
+	auto arch = buildInitializedArchitecture(payload);
+	auto func = _FindFunction(*arch, payload);
+	yagi::Profile::setAllocationCounter(allocationCount);
+
+	auto start = allocationCount();
+	for (auto _ : state)
+	{
+		yagi::Profile profile(payload.address);
+		yagi::ProfileSession session(profile);
+		arch->clearAnalysis(func);
+		benchmark::DoNotOptimize(arch->performActions(*func));
+		profile.close();
+	}
+	_ReportAllocations(state, start);
+	yagi::Profile::setAllocationCounter(nullptr);
+}
+
+/*!
+ * \brief	Emission of an analyzed function with a print language
+ * \param	language	name of the print capability
+ */
+static void _BenchPrint(benchmark::State& state, const BenchPayload& payload, const std::string& language)
+{
+	yagi::ghidra::init(benchGhidraDirectory());
+
+	auto arch = buildInitializedArchitecture(payload);
+	auto func = _FindFunction(*arch, payload);
+	arch->performActions(*func);
+	arch->setPrintLanguage(language);
+
+	auto start = allocationCount();
+	for (auto _ : state)
+	{
+		std::stringstream ss;
+		arch->print->setOutputStream(&ss);
+		arch->print->docFunction(func);
+		benchmark::DoNotOptimize(ss.str());
+	}
+	arch->print->setOutputStream(nullptr);
+	_ReportAllocations(state, start);
+}
+
+/*!
+ * \brief	C emission of an analyzed function
+ */
+static void BM_Print(benchmark::State& state, const BenchPayload& payload)
+{
+	_BenchPrint(state, payload, "c-language");
+}
+
+/*!
+ * \brief	Colored emission used by the IDA viewer
+ *			Every token is wrapped into color tags
+ */
+static void BM_IdaPrint(benchmark::State& state, const BenchPayload& payload)
+{
+	_BenchPrint(state, payload, "yagi-c-language");
+}
+
+/*!
+ * \brief	Analysis of the synthetic function
+ *			Argument is the number of blocks
+ */
+static void BM_PerformActionsBranch(benchmark::State& state)
+{
+	BM_PerformActions(state, buildBranchBenchPayload(state.range(0)));
+	state.SetComplexityN(state.range(0));
+}
+
+/*!
+ * \brief	C emission of the synthetic function
+ *			Argument is the number of blocks
+ */
+static void BM_PrintBranch(benchmark::State& state)
+{
+	BM_Print(state, buildBranchBenchPayload(state.range(0)));
+	state.SetComplexityN(state.range(0));
+}
+
+/*!
+ * \brief	Colored emission of the synthetic function
+ *			Argument is the number of blocks
+ */
+static void BM_IdaPrintBranch(benchmark::State& state)
+{
+	BM_IdaPrint(state, buildBranchBenchPayload(state.range(0)));
+	state.SetComplexityN(state.range(0));
+}
+
+/*!
+ * \brief	Register one benchmark per sample payload
+ */
+static const bool _Registered = []() {
+	for (auto& payload : benchSamples())
+	{
+		benchmark::RegisterBenchmark((std::string("BM_ArchitectureInit/") + payload.name).c_str(), BM_ArchitectureInit, payload)
+			->Unit(benchmark::kMillisecond);
+		benchmark::RegisterBenchmark((std::string("BM_PerformActions/") + payload.name).c_str(), BM_PerformActions, payload)
+			->Unit(benchmark::kMicrosecond);
+		benchmark::RegisterBenchmark((std::string("BM_ProfiledActions/") + payload.name).c_str(), BM_ProfiledActions, payload)
+			->Unit(benchmark::kMicrosecond);
+		benchmark::RegisterBenchmark((std::string("BM_Print/") + payload.name).c_str(), BM_Print, payload)
+			->Unit(benchmark::kMicrosecond);
+		benchmark::RegisterBenchmark((std::string("BM_IdaPrint/") + payload.name).c_str(), BM_IdaPrint, payload)
+			->Unit(benchmark::kMicrosecond);
+	}
+	return true;
+}();
+
+BENCHMARK(BM_PerformActionsBranch)->RangeMultiplier(2)->Range(64, 1024)->Complexity()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PrintBranch)->RangeMultiplier(2)->Range(64, 1024)->Complexity()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_IdaPrintBranch)->RangeMultiplier(2)->Range(64, 1024)->Complexity()->Unit(benchmark::kMicrosecond);
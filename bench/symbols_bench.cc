@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+#include "bench_payload.hh"
+#include "ghidradecompiler.hh"
+#include "print.hh"
+
+/*!
+ * \brief	Expose symbol extraction of the decompiler
+ *			which only depends on the analyzed function
+ */
+class SymbolExtractor : public yagi::GhidraDecompiler
+{
+public:
+	SymbolExtractor()
+		: GhidraDecompiler(nullptr, yagi::ResultCache(0, nullptr))
+	{}
+
+	using GhidraDecompiler::findSymbols;
+};
+
+/*!
+ * \brief	Symbol extraction on an analyzed function
+ *			Argument is the number of blocks of the synthetic function
+ */
+static void BM_FindSymbols(benchmark::State& state)
+{
+	yagi::ghidra::init(benchGhidraDirectory());
+
+	auto payload = buildBranchBenchPayload(state.range(0));
+	auto arch = buildInitializedArchitecture(payload);
+
+	auto func = arch->symboltab->getGlobalScope()->findFunction(
+		Address(arch->getDefaultCodeSpace(), BENCH_FUNC_ADDR)
+	);
+	arch->performActions(*func);
+
+	SymbolExtractor extractor;
+	for (auto _ : state)
+	{
+		yagi::SymbolIndex symbols;
+		extractor.findSymbols(*func, symbols);
+		benchmark::DoNotOptimize(symbols);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_FindSymbols)->RangeMultiplier(2)->Range(64, 1024)->Complexity()->Unit(benchmark::kMicrosecond);
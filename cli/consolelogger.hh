@@ -0,0 +1,32 @@
+#ifndef __YAGI_CONSOLELOGGER__
+#define __YAGI_CONSOLELOGGER__
+
+#include "logger.hh"
+
+#include <iostream>
+#include <mutex>
+#include <string>
+
+/*!
+ * \brief	Logger of the headless decompiler and of the service
+ *			Messages of all workers go to the standard error
+ */
+class ConsoleLogger : public yagi::Logger
+{
+protected:
+	inline static std::mutex s_mutex;
+
+	void print(const std::string& message) override
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		std::cerr << message;
+	}
+
+public:
+	explicit ConsoleLogger(yagi::LogLevel level)
+	{
+		setLevel(level);
+	}
+};
+
+#endif
@@ -0,0 +1,357 @@
+#include "exportview.hh"
+#include "exportloader.hh"
+#include "exportsymbol.hh"
+#include "exporttype.hh"
+#include "ghidradecompiler.hh"
+#include "ghidra.hh"
+#include "batch.hh"
+#include "library.hh"
+#include "sync.hh"
+#include "options.hh"
+#include "profile.hh"
+#include "regression.hh"
+#include "exception.hh"
+#include "base.hh"
+#include "consolelogger.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/**********************************************************************/
+/*!
+ * \brief	Print the command line help
+ */
+static void _Usage()
+{
+	std::cerr << "usage: yagi_cli <ghidra_dir> <export> [-o <file.c> | -d <directory>] [-r <run.csv>] [-b <baseline.csv>] [options]" << std::endl;
+	std::cerr << "  ghidra_dir        folder that contains Ghidra/Processors" << std::endl;
+	std::cerr << "  export            database exported by the plugin, run_plugin(yagi, 5)" << std::endl;
+	std::cerr << "                    or a directory of exports (*.yagi) used as a corpus" << std::endl;
+	std::cerr << "  -o <file.c>       write all functions into a single file" << std::endl;
+	std::cerr << "                    or a JSON array of results and tokens if the extension is .json" << std::endl;
+	std::cerr << "  -d <directory>    write one file per function and a timing.csv report" << std::endl;
+	std::cerr << "  -r <run.csv>      save the output hash and timing of every function" << std::endl;
+	std::cerr << "  -b <baseline.csv> compare with a run saved by -r, exit code is 1 if an output changed" << std::endl;
+	std::cerr << "  -j <workers>      number of decompilers, one per hardware thread by default" << std::endl;
+	std::cerr << "  -f <ea,...>       decompile only these functions" << std::endl;
+	std::cerr << "  -O <key=value>    plugin options, comma separated (see README)" << std::endl;
+}
+
+/**********************************************************************/
+/*!
+ * \brief	Decompile functions of an export with a pool of decompilers
+ * \param	view		the export
+ * \param	functions	functions to decompile, all functions if empty
+ * \param	options		plugin options
+ * \param	count		number of decompilers
+ * \param	profile		destination of profiles, may be null
+ * \param	output		destination of results
+ * \param	logger		console logger
+ * \return	summary of the batch, nullopt if no decompiler can be loaded
+ */
+static std::optional<yagi::BatchDecompiler::Report> _DecompileExport(
+	std::shared_ptr<const yagi::ExportView> view,
+	std::vector<uint64_t> functions,
+	const yagi::Options& options,
+	size_t count,
+	std::shared_ptr<yagi::ProfileOutput> profile,
+	yagi::BatchOutput& output,
+	yagi::Logger& logger)
+{
+	if (functions.empty())
+	{
+		for (auto& function : view->getFunctions())
+		{
+			functions.push_back(function.ea);
+		}
+	}
+
+	// library functions are skipped or served from the shared results
+	// the others are saved there once decompiled
+	std::optional<yagi::LibraryStore> library;
+	if (!options.libraryDir.empty())
+	{
+		library.emplace(options.libraryDir);
+	}
+
+	std::unordered_map<uint64_t, yagi::LibraryFunction> libraryFunctions;
+	std::vector<uint64_t> remaining;
+	for (auto ea : functions)
+	{
+		auto function = view->findFunction(ea);
+		if (function == nullptr || (function->flags & yagi::exportformat::FUNCTION_LIBRARY) == 0)
+		{
+			remaining.push_back(ea);
+			continue;
+		}
+
+		std::optional<yagi::LibraryFunction> key;
+		if (library.has_value() && function->cloneHash != 0)
+		{
+			key = yagi::LibraryFunction{ std::string(view->getString(function->name)), function->cloneHash, function->size };
+		}
+
+		auto result = key.has_value() ? library.value().load(ea, key.value()) : std::nullopt;
+		if (result.has_value())
+		{
+			output.write(ea, result, 0);
+		}
+		else if (!options.librarySkip)
+		{
+			if (key.has_value())
+			{
+				libraryFunctions.emplace(ea, std::move(key.value()));
+			}
+			remaining.push_back(ea);
+		}
+	}
+	functions = std::move(remaining);
+	count = std::min(count, std::max<size_t>(1, functions.size()));
+
+	// workers are only used during the batch, no need to cache results
+	auto workerOptions = options;
+	workerOptions.cacheSize = 0;
+
+	// the export is read only and shared by all workers, no backend thread is needed
+	// architectures are still initialized sequentially because the spec parser use a global state
+	std::vector<std::unique_ptr<yagi::Decompiler>> workers;
+	for (size_t i = 0; i < count; i++)
+	{
+		auto worker = yagi::GhidraDecompiler::build(
+			view->getCompiler(),
+			workerOptions,
+			std::make_unique<yagi::ExportLoaderFactory>(view),
+			std::make_unique<ConsoleLogger>(options.logLevel),
+			std::make_unique<yagi::ExportSymbolInfoFactory>(view, options.readOnlySegments),
+			std::make_unique<yagi::ExportTypeInfoFactory>(view),
+			nullptr
+		);
+
+		if (!worker.has_value())
+		{
+			break;
+		}
+		worker.value()->setProfileOutput(profile);
+		workers.push_back(std::move(worker.value()));
+	}
+
+	if (workers.empty())
+	{
+		logger.error("Unable to load decompilers for the batch");
+		return std::nullopt;
+	}
+
+	yagi::RequestQueue queue;
+	yagi::BatchDecompiler batch(queue, std::move(workers));
+	if (options.batchDedup)
+	{
+		batch.setCloneKey([view](uint64_t ea) -> std::optional<yagi::BatchDecompiler::CloneKey> {
+			auto function = view->findFunction(ea);
+			if (function == nullptr || function->cloneHash == 0)
+			{
+				return std::nullopt;
+			}
+			return yagi::BatchDecompiler::CloneKey{ function->cloneHash, function->size, std::string(view->getString(function->name)) };
+		});
+	}
+	if (libraryFunctions.empty())
+	{
+		return batch.run(functions, output, nullptr);
+	}
+
+	yagi::LibraryBatchOutput libraryOutput(output, library.value(), std::move(libraryFunctions));
+	return batch.run(functions, libraryOutput, nullptr);
+}
+
+/**********************************************************************/
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		_Usage();
+		return 2;
+	}
+
+	std::string ghidraDir = argv[1];
+	std::filesystem::path exportPath = argv[2];
+	std::string outputFile, outputDir, runFile, baselineFile, functionList, optionString;
+	std::optional<size_t> nbWorkers;
+
+	for (int i = 3; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			_Usage();
+			return 2;
+		}
+
+		std::string value = argv[++i];
+		if (arg == "-o")
+		{
+			outputFile = value;
+		}
+		else if (arg == "-d")
+		{
+			outputDir = value;
+		}
+		else if (arg == "-r")
+		{
+			runFile = value;
+		}
+		else if (arg == "-b")
+		{
+			baselineFile = value;
+		}
+		else if (arg == "-j")
+		{
+			nbWorkers = std::strtoull(value.c_str(), nullptr, 0);
+		}
+		else if (arg == "-f")
+		{
+			functionList = value;
+		}
+		else if (arg == "-O")
+		{
+			optionString = value;
+		}
+		else
+		{
+			_Usage();
+			return 2;
+		}
+	}
+
+	// at most one output, none is allowed when only recording a run
+	auto recording = !runFile.empty() || !baselineFile.empty();
+	if ((!outputFile.empty() && !outputDir.empty()) || (outputFile.empty() && outputDir.empty() && !recording))
+	{
+		_Usage();
+		return 2;
+	}
+
+	auto options = yagi::Options::parse(optionString);
+	ConsoleLogger logger(options.logLevel);
+
+	try
+	{
+		// a corpus is decompiled export after export, in name order
+		std::vector<std::filesystem::path> exports;
+		if (std::filesystem::is_directory(exportPath))
+		{
+			for (auto& entry : std::filesystem::directory_iterator(exportPath))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".yagi")
+				{
+					exports.push_back(entry.path());
+				}
+			}
+			std::sort(exports.begin(), exports.end());
+		}
+		else
+		{
+			exports.push_back(exportPath);
+		}
+
+		std::vector<uint64_t> functions;
+		for (auto& ea : yagi::split(functionList, ','))
+		{
+			if (!ea.empty())
+			{
+				functions.push_back(std::stoull(ea, nullptr, 0));
+			}
+		}
+
+		// the JSON array is closed before its stream
+		std::ofstream jsonStream;
+		std::unique_ptr<yagi::BatchOutput> fileOutput;
+		if (std::filesystem::path(outputFile).extension() == ".json")
+		{
+			jsonStream.open(outputFile);
+			if (!jsonStream.is_open())
+			{
+				throw yagi::UnableToOpenOutput(outputFile);
+			}
+			fileOutput = std::make_unique<yagi::JsonBatchOutput>(jsonStream);
+		}
+		else if (!outputFile.empty())
+		{
+			fileOutput = std::make_unique<yagi::FileBatchOutput>(outputFile);
+		}
+
+		std::shared_ptr<yagi::ProfileOutput> profile;
+		if (!options.profileDir.empty())
+		{
+			profile = std::make_shared<yagi::DirectoryProfileOutput>(options.profileDir);
+		}
+
+		auto count = nbWorkers.value_or(options.batchWorkers);
+		if (count == 0)
+		{
+			count = std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+
+		yagi::ghidra::init(ghidraDir);
+
+		yagi::RegressionRun run;
+		yagi::BatchDecompiler::Report total;
+		for (auto& path : exports)
+		{
+			// mapped, records are used in place by all workers
+			auto view = yagi::ExportView::open(path);
+			auto source = path.stem().string();
+
+			// function addresses of several exports may collide
+			std::unique_ptr<yagi::BatchOutput> directoryOutput;
+			if (!outputDir.empty())
+			{
+				auto directory = exports.size() > 1 ? std::filesystem::path(outputDir) / source : std::filesystem::path(outputDir);
+				directoryOutput = std::make_unique<yagi::DirectoryBatchOutput>(directory);
+			}
+
+			yagi::RegressionBatchOutput output(run, source, fileOutput != nullptr ? fileOutput.get() : directoryOutput.get());
+			auto report = _DecompileExport(view, functions, options, count, profile, output, logger);
+			if (!report.has_value())
+			{
+				return 2;
+			}
+
+			total.decompiled += report.value().decompiled;
+			total.reused += report.value().reused;
+			total.failed += report.value().failed;
+			total.duration += report.value().duration;
+		}
+
+		std::stringstream ss;
+		ss << total.decompiled << " functions decompiled, " << total.failed << " failed in " << (total.duration / 1000.0) << "s";
+		if (total.reused != 0)
+		{
+			ss << ", " << total.reused << " identical functions reused";
+		}
+		logger.info("Batch", ss.str());
+
+		if (!runFile.empty())
+		{
+			run.save(runFile);
+		}
+
+		if (!baselineFile.empty())
+		{
+			auto diff = yagi::RegressionDiff::compare(yagi::RegressionRun::load(baselineFile), run);
+			diff.print(std::cout, 20);
+			return diff.hasOutputChanges() ? 1 : 0;
+		}
+
+		return total.failed == 0 ? 0 : 1;
+	}
+	catch (std::exception& e)
+	{
+		logger.error(e.what());
+		return 2;
+	}
+}
@@ -0,0 +1,144 @@
+#include "exportview.hh"
+#include "exportloader.hh"
+#include "exportsymbol.hh"
+#include "exporttype.hh"
+#include "ghidradecompiler.hh"
+#include "ghidra.hh"
+#include "servicehost.hh"
+#include "options.hh"
+#include "profile.hh"
+#include "consolelogger.hh"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/**********************************************************************/
+/*!
+ * \brief	Set by SIGINT and SIGTERM
+ */
+static std::atomic<bool> s_stop{ false };
+
+/**********************************************************************/
+static void _Stop(int)
+{
+	s_stop = true;
+}
+
+/**********************************************************************/
+/*!
+ * \brief	Print the command line help
+ */
+static void _Usage()
+{
+	std::cerr << "usage: yagi_service <ghidra_dir> [-p <port>] [-j <workers>] [-O <key=value>]" << std::endl;
+	std::cerr << "  ghidra_dir        folder that contains Ghidra/Processors" << std::endl;
+	std::cerr << "  -p <port>         local port, " << yagi::service::DEFAULT_PORT << " by default" << std::endl;
+	std::cerr << "  -j <workers>      number of decompilers per IDA instance, 2 by default" << std::endl;
+	std::cerr << "  -O <key=value>    plugin options, comma separated (see README)" << std::endl;
+}
+
+/**********************************************************************/
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		_Usage();
+		return 2;
+	}
+
+	std::string ghidraDir = argv[1];
+	std::string optionString;
+	uint16_t port = yagi::service::DEFAULT_PORT;
+	size_t workers = 2;
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			_Usage();
+			return 2;
+		}
+
+		std::string value = argv[++i];
+		if (arg == "-p")
+		{
+			port = static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 0));
+		}
+		else if (arg == "-j")
+		{
+			workers = std::strtoull(value.c_str(), nullptr, 0);
+		}
+		else if (arg == "-O")
+		{
+			optionString = value;
+		}
+		else
+		{
+			_Usage();
+			return 2;
+		}
+	}
+
+	auto options = yagi::Options::parse(optionString);
+	ConsoleLogger logger(options.logLevel);
+
+	yagi::ghidra::init(ghidraDir);
+
+	std::shared_ptr<yagi::ProfileOutput> profile;
+	if (!options.profileDir.empty())
+	{
+		profile = std::make_shared<yagi::DirectoryProfileOutput>(options.profileDir);
+	}
+
+	// decompilers stay warm between requests of an IDA instance
+	// until it sends a new export
+	yagi::ServiceHost host([&options, &logger, profile](const std::string& source) -> std::unique_ptr<yagi::Decompiler> {
+		try
+		{
+			auto view = yagi::ExportView::open(source);
+			auto decompiler = yagi::GhidraDecompiler::build(
+				view->getCompiler(),
+				options,
+				std::make_unique<yagi::ExportLoaderFactory>(view),
+				std::make_unique<ConsoleLogger>(options.logLevel),
+				std::make_unique<yagi::ExportSymbolInfoFactory>(view, options.readOnlySegments),
+				std::make_unique<yagi::ExportTypeInfoFactory>(view),
+				nullptr
+			);
+
+			if (!decompiler.has_value())
+			{
+				return nullptr;
+			}
+			decompiler.value()->setProfileOutput(profile);
+			return std::move(decompiler.value());
+		}
+		catch (std::exception& e)
+		{
+			logger.error(e.what());
+			return nullptr;
+		}
+	}, workers);
+
+	yagi::LocalServer server;
+	if (!server.listen(port))
+	{
+		logger.error("Unable to listen on port", port);
+		return 2;
+	}
+
+	std::signal(SIGINT, _Stop);
+	std::signal(SIGTERM, _Stop);
+
+	std::stringstream ss;
+	ss << "listening on port " << server.getPort() << ", " << workers << " decompilers per client";
+	logger.info("Service", ss.str());
+
+	host.serve(server, s_stop);
+	return 0;
+}
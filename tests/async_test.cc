@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include "async.hh"
+#include "mock_type_test.h"
+
+#include <atomic>
+#include <thread>
+
+/*!
+ * \brief	Decompiler that runs until its token ask to stop
+ *			when blocking is set
+ */
+class MockDecompiler : public yagi::Decompiler
+{
+public:
+	std::atomic<bool> m_block{ false };
+	std::shared_ptr<const yagi::CancelToken> m_token;
+	std::vector<std::string> m_updates;
+
+	std::optional<Result> decompile(uint64_t funcAddress) override
+	{
+		while (m_block)
+		{
+			if (m_token != nullptr && (m_token->isCanceled() || m_token->isExpired()))
+			{
+				return std::nullopt;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return Result("func", funcAddress, "void func(void) {}", {});
+	}
+
+	std::optional<Result> refreshNames(uint64_t funcAddress) override
+	{
+		return decompile(funcAddress);
+	}
+
+	void invalidate(uint64_t funcAddress) override { m_updates.push_back("invalidate"); }
+	void invalidateDependents(uint64_t ea) override { m_updates.push_back("invalidateDependents"); }
+	void invalidateCode(uint64_t ea) override { m_updates.push_back("invalidateCode"); }
+	void clearCache() override { m_updates.push_back("clearCache"); }
+	void invalidateType(const std::string& name) override { m_updates.push_back("invalidateType " + name); }
+	void invalidateTypes() override { m_updates.push_back("invalidateTypes"); }
+	void retain(uint64_t funcAddress) override { m_updates.push_back("retain"); }
+	void release(uint64_t funcAddress) override { m_updates.push_back("release"); }
+	void setCancelToken(std::shared_ptr<const yagi::CancelToken> token) override { m_token = std::move(token); }
+	void setProfileOutput(std::shared_ptr<yagi::ProfileOutput> output) override { m_updates.push_back("setProfileOutput"); }
+	size_t prewarmTypes(yagi::TypeInfoFactory& source, const std::vector<std::string>& names) override
+	{
+		m_updates.push_back("prewarmTypes " + std::to_string(names.size()));
+		return names.size();
+	}
+};
+
+/*!
+ * \brief	Poll until the running job is done
+ */
+static yagi::AsyncDecompiler::Outcome _Wait(yagi::AsyncDecompiler& async)
+{
+	while (true)
+	{
+		auto outcome = async.poll();
+		if (outcome.has_value())
+		{
+			return std::move(outcome.value());
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+TEST(TestAsyncDecompiler, Done) {
+	MockDecompiler decompiler;
+	yagi::AsyncDecompiler async(decompiler);
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	auto outcome = _Wait(async);
+
+	ASSERT_EQ(outcome.status, yagi::AsyncDecompiler::Status::Done);
+	ASSERT_EQ(outcome.ea, 0x1000);
+	ASSERT_EQ(outcome.result.value().name, "func");
+	ASSERT_FALSE(async.isBusy());
+	ASSERT_EQ(decompiler.m_token, nullptr);
+}
+
+TEST(TestAsyncDecompiler, Cancel) {
+	MockDecompiler decompiler;
+	decompiler.m_block = true;
+	yagi::AsyncDecompiler async(decompiler);
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	ASSERT_TRUE(async.isBusy());
+
+	// only one job at a time
+	ASSERT_FALSE(async.start(0x2000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+
+	async.cancel();
+	auto outcome = _Wait(async);
+
+	ASSERT_EQ(outcome.status, yagi::AsyncDecompiler::Status::Canceled);
+	ASSERT_FALSE(outcome.result.has_value());
+}
+
+TEST(TestAsyncDecompiler, Expired) {
+	MockDecompiler decompiler;
+	decompiler.m_block = true;
+	yagi::AsyncDecompiler async(decompiler);
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::RefreshNames, std::chrono::milliseconds(10)));
+	auto outcome = _Wait(async);
+
+	ASSERT_EQ(outcome.status, yagi::AsyncDecompiler::Status::Expired);
+	ASSERT_GE(outcome.duration, 10.0);
+}
+
+TEST(TestAsyncDecompiler, InvalidateAfterJob) {
+	MockDecompiler decompiler;
+	decompiler.m_block = true;
+	yagi::AsyncDecompiler async(decompiler);
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	async.invalidate(0x1000);
+	async.invalidateType("foo");
+	async.setProfileOutput(nullptr);
+	async.retain(0x1000);
+
+	// the decompiler is still used by the job
+	ASSERT_TRUE(decompiler.m_updates.empty());
+
+	decompiler.m_block = false;
+	_Wait(async);
+
+	ASSERT_EQ(decompiler.m_updates, std::vector<std::string>({ "invalidate", "invalidateType foo", "setProfileOutput", "retain" }));
+
+	// idle, applied immediately
+	async.clearCache();
+	async.release(0x1000);
+	ASSERT_EQ(decompiler.m_updates.size(), 6);
+}
+
+TEST(TestAsyncDecompiler, DeferAfterJob) {
+	MockDecompiler decompiler;
+	decompiler.m_block = true;
+	yagi::AsyncDecompiler async(decompiler);
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	async.defer([&decompiler]() { decompiler.m_updates.push_back("image"); });
+	async.invalidateDependents(0x1000);
+	ASSERT_TRUE(decompiler.m_updates.empty());
+
+	// the image is updated before results that read it are dropped
+	decompiler.m_block = false;
+	_Wait(async);
+	ASSERT_EQ(decompiler.m_updates, std::vector<std::string>({ "image", "invalidateDependents" }));
+
+	async.defer([&decompiler]() { decompiler.m_updates.push_back("now"); });
+	ASSERT_EQ(decompiler.m_updates.back(), "now");
+}
+
+TEST(TestAsyncDecompiler, Prewarm) {
+	MockDecompiler decompiler;
+	yagi::AsyncDecompiler async(decompiler);
+	auto source = std::make_shared<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; });
+
+	ASSERT_TRUE(async.startPrewarm(source, { "FILETIME", "SYSTEMTIME" }));
+	ASSERT_FALSE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	auto outcome = _Wait(async);
+
+	ASSERT_EQ(outcome.status, yagi::AsyncDecompiler::Status::Done);
+	ASSERT_FALSE(outcome.result.has_value());
+	ASSERT_EQ(decompiler.m_updates, std::vector<std::string>({ "prewarmTypes 2" }));
+	ASSERT_EQ(decompiler.m_token, nullptr);
+}
+
+TEST(TestAsyncDecompiler, NotifyAtEnd) {
+	MockDecompiler decompiler;
+	yagi::AsyncDecompiler async(decompiler);
+
+	std::atomic<int> notified{ 0 };
+	async.setNotify([&notified]() { notified++; });
+
+	ASSERT_TRUE(async.start(0x1000, yagi::AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(0)));
+	while (notified == 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// once notified the outcome is available without polling again
+	auto outcome = async.poll();
+	ASSERT_TRUE(outcome.has_value());
+	ASSERT_EQ(outcome.value().status, yagi::AsyncDecompiler::Status::Done);
+	ASSERT_EQ(notified, 1);
+}
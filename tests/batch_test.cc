@@ -0,0 +1,368 @@
+#include <gtest/gtest.h>
+#include "batch.hh"
+#include "sync.hh"
+#include "mock_symbol_test.h"
+#include "mock_logger_test.h"
+
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+/*!
+ * \brief	Decompiler that access the backend through the queue
+ *			Fail on odd addresses
+ */
+class MockDecompiler : public yagi::Decompiler
+{
+protected:
+	yagi::RequestQueue& m_queue;
+	std::thread::id m_owner;
+
+public:
+	std::atomic<bool> m_calledFromOwner{ false };
+
+	explicit MockDecompiler(yagi::RequestQueue& queue)
+		: m_queue{ queue }, m_owner{ std::this_thread::get_id() }
+	{}
+
+	std::optional<Result> decompile(uint64_t funcAddress) override
+	{
+		if (std::this_thread::get_id() == m_owner)
+		{
+			m_calledFromOwner = true;
+		}
+
+		auto name = m_queue.call([this, funcAddress]() {
+			EXPECT_EQ(std::this_thread::get_id(), m_owner);
+			return "func_" + yagi::to_hex(funcAddress);
+		});
+
+		if (funcAddress % 2 != 0)
+		{
+			return std::nullopt;
+		}
+
+		Result result(name, funcAddress, "void " + name + "(void) {}", {});
+		auto prototype = std::make_shared<yagi::Prototype>();
+		prototype->name = name;
+		result.prototype = prototype;
+		return result;
+	}
+
+	std::optional<Result> refreshNames(uint64_t funcAddress) override
+	{
+		return decompile(funcAddress);
+	}
+
+	void invalidate(uint64_t funcAddress) override {}
+	void invalidateDependents(uint64_t ea) override {}
+	void invalidateCode(uint64_t ea) override {}
+	void clearCache() override {}
+	void invalidateType(const std::string& name) override {}
+	void invalidateTypes() override {}
+	void retain(uint64_t funcAddress) override {}
+	void release(uint64_t funcAddress) override {}
+	void setCancelToken(std::shared_ptr<const yagi::CancelToken> token) override {}
+	void setProfileOutput(std::shared_ptr<yagi::ProfileOutput> output) override {}
+	size_t prewarmTypes(yagi::TypeInfoFactory& source, const std::vector<std::string>& names) override { return 0; }
+};
+
+class MockBatchOutput : public yagi::BatchOutput
+{
+public:
+	std::set<uint64_t> m_decompiled;
+	std::set<uint64_t> m_failed;
+	std::vector<uint64_t> m_order;
+
+	void write(uint64_t ea, const std::optional<yagi::Decompiler::Result>& result, double duration) override
+	{
+		m_order.push_back(ea);
+		if (result.has_value())
+		{
+			EXPECT_EQ(result.value().name, "func_" + yagi::to_hex(ea));
+			m_decompiled.insert(ea);
+		}
+		else
+		{
+			m_failed.insert(ea);
+		}
+	}
+};
+
+TEST(TestRequestQueue, ExecuteOnOwnerThread) {
+	yagi::RequestQueue queue;
+	auto owner = std::this_thread::get_id();
+
+	std::atomic<bool> done{ false };
+	std::thread::id executedOn;
+	std::thread worker([&]() {
+		executedOn = queue.call([]() { return std::this_thread::get_id(); });
+		done = true;
+		queue.wake();
+	});
+
+	while (!done)
+	{
+		queue.process(std::chrono::milliseconds(50));
+	}
+	worker.join();
+
+	ASSERT_EQ(executedOn, owner);
+}
+
+TEST(TestRequestQueue, ForwardException) {
+	yagi::RequestQueue queue;
+
+	std::atomic<bool> done{ false };
+	bool raised = false;
+	std::thread worker([&]() {
+		try
+		{
+			queue.execute([]() { throw std::runtime_error("backend error"); });
+		}
+		catch (std::runtime_error&)
+		{
+			raised = true;
+		}
+		done = true;
+		queue.wake();
+	});
+
+	while (!done)
+	{
+		queue.process(std::chrono::milliseconds(50));
+	}
+	worker.join();
+
+	ASSERT_TRUE(raised);
+}
+
+TEST(TestRequestQueue, SyncLoggerPrintOnOwnerThread) {
+	yagi::RequestQueue queue;
+	auto owner = std::this_thread::get_id();
+
+	std::vector<std::string> messages;
+	std::thread::id printedOn;
+	auto logger = std::make_unique<yagi::SyncLogger>(queue, std::make_unique<MockLogger>([&](const std::string& message) {
+		messages.push_back(message);
+		printedOn = std::this_thread::get_id();
+	}));
+
+	std::thread worker([&]() {
+		logger->info("from worker");
+	});
+	worker.join();
+
+	// message is posted, nothing printed until the queue is processed
+	ASSERT_TRUE(messages.empty());
+	queue.process(std::chrono::milliseconds(0));
+
+	ASSERT_EQ(messages.size(), 1);
+	ASSERT_EQ(printedOn, owner);
+}
+
+TEST(TestRequestQueue, SyncSymbolCapturedOnOwnerThread) {
+	yagi::RequestQueue queue;
+	yagi::SyncSymbolInfoFactory factory(queue, std::make_unique<MockSymbolInfoFactory>(
+		[](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			return std::make_unique<MockSymbolInfo>(ea, "symbol", 0x10, true, false, true, false);
+		},
+		[](uint64_t ea) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::nullopt;
+		}
+	));
+
+	std::atomic<bool> done{ false };
+	std::optional<std::unique_ptr<yagi::SymbolInfo>> symbol;
+	std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> function;
+	std::thread worker([&]() {
+		symbol = factory.find(0x1000);
+		function = factory.find_function(0x1000);
+		done = true;
+		queue.wake();
+	});
+
+	while (!done)
+	{
+		queue.process(std::chrono::milliseconds(50));
+	}
+	worker.join();
+
+	ASSERT_TRUE(symbol.has_value());
+	ASSERT_EQ(symbol.value()->getName(), "symbol");
+	ASSERT_EQ(symbol.value()->getAddress(), 0x1000);
+	ASSERT_EQ(symbol.value()->getFunctionSize(), 0x10);
+	ASSERT_TRUE(symbol.value()->isImport());
+	ASSERT_FALSE(function.has_value());
+}
+
+TEST(TestBatchDecompiler, DecompileAllFunctions) {
+	yagi::RequestQueue queue;
+
+	std::vector<std::unique_ptr<yagi::Decompiler>> workers;
+	std::vector<MockDecompiler*> mocks;
+	for (int i = 0; i < 4; i++)
+	{
+		auto worker = std::make_unique<MockDecompiler>(queue);
+		mocks.push_back(worker.get());
+		workers.push_back(std::move(worker));
+	}
+
+	std::vector<uint64_t> functions;
+	for (uint64_t ea = 0x1000; ea < 0x1100; ea++)
+	{
+		functions.push_back(ea);
+	}
+
+	MockBatchOutput output;
+	yagi::BatchDecompiler batch(queue, std::move(workers));
+	auto report = batch.run(functions, output, nullptr);
+
+	ASSERT_EQ(report.decompiled, 0x80);
+	ASSERT_EQ(report.failed, 0x80);
+	ASSERT_FALSE(report.canceled);
+	ASSERT_EQ(output.m_decompiled.size(), 0x80);
+	ASSERT_EQ(output.m_failed.size(), 0x80);
+
+	for (auto mock : mocks)
+	{
+		ASSERT_FALSE(mock->m_calledFromOwner);
+	}
+}
+
+TEST(TestBatchDecompiler, Cancel) {
+	yagi::RequestQueue queue;
+
+	std::vector<std::unique_ptr<yagi::Decompiler>> workers;
+	workers.push_back(std::make_unique<MockDecompiler>(queue));
+
+	std::vector<uint64_t> functions(10000, 0x1000);
+
+	MockBatchOutput output;
+	yagi::BatchDecompiler batch(queue, std::move(workers));
+	auto report = batch.run(functions, output, [](size_t done, size_t total) {
+		return false;
+	});
+
+	ASSERT_TRUE(report.canceled);
+	ASSERT_LT(report.decompiled, functions.size());
+}
+
+TEST(TestBatchDecompiler, Waves) {
+	yagi::RequestQueue queue;
+
+	std::vector<std::unique_ptr<yagi::Decompiler>> workers;
+	for (int i = 0; i < 4; i++)
+	{
+		workers.push_back(std::make_unique<MockDecompiler>(queue));
+	}
+
+	std::vector<std::vector<uint64_t>> waves = {
+		{ 0x1000, 0x1002, 0x1003, 0x1004 },
+		{ 0x2000 },
+		{ 0x3000, 0x3002 }
+	};
+
+	MockBatchOutput output;
+	std::vector<std::vector<uint64_t>> recovered;
+	yagi::BatchDecompiler batch(queue, std::move(workers));
+	auto report = batch.run(waves, output, nullptr, [&](const std::vector<std::pair<uint64_t, std::shared_ptr<const yagi::Prototype>>>& prototypes) {
+		// every function of the wave is already written
+		size_t written = 0;
+		for (size_t i = 0; i <= recovered.size(); i++)
+		{
+			written += waves[i].size();
+		}
+		ASSERT_EQ(output.m_order.size(), written);
+
+		std::vector<uint64_t> wave;
+		for (auto& prototype : prototypes)
+		{
+			ASSERT_EQ(prototype.second->name, "func_" + yagi::to_hex(prototype.first));
+			wave.push_back(prototype.first);
+		}
+		std::sort(wave.begin(), wave.end());
+		recovered.push_back(wave);
+	});
+
+	ASSERT_EQ(report.decompiled, 6);
+	ASSERT_EQ(report.failed, 1);
+	ASSERT_FALSE(report.canceled);
+
+	// failed functions have no prototype
+	ASSERT_EQ(recovered.size(), 3);
+	ASSERT_EQ(recovered[0], std::vector<uint64_t>({ 0x1000, 0x1002, 0x1004 }));
+	ASSERT_EQ(recovered[1], std::vector<uint64_t>({ 0x2000 }));
+	ASSERT_EQ(recovered[2], std::vector<uint64_t>({ 0x3000, 0x3002 }));
+
+	// a wave is written only once the previous one is done
+	ASSERT_EQ(output.m_order.size(), 7);
+	ASSERT_EQ(output.m_order[4], 0x2000);
+	ASSERT_GE(output.m_order[5], 0x3000);
+	ASSERT_GE(output.m_order[6], 0x3000);
+}
+
+TEST(TestBatchDecompiler, DecompileClonesOnce) {
+	yagi::RequestQueue queue;
+
+	std::vector<std::unique_ptr<yagi::Decompiler>> workers;
+	for (int i = 0; i < 2; i++)
+	{
+		workers.push_back(std::make_unique<MockDecompiler>(queue));
+	}
+
+	std::vector<uint64_t> functions;
+	for (uint64_t ea = 0x1000; ea < 0x1010; ea++)
+	{
+		functions.push_back(ea);
+	}
+
+	MockBatchOutput output;
+	yagi::BatchDecompiler batch(queue, std::move(workers));
+	batch.setCloneKey([](uint64_t ea) -> std::optional<yagi::BatchDecompiler::CloneKey> {
+		// 0x100e has local names
+		if (ea == 0x100e)
+		{
+			return std::nullopt;
+		}
+		return yagi::BatchDecompiler::CloneKey{ ea % 4, 1, "func_" + yagi::to_hex(ea) };
+	});
+	auto report = batch.run(functions, output, nullptr);
+
+	// one function of each class is decompiled, clones of a failure fail
+	ASSERT_EQ(report.decompiled, 3);
+	ASSERT_EQ(report.reused, 5);
+	ASSERT_EQ(report.failed, 8);
+	ASSERT_EQ(output.m_decompiled.size(), 8);
+	ASSERT_EQ(output.m_failed.size(), 8);
+}
+
+TEST(TestBatchDecompiler, JsonOutput) {
+	std::ostringstream empty;
+	yagi::JsonBatchOutput(empty).close();
+	ASSERT_EQ(empty.str(), "[]");
+
+	yagi::Decompiler::Result result("func\"1\"", 0x1000, "void func(void)\n{\n}", {
+		yagi::Decompiler::Symbol("g_value", yagi::MemoryLocation("ram", 0x2000, 4))
+	}, {
+		{ 0, 0, 4, UINT32_MAX, yagi::Decompiler::TokenKind::Type, 2 },
+		{ 0, 5, 9, 0, yagi::Decompiler::TokenKind::FunctionName, 3 }
+	});
+
+	std::ostringstream stream;
+	{
+		yagi::JsonBatchOutput output(stream);
+		output.write(0x1000, result, 1.5);
+		output.write(0x1001, std::nullopt, 0.25);
+	}
+
+	ASSERT_EQ(stream.str(),
+		"[\n"
+		"{\"address\": \"0x1000\", \"status\": \"ok\", \"milliseconds\": 1.50, \"name\": \"func\\\"1\\\"\", \"code\": \"void func(void)\\n{\\n}\", "
+		"\"symbols\": [{\"name\": \"g_value\", \"space\": \"ram\", \"offset\": \"0x2000\", \"size\": 4}], "
+		"\"tokens\": [[0, 0, 4, \"type\", 2, null], [0, 5, 9, \"funcname\", 3, 0]]},\n"
+		"{\"address\": \"0x1001\", \"status\": \"failed\", \"milliseconds\": 0.25}\n"
+		"]"
+	);
+}
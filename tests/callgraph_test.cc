@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "callgraph.hh"
+
+TEST(TestCallGraph, LeafFunctionsFirst) {
+	yagi::CallGraph graph;
+	graph.addFunction(0x1000);
+	graph.addFunction(0x2000);
+	graph.addFunction(0x3000);
+	graph.addFunction(0x4000);
+	graph.addCall(0x4000, 0x2000);
+	graph.addCall(0x4000, 0x3000);
+	graph.addCall(0x3000, 0x2000);
+	graph.addCall(0x2000, 0x1000);
+
+	// calls outside of known functions are ignored
+	graph.addCall(0x1000, 0x9000);
+
+	auto waves = graph.getWaves();
+	ASSERT_EQ(graph.size(), 4);
+	ASSERT_EQ(waves.size(), 4);
+	ASSERT_EQ(waves[0], std::vector<uint64_t>({ 0x1000 }));
+	ASSERT_EQ(waves[1], std::vector<uint64_t>({ 0x2000 }));
+	ASSERT_EQ(waves[2], std::vector<uint64_t>({ 0x3000 }));
+	ASSERT_EQ(waves[3], std::vector<uint64_t>({ 0x4000 }));
+}
+
+TEST(TestCallGraph, RecursiveFunctionsShareAWave) {
+	yagi::CallGraph graph;
+	graph.addFunction(0x1000);
+	graph.addFunction(0x5000);
+	graph.addCall(0x2000, 0x3000);
+	graph.addCall(0x3000, 0x2000);
+	graph.addCall(0x3000, 0x3000);
+	graph.addCall(0x2000, 0x1000);
+	graph.addCall(0x4000, 0x2000);
+
+	auto waves = graph.getWaves();
+	ASSERT_EQ(waves.size(), 3);
+	ASSERT_EQ(waves[0], std::vector<uint64_t>({ 0x1000, 0x5000 }));
+	ASSERT_EQ(waves[1], std::vector<uint64_t>({ 0x2000, 0x3000 }));
+	ASSERT_EQ(waves[2], std::vector<uint64_t>({ 0x4000 }));
+}
+
+TEST(TestCallGraph, DeepCallChain) {
+	yagi::CallGraph graph;
+	graph.addFunction(0);
+	for (uint64_t ea = 0; ea < 100000; ea++)
+	{
+		graph.addCall(ea + 1, ea);
+	}
+
+	auto waves = graph.getWaves();
+	ASSERT_EQ(waves.size(), 100001);
+	ASSERT_EQ(waves.front(), std::vector<uint64_t>({ 0 }));
+	ASSERT_EQ(waves.back(), std::vector<uint64_t>({ 100000 }));
+}
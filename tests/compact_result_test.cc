@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "compactresult.hh"
+
+static yagi::Decompiler::Result _BuildResult()
+{
+	std::vector<yagi::Decompiler::Symbol> symbols;
+	yagi::MemoryLocation loc("register", 0x10, 4);
+	loc.pc.push_back(0x1004);
+	loc.pc.push_back(0x1008);
+	symbols.emplace_back("var", loc);
+	symbols.emplace_back("g_value", yagi::MemoryLocation("ram", 0x2000, 8));
+	symbols.emplace_back("var", yagi::MemoryLocation("stack", 0x10, 8));
+	symbols.emplace_back("tmp", yagi::MemoryLocation("join", 0x20, 4));
+
+	// "g_value" on the first line, "var" and "tmp" on the second one
+	std::vector<yagi::Decompiler::Token> tokens = { { 0, 4, 11, 1 }, { 1, 2, 5, 0 }, { 1, 8, 11, 3 } };
+	yagi::Decompiler::Result result("test", 0x1000, "code", symbols, tokens);
+	result.dependencies.addresses = { 0x2000 };
+	return result;
+}
+
+TEST(TestCompactResult, Symbols) {
+	yagi::CompactResult compact(_BuildResult());
+	ASSERT_EQ(compact.getName(), "test");
+	ASSERT_EQ(compact.getEa(), 0x1000);
+	ASSERT_TRUE(compact.getDependencies().dependsOn(0x2000));
+
+	auto& symbols = compact.getSymbols();
+	ASSERT_EQ(symbols.size(), 4);
+	ASSERT_EQ(symbols[1].space, yagi::SpaceId::Ram);
+	ASSERT_EQ(symbols[3].space, yagi::SpaceId::Other);
+	ASSERT_EQ(compact.getSpaceName(symbols[3]), "join");
+
+	// same name, different storages
+	ASSERT_EQ(symbols[0].name, symbols[2].name);
+	ASSERT_EQ(compact.getSymbolName(symbols[2]), "var");
+
+	auto location = compact.getLocation(symbols[0]);
+	ASSERT_EQ(location.spaceName, "register");
+	ASSERT_EQ(location.pc, std::vector<uint64_t>({ 0x1004, 0x1008 }));
+	ASSERT_TRUE(compact.getLocation(symbols[1]).pc.empty());
+}
+
+TEST(TestCompactResult, FindSymbol) {
+	yagi::CompactResult compact(_BuildResult());
+	auto& symbols = compact.getSymbols();
+
+	ASSERT_EQ(compact.findSymbol(0, 5), &symbols[1]);
+	ASSERT_EQ(compact.findSymbol(1, 9), &symbols[3]);
+	ASSERT_EQ(compact.findSymbol(1, 6), nullptr);
+
+	// the first symbol of a name, as Decompiler::Result
+	ASSERT_EQ(compact.findSymbol("var"), &symbols[0]);
+	ASSERT_EQ(compact.findSymbol("tmp"), &symbols[3]);
+	ASSERT_EQ(compact.findSymbol("missing"), nullptr);
+}
+
+TEST(TestCompactResult, RoundTrip) {
+	auto original = _BuildResult();
+	yagi::CompactResult compact(original);
+	auto result = compact.toResult();
+
+	ASSERT_EQ(result.cCode, original.cCode);
+	ASSERT_EQ(result.name, original.name);
+	ASSERT_EQ(result.tokens.size(), original.tokens.size());
+	ASSERT_EQ(result.dependencies.addresses, original.dependencies.addresses);
+	ASSERT_EQ(result.symbols.size(), original.symbols.size());
+	for (size_t i = 0; i < result.symbols.size(); i++)
+	{
+		ASSERT_EQ(result.symbols[i].name, original.symbols[i].name);
+		ASSERT_EQ(result.symbols[i].location.spaceName, original.symbols[i].location.spaceName);
+		ASSERT_EQ(result.symbols[i].location.offset, original.symbols[i].location.offset);
+		ASSERT_EQ(result.symbols[i].location.addrSize, original.symbols[i].location.addrSize);
+		ASSERT_EQ(result.symbols[i].location.pc, original.symbols[i].location.pc);
+	}
+
+	ASSERT_EQ(compact.takeCode(), "code");
+	ASSERT_TRUE(compact.getCode().empty());
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "decompilecontext.hh"
+#include "ghidradecompiler.hh"
+#include "yagiarchitecture.hh"
+#include "ghidra.hh"
+#include "mock_logger_test.h"
+#include "mock_symbol_test.h"
+#include "mock_type_test.h"
+#include "mock_loader_test.h"
+
+#include <cstring>
+#include <map>
+
+class CountingFunctionSymbolInfo : public MockFunctionSymbolInfo
+{
+public:
+	int m_loads = 0;
+
+	using MockFunctionSymbolInfo::MockFunctionSymbolInfo;
+
+	yagi::LocalOverrides findLocalOverrides() override
+	{
+		m_loads++;
+		return MockFunctionSymbolInfo::findLocalOverrides();
+	}
+};
+
+TEST(TestDecompileContext, OverridesAreLoadedOnce) {
+	auto function = std::make_unique<CountingFunctionSymbolInfo>(
+		std::make_unique<MockSymbolInfo>(0x1000, "main", 1, true, false, false, false)
+	);
+	function->m_name.emplace(std::make_tuple(0x1010, "register"), std::make_tuple("count", 0x8));
+	auto counter = function.get();
+
+	yagi::DecompileContext context(std::move(function));
+	ASSERT_EQ(context.getAddress(), 0x1000);
+	ASSERT_EQ(counter->m_loads, 0);
+
+	ASSERT_EQ(context.getOverrides().names.size(), 1);
+	ASSERT_EQ(context.getOverrides().names.begin()->second.name, "count");
+	ASSERT_TRUE(context.getOverrides().types.empty());
+	ASSERT_EQ(counter->m_loads, 1);
+	ASSERT_EQ(&context.getFunction(), counter);
+}
+
+TEST(TestDecompileContext, Dependencies) {
+	yagi::DecompileContext context(std::make_unique<MockFunctionSymbolInfo>(
+		std::make_unique<MockSymbolInfo>(0x1000, "main", 1, true, false, false, false)
+	));
+
+	context.addDependency(0x3000);
+	context.addDependency(0x2000);
+	context.addDependency(0x3000);
+	ASSERT_TRUE(context.addDependency("foo"));
+	ASSERT_FALSE(context.addDependency("foo"));
+
+	// a rename pass adds to the analysis
+	yagi::Decompiler::Dependencies analyzed;
+	analyzed.addresses = { 0x1500 };
+	analyzed.types = { "bar" };
+	context.addDependencies(analyzed);
+
+	auto dependencies = context.getDependencies();
+	ASSERT_EQ(dependencies.addresses, std::vector<uint64_t>({ 0x1500, 0x2000, 0x3000 }));
+	ASSERT_EQ(dependencies.types, std::vector<std::string>({ "bar", "foo" }));
+	ASSERT_TRUE(dependencies.dependsOn(0x2000));
+	ASSERT_FALSE(dependencies.dependsOn(0x1000));
+	ASSERT_TRUE(dependencies.dependsOn("bar"));
+}
+
+#define FIRST_ADDR 0x401000
+#define SECOND_ADDR 0x401010
+
+// mov eax, 1; ret then xor eax, eax; ret
+static const uint8_t TWO_FUNCTIONS[] = {
+	0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3, 0xCC, 0xCC,
+	0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+	0x33, 0xC0, 0xC3, 0xCC
+};
+
+/*!
+ * \brief	Decompiler of both functions, without result cache
+ *			Counts functions loaded into the global scope
+ */
+static std::unique_ptr<yagi::GhidraDecompiler> _BuildDecompiler(std::map<uint64_t, int>& loads)
+{
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto symbol = [](uint64_t ea) {
+		return std::make_unique<MockSymbolInfo>(ea, ea == FIRST_ADDR ? "first" : "second", ea == FIRST_ADDR ? 6 : 3, true, false, false, false);
+	};
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			std::memset(ptr, 0, size);
+			for (int4 i = 0; i < size; i++)
+			{
+				auto offset = addr.getOffset() + i - FIRST_ADDR;
+				if (offset < sizeof(TWO_FUNCTIONS))
+				{
+					ptr[i] = TWO_FUNCTIONS[offset];
+				}
+			}
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([symbol](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FIRST_ADDR || ea == SECOND_ADDR)
+			{
+				return symbol(ea);
+			}
+			return std::nullopt;
+		},
+		[symbol](uint64_t ea) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			if (ea == FIRST_ADDR || ea == SECOND_ADDR)
+			{
+				return std::make_unique<MockFunctionSymbolInfo>(symbol(ea));
+			}
+			return std::nullopt;
+		}),
+		// the prototype of a function is read when it is loaded into the scope
+		std::make_unique<MockTypeInfoFactory>([&loads](uint64_t ea) {
+			loads[ea]++;
+			return std::nullopt;
+		}, [](const std::string&) { return std::nullopt; }),
+		"__cdecl"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+	return std::make_unique<yagi::GhidraDecompiler>(std::move(arch), yagi::ResultCache(0, nullptr));
+}
+
+TEST(TestDecompileContext, RetainedAnalysisIsKept) {
+	std::map<uint64_t, int> loads;
+	auto decompiler = _BuildDecompiler(loads);
+
+	// shown by a viewer, kept while another function is analyzed
+	decompiler->retain(FIRST_ADDR);
+	ASSERT_TRUE(decompiler->decompile(FIRST_ADDR).has_value());
+	auto first = loads[FIRST_ADDR];
+	ASSERT_GT(first, 0);
+
+	ASSERT_TRUE(decompiler->decompile(SECOND_ADDR).has_value());
+	ASSERT_TRUE(decompiler->refreshNames(FIRST_ADDR).has_value());
+	ASSERT_EQ(loads[FIRST_ADDR], first);
+
+	// once the viewer is closed, the scope is cleared by the next analysis
+	decompiler->release(FIRST_ADDR);
+	ASSERT_TRUE(decompiler->decompile(SECOND_ADDR).has_value());
+	ASSERT_TRUE(decompiler->refreshNames(FIRST_ADDR).has_value());
+	ASSERT_GT(loads[FIRST_ADDR], first);
+}
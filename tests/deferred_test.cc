@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "deferred.hh"
+#include "mock_logger_test.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+/*!
+ * \brief	Decompiler that count received calls
+ */
+class CountingDecompiler : public yagi::Decompiler
+{
+public:
+	std::atomic<size_t>& m_invalidated;
+
+	explicit CountingDecompiler(std::atomic<size_t>& invalidated)
+		: m_invalidated{ invalidated }
+	{}
+
+	std::optional<Result> decompile(uint64_t funcAddress) override
+	{
+		return Result("func", funcAddress, "void func(void) {}", {});
+	}
+
+	std::optional<Result> refreshNames(uint64_t funcAddress) override
+	{
+		return decompile(funcAddress);
+	}
+
+	void invalidate(uint64_t funcAddress) override { m_invalidated++; }
+	void invalidateDependents(uint64_t ea) override { m_invalidated++; }
+	void invalidateCode(uint64_t ea) override { m_invalidated++; }
+	void clearCache() override { m_invalidated++; }
+	void invalidateType(const std::string& name) override { m_invalidated++; }
+	void invalidateTypes() override { m_invalidated++; }
+	void retain(uint64_t funcAddress) override {}
+	void release(uint64_t funcAddress) override {}
+	void setCancelToken(std::shared_ptr<const yagi::CancelToken> token) override {}
+	void setProfileOutput(std::shared_ptr<yagi::ProfileOutput> output) override {}
+	size_t prewarmTypes(yagi::TypeInfoFactory& source, const std::vector<std::string>& names) override { return 0; }
+};
+
+TEST(TestDeferredDecompiler, DecompileWaitForBuild) {
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool release = false;
+	std::atomic<size_t> invalidated{ 0 };
+
+	yagi::DeferredDecompiler decompiler([&]() -> std::unique_ptr<yagi::Decompiler> {
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait(lock, [&]() { return release; });
+		return std::make_unique<CountingDecompiler>(invalidated);
+	}, std::make_unique<MockLogger>([](const std::string&) {}));
+
+	// nothing to invalidate during the build
+	decompiler.clearCache();
+	decompiler.invalidateType("type");
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		release = true;
+	}
+	cv.notify_one();
+
+	auto result = decompiler.decompile(0x1000);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().ea, 0x1000);
+	ASSERT_EQ(invalidated, 0);
+
+	decompiler.clearCache();
+	ASSERT_EQ(invalidated, 1);
+}
+
+TEST(TestDeferredDecompiler, FailedBuild) {
+	std::vector<std::string> messages;
+	yagi::DeferredDecompiler decompiler([]() -> std::unique_ptr<yagi::Decompiler> {
+		throw std::runtime_error("no spec files");
+	}, std::make_unique<MockLogger>([&](const std::string& message) {
+		messages.push_back(message);
+	}));
+
+	ASSERT_FALSE(decompiler.wait());
+	ASSERT_FALSE(decompiler.decompile(0x1000).has_value());
+	ASSERT_FALSE(messages.empty());
+}
@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include "exportdatabase.hh"
+#include "exportview.hh"
+#include "exportsymbol.hh"
+#include "exporttype.hh"
+#include "exception.hh"
+#include "mock_symbol_test.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+/*!
+ * \brief	struct Node { Node* next; int value; }
+ *			Use to check that recursive types are flattened once
+ */
+class MockNodeType;
+
+class MockNodePtr : public yagi::PtrInfo
+{
+public:
+	std::unique_ptr<yagi::TypeInfo> getPointedObject() const override;
+};
+
+class MockNodePtrType : public MockTypeInfo
+{
+public:
+	MockNodePtrType()
+		: MockTypeInfo(8, "Node *", false, false, false, false, false, false, false)
+	{}
+
+	std::optional<std::unique_ptr<yagi::PtrInfo>> toPtr() const override
+	{
+		return std::make_unique<MockNodePtr>();
+	}
+};
+
+class MockNodeStruct : public yagi::StructInfo
+{
+public:
+	std::vector<yagi::TypeStructField> getFields() const override
+	{
+		std::vector<yagi::TypeStructField> fields;
+		fields.push_back(yagi::TypeStructField{ 0, "next", std::make_unique<MockNodePtrType>() });
+		fields.push_back(yagi::TypeStructField{ 8, "value", std::make_unique<MockTypeInfo>(4, "int", true, false, false, false, false, false, false) });
+		return fields;
+	}
+};
+
+class MockNodeType : public MockTypeInfo
+{
+public:
+	MockNodeType()
+		: MockTypeInfo(16, "Node", false, false, false, false, false, false, false)
+	{}
+
+	std::optional<std::unique_ptr<yagi::StructInfo>> toStruct() const override
+	{
+		return std::make_unique<MockNodeStruct>();
+	}
+};
+
+std::unique_ptr<yagi::TypeInfo> MockNodePtr::getPointedObject() const
+{
+	return std::make_unique<MockNodeType>();
+}
+
+/*!
+ * \brief	Build an export and write it
+ */
+static std::string _Write()
+{
+	yagi::ExportDatabase database(yagi::Compiler(yagi::Compiler::Language::X86_GCC, yagi::Compiler::Endianess::LE, yagi::Compiler::Mode::M64));
+
+	uint8_t code[4] = { 0x55, 0x48, 0x89, 0xe5 };
+	database.getImage().write(0x401000, code, sizeof(code));
+	database.addSegment(yagi::ExportDatabase::Segment{ 0x401000, 0x401100, ".text", yagi::exportformat::PERM_READ | yagi::exportformat::PERM_EXEC, true });
+	database.addSegment(yagi::ExportDatabase::Segment{ 0x402000, 0x402100, ".idata", yagi::exportformat::PERM_READ | yagi::exportformat::PERM_WRITE, false });
+	database.addSegment(yagi::ExportDatabase::Segment{ 0x403000, 0x403100, ".bss", yagi::exportformat::PERM_READ | yagi::exportformat::PERM_WRITE, false });
+	database.addImport(0x402008, yagi::ExportDatabase::Import{ "msvcrt", "puts" });
+
+	MockTypeInfo intType(4, "int", true, false, false, false, false, false, false);
+	MockTypeInfo funcType(8, "main_t", MockFuncInfo(false, "__fastcall", { intType, intType }, { "", "argc" }));
+	database.addTypeAt(0x401000, funcType);
+	database.addType(MockNodeType());
+
+	database.addSymbol(MockSymbolInfo(0x402000, "__imp_printf", 0, false, false, true, true));
+	database.addSymbol(MockSymbolInfo(0x402008, "__imp_puts", 0, false, false, false, false));
+	database.addSymbol(MockSymbolInfo(0x403000, "counter", 0, false, false, false, false));
+
+	MockFunctionSymbolInfo function(std::make_unique<MockSymbolInfo>(0x401000, "main", 0x20, true, false, false, false));
+	function.m_name.emplace(std::make_tuple(0x401004, "register"), std::make_tuple("counter", 0x0));
+	function.m_type.emplace(std::make_tuple(0x401008, "stack"), std::make_tuple(intType, 0x10));
+	database.addFunction(function, { { 0xfffffffffffffff8, "var_8" } });
+
+	// a function without body
+	MockFunctionSymbolInfo stub(std::make_unique<MockSymbolInfo>(0x401080, "stub", 0, true, false, false, false));
+	database.addFunction(stub, {});
+
+	std::stringstream ss;
+	database.write(ss);
+	return ss.str();
+}
+
+/*!
+ * \brief	Build an export and view it from memory
+ */
+static std::shared_ptr<const yagi::ExportView> _RoundTrip()
+{
+	auto content = _Write();
+	return yagi::ExportView::fromBuffer(std::vector<uint8_t>(content.begin(), content.end()));
+}
+
+TEST(TestExport, RoundTrip) {
+	auto view = _RoundTrip();
+
+	ASSERT_EQ(view->getCompiler().language, yagi::Compiler::Language::X86_GCC);
+	ASSERT_EQ(view->getCompiler().mode, yagi::Compiler::Mode::M64);
+
+	ASSERT_EQ(view->getFunctions().size(), 2);
+	ASSERT_NE(view->findFunction(0x40101f), nullptr);
+	ASSERT_EQ(view->findFunction(0x401020), nullptr);
+	ASSERT_EQ(view->findFunction(0x400fff), nullptr);
+	ASSERT_NE(view->findFunction(0x401080), nullptr);
+	ASSERT_EQ(view->findFunction(0x401081), nullptr);
+}
+
+TEST(TestExport, Segments) {
+	auto view = _RoundTrip();
+	ASSERT_EQ(view->getSegments().size(), 3);
+	ASSERT_EQ(view->getString(view->findSegment(0x4010ff)->name), ".text");
+	ASSERT_EQ(view->findSegment(0x401100), nullptr);
+
+	// bytes outside of loaded segments are zero
+	uint8_t buffer[8];
+	std::memset(buffer, 0xcc, sizeof(buffer));
+	ASSERT_EQ(view->read(0x400ffe, buffer, sizeof(buffer)), 6);
+	ASSERT_EQ(buffer[0], 0);
+	ASSERT_EQ(buffer[2], 0x55);
+	ASSERT_EQ(buffer[5], 0xe5);
+	ASSERT_EQ(buffer[6], 0);
+
+	ASSERT_EQ(view->read(0x403000, buffer, sizeof(buffer)), 0);
+	ASSERT_EQ(buffer[0], 0);
+}
+
+TEST(TestExport, Symbols) {
+	yagi::ExportSymbolInfoFactory factory(_RoundTrip());
+
+	auto import = factory.find(0x402000);
+	ASSERT_TRUE(import.has_value());
+	ASSERT_EQ(import.value()->getName(), "__imp_printf");
+	ASSERT_TRUE(import.value()->isImport());
+	ASSERT_FALSE(import.value()->isReadOnly());
+	ASSERT_THROW(import.value()->getFunctionSize(), yagi::SymbolIsNotAFunction);
+
+	// import state also comes from the import table
+	ASSERT_TRUE(factory.find(0x402008).value()->isImport());
+	ASSERT_FALSE(factory.find(0x403000).value()->isImport());
+
+	// unnamed function starts are found through the function table
+	auto start = factory.find(0x401000);
+	ASSERT_TRUE(start.has_value());
+	ASSERT_TRUE(start.value()->isFunction());
+	ASSERT_TRUE(start.value()->isReadOnly());
+	ASSERT_EQ(start.value()->getFunctionSize(), 0x20);
+	ASSERT_FALSE(factory.find(0x401004).has_value());
+
+	// records hold the same properties without a symbol object
+	auto record = factory.find_record(0x402000);
+	ASSERT_TRUE(record.has_value());
+	ASSERT_EQ(record.value().name, "__imp_printf");
+	ASSERT_TRUE(record.value().isImport);
+	ASSERT_EQ(record.value().getType(), import.value()->getType());
+	ASSERT_FALSE(record.value().isReadOnly);
+	ASSERT_EQ(factory.find_record(0x401000).value().getType(), yagi::SymbolInfo::Type::Function);
+	ASSERT_FALSE(factory.find_record(0x401004).has_value());
+
+	auto function = factory.find_function(0x401010);
+	ASSERT_TRUE(function.has_value());
+	ASSERT_EQ(function.value()->getSymbol().getName(), "main");
+	ASSERT_EQ(function.value()->findStackVar(0xfffffffffffffff8, 8).value(), "var_8");
+	ASSERT_EQ(function.value()->findStackVar(0xfffffff8, 4).value(), "var_8");
+	ASSERT_FALSE(function.value()->findStackVar(0xfffffff8, 8).has_value());
+
+	uint64_t offset = 0xff;
+	ASSERT_EQ(function.value()->findName(0x401004, "register", offset).value(), "counter");
+	ASSERT_EQ(offset, 0);
+	ASSERT_FALSE(function.value()->findName(0x401004, "stack", offset).has_value());
+
+	auto type = function.value()->findType(0x401008, "stack", offset);
+	ASSERT_TRUE(type.has_value());
+	ASSERT_EQ(type.value()->getName(), "int");
+	ASSERT_EQ(offset, 0x10);
+
+	auto overrides = function.value()->findLocalOverrides();
+	ASSERT_EQ(overrides.names.size(), 1);
+	ASSERT_EQ(overrides.types.size(), 1);
+
+	// leading underscores are not significant
+	auto addresses = factory.find_addresses({ "imp_puts", "counter", "main", "missing" });
+	ASSERT_EQ(addresses.size(), 3);
+	ASSERT_EQ(addresses.at("imp_puts"), 0x402008);
+	ASSERT_EQ(addresses.at("main"), 0x401000);
+}
+
+TEST(TestExport, Types) {
+	yagi::ExportTypeInfoFactory factory(_RoundTrip());
+
+	auto prototype = factory.build(0x401000);
+	ASSERT_TRUE(prototype.has_value());
+	auto func = prototype.value()->toFunc();
+	ASSERT_TRUE(func.has_value());
+	ASSERT_EQ(func.value()->getCallingConv(), "__fastcall");
+	ASSERT_EQ(func.value()->getFuncPrototype().size(), 2);
+	ASSERT_TRUE(func.value()->getFuncPrototype()[1]->isInt());
+	ASSERT_EQ(func.value()->getFuncParamName()[1], "argc");
+
+	// nested types are found by name
+	ASSERT_TRUE(factory.build("int").has_value());
+	ASSERT_FALSE(factory.build("unknown").has_value());
+
+	auto node = factory.build("Node");
+	ASSERT_TRUE(node.has_value());
+	auto fields = node.value()->toStruct().value()->getFields();
+	ASSERT_EQ(fields.size(), 2);
+	ASSERT_EQ(fields[0].name, "next");
+	auto pointed = fields[0].type->toPtr().value()->getPointedObject();
+	ASSERT_EQ(pointed->getName(), "Node");
+	ASSERT_EQ(pointed->getSize(), 16);
+}
+
+TEST(TestExport, Open) {
+	auto path = std::filesystem::temp_directory_path() / "yagi_export_test.yagi";
+	{
+		std::ofstream stream(path, std::ios::binary);
+		stream << _Write();
+	}
+
+	{
+		auto view = yagi::ExportView::open(path);
+		yagi::ExportSymbolInfoFactory factory(view);
+		ASSERT_EQ(factory.find_function(0x401000).value()->getSymbol().getName(), "main");
+
+		uint8_t buffer[4];
+		ASSERT_EQ(view->read(0x401000, buffer, sizeof(buffer)), sizeof(buffer));
+		ASSERT_EQ(buffer[1], 0x48);
+	}
+	std::filesystem::remove(path);
+
+	ASSERT_THROW(yagi::ExportView::open(path), yagi::InvalidExport);
+}
+
+TEST(TestExport, InvalidFile) {
+	ASSERT_THROW(yagi::ExportView::fromBuffer({}), yagi::InvalidExport);
+
+	std::string garbage(sizeof(yagi::exportformat::Header), 'x');
+	ASSERT_THROW(yagi::ExportView::fromBuffer(std::vector<uint8_t>(garbage.begin(), garbage.end())), yagi::InvalidExport);
+
+	// truncated export
+	yagi::ExportDatabase database(yagi::Compiler(yagi::Compiler::Language::ARM, yagi::Compiler::Endianess::BE, yagi::Compiler::Mode::M32));
+	database.addType(MockNodeType());
+	std::stringstream ss;
+	database.write(ss);
+	auto content = ss.str();
+	ASSERT_NO_THROW(yagi::ExportView::fromBuffer(std::vector<uint8_t>(content.begin(), content.end())));
+	ASSERT_THROW(yagi::ExportView::fromBuffer(std::vector<uint8_t>(content.begin(), content.begin() + content.size() / 2)), yagi::InvalidExport);
+}
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+#include "importindex.hh"
+
+TEST(TestImportIndex, FindByAddressAndName) {
+	yagi::ImportIndex index;
+	index.add(0x1000, "CreateFileW");
+	index.add(0x1008, "CloseHandle");
+
+	ASSERT_EQ(index.size(), 2);
+	ASSERT_EQ(index.find(0x1000).value(), "CreateFileW");
+	ASSERT_FALSE(index.find(0x1004).has_value());
+	ASSERT_TRUE(index.contains("CloseHandle"));
+	ASSERT_FALSE(index.contains("ReadFile"));
+}
+
+TEST(TestImportIndex, Clear) {
+	yagi::ImportIndex index;
+	index.add(0x1000, "CreateFileW");
+	index.clear();
+
+	ASSERT_EQ(index.size(), 0);
+	ASSERT_FALSE(index.find(0x1000).has_value());
+	ASSERT_FALSE(index.contains("CreateFileW"));
+}
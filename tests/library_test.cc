@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "library.hh"
+
+#include <filesystem>
+
+class CollectBatchOutput : public yagi::BatchOutput
+{
+public:
+	std::vector<uint64_t> m_written;
+
+	void write(uint64_t ea, const std::optional<yagi::Decompiler::Result>& result, double duration) override
+	{
+		m_written.push_back(ea);
+	}
+};
+
+TEST(TestLibrary, SaveAndLoad) {
+	auto directory = std::filesystem::temp_directory_path() / "yagi_library_test";
+	std::filesystem::remove_all(directory);
+	yagi::LibraryStore store(directory);
+
+	yagi::LibraryFunction memcpy{ "memcpy", 0x1234, 0x40 };
+	yagi::Decompiler::Result result("memcpy", 0x401000, "void memcpy(void) {\n  goto LAB_00401010;\n}", {
+		yagi::Decompiler::Symbol("LAB_00401010", yagi::MemoryLocation("ram", 0x401010, 4))
+	});
+	ASSERT_FALSE(store.load(0x1000, memcpy).has_value());
+	ASSERT_TRUE(store.save(memcpy, result));
+
+	// served to another database at another address
+	auto loaded = store.load(0x5000, memcpy);
+	ASSERT_TRUE(loaded.has_value());
+	ASSERT_EQ(loaded.value().ea, 0x5000);
+	ASSERT_EQ(loaded.value().name, "memcpy");
+	ASSERT_EQ(loaded.value().cCode, "void memcpy(void) {\n  goto LAB_00005010;\n}");
+	ASSERT_EQ(loaded.value().symbols[0].location.offset, 0x5010);
+
+	// another version of the function
+	ASSERT_FALSE(store.load(0x5000, yagi::LibraryFunction{ "memcpy", 0x5678, 0x40 }).has_value());
+
+	// names cleaned the same way
+	ASSERT_FALSE(store.load(0x5000, yagi::LibraryFunction{ "memcp_", 0x1234, 0x40 }).has_value());
+	ASSERT_TRUE(store.save(yagi::LibraryFunction{ "memcp?", 0x1234, 0x40 }, result));
+	ASSERT_FALSE(store.load(0x5000, yagi::LibraryFunction{ "memcp?", 0x1234, 0x40 }).has_value());
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TestLibrary, BatchOutputSavesLibraryFunctions) {
+	auto directory = std::filesystem::temp_directory_path() / "yagi_library_output_test";
+	std::filesystem::remove_all(directory);
+	yagi::LibraryStore store(directory);
+
+	CollectBatchOutput next;
+	yagi::LibraryBatchOutput output(next, store, { { 0x1000, yagi::LibraryFunction{ "strlen", 1, 0x10 } } });
+	output.write(0x1000, yagi::Decompiler::Result("strlen", 0x1000, "int strlen(void) {}", {}), 1.0);
+	output.write(0x2000, yagi::Decompiler::Result("func", 0x2000, "void func(void) {}", {}), 1.0);
+	output.write(0x3000, std::nullopt, 1.0);
+
+	ASSERT_EQ(next.m_written, std::vector<uint64_t>({ 0x1000, 0x2000, 0x3000 }));
+	ASSERT_TRUE(store.load(0x1000, yagi::LibraryFunction{ "strlen", 1, 0x10 }).has_value());
+	ASSERT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include "linestore.hh"
+
+TEST(TestLineStore, SplitOnNewLines) {
+	yagi::LineStore store("int f()\n{\n\treturn 0;\n}");
+
+	ASSERT_EQ(store.size(), 4);
+	ASSERT_EQ(store.getLine(0), "int f()");
+	ASSERT_EQ(store.getLine(1), "{");
+	ASSERT_EQ(store.getLine(2), "\treturn 0;");
+	ASSERT_EQ(store.getLine(3), "}");
+}
+
+TEST(TestLineStore, TrailingNewLineHasNoLine) {
+	yagi::LineStore store("a\n\nb\n");
+
+	ASSERT_EQ(store.size(), 3);
+	ASSERT_EQ(store.getLine(1), "");
+	ASSERT_EQ(store.getLine(2), "b");
+}
+
+TEST(TestLineStore, EmptyTextHasOneLine) {
+	yagi::LineStore store;
+
+	ASSERT_EQ(store.size(), 1);
+	ASSERT_EQ(store.getLine(0), "");
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "ringlogger.hh"
+#include "mock_logger_test.h"
+
+#include <vector>
+
+TEST(TestLogger, DropMessagesUnderLevel) {
+	std::vector<std::string> messages;
+	MockLogger logger([&](const std::string& message) {
+		messages.push_back(message);
+	});
+
+	logger.setLevel(yagi::LogLevel::Info);
+	logger.trace("trace");
+	logger.debug("debug");
+	logger.info("info", 42);
+	logger.error("error", std::string("parameter"));
+
+	ASSERT_EQ(messages.size(), 2);
+	ASSERT_EQ(messages[0], "[Yagi] INFO :  info 42\n");
+	ASSERT_EQ(messages[1], "[Yagi] ERROR :  error parameter\n");
+
+	logger.setLevel(yagi::LogLevel::Off);
+	logger.error("error");
+	ASSERT_EQ(messages.size(), 2);
+}
+
+TEST(TestRingLogger, KeepLastMessages) {
+	yagi::RingLogger logger(nullptr, 2, 0);
+	logger.info("first");
+	logger.info("second");
+	logger.info("third");
+
+	auto recent = logger.recent();
+	ASSERT_EQ(recent.size(), 2);
+	ASSERT_EQ(recent[0], "[Yagi] INFO :  second\n");
+	ASSERT_EQ(recent[1], "[Yagi] INFO :  third\n");
+}
+
+TEST(TestRingLogger, RateLimitForwardedMessages) {
+	size_t printed = 0;
+	yagi::RingLogger logger(std::make_unique<MockLogger>([&](const std::string&) {
+		printed++;
+	}), 16, 3);
+
+	for (int i = 0; i < 10; i++)
+	{
+		logger.info("message");
+	}
+
+	// all messages are kept even if not forwarded
+	ASSERT_EQ(printed, 3);
+	ASSERT_EQ(logger.recent().size(), 10);
+}
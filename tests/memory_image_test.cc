@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "memoryimage.hh"
+
+TEST(TestMemoryImage, ReadWriteAcrossPages) {
+	yagi::MemoryImage image;
+
+	std::vector<uint8_t> data(0x1800);
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<uint8_t>(i);
+	}
+	image.write(0x400ff0, data.data(), data.size());
+
+	// 3 pages are mapped
+	ASSERT_EQ(image.size(), 3 * yagi::MemoryImage::PAGE_SIZE);
+
+	std::vector<uint8_t> buffer(0x20);
+	ASSERT_EQ(image.read(0x400ff0, buffer.data(), buffer.size()), buffer.size());
+	ASSERT_TRUE(std::equal(buffer.begin(), buffer.end(), data.begin()));
+}
+
+TEST(TestMemoryImage, UnmappedBytesAreZero) {
+	yagi::MemoryImage image;
+
+	uint8_t data[4] = { 0xde, 0xad, 0xbe, 0xef };
+	image.write(0x1ffe, data, sizeof(data));
+
+	// read before the mapped range, crossing an unmapped page
+	uint8_t buffer[8];
+	memset(buffer, 0xff, sizeof(buffer));
+	ASSERT_EQ(image.read(0xffc, buffer, sizeof(buffer)), 4);
+	for (auto value : buffer)
+	{
+		ASSERT_EQ(value, 0);
+	}
+
+	ASSERT_EQ(image.read(0x1ffc, buffer, 8), 8);
+	ASSERT_EQ(buffer[2], 0xde);
+	ASSERT_EQ(buffer[5], 0xef);
+}
+
+TEST(TestMemoryImage, OverwriteSharedPage) {
+	yagi::MemoryImage image;
+
+	uint8_t first[2] = { 1, 2 };
+	uint8_t second[2] = { 3, 4 };
+	image.write(0x1000, first, 2);
+	image.write(0x1001, second, 2);
+
+	ASSERT_EQ(image.size(), yagi::MemoryImage::PAGE_SIZE);
+
+	uint8_t buffer[3];
+	image.read(0x1000, buffer, 3);
+	ASSERT_EQ(buffer[0], 1);
+	ASSERT_EQ(buffer[1], 3);
+	ASSERT_EQ(buffer[2], 4);
+
+	image.clear();
+	ASSERT_EQ(image.size(), 0);
+	ASSERT_EQ(image.read(0x1000, buffer, 3), 0);
+}
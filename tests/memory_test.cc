@@ -0,0 +1,22 @@
+#include <gtest/gtest.h>
+#include "memory.hh"
+
+#include <vector>
+
+TEST(TestMemory, ProcessMemory) {
+	auto before = yagi::getProcessMemory();
+	ASSERT_TRUE(before.has_value());
+	ASSERT_GT(before.value(), 0);
+
+	// touched pages are resident
+	std::vector<char> buffer(64 * 1024 * 1024, 1);
+	auto after = yagi::getProcessMemory();
+	ASSERT_TRUE(after.has_value());
+	ASSERT_GT(after.value(), before.value());
+	ASSERT_EQ(buffer.back(), 1);
+}
+
+TEST(TestMemory, Format) {
+	ASSERT_EQ(yagi::formatMemory(1024 * 1024), "1.0 MiB");
+	ASSERT_EQ(yagi::formatMemory(3 * 512 * 1024), "1.5 MiB");
+}
@@ -5,20 +5,25 @@
 #include "mock_type_test.h"
 #include "base.hh"
 #include <functional>
+#include <map>
 #include <optional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 using MockSymbolInfoFactoryFind = std::function<std::optional<std::unique_ptr<yagi::SymbolInfo>>(uint64_t)>;
 using MockSymbolInfoFactoryFindFunction = std::function<std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>>(uint64_t)>;
+using MockSymbolInfoFactoryAddresses = std::unordered_map<std::string, uint64_t>;
 class MockSymbolInfoFactory : public yagi::SymbolInfoFactory
 {
 protected:
 	MockSymbolInfoFactoryFind m_findCallback;
 	MockSymbolInfoFactoryFindFunction m_findFunctionCallback;
+	MockSymbolInfoFactoryAddresses m_addresses;
 
 public:
-	explicit MockSymbolInfoFactory(MockSymbolInfoFactoryFind findCallback, MockSymbolInfoFactoryFindFunction findFunctionCallback)
-		: m_findCallback { findCallback }, m_findFunctionCallback { findFunctionCallback }
+	explicit MockSymbolInfoFactory(MockSymbolInfoFactoryFind findCallback, MockSymbolInfoFactoryFindFunction findFunctionCallback, MockSymbolInfoFactoryAddresses addresses = {})
+		: m_findCallback { findCallback }, m_findFunctionCallback { findFunctionCallback }, m_addresses{ std::move(addresses) }
 	{}
 
 	std::optional<std::unique_ptr<yagi::SymbolInfo>> find(uint64_t ea) override
@@ -30,6 +35,20 @@ public:
 	{
 		return m_findFunctionCallback(ea);
 	}
+
+	std::unordered_map<std::string, uint64_t> find_addresses(const std::vector<std::string>& names) override
+	{
+		std::unordered_map<std::string, uint64_t> result;
+		for (auto& name : names)
+		{
+			auto found = m_addresses.find(name);
+			if (found != m_addresses.end())
+			{
+				result.emplace(name, found->second);
+			}
+		}
+		return result;
+	}
 };
 
 class MockSymbolInfo : public yagi::SymbolInfo
@@ -78,8 +97,10 @@ public:
 class MockFunctionSymbolInfo : public yagi::FunctionSymbolInfo
 {
 public:
-	std::map<std::string, std::tuple<std::string, uint64_t>> m_name;
-	std::map<std::string, std::tuple<MockTypeInfo, uint64_t>> m_type;
+	// indexed by pc and space name
+	std::map<std::tuple<uint64_t, std::string>, std::tuple<std::string, uint64_t>> m_name;
+	std::map<std::tuple<uint64_t, std::string>, std::tuple<MockTypeInfo, uint64_t>> m_type;
+	yagi::FlowHints m_flow;
 
 	explicit MockFunctionSymbolInfo(std::unique_ptr<yagi::SymbolInfo> symbol)
 		: yagi::FunctionSymbolInfo{ std::move(symbol) }
@@ -93,10 +114,7 @@ public:
 
 	std::optional<std::string> findName(uint64_t pc, const std::string& space, uint64_t& offset) override
 	{
-		std::stringstream ss;
-		ss << yagi::to_hex(pc) << "." << space;
-
-		auto iter = m_name.find(ss.str());
+		auto iter = m_name.find(std::make_tuple(pc, space));
 		if (iter == m_name.end())
 		{
 			return std::nullopt;
@@ -108,16 +126,12 @@ public:
 
 	void saveName(const yagi::MemoryLocation& loc, const std::string& value)  override
 	{
-		std::stringstream ss;
-		ss << yagi::to_hex(loc.pc.front()) << "." << loc.spaceName;
-		m_name.emplace(ss.str(), std::make_tuple(value, loc.offset));
+		m_name.emplace(std::make_tuple(loc.pc.front(), loc.spaceName), std::make_tuple(value, loc.offset));
 	}
 
 	void saveType(const yagi::MemoryLocation& loc, const yagi::TypeInfo& newType) override
 	{
-		std::stringstream ss;
-		ss << yagi::to_hex(loc.pc.front()) << "." << loc.spaceName;
-		m_type.emplace(ss.str(), std::make_tuple(MockTypeInfo(newType.getSize(), newType.getName(), newType.isInt(), newType.isBool(), newType.isFloat(), newType.isVoid(), newType.isConst(), newType.isChar(), newType.isUnicode()), loc.offset));
+		m_type.emplace(std::make_tuple(loc.pc.front(), loc.spaceName), std::make_tuple(MockTypeInfo(newType.getSize(), newType.getName(), newType.isInt(), newType.isBool(), newType.isFloat(), newType.isVoid(), newType.isConst(), newType.isChar(), newType.isUnicode()), loc.offset));
 	}
 
 	bool clearType(const yagi::MemoryLocation& loc)
@@ -127,10 +141,7 @@ public:
 
 	std::optional<std::unique_ptr<yagi::TypeInfo>> findType(uint64_t pc, const std::string& from, uint64_t& offset) override
 	{
-		std::stringstream ss;
-		ss << yagi::to_hex(pc) << "." << from;
-
-		auto iter = m_type.find(ss.str());
+		auto iter = m_type.find(std::make_tuple(pc, from));
 		if (iter == m_type.end())
 		{
 			return std::nullopt;
@@ -138,6 +149,53 @@ public:
 		offset = std::get<1>(iter->second);
 		return std::make_unique<MockTypeInfo>(std::get<0>(iter->second));
 	}
+
+	yagi::LocalOverrides findLocalOverrides() override
+	{
+		yagi::LocalOverrides overrides;
+		for (auto& name : m_name)
+		{
+			overrides.names.emplace(std::get<0>(name.first), yagi::NameOverride{ std::get<1>(name.first), std::get<1>(name.second), std::get<0>(name.second) });
+		}
+		for (auto& type : m_type)
+		{
+			overrides.types.emplace(std::get<0>(type.first), yagi::TypeOverride{ std::get<1>(type.first), std::get<1>(type.second), std::make_unique<MockTypeInfo>(std::get<0>(type.second)) });
+		}
+		return overrides;
+	}
+
+	yagi::FlowHints findFlowHints() override
+	{
+		return m_flow;
+	}
+
+	uint64_t getContentHash() override
+	{
+		auto hash = yagi::fnv1a_string(m_symbol->getName());
+		for (auto& name : m_name)
+		{
+			hash = yagi::fnv1a(&std::get<0>(name.first), sizeof(uint64_t), hash);
+			hash = yagi::fnv1a_string(std::get<1>(name.first), hash);
+			hash = yagi::fnv1a_string(std::get<0>(name.second), hash);
+		}
+		for (auto& type : m_type)
+		{
+			hash = yagi::fnv1a(&std::get<0>(type.first), sizeof(uint64_t), hash);
+			hash = yagi::fnv1a_string(std::get<1>(type.first), hash);
+			hash = yagi::fnv1a_string(std::get<0>(type.second).getName(), hash);
+		}
+		return hash;
+	}
+
+	uint64_t getCloneHash() override
+	{
+		return 0;
+	}
+
+	bool isLibrary() override
+	{
+		return false;
+	}
 };
 
 #endif
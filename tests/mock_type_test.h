@@ -29,6 +29,9 @@ public:
 	{
 		return m_findNameCallback(name);
 	}
+
+	void invalidate(const std::string& name) override {}
+	void invalidateAll() override {}
 };
 
 class MockTypeInfo;
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "multiarch.hh"
+#include "mock_logger_test.h"
+
+/*!
+ * \brief	Decompiler that return its name as code
+ */
+class NamedDecompiler : public yagi::Decompiler
+{
+public:
+	std::string m_name;
+	size_t& m_cleared;
+
+	explicit NamedDecompiler(std::string name, size_t& cleared)
+		: m_name{ std::move(name) }, m_cleared{ cleared }
+	{}
+
+	std::optional<Result> decompile(uint64_t funcAddress) override
+	{
+		return Result("func", funcAddress, m_name, {});
+	}
+
+	std::optional<Result> refreshNames(uint64_t funcAddress) override
+	{
+		return decompile(funcAddress);
+	}
+
+	void invalidate(uint64_t funcAddress) override {}
+	void invalidateDependents(uint64_t ea) override {}
+	void invalidateCode(uint64_t ea) override {}
+	void clearCache() override { m_cleared++; }
+	void invalidateType(const std::string& name) override {}
+	void invalidateTypes() override {}
+	void retain(uint64_t funcAddress) override {}
+	void release(uint64_t funcAddress) override {}
+	void setCancelToken(std::shared_ptr<const yagi::CancelToken> token) override {}
+	void setProfileOutput(std::shared_ptr<yagi::ProfileOutput> output) override {}
+	size_t prewarmTypes(yagi::TypeInfoFactory& source, const std::vector<std::string>& names) override { return 0; }
+};
+
+static const yagi::Compiler ARM_COMPILER(yagi::Compiler::Language::ARM, yagi::Compiler::Endianess::LE, yagi::Compiler::Mode::M32);
+
+TEST(TestMultiArchDecompiler, BuildOnFirstUse) {
+	size_t built = 0;
+	size_t cleared = 0;
+
+	// odd addresses are thumb functions
+	yagi::MultiArchDecompiler decompiler(
+		ARM_COMPILER,
+		std::make_unique<NamedDecompiler>("arm", cleared),
+		[](uint64_t ea) {
+			auto compiler = ARM_COMPILER;
+			if (ea % 2 != 0)
+			{
+				compiler.isa = yagi::Compiler::Isa::Thumb;
+			}
+			return compiler;
+		},
+		[&](const yagi::Compiler& compiler) -> std::optional<std::unique_ptr<yagi::Decompiler>> {
+			built++;
+			return std::make_unique<NamedDecompiler>("thumb", cleared);
+		},
+		std::make_unique<MockLogger>([](const std::string&) {})
+	);
+
+	ASSERT_EQ(decompiler.decompile(0x1000).value().cCode, "arm");
+	ASSERT_EQ(built, 0);
+	ASSERT_EQ(decompiler.size(), 1);
+
+	ASSERT_EQ(decompiler.decompile(0x1001).value().cCode, "thumb");
+	ASSERT_EQ(decompiler.decompile(0x1003).value().cCode, "thumb");
+	ASSERT_EQ(built, 1);
+	ASSERT_EQ(decompiler.size(), 2);
+
+	decompiler.clearCache();
+	ASSERT_EQ(cleared, 2);
+}
+
+TEST(TestMultiArchDecompiler, FailedBuildIsNotRetried) {
+	size_t built = 0;
+	size_t cleared = 0;
+
+	yagi::MultiArchDecompiler decompiler(
+		ARM_COMPILER,
+		std::make_unique<NamedDecompiler>("arm", cleared),
+		[](uint64_t ea) {
+			auto compiler = ARM_COMPILER;
+			compiler.isa = yagi::Compiler::Isa::Thumb;
+			return compiler;
+		},
+		[&](const yagi::Compiler& compiler) -> std::optional<std::unique_ptr<yagi::Decompiler>> {
+			built++;
+			return std::nullopt;
+		},
+		std::make_unique<MockLogger>([](const std::string&) {})
+	);
+
+	ASSERT_FALSE(decompiler.decompile(0x1001).has_value());
+	ASSERT_FALSE(decompiler.decompile(0x1001).has_value());
+	ASSERT_EQ(built, 1);
+
+	// failed builds are skipped
+	decompiler.clearCache();
+	ASSERT_EQ(cleared, 1);
+}
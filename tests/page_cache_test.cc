@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "pagecache.hh"
+
+/*!
+ * \brief	Backend where each byte is the low byte of its address
+ *			Records every read
+ */
+struct CountingBackend
+{
+	std::vector<std::pair<uint64_t, size_t>> reads;
+
+	yagi::PageCache::Fetch fetch()
+	{
+		return [this](uint64_t ea, uint8_t* buffer, size_t size) {
+			reads.push_back({ ea, size });
+			for (size_t i = 0; i < size; i++)
+			{
+				buffer[i] = static_cast<uint8_t>(ea + i);
+			}
+		};
+	}
+};
+
+TEST(TestPageCache, SmallReadsFetchPageOnce) {
+	yagi::PageCache cache(16);
+	CountingBackend backend;
+
+	uint8_t buffer[32];
+	for (uint64_t ea = 0x401000; ea < 0x401800; ea += sizeof(buffer))
+	{
+		cache.read(backend.fetch(), ea, buffer, sizeof(buffer));
+		ASSERT_EQ(buffer[0], static_cast<uint8_t>(ea));
+		ASSERT_EQ(buffer[31], static_cast<uint8_t>(ea + 31));
+	}
+
+	ASSERT_EQ(backend.reads.size(), 1);
+	ASSERT_EQ(backend.reads[0].first, 0x401000);
+	ASSERT_EQ(backend.reads[0].second, yagi::PageCache::PAGE_SIZE);
+}
+
+TEST(TestPageCache, MissingRangeIsFetchedAtOnce) {
+	yagi::PageCache cache(16);
+	CountingBackend backend;
+
+	// the middle page is already cached
+	uint8_t byte;
+	cache.read(backend.fetch(), 0x402010, &byte, 1);
+
+	std::vector<uint8_t> buffer(0x4000);
+	cache.read(backend.fetch(), 0x400ff0, buffer.data(), buffer.size());
+	for (size_t i = 0; i < buffer.size(); i++)
+	{
+		ASSERT_EQ(buffer[i], static_cast<uint8_t>(0x400ff0 + i));
+	}
+
+	// one read before and one after the cached page
+	ASSERT_EQ(backend.reads.size(), 3);
+	ASSERT_EQ(backend.reads[1].first, 0x400000);
+	ASSERT_EQ(backend.reads[1].second, 2 * yagi::PageCache::PAGE_SIZE);
+	ASSERT_EQ(backend.reads[2].first, 0x403000);
+	ASSERT_EQ(backend.reads[2].second, 2 * yagi::PageCache::PAGE_SIZE);
+	ASSERT_EQ(cache.size(), 5);
+}
+
+TEST(TestPageCache, InvalidateForgetsPatchedPages) {
+	yagi::PageCache cache(16);
+	CountingBackend backend;
+
+	uint8_t buffer[4];
+	cache.read(backend.fetch(), 0x401000, buffer, sizeof(buffer));
+	cache.read(backend.fetch(), 0x402000, buffer, sizeof(buffer));
+	ASSERT_EQ(cache.size(), 2);
+
+	cache.invalidate(0x401ffe, 1);
+	ASSERT_EQ(cache.size(), 1);
+
+	cache.read(backend.fetch(), 0x401000, buffer, sizeof(buffer));
+	ASSERT_EQ(backend.reads.size(), 3);
+
+	cache.clear();
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestPageCache, PagesFetchedDuringInvalidationAreNotKept) {
+	yagi::PageCache cache(16);
+
+	// the byte is patched while the backend reads it
+	uint8_t byte;
+	cache.read([&cache](uint64_t ea, uint8_t* buffer, size_t size) {
+		cache.invalidate(ea, 1);
+	}, 0x401000, &byte, 1);
+
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestPageCache, FullCacheIsEmptied) {
+	yagi::PageCache cache(2);
+	CountingBackend backend;
+
+	uint8_t byte;
+	cache.read(backend.fetch(), 0x401000, &byte, 1);
+	cache.read(backend.fetch(), 0x402000, &byte, 1);
+	cache.read(backend.fetch(), 0x403000, &byte, 1);
+	ASSERT_EQ(cache.size(), 1);
+
+	// larger than the cache, read but not kept
+	std::vector<uint8_t> buffer(0x3000);
+	cache.read(backend.fetch(), 0x410000, buffer.data(), buffer.size());
+	ASSERT_EQ(buffer[0x2fff], static_cast<uint8_t>(0x412fff));
+	ASSERT_EQ(cache.size(), 1);
+}
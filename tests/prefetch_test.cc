@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "prefetch.hh"
+
+/*!
+ * \brief	Result calling 0x2000 twice, reading 0x3000 then calling 0x4000
+ */
+static yagi::Decompiler::Result _BuildResult()
+{
+	std::vector<yagi::Decompiler::Symbol> symbols;
+	symbols.emplace_back("func_2000", yagi::MemoryLocation("ram", 0x2000, 8));
+	symbols.emplace_back("data_3000", yagi::MemoryLocation("ram", 0x3000, 8));
+	symbols.emplace_back("func_4000", yagi::MemoryLocation("ram", 0x4000, 8));
+	symbols.emplace_back("local_10", yagi::MemoryLocation("stack", 0x10, 8));
+	symbols.emplace_back("func_1000", yagi::MemoryLocation("ram", 0x1000, 8));
+
+	std::vector<yagi::Decompiler::Token> tokens = {
+		{ 0, 5, 14, 4 },
+		{ 2, 2, 11, 0 },
+		{ 3, 2, 10, 3 },
+		{ 3, 13, 22, 1 },
+		{ 4, 2, 11, 0 },
+		{ 5, 2, 11, 2 },
+	};
+
+	return yagi::Decompiler::Result("func_1000", 0x1000, "", symbols, tokens);
+}
+
+static bool _IsFunction(uint64_t ea)
+{
+	return ea != 0x3000;
+}
+
+TEST(TestPrefetcher, ScheduleCalleesInOrder) {
+	yagi::Prefetcher prefetcher(4);
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.size(), 2);
+
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+	ASSERT_EQ(prefetcher.next(), 0x4000);
+	ASSERT_EQ(prefetcher.next(), std::nullopt);
+	ASSERT_TRUE(prefetcher.empty());
+}
+
+TEST(TestPrefetcher, Limit) {
+	yagi::Prefetcher prefetcher(1);
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+	ASSERT_TRUE(prefetcher.empty());
+
+	yagi::Prefetcher disabled(0);
+	disabled.schedule(_BuildResult(), _IsFunction);
+	ASSERT_FALSE(disabled.push(0x5000));
+	ASSERT_TRUE(disabled.empty());
+}
+
+TEST(TestPrefetcher, NeverTwice) {
+	yagi::Prefetcher prefetcher(4);
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+
+	// already prefetched, or the current function
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.next(), 0x4000);
+	ASSERT_FALSE(prefetcher.push(0x1000));
+	ASSERT_TRUE(prefetcher.push(0x5000));
+	ASSERT_EQ(prefetcher.next(), 0x5000);
+
+	// cache cleared
+	prefetcher.reset();
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+}
+
+TEST(TestPrefetcher, ForgetCanceled) {
+	yagi::Prefetcher prefetcher(4);
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+
+	// the job of 0x2000 is canceled, 0x4000 is dropped
+	prefetcher.clear();
+	prefetcher.forget(0x2000);
+	ASSERT_TRUE(prefetcher.empty());
+
+	prefetcher.schedule(_BuildResult(), _IsFunction);
+	ASSERT_EQ(prefetcher.next(), 0x2000);
+	ASSERT_EQ(prefetcher.next(), 0x4000);
+}
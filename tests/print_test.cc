@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "print.hh"
+
+TEST(TestPrint, RemoveColorTags) {
+	ASSERT_EQ(yagi::removeColorTags("\1\x20int\2\x20 \1\x0F" "a\2\x0F;"), "int a;");
+}
+
+TEST(TestPrint, IndexSymbolTokens) {
+	// int func(void) {\n   var = 1;\n}
+	std::string code =
+		"\1\x20int\2\x20 \1\x01" "func\2\x01(\1\x20void\2\x20) {\n"
+		"   \1\x0Fvar\2\x0F = \1\x20" "1\2\x20;\n"
+		"}";
+
+	// one id per tag, func is 0 and var is 1
+	auto none = yagi::SymbolIndex::NO_SYMBOL;
+	auto tokens = yagi::indexTokens(code, { { 0, 0, 0, none }, { 0, 0, 0, 0 }, { 0, 0, 0, none }, { 0, 0, 0, 1 }, { 0, 0, 0, none } }, false);
+
+	ASSERT_EQ(tokens.size(), 2);
+	ASSERT_EQ(tokens[0].line, 0);
+	ASSERT_EQ(tokens[0].start, 4);
+	ASSERT_EQ(tokens[0].end, 8);
+	ASSERT_EQ(tokens[0].symbol, 0);
+
+	ASSERT_EQ(tokens[1].line, 1);
+	ASSERT_EQ(tokens[1].start, 3);
+	ASSERT_EQ(tokens[1].end, 6);
+	ASSERT_EQ(tokens[1].symbol, 1);
+}
+
+TEST(TestPrint, IndexTokenStream) {
+	std::string code = "\1\x20int\2\x20 \1\x0F" "a\2\x0F;";
+
+	auto none = yagi::SymbolIndex::NO_SYMBOL;
+	auto tokens = yagi::indexTokens(code, {
+		{ 0, 0, 0, none, yagi::Decompiler::TokenKind::Type, 2 },
+		{ 0, 0, 0, 0, yagi::Decompiler::TokenKind::Variable, 4 }
+	}, true);
+
+	ASSERT_EQ(tokens.size(), 2);
+	ASSERT_EQ(tokens[0].start, 0);
+	ASSERT_EQ(tokens[0].end, 3);
+	ASSERT_EQ(tokens[0].symbol, none);
+	ASSERT_EQ(tokens[0].kind, yagi::Decompiler::TokenKind::Type);
+	ASSERT_EQ(tokens[0].highlight, 2);
+
+	ASSERT_EQ(tokens[1].start, 4);
+	ASSERT_EQ(tokens[1].end, 5);
+	ASSERT_EQ(tokens[1].symbol, 0);
+	ASSERT_EQ(tokens[1].kind, yagi::Decompiler::TokenKind::Variable);
+}
+
+TEST(TestPrint, RebaseResult) {
+	// void FUN_00401000(void) {\n  goto LAB_00401010;\n  DAT_00403000 = 0x401010;\n  y = 0x403000;\n}
+	std::string code =
+		"void \1\x01" "FUN_00401000\2\x01(void) {\n"
+		"  goto \1\x0F" "LAB_00401010\2\x0F; \1\x0F" "x\2\x0F;\n"
+		"  \1\x0F" "DAT_00403000\2\x0F = 0x401010; \1\x0F" "y\2\x0F;\n"
+		"  \1\x0F" "z\2\x0F = 0x403000;\n"
+		"}";
+
+	auto none = yagi::SymbolIndex::NO_SYMBOL;
+	yagi::Decompiler::Result result("FUN_00401000", 0x401000, code, {
+		yagi::Decompiler::Symbol("LAB_00401010", yagi::MemoryLocation("ram", 0x401010, 8)),
+		yagi::Decompiler::Symbol("DAT_00403000", yagi::MemoryLocation("ram", 0x403000, 8))
+	}, {
+		{ 0, 5, 17, none },
+		{ 1, 7, 19, 0 },
+		{ 1, 21, 22, none },
+		{ 2, 2, 14, 1 },
+		{ 2, 27, 28, none },
+		{ 3, 2, 3, none }
+	});
+	result.dependencies.addresses = { 0x401010, 0x403000 };
+
+	auto rebased = yagi::rebaseResult(result, 0x401000, 0x20, 0x10500000, "clone");
+
+	ASSERT_EQ(rebased.ea, 0x10500000);
+	ASSERT_EQ(rebased.name, "clone");
+	ASSERT_EQ(yagi::removeColorTags(rebased.cCode),
+		"void clone(void) {\n"
+		"  goto LAB_10500010; x;\n"
+		"  DAT_00403000 = 0x10500010; y;\n"
+		"  z = 0x403000;\n"
+		"}");
+
+	// the name is shorter, the label keeps its width
+	ASSERT_EQ(rebased.tokens[0].start, 5);
+	ASSERT_EQ(rebased.tokens[0].end, 10);
+	ASSERT_EQ(rebased.tokens[1].start, 7);
+	ASSERT_EQ(rebased.tokens[1].end, 19);
+	ASSERT_EQ(rebased.tokens[2].start, 21);
+
+	// a constant into the function is moved, others are kept
+	ASSERT_EQ(rebased.tokens[4].start, 29);
+	ASSERT_EQ(rebased.tokens[4].end, 30);
+	ASSERT_EQ(rebased.tokens[5].start, 2);
+
+	ASSERT_EQ(rebased.symbols[0].name, "LAB_10500010");
+	ASSERT_EQ(rebased.symbols[0].location.offset, 0x10500010);
+	ASSERT_EQ(rebased.symbols[1].name, "DAT_00403000");
+	ASSERT_EQ(rebased.symbols[1].location.offset, 0x403000);
+
+	ASSERT_EQ(rebased.dependencies.addresses, std::vector<uint64_t>({ 0x403000, 0x10500010 }));
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include "profile.hh"
+
+#include <sstream>
+#include <thread>
+
+TEST(TestProfile, ScopeWithoutProfile) {
+	ASSERT_EQ(yagi::Profile::current(), nullptr);
+	{
+		// nothing to account, must not crash
+		yagi::ProfileScope scope("backend", "find");
+	}
+	ASSERT_EQ(yagi::Profile::current(), nullptr);
+}
+
+TEST(TestProfile, Session) {
+	yagi::Profile outer(0x1000);
+	yagi::Profile inner(0x2000);
+	{
+		yagi::ProfileSession outerSession(outer);
+		{
+			yagi::ProfileSession innerSession(inner);
+			ASSERT_EQ(yagi::Profile::current(), &inner);
+			yagi::ProfileScope scope("backend", "find");
+		}
+		ASSERT_EQ(yagi::Profile::current(), &outer);
+
+		// other threads are not profiled
+		bool profiled = true;
+		std::thread([&profiled]() { profiled = yagi::Profile::current() != nullptr; }).join();
+		ASSERT_FALSE(profiled);
+	}
+	ASSERT_EQ(yagi::Profile::current(), nullptr);
+
+	ASSERT_EQ(inner.getTimings().at("backend").at("find").calls, 1);
+	ASSERT_TRUE(outer.getTimings().empty());
+}
+
+TEST(TestProfile, Marks) {
+	yagi::Profile profile(0x1000);
+	profile.mark("heritage");
+	profile.mark("deadcode");
+	profile.mark("heritage");
+	profile.close();
+
+	auto& actions = profile.getTimings().at(yagi::Profile::ACTIONS);
+	ASSERT_EQ(actions.at("heritage").calls, 2);
+	ASSERT_EQ(actions.at("deadcode").calls, 1);
+	ASSERT_TRUE(profile.getMilliseconds().has_value());
+
+	// closed, nothing more is accounted
+	profile.close();
+	ASSERT_EQ(actions.at("heritage").calls, 2);
+}
+
+TEST(TestProfile, Statistics) {
+	yagi::Profile profile(0x1000);
+	std::stringstream ss;
+	ss << "universal Tested=1 Applied=1" << std::endl;
+	ss << "oppool1 Tested=20 Applied=3" << std::endl;
+	ss << "windowscfg Tested=12 Applied=2" << std::endl;
+	ss << "garbage" << std::endl;
+	ss << "windowscfg Tested=3 Applied=1" << std::endl;
+	profile.addStatistics(ss);
+
+	auto& statistics = profile.getStatistics();
+	ASSERT_EQ(statistics.size(), 3);
+	ASSERT_EQ(statistics.at("oppool1").tested, 20);
+	ASSERT_EQ(statistics.at("windowscfg").tested, 15);
+	ASSERT_EQ(statistics.at("windowscfg").applied, 3);
+}
+
+static size_t s_allocations = 0;
+static size_t _CountAllocations()
+{
+	return s_allocations;
+}
+
+TEST(TestProfile, Json) {
+	yagi::Profile::setAllocationCounter(_CountAllocations);
+	s_allocations = 10;
+	yagi::Profile profile(0x1000);
+	s_allocations = 15;
+
+	profile.setName("my \"func\"");
+	profile.add("backend", "SymbolInfoFactory::find", 1.5);
+	std::stringstream stats("rename Tested=1 Applied=0\n");
+	profile.addStatistics(stats);
+	profile.setCounter(yagi::Profile::OPS, 42);
+	profile.close();
+	yagi::Profile::setAllocationCounter(nullptr);
+
+	ASSERT_EQ(profile.getAllocations().value(), 5);
+
+	std::stringstream ss;
+	profile.writeJson(ss);
+	auto json = ss.str();
+
+	ASSERT_NE(json.find("\"address\": \"0x1000\""), std::string::npos);
+	ASSERT_NE(json.find("\"name\": \"my \\\"func\\\"\""), std::string::npos);
+	ASSERT_NE(json.find("\"allocations\": 5"), std::string::npos);
+	ASSERT_NE(json.find("\"counters\": { \"ops\": 42 }"), std::string::npos);
+	ASSERT_NE(json.find("\"SymbolInfoFactory::find\": { \"calls\": 1, \"milliseconds\": 1.500 }"), std::string::npos);
+	ASSERT_NE(json.find("\"rename\": { \"tested\": 1, \"applied\": 0 }"), std::string::npos);
+}
+
+TEST(TestProfile, Summary) {
+	auto next = std::make_shared<yagi::SummaryProfileOutput>();
+	yagi::SummaryProfileOutput summary(next);
+
+	yagi::Profile fast(0x1000);
+	fast.setName("fast");
+	fast.setCounter(yagi::Profile::OPS, 10);
+	fast.add(yagi::Profile::BACKEND, "SymbolInfoFactory::find", 1);
+	fast.add(yagi::Profile::BACKEND, "TypeInfoFactory::build", 1);
+	fast.close();
+
+	yagi::Profile slow(0x2000);
+	slow.setName("slow, \"big\"");
+	slow.setCounter(yagi::Profile::OPS, 500);
+	slow.setCounter(yagi::Profile::OPS, 200);
+	std::stringstream stats("oppool1 Tested=20 Applied=3\nwindowscfg Tested=12 Applied=2\n");
+	slow.addStatistics(stats);
+	slow.close();
+
+	summary.write(slow);
+	summary.write(fast);
+
+	// profiles are forwarded
+	ASSERT_EQ(next->getRows(yagi::SummaryProfileOutput::Column::Address).size(), 2);
+
+	auto rows = summary.getRows(yagi::SummaryProfileOutput::Column::Address);
+	ASSERT_EQ(rows[0].ea, 0x1000);
+	ASSERT_EQ(rows[0].backend, 2);
+	ASSERT_EQ(rows[1].ops, 500);
+	ASSERT_EQ(rows[1].applied, 5);
+
+	rows = summary.getRows(yagi::SummaryProfileOutput::Column::Ops);
+	ASSERT_EQ(rows[0].ea, 0x2000);
+	rows = summary.getRows(yagi::SummaryProfileOutput::Column::Backend);
+	ASSERT_EQ(rows[0].ea, 0x1000);
+
+	std::stringstream ss;
+	summary.writeCsv(ss, yagi::SummaryProfileOutput::Column::Ops);
+	std::string header, first;
+	std::getline(ss, header);
+	std::getline(ss, first);
+	ASSERT_EQ(header, "address,name,milliseconds,memory,ops,varnodes,blocks,applied,backend");
+	ASSERT_EQ(first.rfind("0x2000,\"slow, \"\"big\"\"\",", 0), 0);
+	ASSERT_EQ(first.substr(first.size() - 12), ",500,0,0,5,0");
+}
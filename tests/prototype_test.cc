@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "prototype.hh"
+#include "mock_type_test.h"
+
+static std::shared_ptr<const yagi::Prototype> _MakePrototype()
+{
+	auto pointed = std::make_shared<const yagi::RecoveredTypeInfo>("char", 1, yagi::RecoveredTypeInfo::CHAR);
+
+	auto prototype = std::make_shared<yagi::Prototype>();
+	prototype->name = "sub_401000";
+	prototype->callingConv = "__cdecl";
+	prototype->types.emplace_back("__int32", 4, yagi::RecoveredTypeInfo::INT);
+	prototype->types.emplace_back("char *", 8, 0, pointed);
+	prototype->types.emplace_back("_DWORD", 4, 0);
+	prototype->names = { "", "param_1", "param_2" };
+	return prototype;
+}
+
+TEST(TestPrototype, Declaration) {
+	auto prototype = _MakePrototype();
+	ASSERT_EQ(prototype->toDeclaration(), "__int32 __cdecl sub_401000(char * param_1, _DWORD param_2)");
+
+	yagi::Prototype empty;
+	empty.name = "f";
+	ASSERT_EQ(empty.toDeclaration(), "void f(void)");
+
+	empty.dotDotDot = true;
+	ASSERT_EQ(empty.toDeclaration(), "void f(...)");
+}
+
+TEST(TestPrototype, StoreOverridesFunctionTypes) {
+	auto store = std::make_shared<yagi::PrototypeStore>();
+	store->add(0x401000, _MakePrototype());
+
+	yagi::PrototypeTypeInfoFactory factory(std::make_unique<MockTypeInfoFactory>(
+		[](uint64_t ea) -> std::optional<std::unique_ptr<yagi::TypeInfo>> { return std::nullopt; },
+		[](const std::string& name) -> std::optional<std::unique_ptr<yagi::TypeInfo>> { return std::nullopt; }
+	), store);
+	ASSERT_FALSE(factory.build(0x402000).has_value());
+
+	auto type = factory.build(0x401000);
+	ASSERT_TRUE(type.has_value());
+	auto func = type.value()->toFunc();
+	ASSERT_TRUE(func.has_value());
+	ASSERT_EQ(func.value()->getCallingConv(), "__cdecl");
+	ASSERT_EQ(func.value()->getFuncParamName(), std::vector<std::string>({ "", "param_1", "param_2" }));
+
+	auto params = func.value()->getFuncPrototype();
+	ASSERT_EQ(params.size(), 3);
+	ASSERT_TRUE(params[0]->isInt());
+	auto ptr = params[1]->toPtr();
+	ASSERT_TRUE(ptr.has_value());
+	ASSERT_TRUE(ptr.value()->getPointedObject()->isChar());
+	ASSERT_FALSE(params[2]->toPtr().has_value());
+}
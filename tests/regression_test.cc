@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "regression.hh"
+#include "exception.hh"
+#include "base.hh"
+
+#include <sstream>
+
+static yagi::Decompiler::Result _Result(uint64_t ea, const std::string& code)
+{
+	return yagi::Decompiler::Result("func_" + yagi::to_hex(ea), ea, code, {});
+}
+
+TEST(TestRegression, SaveAndLoad) {
+	yagi::RegressionRun run;
+	yagi::RegressionBatchOutput output(run, "corpus", nullptr);
+	output.write(0x1000, _Result(0x1000, "void f(void) {}"), 1.5);
+	output.write(0x2000, std::nullopt, 0.25);
+	run.entries[yagi::RegressionRun::Key("corpus", 0x1000)].name = "f<a,b>";
+
+	auto path = std::filesystem::temp_directory_path() / "yagi_regression_test.csv";
+	run.save(path);
+	auto loaded = yagi::RegressionRun::load(path);
+	std::filesystem::remove(path);
+
+	ASSERT_EQ(loaded.entries.size(), 2);
+	auto& decompiled = loaded.entries.at(yagi::RegressionRun::Key("corpus", 0x1000));
+	ASSERT_TRUE(decompiled.decompiled);
+	ASSERT_EQ(decompiled.name, "f<a,b>");
+	ASSERT_EQ(decompiled.hash, run.entries.at(yagi::RegressionRun::Key("corpus", 0x1000)).hash);
+	ASSERT_DOUBLE_EQ(decompiled.duration, 1.5);
+	ASSERT_FALSE(loaded.entries.at(yagi::RegressionRun::Key("corpus", 0x2000)).decompiled);
+
+	ASSERT_THROW(yagi::RegressionRun::load(std::filesystem::temp_directory_path() / "yagi_missing_run.csv"), yagi::InvalidRegressionRun);
+}
+
+TEST(TestRegression, Compare) {
+	yagi::RegressionRun baseline, current;
+	yagi::RegressionBatchOutput before(baseline, "a", nullptr);
+	yagi::RegressionBatchOutput after(current, "a", nullptr);
+
+	before.write(0x1000, _Result(0x1000, "same"), 1.0);
+	after.write(0x1000, _Result(0x1000, "same"), 3.0);
+
+	before.write(0x2000, _Result(0x2000, "old"), 2.0);
+	after.write(0x2000, _Result(0x2000, "new"), 1.0);
+
+	before.write(0x3000, _Result(0x3000, "ok"), 1.0);
+	after.write(0x3000, std::nullopt, 1.0);
+
+	before.write(0x4000, std::nullopt, 1.0);
+	after.write(0x4000, _Result(0x4000, "ok"), 1.0);
+
+	before.write(0x5000, _Result(0x5000, "removed"), 1.0);
+	after.write(0x6000, _Result(0x6000, "added"), 1.0);
+
+	auto diff = yagi::RegressionDiff::compare(baseline, current);
+	ASSERT_TRUE(diff.hasOutputChanges());
+	ASSERT_EQ(diff.changed, std::vector<yagi::RegressionRun::Key>({ { "a", 0x2000 } }));
+	ASSERT_EQ(diff.broken, std::vector<yagi::RegressionRun::Key>({ { "a", 0x3000 } }));
+	ASSERT_EQ(diff.fixed, std::vector<yagi::RegressionRun::Key>({ { "a", 0x4000 } }));
+	ASSERT_EQ(diff.removed, std::vector<yagi::RegressionRun::Key>({ { "a", 0x5000 } }));
+	ASSERT_EQ(diff.added, std::vector<yagi::RegressionRun::Key>({ { "a", 0x6000 } }));
+
+	// slowest regression first
+	ASSERT_EQ(diff.latencies.size(), 2);
+	ASSERT_EQ(diff.latencies.front().key.second, 0x1000);
+	ASSERT_DOUBLE_EQ(diff.baselineDuration, 3.0);
+	ASSERT_DOUBLE_EQ(diff.currentDuration, 4.0);
+
+	std::stringstream ss;
+	diff.print(ss, 10);
+	ASSERT_NE(ss.str().find("changed : 1"), std::string::npos);
+
+	ASSERT_FALSE(yagi::RegressionDiff::compare(baseline, baseline).hasOutputChanges());
+}
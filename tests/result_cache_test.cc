@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include "resultcache.hh"
+
+static yagi::Decompiler::Result BuildResult(uint64_t ea, const std::string& code)
+{
+	std::vector<yagi::Decompiler::Symbol> symbols;
+	yagi::MemoryLocation loc("register", 0x10, 4);
+	loc.pc.push_back(ea + 4);
+	loc.pc.push_back(ea + 8);
+	symbols.emplace_back("var", loc);
+	symbols.emplace_back("test", yagi::MemoryLocation("ram", ea, 8));
+
+	// "test" on the first line, "var" on the second one
+	std::vector<yagi::Decompiler::Token> tokens = { { 0, 4, 8, 1 }, { 1, 2, 5, 0 } };
+	return yagi::Decompiler::Result("test", ea, code, symbols, tokens);
+}
+
+class MockResultStore : public yagi::ResultStore
+{
+public:
+	std::map<uint64_t, std::vector<uint8_t>> m_blobs;
+	std::vector<uint64_t> m_removedDependents;
+	std::vector<std::string> m_removedTypes;
+
+	std::optional<yagi::Decompiler::Result> load(uint64_t ea, uint64_t hash) override
+	{
+		auto iter = m_blobs.find(ea);
+		if (iter == m_blobs.end())
+		{
+			return std::nullopt;
+		}
+		return yagi::deserializeResult(iter->second, hash);
+	}
+
+	void save(uint64_t hash, const yagi::Decompiler::Result& result) override
+	{
+		m_blobs[result.ea] = yagi::serializeResult(hash, result);
+	}
+
+	void remove(uint64_t ea) override
+	{
+		m_blobs.erase(ea);
+	}
+
+	void removeDependents(uint64_t ea) override
+	{
+		m_removedDependents.push_back(ea);
+		m_blobs.erase(ea);
+	}
+
+	void removeType(const std::string& name) override
+	{
+		m_removedTypes.push_back(name);
+	}
+
+	void clear() override
+	{
+		m_blobs.clear();
+	}
+};
+
+TEST(TestResultCache, FindWithSameHash) {
+	yagi::ResultCache cache(4, nullptr);
+	cache.insert(1, BuildResult(0x1000, "code"));
+
+	auto result = cache.find(0x1000, 1);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().cCode, "code");
+	ASSERT_EQ(result.value().symbols.size(), 2);
+}
+
+TEST(TestResultCache, MissWhenHashChanged) {
+	yagi::ResultCache cache(4, nullptr);
+	cache.insert(1, BuildResult(0x1000, "code"));
+
+	ASSERT_FALSE(cache.find(0x1000, 2).has_value());
+	ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(TestResultCache, EvictLeastRecentlyUsed) {
+	yagi::ResultCache cache(2, nullptr);
+	cache.insert(1, BuildResult(0x1000, "a"));
+	cache.insert(1, BuildResult(0x2000, "b"));
+
+	// 0x1000 become the most recently used
+	ASSERT_TRUE(cache.find(0x1000, 1).has_value());
+	cache.insert(1, BuildResult(0x3000, "c"));
+
+	ASSERT_EQ(cache.size(), 2);
+	ASSERT_TRUE(cache.find(0x1000, 1).has_value());
+	ASSERT_FALSE(cache.find(0x2000, 1).has_value());
+	ASSERT_TRUE(cache.find(0x3000, 1).has_value());
+}
+
+TEST(TestResultCache, Invalidate) {
+	yagi::ResultCache cache(4, nullptr);
+	cache.insert(1, BuildResult(0x1000, "a"));
+	cache.insert(1, BuildResult(0x2000, "b"));
+	cache.invalidate(0x1000);
+
+	ASSERT_FALSE(cache.find(0x1000, 1).has_value());
+	ASSERT_TRUE(cache.find(0x2000, 1).has_value());
+}
+
+TEST(TestResultCache, InvalidateDependents) {
+	// 0x1000 calls 0x2000 and reads a global of type "foo"
+	auto caller = BuildResult(0x1000, "a");
+	caller.dependencies.addresses = { 0x2000, 0x5000 };
+	caller.dependencies.types = { "foo" };
+
+	yagi::ResultCache cache(4, nullptr);
+	cache.insert(1, caller);
+	cache.insert(1, BuildResult(0x2000, "b"));
+	cache.insert(1, BuildResult(0x3000, "c"));
+
+	// the callee is renamed
+	cache.invalidateDependents(0x2000);
+	ASSERT_FALSE(cache.find(0x1000, 1).has_value());
+	ASSERT_FALSE(cache.find(0x2000, 1).has_value());
+	ASSERT_TRUE(cache.find(0x3000, 1).has_value());
+
+	cache.insert(1, caller);
+	cache.invalidateType("bar");
+	ASSERT_TRUE(cache.find(0x1000, 1).has_value());
+	cache.invalidateType("foo");
+	ASSERT_FALSE(cache.find(0x1000, 1).has_value());
+	ASSERT_TRUE(cache.find(0x3000, 1).has_value());
+}
+
+TEST(TestResultCache, SerializeRoundTrip) {
+	auto source = BuildResult(0x1000, "int test(void);");
+	source.dependencies.addresses = { 0x2000 };
+	source.dependencies.types = { "foo", "foo *" };
+	source.tokens.push_back({ 1, 6, 7, UINT32_MAX, yagi::Decompiler::TokenKind::Syntax, 8 });
+	auto buffer = yagi::serializeResult(42, source);
+
+	auto result = yagi::deserializeResult(buffer, 42);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().name, "test");
+	ASSERT_EQ(result.value().ea, 0x1000);
+	ASSERT_EQ(result.value().cCode, "int test(void);");
+
+	auto var = result.value().findSymbol("var");
+	ASSERT_NE(var, nullptr);
+	ASSERT_EQ(var->location.spaceName, "register");
+	ASSERT_EQ(var->location.offset, 0x10);
+	ASSERT_EQ(var->location.addrSize, 4);
+	ASSERT_EQ(var->location.pc, std::vector<uint64_t>({ 0x1004, 0x1008 }));
+	ASSERT_EQ(result.value().findSymbol(1, 3), var);
+	ASSERT_EQ(result.value().findSymbol(1, 6), nullptr);
+	ASSERT_EQ(result.value().tokens.size(), 3);
+	ASSERT_EQ(result.value().tokens[2].kind, yagi::Decompiler::TokenKind::Syntax);
+	ASSERT_EQ(result.value().tokens[2].highlight, 8);
+	ASSERT_EQ(result.value().dependencies.addresses, source.dependencies.addresses);
+	ASSERT_EQ(result.value().dependencies.types, source.dependencies.types);
+
+	// wrong hash or truncated buffer
+	ASSERT_FALSE(yagi::deserializeResult(buffer, 43).has_value());
+	buffer.resize(buffer.size() - 1);
+	ASSERT_FALSE(yagi::deserializeResult(buffer, 42).has_value());
+}
+
+TEST(TestResultCache, FallbackOnStore) {
+	// a store filled by a previous session
+	auto store = std::make_unique<MockResultStore>();
+	store->save(1, BuildResult(0x1000, "a"));
+	auto storePtr = store.get();
+
+	yagi::ResultCache cache(4, std::move(store));
+	ASSERT_EQ(cache.size(), 0);
+
+	auto result = cache.find(0x1000, 1);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().cCode, "a");
+	ASSERT_EQ(cache.size(), 1);
+
+	// outdated content is not served from store
+	ASSERT_FALSE(cache.find(0x1000, 2).has_value());
+
+	cache.insert(1, BuildResult(0x2000, "b"));
+	ASSERT_EQ(storePtr->m_blobs.size(), 2);
+
+	// other saved results are kept
+	cache.invalidateDependents(0x2000);
+	cache.invalidateType("foo");
+	ASSERT_EQ(storePtr->m_blobs.size(), 1);
+	ASSERT_EQ(storePtr->m_removedDependents, std::vector<uint64_t>({ 0x2000 }));
+	ASSERT_EQ(storePtr->m_removedTypes, std::vector<std::string>({ "foo" }));
+
+	cache.clear();
+	ASSERT_EQ(storePtr->m_blobs.size(), 0);
+}
+
+TEST(TestResultCache, FindSymbolAtPosition) {
+	auto result = BuildResult(0x1000, "int test(void);\n  var;");
+
+	ASSERT_EQ(result.findSymbol(0, 4)->name, "test");
+	ASSERT_EQ(result.findSymbol(0, 7)->name, "test");
+	ASSERT_EQ(result.findSymbol(1, 2)->name, "var");
+
+	// before, after and between tokens
+	ASSERT_EQ(result.findSymbol(0, 3), nullptr);
+	ASSERT_EQ(result.findSymbol(0, 8), nullptr);
+	ASSERT_EQ(result.findSymbol(1, 0), nullptr);
+	ASSERT_EQ(result.findSymbol(1, 5), nullptr);
+	ASSERT_EQ(result.findSymbol(2, 0), nullptr);
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "resultstore.hh"
+#include "compress.hh"
+
+/*!
+ * \brief	Blobs kept in memory, counting the calls of the store
+ */
+class MockResultBlobs : public yagi::ResultBlobs
+{
+public:
+	std::map<uint64_t, Entry>& m_entries;
+	size_t m_reads = 0;
+	size_t m_ownWrites = 0;
+
+	// may outlive the mock, like entries
+	size_t& m_writes;
+
+	explicit MockResultBlobs(std::map<uint64_t, Entry>& entries)
+		: m_entries{ entries }, m_writes{ m_ownWrites }
+	{}
+
+	MockResultBlobs(std::map<uint64_t, Entry>& entries, size_t& writes)
+		: m_entries{ entries }, m_writes{ writes }
+	{}
+
+	std::unordered_map<uint64_t, IndexEntry> readIndex() override
+	{
+		std::unordered_map<uint64_t, IndexEntry> index;
+		for (auto& entry : m_entries)
+		{
+			index.emplace(entry.first, IndexEntry{ entry.second.hash, entry.second.dependencies });
+		}
+		return index;
+	}
+
+	std::optional<std::vector<uint8_t>> read(uint64_t ea) override
+	{
+		m_reads++;
+		auto iter = m_entries.find(ea);
+		if (iter == m_entries.end())
+		{
+			return std::nullopt;
+		}
+		return iter->second.data;
+	}
+
+	void write(const std::vector<Entry>& entries) override
+	{
+		m_writes++;
+		for (auto& entry : entries)
+		{
+			if (entry.data.empty())
+			{
+				m_entries.erase(entry.ea);
+			}
+			else
+			{
+				m_entries[entry.ea] = entry;
+			}
+		}
+	}
+
+	void clear() override
+	{
+		m_entries.clear();
+	}
+};
+
+static yagi::Decompiler::Result _BuildResult(uint64_t ea)
+{
+	std::vector<yagi::Decompiler::Symbol> symbols;
+	symbols.emplace_back("local_10", yagi::MemoryLocation("stack", 0x10, 8));
+	std::string code;
+	for (int i = 0; i < 20; i++)
+	{
+		code += "  local_10 = local_10 + " + std::to_string(i) + ";\n";
+	}
+	return yagi::Decompiler::Result("func_" + std::to_string(ea), ea, code, symbols);
+}
+
+TEST(TestResultStore, CompressRoundTrip) {
+	std::vector<std::vector<uint8_t>> inputs = { {}, { 1, 2, 3 }, std::vector<uint8_t>(1000, 'a') };
+
+	// long literals and long matches use extra length bytes
+	std::vector<uint8_t> mixed;
+	for (int i = 0; i < 5000; i++)
+	{
+		mixed.push_back(static_cast<uint8_t>((i * 7919) % 251));
+	}
+	mixed.insert(mixed.end(), mixed.begin(), mixed.begin() + 3000);
+	inputs.push_back(mixed);
+
+	for (auto& input : inputs)
+	{
+		auto compressed = yagi::compressBuffer(input);
+		auto decompressed = yagi::decompressBuffer(compressed);
+		ASSERT_TRUE(decompressed.has_value());
+		ASSERT_EQ(decompressed.value(), input);
+	}
+
+	ASSERT_LT(yagi::compressBuffer(std::vector<uint8_t>(1000, 'a')).size(), 32);
+
+	auto truncated = yagi::compressBuffer(mixed);
+	truncated.resize(truncated.size() / 2);
+	ASSERT_FALSE(yagi::decompressBuffer(truncated).has_value());
+	ASSERT_FALSE(yagi::decompressBuffer({ 1, 0 }).has_value());
+}
+
+TEST(TestResultStore, BatchedWrites) {
+	std::map<uint64_t, yagi::ResultBlobs::Entry> entries;
+	size_t writes = 0;
+	{
+		yagi::PackedResultStore store(std::make_unique<MockResultBlobs>(entries, writes), 2);
+		store.save(1, _BuildResult(0x1000));
+
+		// pending results are already visible
+		ASSERT_EQ(store.load(0x1000, 1).value().cCode, _BuildResult(0x1000).cCode);
+		ASSERT_EQ(writes, 0);
+
+		store.save(2, _BuildResult(0x2000));
+		ASSERT_EQ(writes, 1);
+		ASSERT_EQ(entries.size(), 2);
+		ASSERT_LT(entries[0x1000].data.size(), yagi::serializeResult(1, _BuildResult(0x1000)).size());
+
+		store.save(3, _BuildResult(0x3000));
+	}
+
+	// the last one is written on destruction, in a single batch
+	ASSERT_EQ(writes, 2);
+	ASSERT_EQ(entries.size(), 3);
+}
+
+TEST(TestResultStore, LazyLoad) {
+	std::map<uint64_t, yagi::ResultBlobs::Entry> entries;
+	{
+		yagi::PackedResultStore store(std::make_unique<MockResultBlobs>(entries), 1);
+		store.save(1, _BuildResult(0x1000));
+		store.save(2, _BuildResult(0x2000));
+	}
+
+	auto blobs = std::make_unique<MockResultBlobs>(entries);
+	auto mock = blobs.get();
+	yagi::PackedResultStore store(std::move(blobs), 1);
+
+	// outdated and unknown results are not read
+	ASSERT_FALSE(store.load(0x1000, 5).has_value());
+	ASSERT_FALSE(store.load(0x4000, 1).has_value());
+	ASSERT_EQ(mock->m_reads, 0);
+
+	auto result = store.load(0x2000, 2);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().name, "func_8192");
+	ASSERT_EQ(mock->m_reads, 1);
+
+	// removing a function never stored writes nothing
+	store.remove(0x4000);
+	ASSERT_EQ(mock->m_writes, 0);
+	store.remove(0x1000);
+	ASSERT_EQ(mock->m_writes, 1);
+	ASSERT_EQ(entries.count(0x1000), 0);
+
+	store.clear();
+	ASSERT_TRUE(entries.empty());
+	ASSERT_FALSE(store.load(0x2000, 2).has_value());
+}
+
+TEST(TestResultStore, RemoveDependents) {
+	// 0x1000 calls 0x2000 and reads type "foo", saved by a previous session
+	std::map<uint64_t, yagi::ResultBlobs::Entry> entries;
+	{
+		auto caller = _BuildResult(0x1000);
+		caller.dependencies.addresses = { 0x2000 };
+		caller.dependencies.types = { "foo" };
+
+		yagi::PackedResultStore store(std::make_unique<MockResultBlobs>(entries), 1);
+		store.save(1, caller);
+		store.save(2, _BuildResult(0x2000));
+		store.save(3, _BuildResult(0x3000));
+	}
+
+	auto blobs = std::make_unique<MockResultBlobs>(entries);
+	auto mock = blobs.get();
+	yagi::PackedResultStore store(std::move(blobs), 1);
+
+	// only the index is read to find dependents
+	store.removeType("bar");
+	store.removeDependents(0x4000);
+	ASSERT_EQ(entries.size(), 3);
+
+	store.removeDependents(0x2000);
+	ASSERT_EQ(mock->m_reads, 0);
+	ASSERT_EQ(entries.count(0x1000), 0);
+	ASSERT_EQ(entries.count(0x2000), 0);
+	ASSERT_TRUE(store.load(0x3000, 3).has_value());
+
+	auto caller = _BuildResult(0x1000);
+	caller.dependencies.types = { "foo" };
+	store.save(1, caller);
+	store.removeType("foo");
+	ASSERT_FALSE(store.load(0x1000, 1).has_value());
+	ASSERT_EQ(entries.size(), 1);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "scheduler.hh"
+
+using Priority = yagi::JobScheduler::Priority;
+
+TEST(TestJobScheduler, BackgroundShare) {
+	yagi::JobScheduler scheduler(0.25);
+	auto now = yagi::JobScheduler::Clock::now();
+
+	ASSERT_TRUE(scheduler.mayStart(Priority::Prefetch, now));
+	scheduler.start(Priority::Prefetch, now, now);
+	scheduler.end(now + std::chrono::milliseconds(100));
+
+	// 100 ms of prefetch is a quarter of 400 ms
+	now += std::chrono::milliseconds(100);
+	ASSERT_FALSE(scheduler.mayStart(Priority::Background, now));
+	ASSERT_EQ(scheduler.getDelay(now), std::chrono::milliseconds(300));
+	ASSERT_TRUE(scheduler.mayStart(Priority::Interactive, now));
+
+	// a user request is never delayed and doesn't delay others
+	scheduler.start(Priority::Interactive, now, now);
+	scheduler.end(now + std::chrono::milliseconds(1000));
+	now += std::chrono::milliseconds(1000);
+	ASSERT_TRUE(scheduler.mayStart(Priority::Background, now));
+	ASSERT_EQ(scheduler.getDelay(now), std::chrono::milliseconds(0));
+}
+
+TEST(TestJobScheduler, Preemption) {
+	yagi::JobScheduler scheduler(1);
+	auto now = yagi::JobScheduler::Clock::now();
+
+	ASSERT_FALSE(scheduler.preempt(Priority::Interactive));
+
+	scheduler.start(Priority::Interactive, now, now);
+	ASSERT_FALSE(scheduler.preempt(Priority::Prefetch));
+	scheduler.end(now + std::chrono::milliseconds(50));
+
+	scheduler.start(Priority::Background, now, now);
+	ASSERT_EQ(scheduler.getRunning(), Priority::Background);
+	ASSERT_TRUE(scheduler.preempt(Priority::Interactive));
+	scheduler.end(now + std::chrono::milliseconds(10));
+	ASSERT_EQ(scheduler.getRunning(), std::nullopt);
+
+	// the last user request replaces the previous one
+	scheduler.start(Priority::Interactive, now, now);
+	ASSERT_TRUE(scheduler.preempt(Priority::Interactive));
+	scheduler.end(now);
+
+	auto& interactive = scheduler.getStats(Priority::Interactive);
+	ASSERT_EQ(interactive.done, 1);
+	ASSERT_EQ(interactive.preempted, 1);
+	ASSERT_DOUBLE_EQ(interactive.getLatency(), 50);
+	ASSERT_EQ(scheduler.getStats(Priority::Background).preempted, 1);
+	ASSERT_EQ(scheduler.getStats(Priority::Background).done, 0);
+}
+
+TEST(TestJobScheduler, Latency) {
+	yagi::JobScheduler scheduler(1);
+	auto submitted = yagi::JobScheduler::Clock::now();
+
+	// the wait before the start is part of the latency
+	scheduler.start(Priority::Prefetch, submitted, submitted + std::chrono::milliseconds(20));
+	scheduler.end(submitted + std::chrono::milliseconds(30));
+	scheduler.start(Priority::Prefetch, submitted, submitted);
+	scheduler.end(submitted + std::chrono::milliseconds(10));
+	scheduler.setPending(Priority::Prefetch, 3);
+
+	auto& prefetch = scheduler.getStats(Priority::Prefetch);
+	ASSERT_EQ(prefetch.done, 2);
+	ASSERT_EQ(prefetch.pending, 3);
+	ASSERT_DOUBLE_EQ(prefetch.getLatency(), 20);
+	ASSERT_DOUBLE_EQ(prefetch.maxLatency, 30);
+	ASSERT_EQ(scheduler.getSummary(), "interactive 0 pending 0 done 0 preempted (mean 0 ms, max 0 ms), prefetch 3 pending 2 done 0 preempted (mean 20 ms, max 30 ms), background 0 pending 0 done 0 preempted (mean 0 ms, max 0 ms)");
+}
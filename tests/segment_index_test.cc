@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "segmentindex.hh"
+
+TEST(TestSegmentIndex, Permissions) {
+	yagi::SegmentIndex index;
+	index.add(0x2000, 0x3000, ".rdata", yagi::SegmentIndex::PERM_READ);
+	index.add(0x1000, 0x2000, ".text", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_EXEC);
+	index.add(0x4000, 0x5000, ".bss", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_WRITE);
+
+	ASSERT_EQ(index.size(), 3);
+	ASSERT_TRUE(index.isReadOnly(0x1000));
+	ASSERT_TRUE(index.isReadOnly(0x2fff));
+	ASSERT_FALSE(index.isReadOnly(0x3000));
+	ASSERT_FALSE(index.isReadOnly(0x4800));
+	ASSERT_FALSE(index.isReadOnly(0x0));
+	ASSERT_FALSE(index.isReadOnly(0xffffffffffffffff));
+}
+
+TEST(TestSegmentIndex, Policy) {
+	yagi::SegmentIndex defaultPolicy;
+	defaultPolicy.add(0x1000, 0x2000, ".data", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_WRITE);
+	ASSERT_TRUE(defaultPolicy.isReadOnly(0x1000));
+
+	yagi::SegmentIndex noPolicy(std::unordered_set<std::string>{});
+	noPolicy.add(0x1000, 0x2000, ".data", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_WRITE);
+	ASSERT_FALSE(noPolicy.isReadOnly(0x1000));
+
+	yagi::SegmentIndex custom({ ".got" });
+	custom.add(0x1000, 0x2000, ".got", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_WRITE);
+	custom.add(0x2000, 0x3000, ".data", yagi::SegmentIndex::PERM_READ | yagi::SegmentIndex::PERM_WRITE);
+	ASSERT_TRUE(custom.isReadOnly(0x1800));
+	ASSERT_FALSE(custom.isReadOnly(0x2800));
+
+	custom.clear();
+	ASSERT_FALSE(custom.isReadOnly(0x1800));
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "servicehost.hh"
+#include "remote.hh"
+#include "mock_logger_test.h"
+
+#include <atomic>
+#include <thread>
+
+/*!
+ * \brief	Decompiler that prints the export it was built from
+ */
+class SourceDecompiler : public yagi::Decompiler
+{
+public:
+	std::string m_source;
+
+	explicit SourceDecompiler(std::string source)
+		: m_source{ std::move(source) }
+	{}
+
+	std::optional<Result> decompile(uint64_t funcAddress) override
+	{
+		if (funcAddress == 0)
+		{
+			return std::nullopt;
+		}
+		return Result("func", funcAddress, "// " + m_source, {});
+	}
+
+	std::optional<Result> refreshNames(uint64_t funcAddress) override
+	{
+		return decompile(funcAddress);
+	}
+
+	void invalidate(uint64_t funcAddress) override {}
+	void invalidateDependents(uint64_t ea) override {}
+	void invalidateCode(uint64_t ea) override {}
+	void clearCache() override {}
+	void invalidateType(const std::string& name) override {}
+	void invalidateTypes() override {}
+	void retain(uint64_t funcAddress) override {}
+	void release(uint64_t funcAddress) override {}
+	void setCancelToken(std::shared_ptr<const yagi::CancelToken> token) override {}
+	void setProfileOutput(std::shared_ptr<yagi::ProfileOutput> output) override {}
+	size_t prewarmTypes(yagi::TypeInfoFactory& source, const std::vector<std::string>& names) override { return 0; }
+};
+
+TEST(TestService, RequestRoundTrip) {
+	yagi::service::Request request{ "client", "db.1.yagi", 0x401000, 500 };
+	yagi::service::Request decoded;
+
+	ASSERT_TRUE(yagi::service::decode(yagi::service::encode(request), decoded));
+	ASSERT_EQ(decoded.client, "client");
+	ASSERT_EQ(decoded.source, "db.1.yagi");
+	ASSERT_EQ(decoded.ea, 0x401000);
+	ASSERT_EQ(decoded.timeout, 500);
+
+	auto truncated = yagi::service::encode(request);
+	truncated.pop_back();
+	ASSERT_FALSE(yagi::service::decode(truncated, decoded));
+}
+
+TEST(TestService, DecompilersAreKeptUntilNewExport) {
+	std::atomic<int> built{ 0 };
+	yagi::ServiceHost host([&built](const std::string& source) {
+		built++;
+		return std::make_unique<SourceDecompiler>(source);
+	}, 2);
+
+	auto response = host.handle(yagi::service::Request{ "a", "a.1", 0x1000, 0 });
+	ASSERT_EQ(response.status, yagi::service::Status::Ok);
+	host.handle(yagi::service::Request{ "a", "a.1", 0x1000, 0 });
+	ASSERT_EQ(built, 1);
+
+	// other clients have their own decompilers
+	host.handle(yagi::service::Request{ "b", "b.1", 0x1000, 0 });
+	ASSERT_EQ(built, 2);
+	ASSERT_EQ(host.getClientCount(), 2);
+
+	host.handle(yagi::service::Request{ "a", "a.2", 0x1000, 0 });
+	ASSERT_EQ(built, 3);
+
+	ASSERT_EQ(host.handle(yagi::service::Request{ "a", "a.2", 0, 0 }).status, yagi::service::Status::NotFound);
+}
+
+TEST(TestService, UnloadableExport) {
+	yagi::ServiceHost host([](const std::string&) { return nullptr; }, 1);
+
+	auto response = host.handle(yagi::service::Request{ "a", "a.1", 0x1000, 0 });
+	ASSERT_EQ(response.status, yagi::service::Status::Error);
+}
+
+TEST(TestService, RemoteDecompilation) {
+	yagi::ServiceHost host([](const std::string& source) {
+		return std::make_unique<SourceDecompiler>(source);
+	}, 1);
+
+	yagi::LocalServer server;
+	ASSERT_TRUE(server.listen(0));
+	std::atomic<bool> stop{ false };
+	std::thread thread([&]() { host.serve(server, stop); });
+
+	std::vector<std::string> exports;
+	uint64_t hash = 1;
+	yagi::RemoteDecompiler remote(
+		server.getPort(),
+		"db",
+		[&exports](const std::string& path) { exports.push_back(path); return true; },
+		[&hash](uint64_t) { return hash; },
+		0,
+		std::make_unique<MockLogger>([](const std::string&) {})
+	);
+
+	auto result = remote.decompile(0x1000);
+	ASSERT_TRUE(result.has_value());
+	ASSERT_EQ(result.value().ea, 0x1000);
+	ASSERT_EQ(result.value().cCode, "// db.1.yagi");
+
+	// nothing changed, the same export is used
+	remote.decompile(0x2000);
+	ASSERT_EQ(exports.size(), 1);
+
+	// a database event
+	remote.invalidateDependents(0x3000);
+	ASSERT_EQ(remote.decompile(0x1000).value().cCode, "// db.2.yagi");
+
+	// local names saved without event
+	hash = 2;
+	ASSERT_EQ(remote.refreshNames(0x1000).value().cCode, "// db.3.yagi");
+	ASSERT_EQ(exports.size(), 3);
+
+	stop = true;
+	thread.join();
+}
+
+TEST(TestService, ServiceUnavailable) {
+	// nobody listen on a closed port
+	yagi::LocalServer server;
+	ASSERT_TRUE(server.listen(0));
+	auto port = server.getPort();
+	server = yagi::LocalServer();
+
+	std::vector<std::string> messages;
+	yagi::RemoteDecompiler remote(
+		port,
+		"db",
+		[](const std::string&) { return true; },
+		[](uint64_t) { return 0; },
+		0,
+		std::make_unique<MockLogger>([&messages](const std::string& message) { messages.push_back(message); })
+	);
+
+	ASSERT_FALSE(remote.decompile(0x1000).has_value());
+	ASSERT_EQ(messages.size(), 1);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "yagiarchitecture.hh"
+#include "typemanager.hh"
+#include "mock_logger_test.h"
+#include "mock_symbol_test.h"
+#include "mock_type_test.h"
+#include "mock_loader_test.h"
+#include "ghidra.hh"
+
+#include <set>
+#include <stdexcept>
+
+static std::unique_ptr<yagi::TypeInfo> _MakeInt(size_t size, const std::string& name)
+{
+	return std::make_unique<MockTypeInfo>(size, name, true, false, false, false, false, false, false);
+}
+
+static std::unique_ptr<yagi::YagiArchitecture> _MakeArchitecture(MockTypeInfoFactoryFindName backend)
+{
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memset(ptr, 0, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			return std::nullopt;
+		},
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::nullopt;
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, backend),
+		"__stdcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+	return arch;
+}
+
+// Types are read from the source before the backend, nested ones included
+TEST(TestTypeManager, PrewarmReadsSourceFirst) {
+	auto arch = _MakeArchitecture([](const std::string& name) -> std::optional<std::unique_ptr<yagi::TypeInfo>> {
+		if (name == "mytype")
+		{
+			return _MakeInt(2, name);
+		}
+		return std::nullopt;
+	});
+
+	std::vector<std::string> reads;
+	MockTypeInfoFactory source([](uint64_t) { return std::nullopt; }, [&reads](const std::string& name) -> std::optional<std::unique_ptr<yagi::TypeInfo>> {
+		reads.push_back(name);
+		if (name == "mytype")
+		{
+			return _MakeInt(4, name);
+		}
+		if (name == "myfunc")
+		{
+			// the embedded parameter is not the one translated
+			auto param = MockTypeInfo(8, "mytype", true, false, false, false, false, false, false);
+			return std::make_unique<MockTypeInfo>(4, name, MockFuncInfo(false, "__cdecl", { param, param }, { "", "a" }));
+		}
+		return std::nullopt;
+	});
+
+	auto types = static_cast<yagi::TypeManager*>(arch->types);
+	ASSERT_EQ(types->prewarm(source, { "myfunc" }), 1);
+	ASSERT_EQ(reads, std::vector<std::string>({ "myfunc", "mytype" }));
+
+	// translated from the source, not asked again
+	auto nested = types->tryFindByName("mytype");
+	ASSERT_NE(nested, nullptr);
+	ASSERT_EQ(nested->getSize(), 4);
+	ASSERT_EQ(reads.size(), 2);
+}
+
+// The source is detached when the prewarm is canceled or raises
+TEST(TestTypeManager, PrewarmCancelMidSlice) {
+	auto arch = _MakeArchitecture([](const std::string& name) -> std::optional<std::unique_ptr<yagi::TypeInfo>> {
+		return _MakeInt(2, name);
+	});
+
+	auto token = std::make_shared<yagi::CancelToken>();
+	arch->setCancelToken(token);
+
+	std::set<std::string> reads;
+	MockTypeInfoFactory source([](uint64_t) { return std::nullopt; }, [&reads, token](const std::string& name) -> std::optional<std::unique_ptr<yagi::TypeInfo>> {
+		reads.insert(name);
+		if (name == "b")
+		{
+			token->cancel();
+		}
+		if (name == "boom")
+		{
+			throw std::runtime_error("boom");
+		}
+		return _MakeInt(4, name);
+	});
+
+	auto types = static_cast<yagi::TypeManager*>(arch->types);
+	ASSERT_EQ(types->prewarm(source, { "a", "b", "c" }), 2);
+	ASSERT_EQ(reads, std::set<std::string>({ "a", "b" }));
+
+	// a later lookup reads the backend
+	auto type = types->tryFindByName("c");
+	ASSERT_NE(type, nullptr);
+	ASSERT_EQ(type->getSize(), 2);
+	ASSERT_EQ(reads.count("c"), 0);
+
+	arch->setCancelToken(nullptr);
+	ASSERT_THROW(types->prewarm(source, { "boom" }), std::runtime_error);
+
+	type = types->tryFindByName("d");
+	ASSERT_NE(type, nullptr);
+	ASSERT_EQ(type->getSize(), 2);
+	ASSERT_EQ(reads.count("d"), 0);
+}
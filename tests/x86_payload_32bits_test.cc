@@ -1,11 +1,18 @@
 #include <gtest/gtest.h>
 #include "yagiarchitecture.hh"
+#include "decompilecontext.hh"
+#include "ghidradecompiler.hh"
+#include "resultcache.hh"
+#include "print.hh"
 #include "mock_logger_test.h"
 #include "mock_symbol_test.h"
 #include "mock_type_test.h"
 #include "mock_loader_test.h"
 #include "ghidra.hh"
 
+#include <algorithm>
+#include <sstream>
+
 #define FUNC_ADDR 0xaaaaaaaa
 #define FUNC_SIZE 20
 #define FUNC_NAME "test"
@@ -68,4 +75,324 @@ TEST(TestDecompilationPayload_x86_32, DecompileWithoutType) {
 	arch->print->docFunction(func);
 	
 	ASSERT_STREQ(ss.str().c_str(), "\n__uint32 * __fastcall test(__uint8 param_1)\n\n{\n  __uint32 *p_Var1;\n  \n  p_Var1 = (__uint32 *)func_0xaaae02f2(9);\n  if (p_Var1 != (__uint32 *)0x0) {\n    *p_Var1 = 0;\n    p_Var1[1] = 1;\n    *(__uint8 *)(p_Var1 + 2) = param_1;\n    return p_Var1 + 2;\n  }\n  return (__uint32 *)0x0;\n}\n");
-}
\ No newline at end of file
+}
+
+// The caller of an unnamed function is invalidated when the callee is named
+TEST(TestDecompilationPayload_x86_32, DependsOnUnnamedCallee) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memcpy(ptr, PAYLOAD + addr.getOffset() - FUNC_ADDR, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FUNC_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+					)
+				);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__stdcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+
+	auto context = arch->findContext(FUNC_ADDR);
+	ASSERT_NE(context, nullptr);
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), FUNC_ADDR)
+	);
+	arch->performActions(*func);
+
+	// no symbol at the callee, it is printed as func_0xaaae02f2
+	auto dependencies = context->getDependencies();
+	ASSERT_TRUE(dependencies.dependsOn(0xaaae02f2));
+
+	yagi::Decompiler::Result caller(FUNC_NAME, FUNC_ADDR, "", {});
+	caller.dependencies = dependencies;
+
+	yagi::ResultCache cache(4, nullptr);
+	cache.insert(1, caller);
+
+	// a name is added at the callee
+	cache.invalidateDependents(0xaaae02f2);
+	ASSERT_FALSE(cache.find(FUNC_ADDR, 1).has_value());
+}
+
+// Kind of each token printed by the IDA printer
+TEST(TestDecompilationPayload_x86_32, TokenKinds) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memcpy(ptr, PAYLOAD + addr.getOffset() - FUNC_ADDR, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FUNC_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+					)
+				);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__stdcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), FUNC_ADDR)
+	);
+	arch->performActions(*func);
+	func->warningHeader("yagitoken");
+
+	arch->setPrintLanguage("yagi-c-language");
+	auto& emitter = static_cast<yagi::IdaPrint*>(arch->print)->getEmitter();
+	emitter.setSymbolIndex(nullptr);
+
+	stringstream ss;
+	arch->print->setOutputStream(&ss);
+	arch->print->docFunction(func);
+	arch->print->setOutputStream(nullptr);
+
+	auto code = ss.str();
+	auto tokens = yagi::indexTokens(code, emitter.getTags(), true);
+
+	std::vector<std::string> lines;
+	std::stringstream plain(yagi::removeColorTags(code));
+	for (std::string line; std::getline(plain, line);)
+	{
+		lines.push_back(line);
+	}
+
+	// kinds of all tokens with this text
+	auto kindsOf = [&](const std::string& text) {
+		std::vector<yagi::Decompiler::TokenKind> kinds;
+		for (auto& token : tokens)
+		{
+			if (lines[token.line].substr(token.start, token.end - token.start) == text)
+			{
+				kinds.push_back(token.kind);
+			}
+		}
+		return kinds;
+	};
+
+	auto returns = kindsOf("return");
+	ASSERT_FALSE(returns.empty());
+	for (auto kind : returns)
+	{
+		ASSERT_EQ(kind, yagi::Decompiler::TokenKind::Keyword);
+	}
+
+	// comments are printed word by word
+	auto comments = kindsOf("yagitoken");
+	ASSERT_EQ(comments, std::vector<yagi::Decompiler::TokenKind>({ yagi::Decompiler::TokenKind::Comment }));
+
+	auto assigns = kindsOf("=");
+	ASSERT_FALSE(assigns.empty());
+	ASSERT_EQ(assigns.front(), yagi::Decompiler::TokenKind::Operator);
+}
+
+#define SWITCH_ADDR 0x401000
+#define SWITCH_SIZE 0x28
+
+// switch on param_1 from case 3 to 5, the jump table at 0x401028 is left unmapped
+static const uint8_t SWITCH_PAYLOAD[] = {
+	0x8B, 0x44, 0x24, 0x04, 0x83, 0xE8, 0x03, 0x83,
+	0xF8, 0x02, 0x77, 0x19, 0xFF, 0x24, 0x85, 0x28,
+	0x10, 0x40, 0x00, 0xB8, 0x0A, 0x00, 0x00, 0x00,
+	0xC3, 0xB8, 0x14, 0x00, 0x00, 0x00, 0xC3, 0xB8,
+	0x1E, 0x00, 0x00, 0x00, 0xC3, 0x33, 0xC0, 0xC3
+};
+
+// Jump table resolved by the backend is used with its case values
+TEST(TestDecompilationPayload_x86_32, SeedFlow) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memset(ptr, 0, size);
+			for (int4 i = 0; i < size; i++)
+			{
+				auto offset = addr.getOffset() + i - SWITCH_ADDR;
+				if (offset < sizeof(SWITCH_PAYLOAD))
+				{
+					ptr[i] = SWITCH_PAYLOAD[offset];
+				}
+			}
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == SWITCH_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					SWITCH_ADDR, FUNC_NAME, SWITCH_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			auto function = std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					SWITCH_ADDR, FUNC_NAME, SWITCH_SIZE, true, false, false, false
+					)
+				);
+			function->m_flow.chunks.emplace_back(SWITCH_ADDR, SWITCH_ADDR + SWITCH_SIZE);
+			function->m_flow.jumpTables[0x40100c] = { { 3, 0x401013 }, { 4, 0x401019 }, { 5, 0x40101f } };
+			return function;
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__cdecl"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+	arch->setFlowSeeding(true);
+	ASSERT_NE(arch->findContext(SWITCH_ADDR), nullptr);
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), SWITCH_ADDR)
+	);
+	ASSERT_EQ(arch->seedFlow(*func), 1);
+	arch->performActions(*func);
+
+	arch->setPrintLanguage("c-language");
+
+	stringstream ss;
+	arch->print->setOutputStream(&ss);
+	arch->print->docFunction(func);
+
+	auto code = ss.str();
+	ASSERT_NE(code.find("switch("), std::string::npos);
+	ASSERT_NE(code.find("case 3:"), std::string::npos);
+	ASSERT_NE(code.find("case 5:"), std::string::npos);
+	ASSERT_EQ(code.find("case 0:"), std::string::npos);
+}
+
+#define CONSTANT_ADDR 0x401000
+#define CONSTANT_DATA 0x403000
+
+// return param_1 * 0x403000, the value is also the address of a global
+static const uint8_t CONSTANT_PAYLOAD[] = {
+	0x8B, 0x44, 0x24, 0x04, 0x69, 0xC0, 0x00, 0x30,
+	0x40, 0x00, 0xC3
+};
+
+// A printed constant naming a symbol of the database is a ram token
+TEST(TestDecompilationPayload_x86_32, ConstantSymbolTokens) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memset(ptr, 0, size);
+			for (int4 i = 0; i < size; i++)
+			{
+				auto offset = addr.getOffset() + i - CONSTANT_ADDR;
+				if (offset < sizeof(CONSTANT_PAYLOAD))
+				{
+					ptr[i] = CONSTANT_PAYLOAD[offset];
+				}
+			}
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == CONSTANT_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					CONSTANT_ADDR, FUNC_NAME, sizeof(CONSTANT_PAYLOAD), true, false, false, false
+				);
+			}
+			if (ea == CONSTANT_DATA)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					CONSTANT_DATA, "counter", 0, false, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			if (func_addr != CONSTANT_ADDR)
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					CONSTANT_ADDR, FUNC_NAME, sizeof(CONSTANT_PAYLOAD), true, false, false, false
+					)
+				);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__cdecl"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+
+	yagi::GhidraDecompiler decompiler(std::move(arch), yagi::ResultCache(0, nullptr));
+	auto result = decompiler.decompile(CONSTANT_ADDR);
+	ASSERT_TRUE(result.has_value());
+
+	auto symbol = std::find_if(result->symbols.begin(), result->symbols.end(), [](const yagi::Decompiler::Symbol& symbol) {
+		return symbol.name == "0x403000";
+	});
+	ASSERT_NE(symbol, result->symbols.end());
+	ASSERT_EQ(symbol->location.spaceName, "ram");
+	ASSERT_EQ(symbol->location.offset, CONSTANT_DATA);
+
+	// the printed value leads to the global
+	std::stringstream plain(yagi::removeColorTags(result->cCode));
+	uint32_t line = 0;
+	bool found = false;
+	for (std::string text; std::getline(plain, text); line++)
+	{
+		auto column = text.find("0x403000");
+		if (column != std::string::npos)
+		{
+			auto printed = result->findSymbol(line, static_cast<uint32_t>(column));
+			ASSERT_NE(printed, nullptr);
+			ASSERT_EQ(printed->location.offset, CONSTANT_DATA);
+			found = true;
+		}
+	}
+	ASSERT_TRUE(found);
+}
@@ -125,4 +125,65 @@ TEST(TestDecompilationPayload_x86_32, RetypeLocalRegVar) {
 	arch->print->docFunction(func);
 
 	ASSERT_STREQ(ss.str().c_str(), "\nint32_t test(__uint32 param_1,__uint32 param_2)\n\n{\n  pointer pVar1;\n  \n  pVar1 = func_0x0040205e(param_2);\n  func_0x0040244c(param_1,param_2);\n  return pVar1 + 1;\n}\n");
-}
\ No newline at end of file
+}
+
+TEST(TestDecompilationPayload_x86_32, RenameLocalRegVarWithoutAnalysis) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	// name saved by the user after the first analysis
+	auto newName = std::make_shared<std::string>("yeah");
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:32:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memcpy(ptr, PAYLOAD + addr.getOffset() - FUNC_ADDR, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FUNC_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[newName](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			auto result = std::make_unique<MockFunctionSymbolInfo>(
+					std::make_unique<MockSymbolInfo>(
+						FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+					)
+				);
+			yagi::MemoryLocation loc("register", 0x0000000000000000, 4);
+			loc.pc.push_back(0x0000000000401fa7);
+			result->saveName(loc, *newName);
+			return result;
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__stdcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), FUNC_ADDR)
+	);
+	arch->performActions(*func);
+
+	// only rename actions are run on the retained analysis
+	*newName = "renamed";
+	arch->performRenameActions(*func);
+
+	arch->setPrintLanguage("c-language");
+
+	stringstream ss;
+	arch->print->setOutputStream(&ss);
+	//print as C
+	arch->print->docFunction(func);
+	
+	ASSERT_STREQ(ss.str().c_str(), "\nint32_t test(__uint32 param_1,__uint32 param_2)\n\n{\n  int32_t renamed;\n  \n  renamed = func_0x0040205e(param_2);\n  func_0x0040244c(param_1,param_2);\n  return renamed + 1;\n}\n");
+}
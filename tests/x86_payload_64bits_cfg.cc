@@ -57,13 +57,15 @@ TEST(TestDecompilationPayload_x86_64, CheckControlFlowGuardPatch) {
 					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
 					)
 				);
-		}),
+		},
+		{ { "guard_dispatch_icall_fptr", 0x1400335d8 } }),
 		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
 		"__fastcall"
 	);
 
 	// add CFG rules
-	arch->extra_pool_rules.push_back(new yagi::RuleWindowsControlFlowGuard("analysis", "guard_dispatch_icall_fptr"));
+	arch->addCallWrapper({ "guard_dispatch_icall_fptr", "RAX" });
+	arch->extra_pool_rules.push_back(new yagi::RuleCallWrapper("analysis"));
 
 	DocumentStorage store;
 	arch->init(store);
@@ -5,6 +5,7 @@
 #include "mock_type_test.h"
 #include "mock_loader_test.h"
 #include "ghidra.hh"
+#include "yagirule.hh"
 
 #define FUNC_ADDR 0xaaaaaaaa
 #define FUNC_SIZE 20
@@ -70,4 +71,81 @@ TEST(TestDecompilationPayload_x86_64_gcc, DecompileWithoutType) {
 	arch->print->docFunction(func);
 	
 	ASSERT_STREQ(ss.str().c_str(), "\n__uint32 test(__uint32 param_1)\n\n{\n  if (unk_0xaaac4f4a != 0) {\n    unk_0xaaac4f4a = 0;\n    func_0xaaa9a2ca();\n  }\n  if ((__uint8 *)0xaaac44e8 < unk_0xaaac035a) {\n    func_0xaaaaaa4a();\n  }\n  *unk_0xaaac035a = (char)param_1;\n  unk_0xaaac035a = unk_0xaaac035a + 1;\n  unk_0xaaac4f52 = 0;\n  return param_1;\n}\n");
-}
\ No newline at end of file
+}
+
+#define THUNK_CALLER_ADDR 0x401000
+#define THUNK_ADDR 0x402000
+
+// mov rax, rdi ; call __x86_indirect_thunk_rax ; ret
+static const uint8_t PAYLOAD_THUNK[] = {
+	0x48, 0x89, 0xF8, 0xE8, 0xF8, 0x0F, 0x00, 0x00, 0xC3, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC
+};
+
+// Direct calls to a retpoline thunk are kept, the call spec is bound to the thunk
+TEST(TestDecompilationPayload_x86_64_gcc, CallIndirectThunk) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:64:default:gcc",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memset(ptr, 0xCC, size);
+			auto offset = addr.getOffset() - THUNK_CALLER_ADDR;
+			if (offset < sizeof(PAYLOAD_THUNK))
+			{
+				memcpy(ptr, PAYLOAD_THUNK + offset, std::min<size_t>(size, sizeof(PAYLOAD_THUNK) - offset));
+			}
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == THUNK_CALLER_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					THUNK_CALLER_ADDR, FUNC_NAME, 9, true, false, false, false
+				);
+			}
+			if (ea == THUNK_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					THUNK_ADDR, "__x86_indirect_thunk_rax", 1, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					THUNK_CALLER_ADDR, FUNC_NAME, 9, true, false, false, false
+					)
+				);
+		},
+		{ { "__x86_indirect_thunk_rax", THUNK_ADDR } }),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__stdcall"
+	);
+
+	// same wrappers as the plugin
+	arch->addCallWrapper({ "guard_dispatch_icall_fptr", "RAX" });
+	arch->extra_pool_rules.push_back(new yagi::RuleCallWrapper("analysis"));
+
+	DocumentStorage store;
+	arch->init(store);
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), THUNK_CALLER_ADDR)
+	);
+	arch->performActions(*func);
+
+	arch->setPrintLanguage("c-language");
+
+	stringstream ss;
+	arch->print->setOutputStream(&ss);
+	//print as C
+	arch->print->docFunction(func);
+
+	auto code = ss.str();
+	ASSERT_NE(code.find("__x86_indirect_thunk_rax("), std::string::npos);
+	ASSERT_EQ(code.find("Yagi :"), std::string::npos);
+}
@@ -5,6 +5,7 @@
 #include "mock_type_test.h"
 #include "mock_loader_test.h"
 #include "ghidra.hh"
+#include "exception.hh"
 
 #define FUNC_ADDR 0xaaaaaaaa
 #define FUNC_SIZE 27
@@ -95,6 +96,80 @@ TEST(TestDecompilationPayload_x86_64, DecompileWithoutType) {
 	ASSERT_STREQ(ss.str().c_str(), "\n__uint64 test(__uint64 param_1,int64_t param_2)\n\n{\n  *(__uint32 *)(param_2 + 4) = 0;\n  return 0;\n}\n");
 }
 
+// Instructions are translated once, then read from the lift cache
+TEST(TestDecompilationPayload_x86_64, TranslationIsReused) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	size_t reads = 0;
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:64:default:windows",
+		std::make_unique<MockLoaderFactory>([&reads](uint1* ptr, int4 size, const Address& addr) {
+			reads++;
+			memcpy(ptr, PAYLOAD_1 + addr.getOffset() - FUNC_ADDR, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FUNC_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+					)
+				);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__fastcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+	arch->setPrintLanguage("c-language");
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), FUNC_ADDR)
+	);
+
+	std::vector<std::string> outputs;
+	std::vector<size_t> readsPerRun;
+	for (auto run = 0; run < 3; run++)
+	{
+		// the patch of the last run forgets every instruction of the function
+		if (run == 2)
+		{
+			for (auto ea = FUNC_ADDR; ea < FUNC_ADDR + FUNC_SIZE; ea++)
+			{
+				arch->invalidateCode(ea);
+			}
+		}
+
+		reads = 0;
+		arch->clearAnalysis(func);
+		arch->performActions(*func);
+		readsPerRun.push_back(reads);
+
+		stringstream ss;
+		arch->print->setOutputStream(&ss);
+		arch->print->docFunction(func);
+		outputs.push_back(ss.str());
+	}
+
+	ASSERT_GT(readsPerRun[0], 0);
+	ASSERT_EQ(readsPerRun[1], 0);
+	ASSERT_GT(readsPerRun[2], 0);
+	ASSERT_EQ(outputs[0], outputs[1]);
+	ASSERT_EQ(outputs[0], outputs[2]);
+}
+
 // Demonstrate some basic assertions.
 TEST(TestDecompilationPayload_x86_64, DecompileWithFunctionType) {
 
@@ -166,4 +241,62 @@ TEST(TestDecompilationPayload_x86_64, DecompileWithFunctionType) {
 	arch->print->docFunction(func);
 
 	ASSERT_STREQ(ss.str().c_str(), "\nvoid test(void)\n\n{\n  int64_t in_RDX;\n  \n  *(__uint32 *)(in_RDX + 4) = 0;\n  return;\n}\n");
-}
\ No newline at end of file
+}
+
+// The analysis stopped by its pass limit is done again without rules, and still printed
+TEST(TestDecompilationPayload_x86_64, FallbackIsPrintable) {
+
+	yagi::ghidra::init(std::getenv("GHIDRADIRTEST"));
+
+	auto arch = std::make_unique<yagi::YagiArchitecture>(
+		"test",
+		"x86:LE:64:default:windows",
+		std::make_unique<MockLoaderFactory>([](uint1* ptr, int4 size, const Address& addr) {
+			memcpy(ptr, PAYLOAD_1 + addr.getOffset() - FUNC_ADDR, size);
+		}),
+		std::make_unique<MockLogger>([](const std::string&) {}),
+		std::make_unique<MockSymbolInfoFactory>([](uint64_t ea) -> std::optional<std::unique_ptr<yagi::SymbolInfo>> {
+			if (ea == FUNC_ADDR)
+			{
+				return std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+				);
+			}
+			return std::nullopt; 
+		}, 
+		[](uint64_t func_addr) -> std::optional<std::unique_ptr<yagi::FunctionSymbolInfo>> {
+			return std::make_unique<MockFunctionSymbolInfo>(
+				std::make_unique<MockSymbolInfo>(
+					FUNC_ADDR, FUNC_NAME, FUNC_SIZE, true, false, false, false
+					)
+				);
+		}),
+		std::make_unique<MockTypeInfoFactory>([](uint64_t) { return std::nullopt; }, [](const std::string&) { return std::nullopt; }),
+		"__fastcall"
+	);
+
+	DocumentStorage store;
+	arch->init(store);
+	arch->setPrintLanguage("c-language");
+
+	auto scope = arch->symboltab->getGlobalScope();
+	auto func = scope->findFunction(
+		Address(arch->getDefaultCodeSpace(), FUNC_ADDR)
+	);
+
+	yagi::YagiArchitecture::LargeFunctionLimits limits;
+	limits.passes = 1;
+	arch->setLargeFunctionLimits(limits);
+	ASSERT_THROW(arch->performLargeActions(*func), yagi::AnalysisLimitExceeded);
+
+	arch->clearAnalysis(func);
+	ASSERT_GE(arch->performFallbackActions(*func), 0);
+
+	stringstream ss;
+	arch->print->setOutputStream(&ss);
+	ASSERT_NO_THROW(arch->print->docFunction(func));
+
+	auto output = ss.str();
+	ASSERT_NE(output.find(" test("), std::string::npos);
+	ASSERT_NE(output.find("return"), std::string::npos);
+}
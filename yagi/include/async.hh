@@ -0,0 +1,211 @@
+#ifndef __YAGI_ASYNC__
+#define __YAGI_ASYNC__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "decompiler.hh"
+#include "cancel.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Run one decompilation at a time on a background thread
+	 *			The calling thread polls for the outcome, backend access
+	 *			is expected to go through the request queue (see sync.hh)
+	 *			Invalidations received while a job is running are applied
+	 *			once it is done, the decompiler is never used concurrently
+	 */
+	class AsyncDecompiler
+	{
+	public:
+		/*!
+		 * \brief	What to ask to the decompiler
+		 */
+		enum class Command
+		{
+			Decompile,
+			RefreshNames
+		};
+
+		/*!
+		 * \brief	How a job ended
+		 */
+		enum class Status
+		{
+			Done,		// result is set
+			Failed,		// decompiler returned nothing
+			Canceled,	// cancel was called
+			Expired		// time budget exceeded, result may be a simplified output
+		};
+
+		/*!
+		 * \brief	End of a job
+		 */
+		struct Outcome
+		{
+			uint64_t ea;
+			Status status;
+			std::optional<Decompiler::Result> result;
+
+			/*!
+			 * \brief	duration of the job in milliseconds
+			 */
+			double duration;
+		};
+
+	protected:
+		/*!
+		 * \brief	only used by the job thread while busy
+		 */
+		Decompiler& m_decompiler;
+
+		/*!
+		 * \brief	running job, invalid when idle
+		 */
+		std::future<std::optional<Decompiler::Result>> m_job;
+
+		/*!
+		 * \brief	token checked by the running job
+		 */
+		std::shared_ptr<CancelToken> m_token;
+
+		/*!
+		 * \brief	function of the running job
+		 */
+		uint64_t m_ea = 0;
+
+		/*!
+		 * \brief	start of the running job
+		 */
+		std::chrono::steady_clock::time_point m_start;
+
+		/*!
+		 * \brief	the running job translates types, it has no result
+		 */
+		bool m_prewarm = false;
+
+		/*!
+		 * \brief	budget state at the end of the job
+		 *			written by the job thread, read once the future is ready
+		 */
+		bool m_expired = false;
+
+		/*!
+		 * \brief	set by the job thread just before its end
+		 *			poll waits for the job from then on
+		 */
+		std::atomic<bool> m_done{ false };
+
+		/*!
+		 * \brief	called by the job thread at its end, see setNotify
+		 */
+		std::function<void()> m_notify;
+
+		/*!
+		 * \brief	invalidations received while busy
+		 */
+		std::vector<std::function<void(Decompiler&)>> m_pending;
+
+		/*!
+		 * \brief	Apply an invalidation now or once the job is done
+		 */
+		void apply(std::function<void(Decompiler&)> update);
+
+		/*!
+		 * \brief	Called by the job thread once it no longer needs the caller
+		 */
+		void finish();
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	decompiler	must outlive this object
+		 */
+		explicit AsyncDecompiler(Decompiler& decompiler);
+
+		/*!
+		 * \brief	cancel and wait for the running job
+		 *			The request queue must be processed before,
+		 *			or the job may wait for it forever
+		 */
+		virtual ~AsyncDecompiler();
+
+		/*!
+		 *	\brief	Copy is forbidden
+		 */
+		AsyncDecompiler(const AsyncDecompiler&) = delete;
+		AsyncDecompiler& operator=(const AsyncDecompiler&) = delete;
+
+		/*!
+		 * \brief	Called by the job thread at the end of each job
+		 *			Use to wake up a thread waiting for requests before poll
+		 * \param	notify	must be callable from any thread
+		 */
+		void setNotify(std::function<void()> notify);
+
+		/*!
+		 * \brief	Start a job
+		 * \param	ea		address of the function
+		 * \param	command	what to ask to the decompiler
+		 * \param	budget	time allowed, 0 means unlimited
+		 * \return	false if a job is already running
+		 */
+		bool start(uint64_t ea, Command command, std::chrono::milliseconds budget);
+
+		/*!
+		 * \brief	Start a job that translates types, see Decompiler::prewarmTypes
+		 *			Its outcome has no result, Done once all names are processed
+		 * \param	source	snapshot of the backend types, kept until the end of the job
+		 * \param	names	names of types to translate
+		 * \return	false if a job is already running
+		 */
+		bool startPrewarm(std::shared_ptr<TypeInfoFactory> source, std::vector<std::string> names);
+
+		/*!
+		 * \brief	Is a job running or waiting for poll
+		 */
+		bool isBusy() const noexcept;
+
+		/*!
+		 * \brief	Ask the running job to stop
+		 *			The outcome is still reported by poll
+		 */
+		void cancel() noexcept;
+
+		/*!
+		 * \brief	Collect the end of the running job
+		 *			Never block
+		 * \return	nullopt while the job is running or if idle
+		 */
+		std::optional<Outcome> poll();
+
+		void invalidate(uint64_t funcAddress);
+		void invalidateDependents(uint64_t ea);
+		void invalidateCode(uint64_t ea);
+		void clearCache();
+		void invalidateType(const std::string& name);
+		void invalidateTypes();
+		void retain(uint64_t funcAddress);
+		void release(uint64_t funcAddress);
+
+		/*!
+		 * \brief	Change a state read by the decompiler, like its memory image
+		 *			Run now or once the job is done, in order with invalidations
+		 */
+		void defer(std::function<void()> update);
+
+		/*!
+		 * \brief	Profile the next jobs
+		 * \param	output	destination of reports, null to stop profiling
+		 */
+		void setProfileOutput(std::shared_ptr<ProfileOutput> output);
+	};
+}
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
 
 namespace yagi 
 {
@@ -19,6 +22,55 @@ namespace yagi
 	 *	\param	delimiter	char use as delimiter of the string
 	 */
 	std::vector<std::string> split(const std::string& s, char delimiter);
+
+	/*!
+	 *	\brief	Seed of the FNV-1a hash function
+	 */
+	constexpr uint64_t FNV1A_SEED = 0xcbf29ce484222325ULL;
+
+	/*!
+	 *	\brief	Compute (or continue) a 64 bits FNV-1a hash
+	 *	\param	data	buffer to hash
+	 *	\param	size	size of the buffer in bytes
+	 *	\param	hash	previous hash value, use to chain multiple buffers
+	 *	\return	the new hash value
+	 */
+	uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV1A_SEED);
+
+	/*!
+	 *	\brief	Continue a FNV-1a hash with a string
+	 */
+	uint64_t fnv1a_string(const std::string& data, uint64_t hash = FNV1A_SEED);
+
+	/*!
+	 *	\brief	Write a quoted and escaped JSON string
+	 *	\param	stream	destination
+	 *	\param	value	string to write
+	 */
+	void writeJsonString(std::ostream& stream, const std::string& value);
+
+	/*!
+	 *	\brief	Stream buffer that appends to a string
+	 *			Use instead of a stringstream to avoid copying the result
+	 */
+	class StringBuffer : public std::streambuf
+	{
+	protected:
+		/*!
+		 *	\brief	destination of written characters
+		 */
+		std::string& m_target;
+
+		int_type overflow(int_type c) override;
+		std::streamsize xsputn(const char* s, std::streamsize count) override;
+
+	public:
+		/*!
+		 *	\brief	ctor
+		 *	\param	target	string to append to, must outlive the buffer
+		 */
+		explicit StringBuffer(std::string& target);
+	};
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,276 @@
+#ifndef __YAGI_BATCH__
+#define __YAGI_BATCH__
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "decompiler.hh"
+#include "prototype.hh"
+#include "sync.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Destination of a batch decompilation
+	 *			Results are written as soon as they are produced
+	 */
+	class BatchOutput
+	{
+	public:
+		virtual ~BatchOutput() = default;
+
+		/*!
+		 * \brief	Write the result of a function
+		 *			Never called concurrently
+		 * \param	ea			address of the function
+		 * \param	result		decompilation result, nullopt if it failed
+		 * \param	duration	decompilation time in milliseconds
+		 */
+		virtual void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) = 0;
+	};
+
+	/*!
+	 * \brief	Write every function into a single source file
+	 *			Each function is preceded by a comment with its timing
+	 */
+	class FileBatchOutput : public BatchOutput
+	{
+	protected:
+		std::ofstream m_stream;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	path	path of the output file
+		 * \raise	UnableToOpenOutput
+		 */
+		explicit FileBatchOutput(const std::filesystem::path& path);
+
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override;
+	};
+
+	/*!
+	 * \brief	Write one source file per function into a directory
+	 *			Timing of every function is saved into timing.csv
+	 */
+	class DirectoryBatchOutput : public BatchOutput
+	{
+	protected:
+		std::filesystem::path m_directory;
+		std::ofstream m_timing;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			The directory is created if needed
+		 * \param	directory	output directory
+		 * \raise	UnableToOpenOutput
+		 */
+		explicit DirectoryBatchOutput(const std::filesystem::path& directory);
+
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override;
+	};
+
+	/*!
+	 * \brief	Write results as a JSON array, one object per function
+	 *			with its code, the symbols it references, its tokens and its timing
+	 *			Use to return results to scripts and tools
+	 */
+	class JsonBatchOutput : public BatchOutput
+	{
+	protected:
+		std::ostream& m_stream;
+
+		size_t m_count = 0;
+
+		bool m_closed = false;
+
+	public:
+		/*!
+		 * \brief	ctor, open the array
+		 * \param	stream	destination, must outlive the output
+		 */
+		explicit JsonBatchOutput(std::ostream& stream);
+
+		/*!
+		 * \brief	destructor, close the array if needed
+		 */
+		virtual ~JsonBatchOutput();
+
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override;
+
+		/*!
+		 * \brief	Close the array, nothing is written afterwards
+		 */
+		void close();
+	};
+
+	/*!
+	 * \brief	Decompile a list of functions using a pool of decompilers
+	 *			Each decompiler runs into its own thread, backend access
+	 *			is expected to go through the request queue (see sync.hh)
+	 */
+	class BatchDecompiler
+	{
+	public:
+		/*!
+		 * \brief	Summary of a batch
+		 */
+		struct Report
+		{
+			size_t decompiled = 0;
+
+			/*!
+			 * \brief	functions written from the result of an identical one
+			 */
+			size_t reused = 0;
+			size_t failed = 0;
+			bool canceled = false;
+			double duration = 0;
+		};
+
+		/*!
+		 * \brief	Progress callback, called from the owner thread
+		 *			Return false to cancel the batch
+		 */
+		using Progress = std::function<bool(size_t done, size_t total)>;
+
+		/*!
+		 * \brief	Called from the owner thread once a wave is done
+		 *			with the prototypes recovered by the wave
+		 */
+		using WaveDone = std::function<void(const std::vector<std::pair<uint64_t, std::shared_ptr<const Prototype>>>& prototypes)>;
+
+		/*!
+		 * \brief	Identify functions which decompile the same way
+		 *			except for their name and addresses
+		 */
+		struct CloneKey
+		{
+			/*!
+			 * \brief	see FunctionSymbolInfo::getCloneHash
+			 */
+			uint64_t hash;
+
+			/*!
+			 * \brief	size of the function, addresses into it are moved
+			 */
+			uint64_t size;
+
+			/*!
+			 * \brief	name of the function
+			 */
+			std::string name;
+		};
+
+		/*!
+		 * \brief	Called from the owner thread before a wave
+		 *			nullopt if the function must be decompiled anyway
+		 */
+		using CloneKeyProvider = std::function<std::optional<CloneKey>(uint64_t ea)>;
+
+	protected:
+		/*!
+		 * \brief	queue processed while workers are running
+		 */
+		RequestQueue& m_queue;
+
+		/*!
+		 * \brief	independent decompilers, one per thread
+		 */
+		std::vector<std::unique_ptr<Decompiler>> m_workers;
+
+		/*!
+		 * \brief	empty to decompile every function
+		 */
+		CloneKeyProvider m_cloneKey;
+
+		/*!
+		 * \brief	Functions identical to a decompiled one
+		 */
+		struct CloneGroup
+		{
+			/*!
+			 * \brief	size of the decompiled function
+			 */
+			uint64_t size = 0;
+
+			/*!
+			 * \brief	address and name of other functions
+			 */
+			std::vector<std::pair<uint64_t, std::string>> clones;
+		};
+
+		/*!
+		 * \brief	Group identical functions of a wave
+		 * \param	functions	address of functions of the wave
+		 * \param	groups		clones of each function to decompile [out]
+		 * \return	functions to decompile, the first one of each group
+		 */
+		std::vector<uint64_t> groupClones(const std::vector<uint64_t>& functions, std::vector<CloneGroup>& groups);
+
+		/*!
+		 * \brief	Decompile one wave with all workers
+		 *			Clones of a function are written from its result
+		 * \param	wave		address of functions of the wave
+		 * \param	output		destination of results
+		 * \param	progress	optional progress callback
+		 * \param	done		functions done by previous waves
+		 * \param	total		functions of all waves
+		 * \param	report		summary updated with the wave
+		 * \param	prototypes	output of recovered prototypes, null to ignore them
+		 */
+		void runWave(const std::vector<uint64_t>& wave, BatchOutput& output, const Progress& progress, size_t done, size_t total, Report& report, std::vector<std::pair<uint64_t, std::shared_ptr<const Prototype>>>* prototypes);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	queue	queue used by workers to reach the owner thread
+		 * \param	workers	decompilers, they must not share any state
+		 */
+		explicit BatchDecompiler(RequestQueue& queue, std::vector<std::unique_ptr<Decompiler>> workers);
+
+		/*!
+		 *	\brief	Copy is forbidden due to unique ptr
+		 */
+		BatchDecompiler(const BatchDecompiler&) = delete;
+		BatchDecompiler& operator=(const BatchDecompiler&) = delete;
+
+		/*!
+		 * \brief	Decompile identical functions once
+		 *			Others are written from its result with their name and addresses
+		 * \param	provider	key of each function, empty to decompile all of them
+		 */
+		void setCloneKey(CloneKeyProvider provider);
+
+		/*!
+		 * \brief	Decompile all functions
+		 *			Must be called from the owner thread of the queue
+		 * \param	functions	address of functions to decompile
+		 * \param	output		destination of results
+		 * \param	progress	optional progress callback
+		 * \return	summary of the batch
+		 */
+		Report run(const std::vector<uint64_t>& functions, BatchOutput& output, const Progress& progress);
+
+		/*!
+		 * \brief	Decompile functions wave after wave
+		 *			A wave starts once the previous one is done
+		 *			so its functions can use prototypes recovered before
+		 *			Must be called from the owner thread of the queue
+		 * \param	waves		address of functions of each wave, see CallGraph
+		 * \param	output		destination of results
+		 * \param	progress	optional progress callback
+		 * \param	waveDone	optional callback called after each wave
+		 * \return	summary of the batch
+		 */
+		Report run(const std::vector<std::vector<uint64_t>>& waves, BatchOutput& output, const Progress& progress, const WaveDone& waveDone);
+	};
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __YAGI_CACHEDLOADER__
+#define __YAGI_CACHEDLOADER__
+
+#include "loader.hh"
+#include "pagecache.hh"
+#include <memory>
+#include <libdecomp.hh>
+
+namespace yagi 
+{
+	/*!
+	 * \brief	Implement the LoadImage interface of Ghidra
+	 *			over a cache of pages in front of a slow loader
+	 *			Sleigh and the string manager read a few bytes at a time,
+	 *			only missing pages reach the inner loader
+	 */
+	class CachedLoader : public LoadImage
+	{
+	protected:
+		/*!
+		 * \brief	pages shared by every loader of the same program
+		 */
+		std::shared_ptr<PageCache> m_cache;
+
+		/*!
+		 * \brief	loader used to fetch missing pages
+		 */
+		std::unique_ptr<LoadImage> m_inner;
+
+	public:
+		/*!
+		 * \brief	constructor
+		 * \param	cache	shared pages
+		 * \param	inner	loader used to fetch missing pages
+		 */
+		explicit CachedLoader(std::shared_ptr<PageCache> cache, std::unique_ptr<LoadImage> inner);
+
+		/*!
+		 * \brief	Copy is forbidden due to unique ptr
+		 */
+		CachedLoader(const CachedLoader&) = delete;
+		CachedLoader& operator=(const CachedLoader&) = delete;
+
+		/*!
+		 * \brief	Return the arch type of the inner loader
+		 */
+		std::string getArchType(void) const override;
+
+		/*!
+		 * \brief	Copy data from the cache, missing pages are read by the inner loader
+		 * \param	ptr	buffer pointer
+		 * \param	size	size of expected data
+		 * \param	addr	address of the payload
+		 */
+		void loadFill(uint1* ptr, int4 size, const Address& addr) override;
+
+		/*!
+		 * \brief	Adjust VMA
+		 * \param	adjust
+		 */
+		void adjustVma(long adjust) override;
+	};
+
+	/*!
+	 * \brief	Build cached loaders sharing the same pages
+	 */
+	class CachedLoaderFactory : public LoaderFactory
+	{
+	protected:
+		std::shared_ptr<PageCache> m_cache;
+		std::unique_ptr<LoaderFactory> m_inner;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	cache	shared pages
+		 * \param	inner	factory of the loader used to fetch missing pages
+		 */
+		explicit CachedLoaderFactory(std::shared_ptr<PageCache> cache, std::unique_ptr<LoaderFactory> inner);
+
+		/*!
+		 * \brief	build a cached loader around a new inner loader
+		 */
+		LoadImage* build() override;
+	};
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __YAGI_CALLGRAPH__
+#define __YAGI_CALLGRAPH__
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Calls between functions of a program
+	 *			Use to decompile callees before their callers
+	 */
+	class CallGraph
+	{
+	protected:
+		/*!
+		 * \brief	callees of each function
+		 */
+		std::map<uint64_t, std::vector<uint64_t>> m_callees;
+
+	public:
+		/*!
+		 * \brief	Add a function without any call
+		 * \param	ea	start address of the function
+		 */
+		void addFunction(uint64_t ea);
+
+		/*!
+		 * \brief	Add a call between two functions
+		 *			Calls to an address which is not a function are ignored
+		 * \param	caller	start address of the calling function
+		 * \param	callee	start address of the called function
+		 */
+		void addCall(uint64_t caller, uint64_t callee);
+
+		/*!
+		 * \brief	Number of functions
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	Group functions by call depth, leaf functions first
+		 *			A function only calls functions of previous waves
+		 *			except mutually recursive functions which share a wave
+		 * \return	waves of function addresses, sorted by address
+		 */
+		std::vector<std::vector<uint64_t>> getWaves() const;
+	};
+}
+
+#endif
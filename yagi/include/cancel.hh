@@ -0,0 +1,71 @@
+#ifndef __YAGI_CANCEL__
+#define __YAGI_CANCEL__
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Cancellation state of a decompilation
+	 *			Shared between the thread that run the decompilation
+	 *			and the one that may cancel it
+	 */
+	class CancelToken
+	{
+	protected:
+		/*!
+		 * \brief	set by cancel
+		 */
+		std::atomic<bool> m_canceled{ false };
+
+		/*!
+		 * \brief	end of the time budget, if any
+		 */
+		std::optional<std::chrono::steady_clock::time_point> m_deadline;
+
+	public:
+		/*!
+		 * \brief	ctor of a token without budget
+		 */
+		CancelToken() = default;
+
+		/*!
+		 * \brief	ctor
+		 * \param	budget	time allowed from now, 0 means unlimited
+		 */
+		explicit CancelToken(std::chrono::milliseconds budget);
+
+		/*!
+		 * \brief	Copy is forbidden, the token is shared
+		 */
+		CancelToken(const CancelToken&) = delete;
+		CancelToken& operator=(const CancelToken&) = delete;
+
+		/*!
+		 * \brief	Request the decompilation to stop
+		 *			Can be called from any thread
+		 */
+		void cancel() noexcept;
+
+		/*!
+		 * \brief	Was cancel called
+		 */
+		bool isCanceled() const noexcept;
+
+		/*!
+		 * \brief	Is the time budget exceeded
+		 */
+		bool isExpired() const noexcept;
+
+		/*!
+		 * \brief	Stop the current decompilation if needed
+		 * \raise	DecompilationCanceled if canceled
+		 * \raise	DecompilationTimeout if the budget is exceeded
+		 */
+		void check() const;
+	};
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef __YAGI_COMPACTRESULT__
+#define __YAGI_COMPACTRESULT__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "decompiler.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Spaces of the symbols printed by Ghidra
+	 *			Other spaces are kept by name in the result
+	 */
+	enum class SpaceId : uint8_t
+	{
+		Ram,
+		Stack,
+		Register,
+		Unique,
+		Const,
+		Other
+	};
+
+	/*!
+	 * \brief	Decompiler::Result held with few allocations
+	 *			Kept by the result cache and by viewers, a result
+	 *			is only expanded when it leaves the cache
+	 *			Symbol names share one string pool, pcode addresses
+	 *			of all symbols one array, and spaces are interned
+	 */
+	class CompactResult
+	{
+	public:
+		/*!
+		 * \brief	A symbol referenced by the code
+		 */
+		struct Symbol
+		{
+			/*!
+			 * \brief	offset in memory space range
+			 */
+			uint64_t offset;
+
+			/*!
+			 * \brief	name as printed, into the string pool
+			 */
+			uint32_t name;
+			uint32_t nameSize;
+
+			/*!
+			 * \brief	pcode address definitions, into the pc array
+			 */
+			uint32_t pc;
+			uint32_t pcCount;
+
+			uint32_t addrSize;
+
+			SpaceId space;
+
+			/*!
+			 * \brief	index of the space name if space is Other
+			 */
+			uint8_t otherSpace;
+		};
+
+	protected:
+		std::string m_code;
+		std::string m_name;
+		uint64_t m_ea;
+
+		/*!
+		 * \brief	names of symbols, each stored once
+		 */
+		std::string m_strings;
+
+		/*!
+		 * \brief	names of spaces without SpaceId
+		 */
+		std::vector<std::string> m_spaces;
+
+		/*!
+		 * \brief	symbols in their order of the result, tokens index them
+		 */
+		std::vector<Symbol> m_symbols;
+
+		/*!
+		 * \brief	index of symbols sorted by name, then by index
+		 */
+		std::vector<uint32_t> m_byName;
+
+		std::vector<uint64_t> m_pcs;
+		std::vector<Decompiler::Token> m_tokens;
+		std::shared_ptr<const Prototype> m_prototype;
+		Decompiler::Dependencies m_dependencies;
+
+	public:
+		/*!
+		 * \brief	ctor, pack a result
+		 */
+		explicit CompactResult(Decompiler::Result result);
+
+		/*!
+		 * \brief	Rebuild the full result
+		 */
+		Decompiler::Result toResult() const;
+
+		/*!
+		 * \brief	Move the code out, the viewer keeps it in its line store
+		 */
+		std::string takeCode();
+
+		const std::string& getCode() const noexcept;
+		const std::string& getName() const noexcept;
+		uint64_t getEa() const noexcept;
+		const std::vector<Symbol>& getSymbols() const noexcept;
+		const Decompiler::Dependencies& getDependencies() const noexcept;
+
+		std::string_view getSymbolName(const Symbol& symbol) const noexcept;
+		std::string_view getSpaceName(const Symbol& symbol) const noexcept;
+
+		/*!
+		 * \brief	Storage of a symbol, as expected by symbol edits
+		 */
+		MemoryLocation getLocation(const Symbol& symbol) const;
+
+		/*!
+		 * \brief	Find the symbol printed at a position
+		 * \param	line	line of the cursor
+		 * \param	column	column of the cursor, color tags excluded
+		 * \return	nullptr if there is no symbol under the cursor
+		 */
+		const Symbol* findSymbol(uint32_t line, uint32_t column) const;
+
+		/*!
+		 * \brief	Find the first symbol with this name
+		 * \return	nullptr if no symbol match
+		 */
+		const Symbol* findSymbol(std::string_view name) const;
+	};
+
+	/*!
+	 * \brief	Interned id of the space of a memory location
+	 */
+	SpaceId toSpaceId(std::string_view spaceName) noexcept;
+}
+
+#endif
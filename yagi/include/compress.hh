@@ -0,0 +1,26 @@
+#ifndef __YAGI_COMPRESS__
+#define __YAGI_COMPRESS__
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Compress a buffer with a fast LZ77 scheme, sequences of the LZ4 block format
+	 *			Decompiled code is mostly made of repeated identifiers and keywords
+	 * \param	input	buffer to compress
+	 * \return	size of the input followed by the compressed block
+	 */
+	std::vector<uint8_t> compressBuffer(const std::vector<uint8_t>& input);
+
+	/*!
+	 * \brief	Decompress a buffer created by compressBuffer
+	 * \param	input	compressed buffer
+	 * \return	nullopt if the buffer is malformed
+	 */
+	std::optional<std::vector<uint8_t>> decompressBuffer(const std::vector<uint8_t>& input);
+}
+
+#endif
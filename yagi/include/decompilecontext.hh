@@ -0,0 +1,87 @@
+#ifndef __YAGI_DECOMPILECONTEXT__
+#define __YAGI_DECOMPILECONTEXT__
+
+#include "decompiler.hh"
+#include "symbolinfo.hh"
+
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace yagi
+{
+	/*!
+	 * \brief	State of the function being decompiled
+	 *			Resolved once by the decompiler and shared by all actions
+	 *			so the backend is not queried again by each of them
+	 */
+	class DecompileContext
+	{
+	protected:
+		/*!
+		 * \brief	the function, its frame index is built on first lookup
+		 */
+		std::unique_ptr<FunctionSymbolInfo> m_function;
+
+		/*!
+		 * \brief	stored names and types, loaded on first use
+		 */
+		std::optional<LocalOverrides> m_overrides;
+
+		/*!
+		 * \brief	addresses of items read from the backend
+		 */
+		std::set<uint64_t> m_addresses;
+
+		/*!
+		 * \brief	names of used types
+		 */
+		std::set<std::string> m_types;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	function	the decompiled function
+		 */
+		explicit DecompileContext(std::unique_ptr<FunctionSymbolInfo> function);
+
+		/*!
+		 * \brief	Start address of the function
+		 */
+		uint64_t getAddress();
+
+		FunctionSymbolInfo& getFunction() noexcept;
+
+		/*!
+		 * \brief	Stored names and types of the function
+		 *			Read from the backend once per decompilation
+		 */
+		const LocalOverrides& getOverrides();
+
+		/*!
+		 * \brief	The output depends on the item at an address
+		 * \param	ea	address of a global, a callee, an import or a label
+		 */
+		void addDependency(uint64_t ea);
+
+		/*!
+		 * \brief	The output depends on a type
+		 * \param	type	name of the type
+		 * \return	false if the type was already recorded
+		 */
+		bool addDependency(const std::string& type);
+
+		/*!
+		 * \brief	Record dependencies of a previous pass on the same function
+		 */
+		void addDependencies(const Decompiler::Dependencies& dependencies);
+
+		/*!
+		 * \brief	Everything recorded since the start of the decompilation
+		 */
+		Decompiler::Dependencies getDependencies() const;
+	};
+}
+
+#endif
@@ -2,12 +2,19 @@
 #define __YAGI_IDECOMPILE__
 
 #include <string>
-#include <map>
+#include <memory>
 #include <optional>
 #include <vector>
+#include <cstdint>
+#include <algorithm>
 
 namespace yagi 
 {
+	class CancelToken;
+	class ProfileOutput;
+	class TypeInfoFactory;
+	struct Prototype;
+
 	/*!
 	 * \brief Memory location
 	 */
@@ -72,15 +79,25 @@ namespace yagi
 			M64				// 64 bits
 		};
 
+		/*!
+		 * \brief	Instruction set selected by a context register
+		 */
+		enum class Isa {
+			Default,		// main instruction set of the language
+			Thumb,			// ARM Thumb (TMode)
+			Mips16			// MIPS16e (ISA_MODE)
+		};
+
 		Language	language;
 		Endianess	endianess;
 		Mode		mode;
+		Isa			isa;
 
 		/*!
 		 * \brief	Constructor
 		 */
-		Compiler(Language language, Endianess endianess, Mode mode)
-			: language {language}, endianess{endianess}, mode{mode}
+		Compiler(Language language, Endianess endianess, Mode mode, Isa isa = Isa::Default)
+			: language {language}, endianess{endianess}, mode{mode}, isa{isa}
 		{}
 	};
 
@@ -91,6 +108,106 @@ namespace yagi
 	{
 	public:
 
+		/*!
+		 * \brief	A symbol referenced by the decompiled code
+		 */
+		struct Symbol
+		{
+			/*!
+			 * \brief	name as printed
+			 */
+			std::string name;
+
+			/*!
+			 * \brief	storage of the symbol
+			 */
+			MemoryLocation location;
+
+			Symbol(std::string name, MemoryLocation location)
+				: name{ std::move(name) }, location{ std::move(location) }
+			{}
+		};
+
+		/*!
+		 * \brief	What a printed token is
+		 */
+		enum class TokenKind : uint8_t
+		{
+			Syntax,			// punctuation, parentheses and spaces
+			Keyword,		// keywords of the language
+			Operator,		// operators of expressions
+			Variable,		// locals, parameters and globals
+			FunctionName,	// called or defined functions
+			Type,			// type names
+			Field,			// fields of structures
+			Constant,		// numbers, characters and strings
+			Label,			// goto labels
+			Comment			// comments and warnings
+		};
+
+		/*!
+		 * \brief	Span of a printed token
+		 *			Columns exclude color tags
+		 *			Only symbols are kept unless the token_stream option is set
+		 */
+		struct Token
+		{
+			/*!
+			 * \brief	line of the token
+			 */
+			uint32_t line;
+
+			/*!
+			 * \brief	first column of the token
+			 */
+			uint32_t start;
+
+			/*!
+			 * \brief	column after the last character
+			 */
+			uint32_t end;
+
+			/*!
+			 * \brief	index into the symbols of the result
+			 *			out of range if the token is not a symbol
+			 */
+			uint32_t symbol;
+
+			TokenKind kind = TokenKind::Variable;
+
+			/*!
+			 * \brief	syntax highlight class given by the Ghidra printer
+			 */
+			uint8_t highlight = 0;
+		};
+
+		/*!
+		 * \brief	Items of the database read by a decompilation
+		 *			Its result is out of date once one of them changes
+		 */
+		struct Dependencies
+		{
+			/*!
+			 * \brief	globals, callees, imports and labels, sorted
+			 */
+			std::vector<uint64_t> addresses;
+
+			/*!
+			 * \brief	names of used types and of their nested types, sorted
+			 */
+			std::vector<std::string> types;
+
+			bool dependsOn(uint64_t ea) const
+			{
+				return std::binary_search(addresses.begin(), addresses.end(), ea);
+			}
+
+			bool dependsOn(const std::string& type) const
+			{
+				return std::binary_search(types.begin(), types.end(), type);
+			}
+		};
+
 		/*!
 		 * \brief	result of the decompiler 
 		 */
@@ -112,16 +229,86 @@ namespace yagi
 			uint64_t ea;
 
 			/*!
-			 * \brief	a mapping between token symbol and address
+			 * \brief	every symbol referenced by the code
+			 */
+			std::vector<Symbol> symbols;
+
+			/*!
+			 * \brief	printed symbols sorted by line and column
+			 */
+			std::vector<Token> tokens;
+
+			/*!
+			 * \brief	prototype recovered by the analysis
+			 *			null if the output is not fully analyzed
+			 */
+			std::shared_ptr<const Prototype> prototype;
+
+			/*!
+			 * \brief	what the output was computed from
 			 */
-			std::map<std::string, MemoryLocation> symbolAddress;
+			Dependencies dependencies;
 
 			/*!
 			 * \brief	ctor
 			 */
-			Result(std::string name, uint64_t ea, std::string cCode, std::map<std::string, MemoryLocation> symbolAddress)
-				: name{ name }, ea { ea }, cCode{ cCode }, symbolAddress{ symbolAddress }
+			Result(std::string name, uint64_t ea, std::string cCode, std::vector<Symbol> symbols, std::vector<Token> tokens = {})
+				: cCode{ std::move(cCode) }, name{ std::move(name) }, ea{ ea }, symbols{ std::move(symbols) }, tokens{ std::move(tokens) }
 			{}
+
+			/*!
+			 * \brief	Find the symbol printed at a position
+			 * \param	line	line of the cursor
+			 * \param	column	column of the cursor, color tags excluded
+			 * \return	nullptr if there is no symbol under the cursor
+			 */
+			const Symbol* findSymbol(uint32_t line, uint32_t column) const
+			{
+				auto token = findToken(tokens, line, column);
+				if (token == nullptr || token->symbol >= symbols.size())
+				{
+					return nullptr;
+				}
+				return &symbols[token->symbol];
+			}
+
+			/*!
+			 * \brief	Find the token printed at a position
+			 * \param	tokens	tokens sorted by line and column
+			 * \return	nullptr if there is no token under the cursor
+			 */
+			static const Token* findToken(const std::vector<Token>& tokens, uint32_t line, uint32_t column)
+			{
+				auto iter = std::upper_bound(tokens.begin(), tokens.end(), std::make_pair(line, column),
+					[](const std::pair<uint32_t, uint32_t>& position, const Token& token) {
+						return position < std::make_pair(token.line, token.start);
+					}
+				);
+
+				if (iter == tokens.begin())
+				{
+					return nullptr;
+				}
+
+				--iter;
+				if (iter->line != line || column >= iter->end)
+				{
+					return nullptr;
+				}
+				return &(*iter);
+			}
+
+			/*!
+			 * \brief	Find the first symbol with this name
+			 * \return	nullptr if no symbol match
+			 */
+			const Symbol* findSymbol(const std::string& symbolName) const
+			{
+				auto iter = std::find_if(symbols.begin(), symbols.end(), [&](const Symbol& symbol) {
+					return symbol.name == symbolName;
+				});
+				return iter == symbols.end() ? nullptr : &(*iter);
+			}
 		};
 
 		virtual ~Decompiler() = default;
@@ -132,6 +319,94 @@ namespace yagi
 		 * \return	decompiled source code
 		 */
 		virtual std::optional<Result> decompile(uint64_t funcAddress) = 0;
+
+		/*!
+		 * \brief	Update the output after a change of local variable names
+		 *			Fall back to a full decompilation if the analysis
+		 *			of the function is no longer held, see retain
+		 * \param	funcAddress	address of the function to refresh
+		 * \return	decompiled source code
+		 */
+		virtual std::optional<Result> refreshNames(uint64_t funcAddress) = 0;
+
+		/*!
+		 * \brief	Forget any cached result of a function
+		 * \param	funcAddress	address of the function
+		 */
+		virtual void invalidate(uint64_t funcAddress) = 0;
+
+		/*!
+		 * \brief	Forget results that read an item of the database
+		 *			Use when a global, a function or an import
+		 *			is renamed, retyped or patched
+		 * \param	ea	address of the changed item
+		 */
+		virtual void invalidateDependents(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Forget translated instructions that cover a patched byte
+		 * \param	ea	address of the patched byte
+		 */
+		virtual void invalidateCode(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Forget all cached results
+		 *			Use when a change in the database can impact any function
+		 */
+		virtual void clearCache() = 0;
+
+		/*!
+		 * \brief	Forget the translation of a type
+		 *			and results that used it
+		 *			Use when a local type of the database is changed
+		 * \param	name	name of the type
+		 */
+		virtual void invalidateType(const std::string& name) = 0;
+
+		/*!
+		 * \brief	Forget the translation of all types
+		 *			Use when the changed type is unknown
+		 */
+		virtual void invalidateTypes() = 0;
+
+		/*!
+		 * \brief	Keep the analysis of a function while it is shown
+		 *			so refreshNames doesn't fall back to a full decompilation
+		 *			Calls are counted, each one is matched by a release
+		 * \param	funcAddress	address of the shown function
+		 */
+		virtual void retain(uint64_t funcAddress) = 0;
+
+		/*!
+		 * \brief	The function is no longer shown by a viewer, see retain
+		 * \param	funcAddress	address of the function
+		 */
+		virtual void release(uint64_t funcAddress) = 0;
+
+		/*!
+		 * \brief	Token checked by the next decompilations
+		 *			Set by the thread that run decompilations
+		 * \param	token	cancellation state, null to never stop
+		 */
+		virtual void setCancelToken(std::shared_ptr<const CancelToken> token) = 0;
+
+		/*!
+		 * \brief	Profile the next decompilations
+		 *			One report per decompiled function
+		 * \param	output	destination of reports, null to stop profiling
+		 */
+		virtual void setProfileOutput(std::shared_ptr<ProfileOutput> output) = 0;
+
+		/*!
+		 * \brief	Translate types ahead of the decompilations that use them
+		 *			Types are read from the source instead of the backend
+		 *			and kept until one of them changes
+		 *			Stop once canceled, see setCancelToken
+		 * \param	source	snapshot of the backend types
+		 * \param	names	names of types to translate
+		 * \return	number of names processed before the end or the cancel
+		 */
+		virtual size_t prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names) = 0;
 	};
 }
 
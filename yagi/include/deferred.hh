@@ -0,0 +1,117 @@
+#ifndef __YAGI_DEFERRED__
+#define __YAGI_DEFERRED__
+
+#include "decompiler.hh"
+#include "logger.hh"
+
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Decompiler built by a background thread
+	 *			Decompilations wait for the end of the build
+	 *			Invalidations are dropped while the build is running
+	 *			because the decompiler has nothing to invalidate yet
+	 */
+	class DeferredDecompiler : public Decompiler
+	{
+	public:
+		/*!
+		 * \brief	Build the decompiler, may return null on failure
+		 */
+		using Builder = std::function<std::unique_ptr<Decompiler>()>;
+
+	protected:
+		/*!
+		 * \brief	result of the background build
+		 */
+		std::future<std::unique_ptr<Decompiler>> m_future;
+
+		/*!
+		 * \brief	built decompiler, null until the future is resolved
+		 */
+		std::unique_ptr<Decompiler> m_decompiler;
+
+		/*!
+		 * \brief	true when the future was resolved
+		 */
+		bool m_resolved = false;
+
+		/*!
+		 * \brief	token applied to the decompiler once built
+		 */
+		std::shared_ptr<const CancelToken> m_cancel;
+
+		/*!
+		 * \brief	profile output applied to the decompiler once built
+		 */
+		std::shared_ptr<ProfileOutput> m_profile;
+
+		/*!
+		 * \brief	use to report a wait or a failed build
+		 */
+		std::unique_ptr<Logger> m_logger;
+
+		/*!
+		 * \brief	Wait for the build
+		 * \return	the decompiler or nullptr if the build failed
+		 */
+		Decompiler* resolve();
+
+		/*!
+		 * \brief	The decompiler if the build is already done
+		 * \return	nullptr while building or if the build failed
+		 */
+		Decompiler* ready();
+
+	public:
+		/*!
+		 * \brief	ctor, start the build
+		 * \param	builder	run from a background thread
+		 * \param	logger	use from the calling thread
+		 */
+		explicit DeferredDecompiler(Builder builder, std::unique_ptr<Logger> logger);
+
+		/*!
+		 * \brief	wait for the build before destroying the decompiler
+		 */
+		virtual ~DeferredDecompiler();
+
+		/*!
+		 *	\brief	Copy is forbidden
+		 */
+		DeferredDecompiler(const DeferredDecompiler&) = delete;
+		DeferredDecompiler& operator=(const DeferredDecompiler&) = delete;
+
+		/*!
+		 * \brief	Wait for the end of the build
+		 * \return	true if the decompiler is available
+		 */
+		bool wait();
+
+		/*!
+		 * \brief	Is the build done, never block
+		 *			Use to keep processing requests the build may wait for
+		 */
+		bool isBuilt() const;
+
+		std::optional<Result> decompile(uint64_t funcAddress) override;
+		std::optional<Result> refreshNames(uint64_t funcAddress) override;
+		void invalidate(uint64_t funcAddress) override;
+		void invalidateDependents(uint64_t ea) override;
+		void invalidateCode(uint64_t ea) override;
+		void clearCache() override;
+		void invalidateType(const std::string& name) override;
+		void invalidateTypes() override;
+		void retain(uint64_t funcAddress) override;
+		void release(uint64_t funcAddress) override;
+		void setCancelToken(std::shared_ptr<const CancelToken> token) override;
+		void setProfileOutput(std::shared_ptr<ProfileOutput> output) override;
+		size_t prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names) override;
+	};
+}
+
+#endif
@@ -130,6 +130,77 @@ namespace yagi
 	public:
 		explicit UnableToFoundGhidraFolder();
 	};
+
+	/*!
+	 * \brief	Unable to create an output file
+	 */
+	class UnableToOpenOutput : public Error
+	{
+	public:
+		explicit UnableToOpenOutput(const std::string& path);
+	};
+
+	/*!
+	 * \brief	The decompilation was canceled by the user
+	 */
+	class DecompilationCanceled : public Error
+	{
+	protected:
+		explicit DecompilationCanceled(std::string reason);
+
+	public:
+		explicit DecompilationCanceled();
+	};
+
+	/*!
+	 * \brief	The decompilation exceeded its time budget
+	 */
+	class DecompilationTimeout : public DecompilationCanceled
+	{
+	protected:
+		explicit DecompilationTimeout(std::string reason);
+
+	public:
+		explicit DecompilationTimeout();
+	};
+
+	/*!
+	 * \brief	The main simplification loop exceeded its passes
+	 *			in large function mode, handled as a time budget
+	 */
+	class AnalysisLimitExceeded : public DecompilationTimeout
+	{
+	public:
+		explicit AnalysisLimitExceeded();
+	};
+
+	/*!
+	 * \brief	The function has too many ops for the full analysis
+	 *			it must be analyzed again in large function mode
+	 */
+	class LargeFunction : public Error
+	{
+	public:
+		explicit LargeFunction(size_t ops);
+	};
+
+	/*!
+	 * \brief	An exported database can not be read
+	 */
+	class InvalidExport : public Error
+	{
+	public:
+		explicit InvalidExport(const std::string& reason);
+	};
+
+	/*!
+	 * \brief	A regression run can not be read
+	 */
+	class InvalidRegressionRun : public Error
+	{
+	public:
+		explicit InvalidRegressionRun(const std::string& path);
+	};
 }
 
 #endif
@@ -0,0 +1,275 @@
+#ifndef __YAGI_EXPORTDATABASE__
+#define __YAGI_EXPORTDATABASE__
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "decompiler.hh"
+#include "memoryimage.hh"
+#include "symbolinfo.hh"
+#include "typeinfo.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Everything the decompiler reads from a database
+	 *			(segments, names, imports, function bounds and types)
+	 *			Built once by the plugin and written in the format
+	 *			of exportformat.hh, read back through ExportView
+	 *			Types are flattened into a table and referenced by index
+	 */
+	class ExportDatabase
+	{
+	public:
+		/*!
+		 * \brief	Index into the type table
+		 */
+		using TypeIndex = uint32_t;
+
+		/*!
+		 * \brief	A memory segment
+		 *			Bytes of loaded segments are taken from the image
+		 */
+		struct Segment
+		{
+			uint64_t start;
+			uint64_t end;
+			std::string name;
+			uint32_t perm;		// see exportformat::SegmentPerm
+			bool loaded;
+		};
+
+		/*!
+		 * \brief	An imported function
+		 */
+		struct Import
+		{
+			std::string module;
+			std::string name;
+		};
+
+		/*!
+		 * \brief	Function part of a type, see FuncInfo
+		 */
+		struct Func
+		{
+			bool dotDotDot = false;
+
+			/*!
+			 * \brief	nullopt if the calling convention is unknown
+			 */
+			std::optional<std::string> callingConv;
+
+			/*!
+			 * \brief	return type followed by parameter types
+			 */
+			std::vector<TypeIndex> prototype;
+
+			/*!
+			 * \brief	return name followed by parameter names
+			 */
+			std::vector<std::string> paramNames;
+			std::string name;
+		};
+
+		/*!
+		 * \brief	Member of a structure, see TypeStructField
+		 */
+		struct Field
+		{
+			uint64_t offset;
+			std::string name;
+			TypeIndex type;
+		};
+
+		/*!
+		 * \brief	Array part of a type, see ArrayInfo
+		 */
+		struct Array
+		{
+			TypeIndex element;
+			uint64_t count;
+		};
+
+		/*!
+		 * \brief	A flattened type
+		 *			At most one of the optional parts is set
+		 */
+		struct Type
+		{
+			std::string name;
+			uint64_t size = 0;
+			uint32_t flags = 0;		// see exportformat::TypeFlags
+			std::optional<Func> func;
+			std::optional<std::vector<Field>> fields;
+			std::optional<TypeIndex> pointed;
+			std::optional<Array> array;
+		};
+
+		/*!
+		 * \brief	A named address
+		 */
+		struct Symbol
+		{
+			/*!
+			 * \brief	final name, as returned by SymbolInfo::getName
+			 */
+			std::string name;
+			uint32_t flags = 0;		// see exportformat::SymbolFlags
+		};
+
+		/*!
+		 * \brief	User defined type of a local variable
+		 */
+		struct LocalType
+		{
+			uint64_t pc;
+			std::string space;
+			uint64_t offset;
+			TypeIndex type;
+		};
+
+		/*!
+		 * \brief	A function and its stored names and types
+		 */
+		struct Function
+		{
+			uint64_t ea = 0;
+			uint64_t size = 0;
+			std::string name;
+			uint64_t contentHash = 0;
+			uint64_t cloneHash = 0;
+			bool library = false;
+
+			/*!
+			 * \brief	frame member names by stack offset
+			 */
+			std::map<uint64_t, std::string> stackVars;
+
+			/*!
+			 * \brief	user defined names by use address
+			 */
+			std::vector<std::pair<uint64_t, NameOverride>> names;
+
+			/*!
+			 * \brief	user defined types by use address
+			 */
+			std::vector<LocalType> types;
+		};
+
+	protected:
+		/*!
+		 * \brief	compiler of the database
+		 */
+		Compiler m_compiler;
+
+		/*!
+		 * \brief	content of loaded segments
+		 */
+		MemoryImage m_image;
+
+		/*!
+		 * \brief	segments by start address
+		 */
+		std::map<uint64_t, Segment> m_segments;
+
+		/*!
+		 * \brief	imports by address
+		 */
+		std::map<uint64_t, Import> m_imports;
+
+		/*!
+		 * \brief	flattened types
+		 */
+		std::vector<Type> m_types;
+
+		/*!
+		 * \brief	named types by name
+		 */
+		std::unordered_map<std::string, TypeIndex> m_namedTypes;
+
+		/*!
+		 * \brief	type of a function or a global by address
+		 */
+		std::map<uint64_t, TypeIndex> m_typesByAddress;
+
+		/*!
+		 * \brief	named addresses
+		 */
+		std::map<uint64_t, Symbol> m_symbols;
+
+		/*!
+		 * \brief	functions by start address
+		 */
+		std::map<uint64_t, Function> m_functions;
+
+	public:
+		/*!
+		 * \brief	ctor of an empty export
+		 * \param	compiler	compiler of the database
+		 */
+		explicit ExportDatabase(const Compiler& compiler);
+
+		const Compiler& getCompiler() const noexcept;
+
+		/*!
+		 * \brief	Content of loaded segments
+		 *			Bytes outside of segments are not written
+		 */
+		MemoryImage& getImage() noexcept;
+		const MemoryImage& getImage() const noexcept;
+
+		/*!
+		 * \brief	Add a memory segment
+		 * \param	segment	segment, loaded ones take their bytes from the image
+		 */
+		void addSegment(Segment segment);
+
+		/*!
+		 * \brief	Add an imported function
+		 */
+		void addImport(uint64_t ea, Import import);
+
+		/*!
+		 * \brief	Flatten a type and all its nested types
+		 *			Named types are only added once
+		 * \param	type	type to add
+		 * \return	index of the type
+		 */
+		TypeIndex addType(const TypeInfo& type);
+
+		/*!
+		 * \brief	Add the type of a function or a global
+		 * \param	ea		address of the function or the global
+		 * \param	type	its type
+		 */
+		void addTypeAt(uint64_t ea, const TypeInfo& type);
+
+		/*!
+		 * \brief	Add a named address
+		 *			Read only state is not stored, it comes from segments
+		 */
+		void addSymbol(const SymbolInfo& symbol);
+
+		/*!
+		 * \brief	Add a function with its stored names and types
+		 * \param	function	function to add
+		 * \param	stackVars	frame member names by stack offset
+		 */
+		void addFunction(FunctionSymbolInfo& function, const std::map<uint64_t, std::string>& stackVars);
+
+		const std::map<uint64_t, Function>& getFunctions() const noexcept;
+
+		/*!
+		 * \brief	Write the export, see exportformat.hh
+		 */
+		void write(std::ostream& stream) const;
+	};
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef __YAGI_EXPORTFORMAT__
+#define __YAGI_EXPORTFORMAT__
+
+#include <cstdint>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Layout of an export file
+	 *			The file is a header followed by sections of fixed size records,
+	 *			every record is 8 bytes aligned and little endian
+	 *			so the file can be used in place once mapped into memory
+	 *			Strings are slices of a shared pool, not null terminated
+	 */
+	namespace exportformat
+	{
+		/*!
+		 * \brief	First bytes of an export file, "YAGX"
+		 */
+		static const uint32_t MAGIC = 0x58474159;
+
+		/*!
+		 * \brief	Current version of the file format
+		 *			1 was a stream of variable size entries
+		 */
+		static const uint32_t VERSION = 4;
+
+		/*!
+		 * \brief	Missing type reference
+		 */
+		static const uint32_t NO_TYPE = 0xffffffff;
+
+		/*!
+		 * \brief	Segment without bytes (BSS)
+		 */
+		static const uint64_t NO_DATA = 0xffffffffffffffff;
+
+		/*!
+		 * \brief	Sections of the file, in file order
+		 */
+		enum SectionId : uint32_t
+		{
+			SECTION_STRINGS = 0,		// string pool, count is in bytes
+			SECTION_BYTES,				// content of segments, count is in bytes
+			SECTION_SEGMENTS,			// Segment sorted by start
+			SECTION_SYMBOLS,			// Symbol sorted by address
+			SECTION_IMPORTS,			// Import sorted by address
+			SECTION_FUNCTIONS,			// Function sorted by address
+			SECTION_STACK_VARS,			// StackVar grouped by function, sorted by offset
+			SECTION_NAMES,				// Name grouped by function
+			SECTION_LOCAL_TYPES,		// LocalType grouped by function
+			SECTION_TYPES,				// Type referenced by index
+			SECTION_FUNCS,				// Func referenced by Type::first
+			SECTION_FIELDS,				// Field grouped by struct
+			SECTION_TYPE_REFS,			// uint32_t, prototype of Func
+			SECTION_PARAM_NAMES,		// StringRef, parameter names of Func
+			SECTION_NAMED_TYPES,		// NamedType sorted by name
+			SECTION_TYPED_ADDRESSES,	// TypedAddress sorted by address
+			SECTION_COUNT
+		};
+
+		/*!
+		 * \brief	A string of the pool
+		 */
+		struct StringRef
+		{
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		/*!
+		 * \brief	Location of a section
+		 */
+		struct Section
+		{
+			uint64_t offset;	// from the start of the file
+			uint64_t count;		// number of records
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t language;
+			uint32_t endianess;
+			uint32_t mode;
+			uint32_t isa;
+			Section sections[SECTION_COUNT];
+		};
+
+		/*!
+		 * \brief	Segment permissions
+		 */
+		enum SegmentPerm : uint32_t
+		{
+			PERM_EXEC = 1,
+			PERM_WRITE = 2,
+			PERM_READ = 4
+		};
+
+		struct Segment
+		{
+			uint64_t start;
+			uint64_t end;
+			uint64_t data;		// offset into SECTION_BYTES or NO_DATA
+			StringRef name;
+			uint32_t perm;		// see SegmentPerm
+			uint32_t reserved;
+		};
+
+		/*!
+		 * \brief	Properties of a symbol, see SymbolInfo
+		 *			read only is computed from segments
+		 */
+		enum SymbolFlags : uint32_t
+		{
+			SYMBOL_FUNCTION = 1 << 0,
+			SYMBOL_LABEL = 1 << 1,
+			SYMBOL_IMPORT = 1 << 2
+		};
+
+		struct Symbol
+		{
+			uint64_t ea;
+			StringRef name;		// final name, as returned by SymbolInfo::getName
+			uint32_t flags;		// see SymbolFlags
+			uint32_t reserved;
+		};
+
+		struct Import
+		{
+			uint64_t ea;
+			StringRef module;
+			StringRef name;
+		};
+
+		/*!
+		 * \brief	Properties of a function, see FunctionSymbolInfo
+		 */
+		enum FunctionFlags : uint32_t
+		{
+			FUNCTION_LIBRARY = 1 << 0
+		};
+
+		struct Function
+		{
+			uint64_t ea;
+			uint64_t size;
+			uint64_t contentHash;
+			uint64_t cloneHash;
+			StringRef name;
+			uint32_t firstStackVar;
+			uint32_t stackVarCount;
+			uint32_t firstName;
+			uint32_t nameCount;
+			uint32_t firstLocalType;
+			uint32_t localTypeCount;
+			uint32_t flags;		// see FunctionFlags
+			uint32_t reserved;
+		};
+
+		struct StackVar
+		{
+			uint64_t offset;
+			StringRef name;
+		};
+
+		/*!
+		 * \brief	User defined name of a local variable, see NameOverride
+		 */
+		struct Name
+		{
+			uint64_t pc;
+			uint64_t offset;
+			StringRef space;
+			StringRef name;
+		};
+
+		/*!
+		 * \brief	User defined type of a local variable, see TypeOverride
+		 */
+		struct LocalType
+		{
+			uint64_t pc;
+			uint64_t offset;
+			StringRef space;
+			uint32_t type;
+			uint32_t reserved;
+		};
+
+		/*!
+		 * \brief	Properties of a type, see TypeInfo
+		 */
+		enum TypeFlags : uint32_t
+		{
+			TYPE_INT = 1 << 0,
+			TYPE_BOOL = 1 << 1,
+			TYPE_FLOAT = 1 << 2,
+			TYPE_VOID = 1 << 3,
+			TYPE_CONST = 1 << 4,
+			TYPE_CHAR = 1 << 5,
+			TYPE_UNICODE = 1 << 6
+		};
+
+		/*!
+		 * \brief	Optional part of a type
+		 */
+		enum TypeKind : uint32_t
+		{
+			KIND_NONE = 0,
+			KIND_FUNC,		// first is an index into SECTION_FUNCS
+			KIND_STRUCT,	// first and count are a range of SECTION_FIELDS
+			KIND_PTR,		// first is the pointed type
+			KIND_ARRAY		// first is the element type, count the number of elements
+		};
+
+		struct Type
+		{
+			uint64_t size;
+			uint64_t count;
+			StringRef name;
+			uint32_t flags;		// see TypeFlags
+			uint32_t kind;		// see TypeKind
+			uint32_t first;
+			uint32_t reserved;
+		};
+
+		struct Func
+		{
+			StringRef name;
+			StringRef callingConv;
+			uint32_t firstParam;		// into SECTION_TYPE_REFS, return type first
+			uint32_t paramCount;
+			uint32_t firstParamName;	// into SECTION_PARAM_NAMES, return name first
+			uint32_t paramNameCount;
+			uint32_t dotDotDot;
+			uint32_t hasCallingConv;
+		};
+
+		struct Field
+		{
+			uint64_t offset;
+			StringRef name;
+			uint32_t type;
+			uint32_t reserved;
+		};
+
+		struct NamedType
+		{
+			StringRef name;
+			uint32_t type;
+			uint32_t reserved;
+		};
+
+		struct TypedAddress
+		{
+			uint64_t ea;
+			uint32_t type;
+			uint32_t reserved;
+		};
+
+		/*!
+		 * \brief	Records are used in place, only on little endian hosts
+		 */
+		inline bool isHostSupported() noexcept
+		{
+			const uint16_t probe = 1;
+			return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+		}
+
+		/*!
+		 * \brief	Size of a section padded to the record alignment
+		 */
+		inline uint64_t align(uint64_t size) noexcept
+		{
+			return (size + 7) & ~static_cast<uint64_t>(7);
+		}
+
+		static_assert(sizeof(Header) % 8 == 0, "export records must be 8 bytes aligned");
+		static_assert(sizeof(Segment) == 40, "unexpected padding");
+		static_assert(sizeof(Symbol) == 24, "unexpected padding");
+		static_assert(sizeof(Import) == 24, "unexpected padding");
+		static_assert(sizeof(Function) == 72, "unexpected padding");
+		static_assert(sizeof(StackVar) == 16, "unexpected padding");
+		static_assert(sizeof(Name) == 32, "unexpected padding");
+		static_assert(sizeof(LocalType) == 32, "unexpected padding");
+		static_assert(sizeof(Type) == 40, "unexpected padding");
+		static_assert(sizeof(Func) == 40, "unexpected padding");
+		static_assert(sizeof(Field) == 24, "unexpected padding");
+		static_assert(sizeof(NamedType) == 16, "unexpected padding");
+		static_assert(sizeof(TypedAddress) == 16, "unexpected padding");
+	}
+}
+
+#endif
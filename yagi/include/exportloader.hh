@@ -0,0 +1,75 @@
+#ifndef __YAGI_EXPORTLOADER__
+#define __YAGI_EXPORTLOADER__
+
+#include "loader.hh"
+#include "exportview.hh"
+#include <memory>
+#include <libdecomp.hh>
+
+namespace yagi 
+{
+	/*!
+	 * \brief	Implement the LoadImage interface of Ghidra
+	 *			over the segments of an export
+	 *			Bytes are copied from the mapped file
+	 */
+	class ExportLoader : public LoadImage
+	{
+	protected:
+		/*!
+		 * \brief	export shared by every loader of the same program
+		 */
+		std::shared_ptr<const ExportView> m_view;
+
+	public:
+		/*!
+		 * \brief	constructor
+		 * \param	view	export to read
+		 */
+		explicit ExportLoader(std::shared_ptr<const ExportView> view);
+
+		/*!
+		 * \brief	Return the name of the loader
+		 * \return	name of the current arch
+		 */
+		std::string getArchType(void) const override;
+
+		/*!
+		 * \brief	Copy data from the export
+		 *			bytes outside of loaded segments are zero
+		 * \param	ptr	buffer pointer
+		 * \param	size	size of expected data
+		 * \param	addr	address of the payload
+		 */
+		void loadFill(uint1* ptr, int4 size, const Address& addr) override;
+
+		/*!
+		 * \brief	Adjust VMA
+		 * \param	adjust
+		 */
+		void adjustVma(long adjust) override;
+	};
+
+	/*!
+	 * \brief	Build loaders sharing the same export
+	 */
+	class ExportLoaderFactory : public LoaderFactory
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	view	export to read
+		 */
+		explicit ExportLoaderFactory(std::shared_ptr<const ExportView> view);
+
+		/*!
+		 * \brief	build a loader over the export
+		 */
+		LoadImage* build() override;
+	};
+}
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef __YAGI_EXPORTSYMBOL__
+#define __YAGI_EXPORTSYMBOL__
+
+#include "symbolinfo.hh"
+#include "exportview.hh"
+#include "segmentindex.hh"
+
+#include <memory>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Symbol read from an exported database
+	 */
+	class ExportSymbolInfo : public SymbolInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+		/*!
+		 * \brief	segments of the export with the read only policy
+		 */
+		std::shared_ptr<const SegmentIndex> m_segments;
+
+		/*!
+		 * \brief	flags of the symbol, see exportformat::SymbolFlags
+		 */
+		uint32_t m_flags;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	view		export shared by all symbols
+		 * \param	segments	segments of the export
+		 * \param	ea			address of the symbol
+		 * \param	name		final name of the symbol
+		 * \param	flags		see exportformat::SymbolFlags
+		 */
+		explicit ExportSymbolInfo(std::shared_ptr<const ExportView> view, std::shared_ptr<const SegmentIndex> segments, uint64_t ea, std::string name, uint32_t flags);
+
+		/*!
+		 *	\brief	if symbol refer to a function compute the size of the symbol
+		 *	\return	the size of the symbol
+		 *	\raise	SymbolIsNotAFunction
+		 */
+		uint64_t getFunctionSize() const override;
+
+		bool isFunction() const noexcept override;
+		bool isLabel() const noexcept override;
+		/*!
+		 * \brief	Flagged as import or referenced by the import table
+		 */
+		bool isImport() const noexcept override;
+
+		/*!
+		 * \brief	Computed from the segments, as IdaSymbolInfo
+		 */
+		bool isReadOnly() const noexcept override;
+	};
+
+	/*!
+	 * \brief	Function read from an exported database
+	 *			The export is read only, saved names and types are dropped
+	 */
+	class ExportFunctionSymbolInfo : public FunctionSymbolInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+		/*!
+		 * \brief	record of m_view
+		 */
+		const exportformat::Function* m_function;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	view		export shared by all symbols
+		 * \param	segments	segments of the export
+		 * \param	function	record of the export
+		 */
+		explicit ExportFunctionSymbolInfo(std::shared_ptr<const ExportView> view, std::shared_ptr<const SegmentIndex> segments, const exportformat::Function& function);
+
+		/*!
+		 * \brief	Frame member at a stack offset
+		 *			32 bits offsets are also matched truncated, as in IDA
+		 */
+		std::optional<std::string> findStackVar(uint64_t offset, uint32_t addrSize) override;
+		std::optional<std::string> findName(uint64_t pc, const std::string& space, uint64_t& offset) override;
+		void saveName(const MemoryLocation& loc, const std::string& space) override;
+		void saveType(const MemoryLocation& loc, const TypeInfo& newType) override;
+		bool clearType(const MemoryLocation& loc) override;
+		std::optional<std::unique_ptr<TypeInfo>> findType(uint64_t pc, const std::string& from, uint64_t& offset) override;
+		LocalOverrides findLocalOverrides() override;
+
+		/*!
+		 * \brief	The export file has no chunk nor jump table
+		 *			the function is seen as a single range
+		 */
+		FlowHints findFlowHints() override;
+
+		/*!
+		 * \brief	Hash computed by the exporting backend
+		 */
+		uint64_t getContentHash() override;
+
+		/*!
+		 * \brief	Hash computed by the exporting backend
+		 */
+		uint64_t getCloneHash() override;
+
+		/*!
+		 * \brief	Flag written by the exporting backend
+		 */
+		bool isLibrary() override;
+	};
+
+	/*!
+	 * \brief	Symbol factory over an export
+	 *			Safe to use from several threads
+	 */
+	class ExportSymbolInfoFactory : public SymbolInfoFactory
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+		/*!
+		 * \brief	built once from the segments of the export
+		 */
+		std::shared_ptr<const SegmentIndex> m_segments;
+
+		/*!
+		 * \brief	Symbol at an address, shared by find and find_record
+		 */
+		std::optional<ExportSymbolInfo> findSymbol(uint64_t ea) const;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	view			export to read
+		 * \param	readOnlyNames	segments considered read only for the analysis
+		 */
+		explicit ExportSymbolInfoFactory(std::shared_ptr<const ExportView> view, std::unordered_set<std::string> readOnlyNames = SegmentIndex::DEFAULT_READ_ONLY);
+
+		/*!
+		 * \brief	Find any symbol at a particular address
+		 *			Unnamed function starts are found under the function name
+		 */
+		std::optional<std::unique_ptr<SymbolInfo>> find(uint64_t ea) override;
+		std::optional<std::unique_ptr<FunctionSymbolInfo>> find_function(uint64_t ea) override;
+
+		/*!
+		 * \brief	The symbol is built on the stack, not allocated
+		 */
+		std::optional<SymbolRecord> find_record(uint64_t ea) override;
+
+		/*!
+		 * \brief	Scan all symbols and named functions of the export
+		 */
+		std::unordered_map<std::string, uint64_t> find_addresses(const std::vector<std::string>& names) override;
+	};
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef __YAGI_EXPORTTYPE__
+#define __YAGI_EXPORTTYPE__
+
+#include "typeinfo.hh"
+#include "exportview.hh"
+
+#include <memory>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Type read from an exported database
+	 *			Only an index into the type table of the export
+	 */
+	class ExportTypeInfo : public TypeInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+		uint32_t m_index;
+
+		/*!
+		 * \brief	the flattened type
+		 * \raise	UnableToFindType
+		 */
+		const exportformat::Type& get() const;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	view	export shared by all types
+		 * \param	index	index of the type into the export
+		 */
+		explicit ExportTypeInfo(std::shared_ptr<const ExportView> view, uint32_t index);
+
+		size_t getSize() const override;
+		std::string getName() const override;
+		bool isInt() const override;
+		bool isBool() const override;
+		bool isFloat() const override;
+		bool isVoid() const override;
+		bool isConst() const override;
+		bool isChar() const override;
+		bool isUnicode() const override;
+
+		std::optional<std::unique_ptr<FuncInfo>> toFunc() const override;
+		std::optional<std::unique_ptr<StructInfo>> toStruct() const override;
+		std::optional<std::unique_ptr<PtrInfo>> toPtr() const override;
+		std::optional<std::unique_ptr<ArrayInfo>> toArray() const override;
+	};
+
+	/*!
+	 * \brief	Function part of an exported type
+	 */
+	class ExportFuncInfo : public FuncInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+		/*!
+		 * \brief	record of m_view
+		 */
+		const exportformat::Func* m_func;
+
+	public:
+		explicit ExportFuncInfo(std::shared_ptr<const ExportView> view, const exportformat::Func& func);
+
+		bool isDotDotDot() const override;
+		std::vector<std::unique_ptr<TypeInfo>> getFuncPrototype() const override;
+		std::vector<std::string> getFuncParamName() const override;
+
+		/*!
+		 * \raise	UnknownCallingConvention
+		 */
+		std::string getCallingConv() const override;
+		std::string getName() const override;
+	};
+
+	/*!
+	 * \brief	Structure part of an exported type
+	 */
+	class ExportStructInfo : public StructInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+		/*!
+		 * \brief	records of m_view
+		 */
+		ExportView::Table<exportformat::Field> m_fields;
+
+	public:
+		explicit ExportStructInfo(std::shared_ptr<const ExportView> view, ExportView::Table<exportformat::Field> fields);
+
+		std::vector<TypeStructField> getFields() const override;
+	};
+
+	/*!
+	 * \brief	Pointer part of an exported type
+	 */
+	class ExportPtrInfo : public PtrInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+		uint32_t m_pointed;
+
+	public:
+		explicit ExportPtrInfo(std::shared_ptr<const ExportView> view, uint32_t pointed);
+
+		std::unique_ptr<TypeInfo> getPointedObject() const override;
+	};
+
+	/*!
+	 * \brief	Array part of an exported type
+	 */
+	class ExportArrayInfo : public ArrayInfo
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+		uint32_t m_element;
+		uint64_t m_count;
+
+	public:
+		explicit ExportArrayInfo(std::shared_ptr<const ExportView> view, uint32_t element, uint64_t count);
+
+		std::unique_ptr<TypeInfo> getPointedObject() const override;
+		uint64_t getSize() const override;
+	};
+
+	/*!
+	 * \brief	Type factory over an export
+	 *			Safe to use from several threads
+	 */
+	class ExportTypeInfoFactory : public TypeInfoFactory
+	{
+	protected:
+		std::shared_ptr<const ExportView> m_view;
+
+	public:
+		explicit ExportTypeInfoFactory(std::shared_ptr<const ExportView> view);
+
+		std::optional<std::unique_ptr<TypeInfo>> build(const std::string& name) override;
+		std::optional<std::unique_ptr<TypeInfo>> build(uint64_t ea) override;
+
+		/*!
+		 * \brief	Nothing to forget, the export never change
+		 */
+		void invalidate(const std::string& name) override;
+		void invalidateAll() override;
+	};
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef __YAGI_EXPORTVIEW__
+#define __YAGI_EXPORTVIEW__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "decompiler.hh"
+#include "exportformat.hh"
+#include "exception.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Read only access to an export file, see exportformat.hh
+	 *			Records are used in place, nothing is parsed at load time,
+	 *			only the section table is checked
+	 *			References between records are checked on access
+	 *			Safe to use from several threads
+	 */
+	class ExportView
+	{
+	public:
+		/*!
+		 * \brief	A range of records
+		 */
+		template<typename T>
+		class Table
+		{
+		protected:
+			const T* m_data;
+			size_t m_size;
+
+		public:
+			Table(const T* data, size_t size) noexcept
+				: m_data{ data }, m_size{ size }
+			{}
+
+			size_t size() const noexcept { return m_size; }
+			bool empty() const noexcept { return m_size == 0; }
+			const T* begin() const noexcept { return m_data; }
+			const T* end() const noexcept { return m_data + m_size; }
+			const T& operator[](size_t index) const noexcept { return m_data[index]; }
+
+			/*!
+			 * \brief	A sub range, checked against this one
+			 * \raise	InvalidExport
+			 */
+			Table<T> slice(uint64_t first, uint64_t count) const
+			{
+				if (first > m_size || count > m_size - first)
+				{
+					throw InvalidExport("record range out of bounds");
+				}
+				return Table<T>(m_data + first, static_cast<size_t>(count));
+			}
+		};
+
+	protected:
+		/*!
+		 * \brief	keep the mapping or the buffer alive
+		 */
+		std::shared_ptr<const void> m_storage;
+
+		const uint8_t* m_data;
+		size_t m_size;
+
+		/*!
+		 * \brief	start and number of records of each section
+		 */
+		std::pair<const uint8_t*, size_t> m_sections[exportformat::SECTION_COUNT];
+
+		/*!
+		 * \brief	Check the header and the section table
+		 * \raise	InvalidExport
+		 */
+		ExportView(std::shared_ptr<const void> storage, const uint8_t* data, size_t size);
+
+		template<typename T>
+		Table<T> table(exportformat::SectionId id) const noexcept
+		{
+			return Table<T>(reinterpret_cast<const T*>(m_sections[id].first), m_sections[id].second);
+		}
+
+	public:
+		/*!
+		 * \brief	Map an export file into memory
+		 * \raise	InvalidExport
+		 */
+		static std::shared_ptr<const ExportView> open(const std::filesystem::path& path);
+
+		/*!
+		 * \brief	Use an export already in memory
+		 * \raise	InvalidExport
+		 */
+		static std::shared_ptr<const ExportView> fromBuffer(std::vector<uint8_t> buffer);
+
+		Compiler getCompiler() const noexcept;
+
+		/*!
+		 * \brief	A string of the pool, not null terminated
+		 * \raise	InvalidExport
+		 */
+		std::string_view getString(const exportformat::StringRef& ref) const;
+
+		Table<exportformat::Segment> getSegments() const noexcept;
+
+		/*!
+		 * \brief	Segment containing an address
+		 */
+		const exportformat::Segment* findSegment(uint64_t ea) const;
+
+		/*!
+		 * \brief	Read bytes of loaded segments
+		 *			Bytes outside of them are set to zero
+		 * \return	number of bytes read from segments
+		 */
+		size_t read(uint64_t ea, uint8_t* buffer, size_t size) const;
+
+		Table<exportformat::Symbol> getSymbols() const noexcept;
+		const exportformat::Symbol* findSymbol(uint64_t ea) const;
+		const exportformat::Import* findImport(uint64_t ea) const;
+
+		Table<exportformat::Function> getFunctions() const noexcept;
+
+		/*!
+		 * \brief	Function handling an address
+		 *			only the range [ea, ea + size) of each function is handled
+		 */
+		const exportformat::Function* findFunction(uint64_t ea) const;
+
+		/*!
+		 * \brief	Stored data of a function
+		 * \raise	InvalidExport
+		 */
+		Table<exportformat::StackVar> getStackVars(const exportformat::Function& function) const;
+		Table<exportformat::Name> getNames(const exportformat::Function& function) const;
+		Table<exportformat::LocalType> getLocalTypes(const exportformat::Function& function) const;
+
+		/*!
+		 * \brief	A type of the table
+		 * \raise	UnableToFindType
+		 */
+		const exportformat::Type& getType(uint32_t index) const;
+
+		/*!
+		 * \brief	Parts of a type, the kind must match
+		 * \raise	InvalidExport
+		 */
+		const exportformat::Func& getFunc(const exportformat::Type& type) const;
+		Table<uint32_t> getParams(const exportformat::Func& func) const;
+		Table<exportformat::StringRef> getParamNames(const exportformat::Func& func) const;
+		Table<exportformat::Field> getFields(const exportformat::Type& type) const;
+
+		/*!
+		 * \brief	All named types, sorted by name
+		 */
+		Table<exportformat::NamedType> getNamedTypes() const noexcept;
+
+		/*!
+		 * \brief	Named type, by a binary search on names
+		 */
+		std::optional<uint32_t> findType(std::string_view name) const;
+
+		/*!
+		 * \brief	Type of a function or a global
+		 */
+		std::optional<uint32_t> findType(uint64_t ea) const;
+	};
+}
+
+#endif
@@ -9,6 +9,8 @@ namespace yagi
 	{
 		/*!
 		 * \brief	Init the ghidra library with file backends
+		 *			Only the first call for a path is effective
+		 *			Safe to call from any thread
 		 * \param	ghidraPath	Path to the root folder that Start with Ghidra/Processors
 		 */
 		void init(const std::string& ghidraPath);
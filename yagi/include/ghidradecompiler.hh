@@ -1,6 +1,9 @@
 #ifndef __YAGI_DECOMPILER__
 #define __YAGI_DECOMPILER__
 
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 
@@ -9,6 +12,8 @@
 #include "symbolinfo.hh"
 #include "logger.hh"
 #include "loader.hh"
+#include "options.hh"
+#include "resultcache.hh"
 
 class Funcdata;
 
@@ -16,6 +21,7 @@ namespace yagi
 {
 
 	class YagiArchitecture;
+	class SymbolIndex;
 
 	/*!
 	 *	\brief	Implement the IDecompile interface for Ghidra
@@ -28,34 +34,181 @@ namespace yagi
 		 */
 		std::unique_ptr<YagiArchitecture> m_architecture;
 
+		/*!
+		 *	\brief	cache of previous decompilation results
+		 */
+		ResultCache m_cache;
+
+		/*!
+		 *	\brief	An analysis held by the global scope
+		 */
+		struct Analysis
+		{
+			/*!
+			 *	\brief	what the analysis read
+			 */
+			Decompiler::Dependencies dependencies;
+
+			/*!
+			 *	\brief	done in large function mode
+			 */
+			bool large;
+		};
+
+		/*!
+		 *	\brief	functions whose complete analysis is still held
+		 *			by the global scope
+		 */
+		std::map<uint64_t, Analysis> m_analyzed;
+
+		/*!
+		 *	\brief	number of viewers of each shown function, see retain
+		 */
+		std::map<uint64_t, size_t> m_retained;
+
+		/*!
+		 *	\brief	the database changed since symbols of the global scope were read
+		 */
+		bool m_stale;
+
+		/*!
+		 *	\brief	destination of profiles, null when not profiling
+		 */
+		std::shared_ptr<ProfileOutput> m_profile;
+
+		/*!
+		 *	\brief	resident memory in bytes above which caches are released
+		 *			0 means unlimited
+		 */
+		size_t m_memoryLimit;
+
+		/*!
+		 *	\brief	resident memory when caches were last released, 0 if never
+		 *			the allocator may keep freed pages, caches are released again
+		 *			once the usage went under the low watermark or grew further
+		 */
+		size_t m_memoryReleased = 0;
+
+		/*!
+		 *	\brief	last report of a release and releases since not reported
+		 */
+		std::chrono::steady_clock::time_point m_memoryLogged;
+		size_t m_memoryUnlogged = 0;
+
+		/*!
+		 *	\brief	keep every printed token into results, see setTokenStream
+		 */
+		bool m_tokenStream = false;
+
 	protected:
+		/*!
+		 * \brief	Run a decompilation into a new profile if profiling is enabled
+		 *			The report is written once the decompilation is done
+		 * \param	funcAddress	address of the profiled function
+		 * \param	run	the decompilation
+		 */
+		std::optional<Decompiler::Result> profiled(uint64_t funcAddress, const std::function<std::optional<Result>()>& run);
+
+		/*!
+		 * \brief	Full analysis of a function, see decompile
+		 */
+		std::optional<Decompiler::Result> analyze(uint64_t funcAddress);
+
+		/*!
+		 * \brief	Rename pass on the retained analysis, see refreshNames
+		 */
+		std::optional<Decompiler::Result> refresh(uint64_t funcAddress);
+
+		/*!
+		 * \brief	Release the retained analysis, cached symbols and types
+		 *			if the process is above the memory limit
+		 *			and did not stay above it since the last release
+		 *			They are built again on demand by next decompilations
+		 */
+		void checkMemory();
+
+		/*!
+		 * \brief	Make room for the analysis of a function
+		 *			The global scope is cleared if the database changed
+		 *			or if no shown function is held,
+		 *			otherwise analyses of hidden functions are released
+		 *			and the ones of shown functions are kept
+		 * \param	funcAddress	address of the next analyzed function
+		 */
+		void prepareScope(uint64_t funcAddress);
+
+		/*!
+		 * \brief	Release the dataflow of a function held by the global scope
+		 *			Its symbol is kept, other analyses may point to it
+		 */
+		void releaseAnalysis(uint64_t funcAddress);
+
+		/*!
+		 * \brief	Everything collected by the single walk over ops
+		 *			Defined with Ghidra types into the implementation
+		 */
+		struct OpIndex;
+
+		/*!
+		 * \brief	Walk every op of the function once
+		 *			Index use addresses of each storage location
+		 *			and collect constants pointing to a known RAM symbol
+		 * \param	data	the source function
+		 * \param	index	the output index
+		 * \param	uses	also index use addresses, skipped for large functions
+		 */
+		void indexOps(const Funcdata& data, OpIndex& index, bool uses) const;
+
 		/*!
 		 * \brief	Find high level variable and defined address
 		 * \param	data	the source function
+		 * \param	index	ops index of the function
 		 * \param	symbols	the output list of symbols
 		 */
-		void findVarSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const;
+		void findVarSymbols(const Funcdata& data, const OpIndex& index, SymbolIndex& symbols) const;
 
 		/*!
 		 * \brief	Find calling function and populate the sylbol map
 		 * \param	data	the source function
-		 * \param	symbols	the output map populate by algo
+		 * \param	symbols	the output index populate by algo
 		 */
-		void findFunctionSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const;
+		void findFunctionSymbols(const Funcdata& data, SymbolIndex& symbols) const;
 
 		/*!
-		 * \param	Trying to find Constant symbols
+		 * \brief	Add constants that are RAM addresses
+		 *			so they can be followed from the view
+		 * \param	index	ops index of the function
+		 * \param	symbols	the output symbol index
+		 */
+		void findConstantSymbols(const OpIndex& index, SymbolIndex& symbols) const;
+
+		/*!
+		 * \brief	Compute every symbol of the output
+		 *			Variables first, then functions and constants
 		 * \param	data	the source function
-		 * \param	symbols	the output symbol maps
+		 * \param	symbols	the output symbol index
+		 * \param	uses	collect use addresses of variables
+		 */
+		void findSymbols(const Funcdata& data, SymbolIndex& symbols, bool uses = true) const;
+
+		/*!
+		 * \brief	Compute symbols and print an analyzed function
+		 * \param	funcSym	symbol of the function
+		 * \param	func	analyzed function
+		 * \param	hash	content hash use to cache the result, if any
+		 * \param	large	analyzed in large function mode, the output is marked
+		 * \return	decompilation result
 		 */
-		void findConstantSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const;
+		Decompiler::Result print(FunctionSymbolInfo& funcSym, Funcdata& func, const std::optional<uint64_t>& hash, bool large = false);
 
 	public:
 		/*!
 		 *	\brief	ctor
 		 *	\param	architecture	Ghidra architecture
+		 *	\param	cache	cache of decompilation results
+		 *	\param	memoryLimit	resident memory in bytes above which caches are released, 0 means unlimited
 		 */
-		explicit GhidraDecompiler(std::unique_ptr<YagiArchitecture> architecture);
+		explicit GhidraDecompiler(std::unique_ptr<YagiArchitecture> architecture, ResultCache cache, size_t memoryLimit = 0);
 
 		/*!
 		 *	\brief	default deletor 
@@ -79,32 +232,100 @@ namespace yagi
 		 */
 		static std::string compute_sleigh_id(const Compiler& compilerType) noexcept;
 
+		/*!
+		 * \brief	compute the key of an architecture
+		 *			the sleigh id followed by the instruction set if not the default one
+		 */
+		static std::string compute_architecture_key(const Compiler& compilerType) noexcept;
+
 		/*!
 		 * \brief	compute default calling convention
 		 * \param	compilerType	type of arch
 		 */
 		static std::string compute_default_cc(const Compiler& compilerType);
 
+		/*!
+		 *	\brief	Keep every printed token into results
+		 *			with its kind and highlight class, not only symbols
+		 */
+		void setTokenStream(bool enabled) noexcept;
+
 		/*!
 		 *	\brief	main function for decompiler
 		 *	\param	funcAddress	address of function to decompile
 		 */
 		std::optional<Decompiler::Result> decompile(uint64_t funcAddress) override;
 
+		/*!
+		 *	\brief	Run again only rename actions and the printer
+		 *			on the retained analysis of the function
+		 *	\param	funcAddress	address of function to refresh
+		 */
+		std::optional<Decompiler::Result> refreshNames(uint64_t funcAddress) override;
+
+		/*!
+		 *	\brief	Forget the cached result of a function
+		 *	\param	funcAddress	address of the function
+		 */
+		void invalidate(uint64_t funcAddress) override;
+		void invalidateDependents(uint64_t ea) override;
+		void invalidateCode(uint64_t ea) override;
+
+		/*!
+		 *	\brief	Forget all cached results
+		 */
+		void clearCache() override;
+
+		/*!
+		 *	\brief	Translate again a type on the next decompilation
+		 *	\param	name	name of the changed type
+		 */
+		void invalidateType(const std::string& name) override;
+
+		/*!
+		 *	\brief	Translate again all types on the next decompilation
+		 */
+		void invalidateTypes() override;
+		void retain(uint64_t funcAddress) override;
+		void release(uint64_t funcAddress) override;
+
+		/*!
+		 *	\brief	Check this token during the next decompilations
+		 *	\param	token	null to never stop
+		 */
+		void setCancelToken(std::shared_ptr<const CancelToken> token) override;
+
+		/*!
+		 *	\brief	Write a profile of each next decompilation
+		 *	\param	output	null to stop profiling
+		 */
+		void setProfileOutput(std::shared_ptr<ProfileOutput> output) override;
+
+		/*!
+		 *	\brief	Translate types into the type manager while no function is analyzed
+		 *			Types are dropped on the next sync if one of them changed meanwhile
+		 */
+		size_t prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names) override;
+
 		/*!
 		 *	\brief	factory
 		 *			Use to build a ghidra decompiler interface
 		 *	\param	compilerType	decompiler id to load
+		 *	\param	options	user configuration
 		 *  \param	loaderFactory	Loader factory, use to interact with file or IDA
 		 *  \param	logger	logger use to inform state of the decompilation
 		 *	\param	symbolDatabase	symboles database use to increase the decompilation output
 		 *  \param	typeDatabase	type declared use to increase the decompilation output
+		 *	\param	resultStore	optional persistent store of decompilation results
 		 */
 		static std::optional<std::unique_ptr<Decompiler>> build(
 			const Compiler& compilerType,
+			const Options& options,
+			std::unique_ptr<LoaderFactory> loaderFactory,
 			std::unique_ptr<Logger> logger, 
 			std::unique_ptr<SymbolInfoFactory> symbolDatabase, 
-			std::unique_ptr<TypeInfoFactory> typeDatabase
+			std::unique_ptr<TypeInfoFactory> typeDatabase,
+			std::unique_ptr<ResultStore> resultStore
 		) noexcept;
 	};
 }
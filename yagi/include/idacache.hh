@@ -0,0 +1,42 @@
+#ifndef __YAGI_IDACACHE__
+#define __YAGI_IDACACHE__
+
+#include "resultstore.hh"
+
+namespace yagi 
+{
+	/*!
+	 * \brief	Store compressed decompilation results into the IDA database
+	 *			One blob per function, one supval of its content hash
+	 *			and one blob of its dependencies, indexed by the function address
+	 */
+	class IdaResultBlobs : public ResultBlobs
+	{
+	public:
+		/*!
+		 * \brief	ctor
+		 */
+		IdaResultBlobs() = default;
+
+		/*!
+		 * \brief	destructor
+		 */
+		~IdaResultBlobs() = default;
+
+		/*!
+		 * \brief	Walk the hash supvals, results of previous versions are removed
+		 *			as well as results saved without dependencies
+		 */
+		std::unordered_map<uint64_t, IndexEntry> readIndex() override;
+
+		std::optional<std::vector<uint8_t>> read(uint64_t ea) override;
+		void write(const std::vector<Entry>& entries) override;
+
+		/*!
+		 * \brief	Remove all results from the database
+		 */
+		void clear() override;
+	};
+}
+
+#endif
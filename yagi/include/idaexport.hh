@@ -0,0 +1,41 @@
+#ifndef __YAGI_IDAEXPORT__
+#define __YAGI_IDAEXPORT__
+
+#include <memory>
+
+#include "exportdatabase.hh"
+#include "exportview.hh"
+
+namespace yagi
+{
+	class IdaImportIndex;
+
+	/*!
+	 * \brief	Copy everything the decompiler reads from the database
+	 *			into an export for the headless decompiler
+	 *			Must be called from the IDA main thread
+	 * \param	imports		import index of the database
+	 * \param	database	destination export, built with the compiler of the database
+	 */
+	void exportIdaDatabase(std::shared_ptr<IdaImportIndex> imports, ExportDatabase& database);
+
+	/*!
+	 * \brief	Immutable snapshot of the database kept in memory
+	 *			Factories built over it can be used from any thread
+	 *			without going through the IDA main thread
+	 *			Must be called from the IDA main thread
+	 * \param	imports		import index of the database
+	 * \param	compiler	compiler of the database
+	 */
+	std::shared_ptr<const ExportView> snapshotIdaDatabase(std::shared_ptr<IdaImportIndex> imports, const Compiler& compiler);
+
+	/*!
+	 * \brief	Immutable snapshot of the local types and of the prototypes of imports
+	 *			with the types they use, see snapshotIdaDatabase
+	 *			Must be called from the IDA main thread
+	 * \param	compiler	compiler of the database
+	 */
+	std::shared_ptr<const ExportView> snapshotIdaTypes(const Compiler& compiler);
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __YAGI_IDAIMAGE__
+#define __YAGI_IDAIMAGE__
+
+#include "memoryimage.hh"
+
+namespace yagi 
+{
+	/*!
+	 * \brief	Copy every loaded segment of the database into an image
+	 *			Uninitialized segments (BSS) are left unmapped
+	 * \param	image	destination image, previous content is dropped
+	 */
+	void captureIdaImage(MemoryImage& image);
+
+	/*!
+	 * \brief	Copy again a range of bytes from the database
+	 *			Use when bytes are patched
+	 * \param	image	image to update
+	 * \param	ea		address of the first byte
+	 * \param	size	number of bytes
+	 */
+	void updateIdaImage(MemoryImage& image, uint64_t ea, size_t size);
+}
+
+#endif
@@ -11,6 +11,15 @@ namespace yagi
 	class IdaLogger : public Logger
 	{
 	public:
+		/*!
+		 * \brief	ctor
+		 * \param	level	minimum level of printed messages
+		 */
+		explicit IdaLogger(LogLevel level = LogLevel::Info)
+		{
+			m_level = level;
+		}
+
 		/*!
 		 * \brief	Core print for IDA
 		 * \param	message	message to print on console
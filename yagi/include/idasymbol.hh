@@ -2,19 +2,166 @@
 #define __YAGI_IDASYMBOLFACTORY__
 
 #include "symbolinfo.hh"
+#include "importindex.hh"
+#include "segmentindex.hh"
+
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 namespace yagi 
 {
+	/*!
+	 * \brief	Import index of the current database
+	 *			Built once from the import modules of IDA
+	 *			and rebuilt on next use after an invalidation
+	 */
+	class IdaImportIndex
+	{
+	protected:
+		/*!
+		 * \brief	all imports of the database
+		 */
+		ImportIndex m_index;
+
+		/*!
+		 * \brief	true when m_index reflect the database
+		 */
+		bool m_isBuilt = false;
+
+	public:
+		/*!
+		 * \brief	Index of imports, built if needed
+		 *			Must be called from the IDA main thread
+		 */
+		const ImportIndex& get();
+
+		/*!
+		 * \brief	Force a rebuild on next use
+		 *			Call it when imports or names change
+		 */
+		void invalidate() noexcept;
+	};
+
+	/*!
+	 * \brief	Segment index of the current database
+	 *			Built once from the segments of IDA
+	 *			and rebuilt on next use after an invalidation
+	 */
+	class IdaSegmentIndex
+	{
+	protected:
+		/*!
+		 * \brief	all segments of the database
+		 */
+		SegmentIndex m_index;
+
+		/*!
+		 * \brief	true when m_index reflect the database
+		 */
+		bool m_isBuilt = false;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	readOnlyNames	segments considered read only for the analysis
+		 */
+		explicit IdaSegmentIndex(std::unordered_set<std::string> readOnlyNames = SegmentIndex::DEFAULT_READ_ONLY);
+
+		/*!
+		 * \brief	Index of segments, built if needed
+		 *			Must be called from the IDA main thread
+		 */
+		const SegmentIndex& get();
+
+		/*!
+		 * \brief	Force a rebuild on next use
+		 *			Call it when segments change
+		 */
+		void invalidate() noexcept;
+	};
+
+	/*!
+	 * \brief	Names computed from IDA names, by address
+	 *			Cleanup and demangling are only done once per name
+	 *			Must be used from the IDA main thread
+	 */
+	class IdaNameCache
+	{
+	protected:
+		struct Entry
+		{
+			/*!
+			 * \brief	IDA name the display name was computed from
+			 */
+			std::string name;
+			std::optional<std::string> displayName;
+
+			/*!
+			 * \brief	short name of the function starting at this address
+			 */
+			std::optional<std::string> functionName;
+		};
+
+		std::unordered_map<uint64_t, Entry> m_entries;
+
+	public:
+		/*!
+		 * \brief	Cleaned and demangled name, as returned by SymbolInfo::getName
+		 * \param	ea			address of the symbol
+		 * \param	name		IDA name of the symbol
+		 * \param	isImport	imports are prefixed by SymbolInfo::IMPORT_PREFIX
+		 */
+		const std::string& getDisplayName(uint64_t ea, const std::string& name, bool isImport);
+
+		/*!
+		 * \brief	Name of a function without its parameters
+		 * \param	ea	start address of the function
+		 */
+		const std::string& getFunctionName(uint64_t ea);
+
+		/*!
+		 * \brief	Forget names of an address
+		 *			Call it when the address is renamed
+		 */
+		void invalidate(uint64_t ea) noexcept;
+
+		/*!
+		 * \brief	Forget all names
+		 *			Call it when imports change
+		 */
+		void invalidateAll() noexcept;
+	};
+
 	/*!
 	 * \brief	Symbol database interface from IDA to Yagi 
+	 *			Properties are read from IDA once, when the symbol is built
+	 *			so the ctor must be called from the IDA main thread
 	 */
 	class IdaSymbolInfo : public SymbolInfo 
 	{
+	protected:
+		/*!
+		 * \brief	cleaned and demangled name, as returned by getName
+		 */
+		std::string m_displayName;
+
+		bool m_isFunction;
+		bool m_isLabel;
+		bool m_isImport;
+		bool m_isReadOnly;
+
 	public:
 		/*!
 		 *	\brief	ctor
+		 *			Query IDA for every property of the symbol
+		 * \param	ea			address of the symbol
+		 * \param	name		IDA name of the symbol
+		 * \param	imports		imports of the database
+		 * \param	segments	segments of the database
+		 * \param	names		cache of display names
 		 */
-		explicit IdaSymbolInfo(uint64_t ea, std::string name);
+		explicit IdaSymbolInfo(uint64_t ea, std::string name, IdaImportIndex& imports, IdaSegmentIndex& segments, IdaNameCache& names);
 
 		/*!
 		 * \brief	default ctor 
@@ -73,6 +220,34 @@ namespace yagi
 
 	class IdaFunctionSymbolInfo : public FunctionSymbolInfo
 	{
+	protected:
+		/*!
+		 * \brief	Names of the frame members indexed by stack offset
+		 */
+		struct StackVarIndex
+		{
+			/*!
+			 * \brief	member name by offset from the stack pointer
+			 */
+			std::unordered_map<uint64_t, std::string> byOffset;
+
+			/*!
+			 * \brief	same offsets truncated to 32 bits
+			 *			Ghidra use 32 bits stack offset even for sign extended one
+			 */
+			std::unordered_map<uint32_t, uint64_t> byOffset32;
+		};
+
+		/*!
+		 * \brief	built on first lookup, the frame is read only once
+		 */
+		std::optional<StackVarIndex> m_stackVars;
+
+		/*!
+		 * \brief	Read the frame of the function into m_stackVars
+		 */
+		const StackVarIndex& getStackVars();
+
 	public:
 		explicit IdaFunctionSymbolInfo(std::unique_ptr<SymbolInfo> symbol)
 			: FunctionSymbolInfo{std::move(symbol)}
@@ -99,6 +274,13 @@ namespace yagi
 		 */
 		std::optional<std::string> findStackVar(uint64_t offset, uint32_t addrSize) override;
 
+		/*!
+		 * \brief	All frame members of the function
+		 *			Use to export the function
+		 * \return	member names by offset from the stack pointer
+		 */
+		std::map<uint64_t, std::string> getStackVarNames();
+
 		/*!
 		 *	\brief	Find a custom stored name use at a particular address for this space
 		 *			use to staore registry or stack var name
@@ -157,18 +339,169 @@ namespace yagi
 		 * \return	if found the offset into memory space and the linked type
 		 */
 		std::optional<std::unique_ptr<TypeInfo>> findType(uint64_t pc, const std::string& from, uint64_t& offset) override;
+
+		/*!
+		 * \brief	Load every stored name and type of the function
+		 *			from its dedicated netnode in a single walk
+		 * \return	overrides indexed by use address
+		 */
+		LocalOverrides findLocalOverrides() override;
+
+		/*!
+		 * \brief	Chunks of the function and the switches resolved by IDA
+		 *			Switches with an unknown target are not reported
+		 * \return	the flow hints of the function
+		 */
+		FlowHints findFlowHints() override;
+
+		/*!
+		 * \brief	Hash of the function chunks bytes, the prototype,
+		 *			the frame members and the revision of stored names and types
+		 * \return	the content hash of the function
+		 */
+		uint64_t getContentHash() override;
+
+		/*!
+		 * \brief	Hash of the instructions with the operands that reference
+		 *			another item masked and replaced by the name of the item,
+		 *			of the prototype and of the frame members
+		 *			References into the function are hashed relative to its start
+		 *			Functions with stored names or types are not deduplicated
+		 * \return	the clone hash of the function, 0 if it has stored names or types
+		 */
+		uint64_t getCloneHash() override;
+
+		/*!
+		 * \brief	Flagged as library function by IDA
+		 */
+		bool isLibrary() override;
 	};
 
+	/*!
+	 * \brief	Names and types of local variables of a function saved at once
+	 *			Edits are collected then written on commit, reading and writing
+	 *			each pc once and incrementing the revision once
+	 */
+	class IdaLocalTransaction
+	{
+	protected:
+		/*!
+		 * \brief	Change of the entry of a space at a pc
+		 */
+		struct Edit
+		{
+			/*!
+			 * \brief	supval tag of the entry, name or type
+			 */
+			uint8_t tag;
+
+			uint64_t pc;
+
+			/*!
+			 * \brief	name or type declaration, ignored by a removal
+			 */
+			NameOverride entry;
+
+			bool remove;
+		};
+
+		/*!
+		 * \brief	address of the function
+		 */
+		uint64_t m_ea;
+
+		/*!
+		 * \brief	edits applied in order on commit
+		 */
+		std::vector<Edit> m_edits;
+
+		bool m_hasTypes = false;
+
+		/*!
+		 * \brief	Add an edit for each pc of the location
+		 */
+		void add(uint8_t tag, const MemoryLocation& loc, const std::string& value, bool remove);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	ea	address of the function
+		 */
+		explicit IdaLocalTransaction(uint64_t ea);
+
+		/*!
+		 * \brief	Rename a local variable at all its pc
+		 */
+		void saveName(const MemoryLocation& loc, const std::string& name);
+
+		/*!
+		 * \brief	Retype a local variable at all its pc
+		 */
+		void saveType(const MemoryLocation& loc, const TypeInfo& newType);
+
+		/*!
+		 * \brief	Restore the type found by the decompiler
+		 */
+		void clearType(const MemoryLocation& loc);
+
+		bool empty() const noexcept;
+
+		/*!
+		 * \brief	Types are changed, names can't be refreshed
+		 *			without analyzing the function again
+		 */
+		bool hasTypes() const noexcept;
+
+		/*!
+		 * \brief	Write all edits into the netnode of the function
+		 *			The transaction is empty after
+		 * \return	number of pc whose entries changed
+		 */
+		size_t commit();
+	};
+
+	/*!
+	 * \brief	Move names and types stored by previous versions
+	 *			(one netnode per space and pc) into the per function netnode
+	 *			Run only once per database
+	 */
+	void migrateLegacyOverrides();
+
 	/*!
 	 * \brief	Factory for IDA symbol
 	 */
 	class IdaSymbolInfoFactory : public SymbolInfoFactory
 	{
+	protected:
+		/*!
+		 * \brief	imports shared by all created symbols
+		 */
+		std::shared_ptr<IdaImportIndex> m_imports;
+
+		/*!
+		 * \brief	segments shared by all created symbols
+		 */
+		std::shared_ptr<IdaSegmentIndex> m_segments;
+
+		/*!
+		 * \brief	names shared by all created symbols
+		 */
+		std::shared_ptr<IdaNameCache> m_names;
+
 	public:
 		/*!
-		 * \brief	ctor 
+		 * \brief	ctor with its own import, segment and name index
 		 */
-		IdaSymbolInfoFactory() = default;
+		IdaSymbolInfoFactory();
+
+		/*!
+		 * \brief	ctor
+		 * \param	imports		import index shared with the plugin
+		 * \param	segments	segment index shared with the plugin
+		 * \param	names		name cache shared with the plugin
+		 *			all are invalidated by the plugin on database events
+		 */
+		explicit IdaSymbolInfoFactory(std::shared_ptr<IdaImportIndex> imports, std::shared_ptr<IdaSegmentIndex> segments, std::shared_ptr<IdaNameCache> names);
 
 		/*!
 		 * \brief	destructor
@@ -189,6 +522,16 @@ namespace yagi
 		 * \param	ea	any address that is handle by a function
 		 */
 		std::optional<std::unique_ptr<FunctionSymbolInfo>> find_function(uint64_t ea) override;
+
+		/*!
+		 * \brief	The symbol is built on the stack, not allocated
+		 */
+		std::optional<SymbolRecord> find_record(uint64_t ea) override;
+
+		/*!
+		 * \brief	Names are looked up as is, then with one or two leading underscores
+		 */
+		std::unordered_map<std::string, uint64_t> find_addresses(const std::vector<std::string>& names) override;
 	};
 }
 
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <unordered_map>
 
 #include <typeinf.hpp>
 #include <idp.hpp>
@@ -16,6 +17,63 @@
 
 namespace yagi 
 {
+	/*!
+	 * \brief	Decomposed form of an IDA type
+	 *			Each part is computed on first use
+	 */
+	struct IdaTypeLayout
+	{
+		/*!
+		 * \brief	printed name of the type
+		 */
+		std::optional<std::string> name;
+
+		/*!
+		 * \brief	function details, valid if hasFunc is set
+		 */
+		bool funcLoaded = false;
+		bool hasFunc = false;
+		func_type_data_t func;
+
+		/*!
+		 * \brief	struct details, valid if hasUdt is set
+		 */
+		bool udtLoaded = false;
+		bool hasUdt = false;
+		udt_type_data_t udt;
+	};
+
+	/*!
+	 * \brief	Layouts of named types shared by all type informations
+	 *			Must be invalidated when a local type change
+	 */
+	class IdaTypeCache
+	{
+	protected:
+		/*!
+		 * \brief	type name to its layout
+		 */
+		std::unordered_map<std::string, std::shared_ptr<IdaTypeLayout>> m_layouts;
+
+	public:
+		/*!
+		 * \brief	Layout of a type
+		 *			Unnamed and qualified types get their own layout
+		 * \param	type	IDA type
+		 */
+		std::shared_ptr<IdaTypeLayout> find(const tinfo_t& type);
+
+		/*!
+		 * \brief	Forget the layout of a named type
+		 */
+		void invalidate(const std::string& name);
+
+		/*!
+		 * \brief	Forget all layouts
+		 */
+		void clear();
+	};
+
 	/*!
 	 * \brief	Implementation of the TypeInfo Interface for IDA
 	 */
@@ -32,12 +90,42 @@ namespace yagi
 		 */
 		tinfo_t m_type;
 
+		/*!
+		 * \brief	cache used for nested types, may be null
+		 */
+		std::shared_ptr<IdaTypeCache> m_cache;
+
+		/*!
+		 * \brief	memoized decomposition of the type
+		 */
+		std::shared_ptr<IdaTypeLayout> m_layout;
+
+		/*!
+		 * \brief	Build the type information of a nested type
+		 *			which shares the same cache
+		 */
+		std::unique_ptr<IdaTypeInfo> nested(const tinfo_t& type) const;
+
+		/*!
+		 * \brief	function details computed once
+		 * \return	nullptr if the type is not a function
+		 */
+		const func_type_data_t* getFuncDetails() const;
+
+		/*!
+		 * \brief	struct details computed once
+		 * \return	nullptr if the type is not a struct
+		 */
+		const udt_type_data_t* getUdtDetails() const;
+
 	public:
 
 		/*!
 		 * \brief	ctor 
+		 * \param	idaType	IDA type
+		 * \param	cache	layouts of named types, null to not share them
 		 */
-		explicit IdaTypeInfo(tinfo_t idaType);
+		explicit IdaTypeInfo(tinfo_t idaType, std::shared_ptr<IdaTypeCache> cache = nullptr);
 
 		/*!
 		 *	\brief	destructor
@@ -345,8 +433,14 @@ namespace yagi
 	 */
 	class IdaTypeInfoFactory : public TypeInfoFactory
 	{
+	protected:
+		/*!
+		 * \brief	layouts of named types kept during the whole session
+		 */
+		std::shared_ptr<IdaTypeCache> m_cache;
+
 	public:
-		explicit IdaTypeInfoFactory() = default;
+		explicit IdaTypeInfoFactory();
 		virtual ~IdaTypeInfoFactory() = default;
 
 		/*!
@@ -367,6 +461,17 @@ namespace yagi
 
 		std::optional<std::unique_ptr<TypeInfo>> build(tinfo_t info);
 		std::optional<std::unique_ptr<TypeInfo>> build_decl(const std::string& name);
+
+		/*!
+		 * \brief	Forget the layout of a local type
+		 * \param	name	name of the changed type
+		 */
+		void invalidate(const std::string& name) override;
+
+		/*!
+		 * \brief	Forget layouts of all types
+		 */
+		void invalidateAll() override;
 	};
 }
 
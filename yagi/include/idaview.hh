@@ -0,0 +1,62 @@
+#ifndef __YAGI_IDAVIEW__
+#define __YAGI_IDAVIEW__
+
+#include <idp.hpp>
+#include <kernwin.hpp>
+#include "linestore.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Position of a custom viewer into a LineStore
+	 *			Lines are generated by IDA only when they are shown,
+	 *			the user data of the viewer is the LineStore
+	 */
+	class LinePlace : public place_t
+	{
+	public:
+		/*!
+		 * \brief	index of the line in the store
+		 */
+		uval_t n;
+
+		/*!
+		 * \brief	ctor
+		 * \param	line	index of the line
+		 */
+		explicit LinePlace(uval_t line = 0)
+			: n{ line }
+		{
+			lnnum = 0;
+		}
+
+		/*!
+		 * \brief	Register the place class into IDA
+		 *			Must be called once before any viewer is created
+		 */
+		static void registerClass();
+
+		void idaapi print(qstring* out_buf, void* ud) const override;
+		uval_t idaapi touval(void* ud) const override;
+		place_t* idaapi clone(void) const override;
+		void idaapi copyfrom(const place_t* from) override;
+		place_t* idaapi makeplace(void* ud, uval_t x, int lnnum) const override;
+		int idaapi compare(const place_t* t2) const override;
+		void idaapi adjust(void* ud) override;
+		bool idaapi prev(void* ud) override;
+		bool idaapi next(void* ud) override;
+		bool idaapi beginning(void* ud) const override;
+		bool idaapi ending(void* ud) const override;
+		int idaapi generate(qstrvec_t* out, int* out_deflnnum, color_t* out_pfx_color, bgcolor_t* out_bgcolor, void* ud, int maxsize) const override;
+		void idaapi serialize(bytevec_t* out) const override;
+		bool idaapi deserialize(const uchar** pptr, const uchar* end) override;
+		int idaapi id() const override;
+		const char* idaapi name() const override;
+		ea_t idaapi toea() const override;
+		bool idaapi rebase(const segm_move_infos_t&) override;
+		place_t* idaapi enter(uint32*) const override;
+		void idaapi leave(uint32) const override;
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef __YAGI_IMAGELOADER__
+#define __YAGI_IMAGELOADER__
+
+#include "loader.hh"
+#include "memoryimage.hh"
+#include <memory>
+#include <libdecomp.hh>
+
+namespace yagi 
+{
+	/*!
+	 * \brief	Implement the LoadImage interface of Ghidra
+	 *			over a memory snapshot
+	 *			Reading does not need any access to the backend
+	 */
+	class ImageLoader : public LoadImage
+	{
+	protected:
+		/*!
+		 * \brief	snapshot shared by every loader of the same program
+		 */
+		std::shared_ptr<const MemoryImage> m_image;
+
+	public:
+		/*!
+		 * \brief	constructor
+		 * \param	image	memory snapshot
+		 */
+		explicit ImageLoader(std::shared_ptr<const MemoryImage> image);
+
+		/*!
+		 *	\brief	Copy is authorized because we only use copyable type
+		 */
+		ImageLoader(const ImageLoader&) = default;
+		ImageLoader& operator=(const ImageLoader&) = default;
+
+		/*!
+		 *	\brief	moving is allowed
+		 */
+		ImageLoader(ImageLoader&&) noexcept = default;
+		ImageLoader& operator=(ImageLoader&&) noexcept = default;
+
+		/*!
+		 * \brief	Return the name of the loader
+		 * \return	name of the current arch
+		 */
+		std::string getArchType(void) const override;
+
+		/*!
+		 * \brief	Copy data from the snapshot
+		 * \param	ptr	buffer pointer
+		 * \param	size	size of expected data
+		 * \param	addr	address of the payload
+		 */
+		void loadFill(uint1* ptr, int4 size, const Address& addr) override;
+
+		/*!
+		 * \brief	Adjust VMA
+		 * \param	adjust
+		 */
+		void adjustVma(long adjust) override;
+	};
+
+	/*!
+	 * \brief	Build loaders sharing the same snapshot
+	 */
+	class ImageLoaderFactory : public LoaderFactory
+	{
+	protected:
+		std::shared_ptr<const MemoryImage> m_image;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	image	memory snapshot
+		 */
+		explicit ImageLoaderFactory(std::shared_ptr<const MemoryImage> image);
+
+		/*!
+		 * \brief	build a loader over the snapshot
+		 */
+		LoadImage* build() override;
+	};
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef __YAGI_IMPORTINDEX__
+#define __YAGI_IMPORTINDEX__
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Index of imported symbols
+	 *			Use to answer import queries in constant time
+	 */
+	class ImportIndex
+	{
+	protected:
+		/*!
+		 * \brief	import name by address
+		 */
+		std::unordered_map<uint64_t, std::string> m_names;
+
+		/*!
+		 * \brief	set of all import names
+		 */
+		std::unordered_set<std::string> m_imports;
+
+	public:
+		/*!
+		 * \brief	Add an import
+		 * \param	ea		address of the import
+		 * \param	name	name of the import
+		 */
+		void add(uint64_t ea, const std::string& name);
+
+		/*!
+		 * \brief	Remove all imports
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Find the import at an address
+		 * \param	ea	address of the import
+		 * \return	name of the import if found
+		 */
+		std::optional<std::string> find(uint64_t ea) const;
+
+		/*!
+		 * \brief	Is this name an import name
+		 * \param	name	name to check
+		 */
+		bool contains(const std::string& name) const;
+
+		/*!
+		 * \brief	Number of imports
+		 */
+		size_t size() const noexcept;
+	};
+}
+
+#endif
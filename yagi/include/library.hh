@@ -0,0 +1,105 @@
+#ifndef __YAGI_LIBRARY__
+#define __YAGI_LIBRARY__
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "batch.hh"
+#include "decompiler.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Identify a library function across databases
+	 */
+	struct LibraryFunction
+	{
+		/*!
+		 * \brief	name given by the signature
+		 */
+		std::string name;
+
+		/*!
+		 * \brief	see FunctionSymbolInfo::getCloneHash
+		 */
+		uint64_t hash;
+
+		/*!
+		 * \brief	size of the function, addresses into it are moved
+		 */
+		uint64_t size;
+	};
+
+	/*!
+	 * \brief	Results of library functions shared by several databases
+	 *			One file per function into a directory, keyed by name and hash
+	 *			Files written by another version of the result format are ignored
+	 */
+	class LibraryStore
+	{
+	protected:
+		std::filesystem::path m_directory;
+
+		/*!
+		 * \brief	File of a library function
+		 */
+		std::filesystem::path getPath(const LibraryFunction& function) const;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			The directory is created on first save
+		 * \param	directory	directory of results
+		 */
+		explicit LibraryStore(std::filesystem::path directory);
+
+		/*!
+		 * \brief	Load the result of a library function
+		 * \param	ea			address of the function in the current database
+		 * \param	function	signature of the function
+		 * \return	the result moved to the function, nullopt if unknown
+		 */
+		std::optional<Decompiler::Result> load(uint64_t ea, const LibraryFunction& function) const;
+
+		/*!
+		 * \brief	Save the result of a library function
+		 *			Readers never see a partial file
+		 * \param	function	signature of the function
+		 * \param	result		decompilation result
+		 * \return	false if the file can't be written
+		 */
+		bool save(const LibraryFunction& function, const Decompiler::Result& result) const;
+	};
+
+	/*!
+	 * \brief	Save results of library functions into a store
+	 *			and forward all results to another output
+	 */
+	class LibraryBatchOutput : public BatchOutput
+	{
+	protected:
+		BatchOutput& m_next;
+
+		const LibraryStore& m_store;
+
+		/*!
+		 * \brief	signature of library functions of the batch
+		 */
+		std::unordered_map<uint64_t, LibraryFunction> m_functions;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	next		output receiving all results
+		 * \param	store		destination of library results
+		 * \param	functions	library functions of the batch
+		 */
+		LibraryBatchOutput(BatchOutput& next, const LibraryStore& store, std::unordered_map<uint64_t, LibraryFunction> functions);
+
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override;
+	};
+}
+
+#endif
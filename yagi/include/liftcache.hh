@@ -0,0 +1,163 @@
+#ifndef __YAGI_LIFTCACHE__
+#define __YAGI_LIFTCACHE__
+
+#include <libdecomp.hh>
+#include <map>
+#include <vector>
+
+namespace yagi 
+{
+	/*!
+	 * \brief	P-code of translated instructions by address and context
+	 *			A translation only depends on the bytes of the instruction
+	 *			and on the context registers, the context is part of the key
+	 *			and patched bytes are invalidated by the owner
+	 */
+	class LiftCache
+	{
+	public:
+		/*!
+		 * \brief	An op emitted by Sleigh
+		 */
+		struct Op
+		{
+			Address address;
+			OpCode opcode;
+			bool hasOutput;
+			VarnodeData output;
+
+			/*!
+			 * \brief	range of Lift::inputs
+			 */
+			size_t firstInput;
+			int4 inputCount;
+		};
+
+		/*!
+		 * \brief	Translation of an instruction
+		 */
+		struct Lift
+		{
+			/*!
+			 * \brief	context registers at the address of the instruction
+			 */
+			std::vector<uintm> context;
+
+			/*!
+			 * \brief	bytes translated, including delay slots
+			 */
+			int4 length = 0;
+
+			std::vector<Op> ops;
+
+			/*!
+			 * \brief	inputs of all ops
+			 */
+			std::vector<VarnodeData> inputs;
+		};
+
+	protected:
+		/*!
+		 * \brief	translations by instruction address, one per context
+		 */
+		std::map<uint64_t, std::vector<Lift>> m_lifts;
+
+		/*!
+		 * \brief	number of translations
+		 */
+		size_t m_count = 0;
+
+		/*!
+		 * \brief	number of translations above which the cache is emptied
+		 */
+		size_t m_maxCount;
+
+		/*!
+		 * \brief	longest translation, bounds the search of invalidate
+		 */
+		int4 m_maxLength = 0;
+
+	public:
+		/*!
+		 * \brief	ctor of an empty cache
+		 * \param	maxCount	number of translations above which the cache is emptied
+		 */
+		explicit LiftCache(size_t maxCount);
+
+		/*!
+		 * \brief	Translation of an instruction with this context
+		 * \return	nullptr if the instruction was not translated yet
+		 */
+		const Lift* find(uint64_t ea, const uintm* context, int4 contextSize) const;
+
+		/*!
+		 * \brief	Add the translation of an instruction
+		 */
+		void insert(uint64_t ea, Lift lift);
+
+		/*!
+		 * \brief	Forget translations reading a patched byte
+		 * \param	ea	address of the byte
+		 */
+		void invalidate(uint64_t ea);
+
+		/*!
+		 * \brief	Forget all translations
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Number of translations
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	Emit again ops of a translation
+		 * \return	length of the translation
+		 */
+		static int4 replay(const Lift& lift, PcodeEmit& emit);
+	};
+
+	/*!
+	 * \brief	Forward ops emitted by Sleigh and record them
+	 */
+	class LiftRecorder : public PcodeEmit
+	{
+	protected:
+		PcodeEmit& m_inner;
+		LiftCache::Lift& m_lift;
+
+	public:
+		LiftRecorder(PcodeEmit& inner, LiftCache::Lift& lift);
+
+		void dump(const Address& addr, OpCode opc, VarnodeData* outvar, VarnodeData* vars, int4 isize) override;
+	};
+
+	/*!
+	 * \brief	Sleigh translator reusing translations of a LiftCache
+	 *			Context changes committed by a translation are already
+	 *			stored into the context database when it is reused
+	 */
+	class CachedSleigh : public Sleigh
+	{
+	protected:
+		LiftCache& m_cache;
+		ContextDatabase* m_context;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	loader	loader of instruction bytes
+		 * \param	context	context database, part of the cache key
+		 * \param	cache	translations, owned by the architecture
+		 */
+		CachedSleigh(LoadImage* loader, ContextDatabase* context, LiftCache& cache);
+
+		/*!
+		 * \brief	Reuse the cached translation or translate and record it
+		 */
+		int4 oneInstruction(PcodeEmit& emit, const Address& baseaddr) const override;
+	};
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __YAGI_LINESTORE__
+#define __YAGI_LINESTORE__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Lines of a decompiled function, split on demand
+	 *			The text is kept as a single buffer with the start of each line
+	 *			so a viewer only builds the lines it shows
+	 */
+	class LineStore
+	{
+	protected:
+		/*!
+		 * \brief	the whole output, with color tags
+		 */
+		std::string m_text;
+
+		/*!
+		 * \brief	offset of the first char of each line into m_text
+		 */
+		std::vector<size_t> m_starts;
+
+	public:
+		/*!
+		 * \brief	ctor, index the lines of a text
+		 *			A trailing new line does not start an empty line
+		 * \param	text	lines separated by '\n'
+		 */
+		explicit LineStore(std::string text = std::string());
+
+		/*!
+		 * \brief	Number of lines, at least one
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	A line without its new line
+		 * \param	index	index of the line, lower than size()
+		 * \return	a view valid as long as the store
+		 */
+		std::string_view getLine(size_t index) const noexcept;
+	};
+}
+
+#endif
@@ -5,29 +5,67 @@
 #include <sstream>
 #include <ostream>
 
+/*!
+ * \brief	Minimum level of compiled logs (see LogLevel)
+ *			Logs under this level are removed at compile time
+ */
+#ifndef YAGI_LOG_LEVEL
+#define YAGI_LOG_LEVEL 0
+#endif
+
 namespace yagi
 {
 	/*!
-	 * \brief	A base class for every logger 
+	 * \brief	Severity of a log message
+	 */
+	enum class LogLevel : int
+	{
+		Trace = 0,	// details of every lookup made during a decompilation
+		Debug = 1,	// decisions made during a decompilation
+		Info = 2,	// user facing informations
+		Error = 3,	// errors only
+		Off = 4		// nothing
+	};
+
+	/*!
+	 * \brief	A base class for every logger
 	 */
 	class Logger
 	{
+		/*!
+		 * \brief	Forward already formatted messages
+		 */
+		friend class SyncLogger;
+		friend class RingLogger;
+
+	protected:
+		/*!
+		 * \brief	messages under this level are dropped before formatting
+		 */
+		LogLevel m_level = LogLevel::Info;
+
 	private:
 		/*!
-		 * \brief	Format any message from logger implementation 
+		 * \brief	Format any message from logger implementation
+		 *			Nothing is formatted if the level is disabled
 		 */
-		template<typename... Params>
-		void format(const std::string& level, const std::string& message, Params... parameters)
+		template<LogLevel Level, typename... Params>
+		void format(const char* level, const std::string& message, const Params&... parameters)
 		{
-			std::stringstream ss;
-			ss << "[Yagi] " << level << " : ";
-			for (auto& val : { message, parameters ... })
+			if constexpr (static_cast<int>(Level) >= YAGI_LOG_LEVEL)
 			{
-				ss << " " << val;
-			}
+				if (!isEnabled(Level))
+				{
+					return;
+				}
 
-			ss << std::endl;
-			print(ss.str());
+				std::stringstream ss;
+				ss << "[Yagi] " << level << " : " << " " << message;
+				((ss << " " << parameters), ...);
+
+				ss << std::endl;
+				print(ss.str());
+			}
 		}
 
 		/*!
@@ -37,7 +75,36 @@ namespace yagi
 		virtual void print(const std::string& message) = 0;
 
 	public:
-		
+		/*!
+		 * \brief	destructor
+		 */
+		virtual ~Logger() = default;
+
+		/*!
+		 * \brief	Change the minimum level of printed messages
+		 */
+		void setLevel(LogLevel level) noexcept
+		{
+			m_level = level;
+		}
+
+		/*!
+		 * \brief	Minimum level of printed messages
+		 */
+		LogLevel getLevel() const noexcept
+		{
+			return m_level;
+		}
+
+		/*!
+		 * \brief	Is a message of this level printed
+		 *			Use to avoid computing expensive parameters
+		 */
+		bool isEnabled(LogLevel level) const noexcept
+		{
+			return static_cast<int>(level) >= YAGI_LOG_LEVEL && level >= m_level && level != LogLevel::Off;
+		}
+
 		/*!
 		 *	\brief	An error message
 		 *			This will be prefixed with the ERROR keyword
@@ -45,17 +112,35 @@ namespace yagi
 		 *  \param	parameters	convenient format parameters
 		 */
 		template<typename... Params>
-		void error(const std::string& message, Params... parameters) {
-			this->format("ERROR", message, parameters...);
+		void error(const std::string& message, const Params&... parameters) {
+			this->format<LogLevel::Error>("ERROR", message, parameters...);
 		}
 
 		/*!
 		 * \brief	Write an informations log
-		 *			This will prefix all message with the INFI prefix
+		 *			This will prefix all message with the INFO prefix
+		 */
+		template<typename... Params>
+		void info(const std::string& message, const Params&... parameters) {
+			this->format<LogLevel::Info>("INFO", message, parameters...);
+		}
+
+		/*!
+		 * \brief	Write a debug log
+		 *			Use for decisions made during a decompilation
+		 */
+		template<typename... Params>
+		void debug(const std::string& message, const Params&... parameters) {
+			this->format<LogLevel::Debug>("DEBUG", message, parameters...);
+		}
+
+		/*!
+		 * \brief	Write a trace log
+		 *			Use on hot paths, removed from release builds
 		 */
 		template<typename... Params>
-		void info(const std::string& message, Params... parameters) {
-			this->format("INFO", message, parameters...);
+		void trace(const std::string& message, const Params&... parameters) {
+			this->format<LogLevel::Trace>("TRACE", message, parameters...);
 		}
 	};
 }
@@ -0,0 +1,22 @@
+#ifndef __YAGI_MEMORY__
+#define __YAGI_MEMORY__
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Resident memory of the current process
+	 * \return	size in bytes, nullopt if the platform can't tell
+	 */
+	std::optional<size_t> getProcessMemory() noexcept;
+
+	/*!
+	 * \brief	Human readable size, in MiB
+	 */
+	std::string formatMemory(size_t bytes);
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef __YAGI_MEMORYIMAGE__
+#define __YAGI_MEMORYIMAGE__
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Snapshot of the program memory
+	 *			Pages are stored contiguously and indexed by their address
+	 *			Concurrent reads are safe as long as nobody writes
+	 */
+	class MemoryImage
+	{
+	public:
+		/*!
+		 * \brief	Granularity of the page index
+		 */
+		static constexpr uint64_t PAGE_SIZE = 0x1000;
+
+	protected:
+		/*!
+		 * \brief	content of all mapped pages
+		 */
+		std::vector<uint8_t> m_data;
+
+		/*!
+		 * \brief	page address to offset into m_data
+		 */
+		std::unordered_map<uint64_t, size_t> m_pages;
+
+		/*!
+		 * \brief	find or create the page at this address
+		 * \return	offset of the page into m_data
+		 */
+		size_t mapPage(uint64_t page);
+
+	public:
+		/*!
+		 * \brief	ctor of an empty image
+		 */
+		MemoryImage() = default;
+
+		/*!
+		 *	\brief	Copy is authorized because we only use copyable type
+		 */
+		MemoryImage(const MemoryImage&) = default;
+		MemoryImage& operator=(const MemoryImage&) = default;
+
+		/*!
+		 *	\brief	moving is allowed
+		 */
+		MemoryImage(MemoryImage&&) noexcept = default;
+		MemoryImage& operator=(MemoryImage&&) noexcept = default;
+
+		/*!
+		 * \brief	Reserve memory for a number of bytes
+		 *			Use to avoid reallocation during a capture
+		 */
+		void reserve(size_t size);
+
+		/*!
+		 * \brief	Copy bytes into the image, pages are mapped as needed
+		 * \param	ea		address of the first byte
+		 * \param	data	bytes to copy
+		 * \param	size	number of bytes
+		 */
+		void write(uint64_t ea, const uint8_t* data, size_t size);
+
+		/*!
+		 * \brief	Read bytes from the image
+		 *			Bytes from unmapped pages are set to zero
+		 * \param	ea		address of the first byte
+		 * \param	buffer	output buffer
+		 * \param	size	number of bytes
+		 * \return	number of bytes read from mapped pages
+		 */
+		size_t read(uint64_t ea, uint8_t* buffer, size_t size) const;
+
+		/*!
+		 * \brief	Unmap all pages
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Size of all mapped pages in bytes
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	Address of all mapped pages
+		 *			Use to serialize the image
+		 * \return	page addresses sorted in ascending order
+		 */
+		std::vector<uint64_t> pages() const;
+	};
+}
+
+#endif
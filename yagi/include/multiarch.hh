@@ -0,0 +1,116 @@
+#ifndef __YAGI_MULTIARCH__
+#define __YAGI_MULTIARCH__
+
+#include "decompiler.hh"
+#include "logger.hh"
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Route each function to the decompiler of its instruction set
+	 *			Decompilers of alternate instruction sets are built
+	 *			on first use and kept for the session
+	 */
+	class MultiArchDecompiler : public Decompiler
+	{
+	public:
+		/*!
+		 * \brief	Compute the compiler of a function
+		 */
+		using Selector = std::function<Compiler(uint64_t)>;
+
+		/*!
+		 * \brief	Build a decompiler for a compiler
+		 */
+		using Builder = std::function<std::optional<std::unique_ptr<Decompiler>>(const Compiler&)>;
+
+	protected:
+		/*!
+		 * \brief	built decompilers by architecture key
+		 *			null when the build failed
+		 */
+		std::map<std::string, std::unique_ptr<Decompiler>> m_decompilers;
+
+		/*!
+		 * \brief	key of the default architecture
+		 */
+		std::string m_defaultKey;
+
+		/*!
+		 * \brief	token applied to every decompiler, even those built later
+		 */
+		std::shared_ptr<const CancelToken> m_cancel;
+
+		/*!
+		 * \brief	profile output applied to every decompiler, even those built later
+		 */
+		std::shared_ptr<ProfileOutput> m_profile;
+
+		Selector m_selector;
+		Builder m_builder;
+
+		/*!
+		 * \brief	use to report a failed build
+		 */
+		std::unique_ptr<Logger> m_logger;
+
+		/*!
+		 * \brief	Find or build the decompiler of a function
+		 * \return	nullptr if the decompiler can't be built
+		 */
+		Decompiler* select(uint64_t funcAddress);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	compiler	compiler of the default decompiler
+		 * \param	decompiler	default decompiler
+		 * \param	selector	compute the compiler of a function
+		 * \param	builder		build decompilers of other compilers
+		 * \param	logger		use to report a failed build
+		 */
+		explicit MultiArchDecompiler(
+			const Compiler& compiler,
+			std::unique_ptr<Decompiler> decompiler,
+			Selector selector,
+			Builder builder,
+			std::unique_ptr<Logger> logger
+		);
+
+		/*!
+		 *	\brief	Copy is forbidden
+		 */
+		MultiArchDecompiler(const MultiArchDecompiler&) = delete;
+		MultiArchDecompiler& operator=(const MultiArchDecompiler&) = delete;
+
+		/*!
+		 * \brief	Number of built decompilers, including failed builds
+		 */
+		size_t size() const noexcept;
+
+		std::optional<Result> decompile(uint64_t funcAddress) override;
+		std::optional<Result> refreshNames(uint64_t funcAddress) override;
+		void invalidate(uint64_t funcAddress) override;
+		void invalidateDependents(uint64_t ea) override;
+		void invalidateCode(uint64_t ea) override;
+		void clearCache() override;
+		void invalidateType(const std::string& name) override;
+		void invalidateTypes() override;
+		void retain(uint64_t funcAddress) override;
+		void release(uint64_t funcAddress) override;
+		void setCancelToken(std::shared_ptr<const CancelToken> token) override;
+		void setProfileOutput(std::shared_ptr<ProfileOutput> output) override;
+
+		/*!
+		 * \brief	Types are translated by each architecture
+		 *			only the default one is warmed
+		 */
+		size_t prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names) override;
+	};
+}
+
+#endif
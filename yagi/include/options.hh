@@ -0,0 +1,209 @@
+#ifndef __YAGI_OPTIONS__
+#define __YAGI_OPTIONS__
+
+#include <string>
+#include <unordered_set>
+#include <cstdint>
+#include "logger.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	User configuration of Yagi
+	 *			Options are provided through the plugin option string
+	 *			ida -Oyagi:key=value,key=value
+	 */
+	struct Options
+	{
+		/*!
+		 * \brief	Backend use to read program bytes
+		 */
+		enum class Loader
+		{
+			Ida,		// read bytes from IDA on each request
+			Snapshot	// read bytes from a snapshot of all segments
+		};
+
+		/*!
+		 * \brief	Number of decompilation results kept in memory
+		 *			0 disable the in memory cache
+		 */
+		size_t cacheSize = 64;
+
+		/*!
+		 * \brief	Save decompilation results into the database
+		 *			to survive a reopening of the IDB
+		 */
+		bool persistCache = false;
+
+		/*!
+		 * \brief	Number of decompilers used by the batch mode
+		 *			0 use one decompiler per hardware thread
+		 */
+		size_t batchWorkers = 0;
+
+		/*!
+		 * \brief	Workers of the batch mode read symbols and types
+		 *			from an immutable snapshot of the whole database
+		 *			instead of querying IDA through the main thread
+		 */
+		bool batchSnapshot = true;
+
+		/*!
+		 * \brief	The batch mode decompiles callees before their callers
+		 *			Recovered prototypes are used by callers
+		 *			and stored into the database, except user defined ones
+		 */
+		bool batchPropagate = false;
+
+		/*!
+		 * \brief	The batch mode decompiles identical functions once
+		 *			others are written from its result with their own name and addresses
+		 */
+		bool batchDedup = false;
+
+		/*!
+		 * \brief	Library functions (FLIRT) are not decompiled
+		 *			by the batch and the prefetch unless found into the library directory
+		 */
+		bool librarySkip = false;
+
+		/*!
+		 * \brief	Directory of results of library functions shared by databases
+		 *			Library functions found there are not decompiled
+		 *			and those decompiled by the batch are saved there
+		 */
+		std::string libraryDir;
+
+		/*!
+		 * \brief	Backend use by the interactive decompiler to read bytes
+		 *			The batch mode always use a snapshot
+		 */
+		Loader loader = Loader::Ida;
+
+		/*!
+		 * \brief	Segments considered read only whatever their permissions
+		 *			their data is propagated as constant by the decompiler
+		 *			names are separated by ';' in the option string
+		 */
+		std::unordered_set<std::string> readOnlySegments = { ".data" };
+
+		/*!
+		 * \brief	Minimum level of printed messages
+		 */
+		LogLevel logLevel = LogLevel::Info;
+
+		/*!
+		 * \brief	Maximum number of messages printed per second
+		 *			into the output window, 0 means unlimited
+		 */
+		size_t logRate = 100;
+
+		/*!
+		 * \brief	Time allowed to an interactive decompilation in milliseconds
+		 *			a simplified output is shown past this delay
+		 *			0 means unlimited
+		 */
+		size_t decompileBudget = 0;
+
+		/*!
+		 * \brief	Resident memory of the process in MiB above which
+		 *			a decompiler releases its cached symbols and types
+		 *			and the analysis kept for renames, 0 means unlimited
+		 */
+		size_t memoryLimit = 0;
+
+		/*!
+		 * \brief	Size in bytes above which a function is analyzed
+		 *			in large function mode, 0 disables this trigger
+		 *			Expensive rule groups are skipped and the output is marked
+		 */
+		size_t largeFunctionSize = 0x10000;
+
+		/*!
+		 * \brief	Number of p-code ops above which a function is analyzed
+		 *			in large function mode, 0 disables this trigger
+		 *			Checked once the flow of the function is built
+		 */
+		size_t largeFunctionOps = 100000;
+
+		/*!
+		 * \brief	Passes of the main simplification loop allowed
+		 *			in large function mode, 0 means unlimited
+		 *			The simplified output is shown past this limit
+		 */
+		size_t largeFunctionPasses = 4;
+
+		/*!
+		 * \brief	Use the jump tables resolved by IDA
+		 *			instead of recovering them in the decompiler
+		 */
+		bool seedFlow = false;
+
+		/*!
+		 * \brief	Keep every printed token into results, with its kind
+		 *			instead of only the symbols used by the viewer
+		 */
+		bool tokenStream = false;
+
+		/*!
+		 * \brief	Port of the decompiler service (yagi_service)
+		 *			0 decompiles into the IDA process
+		 */
+		size_t servicePort = 0;
+
+		/*!
+		 * \brief	Time allowed to a decompilation by the service in milliseconds
+		 *			0 means unlimited
+		 */
+		size_t serviceTimeout = 60000;
+
+		/*!
+		 * \brief	Number of callees decompiled in background
+		 *			after each decompilation, 0 disable the prefetch
+		 *			Results are kept into the in memory cache
+		 */
+		size_t prefetch = 4;
+
+		/*!
+		 * \brief	Also prefetch callers of the decompiled function
+		 */
+		bool prefetchCallers = false;
+
+		/*!
+		 * \brief	Local types are translated in background once the decompiler is built
+		 *			and kept until one of them changes
+		 */
+		bool prewarmTypes = true;
+
+		/*!
+		 * \brief	Maximum share of the interactive decompiler time, in percent,
+		 *			used by prefetches and other background jobs
+		 *			User requests are never delayed
+		 */
+		size_t backgroundCpu = 50;
+
+		/*!
+		 * \brief	Directory of profiling reports, one JSON file per function
+		 *			Profiling is enabled at startup when set
+		 *			and can be toggled with run_plugin(yagi, 4)
+		 */
+		std::string profileDir;
+
+		/*!
+		 * \brief	Number of functions profiled by run_plugin(yagi, 8)
+		 *			spread over the whole database, 0 for all functions
+		 */
+		size_t profileSample = 0;
+
+		/*!
+		 * \brief	Parse an option string
+		 *			Unknown keys and malformed values are ignored
+		 * \param	options	comma separated list of key=value
+		 * \return	options with default values for missing keys
+		 */
+		static Options parse(const std::string& options);
+	};
+}
+
+#endif
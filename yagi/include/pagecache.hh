@@ -0,0 +1,106 @@
+#ifndef __YAGI_PAGECACHE__
+#define __YAGI_PAGECACHE__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Pages of the program memory read on demand from a slow backend
+	 *			Each range of missing pages is fetched by a single backend read
+	 *			so the many small reads of a decompilation hit memory
+	 *			Shared by decompilers of different threads,
+	 *			the backend is never called with the lock held
+	 */
+	class PageCache
+	{
+	public:
+		/*!
+		 * \brief	Granularity of backend reads
+		 */
+		static constexpr uint64_t PAGE_SIZE = 0x1000;
+
+		/*!
+		 * \brief	Backend read of a range of pages
+		 *			the buffer is zeroed before the call
+		 */
+		using Fetch = std::function<void(uint64_t ea, uint8_t* buffer, size_t size)>;
+
+	protected:
+		mutable std::mutex m_mutex;
+
+		/*!
+		 * \brief	content of cached pages by page address
+		 */
+		std::unordered_map<uint64_t, std::vector<uint8_t>> m_pages;
+
+		/*!
+		 * \brief	number of cached pages above which the cache is emptied
+		 */
+		size_t m_maxPages;
+
+		/*!
+		 * \brief	incremented by each invalidation
+		 *			pages fetched before it are not cached
+		 */
+		uint64_t m_generation = 0;
+
+		/*!
+		 * \brief	Fetch a range of pages and copy the requested part
+		 * \param	fetch		backend read
+		 * \param	first		address of the first page
+		 * \param	count		number of pages
+		 * \param	ea			address of the requested bytes
+		 * \param	buffer		output buffer of the requested bytes
+		 * \param	size		number of requested bytes
+		 * \param	generation	generation read before the fetch
+		 */
+		void fetchPages(const Fetch& fetch, uint64_t first, size_t count, uint64_t ea, uint8_t* buffer, size_t size, uint64_t generation);
+
+	public:
+		/*!
+		 * \brief	ctor of an empty cache
+		 * \param	maxPages	number of cached pages above which the cache is emptied
+		 */
+		explicit PageCache(size_t maxPages);
+
+		/*!
+		 * \brief	Copy is forbidden, the cache is shared
+		 */
+		PageCache(const PageCache&) = delete;
+		PageCache& operator=(const PageCache&) = delete;
+
+		/*!
+		 * \brief	Read bytes, missing pages are fetched from the backend
+		 * \param	fetch	backend read of the calling decompiler
+		 * \param	ea		address of the first byte
+		 * \param	buffer	output buffer
+		 * \param	size	number of bytes
+		 */
+		void read(const Fetch& fetch, uint64_t ea, uint8_t* buffer, size_t size);
+
+		/*!
+		 * \brief	Forget pages holding a range of patched bytes
+		 * \param	ea		address of the first byte
+		 * \param	size	number of bytes
+		 */
+		void invalidate(uint64_t ea, size_t size);
+
+		/*!
+		 * \brief	Forget all pages, the memory layout changed
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Number of cached pages
+		 */
+		size_t size() const;
+	};
+}
+
+#endif
@@ -2,32 +2,384 @@
 #define __YAGI_PLUGIN__
 
 #include <idp.hpp>
+#include <kernwin.hpp>
 #include <memory>
+#include <optional>
+#include <set>
 #include <sstream>
+#include "compactresult.hh"
 #include "decompiler.hh"
+#include "deferred.hh"
+#include "async.hh"
+#include "sync.hh"
+#include "prefetch.hh"
+#include "scheduler.hh"
+#include "profile.hh"
+#include "options.hh"
+#include "memoryimage.hh"
+#include "pagecache.hh"
+#include "linestore.hh"
 
 namespace yagi {
 
+	class Plugin;
+	class IdaImportIndex;
+	class IdaSegmentIndex;
+	class IdaNameCache;
+	class BatchOutput;
+	class LibraryStore;
+	class ExportView;
+	class PrototypeStore;
+
+	/*!
+	 * \brief	Rename or retype of a local variable, see Plugin::editLocals
+	 */
+	struct LocalEdit
+	{
+		/*!
+		 * \brief	name of the variable as printed
+		 */
+		std::string name;
+
+		/*!
+		 * \brief	new name, empty to keep it
+		 */
+		std::string newName;
+
+		/*!
+		 * \brief	new type declaration, empty to keep it
+		 */
+		std::string type;
+	};
+
+	/*!
+	 * \brief	Menu action use to decompile all functions
+	 */
+	class DecompileAllHandler : public action_handler_t {
+	protected:
+		/*!
+		 * \brief	plugin that run the batch
+		 */
+		Plugin& m_plugin;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 */
+		explicit DecompileAllHandler(Plugin& plugin);
+
+		/*!
+		 * \brief	Run the batch decompilation
+		 */
+		int idaapi activate(action_activation_ctx_t* ctx) override;
+
+		/*!
+		 * \brief	Always available
+		 */
+		action_state_t idaapi update(action_update_ctx_t* ctx) override;
+	};
+
+	/*!
+	 * \brief	Table of profiled functions, see Plugin::profileAll
+	 *			Not modal, deleted by IDA when closed
+	 */
+	class ProfileChooser : public chooser_t {
+	protected:
+		/*!
+		 * \brief	profiled functions, the slowest first
+		 */
+		std::vector<SummaryProfileOutput::Row> m_rows;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 */
+		explicit ProfileChooser(std::vector<SummaryProfileOutput::Row> rows);
+
+		size_t idaapi get_count() const override;
+		void idaapi get_row(qstrvec_t* cols, int* icon, chooser_item_attrs_t* attrs, size_t n) const override;
+		ea_t idaapi get_ea(size_t n) const override;
+
+		/*!
+		 * \brief	Jump to the function
+		 */
+		cbret_t idaapi enter(size_t n) override;
+	};
+
+	/*!
+	 * \brief	Data of a code viewer
+	 *			Owned by the viewer, deleted when it is closed
+	 */
+	struct Viewer
+	{
+		/*!
+		 * \brief	null once the plugin is unloaded
+		 */
+		Plugin* plugin;
+
+		/*!
+		 * \brief	the shown result, without its code
+		 */
+		CompactResult code;
+
+		/*!
+		 * \brief	the code, lines are built by the viewer when shown
+		 */
+		LineStore lines;
+	};
+
 	/*!
 	 * \brief	IdaPlugin definition
 	 */
 	class Plugin : public plugmod_t {
 	protected:
 		/*!
-		 * \brief	the Ghidra decompiler
+		 * \brief	backend requests of the decompiler, owned by the main thread
+		 *			must outlive the decompiler
+		 */
+		std::shared_ptr<RequestQueue> m_queue;
+
+		/*!
+		 * \brief	the Ghidra decompiler, built in background
+		 */
+		std::unique_ptr<DeferredDecompiler> m_decompiler;
+
+		/*!
+		 * \brief	run the decompiler out of the main thread
+		 */
+		AsyncDecompiler m_async;
+
+		/*!
+		 * \brief	function to decompile once the canceled job is done
+		 */
+		std::optional<std::pair<uint64_t, AsyncDecompiler::Command>> m_next;
+
+		/*!
+		 * \brief	name of the viewer waiting for the running job
+		 */
+		std::string m_placeholder;
+
+		/*!
+		 * \brief	process the queue while building or decompiling
+		 *			null when idle
+		 */
+		qtimer_t m_timer = nullptr;
+
+		/*!
+		 * \brief	compiler of the database, use to build batch decompilers
+		 */
+		Compiler m_compiler;
+
+		/*!
+		 * \brief	user configuration
+		 */
+		Options m_options;
+
+		/*!
+		 * \brief	snapshot use by the decompiler when the snapshot loader is selected
+		 *			null when bytes are read from IDA
+		 */
+		std::shared_ptr<MemoryImage> m_image;
+
+		/*!
+		 * \brief	pages read from IDA by the decompiler when the IDA loader is selected
+		 *			null when bytes are read from the snapshot
+		 */
+		std::shared_ptr<PageCache> m_pages;
+
+		/*!
+		 * \brief	imports of the database shared with symbol factories
+		 */
+		std::shared_ptr<IdaImportIndex> m_imports;
+
+		/*!
+		 * \brief	segments of the database shared with symbol factories
+		 */
+		std::shared_ptr<IdaSegmentIndex> m_segments;
+
+		/*!
+		 * \brief	demangled names shared with symbol factories
+		 */
+		std::shared_ptr<IdaNameCache> m_names;
+
+		/*!
+		 * \brief	functions decompiled when no user request is running
+		 */
+		Prefetcher m_prefetcher;
+
+		/*!
+		 * \brief	order and measure jobs sharing the decompiler
+		 */
+		JobScheduler m_scheduler;
+
+		/*!
+		 * \brief	time of the last user request
+		 */
+		JobScheduler::Clock::time_point m_submitted;
+
+		/*!
+		 * \brief	true when the running job is a prefetch
+		 *			its result is only kept into the cache
+		 */
+		bool m_prefetching = false;
+
+		/*!
+		 * \brief	snapshot of the local types translated in the background
+		 *			null before the build and once all names are translated
+		 */
+		std::shared_ptr<TypeInfoFactory> m_prewarmSource;
+
+		/*!
+		 * \brief	names of the snapshot, translated by slices
+		 */
+		std::vector<std::string> m_prewarmNames;
+
+		/*!
+		 * \brief	first name of the next slice
+		 */
+		size_t m_prewarmNext = 0;
+
+		/*!
+		 * \brief	the snapshot is taken once per session
 		 */
-		std::unique_ptr<Decompiler> m_decompiler;
+		bool m_prewarmTaken = false;
+
+		/*!
+		 * \brief	true when the running job translates types
+		 *			it has no result to show
+		 */
+		bool m_prewarming = false;
+
+		/*!
+		 * \brief	destination of profiling reports
+		 *			null when profiling is disabled
+		 */
+		std::shared_ptr<ProfileOutput> m_profile;
+
+		/*!
+		 * \brief	results of library functions shared by databases
+		 *			null if the library_dir option is not set
+		 */
+		std::unique_ptr<LibraryStore> m_library;
+
+		/*!
+		 * \brief	handler of the decompile all menu action
+		 */
+		DecompileAllHandler m_decompileAllHandler;
+
+		/*!
+		 * \brief	open code viewers
+		 *			their functions are retained by the decompiler
+		 */
+		std::set<Viewer*> m_viewers;
+
+		/*!
+		 * \brief	Start a job and show a placeholder until its end
+		 */
+		void start(uint64_t ea, AsyncDecompiler::Command command);
+
+		/*!
+		 * \brief	Show the result of a job
+		 *			or the reason why it has none
+		 */
+		void show(AsyncDecompiler::Outcome outcome);
+
+		/*!
+		 * \brief	Schedule the callees, and callers if enabled, of a result
+		 */
+		void prefetch(const Decompiler::Result& result);
+
+		/*!
+		 * \brief	Start a prefetch or the next slice of types
+		 *			when the decompiler is idle
+		 * \return	true if a job was started
+		 */
+		bool startBackground();
+
+		/*!
+		 * \brief	Account the end of the running job
+		 * \return	true if the outcome is of a background job, not shown to the user
+		 */
+		bool end(const AsyncDecompiler::Outcome& outcome);
+
+		/*!
+		 * \brief	Is a background job waiting
+		 */
+		bool hasBackground() const noexcept;
+
+		/*!
+		 * \brief	Forget the types not translated yet
+		 *			the snapshot is older than a change
+		 */
+		void dropPrewarm();
+
+		/*!
+		 * \brief	Cancel the running job and wait for the end of the build
+		 *			Requests are processed while waiting
+		 *			Pending prefetches are dropped
+		 * \return	outcome of the canceled user job if any
+		 */
+		std::optional<AsyncDecompiler::Outcome> stop();
+
+		/*!
+		 * \brief	Start a job once the running one stopped
+		 *			The last request wins, prefetches are stopped the same way
+		 */
+		void request(uint64_t ea, AsyncDecompiler::Command command);
+
+		/*!
+		 * \brief	Run a job without viewer and wait for its end
+		 *			Requests are processed while waiting
+		 */
+		AsyncDecompiler::Outcome wait(uint64_t ea, AsyncDecompiler::Command command);
+
+		/*!
+		 * \brief	Build decompilers of a batch
+		 *			The interactive decompiler must be built and idle
+		 * \param	count		number of workers
+		 * \param	queue		backend requests of workers
+		 * \param	snapshot	database read by workers, null to read it through the queue
+		 * \param	image		bytes read when there is no snapshot
+		 * \param	prototypes	recovered prototypes shared by workers, may be null
+		 * \param	profile		destination of profiles, may be null
+		 * \return	fewer workers than requested if a build failed
+		 */
+		std::vector<std::unique_ptr<Decompiler>> loadWorkers(size_t count, RequestQueue& queue, std::shared_ptr<const ExportView> snapshot, std::shared_ptr<const MemoryImage> image, std::shared_ptr<PrototypeStore> prototypes, std::shared_ptr<ProfileOutput> profile);
 
 	public:
+		/*!
+		 * \brief	Argument of the run function
+		 *			Use from scripts, run_plugin(yagi, 1)
+		 */
+		enum class Command : size_t
+		{
+			Decompile = 0,		// decompile the function under the cursor
+			DecompileAll = 1,	// decompile all functions into files
+			RefreshNames = 2,	// apply new local names on the last decompiled function
+			Cancel = 3,			// stop the running decompilation
+			ToggleProfile = 4,	// enable or disable profiling reports
+			Export = 5,			// export the database for the headless decompiler
+			Memory = 6,			// print the memory used by IDA and the memory limit
+			Scheduler = 7,		// print queue depth and latency of each job class
+			Hotspots = 8		// profile all functions and show the slowest ones
+		};
+
 		/*!
 		 * \brief	Plugin ctor
+		 * \param	queue		backend requests of the decompiler, owned by the main thread
+		 * \param	decompiler	interactive decompiler, may still be building
+		 * \param	compiler	compiler of the database
+		 * \param	options		user configuration
+		 * \param	image		snapshot read by the decompiler, may be null
+		 * \param	pages		pages read from IDA by the decompiler, may be null
+		 * \param	imports		import index used by the symbol factory of the decompiler
 		 */
-		explicit Plugin(std::unique_ptr<Decompiler> decompiler);
+		explicit Plugin(std::shared_ptr<RequestQueue> queue, std::unique_ptr<DeferredDecompiler> decompiler, Compiler compiler, Options options, std::shared_ptr<MemoryImage> image, std::shared_ptr<PageCache> pages, std::shared_ptr<IdaImportIndex> imports, std::shared_ptr<IdaSegmentIndex> segments, std::shared_ptr<IdaNameCache> names);
 
 		/*!
 		 * \brief	destructor
 		 */
-		virtual ~Plugin() = default;
+		virtual ~Plugin();
 
 		/*!
 		 * \brief	copy id disable
@@ -43,13 +395,166 @@ namespace yagi {
 
 		/*!
 		 * \brief	Run the plugin API
+		 * \param	arg	command to run (see Command)
+		 */
+		virtual bool idaapi run(size_t arg) override;
+
+		/*!
+		 * \brief	Process backend requests for a time slice
+		 *			and collect the end of the running job
+		 *			Called by the timer from the main thread
+		 * \return	delay before the next call, -1 when idle
 		 */
-		virtual bool idaapi run(size_t) override;
+		int pump();
+
+		/*!
+		 * \brief	Is a decompilation running
+		 */
+		bool isBusy() const noexcept;
+
+		/*!
+		 * \brief	Enable or disable profiling of next decompilations
+		 *			Reports are written into the profile_dir option
+		 *			or next to the database
+		 */
+		void toggleProfile();
+
+		/*!
+		 * \brief	Decompile all functions of the database
+		 *			using a pool of independent decompilers
+		 *			Results are written into a file or a directory
+		 */
+		void decompileAll();
+
+		/*!
+		 * \brief	Profile all functions, or a sample of profile_sample functions
+		 *			with a single worker without cache
+		 *			Time, memory growth, sizes, rule and IDA request counts of each function
+		 *			are shown into a table and written into hotspots.csv
+		 *			in the directory of profiling reports
+		 */
+		void profileAll();
+
+		/*!
+		 * \brief	Decompile functions with the interactive decompiler
+		 *			Use by scripts through the yagi_decompile IDC function
+		 *			Results come from the cache when they are up to date
+		 *			The running job is canceled and prefetches are dropped
+		 * \param	functions	address of functions to decompile
+		 * \param	output		destination of results
+		 * \return	false if the decompiler is unavailable
+		 */
+		bool decompileFunctions(const std::vector<uint64_t>& functions, BatchOutput& output);
+
+		/*!
+		 * \brief	Rename and retype local variables of a function at once
+		 *			Use by scripts through the yagi_edit_locals IDC function
+		 *			Names are stored by a single transaction
+		 *			then an open viewer of the function is refreshed once
+		 * \param	ea		address of the function
+		 * \param	edits	variables to change, by printed name
+		 * \return	number of edits applied
+		 */
+		size_t editLocals(uint64_t ea, const std::vector<LocalEdit>& edits);
+
+		/*!
+		 * \brief	Write segments, names, functions and types into a file
+		 *			read by the headless decompiler (yagi_cli)
+		 */
+		void exportDatabase();
+
+		/*!
+		 * \brief	Print the resident memory of IDA and the memory limit
+		 */
+		void showMemory() const;
+
+		/*!
+		 * \brief	Print queue depth and latency of each job class
+		 */
+		void showScheduler();
 
 		/*!
 		 * \brief	View decompilation
+		 *			The result is moved into the viewer
+		 * \param	code	result to display, the viewer is named after the function
+		 */
+		void view(Decompiler::Result code);
+
+		/*!
+		 * \brief	A viewer is closed, its function is released
+		 */
+		void close(Viewer& viewer);
+
+		/*!
+		 * \brief	Forget all cached decompilation results
+		 *			Called when the database is changed
+		 */
+		void clearCache();
+
+		/*!
+		 * \brief	Forget results that read the item at an address
+		 *			Called when a single item is renamed, retyped or patched
+		 */
+		void invalidateDependents(uint64_t ea);
+
+		/*!
+		 * \brief	Forget translated instructions that cover a patched byte
+		 */
+		void invalidateCode(uint64_t ea);
+
+		/*!
+		 * \brief	Rebuild the import index on next use
+		 *			Called when names or segments are changed
+		 */
+		void invalidateImports();
+
+		/*!
+		 * \brief	Rebuild the segment index on next use
+		 *			Called when segments are changed
+		 */
+		void invalidateSegments();
+
+		/*!
+		 * \brief	Compute again names of an address
+		 *			Called when the address is renamed
+		 */
+		void invalidateName(uint64_t ea);
+
+		/*!
+		 * \brief	Compute again all names
+		 *			Called when segments, and so imports, are changed
+		 */
+		void invalidateNames();
+
+		/*!
+		 * \brief	Translate again a type on the next decompilation
+		 *			and all typedefs of it
+		 *			Results that used one of them are forgotten
+		 *			Called when a local type is changed
+		 * \param	name	name of the type
+		 */
+		void invalidateType(const std::string& name);
+
+		/*!
+		 * \brief	Translate again all types on the next decompilation
+		 *			Called when the changed type is unknown
+		 */
+		void invalidateTypes();
+
+		/*!
+		 * \brief	Copy again patched bytes into the snapshot
+		 *			or forget the cached pages holding them
+		 * \param	ea		address of the first byte
+		 * \param	size	number of bytes
+		 */
+		void updateImage(uint64_t ea, size_t size);
+
+		/*!
+		 * \brief	Capture again all segments into the snapshot
+		 *			or forget all cached pages
+		 *			Called when segments are changed
 		 */
-		void view(const std::string& name, const Decompiler::Result& code) const;
+		void reloadImage();
 	};
 }
 
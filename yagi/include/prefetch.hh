@@ -0,0 +1,105 @@
+#ifndef __YAGI_PREFETCH__
+#define __YAGI_PREFETCH__
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_set>
+
+#include "decompiler.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Functions to decompile in idle time
+	 *			Users usually jump into a callee of the function
+	 *			they are reading, so callees are decompiled into
+	 *			the result cache before being asked for
+	 */
+	class Prefetcher
+	{
+	public:
+		/*!
+		 * \brief	Is a memory address the start of a function
+		 */
+		using Filter = std::function<bool(uint64_t)>;
+
+	protected:
+		/*!
+		 * \brief	number of functions scheduled after each decompilation
+		 */
+		size_t m_limit;
+
+		/*!
+		 * \brief	functions waiting for a decompilation
+		 */
+		std::deque<uint64_t> m_pending;
+
+		/*!
+		 * \brief	functions already decompiled or pending
+		 */
+		std::unordered_set<uint64_t> m_seen;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	limit	number of functions scheduled after each decompilation
+		 *					0 disable the prefetch
+		 */
+		explicit Prefetcher(size_t limit);
+
+		/*!
+		 * \brief	Replace pending functions by callees of a result
+		 *			Callees are taken in the order of their first use in the code
+		 * \param	result		last decompiled function
+		 * \param	isFunction	keep only addresses of functions
+		 */
+		void schedule(const Decompiler::Result& result, const Filter& isFunction);
+
+		/*!
+		 * \brief	Add a function after the pending ones
+		 *			Ignored if it was already seen, the limit only applies to schedule
+		 * \param	ea	address of the function
+		 * \return	true if the function was added
+		 */
+		bool push(uint64_t ea);
+
+		/*!
+		 * \brief	Next function to decompile
+		 * \return	nullopt if nothing is pending
+		 */
+		std::optional<uint64_t> next();
+
+		/*!
+		 * \brief	Is a function waiting for a decompilation
+		 */
+		bool empty() const noexcept;
+
+		/*!
+		 * \brief	Number of functions waiting for a decompilation
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	Drop pending functions
+		 *			They can be scheduled again later
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Forget a function taken by next but not decompiled
+		 *			Use when its job is canceled, it can be scheduled again later
+		 * \param	ea	address of the function
+		 */
+		void forget(uint64_t ea);
+
+		/*!
+		 * \brief	Forget seen functions
+		 *			Use when the result cache is cleared
+		 */
+		void reset();
+	};
+}
+
+#endif
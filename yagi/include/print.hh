@@ -4,8 +4,72 @@
 #include <printc.hh>
 #include "decompiler.hh"
 
+#include <map>
+
 namespace yagi 
 {
+	/*!
+	 * \brief	Symbols of a function and how to find them from a printed token
+	 *			Variables are indexed by their Ghidra symbol, so two locals
+	 *			with the same name in different scopes stay distinct
+	 */
+	class SymbolIndex
+	{
+	public:
+		/*!
+		 * \brief	id of a token without symbol
+		 */
+		static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+	protected:
+		/*!
+		 * \brief	flat list of symbols, ids are index into it
+		 */
+		std::vector<Decompiler::Symbol> m_symbols;
+
+		/*!
+		 * \brief	id of high level variables
+		 */
+		std::map<const Symbol*, uint32_t> m_variables;
+
+		/*!
+		 * \brief	id of functions and constants by printed name
+		 *			also the first variable of each name
+		 */
+		std::map<std::string, uint32_t> m_names;
+
+	public:
+		/*!
+		 * \brief	Add a high level variable
+		 *			Ignored if the variable is already indexed
+		 */
+		void addVariable(const Symbol* symbol, MemoryLocation location);
+
+		/*!
+		 * \brief	Add a symbol found by its printed name
+		 *			Ignored if a symbol already use this name
+		 */
+		void addNamed(const std::string& name, MemoryLocation location);
+
+		/*!
+		 * \brief	Is this variable already indexed
+		 */
+		bool hasVariable(const Symbol* symbol) const;
+
+		/*!
+		 * \brief	Find the symbol of a printed token
+		 * \param	name	printed name
+		 * \param	vn		varnode of the token if any
+		 * \return	NO_SYMBOL if the token is not a symbol
+		 */
+		uint32_t find(const std::string& name, const Varnode* vn) const;
+
+		/*!
+		 * \brief	Give back all symbols
+		 *			The index is empty afterwards
+		 */
+		std::vector<Decompiler::Symbol> release();
+	};
 
 	/*!
 	 * \brief	Use to declare the local print capability
@@ -52,10 +116,30 @@ namespace yagi
 	protected:
 		friend class EmitColorGuard;
 
+		/*!
+		 * \brief	symbols of the printed function, may be null
+		 */
+		const SymbolIndex* m_index = nullptr;
+
+		/*!
+		 * \brief	symbol, kind and highlight of each color tag in emission order
+		 *			positions are set by indexTokens
+		 */
+		std::vector<Decompiler::Token> m_tags;
+
+		/*!
+		 * \brief	Symbol id of a token
+		 */
+		uint32_t findSymbol(const std::string& name, const Varnode* vn) const;
+
 		/*!
 		 * \brief	start a color tag for each kind of token
+		 * \param	c		color of the tag
+		 * \param	kind	kind of the wrapped token
+		 * \param	hl		highlight class of the wrapped token
+		 * \param	symbol	symbol id of the wrapped token
 		 */
-		virtual void startColorTag(char c);
+		virtual void startColorTag(char c, Decompiler::TokenKind kind, syntax_highlight hl, uint32_t symbol);
 
 		/*!
 		 * \brief	end of color tag
@@ -124,6 +208,24 @@ namespace yagi
 		 */
 		void tagLabel(const char* ptr, syntax_highlight hl, const AddrSpace* spc, uintb off) override;
 
+		/*!
+		 * \brief	tag a comment or a warning
+		 * \param	ptr	text of the comment
+		 * \param	hl	color highlight
+		 * \param	spc	space of the commented address
+		 * \param	off	commented address
+		 */
+		void tagComment(const char* ptr, syntax_highlight hl, const AddrSpace* spc, uintb off) override;
+
+		/*!
+		 * \brief	tag the value of a switch case
+		 * \param	ptr	printed value
+		 * \param	hl	color highlight
+		 * \param	op	the switch
+		 * \param	value	value of the case
+		 */
+		void tagCaseLabel(const char* ptr, syntax_highlight hl, const PcodeOp* op, uintb value) override;
+
 		/*!
 		 * \print	When any print is done, emitter will call print function
 		 * \param	str	string to print
@@ -140,10 +242,17 @@ namespace yagi
 		void tagType(const char* ptr, syntax_highlight hl, const Datatype* ct) override;
 
 		/*!
-		 * \brief	Return the symbol database
-		 * \return	the associated map between the token name and it's associated address
+		 * \brief	Set the symbols of the next printed function
+		 *			Reset the recorded tags
+		 * \param	index	symbols, must outlive the printing, or null
+		 */
+		void setSymbolIndex(const SymbolIndex* index);
+
+		/*!
+		 * \brief	Symbol, kind and highlight of each emitted color tag
+		 *			Use with indexTokens once the output is flushed
 		 */
-		const std::map<std::string, MemoryLocation>& getSymbolAddr() const;
+		const std::vector<Decompiler::Token>& getTags() const;
 	};
 
 	/*!
@@ -166,15 +275,20 @@ namespace yagi
 		 * \brief	Ctor that will emit the code
 		 * \param	emitter	emitter to control
 		 * \param	color	color to emmit
+		 * \param	kind	kind of the wrapped token
+		 * \param	hl		highlight class of the wrapped token
+		 * \param	symbol	symbol id of the wrapped token
 		 */
-		explicit EmitColorGuard(IdaEmit& emitter, char color);
+		explicit EmitColorGuard(IdaEmit& emitter, char color, Decompiler::TokenKind kind, EmitPrettyPrint::syntax_highlight hl, uint32_t symbol = SymbolIndex::NO_SYMBOL);
 
 		/*!
 		 * \brief	Ctor that will emit the code
 		 * \param	emitter	emitter to control
-		 * \param	color	color to emmit
+		 * \param	color	color to emmit, also the highlight class of the token
+		 * \param	kind	kind of the wrapped token
+		 * \param	symbol	symbol id of the wrapped token
 		 */
-		explicit EmitColorGuard(IdaEmit& emitter, EmitPrettyPrint::syntax_highlight color);
+		explicit EmitColorGuard(IdaEmit& emitter, EmitPrettyPrint::syntax_highlight color, Decompiler::TokenKind kind, uint32_t symbol = SymbolIndex::NO_SYMBOL);
 
 		/*!
 		 * \brief	destructor that will end the job
@@ -199,7 +313,43 @@ namespace yagi
 		 * \return	Token emitter
 		 */
 		const IdaEmit& getEmitter() const;
+
+		/*!
+		 * \brief	Return the token emitter
+		 * \return	Token emitter
+		 */
+		IdaEmit& getEmitter();
 	};
+
+	/*!
+	 * \brief	Remove IDA color tags emitted by IdaEmit
+	 * \param	code	colored source code
+	 * \return	plain source code
+	 */
+	std::string removeColorTags(const std::string& code);
+
+	/*!
+	 * \brief	Compute the position of tokens in a colored code
+	 * \param	code	colored source code emitted by IdaEmit
+	 * \param	tags	symbol, kind and highlight of each color tag of the code
+	 * \param	all		keep every token, not only symbols
+	 * \return	spans of tokens sorted by line and column
+	 */
+	std::vector<Decompiler::Token> indexTokens(const std::string& code, const std::vector<Decompiler::Token>& tags, bool all);
+
+	/*!
+	 * \brief	Copy the result of a function to an identical one at another address
+	 *			The name of the function and the labels into it are renamed
+	 *			and addresses into the function are moved,
+	 *			in the code, the symbols, the tokens and the dependencies
+	 * \param	result	result of the decompiled function
+	 * \param	from	address of the decompiled function
+	 * \param	size	size of the decompiled function
+	 * \param	to		address of the identical function
+	 * \param	name	name of the identical function
+	 * \return	result of the identical function
+	 */
+	Decompiler::Result rebaseResult(const Decompiler::Result& result, uint64_t from, uint64_t size, uint64_t to, const std::string& name);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,397 @@
+#ifndef __YAGI_PROFILE__
+#define __YAGI_PROFILE__
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Timings and counters of a single decompilation
+	 *			Filled by the thread that run the decompilation,
+	 *			through the current profile of the thread
+	 */
+	class Profile
+	{
+	public:
+		/*!
+		 * \brief	Accumulated time of a named step
+		 */
+		struct Timing
+		{
+			uint64_t calls = 0;
+			double milliseconds = 0;
+		};
+
+		/*!
+		 * \brief	Counters reported by Ghidra for an action or a rule
+		 */
+		struct Statistic
+		{
+			uint64_t tested = 0;
+			uint64_t applied = 0;
+		};
+
+		/*!
+		 * \brief	Number of heap allocations made by the process
+		 */
+		using AllocationCounter = size_t(*)();
+
+	protected:
+		/*!
+		 * \brief	address of the profiled function
+		 */
+		uint64_t m_ea;
+
+		/*!
+		 * \brief	name of the function, set once known
+		 */
+		std::string m_name;
+
+		/*!
+		 * \brief	start of the profile
+		 */
+		std::chrono::steady_clock::time_point m_start;
+
+		/*!
+		 * \brief	duration of the whole profile, set by close
+		 */
+		std::optional<double> m_milliseconds;
+
+		/*!
+		 * \brief	allocation count at start, if a counter is installed
+		 */
+		std::optional<size_t> m_allocationStart;
+
+		/*!
+		 * \brief	allocations made during the profile, set by close
+		 */
+		std::optional<size_t> m_allocations;
+
+		/*!
+		 * \brief	resident memory at start and highest sample, see sampleMemory
+		 */
+		std::optional<size_t> m_memoryStart;
+		std::optional<size_t> m_memoryPeak;
+
+		/*!
+		 * \brief	sizes of the analyzed function by name (ops, varnodes...)
+		 */
+		std::map<std::string, uint64_t> m_counters;
+
+		/*!
+		 * \brief	step timings by category then name
+		 */
+		std::map<std::string, std::map<std::string, Timing>> m_timings;
+
+		/*!
+		 * \brief	Ghidra counters by action or rule name
+		 */
+		std::map<std::string, Statistic> m_statistics;
+
+		/*!
+		 * \brief	action running since the last mark
+		 */
+		std::optional<std::pair<std::string, std::chrono::steady_clock::time_point>> m_mark;
+
+	public:
+		/*!
+		 * \brief	category of top level actions timed by marks
+		 */
+		static const std::string ACTIONS;
+
+		/*!
+		 * \brief	category of requests answered by IDA
+		 */
+		static const std::string BACKEND;
+
+		/*!
+		 * \brief	counters of the size of the analyzed function
+		 */
+		static const std::string OPS;
+		static const std::string VARNODES;
+		static const std::string BLOCKS;
+
+		/*!
+		 * \brief	ctor, start the clock
+		 * \param	ea	address of the profiled function
+		 */
+		explicit Profile(uint64_t ea);
+
+		uint64_t getAddress() const noexcept;
+		const std::string& getName() const noexcept;
+		void setName(const std::string& name);
+
+		/*!
+		 * \brief	Account a call to a step
+		 * \param	category	kind of step (action, rule, backend...)
+		 * \param	name		name of the step
+		 * \param	milliseconds	time spent
+		 */
+		void add(const std::string& category, const std::string& name, double milliseconds);
+
+		/*!
+		 * \brief	Close the running action and start timing another one
+		 *			Actions are timed from one mark to the next one
+		 * \param	name	name of the starting action
+		 */
+		void mark(const std::string& name);
+
+		/*!
+		 * \brief	Close the running action, if any
+		 */
+		void unmark();
+
+		/*!
+		 * \brief	Read the resident memory of the process and keep the highest value
+		 *			Done at each mark and when closed
+		 */
+		void sampleMemory() noexcept;
+
+		/*!
+		 * \brief	Set a size of the analyzed function
+		 *			The highest value is kept, a function may be analyzed again
+		 */
+		void setCounter(const std::string& name, uint64_t value);
+
+		/*!
+		 * \brief	Stop the clock
+		 *			Nothing is accounted into the total after this call
+		 */
+		void close();
+
+		/*!
+		 * \brief	Read the output of Action::printStatistics
+		 *			Every line is "name Tested=N Applied=M"
+		 *			Counters of the same name are added
+		 */
+		void addStatistics(std::istream& stream);
+
+		const std::map<std::string, std::map<std::string, Timing>>& getTimings() const noexcept;
+		const std::map<std::string, Statistic>& getStatistics() const noexcept;
+		const std::map<std::string, uint64_t>& getCounters() const noexcept;
+
+		/*!
+		 * \brief	Growth of the resident memory between the start and the highest sample
+		 *			Other threads of the process are accounted too
+		 * \return	nullopt if the platform can't tell
+		 */
+		std::optional<size_t> getMemoryGrowth() const noexcept;
+
+		/*!
+		 * \brief	Total duration, nullopt until closed
+		 */
+		std::optional<double> getMilliseconds() const noexcept;
+
+		/*!
+		 * \brief	Allocations, nullopt until closed or without counter
+		 */
+		std::optional<size_t> getAllocations() const noexcept;
+
+		/*!
+		 * \brief	Write the profile as a JSON object
+		 */
+		void writeJson(std::ostream& stream) const;
+
+		/*!
+		 * \brief	Profile of the calling thread
+		 * \return	nullptr when the thread is not profiled
+		 */
+		static Profile* current() noexcept;
+
+		/*!
+		 * \brief	Count allocations of next profiles
+		 *			No counter is installed by default
+		 * \param	counter	null to stop counting
+		 */
+		static void setAllocationCounter(AllocationCounter counter) noexcept;
+
+		friend class ProfileSession;
+	};
+
+	/*!
+	 * \brief	Make a profile current for the calling thread
+	 *			The previous one is restored on destruction
+	 */
+	class ProfileSession
+	{
+	protected:
+		Profile* m_previous;
+
+	public:
+		explicit ProfileSession(Profile& profile) noexcept;
+		~ProfileSession();
+
+		ProfileSession(const ProfileSession&) = delete;
+		ProfileSession& operator=(const ProfileSession&) = delete;
+	};
+
+	/*!
+	 * \brief	Time a scope into the current profile
+	 *			Nothing is done when the thread is not profiled
+	 */
+	class ProfileScope
+	{
+	protected:
+		Profile* m_profile;
+		const char* m_category;
+		const char* m_name;
+		std::chrono::steady_clock::time_point m_start;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	category	kind of step, must outlive the scope
+		 * \param	name		name of the step, must outlive the scope
+		 */
+		ProfileScope(const char* category, const char* name) noexcept;
+		ProfileScope(const char* category, const std::string& name) noexcept;
+		~ProfileScope();
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	};
+
+	/*!
+	 * \brief	Destination of profiles
+	 */
+	class ProfileOutput
+	{
+	public:
+		virtual ~ProfileOutput() = default;
+
+		/*!
+		 * \brief	Export a closed profile
+		 *			May be called concurrently by batch workers
+		 */
+		virtual void write(const Profile& profile) = 0;
+	};
+
+	/*!
+	 * \brief	Write one JSON report per function into a directory
+	 *			A report is overwritten by the next profile of the function
+	 */
+	class DirectoryProfileOutput : public ProfileOutput
+	{
+	protected:
+		std::filesystem::path m_directory;
+		std::mutex m_mutex;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			The directory is created if needed
+		 * \param	directory	output directory
+		 */
+		explicit DirectoryProfileOutput(const std::filesystem::path& directory);
+
+		const std::filesystem::path& getDirectory() const noexcept;
+
+		/*!
+		 * \raise	UnableToOpenOutput
+		 */
+		void write(const Profile& profile) override;
+	};
+
+	/*!
+	 * \brief	Keep one line of figures per profiled function
+	 *			to compare functions between them (sorted table, CSV)
+	 */
+	class SummaryProfileOutput : public ProfileOutput
+	{
+	public:
+		/*!
+		 * \brief	Figures of a function
+		 */
+		struct Row
+		{
+			uint64_t ea = 0;
+			std::string name;
+			double milliseconds = 0;
+
+			/*!
+			 * \brief	growth of the resident memory, in bytes
+			 */
+			size_t memory = 0;
+
+			uint64_t ops = 0;
+			uint64_t varnodes = 0;
+			uint64_t blocks = 0;
+
+			/*!
+			 * \brief	sum of Applied counters of Ghidra actions and rules
+			 */
+			uint64_t applied = 0;
+
+			/*!
+			 * \brief	number of requests answered by IDA
+			 */
+			uint64_t backend = 0;
+		};
+
+		/*!
+		 * \brief	Sort key of rows
+		 */
+		enum class Column
+		{
+			Address,
+			Name,
+			Time,
+			Memory,
+			Ops,
+			Varnodes,
+			Blocks,
+			Applied,
+			Backend
+		};
+
+	protected:
+		/*!
+		 * \brief	next destination of profiles, may be null
+		 */
+		std::shared_ptr<ProfileOutput> m_next;
+
+		/*!
+		 * \brief	rows by address, the last profile of a function wins
+		 */
+		std::map<uint64_t, Row> m_rows;
+		mutable std::mutex m_mutex;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	next	profiles are also written there, may be null
+		 */
+		explicit SummaryProfileOutput(std::shared_ptr<ProfileOutput> next = nullptr);
+
+		/*!
+		 * \brief	Figures of a closed profile
+		 */
+		static Row summarize(const Profile& profile);
+
+		void write(const Profile& profile) override;
+
+		/*!
+		 * \brief	Rows sorted by a column
+		 *			Address and name are ascending, figures descending
+		 */
+		std::vector<Row> getRows(Column column) const;
+
+		/*!
+		 * \brief	Write rows as CSV with a header line
+		 * \param	column	sort key
+		 */
+		void writeCsv(std::ostream& stream, Column column) const;
+	};
+}
+
+#endif
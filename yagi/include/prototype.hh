@@ -0,0 +1,234 @@
+#ifndef __YAGI_PROTOTYPE__
+#define __YAGI_PROTOTYPE__
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "typeinfo.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	A type recovered by the decompiler
+	 *			Independent of the architecture that produced it
+	 *			so it can be shared between decompilers
+	 *			Names are C names understood by the backend
+	 */
+	class RecoveredTypeInfo : public TypeInfo
+	{
+	public:
+		/*!
+		 * \brief	Properties of the type, see TypeInfo
+		 */
+		enum Flags : uint32_t
+		{
+			INT = 1 << 0,
+			BOOL = 1 << 1,
+			FLOAT = 1 << 2,
+			VOID = 1 << 3,
+			CONST = 1 << 4,
+			CHAR = 1 << 5,
+			UNICODE = 1 << 6
+		};
+
+	protected:
+		std::string m_name;
+		size_t m_size;
+		uint32_t m_flags;
+
+		/*!
+		 * \brief	pointed type, null if it's not a pointer
+		 */
+		std::shared_ptr<const RecoveredTypeInfo> m_pointed;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	name	C name of the type
+		 * \param	size	size in bytes
+		 * \param	flags	see Flags
+		 * \param	pointed	pointed type for a pointer
+		 */
+		RecoveredTypeInfo(std::string name, size_t size, uint32_t flags, std::shared_ptr<const RecoveredTypeInfo> pointed = nullptr);
+
+		size_t getSize() const override;
+		std::string getName() const override;
+		bool isInt() const override;
+		bool isBool() const override;
+		bool isFloat() const override;
+		bool isVoid() const override;
+		bool isConst() const override;
+		bool isChar() const override;
+		bool isUnicode() const override;
+		std::optional<std::unique_ptr<FuncInfo>> toFunc() const override;
+		std::optional<std::unique_ptr<StructInfo>> toStruct() const override;
+		std::optional<std::unique_ptr<PtrInfo>> toPtr() const override;
+		std::optional<std::unique_ptr<ArrayInfo>> toArray() const override;
+	};
+
+	/*!
+	 * \brief	Pointer part of a recovered type
+	 */
+	class RecoveredPtrInfo : public PtrInfo
+	{
+	protected:
+		std::shared_ptr<const RecoveredTypeInfo> m_pointed;
+
+	public:
+		explicit RecoveredPtrInfo(std::shared_ptr<const RecoveredTypeInfo> pointed);
+
+		std::unique_ptr<TypeInfo> getPointedObject() const override;
+	};
+
+	/*!
+	 * \brief	Prototype of a function recovered by the decompiler
+	 */
+	struct Prototype
+	{
+		/*!
+		 * \brief	name of the function
+		 */
+		std::string name;
+
+		/*!
+		 * \brief	nullopt if the calling convention is unknown
+		 */
+		std::optional<std::string> callingConv;
+
+		bool dotDotDot = false;
+
+		/*!
+		 * \brief	return type followed by parameter types
+		 */
+		std::vector<RecoveredTypeInfo> types;
+
+		/*!
+		 * \brief	return name followed by parameter names
+		 */
+		std::vector<std::string> names;
+
+		/*!
+		 * \brief	C declaration of the function
+		 *			ret cc name(type name, ...)
+		 */
+		std::string toDeclaration() const;
+	};
+
+	/*!
+	 * \brief	Function type of a recovered prototype
+	 */
+	class PrototypeTypeInfo : public TypeInfo
+	{
+	protected:
+		std::shared_ptr<const Prototype> m_prototype;
+
+	public:
+		explicit PrototypeTypeInfo(std::shared_ptr<const Prototype> prototype);
+
+		size_t getSize() const override;
+
+		/*!
+		 * \brief	the declaration, function types have no name
+		 */
+		std::string getName() const override;
+		bool isInt() const override;
+		bool isBool() const override;
+		bool isFloat() const override;
+		bool isVoid() const override;
+		bool isConst() const override;
+		bool isChar() const override;
+		bool isUnicode() const override;
+		std::optional<std::unique_ptr<FuncInfo>> toFunc() const override;
+		std::optional<std::unique_ptr<StructInfo>> toStruct() const override;
+		std::optional<std::unique_ptr<PtrInfo>> toPtr() const override;
+		std::optional<std::unique_ptr<ArrayInfo>> toArray() const override;
+	};
+
+	/*!
+	 * \brief	Function part of a recovered prototype
+	 */
+	class PrototypeFuncInfo : public FuncInfo
+	{
+	protected:
+		std::shared_ptr<const Prototype> m_prototype;
+
+	public:
+		explicit PrototypeFuncInfo(std::shared_ptr<const Prototype> prototype);
+
+		bool isDotDotDot() const override;
+		std::vector<std::unique_ptr<TypeInfo>> getFuncPrototype() const override;
+		std::vector<std::string> getFuncParamName() const override;
+
+		/*!
+		 * \raise	UnknownCallingConvention
+		 */
+		std::string getCallingConv() const override;
+		std::string getName() const override;
+	};
+
+	/*!
+	 * \brief	Prototypes recovered by previous decompilations
+	 *			Shared by the decompilers of a batch
+	 *			Safe to use from several threads
+	 */
+	class PrototypeStore
+	{
+	protected:
+		mutable std::shared_mutex m_mutex;
+
+		/*!
+		 * \brief	prototype by function address
+		 */
+		std::unordered_map<uint64_t, std::shared_ptr<const Prototype>> m_prototypes;
+
+	public:
+		/*!
+		 * \brief	Add or replace the prototype of a function
+		 * \param	ea			address of the function
+		 * \param	prototype	recovered prototype
+		 */
+		void add(uint64_t ea, std::shared_ptr<const Prototype> prototype);
+
+		/*!
+		 * \brief	Prototype of a function
+		 * \return	null if it was never recovered
+		 */
+		std::shared_ptr<const Prototype> find(uint64_t ea) const;
+
+		/*!
+		 * \brief	Number of prototypes
+		 */
+		size_t size() const;
+	};
+
+	/*!
+	 * \brief	Type of functions taken from a prototype store
+	 *			other types are built by the inner factory
+	 */
+	class PrototypeTypeInfoFactory : public TypeInfoFactory
+	{
+	protected:
+		std::unique_ptr<TypeInfoFactory> m_inner;
+		std::shared_ptr<const PrototypeStore> m_store;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	inner	factory of backend types
+		 * \param	store	recovered prototypes
+		 */
+		PrototypeTypeInfoFactory(std::unique_ptr<TypeInfoFactory> inner, std::shared_ptr<const PrototypeStore> store);
+
+		std::optional<std::unique_ptr<TypeInfo>> build(const std::string& name) override;
+		std::optional<std::unique_ptr<TypeInfo>> build(uint64_t ea) override;
+		void invalidate(const std::string& name) override;
+		void invalidateAll() override;
+	};
+}
+
+#endif
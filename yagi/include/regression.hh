@@ -0,0 +1,161 @@
+#ifndef __YAGI_REGRESSION__
+#define __YAGI_REGRESSION__
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Outcome of a batch over a corpus of exports
+	 *			Saved by a build and compared with the run of another one
+	 */
+	struct RegressionRun
+	{
+		/*!
+		 * \brief	Outcome of a function
+		 */
+		struct Entry
+		{
+			std::string name;
+			bool decompiled = false;
+
+			/*!
+			 * \brief	hash of the C output without color tags
+			 */
+			uint64_t hash = 0;
+
+			/*!
+			 * \brief	decompilation time in milliseconds
+			 */
+			double duration = 0;
+		};
+
+		/*!
+		 * \brief	name of the export and address of the function
+		 */
+		using Key = std::pair<std::string, uint64_t>;
+
+		std::map<Key, Entry> entries;
+
+		/*!
+		 * \brief	Write the run as CSV
+		 *			export,address,status,hash,milliseconds,name
+		 * \raise	UnableToOpenOutput
+		 */
+		void save(const std::filesystem::path& path) const;
+
+		/*!
+		 * \brief	Read a run written by save
+		 * \raise	InvalidRegressionRun
+		 */
+		static RegressionRun load(const std::filesystem::path& path);
+	};
+
+	/*!
+	 * \brief	Record results of a batch into a run
+	 *			and forward them to another output if any
+	 */
+	class RegressionBatchOutput : public BatchOutput
+	{
+	protected:
+		RegressionRun& m_run;
+
+		/*!
+		 * \brief	name of the decompiled export
+		 */
+		std::string m_source;
+
+		/*!
+		 * \brief	forwarded output, may be null
+		 */
+		BatchOutput* m_next;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	run		destination run
+		 * \param	source	name of the decompiled export
+		 * \param	next	output also receiving results, may be null
+		 */
+		RegressionBatchOutput(RegressionRun& run, std::string source, BatchOutput* next);
+
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override;
+	};
+
+	/*!
+	 * \brief	Differences between a baseline run and a new one
+	 */
+	struct RegressionDiff
+	{
+		/*!
+		 * \brief	Latency change of a function
+		 */
+		struct Latency
+		{
+			RegressionRun::Key key;
+			double baseline;
+			double current;
+		};
+
+		/*!
+		 * \brief	decompiled by both runs with a different output
+		 */
+		std::vector<RegressionRun::Key> changed;
+
+		/*!
+		 * \brief	decompiled only by the baseline
+		 */
+		std::vector<RegressionRun::Key> broken;
+
+		/*!
+		 * \brief	decompiled only by the new run
+		 */
+		std::vector<RegressionRun::Key> fixed;
+
+		/*!
+		 * \brief	functions missing from one of the runs
+		 */
+		std::vector<RegressionRun::Key> added;
+		std::vector<RegressionRun::Key> removed;
+
+		/*!
+		 * \brief	functions decompiled by both runs, slowest regressions first
+		 */
+		std::vector<Latency> latencies;
+
+		/*!
+		 * \brief	total time of functions decompiled by both runs
+		 */
+		double baselineDuration = 0;
+		double currentDuration = 0;
+
+		/*!
+		 * \brief	Compare two runs
+		 * \param	baseline	reference run
+		 * \param	current		new run
+		 */
+		static RegressionDiff compare(const RegressionRun& baseline, const RegressionRun& current);
+
+		/*!
+		 * \brief	Is the output of any function different
+		 */
+		bool hasOutputChanges() const noexcept;
+
+		/*!
+		 * \brief	Print a summary of the differences
+		 * \param	stream	destination
+		 * \param	top		number of latency changes printed in each direction
+		 */
+		void print(std::ostream& stream, size_t top) const;
+	};
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef __YAGI_REMOTE__
+#define __YAGI_REMOTE__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "decompiler.hh"
+#include "logger.hh"
+#include "service.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Decompiler running into the decompiler service
+	 *			The service decompiles from an export of the database
+	 *			written again before the next request once the database changed
+	 *			A hang or a crash of the service only fails the request
+	 */
+	class RemoteDecompiler : public Decompiler
+	{
+	public:
+		/*!
+		 * \brief	Write an export of the database
+		 * \param	path	destination file
+		 * \return	false if the export can't be written
+		 */
+		using Snapshot = std::function<bool(const std::string& path)>;
+
+		/*!
+		 * \brief	Content hash of a function, see FunctionSymbolInfo::getContentHash
+		 *			Local names and types are saved without database event
+		 */
+		using ContentHash = std::function<uint64_t(uint64_t ea)>;
+
+	protected:
+		/*!
+		 * \brief	port of the service
+		 */
+		uint16_t m_port;
+
+		/*!
+		 * \brief	exports are written to this path with a generation suffix
+		 *			also identifies this client to the service
+		 */
+		std::string m_base;
+
+		Snapshot m_snapshot;
+
+		ContentHash m_hash;
+
+		/*!
+		 * \brief	content hash of each requested function at its last request
+		 *			a new hash means the export is out of date
+		 */
+		std::unordered_map<uint64_t, uint64_t> m_hashes;
+
+		/*!
+		 * \brief	time allowed to a decompilation by the service in milliseconds
+		 *			0 means unlimited
+		 */
+		uint32_t m_timeout;
+
+		std::unique_ptr<Logger> m_logger;
+
+		/*!
+		 * \brief	kept open between requests, reconnected when lost
+		 */
+		LocalSocket m_socket;
+
+		/*!
+		 * \brief	last written export, empty before the first request
+		 */
+		std::string m_source;
+
+		uint64_t m_generation = 0;
+
+		/*!
+		 * \brief	the database changed since the last export
+		 */
+		std::atomic<bool> m_dirty{ true };
+
+		std::shared_ptr<const CancelToken> m_cancel;
+
+		/*!
+		 * \brief	Write a new export if the database changed
+		 * \return	false if the export failed
+		 */
+		bool updateSource();
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	port		port of the service
+		 * \param	base		base path of exports
+		 * \param	snapshot	write an export of the database
+		 * \param	hash		content hash of a function
+		 * \param	timeout		time allowed to a decompilation in milliseconds
+		 * \param	logger		report failures of the service
+		 */
+		explicit RemoteDecompiler(uint16_t port, std::string base, Snapshot snapshot, ContentHash hash, uint32_t timeout, std::unique_ptr<Logger> logger);
+
+		/*!
+		 * \brief	destructor, remove the last export
+		 */
+		virtual ~RemoteDecompiler();
+
+		std::optional<Result> decompile(uint64_t funcAddress) override;
+
+		/*!
+		 * \brief	Analyses are not kept across requests, same as decompile
+		 */
+		std::optional<Result> refreshNames(uint64_t funcAddress) override;
+
+		/*!
+		 * \brief	Any change make the next request use a new export
+		 */
+		void invalidate(uint64_t funcAddress) override;
+		void invalidateDependents(uint64_t ea) override;
+		void invalidateCode(uint64_t ea) override;
+		void clearCache() override;
+		void invalidateType(const std::string& name) override;
+		void invalidateTypes() override;
+
+		void retain(uint64_t funcAddress) override;
+		void release(uint64_t funcAddress) override;
+
+		/*!
+		 * \brief	Stop waiting for the service once canceled
+		 */
+		void setCancelToken(std::shared_ptr<const CancelToken> token) override;
+
+		/*!
+		 * \brief	Profiles are written by the service, see its profile_dir option
+		 */
+		void setProfileOutput(std::shared_ptr<ProfileOutput> output) override;
+
+		/*!
+		 * \brief	Decompilers of the service are warmed by their first requests
+		 */
+		size_t prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names) override;
+	};
+}
+
+#endif
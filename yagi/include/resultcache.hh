@@ -0,0 +1,217 @@
+#ifndef __YAGI_RESULTCACHE__
+#define __YAGI_RESULTCACHE__
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compactresult.hh"
+#include "decompiler.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Persistent backend for decompilation results
+	 *			Use to keep results when the database is reopened
+	 */
+	class ResultStore
+	{
+	public:
+		virtual ~ResultStore() = default;
+
+		/*!
+		 * \brief	Load a previously saved result
+		 * \param	ea		address of the function
+		 * \param	hash	expected content hash of the function
+		 * \return	the result if it exists and was produced from the same content
+		 */
+		virtual std::optional<Decompiler::Result> load(uint64_t ea, uint64_t hash) = 0;
+
+		/*!
+		 * \brief	Save a result
+		 * \param	hash	content hash of the function
+		 * \param	result	decompilation result
+		 */
+		virtual void save(uint64_t hash, const Decompiler::Result& result) = 0;
+
+		/*!
+		 * \brief	Remove the saved result of a function
+		 * \param	ea	address of the function
+		 */
+		virtual void remove(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Remove saved results that read the item at an address
+		 *			and the saved result of the function at this address
+		 * \param	ea	address of the changed item
+		 */
+		virtual void removeDependents(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Remove saved results that used a type
+		 * \param	name	name of the changed type
+		 */
+		virtual void removeType(const std::string& name) = 0;
+
+		/*!
+		 * \brief	Remove all saved results
+		 */
+		virtual void clear() = 0;
+	};
+
+	/*!
+	 * \brief	Cache of decompilation results
+	 *			Keyed by function address and validated by a content hash
+	 *			Least recently used results are evicted first
+	 *			Results are kept packed, see CompactResult
+	 */
+	class ResultCache
+	{
+	protected:
+		/*!
+		 * \brief	a cached result with the hash of the content it came from
+		 */
+		struct Entry
+		{
+			uint64_t hash;
+			CompactResult result;
+		};
+
+		/*!
+		 * \brief	max number of results kept in memory
+		 */
+		size_t m_capacity;
+
+		/*!
+		 * \brief	cached results, the most recently used first
+		 */
+		std::list<Entry> m_entries;
+
+		/*!
+		 * \brief	index of entries by function address
+		 */
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+
+		/*!
+		 * \brief	optional persistent backend
+		 */
+		std::unique_ptr<ResultStore> m_store;
+
+		/*!
+		 * \brief	Insert a result in memory only
+		 *			and evict the least recently used entries
+		 */
+		void emplace(uint64_t hash, const Decompiler::Result& result);
+
+		/*!
+		 * \brief	Forget every result in memory matching a predicate
+		 */
+		void invalidateIf(const std::function<bool(const CompactResult&)>& predicate);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	capacity	max number of results kept in memory
+		 * \param	store		optional persistent backend (may be null)
+		 */
+		explicit ResultCache(size_t capacity, std::unique_ptr<ResultStore> store);
+
+		/*!
+		 *	\brief	Copy is forbidden due to unique ptr
+		 */
+		ResultCache(const ResultCache&) = delete;
+		ResultCache& operator=(const ResultCache&) = delete;
+
+		/*!
+		 *	\brief	moving is allowed
+		 */
+		ResultCache(ResultCache&&) noexcept = default;
+		ResultCache& operator=(ResultCache&&) noexcept = default;
+
+		/*!
+		 * \brief	Find a result for a function
+		 *			Fallback on the persistent store if not in memory
+		 * \param	ea		address of the function
+		 * \param	hash	current content hash of the function
+		 * \return	the cached result if it was computed from the same content
+		 */
+		std::optional<Decompiler::Result> find(uint64_t ea, uint64_t hash);
+
+		/*!
+		 * \brief	Insert or replace the result of a function
+		 * \param	hash	content hash of the function
+		 * \param	result	the decompilation result
+		 */
+		void insert(uint64_t hash, const Decompiler::Result& result);
+
+		/*!
+		 * \brief	Forget the result of a function
+		 * \param	ea	address of the function
+		 */
+		void invalidate(uint64_t ea);
+
+		/*!
+		 * \brief	Forget results that read the item at an address
+		 *			and the result of the function at this address
+		 *			Persistent results are removed through their saved dependencies
+		 * \param	ea	address of the changed item
+		 */
+		void invalidateDependents(uint64_t ea);
+
+		/*!
+		 * \brief	Forget results that used a type, see invalidateDependents
+		 * \param	name	name of the changed type
+		 */
+		void invalidateType(const std::string& name);
+
+		/*!
+		 * \brief	Forget all results, including persistent ones
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Number of results in memory
+		 */
+		size_t size() const noexcept;
+
+		/*!
+		 * \brief	Is there any place to keep results
+		 *			Use to avoid computing content hash for nothing
+		 */
+		bool isEnabled() const noexcept;
+	};
+
+	/*!
+	 * \brief	Serialize a result into a binary buffer
+	 * \param	hash	content hash of the function
+	 * \param	result	the decompilation result
+	 * \return	buffer usable by deserializeResult
+	 */
+	std::vector<uint8_t> serializeResult(uint64_t hash, const Decompiler::Result& result);
+
+	/*!
+	 * \brief	Parse a buffer created by serializeResult
+	 * \param	buffer	serialized result
+	 * \param	hash	expected content hash
+	 * \return	the result if the buffer is valid and the hash match
+	 */
+	std::optional<Decompiler::Result> deserializeResult(const std::vector<uint8_t>& buffer, uint64_t hash);
+
+	/*!
+	 * \brief	Serialize the dependencies of a result
+	 *			Use to index saved results without reading them
+	 */
+	std::vector<uint8_t> serializeDependencies(const Decompiler::Dependencies& dependencies);
+
+	/*!
+	 * \brief	Parse a buffer created by serializeDependencies
+	 * \return	nullopt if the buffer is malformed
+	 */
+	std::optional<Decompiler::Dependencies> deserializeDependencies(const std::vector<uint8_t>& buffer);
+}
+
+#endif
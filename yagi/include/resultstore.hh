@@ -0,0 +1,148 @@
+#ifndef __YAGI_RESULTSTORE__
+#define __YAGI_RESULTSTORE__
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "resultcache.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Raw storage of compressed results, see PackedResultStore
+	 *			One blob per function and an index of their content hash
+	 */
+	class ResultBlobs
+	{
+	public:
+		/*!
+		 * \brief	Blob of a function
+		 */
+		struct Entry
+		{
+			uint64_t ea;
+
+			/*!
+			 * \brief	content hash of the function
+			 */
+			uint64_t hash;
+
+			/*!
+			 * \brief	compressed result, empty to remove the function
+			 */
+			std::vector<uint8_t> data;
+
+			/*!
+			 * \brief	items read by the result, kept with the index
+			 */
+			Decompiler::Dependencies dependencies;
+		};
+
+		/*!
+		 * \brief	Index of a stored function
+		 */
+		struct IndexEntry
+		{
+			uint64_t hash;
+			Decompiler::Dependencies dependencies;
+		};
+
+		virtual ~ResultBlobs() = default;
+
+		/*!
+		 * \brief	Content hash and dependencies of every stored function
+		 *			Blobs are not read
+		 */
+		virtual std::unordered_map<uint64_t, IndexEntry> readIndex() = 0;
+
+		/*!
+		 * \brief	Read the blob of a function
+		 * \return	nullopt if none is stored
+		 */
+		virtual std::optional<std::vector<uint8_t>> read(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Write or remove blobs and their index entries at once
+		 */
+		virtual void write(const std::vector<Entry>& entries) = 0;
+
+		/*!
+		 * \brief	Remove all blobs
+		 */
+		virtual void clear() = 0;
+	};
+
+	/*!
+	 * \brief	Result store keeping compressed results into blobs
+	 *			The index is read on first use, a result is only read
+	 *			when its hash match, and writes are sent by batches
+	 *			Dependencies in the index remove results without reading them
+	 *			Compression runs on the calling thread
+	 */
+	class PackedResultStore : public ResultStore
+	{
+	protected:
+		std::unique_ptr<ResultBlobs> m_blobs;
+
+		/*!
+		 * \brief	number of pending writes sent together
+		 */
+		size_t m_batch;
+
+		/*!
+		 * \brief	content hash and dependencies of stored and pending results
+		 *			nullopt until read
+		 */
+		std::optional<std::unordered_map<uint64_t, ResultBlobs::IndexEntry>> m_index;
+
+		/*!
+		 * \brief	writes and removals not sent yet, by function
+		 */
+		std::map<uint64_t, ResultBlobs::Entry> m_pending;
+
+		/*!
+		 * \brief	Read the index on first use
+		 */
+		std::unordered_map<uint64_t, ResultBlobs::IndexEntry>& getIndex();
+
+		/*!
+		 * \brief	Remove stored results whose index entry match a predicate
+		 */
+		void removeIf(const std::function<bool(uint64_t, const ResultBlobs::IndexEntry&)>& predicate);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	blobs	destination of results
+		 * \param	batch	number of writes sent together
+		 */
+		explicit PackedResultStore(std::unique_ptr<ResultBlobs> blobs, size_t batch);
+
+		/*!
+		 * \brief	destructor, send pending writes
+		 */
+		virtual ~PackedResultStore();
+
+		std::optional<Decompiler::Result> load(uint64_t ea, uint64_t hash) override;
+		void save(uint64_t hash, const Decompiler::Result& result) override;
+
+		/*!
+		 * \brief	Functions never stored cost nothing
+		 */
+		void remove(uint64_t ea) override;
+		void removeDependents(uint64_t ea) override;
+		void removeType(const std::string& name) override;
+		void clear() override;
+
+		/*!
+		 * \brief	Send pending writes
+		 */
+		void flush();
+	};
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef __YAGI_RINGLOGGER__
+#define __YAGI_RINGLOGGER__
+
+#include "logger.hh"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Logger that keep the last messages in memory
+	 *			and forward at most a number of messages per second
+	 *			to an inner logger
+	 */
+	class RingLogger : public Logger
+	{
+	protected:
+		/*!
+		 * \brief	destination of forwarded messages, may be null
+		 */
+		std::unique_ptr<Logger> m_inner;
+
+		/*!
+		 * \brief	last messages, m_next is the oldest one when full
+		 */
+		std::vector<std::string> m_messages;
+		size_t m_capacity;
+		size_t m_next = 0;
+
+		/*!
+		 * \brief	maximum number of forwarded messages per second
+		 *			0 means unlimited
+		 */
+		size_t m_rate;
+
+		/*!
+		 * \brief	state of the current rate window
+		 */
+		std::chrono::steady_clock::time_point m_windowStart;
+		size_t m_forwarded = 0;
+		size_t m_suppressed = 0;
+
+		mutable std::mutex m_mutex;
+
+		/*!
+		 * \brief	Store the message and forward it if possible
+		 */
+		void print(const std::string& message) override;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			The level of the inner logger is kept
+		 * \param	inner		forwarded messages destination, may be null
+		 * \param	capacity	number of messages kept in memory
+		 * \param	rate		maximum forwarded messages per second, 0 for unlimited
+		 */
+		explicit RingLogger(std::unique_ptr<Logger> inner, size_t capacity, size_t rate);
+
+		/*!
+		 *	\brief	Copy is forbidden due to unique ptr
+		 */
+		RingLogger(const RingLogger&) = delete;
+		RingLogger& operator=(const RingLogger&) = delete;
+
+		/*!
+		 * \brief	Last messages kept in memory
+		 * \return	messages from the oldest to the newest
+		 */
+		std::vector<std::string> recent() const;
+	};
+}
+
+#endif
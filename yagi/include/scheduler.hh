@@ -0,0 +1,154 @@
+#ifndef __YAGI_SCHEDULER__
+#define __YAGI_SCHEDULER__
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Order the jobs sharing the interactive decompiler
+	 *			User requests preempt any other job, prefetches run before
+	 *			other background jobs, and background jobs only run
+	 *			while their share of the decompiler time stays under a cap
+	 *			Queues stay with their owner, the scheduler decides and measures
+	 */
+	class JobScheduler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/*!
+		 * \brief	Priority classes, the lowest value is the most urgent
+		 */
+		enum class Priority : size_t
+		{
+			Interactive = 0,	// requested by the user or a script
+			Prefetch = 1,		// callees and callers of the last result
+			Background = 2,		// any other idle work (types prewarm)
+		};
+
+		static const size_t PRIORITY_COUNT = 3;
+
+		/*!
+		 * \brief	Activity of a priority class
+		 */
+		struct Stats
+		{
+			/*!
+			 * \brief	jobs waiting, reported by their queue
+			 */
+			size_t pending = 0;
+
+			/*!
+			 * \brief	jobs run to their end
+			 */
+			size_t done = 0;
+
+			/*!
+			 * \brief	jobs canceled for a more urgent one
+			 */
+			size_t preempted = 0;
+
+			/*!
+			 * \brief	sum and maximum of the time from submission to end
+			 *			of done jobs, in milliseconds
+			 */
+			double totalLatency = 0;
+			double maxLatency = 0;
+
+			/*!
+			 * \brief	mean latency of done jobs in milliseconds
+			 */
+			double getLatency() const noexcept;
+		};
+
+	protected:
+		/*!
+		 * \brief	maximum share of the time used by background jobs, in ]0, 1]
+		 */
+		double m_share;
+
+		std::array<Stats, PRIORITY_COUNT> m_stats;
+
+		/*!
+		 * \brief	class of the running job, nullopt when idle
+		 */
+		std::optional<Priority> m_running;
+
+		Clock::time_point m_submitted;
+		Clock::time_point m_started;
+
+		/*!
+		 * \brief	the running job was canceled for a more urgent one
+		 */
+		bool m_preempted = false;
+
+		/*!
+		 * \brief	background jobs are not started before
+		 */
+		Clock::time_point m_resume;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	backgroundShare	maximum share of the time used by background jobs
+		 *							1 never delays them
+		 */
+		explicit JobScheduler(double backgroundShare);
+
+		/*!
+		 * \brief	Can a job of this class start now
+		 *			User requests always can, background jobs wait for their share
+		 */
+		bool mayStart(Priority priority, Clock::time_point now) const noexcept;
+
+		/*!
+		 * \brief	Time left before background jobs can start
+		 */
+		std::chrono::milliseconds getDelay(Clock::time_point now) const noexcept;
+
+		/*!
+		 * \brief	A job started
+		 * \param	priority	class of the job
+		 * \param	submitted	time of the request of the job
+		 * \param	now			start time
+		 */
+		void start(Priority priority, Clock::time_point submitted, Clock::time_point now);
+
+		/*!
+		 * \brief	A job of this class is submitted while a job is running
+		 *			the last user request replaces the previous one
+		 * \return	true if the running job must be canceled
+		 */
+		bool preempt(Priority priority) noexcept;
+
+		/*!
+		 * \brief	The running job ended, done or canceled
+		 *			A background job delays the next one in proportion of its run time
+		 */
+		void end(Clock::time_point now);
+
+		/*!
+		 * \brief	Class of the running job, nullopt when idle
+		 */
+		std::optional<Priority> getRunning() const noexcept;
+
+		/*!
+		 * \brief	Number of jobs waiting into the queue of a class
+		 */
+		void setPending(Priority priority, size_t count) noexcept;
+
+		const Stats& getStats(Priority priority) const noexcept;
+
+		/*!
+		 * \brief	Queue depth and latency of each class, on a single line
+		 */
+		std::string getSummary() const;
+	};
+}
+
+#endif
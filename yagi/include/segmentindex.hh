@@ -0,0 +1,88 @@
+#ifndef __YAGI_SEGMENTINDEX__
+#define __YAGI_SEGMENTINDEX__
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Sorted intervals of segments
+	 *			Use to answer read only queries with a binary search
+	 */
+	class SegmentIndex
+	{
+	public:
+		/*!
+		 * \brief	Segment permissions, same bits as IDA
+		 */
+		enum Perm : uint32_t
+		{
+			PERM_EXEC = 1,
+			PERM_WRITE = 2,
+			PERM_READ = 4
+		};
+
+		/*!
+		 * \brief	Segment names assumed read only when nothing is configured
+		 */
+		static const std::unordered_set<std::string> DEFAULT_READ_ONLY;
+
+	protected:
+		struct Interval
+		{
+			uint64_t start;
+			uint64_t end;
+			bool readOnly;
+		};
+
+		/*!
+		 * \brief	segments sorted by start address
+		 */
+		std::vector<Interval> m_intervals;
+
+		/*!
+		 * \brief	names of segments considered read only whatever their permissions
+		 *			data of these segments is propagated as constant by the decompiler
+		 */
+		std::unordered_set<std::string> m_readOnlyNames;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	readOnlyNames	segments considered read only for the analysis
+		 */
+		explicit SegmentIndex(std::unordered_set<std::string> readOnlyNames = DEFAULT_READ_ONLY);
+
+		/*!
+		 * \brief	Add a segment, segments must not overlap
+		 * \param	start	first address
+		 * \param	end		address after the last one
+		 * \param	name	name of the segment
+		 * \param	perm	see Perm
+		 */
+		void add(uint64_t start, uint64_t end, const std::string& name, uint32_t perm);
+
+		/*!
+		 * \brief	Remove all segments, the policy is kept
+		 */
+		void clear();
+
+		/*!
+		 * \brief	Is this address into a read only segment
+		 *			Segments are read only when they are readable
+		 *			and not writable, or when their name is configured so
+		 * \return	false outside of segments
+		 */
+		bool isReadOnly(uint64_t ea) const noexcept;
+
+		/*!
+		 * \brief	Number of segments
+		 */
+		size_t size() const noexcept;
+	};
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef __YAGI_SERVICE__
+#define __YAGI_SERVICE__
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Messages exchanged with the decompiler service
+	 *			Every message is a little endian length followed by its payload
+	 */
+	namespace service
+	{
+		/*!
+		 * \brief	Port used when none is configured
+		 */
+		static const uint16_t DEFAULT_PORT = 47913;
+
+		/*!
+		 * \brief	Messages above this size are rejected
+		 */
+		static const uint32_t MAX_MESSAGE_SIZE = 0x10000000;
+
+		struct Request
+		{
+			/*!
+			 * \brief	identifies the client, one pool of decompilers per client
+			 */
+			std::string client;
+
+			/*!
+			 * \brief	path of the export to decompile from
+			 *			a new path replaces the decompilers of the client
+			 */
+			std::string source;
+
+			/*!
+			 * \brief	address of the function
+			 */
+			uint64_t ea;
+
+			/*!
+			 * \brief	time allowed to the decompilation in milliseconds, 0 means unlimited
+			 */
+			uint32_t timeout;
+		};
+
+		enum class Status : uint32_t
+		{
+			Ok = 0,			// result is set
+			NotFound,		// the decompiler has no result for this function
+			Error			// message is set
+		};
+
+		struct Response
+		{
+			Status status;
+
+			/*!
+			 * \brief	result serialized by serializeResult
+			 */
+			std::vector<uint8_t> result;
+
+			std::string message;
+		};
+
+		std::vector<uint8_t> encode(const Request& request);
+		bool decode(const std::vector<uint8_t>& buffer, Request& request);
+		std::vector<uint8_t> encode(const Response& response);
+		bool decode(const std::vector<uint8_t>& buffer, Response& response);
+	}
+
+	/*!
+	 * \brief	Connection over the loopback interface
+	 *			Only accept local peers, messages are length prefixed
+	 */
+	class LocalSocket
+	{
+		friend class LocalServer;
+
+	protected:
+		/*!
+		 * \brief	native handle, -1 if not connected
+		 */
+		intptr_t m_handle;
+
+	public:
+		/*!
+		 * \brief	How a receive ended
+		 */
+		enum class Receive
+		{
+			Ok,
+			Closed,		// peer disconnected or malformed message
+			Timeout,
+			Canceled
+		};
+
+		/*!
+		 * \brief	Polled while waiting for a message, true to stop waiting
+		 */
+		using CancelCheck = std::function<bool()>;
+
+		explicit LocalSocket(intptr_t handle = -1);
+		~LocalSocket();
+
+		/*!
+		 * \brief	Copy is forbidden, the socket is owned
+		 */
+		LocalSocket(const LocalSocket&) = delete;
+		LocalSocket& operator=(const LocalSocket&) = delete;
+
+		LocalSocket(LocalSocket&& other) noexcept;
+		LocalSocket& operator=(LocalSocket&& other) noexcept;
+
+		/*!
+		 * \brief	Connect to a local server
+		 * \param	port	port of the server
+		 * \return	an invalid socket if nobody listen
+		 */
+		static LocalSocket connect(uint16_t port);
+
+		bool isValid() const noexcept;
+
+		/*!
+		 * \brief	Send a whole message
+		 * \return	false if the connection is lost
+		 */
+		bool send(const std::vector<uint8_t>& message);
+
+		/*!
+		 * \brief	Wait for a whole message
+		 * \param	message		received payload [out]
+		 * \param	timeout		time allowed, 0 means unlimited
+		 * \param	canceled	polled while waiting, may be empty
+		 */
+		Receive receive(std::vector<uint8_t>& message, std::chrono::milliseconds timeout, const CancelCheck& canceled = CancelCheck());
+
+		/*!
+		 * \brief	Close the connection
+		 */
+		void close();
+	};
+
+	/*!
+	 * \brief	Listening socket bound to the loopback interface
+	 */
+	class LocalServer
+	{
+	protected:
+		LocalSocket m_socket;
+		uint16_t m_port = 0;
+
+	public:
+		/*!
+		 * \brief	Start listening
+		 * \param	port	0 to let the system choose
+		 * \return	false if the port is already used
+		 */
+		bool listen(uint16_t port);
+
+		/*!
+		 * \brief	port really used, see listen
+		 */
+		uint16_t getPort() const noexcept;
+
+		/*!
+		 * \brief	Wait for a client
+		 * \param	timeout	time allowed
+		 * \return	an invalid socket on timeout
+		 */
+		LocalSocket accept(std::chrono::milliseconds timeout);
+	};
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef __YAGI_SERVICEHOST__
+#define __YAGI_SERVICEHOST__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "decompiler.hh"
+#include "service.hh"
+
+namespace yagi
+{
+	/*!
+	 * \brief	Serve decompilations to several IDA instances
+	 *			Each client has a pool of warm decompilers built from its export,
+	 *			requests of a client are dispatched on its pool in parallel
+	 */
+	class ServiceHost
+	{
+	public:
+		/*!
+		 * \brief	Build a decompiler of an export
+		 * \return	null if the export can't be loaded
+		 */
+		using Factory = std::function<std::unique_ptr<Decompiler>(const std::string& source)>;
+
+	protected:
+		/*!
+		 * \brief	Decompilers of a client
+		 *			Dropped when the client send a new export
+		 */
+		struct Pool
+		{
+			std::string source;
+			std::vector<std::unique_ptr<Decompiler>> idle;
+			size_t built = 0;
+		};
+
+		Factory m_factory;
+
+		/*!
+		 * \brief	maximum number of decompilers per client
+		 */
+		size_t m_workers;
+
+		std::mutex m_mutex;
+		std::condition_variable m_released;
+
+		/*!
+		 * \brief	current pool of each client
+		 */
+		std::map<std::string, std::shared_ptr<Pool>> m_pools;
+
+		/*!
+		 * \brief	Take an idle decompiler of the client, build it if needed
+		 * \return	null if the export can't be loaded
+		 */
+		std::unique_ptr<Decompiler> acquire(const service::Request& request, std::shared_ptr<Pool>& pool);
+
+		/*!
+		 * \brief	Give back a decompiler, dropped if the pool is replaced
+		 */
+		void release(std::shared_ptr<Pool> pool, std::unique_ptr<Decompiler> decompiler);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	factory		build decompilers
+		 * \param	workers		decompilers per client, at least one
+		 */
+		explicit ServiceHost(Factory factory, size_t workers);
+
+		/*!
+		 * \brief	Decompile a function for a client
+		 *			Thread safe, called by each connection
+		 */
+		service::Response handle(const service::Request& request);
+
+		/*!
+		 * \brief	Accept clients until stopped
+		 *			Each connection is served by its own thread
+		 * \param	server	listening socket
+		 * \param	stop	checked between accepts
+		 */
+		void serve(LocalServer& server, const std::atomic<bool>& stop);
+
+		/*!
+		 * \brief	Number of clients with a pool
+		 */
+		size_t getClientCount();
+	};
+}
+
+#endif
@@ -4,12 +4,15 @@
 #include <optional>
 #include <tuple>
 #include <string>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "decompiler.hh"
+#include "typeinfo.hh"
 
 namespace yagi 
 {
-	class TypeInfo;
 	class SymbolInfo
 	{
 	protected:
@@ -116,6 +119,106 @@ namespace yagi
 		virtual bool isReadOnly() const noexcept = 0;
 	};
 
+	/*!
+	 * \brief	Properties of a symbol captured once, held by value
+	 *			Read by the scope of the decompiler without virtual call,
+	 *			and cached without a heap object per symbol
+	 */
+	struct SymbolRecord
+	{
+		uint64_t ea;
+
+		/*!
+		 * \brief	name as returned by SymbolInfo::getName
+		 */
+		std::string name;
+
+		bool isFunction;
+		bool isLabel;
+		bool isImport;
+		bool isReadOnly;
+
+		/*!
+		 * \brief	ctor, query every property of the symbol
+		 */
+		explicit SymbolRecord(const SymbolInfo& symbol);
+
+		/*!
+		 * \brief	Same guess as SymbolInfo::getType
+		 */
+		SymbolInfo::Type getType() const noexcept;
+	};
+
+	/*!
+	 * \brief	User defined name of a local variable
+	 */
+	struct NameOverride
+	{
+		/*!
+		 * \brief	name of memory space
+		 */
+		std::string space;
+
+		/*!
+		 * \brief	offset in memory space
+		 */
+		uint64_t offset;
+
+		/*!
+		 * \brief	new name of the variable
+		 */
+		std::string name;
+	};
+
+	/*!
+	 * \brief	User defined type of a local variable
+	 */
+	struct TypeOverride
+	{
+		/*!
+		 * \brief	name of memory space
+		 */
+		std::string space;
+
+		/*!
+		 * \brief	offset in memory space
+		 */
+		uint64_t offset;
+
+		/*!
+		 * \brief	new type of the variable
+		 */
+		std::unique_ptr<TypeInfo> type;
+	};
+
+	/*!
+	 * \brief	All user defined names and types of a function
+	 *			indexed by the pcode address where they are used
+	 */
+	struct LocalOverrides
+	{
+		std::unordered_multimap<uint64_t, NameOverride> names;
+		std::unordered_multimap<uint64_t, TypeOverride> types;
+	};
+
+	/*!
+	 * \brief	Control flow already recovered by the backend
+	 *			Use to seed the flow analysis of the decompiler
+	 */
+	struct FlowHints
+	{
+		/*!
+		 * \brief	[start, end) ranges of the function body and its tail chunks
+		 */
+		std::vector<std::pair<uint64_t, uint64_t>> chunks;
+
+		/*!
+		 * \brief	targets of resolved jump tables indexed by case value
+		 *			indexed by the address of the indirect jump
+		 */
+		std::map<uint64_t, std::map<int64_t, uint64_t>> jumpTables;
+	};
+
 	class FunctionSymbolInfo
 	{
 	protected:
@@ -201,6 +304,44 @@ namespace yagi
 		 * \return	if found the offset into memory space and the linked type
 		 */
 		virtual std::optional<std::unique_ptr<TypeInfo>> findType(uint64_t pc, const std::string& from, uint64_t& offset) = 0;
+
+		/*!
+		 * \brief	Load every stored name and type of the function at once
+		 *			Use by actions to avoid a lookup per pcode and per space
+		 * \return	overrides indexed by use address
+		 */
+		virtual LocalOverrides findLocalOverrides() = 0;
+
+		/*!
+		 * \brief	Chunks and jump tables of the function known by the backend
+		 *			Use to skip the recovery of jump tables by the decompiler
+		 * \return	empty hints if the backend has no flow information
+		 */
+		virtual FlowHints findFlowHints() = 0;
+
+		/*!
+		 * \brief	Compute a hash of everything the backend knows about this function
+		 *			(bytes, prototype, stored names and types)
+		 *			Use to know if a cached decompilation is still valid
+		 * \return	the content hash of the function
+		 */
+		virtual uint64_t getContentHash() = 0;
+
+		/*!
+		 * \brief	Compute a hash of the function that doesn't depend on its address
+		 *			(bytes with references masked, names of referenced items, prototype)
+		 *			Functions with the same clone hash decompile to the same output
+		 *			except for their own name and addresses
+		 *			Use by batches to decompile identical functions once
+		 * \return	0 if the function must not be deduplicated
+		 */
+		virtual uint64_t getCloneHash() = 0;
+
+		/*!
+		 * \brief	The function was recognized as part of a known library
+		 *			(FLIRT signature for IDA)
+		 */
+		virtual bool isLibrary() = 0;
 	};
 
 	/*!
@@ -225,6 +366,24 @@ namespace yagi
 		 * \param	ea	any address that is handle by a function
 		 */
 		virtual std::optional<std::unique_ptr<FunctionSymbolInfo>> find_function(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Properties of any symbol at a particular address
+		 *			Backends override it to not build a symbol object,
+		 *			the default implementation copies the result of find
+		 * \param	ea	the address of the symbol
+		 * \return	nullopt if there is no symbol at this address
+		 */
+		virtual std::optional<SymbolRecord> find_record(uint64_t ea);
+
+		/*!
+		 * \brief	Find the address of some symbols by name, at once
+		 *			Leading underscores are not significant,
+		 *			IDA removes them from shown names
+		 * \param	names	names of symbols
+		 * \return	address of each name found into database
+		 */
+		virtual std::unordered_map<std::string, uint64_t> find_addresses(const std::vector<std::string>& names) = 0;
 	};
 }
 
@@ -0,0 +1,498 @@
+#ifndef __YAGI_SYNC__
+#define __YAGI_SYNC__
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include "symbolinfo.hh"
+#include "typeinfo.hh"
+#include "logger.hh"
+#include "loader.hh"
+#include "resultstore.hh"
+
+#include <libdecomp.hh>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Queue of requests executed by a single owner thread
+	 *			IDA API can only be called from the main thread,
+	 *			worker threads use this queue to delegate their calls
+	 */
+	class RequestQueue
+	{
+	protected:
+		/*!
+		 * \brief	A pending call and its completion state
+		 */
+		struct Request
+		{
+			std::function<void()> task;
+			std::exception_ptr error;
+			bool done = false;
+		};
+
+		/*!
+		 * \brief	thread allowed to process requests
+		 */
+		std::thread::id m_owner;
+
+		/*!
+		 * \brief	protect every other members
+		 */
+		std::mutex m_mutex;
+
+		/*!
+		 * \brief	signaled when a request is pushed or the owner is woken up
+		 */
+		std::condition_variable m_pending;
+
+		/*!
+		 * \brief	signaled when a request is done
+		 */
+		std::condition_variable m_completed;
+
+		/*!
+		 * \brief	requests waiting for the owner thread
+		 */
+		std::deque<std::shared_ptr<Request>> m_requests;
+
+		/*!
+		 * \brief	true when the owner must stop waiting
+		 */
+		bool m_woken;
+
+		/*!
+		 * \brief	push a request and notify the owner
+		 */
+		void push(std::shared_ptr<Request> request);
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			The calling thread become the owner of the queue
+		 */
+		explicit RequestQueue();
+
+		/*!
+		 * \brief	copy is forbidden, requests keep a reference on the queue
+		 */
+		RequestQueue(const RequestQueue&) = delete;
+		RequestQueue& operator=(const RequestQueue&) = delete;
+
+		/*!
+		 * \brief	move is forbidden, requests keep a reference on the queue
+		 */
+		RequestQueue(RequestQueue&&) noexcept = delete;
+		RequestQueue& operator=(RequestQueue&&) noexcept = delete;
+
+		/*!
+		 * \brief	Is the current thread the owner of the queue
+		 */
+		bool isOwner() const noexcept;
+
+		/*!
+		 * \brief	Execute a task on the owner thread and wait for its completion
+		 *			Executed directly if called from the owner thread
+		 *			Any exception raised by the task is forwarded to the caller
+		 * \param	task	task to execute
+		 * \warning	the owner must call process until the task is done
+		 */
+		void execute(const std::function<void()>& task);
+
+		/*!
+		 * \brief	Execute a task on the owner thread and return its result
+		 * \param	task	task to execute
+		 * \return	value returned by the task
+		 */
+		template<typename F>
+		std::invoke_result_t<F> call(F&& task)
+		{
+			std::optional<std::invoke_result_t<F>> result;
+			execute([&]() { result.emplace(task()); });
+			return std::move(result.value());
+		}
+
+		/*!
+		 * \brief	Push a task without waiting for its completion
+		 *			Exceptions raised by the task are dropped
+		 * \param	task	task to execute
+		 */
+		void post(std::function<void()> task);
+
+		/*!
+		 * \brief	Execute pending requests
+		 *			Must be called from the owner thread
+		 * \param	timeout	max time to wait for the first request
+		 * \return	number of executed requests
+		 */
+		size_t process(std::chrono::milliseconds timeout);
+
+		/*!
+		 * \brief	Wake up the owner if it's waiting for requests
+		 */
+		void wake();
+	};
+
+	/*!
+	 * \brief	Loader that read bytes through the owner thread of a queue
+	 */
+	class SyncLoader : public LoadImage
+	{
+	protected:
+		/*!
+		 * \brief	queue use to reach the owner thread
+		 */
+		RequestQueue& m_queue;
+
+		/*!
+		 * \brief	loader only usable from the owner thread
+		 */
+		std::unique_ptr<LoadImage> m_inner;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 * \param	queue	queue use to reach the owner thread
+		 * \param	inner	loader to protect
+		 */
+		explicit SyncLoader(RequestQueue& queue, std::unique_ptr<LoadImage> inner);
+
+		/*!
+		 * \brief	The inner loader is destroyed on the owner thread
+		 */
+		virtual ~SyncLoader();
+
+		/*!
+		 * \brief	Copy is forbidden due to unique ptr
+		 */
+		SyncLoader(const SyncLoader&) = delete;
+		SyncLoader& operator=(const SyncLoader&) = delete;
+
+		/*!
+		 * \brief	Return the arch type of the inner loader
+		 */
+		std::string getArchType(void) const override;
+
+		/*!
+		 * \brief	Load data using the inner loader on the owner thread
+		 * \param	ptr		buffer pointer
+		 * \param	size	size of expected data
+		 * \param	addr	address of the payload
+		 */
+		void loadFill(uint1* ptr, int4 size, const Address& addr) override;
+
+		/*!
+		 * \brief	Adjust VMA of the inner loader
+		 */
+		void adjustVma(long adjust) override;
+	};
+
+	/*!
+	 * \brief	Loader factory that build the loader on the owner thread
+	 */
+	class SyncLoaderFactory : public LoaderFactory
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<LoaderFactory> m_inner;
+
+	public:
+		explicit SyncLoaderFactory(RequestQueue& queue, std::unique_ptr<LoaderFactory> inner);
+		virtual ~SyncLoaderFactory();
+
+		/*!
+		 * \brief	build a SyncLoader around the inner loader
+		 */
+		LoadImage* build() override;
+	};
+
+	/*!
+	 * \brief	Logger that print messages from the owner thread
+	 *			Messages are posted, the worker never wait for the print
+	 */
+	class SyncLogger : public Logger
+	{
+	protected:
+		RequestQueue& m_queue;
+
+		/*!
+		 * \brief	shared with pending messages
+		 */
+		std::shared_ptr<Logger> m_inner;
+
+		/*!
+		 * \brief	post the message to the owner thread
+		 */
+		void print(const std::string& message) override;
+
+	public:
+		explicit SyncLogger(RequestQueue& queue, std::unique_ptr<Logger> inner);
+		virtual ~SyncLogger();
+	};
+
+	/*!
+	 * \brief	Symbol captured on the owner thread
+	 *			Symbols are read only, so every property is computed once
+	 */
+	class SyncSymbolInfo : public SymbolInfo
+	{
+	protected:
+		std::optional<uint64_t> m_functionSize;
+		bool m_isFunction;
+		bool m_isLabel;
+		bool m_isImport;
+		bool m_isReadOnly;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			Must be called from the owner thread
+		 * \param	symbol	source symbol
+		 */
+		explicit SyncSymbolInfo(const SymbolInfo& symbol);
+
+		uint64_t getFunctionSize() const override;
+		bool isFunction() const noexcept override;
+		bool isLabel() const noexcept override;
+		bool isImport() const noexcept override;
+		bool isReadOnly() const noexcept override;
+	};
+
+	/*!
+	 * \brief	Function symbol that delegates every access to the owner thread
+	 */
+	class SyncFunctionSymbolInfo : public FunctionSymbolInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<FunctionSymbolInfo> m_inner;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			Must be called from the owner thread
+		 * \param	queue	queue use to reach the owner thread
+		 * \param	inner	function symbol to protect
+		 */
+		explicit SyncFunctionSymbolInfo(RequestQueue& queue, std::unique_ptr<FunctionSymbolInfo> inner);
+
+		/*!
+		 * \brief	The inner symbol is destroyed on the owner thread
+		 */
+		virtual ~SyncFunctionSymbolInfo();
+
+		std::optional<std::string> findStackVar(uint64_t offset, uint32_t addrSize) override;
+		std::optional<std::string> findName(uint64_t pc, const std::string& space, uint64_t& offset) override;
+		void saveName(const MemoryLocation& loc, const std::string& name) override;
+		void saveType(const MemoryLocation& loc, const TypeInfo& newType) override;
+		bool clearType(const MemoryLocation& loc) override;
+		std::optional<std::unique_ptr<TypeInfo>> findType(uint64_t pc, const std::string& from, uint64_t& offset) override;
+		LocalOverrides findLocalOverrides() override;
+		FlowHints findFlowHints() override;
+		uint64_t getContentHash() override;
+		uint64_t getCloneHash() override;
+		bool isLibrary() override;
+	};
+
+	/*!
+	 * \brief	Symbol factory that run the inner factory on the owner thread
+	 */
+	class SyncSymbolInfoFactory : public SymbolInfoFactory
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<SymbolInfoFactory> m_inner;
+
+	public:
+		explicit SyncSymbolInfoFactory(RequestQueue& queue, std::unique_ptr<SymbolInfoFactory> inner);
+		virtual ~SyncSymbolInfoFactory();
+
+		std::optional<std::unique_ptr<SymbolInfo>> find(uint64_t ea) override;
+		std::optional<std::unique_ptr<FunctionSymbolInfo>> find_function(uint64_t ea) override;
+
+		/*!
+		 * \brief	The record is copied from the owner thread, no SyncSymbolInfo is built
+		 */
+		std::optional<SymbolRecord> find_record(uint64_t ea) override;
+		std::unordered_map<std::string, uint64_t> find_addresses(const std::vector<std::string>& names) override;
+	};
+
+	/*!
+	 * \brief	Type whose scalar properties are captured on the owner thread
+	 *			Composite access (function, struct, etc...) is delegated
+	 */
+	class SyncTypeInfo : public TypeInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<TypeInfo> m_inner;
+
+		size_t m_size;
+		std::string m_name;
+		bool m_isInt;
+		bool m_isBool;
+		bool m_isFloat;
+		bool m_isVoid;
+		bool m_isConst;
+		bool m_isChar;
+		bool m_isUnicode;
+
+	public:
+		/*!
+		 * \brief	ctor
+		 *			Must be called from the owner thread
+		 * \param	queue	queue use to reach the owner thread
+		 * \param	inner	type to protect
+		 */
+		explicit SyncTypeInfo(RequestQueue& queue, std::unique_ptr<TypeInfo> inner);
+
+		/*!
+		 * \brief	The inner type is destroyed on the owner thread
+		 */
+		virtual ~SyncTypeInfo();
+
+		/*!
+		 * \brief	Copy is forbidden due to unique ptr
+		 */
+		SyncTypeInfo(const SyncTypeInfo&) = delete;
+		SyncTypeInfo& operator=(const SyncTypeInfo&) = delete;
+
+		size_t getSize() const override;
+		std::string getName() const override;
+		bool isInt() const override;
+		bool isBool() const override;
+		bool isFloat() const override;
+		bool isVoid() const override;
+		bool isConst() const override;
+		bool isChar() const override;
+		bool isUnicode() const override;
+		std::optional<std::unique_ptr<FuncInfo>> toFunc() const override;
+		std::optional<std::unique_ptr<StructInfo>> toStruct() const override;
+		std::optional<std::unique_ptr<PtrInfo>> toPtr() const override;
+		std::optional<std::unique_ptr<ArrayInfo>> toArray() const override;
+	};
+
+	/*!
+	 * \brief	Function type delegated to the owner thread
+	 */
+	class SyncFuncInfo : public FuncInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<FuncInfo> m_inner;
+
+	public:
+		explicit SyncFuncInfo(RequestQueue& queue, std::unique_ptr<FuncInfo> inner);
+		virtual ~SyncFuncInfo();
+
+		bool isDotDotDot() const override;
+		std::vector<std::unique_ptr<TypeInfo>> getFuncPrototype() const override;
+		std::vector<std::string> getFuncParamName() const override;
+		std::string getCallingConv() const override;
+		std::string getName() const override;
+	};
+
+	/*!
+	 * \brief	Structure type delegated to the owner thread
+	 */
+	class SyncStructInfo : public StructInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<StructInfo> m_inner;
+
+	public:
+		explicit SyncStructInfo(RequestQueue& queue, std::unique_ptr<StructInfo> inner);
+		virtual ~SyncStructInfo();
+
+		std::vector<TypeStructField> getFields() const override;
+	};
+
+	/*!
+	 * \brief	Pointer type delegated to the owner thread
+	 */
+	class SyncPtrInfo : public PtrInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<PtrInfo> m_inner;
+
+	public:
+		explicit SyncPtrInfo(RequestQueue& queue, std::unique_ptr<PtrInfo> inner);
+		virtual ~SyncPtrInfo();
+
+		std::unique_ptr<TypeInfo> getPointedObject() const override;
+	};
+
+	/*!
+	 * \brief	Array type delegated to the owner thread
+	 */
+	class SyncArrayInfo : public ArrayInfo
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<ArrayInfo> m_inner;
+
+	public:
+		explicit SyncArrayInfo(RequestQueue& queue, std::unique_ptr<ArrayInfo> inner);
+		virtual ~SyncArrayInfo();
+
+		std::unique_ptr<TypeInfo> getPointedObject() const override;
+		uint64_t getSize() const override;
+	};
+
+	/*!
+	 * \brief	Type factory that run the inner factory on the owner thread
+	 */
+	class SyncTypeInfoFactory : public TypeInfoFactory
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<TypeInfoFactory> m_inner;
+
+	public:
+		explicit SyncTypeInfoFactory(RequestQueue& queue, std::unique_ptr<TypeInfoFactory> inner);
+		virtual ~SyncTypeInfoFactory();
+
+		std::optional<std::unique_ptr<TypeInfo>> build(const std::string& name) override;
+		std::optional<std::unique_ptr<TypeInfo>> build(uint64_t ea) override;
+		void invalidate(const std::string& name) override;
+		void invalidateAll() override;
+	};
+
+	/*!
+	 * \brief	Result blobs accessed through the owner thread of a queue
+	 *			Writes are posted, the caller doesn't wait for them
+	 */
+	class SyncResultBlobs : public ResultBlobs
+	{
+	protected:
+		RequestQueue& m_queue;
+		std::unique_ptr<ResultBlobs> m_inner;
+
+	public:
+		explicit SyncResultBlobs(RequestQueue& queue, std::unique_ptr<ResultBlobs> inner);
+
+		/*!
+		 * \brief	The inner blobs are destroyed on the owner thread
+		 *			after posted writes
+		 */
+		virtual ~SyncResultBlobs();
+
+		std::unordered_map<uint64_t, IndexEntry> readIndex() override;
+		std::optional<std::vector<uint8_t>> read(uint64_t ea) override;
+		void write(const std::vector<Entry>& entries) override;
+		void clear() override;
+	};
+}
+
+#endif
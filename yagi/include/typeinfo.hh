@@ -117,6 +117,8 @@ namespace yagi
 	class TypeInfo
 	{
 	public:
+		virtual ~TypeInfo() = default;
+
 		/*!
 		 * \brief	get the size of the the type in bytes 
 		 */
@@ -214,6 +216,17 @@ namespace yagi
 
 		virtual std::optional<std::unique_ptr<TypeInfo>> build(const std::string& name) = 0;
 		virtual std::optional<std::unique_ptr<TypeInfo>> build(uint64_t ea) = 0;
+
+		/*!
+		 * \brief	Forget any memoized layout of a type
+		 * \param	name	name of the changed type
+		 */
+		virtual void invalidate(const std::string& name) = 0;
+
+		/*!
+		 * \brief	Forget memoized layouts of all types
+		 */
+		virtual void invalidateAll() = 0;
 	};
 }
 
@@ -6,7 +6,7 @@
 #include <string>
 #include <optional>
 #include <map>
-#include <string>
+#include <set>
 
 #include "yagiarchitecture.hh"
 
@@ -24,14 +24,66 @@ namespace yagi
 		 */
 		YagiArchitecture* m_archi;
 
+		/*!
+		 * \brief	names of types translated since the last clear
+		 */
+		std::set<std::string> m_translated;
+
+		/*!
+		 * \brief	names of types changed in the backend since the last sync
+		 */
+		std::set<std::string> m_changed;
+
+		/*!
+		 * \brief	all types must be translated again
+		 */
+		bool m_changedAll = false;
+
+		/*!
+		 * \brief	types directly pulled by the translation of each type
+		 *			a cached type depends on them without looking them up again
+		 */
+		std::map<std::string, std::set<std::string>> m_nested;
+
+		/*!
+		 * \brief	types being translated, the innermost last
+		 */
+		std::vector<std::string> m_parsing;
+
+		/*!
+		 * \brief	read before the backend while prewarming, null otherwise
+		 */
+		TypeInfoFactory* m_source = nullptr;
+
 		/*!
 		 * \brief	find type by inner id
+		 *			Throw UnknownTypeError if the backend doesn't know the type
 		 * \param	n	name of the type
 		 * \param	id	id of the type
 		 * \return	found type
 		 */
 		Datatype* findById(const string& n, uint8 id, int4 sz) override;
 
+		/*!
+		 * \brief	find type by inner id without throwing
+		 * \param	name	name of the type
+		 * \param	id		id of the type
+		 * \return	found type or nullptr if the backend doesn't know it
+		 */
+		Datatype* tryFindById(const std::string& name, uint8 id);
+
+		/*!
+		 * \brief	Record a type used by the current decompilation
+		 *			with all the types it is built from
+		 * \param	name	name of the type
+		 */
+		void addDependency(const std::string& name);
+
+		/*!
+		 * \brief	Translation of a type, see parseTypeInfo
+		 */
+		Datatype* translate(const TypeInfo& typeInfo);
+
 	public:
 		/*!
 		 * \brief	ctor
@@ -68,6 +120,14 @@ namespace yagi
 		 */
 		Datatype* parseTypeInfo(const TypeInfo& typeInfo);
 
+		/*!
+		 * \brief	Find a type by name, from the cache or from the backend
+		 *			Use instead of findByName on internal paths
+		 * \param	name	name of the type
+		 * \return	ghidra type or nullptr if unknown
+		 */
+		Datatype* tryFindByName(const std::string& name);
+
 		/*!
 		 * \brief	Find a type from typeinformation interface
 		 * \param	typeInfo interface to find
@@ -75,10 +135,47 @@ namespace yagi
 		 */
 		Datatype* findByTypeInfo(const TypeInfo& typeInfo);
 
+		/*!
+		 * \brief	Translate types before they are used
+		 *			Nested types are also read from the source,
+		 *			the backend is only asked for those it doesn't know
+		 *			Types that can't be translated are left to the decompilation
+		 * \param	source	snapshot of the backend types
+		 * \param	names	names of types to translate
+		 * \return	number of names processed before the end or a cancel
+		 */
+		size_t prewarm(TypeInfoFactory& source, const std::vector<std::string>& names);
+
 		/*!
 		 * \brief	update function information data
 		 */
 		void update(Funcdata& func);
+
+		/*!
+		 * \brief	Mark a type as changed in the backend
+		 *			Translated types are dropped on the next sync
+		 * \param	name	name of the type
+		 */
+		void invalidate(const std::string& name);
+
+		/*!
+		 * \brief	Mark all types as changed in the backend
+		 */
+		void invalidateAll();
+
+		/*!
+		 * \brief	Will the next sync drop translated types
+		 *			Analyses kept across a sync must be released before
+		 */
+		bool isStale() const;
+
+		/*!
+		 * \brief	Drop translated types if one of them changed
+		 *			Ghidra types can't be removed one by one because
+		 *			derived types and the analysis keep pointers on them
+		 *			Must be called when no function is analyzed
+		 */
+		void sync();
 	};
 }
 
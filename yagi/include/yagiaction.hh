@@ -3,6 +3,8 @@
 
 #include "action.hh"
 
+#include <chrono>
+
 namespace yagi 
 {
 	/*!
@@ -26,18 +28,17 @@ namespace yagi
 	/*!
 	 * \brief	This action will try to synchronize name
 	 *			with an IDA netnode
+	 *			All memory spaces are handled in a single pass
 	 */
 	class ActionRenameVar : public Action
 	{
-	protected:
-		std::string m_space;
 	public:
-		ActionRenameVar(const string& g, const string& space) 
-			: Action(Action::ruleflags::rule_onceperfunc, "renamevar", g), m_space{ space }
+		ActionRenameVar(const string& g) 
+			: Action(Action::ruleflags::rule_onceperfunc, "renamevar", g)
 		{}
 		virtual Action* clone(const ActionGroupList& grouplist) const {
 			if (!grouplist.contains(getGroup())) return (Action*)0;
-			return new ActionRenameVar(getGroup(), m_space);
+			return new ActionRenameVar(getGroup());
 		}
 		/*!
 		 * \brief	Will apply the stack rename
@@ -45,18 +46,21 @@ namespace yagi
 		int4 apply(Funcdata& data) override;
 	};
 
+	/*!
+	 * \brief	This action will declare local variables
+	 *			retyped by the user
+	 *			All memory spaces are handled in a single pass
+	 */
 	class ActionLoadLocalScope : public Action
 	{
-	protected:
-		std::string m_space;
 	public:
-		ActionLoadLocalScope(const string& g, const string& space) 
-			: Action(Action::ruleflags::rule_onceperfunc, "load", g), m_space { space } 
+		ActionLoadLocalScope(const string& g) 
+			: Action(Action::ruleflags::rule_onceperfunc, "load", g)
 		{}
 
 		virtual Action* clone(const ActionGroupList& grouplist) const {
 			if (!grouplist.contains(getGroup())) return (Action*)0;
-			return new ActionSyncStackVar(getGroup());
+			return new ActionLoadLocalScope(getGroup());
 		}
 		/*!
 		 * \brief	Will apply the stack rename
@@ -81,6 +85,132 @@ namespace yagi
 		 */
 		int4 apply(Funcdata& data) override;
 	};
+
+	/*!
+	 * \brief	Run a Yagi action group as a stage of the universal action
+	 *			The group is owned by the architecture
+	 *			Time spent into the group is accumulated
+	 */
+	class ActionStage : public Action
+	{
+	protected:
+		ActionGroup& m_stage;
+		size_t m_calls = 0;
+		std::chrono::steady_clock::duration m_elapsed{};
+
+	public:
+		ActionStage(const string& name, ActionGroup& stage, const string& g)
+			: Action(Action::ruleflags::rule_onceperfunc, name, g), m_stage{ stage }
+		{}
+
+		virtual Action* clone(const ActionGroupList& grouplist) const {
+			if (!grouplist.contains(getGroup())) return (Action*)0;
+			return new ActionStage(getName(), m_stage, getGroup());
+		}
+
+		/*!
+		 * \brief	Reset the stage and its group
+		 */
+		void reset(Funcdata& data) override;
+
+		/*!
+		 * \brief	Perform the group, a cancel is checked before
+		 */
+		int4 apply(Funcdata& data) override;
+
+		/*!
+		 * \brief	Number of runs since the last resetTimings
+		 */
+		size_t getCalls() const noexcept;
+
+		/*!
+		 * \brief	Time spent since the last resetTimings
+		 */
+		double getMilliseconds() const noexcept;
+
+		/*!
+		 * \brief	Reset counters
+		 */
+		void resetTimings() noexcept;
+	};
+
+	/*!
+	 * \brief	Start timing the next action of a group into the current profile
+	 *			Do nothing when the thread is not profiled
+	 */
+	class ActionMark : public Action
+	{
+	protected:
+		/*!
+		 * \brief	name of the timed action
+		 */
+		string m_next;
+
+	public:
+		ActionMark(const string& next, const string& g)
+			: Action(0, "mark_" + next, g), m_next{ next }
+		{}
+
+		virtual Action* clone(const ActionGroupList& grouplist) const {
+			if (!grouplist.contains(getGroup())) return (Action*)0;
+			return new ActionMark(m_next, getGroup());
+		}
+
+		/*!
+		 * \brief	Close the previous mark and open this one
+		 */
+		int4 apply(Funcdata& data) override;
+
+		/*!
+		 * \brief	Marks are not reported with Ghidra statistics
+		 */
+		void printStatistics(ostream& s) const override {}
+	};
+
+	/*!
+	 * \brief	Check the number of ops once the flow is built
+	 *			A function above the limit of the architecture
+	 *			is analyzed again in large function mode
+	 */
+	class ActionCheckLimits : public Action
+	{
+	public:
+		ActionCheckLimits(const string& g)
+			: Action(Action::ruleflags::rule_onceperfunc, "checklimits", g)
+		{}
+
+		virtual Action* clone(const ActionGroupList& grouplist) const {
+			if (!grouplist.contains(getGroup())) return (Action*)0;
+			return new ActionCheckLimits(getGroup());
+		}
+
+		/*!
+		 * \brief	Raise LargeFunction above the limit
+		 */
+		int4 apply(Funcdata& data) override;
+	};
+
+	/*!
+	 * \brief	Count passes of the main simplification loop
+	 *			Applied on each pass, never count as a change
+	 */
+	class ActionCountPass : public Action
+	{
+	public:
+		ActionCountPass(const string& g)
+			: Action(0, "countpass", g)
+		{}
+
+		virtual Action* clone(const ActionGroupList& grouplist) const {
+			if (!grouplist.contains(getGroup())) return (Action*)0;
+			return new ActionCountPass(getGroup());
+		}
+
+		/*!
+		 * \brief	Raise AnalysisLimitExceeded past the limit
+		 */
+		int4 apply(Funcdata& data) override;
+	};
 }
 
 #endif
\ No newline at end of file
@@ -5,11 +5,40 @@
 #include "typeinfo.hh"
 #include "logger.hh"
 #include "loader.hh"
+#include "cancel.hh"
+#include "decompilecontext.hh"
+#include "liftcache.hh"
 
 #include <libdecomp.hh>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace yagi 
 {
+	class ActionStage;
+
+	/*!
+	 * \brief	Pointer called indirectly in place of the real target of a call
+	 *			(guard_dispatch_icall_fptr), the target is passed into a register
+	 *			see RuleCallWrapper
+	 */
+	struct CallWrapper
+	{
+		/*!
+		 * \brief	name of the symbol, see SymbolInfoFactory::find_addresses
+		 */
+		std::string name;
+
+		/*!
+		 * \brief	register holding the real target
+		 */
+		std::string reg;
+	};
+
 	/*!
 	 *	\brief	Main Ghidra core class
 	 *			Use to centralize all class associated with
@@ -17,12 +46,83 @@ namespace yagi
 	 */
 	class YagiArchitecture : public SleighArchitecture
 	{
+	public:
+		/*!
+		 * \brief	Accumulated time of a Yagi stage
+		 */
+		struct StageTiming
+		{
+			std::string name;
+			size_t calls;
+			double milliseconds;
+		};
+
+		/*!
+		 * \brief	Time spent into each part of init in milliseconds
+		 *			Spec files are parsed by a background thread
+		 *			while the loader and core types are built
+		 */
+		struct StartupTimings
+		{
+			double specFiles = 0;		// discovery of processors
+			double specParse = 0;		// parse of sla, pspec and cspec files
+			double specWait = 0;		// init waiting for the parse
+			double loader = 0;
+			double types = 0;
+			double actions = 0;
+		};
+
+		/*!
+		 * \brief	Triggers and bounds of the large function mode
+		 *			0 disables a trigger or a bound
+		 */
+		struct LargeFunctionLimits
+		{
+			uint64_t size = 0;		// bytes of the function
+			size_t ops = 0;			// p-code ops once the flow is built
+			size_t passes = 0;		// passes of the main simplification loop
+		};
+
+		/*!
+		 * \brief	Name of the universal action used in large function mode
+		 */
+		static const char* const LARGE_ACTION;
+
+		/*!
+		 * \brief	Name of the universal action used once the budget is exceeded
+		 */
+		static const char* const FALLBACK_ACTION;
+
 	protected:
 		/*!
-		 * \brief	Static object use in parent class
-		 *			Don't delete it
+		 * \brief	Translator owned by this architecture
+		 *			SleighArchitecture share one translator per language
+		 *			between all instances, which is not thread safe
+		 */
+		std::unique_ptr<Sleigh> m_translate;
+
+		/*!
+		 * \brief	Translations of instructions kept between decompilations
+		 *			read by m_translate
+		 */
+		LiftCache m_lifts;
+
+		/*!
+		 * \brief	ID given to the ctor, kept to find spec files
+		 *			before resolveArchitecture
 		 */
-		Translate* m_translate;
+		std::string m_sleighId;
+
+		/*!
+		 * \brief	Parse of spec files started by buildLoader
+		 *			resolved with the parse duration by buildSpecFile
+		 */
+		std::future<double> m_specParse;
+
+		/*!
+		 * \brief	see getStartupTimings
+		 */
+		StartupTimings m_startup;
 
 		/*!
 		 * \brief	Loader factory
@@ -57,6 +157,30 @@ namespace yagi
 		 */
 		ActionGroup m_archSpecific;
 
+		/*!
+		 * \brief	Stages running the Yagi groups inside the universal actions
+		 *			owned by the universal actions
+		 */
+		std::vector<ActionStage*> m_stages;
+
+		/*!
+		 * \brief	Insert Yagi groups as stages of the current universal action
+		 *			so a decompilation is a single uninterrupted pass
+		 */
+		void insertStages();
+
+		/*!
+		 * \brief	Insert a mark before each action of the universal action
+		 *			so top level actions are timed into the current profile
+		 */
+		void insertMarks();
+
+		/*!
+		 * \brief	Insert a pass counter into the main loop
+		 *			of the current universal action, see countPass
+		 */
+		void insertPassCounter();
+
 		/*!
 		 *	\brief	allow object that have access to the core
 		 *			to print informations message to the end user
@@ -79,6 +203,74 @@ namespace yagi
 		 */
 		std::map<std::string, std::string> m_injectionMap;
 
+		/*!
+		 * \brief	Call fixup payload id by function address
+		 *			-1 for functions without injection
+		 */
+		std::unordered_map<uint64_t, int4> m_injectionCache;
+
+		/*!
+		 * \brief	Wrappers hiding the target of calls, see addCallWrapper
+		 */
+		std::vector<CallWrapper> m_callWrappers;
+
+		/*!
+		 * \brief	Index into m_callWrappers by address of the wrapper
+		 *			nullopt until names are resolved
+		 */
+		std::optional<std::unordered_map<uint64_t, size_t>> m_callWrapperIndex;
+
+		/*!
+		 * \brief	Result of every symbol lookup made by scopes
+		 *			held by value, nullopt for addresses without symbol
+		 */
+		std::unordered_map<uint64_t, std::optional<SymbolRecord>> m_symbolCache;
+
+		/*!
+		 * \brief	Function being decompiled, shared by Yagi actions
+		 *			null before the first decompilation
+		 */
+		std::unique_ptr<DecompileContext> m_context;
+
+		/*!
+		 * \brief	Checked between analysis phases and on symbol lookups
+		 *			null when the decompilation can't be stopped
+		 */
+		std::shared_ptr<const CancelToken> m_cancel;
+
+		/*!
+		 * \brief	set by performFallbackActions or once the analysis is done,
+		 *			the budget of m_cancel is ignored until a new token is set
+		 *			or until the next analysis
+		 */
+		bool m_fallback = false;
+
+		/*!
+		 * \brief	see setDeadline, cleared once the analysis is done
+		 *			so that the printer is not stopped by the budget of m_cancel
+		 */
+		bool m_deadline = true;
+
+		/*!
+		 * \brief	see setLargeFunctionLimits
+		 */
+		LargeFunctionLimits m_largeLimits;
+
+		/*!
+		 * \brief	set by performLargeActions for the duration of the analysis
+		 */
+		bool m_large = false;
+
+		/*!
+		 * \brief	passes of the main loop done by the current large analysis
+		 */
+		size_t m_passes = 0;
+
+		/*!
+		 * \brief	see setFlowSeeding
+		 */
+		bool m_seedFlow = false;
+
 		/*!
 		 *	\brief	Factory function override to build our internal scope
 		 *			Scopes are used to reselve symbols
@@ -92,12 +284,25 @@ namespace yagi
 		 */
 		void buildLoader(DocumentStorage& store) override;
 
+		/*!
+		 *	\brief	Wait for spec files parsed by buildLoader
+		 *			and register them into the store
+		 */
+		void buildSpecFile(DocumentStorage& store) override;
+
 		/*!
 		 *	\brief	Overriden factory function
 		 *			Use to set our own type factory
+		 *			Already done by buildLoader while spec files are parsed
 		 */
 		void buildTypegrp(DocumentStorage& store) override;
 
+		/*!
+		 *	\brief	Build our type factory and its core types
+		 *			They don't depend on spec files
+		 */
+		void setupCoreTypes();
+
 		/*!
 		 * \brief build the universal action database and the custom
 		 */
@@ -105,7 +310,8 @@ namespace yagi
 
 		/*!
 		 *	\brief	Overriden factory function
-		 *			Use to get back the private static translator
+		 *			Build a translator dedicated to this architecture
+		 *			so that architectures can be used from different threads
 		 */
 		Translate* buildTranslator(DocumentStorage& store) override;
 
@@ -149,6 +355,98 @@ namespace yagi
 		 */
 		SymbolInfoFactory& getSymbolDatabase() const;
 
+		/*!
+		 *	\brief	Find a symbol through the cache of previous lookups
+		 *			Ghidra probes the same addresses many times,
+		 *			and most data addresses have no symbol
+		 *	\param	ea	address of the symbol
+		 *	\return	nullptr if there is no symbol at this address
+		 */
+		const SymbolRecord* findSymbol(uint64_t ea);
+
+		/*!
+		 *	\brief	Forget every symbol lookup, resolved injection and wrapper
+		 *			and the current context
+		 *			Use when names of the database changed
+		 */
+		void clearSymbolCache();
+
+		/*!
+		 *	\brief	Forget the lookup and the injection of a single address
+		 *			and resolved wrappers, the item may take the name of one
+		 *			Use when the item at this address is renamed or retyped
+		 *	\param	ea	address of the changed item
+		 */
+		void invalidateSymbol(uint64_t ea);
+
+		/*!
+		 * \brief	Forget translations of the instructions holding a patched byte
+		 * \param	ea	address of the byte
+		 */
+		void invalidateCode(uint64_t ea);
+
+		/*!
+		 * \brief	Forget all translations of instructions
+		 *			Use when the memory layout changed
+		 */
+		void clearLiftCache();
+
+		/*!
+		 *	\brief	Start the decompilation of a function
+		 *			Its state is kept until the next call
+		 *	\param	function	function resolved by the decompiler
+		 *	\return	context read by actions
+		 */
+		DecompileContext& setContext(std::unique_ptr<FunctionSymbolInfo> function);
+
+		/*!
+		 *	\brief	Context of the function starting at an address
+		 *			resolved through the symbol factory if it is not the current one
+		 *	\param	ea	start address of the function
+		 *	\return	nullptr if there is no function at this address
+		 */
+		DecompileContext* findContext(uint64_t ea);
+
+		/*!
+		 *	\brief	Record a dependency of the current decompilation
+		 *			Ignored outside of a decompilation
+		 *	\param	ea	address of a global, a callee, an import or a label
+		 */
+		void addDependency(uint64_t ea);
+
+		/*!
+		 *	\brief	Record a type used by the current decompilation
+		 *	\param	type	name of the type
+		 *	\return	false if the type was already recorded or outside of a decompilation
+		 */
+		bool addDependency(const std::string& type);
+
+		/*!
+		 *	\brief	Token checked by the next decompilations
+		 *	\param	token	null to never stop
+		 */
+		void setCancelToken(std::shared_ptr<const CancelToken> token);
+
+		/*!
+		 *	\brief	Stop the current decompilation if requested
+		 *	\raise	DecompilationCanceled
+		 *	\raise	DecompilationTimeout if the budget is exceeded
+		 *			and no fallback analysis is running
+		 */
+		void checkCanceled() const;
+
+		/*!
+		 *	\brief	Stop or restart the time budget of the current decompilation
+		 *			A finished analysis is printed even if the time is over,
+		 *			only a cancel stops it
+		 */
+		void setDeadline(bool enabled) noexcept;
+
+		/*!
+		 *	\brief	Was the current job canceled, without raising
+		 */
+		bool isCanceled() const noexcept;
+
 		/*!
 		 *	\brief	Access to the type factory backend
 		 *	\return	An implementation of a type info factory
@@ -175,16 +473,112 @@ namespace yagi
 
 		/*!
 		 * \brief	Injection are processed by function name
+		 *			The payload is resolved once per function
+		 * \param	ea				address of the function
 		 * \param	functionName	name of the function
-		 * \return	if exist the injection type
+		 * \return	if exist the call fixup payload id
+		 */
+		std::optional<int4> findInjection(uint64_t ea, const std::string& functionName);
+
+		/*!
+		 * \brief	Declare a wrapper hiding the target of calls
+		 * \param	wrapper	name and register of the target
 		 */
-		std::optional<std::string> findInjection(const std::string& functionName);
+		void addCallWrapper(CallWrapper wrapper);
+
+		/*!
+		 * \brief	Wrapper at an address
+		 *			Names of all wrappers are resolved at once on first use,
+		 *			then again once the symbol cache is cleared
+		 * \param	ea	address called
+		 * \return	nullptr if this address is not a wrapper
+		 */
+		const CallWrapper* findCallWrapper(uint64_t ea);
 
 		/*!
 		 * \brief apply universal action and custom action
+		 *			Timings, Ghidra counters and sizes of the function go into the current profile, if any
 		 */
 		int4 performActions(Funcdata & data);
 
+		/*!
+		 * \brief	Time spent into init, see StartupTimings
+		 */
+		const StartupTimings& getStartupTimings() const noexcept;
+
+		/*!
+		 * \brief	Time spent into each Yagi stage since the last reset
+		 */
+		std::vector<StageTiming> getStageTimings() const;
+
+		/*!
+		 * \brief	Reset counters of all stages
+		 */
+		void resetStageTimings();
+
+		/*!
+		 * \brief	apply only rename actions on an already analyzed function
+		 *			Use when only user names changed since the last analysis
+		 */
+		int4 performRenameActions(Funcdata& data);
+
+		/*!
+		 * \brief	apply the analysis without simplification rules nor type recovery
+		 *			Yagi stages still apply user names and types
+		 *			Use when the time budget of the full analysis is exceeded,
+		 *			the output is less readable but always printable
+		 *			as blocks are still structured and variables merged
+		 */
+		int4 performFallbackActions(Funcdata& data);
+
+		/*!
+		 * \brief	Set triggers and bounds of the large function mode
+		 */
+		void setLargeFunctionLimits(const LargeFunctionLimits& limits) noexcept;
+
+		/*!
+		 * \brief	A function of this size is directly analyzed in large function mode
+		 * \param	size	size of the function in bytes
+		 */
+		bool isLargeFunction(uint64_t size) const noexcept;
+
+		/*!
+		 * \brief	Called by ActionCheckLimits once the flow is built
+		 *			Nothing is checked in large function mode or in fallback
+		 * \raise	LargeFunction	too many ops for the full analysis
+		 */
+		void checkLimits(const Funcdata& data) const;
+
+		/*!
+		 * \brief	Called by ActionCountPass on each pass of the main loop
+		 * \raise	AnalysisLimitExceeded	too many passes in large function mode
+		 */
+		void countPass();
+
+		/*!
+		 * \brief	apply the universal action without expensive rule groups
+		 *			and with a bounded main loop, see LARGE_ACTION
+		 *			Use for functions whose full analysis is too slow
+		 * \raise	AnalysisLimitExceeded	the main loop is not done
+		 */
+		int4 performLargeActions(Funcdata& data);
+
+		/*!
+		 * \brief	Use jump tables resolved by the backend instead of recovering them
+		 */
+		void setFlowSeeding(bool enabled) noexcept;
+
+		/*!
+		 * \brief	Install the jump tables resolved by the backend as overrides
+		 *			of the function of the current context
+		 *			Only tables whose targets are all inside the function chunks
+		 *			and whose case values have no hole are used
+		 *			Must be called before the flow is followed
+		 * \param	data	cleared function
+		 * \return	number of installed jump tables
+		 */
+		size_t seedFlow(Funcdata& data);
+
 		/*!
 		 * \brief	Add action in the Arch specific pool
 		 * \param	action	new action
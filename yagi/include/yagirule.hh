@@ -6,25 +6,22 @@
 namespace yagi 
 {
 	/*!
-	 * \brief	Rule define to handle Control flow Guard on Windows
-	 *			Control flow guard is a security mechanism that check
-	 *			address of indirect call
+	 * \brief	Rule define to call the real target of a call wrapper
+	 *			Control flow guard on Windows calls indirect targets through
+	 *			a dispatcher, the target is passed into a register
+	 *			Wrappers are declared per architecture, see YagiArchitecture::addCallWrapper
+	 *			Direct calls to thunks (retpolines) are not rewritten,
+	 *			their call spec is bound to the thunk once the flow is built
 	 */
-	class RuleWindowsControlFlowGuard : public Rule {
-	protected:
-		/*!
-		 *	\brief	Name of the CFG wrapper name that will be patched
-		 */
-		string m_cfgWrapperName;
-
+	class RuleCallWrapper : public Rule {
 	public:
-		RuleWindowsControlFlowGuard(const string& g, const string& cfgWrapperName)
-			: Rule(g, 0, "cfg_visual"), m_cfgWrapperName{ cfgWrapperName }
+		explicit RuleCallWrapper(const string& g)
+			: Rule(g, 0, "call_wrapper")
 		{}
 
 		virtual Rule* clone(const ActionGroupList& grouplist) const {
 			if (!grouplist.contains(getGroup())) return (Rule*)0;
-			return new RuleWindowsControlFlowGuard(getGroup(), m_cfgWrapperName);
+			return new RuleCallWrapper(getGroup());
 		};
 		void getOpList(vector<uint4>& oplist) const override;
 		int4 applyOp(PcodeOp* op, Funcdata& data) override;
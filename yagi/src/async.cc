@@ -0,0 +1,240 @@
+#include "async.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	AsyncDecompiler::AsyncDecompiler(Decompiler& decompiler)
+		: m_decompiler{ decompiler }
+	{}
+
+	/**********************************************************************/
+	AsyncDecompiler::~AsyncDecompiler()
+	{
+		if (m_job.valid())
+		{
+			m_token->cancel();
+			m_job.wait();
+		}
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::apply(std::function<void(Decompiler&)> update)
+	{
+		if (isBusy())
+		{
+			m_pending.push_back(std::move(update));
+			return;
+		}
+		update(m_decompiler);
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::finish()
+	{
+		m_done = true;
+		if (m_notify)
+		{
+			m_notify();
+		}
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::setNotify(std::function<void()> notify)
+	{
+		m_notify = std::move(notify);
+	}
+
+	/**********************************************************************/
+	bool AsyncDecompiler::start(uint64_t ea, Command command, std::chrono::milliseconds budget)
+	{
+		if (isBusy())
+		{
+			return false;
+		}
+
+		m_ea = ea;
+		m_start = std::chrono::steady_clock::now();
+		m_expired = false;
+		m_done = false;
+		m_prewarm = false;
+		m_token = std::make_shared<CancelToken>(budget);
+		m_job = std::async(std::launch::async, [this, ea, command, token = m_token]() {
+			m_decompiler.setCancelToken(token);
+			std::optional<Decompiler::Result> result;
+			try
+			{
+				result = command == Command::Decompile
+					? m_decompiler.decompile(ea)
+					: m_decompiler.refreshNames(ea);
+			}
+			catch (...)
+			{
+				m_decompiler.setCancelToken(nullptr);
+				finish();
+				throw;
+			}
+			m_decompiler.setCancelToken(nullptr);
+			m_expired = token->isExpired();
+			finish();
+			return result;
+		});
+		return true;
+	}
+
+	/**********************************************************************/
+	bool AsyncDecompiler::startPrewarm(std::shared_ptr<TypeInfoFactory> source, std::vector<std::string> names)
+	{
+		if (isBusy())
+		{
+			return false;
+		}
+
+		m_ea = 0;
+		m_start = std::chrono::steady_clock::now();
+		m_expired = false;
+		m_done = false;
+		m_prewarm = true;
+		m_token = std::make_shared<CancelToken>(std::chrono::milliseconds(0));
+		m_job = std::async(std::launch::async, [this, source = std::move(source), names = std::move(names), token = m_token]() -> std::optional<Decompiler::Result> {
+			m_decompiler.setCancelToken(token);
+			try
+			{
+				m_decompiler.prewarmTypes(*source, names);
+			}
+			catch (...)
+			{
+				m_decompiler.setCancelToken(nullptr);
+				finish();
+				throw;
+			}
+			m_decompiler.setCancelToken(nullptr);
+			finish();
+			return std::nullopt;
+		});
+		return true;
+	}
+
+	/**********************************************************************/
+	bool AsyncDecompiler::isBusy() const noexcept
+	{
+		return m_job.valid();
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::cancel() noexcept
+	{
+		if (m_job.valid())
+		{
+			m_token->cancel();
+		}
+	}
+
+	/**********************************************************************/
+	std::optional<AsyncDecompiler::Outcome> AsyncDecompiler::poll()
+	{
+		// once done, the job only has to return
+		if (!m_job.valid() || (!m_done && m_job.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+		{
+			return std::nullopt;
+		}
+
+		Outcome outcome{ m_ea, Status::Failed, std::nullopt, 0.0 };
+		auto thrown = false;
+		try
+		{
+			outcome.result = m_job.get();
+		}
+		catch (...)
+		{
+			// decompilers report their own errors
+			thrown = true;
+		}
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - m_start;
+		outcome.duration = duration.count();
+
+		if (m_token->isCanceled() && !outcome.result.has_value())
+		{
+			outcome.status = Status::Canceled;
+		}
+		else if (m_expired)
+		{
+			outcome.status = Status::Expired;
+		}
+		else if (outcome.result.has_value() || (m_prewarm && !thrown))
+		{
+			outcome.status = Status::Done;
+		}
+		m_token.reset();
+
+		// the job is done, the decompiler is ours again
+		auto pending = std::move(m_pending);
+		m_pending.clear();
+		for (auto& update : pending)
+		{
+			update(m_decompiler);
+		}
+
+		return outcome;
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::invalidate(uint64_t funcAddress)
+	{
+		apply([funcAddress](Decompiler& decompiler) { decompiler.invalidate(funcAddress); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::invalidateDependents(uint64_t ea)
+	{
+		apply([ea](Decompiler& decompiler) { decompiler.invalidateDependents(ea); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::invalidateCode(uint64_t ea)
+	{
+		apply([ea](Decompiler& decompiler) { decompiler.invalidateCode(ea); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::clearCache()
+	{
+		apply([](Decompiler& decompiler) { decompiler.clearCache(); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::invalidateType(const std::string& name)
+	{
+		apply([name](Decompiler& decompiler) { decompiler.invalidateType(name); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::invalidateTypes()
+	{
+		apply([](Decompiler& decompiler) { decompiler.invalidateTypes(); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::retain(uint64_t funcAddress)
+	{
+		apply([funcAddress](Decompiler& decompiler) { decompiler.retain(funcAddress); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::release(uint64_t funcAddress)
+	{
+		apply([funcAddress](Decompiler& decompiler) { decompiler.release(funcAddress); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::defer(std::function<void()> update)
+	{
+		apply([update = std::move(update)](Decompiler&) { update(); });
+	}
+
+	/**********************************************************************/
+	void AsyncDecompiler::setProfileOutput(std::shared_ptr<ProfileOutput> output)
+	{
+		apply([output](Decompiler& decompiler) { decompiler.setProfileOutput(output); });
+	}
+} // end of namespace yagi
@@ -1,4 +1,5 @@
 #include "base.hh"
+#include <iomanip>
 #include <sstream>
 
 namespace yagi 
@@ -10,6 +11,25 @@ namespace yagi
 		return stream.str();
 	}
 
+	StringBuffer::StringBuffer(std::string& target)
+		: m_target{ target }
+	{}
+
+	StringBuffer::int_type StringBuffer::overflow(int_type c)
+	{
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			m_target.push_back(traits_type::to_char_type(c));
+		}
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize StringBuffer::xsputn(const char* s, std::streamsize count)
+	{
+		m_target.append(s, static_cast<size_t>(count));
+		return count;
+	}
+
 	std::vector<std::string> split(const std::string& s, char delimiter)
 	{
 		std::vector<std::string> tokens;
@@ -21,4 +41,57 @@ namespace yagi
 		}
 		return tokens;
 	}
+
+	uint64_t fnv1a(const void* data, size_t size, uint64_t hash)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	uint64_t fnv1a_string(const std::string& data, uint64_t hash)
+	{
+		// hash the size too, so that concatenation of strings are not ambiguous
+		uint64_t size = data.size();
+		hash = fnv1a(&size, sizeof(size), hash);
+		return fnv1a(data.data(), data.size(), hash);
+	}
+
+	void writeJsonString(std::ostream& stream, const std::string& value)
+	{
+		stream << '"';
+		for (auto c : value)
+		{
+			switch (c)
+			{
+			case '"':
+				stream << "\\\"";
+				break;
+			case '\\':
+				stream << "\\\\";
+				break;
+			case '\n':
+				stream << "\\n";
+				break;
+			case '\t':
+				stream << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+				}
+				else
+				{
+					stream << c;
+				}
+				break;
+			}
+		}
+		stream << '"';
+	}
 } // end of namespace yagi
\ No newline at end of file
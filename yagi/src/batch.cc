@@ -0,0 +1,369 @@
+#include "batch.hh"
+#include "exception.hh"
+#include "print.hh"
+#include "base.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+namespace yagi
+{
+	/**********************************************************************/
+	FileBatchOutput::FileBatchOutput(const std::filesystem::path& path)
+		: m_stream(path)
+	{
+		if (!m_stream.is_open())
+		{
+			throw UnableToOpenOutput(path.string());
+		}
+	}
+
+	/**********************************************************************/
+	void FileBatchOutput::write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration)
+	{
+		if (!result.has_value())
+		{
+			m_stream << "// " << to_hex(ea) << " : decompilation failed (" << std::fixed << std::setprecision(2) << duration << " ms)" << std::endl << std::endl;
+			return;
+		}
+
+		m_stream << "// " << result.value().name << " @ " << to_hex(ea) << " (" << std::fixed << std::setprecision(2) << duration << " ms)" << std::endl;
+		m_stream << removeColorTags(result.value().cCode) << std::endl;
+	}
+
+	/**********************************************************************/
+	DirectoryBatchOutput::DirectoryBatchOutput(const std::filesystem::path& directory)
+		: m_directory{ directory }
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+
+		m_timing.open(m_directory / "timing.csv");
+		if (!m_timing.is_open())
+		{
+			throw UnableToOpenOutput((m_directory / "timing.csv").string());
+		}
+		m_timing << "address,name,status,milliseconds" << std::endl;
+	}
+
+	/**********************************************************************/
+	void DirectoryBatchOutput::write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration)
+	{
+		m_timing << to_hex(ea) << ","
+			<< (result.has_value() ? result.value().name : "") << ","
+			<< (result.has_value() ? "ok" : "failed") << ","
+			<< std::fixed << std::setprecision(2) << duration << std::endl;
+
+		if (!result.has_value())
+		{
+			return;
+		}
+
+		// function names are not always valid file names
+		std::ofstream stream(m_directory / (to_hex(ea) + ".c"));
+		stream << "// " << result.value().name << " @ " << to_hex(ea) << " (" << std::fixed << std::setprecision(2) << duration << " ms)" << std::endl;
+		stream << removeColorTags(result.value().cCode);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Name of a token kind into JSON outputs
+	 */
+	static const char* _TokenKindName(Decompiler::TokenKind kind)
+	{
+		switch (kind)
+		{
+		case Decompiler::TokenKind::Keyword:
+			return "keyword";
+		case Decompiler::TokenKind::Operator:
+			return "operator";
+		case Decompiler::TokenKind::Variable:
+			return "var";
+		case Decompiler::TokenKind::FunctionName:
+			return "funcname";
+		case Decompiler::TokenKind::Type:
+			return "type";
+		case Decompiler::TokenKind::Field:
+			return "field";
+		case Decompiler::TokenKind::Constant:
+			return "const";
+		case Decompiler::TokenKind::Label:
+			return "label";
+		case Decompiler::TokenKind::Comment:
+			return "comment";
+		default:
+			return "syntax";
+		}
+	}
+
+	/**********************************************************************/
+	JsonBatchOutput::JsonBatchOutput(std::ostream& stream)
+		: m_stream{ stream }
+	{
+		m_stream << "[";
+	}
+
+	/**********************************************************************/
+	JsonBatchOutput::~JsonBatchOutput()
+	{
+		close();
+	}
+
+	/**********************************************************************/
+	void JsonBatchOutput::close()
+	{
+		if (m_closed)
+		{
+			return;
+		}
+		m_closed = true;
+		m_stream << (m_count == 0 ? "]" : "\n]") << std::flush;
+	}
+
+	/**********************************************************************/
+	void JsonBatchOutput::write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration)
+	{
+		m_stream << (m_count++ == 0 ? "" : ",") << std::endl;
+		m_stream << "{\"address\": ";
+		writeJsonString(m_stream, to_hex(ea));
+		m_stream << ", \"status\": \"" << (result.has_value() ? "ok" : "failed") << "\"";
+		m_stream << ", \"milliseconds\": " << std::fixed << std::setprecision(2) << duration;
+
+		if (!result.has_value())
+		{
+			m_stream << "}";
+			return;
+		}
+
+		m_stream << ", \"name\": ";
+		writeJsonString(m_stream, result.value().name);
+		m_stream << ", \"code\": ";
+		writeJsonString(m_stream, removeColorTags(result.value().cCode));
+
+		auto& symbols = result.value().symbols;
+		m_stream << ", \"symbols\": [";
+		for (size_t i = 0; i < symbols.size(); i++)
+		{
+			m_stream << (i == 0 ? "" : ", ") << "{\"name\": ";
+			writeJsonString(m_stream, symbols[i].name);
+			m_stream << ", \"space\": ";
+			writeJsonString(m_stream, symbols[i].location.spaceName);
+			m_stream << ", \"offset\": ";
+			writeJsonString(m_stream, to_hex(symbols[i].location.offset));
+			m_stream << ", \"size\": " << symbols[i].location.addrSize << "}";
+		}
+
+		// [line, start, end, kind, highlight, symbol index or null]
+		auto& tokens = result.value().tokens;
+		m_stream << "], \"tokens\": [";
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			m_stream << (i == 0 ? "" : ", ") << "[" << tokens[i].line << ", " << tokens[i].start << ", " << tokens[i].end;
+			m_stream << ", \"" << _TokenKindName(tokens[i].kind) << "\", " << static_cast<uint32_t>(tokens[i].highlight) << ", ";
+			if (tokens[i].symbol < symbols.size())
+			{
+				m_stream << tokens[i].symbol;
+			}
+			else
+			{
+				m_stream << "null";
+			}
+			m_stream << "]";
+		}
+		m_stream << "]}";
+	}
+
+	/**********************************************************************/
+	BatchDecompiler::BatchDecompiler(RequestQueue& queue, std::vector<std::unique_ptr<Decompiler>> workers)
+		: m_queue{ queue }, m_workers{ std::move(workers) }
+	{}
+
+	/**********************************************************************/
+	void BatchDecompiler::setCloneKey(CloneKeyProvider provider)
+	{
+		m_cloneKey = std::move(provider);
+	}
+
+	/**********************************************************************/
+	std::vector<uint64_t> BatchDecompiler::groupClones(const std::vector<uint64_t>& functions, std::vector<CloneGroup>& groups)
+	{
+		groups.clear();
+		if (!m_cloneKey)
+		{
+			groups.resize(functions.size());
+			return functions;
+		}
+
+		// keys ask the backend, so they are computed here on the owner thread
+		std::vector<uint64_t> representatives;
+		std::map<std::pair<uint64_t, uint64_t>, size_t> classes;
+		for (auto ea : functions)
+		{
+			auto key = m_cloneKey(ea);
+			if (key.has_value())
+			{
+				auto inserted = classes.emplace(std::make_pair(key.value().hash, key.value().size), representatives.size());
+				if (!inserted.second)
+				{
+					groups[inserted.first->second].clones.emplace_back(ea, std::move(key.value().name));
+					continue;
+				}
+			}
+
+			representatives.push_back(ea);
+			groups.emplace_back();
+			groups.back().size = key.has_value() ? key.value().size : 0;
+		}
+		return representatives;
+	}
+
+	/**********************************************************************/
+	BatchDecompiler::Report BatchDecompiler::run(const std::vector<uint64_t>& functions, BatchOutput& output, const Progress& progress)
+	{
+		Report report;
+		auto start = std::chrono::steady_clock::now();
+
+		runWave(functions, output, progress, 0, functions.size(), report, nullptr);
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		report.duration = duration.count();
+		return report;
+	}
+
+	/**********************************************************************/
+	BatchDecompiler::Report BatchDecompiler::run(const std::vector<std::vector<uint64_t>>& waves, BatchOutput& output, const Progress& progress, const WaveDone& waveDone)
+	{
+		Report report;
+		auto start = std::chrono::steady_clock::now();
+
+		size_t total = 0;
+		for (auto& wave : waves)
+		{
+			total += wave.size();
+		}
+
+		size_t done = 0;
+		for (auto& wave : waves)
+		{
+			std::vector<std::pair<uint64_t, std::shared_ptr<const Prototype>>> prototypes;
+			runWave(wave, output, progress, done, total, report, &prototypes);
+			done += wave.size();
+
+			// an incomplete wave is not propagated
+			if (report.canceled)
+			{
+				break;
+			}
+
+			if (waveDone)
+			{
+				waveDone(prototypes);
+			}
+		}
+
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		report.duration = duration.count();
+		return report;
+	}
+
+	/**********************************************************************/
+	void BatchDecompiler::runWave(const std::vector<uint64_t>& wave, BatchOutput& output, const Progress& progress, size_t previous, size_t total, Report& report, std::vector<std::pair<uint64_t, std::shared_ptr<const Prototype>>>* prototypes)
+	{
+		std::vector<CloneGroup> groups;
+		auto functions = groupClones(wave, groups);
+
+		std::atomic<size_t> next{ 0 };
+		std::atomic<size_t> done{ previous };
+		std::atomic<bool> canceled{ false };
+		std::mutex outputMutex;
+
+		// a small wave does not need every worker
+		auto nbThreads = std::min(m_workers.size(), functions.size());
+		std::atomic<size_t> running{ nbThreads };
+
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < nbThreads; i++)
+		{
+			threads.emplace_back([&, decompiler = m_workers[i].get()]() {
+				while (!canceled)
+				{
+					auto index = next++;
+					if (index >= functions.size())
+					{
+						break;
+					}
+
+					auto functionStart = std::chrono::steady_clock::now();
+					auto result = decompiler->decompile(functions[index]);
+					std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - functionStart;
+
+					{
+						std::lock_guard<std::mutex> lock(outputMutex);
+						output.write(functions[index], result, duration.count());
+						if (result.has_value())
+						{
+							report.decompiled++;
+							if (prototypes != nullptr && result.value().prototype != nullptr)
+							{
+								prototypes->emplace_back(functions[index], result.value().prototype);
+							}
+						}
+						else
+						{
+							report.failed++;
+						}
+
+						// clones were not decompiled, no time is spent on them
+						auto& group = groups[index];
+						for (auto& clone : group.clones)
+						{
+							if (!result.has_value())
+							{
+								output.write(clone.first, std::nullopt, 0);
+								report.failed++;
+								continue;
+							}
+
+							auto rebased = rebaseResult(result.value(), functions[index], group.size, clone.first, clone.second);
+							output.write(clone.first, rebased, 0);
+							report.reused++;
+							if (prototypes != nullptr && rebased.prototype != nullptr)
+							{
+								prototypes->emplace_back(clone.first, rebased.prototype);
+							}
+						}
+					}
+					done += 1 + groups[index].clones.size();
+				}
+
+				running--;
+				m_queue.wake();
+			});
+		}
+
+		// workers are blocked until their backend requests are processed
+		// so keep the queue running even after a cancel
+		while (running > 0)
+		{
+			m_queue.process(std::chrono::milliseconds(50));
+			if (!canceled && progress && !progress(done, total))
+			{
+				canceled = true;
+			}
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		// flush posted requests (log messages)
+		m_queue.process(std::chrono::milliseconds(0));
+
+		report.canceled = report.canceled || canceled;
+	}
+} // end of namespace yagi
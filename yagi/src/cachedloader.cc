@@ -0,0 +1,41 @@
+#include "cachedloader.hh"
+
+namespace yagi 
+{
+	/**********************************************************************/
+	CachedLoader::CachedLoader(std::shared_ptr<PageCache> cache, std::unique_ptr<LoadImage> inner)
+		: LoadImage(inner->getFileName()), m_cache{ std::move(cache) }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	std::string CachedLoader::getArchType(void) const
+	{
+		return m_inner->getArchType();
+	}
+
+	/**********************************************************************/
+	void CachedLoader::loadFill(uint1* ptr, int4 size, const Address& addr)
+	{
+		auto space = addr.getSpace();
+		m_cache->read([this, space](uint64_t ea, uint8_t* buffer, size_t size) {
+			m_inner->loadFill(buffer, static_cast<int4>(size), Address(space, ea));
+		}, addr.getOffset(), ptr, size);
+	}
+
+	/**********************************************************************/
+	void CachedLoader::adjustVma(long adjust)
+	{
+		throw LowlevelError("Cannot adjust YAGI virtual memory");
+	}
+
+	/**********************************************************************/
+	CachedLoaderFactory::CachedLoaderFactory(std::shared_ptr<PageCache> cache, std::unique_ptr<LoaderFactory> inner)
+		: m_cache{ std::move(cache) }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	LoadImage* CachedLoaderFactory::build()
+	{
+		return new CachedLoader(m_cache, std::unique_ptr<LoadImage>(m_inner->build()));
+	}
+} // end of namespace yagi
\ No newline at end of file
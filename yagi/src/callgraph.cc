@@ -0,0 +1,149 @@
+#include "callgraph.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace yagi
+{
+	/**********************************************************************/
+	void CallGraph::addFunction(uint64_t ea)
+	{
+		m_callees.emplace(ea, std::vector<uint64_t>());
+	}
+
+	/**********************************************************************/
+	void CallGraph::addCall(uint64_t caller, uint64_t callee)
+	{
+		m_callees[caller].push_back(callee);
+	}
+
+	/**********************************************************************/
+	size_t CallGraph::size() const noexcept
+	{
+		return m_callees.size();
+	}
+
+	/**********************************************************************/
+	std::vector<std::vector<uint64_t>> CallGraph::getWaves() const
+	{
+		static const size_t UNVISITED = std::numeric_limits<size_t>::max();
+
+		// functions are numbered in address order
+		std::vector<uint64_t> functions;
+		functions.reserve(m_callees.size());
+		for (auto& entry : m_callees)
+		{
+			functions.push_back(entry.first);
+		}
+
+		std::vector<std::vector<size_t>> edges(functions.size());
+		for (size_t i = 0; i < functions.size(); i++)
+		{
+			for (auto callee : m_callees.at(functions[i]))
+			{
+				auto iter = std::lower_bound(functions.begin(), functions.end(), callee);
+				auto target = static_cast<size_t>(iter - functions.begin());
+				if (iter != functions.end() && *iter == callee && target != i)
+				{
+					edges[i].push_back(target);
+				}
+			}
+		}
+
+		// Tarjan strongly connected components, without recursion
+		// as call chains can be deeper than the native stack
+		// a component is closed once all its callees are closed
+		// so the level of callees is always known
+		std::vector<size_t> index(functions.size(), UNVISITED);
+		std::vector<size_t> lowLink(functions.size(), 0);
+		std::vector<size_t> component(functions.size(), UNVISITED);
+		std::vector<size_t> levels;
+		std::vector<size_t> stack;
+		std::vector<std::pair<size_t, size_t>> path;
+		size_t counter = 0;
+
+		for (size_t root = 0; root < functions.size(); root++)
+		{
+			if (index[root] != UNVISITED)
+			{
+				continue;
+			}
+
+			path.emplace_back(root, 0);
+			index[root] = lowLink[root] = counter++;
+			stack.push_back(root);
+
+			while (!path.empty())
+			{
+				auto& frame = path.back();
+				auto node = frame.first;
+				if (frame.second < edges[node].size())
+				{
+					auto next = edges[node][frame.second++];
+					if (index[next] == UNVISITED)
+					{
+						index[next] = lowLink[next] = counter++;
+						stack.push_back(next);
+						path.emplace_back(next, 0);
+					}
+					else if (component[next] == UNVISITED)
+					{
+						lowLink[node] = std::min(lowLink[node], index[next]);
+					}
+					continue;
+				}
+
+				path.pop_back();
+				if (!path.empty())
+				{
+					auto parent = path.back().first;
+					lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+				}
+
+				if (lowLink[node] != index[node])
+				{
+					continue;
+				}
+
+				// close the component of node, its members are on top of the stack
+				auto id = levels.size();
+				auto first = stack.end();
+				do
+				{
+					--first;
+				} while (*first != node);
+
+				for (auto iter = first; iter != stack.end(); iter++)
+				{
+					component[*iter] = id;
+				}
+
+				size_t level = 0;
+				for (auto iter = first; iter != stack.end(); iter++)
+				{
+					for (auto callee : edges[*iter])
+					{
+						if (component[callee] != id)
+						{
+							level = std::max(level, levels[component[callee]] + 1);
+						}
+					}
+				}
+				levels.push_back(level);
+				stack.erase(first, stack.end());
+			}
+		}
+
+		std::vector<std::vector<uint64_t>> waves;
+		for (size_t i = 0; i < functions.size(); i++)
+		{
+			auto level = levels[component[i]];
+			if (level >= waves.size())
+			{
+				waves.resize(level + 1);
+			}
+			waves[level].push_back(functions[i]);
+		}
+		return waves;
+	}
+} // end of namespace yagi
@@ -0,0 +1,46 @@
+#include "cancel.hh"
+#include "exception.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	CancelToken::CancelToken(std::chrono::milliseconds budget)
+	{
+		if (budget.count() > 0)
+		{
+			m_deadline = std::chrono::steady_clock::now() + budget;
+		}
+	}
+
+	/**********************************************************************/
+	void CancelToken::cancel() noexcept
+	{
+		m_canceled = true;
+	}
+
+	/**********************************************************************/
+	bool CancelToken::isCanceled() const noexcept
+	{
+		return m_canceled;
+	}
+
+	/**********************************************************************/
+	bool CancelToken::isExpired() const noexcept
+	{
+		return m_deadline.has_value() && std::chrono::steady_clock::now() >= m_deadline.value();
+	}
+
+	/**********************************************************************/
+	void CancelToken::check() const
+	{
+		if (isCanceled())
+		{
+			throw DecompilationCanceled();
+		}
+
+		if (isExpired())
+		{
+			throw DecompilationTimeout();
+		}
+	}
+} // end of namespace yagi
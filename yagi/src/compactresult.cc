@@ -0,0 +1,185 @@
+#include "compactresult.hh"
+
+#include <unordered_map>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Names of the spaces with an id, in SpaceId order
+	 */
+	static const char* SPACE_NAMES[] = { "ram", "stack", "register", "unique", "const" };
+
+	/**********************************************************************/
+	SpaceId toSpaceId(std::string_view spaceName) noexcept
+	{
+		for (size_t i = 0; i < sizeof(SPACE_NAMES) / sizeof(SPACE_NAMES[0]); i++)
+		{
+			if (spaceName == SPACE_NAMES[i])
+			{
+				return static_cast<SpaceId>(i);
+			}
+		}
+		return SpaceId::Other;
+	}
+
+	/**********************************************************************/
+	CompactResult::CompactResult(Decompiler::Result result)
+		: m_code{ std::move(result.cCode) }, m_name{ std::move(result.name) }, m_ea{ result.ea },
+		m_tokens{ std::move(result.tokens) }, m_prototype{ std::move(result.prototype) },
+		m_dependencies{ std::move(result.dependencies) }
+	{
+		size_t size = 0, pcCount = 0;
+		for (auto& symbol : result.symbols)
+		{
+			size += symbol.name.size();
+			pcCount += symbol.location.pc.size();
+		}
+		m_strings.reserve(size);
+		m_pcs.reserve(pcCount);
+		m_symbols.reserve(result.symbols.size());
+
+		// a name printed for several storages is stored once
+		std::unordered_map<std::string_view, uint32_t> names;
+		std::vector<std::pair<std::string_view, uint32_t>> byName;
+		for (auto& symbol : result.symbols)
+		{
+			auto name = names.find(symbol.name);
+			if (name == names.end())
+			{
+				name = names.emplace(symbol.name, static_cast<uint32_t>(m_strings.size())).first;
+				m_strings.append(symbol.name);
+			}
+
+			Symbol compact{};
+			compact.offset = symbol.location.offset;
+			compact.name = name->second;
+			compact.nameSize = static_cast<uint32_t>(symbol.name.size());
+			compact.pc = static_cast<uint32_t>(m_pcs.size());
+			compact.pcCount = static_cast<uint32_t>(symbol.location.pc.size());
+			compact.addrSize = symbol.location.addrSize;
+			compact.space = toSpaceId(symbol.location.spaceName);
+			if (compact.space == SpaceId::Other)
+			{
+				auto other = std::find(m_spaces.begin(), m_spaces.end(), symbol.location.spaceName);
+				compact.otherSpace = static_cast<uint8_t>(other - m_spaces.begin());
+				if (other == m_spaces.end())
+				{
+					m_spaces.push_back(symbol.location.spaceName);
+				}
+			}
+
+			m_pcs.insert(m_pcs.end(), symbol.location.pc.begin(), symbol.location.pc.end());
+			byName.emplace_back(symbol.name, static_cast<uint32_t>(m_symbols.size()));
+			m_symbols.push_back(compact);
+		}
+
+		std::sort(byName.begin(), byName.end());
+		m_byName.reserve(byName.size());
+		for (auto& entry : byName)
+		{
+			m_byName.push_back(entry.second);
+		}
+	}
+
+	/**********************************************************************/
+	Decompiler::Result CompactResult::toResult() const
+	{
+		std::vector<Decompiler::Symbol> symbols;
+		symbols.reserve(m_symbols.size());
+		for (auto& symbol : m_symbols)
+		{
+			symbols.emplace_back(std::string(getSymbolName(symbol)), getLocation(symbol));
+		}
+
+		Decompiler::Result result(m_name, m_ea, m_code, std::move(symbols), m_tokens);
+		result.prototype = m_prototype;
+		result.dependencies = m_dependencies;
+		return result;
+	}
+
+	/**********************************************************************/
+	std::string CompactResult::takeCode()
+	{
+		auto code = std::move(m_code);
+		m_code = std::string();
+		return code;
+	}
+
+	/**********************************************************************/
+	const std::string& CompactResult::getCode() const noexcept
+	{
+		return m_code;
+	}
+
+	/**********************************************************************/
+	const std::string& CompactResult::getName() const noexcept
+	{
+		return m_name;
+	}
+
+	/**********************************************************************/
+	uint64_t CompactResult::getEa() const noexcept
+	{
+		return m_ea;
+	}
+
+	/**********************************************************************/
+	const std::vector<CompactResult::Symbol>& CompactResult::getSymbols() const noexcept
+	{
+		return m_symbols;
+	}
+
+	/**********************************************************************/
+	const Decompiler::Dependencies& CompactResult::getDependencies() const noexcept
+	{
+		return m_dependencies;
+	}
+
+	/**********************************************************************/
+	std::string_view CompactResult::getSymbolName(const Symbol& symbol) const noexcept
+	{
+		return std::string_view(m_strings).substr(symbol.name, symbol.nameSize);
+	}
+
+	/**********************************************************************/
+	std::string_view CompactResult::getSpaceName(const Symbol& symbol) const noexcept
+	{
+		if (symbol.space == SpaceId::Other)
+		{
+			return m_spaces[symbol.otherSpace];
+		}
+		return SPACE_NAMES[static_cast<size_t>(symbol.space)];
+	}
+
+	/**********************************************************************/
+	MemoryLocation CompactResult::getLocation(const Symbol& symbol) const
+	{
+		MemoryLocation location(std::string(getSpaceName(symbol)), symbol.offset, symbol.addrSize);
+		location.pc.assign(m_pcs.begin() + symbol.pc, m_pcs.begin() + symbol.pc + symbol.pcCount);
+		return location;
+	}
+
+	/**********************************************************************/
+	const CompactResult::Symbol* CompactResult::findSymbol(uint32_t line, uint32_t column) const
+	{
+		auto token = Decompiler::Result::findToken(m_tokens, line, column);
+		if (token == nullptr || token->symbol >= m_symbols.size())
+		{
+			return nullptr;
+		}
+		return &m_symbols[token->symbol];
+	}
+
+	/**********************************************************************/
+	const CompactResult::Symbol* CompactResult::findSymbol(std::string_view name) const
+	{
+		auto iter = std::lower_bound(m_byName.begin(), m_byName.end(), name, [this](uint32_t index, std::string_view value) {
+			return getSymbolName(m_symbols[index]) < value;
+		});
+		if (iter == m_byName.end() || getSymbolName(m_symbols[*iter]) != name)
+		{
+			return nullptr;
+		}
+		return &m_symbols[*iter];
+	}
+} // end of namespace yagi
\ No newline at end of file
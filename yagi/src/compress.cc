@@ -0,0 +1,227 @@
+#include "compress.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace yagi
+{
+	/*!
+	 * \brief	Shortest match worth an offset
+	 */
+	static const size_t MIN_MATCH = 4;
+
+	/*!
+	 * \brief	Last bytes of a block are always literals
+	 *			and no match starts into the last MATCH_LIMIT bytes
+	 */
+	static const size_t LAST_LITERALS = 5;
+	static const size_t MATCH_LIMIT = 12;
+
+	/*!
+	 * \brief	Offsets are written on 16 bits
+	 */
+	static const size_t MAX_OFFSET = 65535;
+
+	/*!
+	 * \brief	Size of the table of last positions of 4 bytes sequences
+	 */
+	static const uint32_t HASH_BITS = 12;
+
+	/**********************************************************************/
+	static uint32_t _Read32(const std::vector<uint8_t>& buffer, size_t pos)
+	{
+		uint32_t value;
+		std::memcpy(&value, buffer.data() + pos, sizeof(value));
+		return value;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Lengths above 15 are continued with bytes of 255
+	 */
+	static void _WriteLength(std::vector<uint8_t>& output, size_t length)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+		output.push_back(static_cast<uint8_t>(length));
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Read the continuation of a length
+	 * \return	false if the buffer ends before
+	 */
+	static bool _ReadLength(const std::vector<uint8_t>& input, size_t& pos, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (pos >= input.size())
+			{
+				return false;
+			}
+			byte = input[pos++];
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Write literals followed by a match
+	 *			The last sequence of a block has no match
+	 */
+	static void _WriteSequence(std::vector<uint8_t>& output, const std::vector<uint8_t>& input, size_t anchor, size_t literals, size_t offset, size_t match)
+	{
+		auto token = output.size();
+		output.push_back(static_cast<uint8_t>(std::min<size_t>(literals, 15) << 4));
+		if (literals >= 15)
+		{
+			_WriteLength(output, literals - 15);
+		}
+		output.insert(output.end(), input.begin() + anchor, input.begin() + anchor + literals);
+
+		if (match == 0)
+		{
+			return;
+		}
+
+		output.push_back(static_cast<uint8_t>(offset & 0xff));
+		output.push_back(static_cast<uint8_t>(offset >> 8));
+
+		match -= MIN_MATCH;
+		output[token] |= static_cast<uint8_t>(std::min<size_t>(match, 15));
+		if (match >= 15)
+		{
+			_WriteLength(output, match - 15);
+		}
+	}
+
+	/**********************************************************************/
+	std::vector<uint8_t> compressBuffer(const std::vector<uint8_t>& input)
+	{
+		std::vector<uint8_t> output;
+		output.reserve(input.size() / 2 + 16);
+
+		auto size = static_cast<uint32_t>(input.size());
+		for (size_t i = 0; i < sizeof(size); i++)
+		{
+			output.push_back(static_cast<uint8_t>(size >> (i * 8)));
+		}
+
+		// last position of each hashed sequence, 0 means none
+		std::vector<size_t> table(static_cast<size_t>(1) << HASH_BITS, 0);
+		size_t anchor = 0;
+		size_t pos = 0;
+		auto limit = input.size() > MATCH_LIMIT ? input.size() - MATCH_LIMIT : 0;
+		while (pos < limit)
+		{
+			auto sequence = _Read32(input, pos);
+			auto& slot = table[(sequence * 2654435761u) >> (32 - HASH_BITS)];
+			auto candidate = slot;
+			slot = pos + 1;
+
+			if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || _Read32(input, candidate - 1) != sequence)
+			{
+				pos++;
+				continue;
+			}
+
+			auto ref = candidate - 1 + MIN_MATCH;
+			auto end = pos + MIN_MATCH;
+			while (end < input.size() - LAST_LITERALS && input[end] == input[ref])
+			{
+				end++;
+				ref++;
+			}
+
+			_WriteSequence(output, input, anchor, pos - anchor, pos - (candidate - 1), end - pos);
+			pos = end;
+			anchor = pos;
+		}
+
+		_WriteSequence(output, input, anchor, input.size() - anchor, 0, 0);
+		return output;
+	}
+
+	/**********************************************************************/
+	std::optional<std::vector<uint8_t>> decompressBuffer(const std::vector<uint8_t>& input)
+	{
+		if (input.size() < sizeof(uint32_t))
+		{
+			return std::nullopt;
+		}
+
+		size_t size = 0;
+		for (size_t i = 0; i < sizeof(uint32_t); i++)
+		{
+			size |= static_cast<size_t>(input[i]) << (i * 8);
+		}
+
+		// a corrupted size must not allocate much
+		if (size > input.size() * 255)
+		{
+			return std::nullopt;
+		}
+
+		std::vector<uint8_t> output;
+		output.reserve(size);
+		size_t pos = sizeof(uint32_t);
+		while (pos < input.size())
+		{
+			auto token = input[pos++];
+			size_t literals = token >> 4;
+			if (literals == 15 && !_ReadLength(input, pos, literals))
+			{
+				return std::nullopt;
+			}
+			if (literals > input.size() - pos || output.size() + literals > size)
+			{
+				return std::nullopt;
+			}
+			output.insert(output.end(), input.begin() + pos, input.begin() + pos + literals);
+			pos += literals;
+
+			// the last sequence has no match
+			if (pos == input.size())
+			{
+				break;
+			}
+
+			if (input.size() - pos < 2)
+			{
+				return std::nullopt;
+			}
+			size_t offset = input[pos] | (static_cast<size_t>(input[pos + 1]) << 8);
+			pos += 2;
+
+			size_t match = token & 0xf;
+			if (match == 15 && !_ReadLength(input, pos, match))
+			{
+				return std::nullopt;
+			}
+			match += MIN_MATCH;
+
+			if (offset == 0 || offset > output.size() || output.size() + match > size)
+			{
+				return std::nullopt;
+			}
+
+			// the match can overlap the bytes it writes
+			auto from = output.size() - offset;
+			for (size_t i = 0; i < match; i++)
+			{
+				output.push_back(output[from + i]);
+			}
+		}
+
+		if (output.size() != size)
+		{
+			return std::nullopt;
+		}
+		return output;
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "decompilecontext.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	DecompileContext::DecompileContext(std::unique_ptr<FunctionSymbolInfo> function)
+		: m_function{ std::move(function) }
+	{}
+
+	/**********************************************************************/
+	uint64_t DecompileContext::getAddress()
+	{
+		return m_function->getSymbol().getAddress();
+	}
+
+	/**********************************************************************/
+	FunctionSymbolInfo& DecompileContext::getFunction() noexcept
+	{
+		return *m_function;
+	}
+
+	/**********************************************************************/
+	const LocalOverrides& DecompileContext::getOverrides()
+	{
+		if (!m_overrides.has_value())
+		{
+			m_overrides = m_function->findLocalOverrides();
+		}
+		return m_overrides.value();
+	}
+
+	/**********************************************************************/
+	void DecompileContext::addDependency(uint64_t ea)
+	{
+		m_addresses.insert(ea);
+	}
+
+	/**********************************************************************/
+	bool DecompileContext::addDependency(const std::string& type)
+	{
+		return m_types.insert(type).second;
+	}
+
+	/**********************************************************************/
+	void DecompileContext::addDependencies(const Decompiler::Dependencies& dependencies)
+	{
+		m_addresses.insert(dependencies.addresses.begin(), dependencies.addresses.end());
+		m_types.insert(dependencies.types.begin(), dependencies.types.end());
+	}
+
+	/**********************************************************************/
+	Decompiler::Dependencies DecompileContext::getDependencies() const
+	{
+		Decompiler::Dependencies result;
+		result.addresses.assign(m_addresses.begin(), m_addresses.end());
+		result.types.assign(m_types.begin(), m_types.end());
+		return result;
+	}
+} // end of namespace yagi
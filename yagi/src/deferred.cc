@@ -0,0 +1,212 @@
+#include "deferred.hh"
+
+#include <chrono>
+
+namespace yagi
+{
+	/**********************************************************************/
+	DeferredDecompiler::DeferredDecompiler(Builder builder, std::unique_ptr<Logger> logger)
+		: m_future{ std::async(std::launch::async, std::move(builder)) }, m_logger{ std::move(logger) }
+	{}
+
+	/**********************************************************************/
+	DeferredDecompiler::~DeferredDecompiler()
+	{
+		if (m_future.valid())
+		{
+			m_future.wait();
+		}
+	}
+
+	/**********************************************************************/
+	Decompiler* DeferredDecompiler::resolve()
+	{
+		if (!m_resolved)
+		{
+			if (m_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				m_logger->info("Waiting for the decompiler initialization");
+			}
+
+			try
+			{
+				m_decompiler = m_future.get();
+			}
+			catch (std::exception& e)
+			{
+				m_logger->error(e.what());
+			}
+			catch (...)
+			{
+				// Ghidra errors are not standard exceptions
+				m_logger->error("Unexpected error during the decompiler initialization");
+			}
+			m_resolved = true;
+
+			if (m_decompiler == nullptr)
+			{
+				m_logger->error("Unable to initialize the decompiler");
+			}
+			else
+			{
+				if (m_cancel != nullptr)
+				{
+					m_decompiler->setCancelToken(m_cancel);
+				}
+				if (m_profile != nullptr)
+				{
+					m_decompiler->setProfileOutput(m_profile);
+				}
+			}
+		}
+		return m_decompiler.get();
+	}
+
+	/**********************************************************************/
+	Decompiler* DeferredDecompiler::ready()
+	{
+		if (!m_resolved && m_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return nullptr;
+		}
+		return resolve();
+	}
+
+	/**********************************************************************/
+	bool DeferredDecompiler::wait()
+	{
+		return resolve() != nullptr;
+	}
+
+	/**********************************************************************/
+	bool DeferredDecompiler::isBuilt() const
+	{
+		return m_resolved || m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> DeferredDecompiler::decompile(uint64_t funcAddress)
+	{
+		auto decompiler = resolve();
+		if (decompiler == nullptr)
+		{
+			return std::nullopt;
+		}
+		return decompiler->decompile(funcAddress);
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> DeferredDecompiler::refreshNames(uint64_t funcAddress)
+	{
+		auto decompiler = resolve();
+		if (decompiler == nullptr)
+		{
+			return std::nullopt;
+		}
+		return decompiler->refreshNames(funcAddress);
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::invalidate(uint64_t funcAddress)
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->invalidate(funcAddress);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::invalidateDependents(uint64_t ea)
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->invalidateDependents(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::invalidateCode(uint64_t ea)
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->invalidateCode(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::clearCache()
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->clearCache();
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::invalidateType(const std::string& name)
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->invalidateType(name);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::invalidateTypes()
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->invalidateTypes();
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::retain(uint64_t funcAddress)
+	{
+		// nothing is shown before the first decompilation
+		if (auto decompiler = ready())
+		{
+			decompiler->retain(funcAddress);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::release(uint64_t funcAddress)
+	{
+		if (auto decompiler = ready())
+		{
+			decompiler->release(funcAddress);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::setCancelToken(std::shared_ptr<const CancelToken> token)
+	{
+		// don't wait for the build, the token is applied by resolve
+		m_cancel = std::move(token);
+		if (auto decompiler = ready())
+		{
+			decompiler->setCancelToken(m_cancel);
+		}
+	}
+
+	/**********************************************************************/
+	void DeferredDecompiler::setProfileOutput(std::shared_ptr<ProfileOutput> output)
+	{
+		m_profile = std::move(output);
+		if (auto decompiler = ready())
+		{
+			decompiler->setProfileOutput(m_profile);
+		}
+	}
+
+	/**********************************************************************/
+	size_t DeferredDecompiler::prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names)
+	{
+		if (auto decompiler = ready())
+		{
+			return decompiler->prewarmTypes(source, names);
+		}
+		return 0;
+	}
+} // end of namespace yagi
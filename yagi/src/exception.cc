@@ -115,4 +115,61 @@ namespace yagi
 		ss << "Ghidra folder missing. Yagi was not correctly installed.";
 		m_reason = ss.str();
 	}
+
+	/**********************************************************************/
+	UnableToOpenOutput::UnableToOpenOutput(const std::string& path)
+		: Error("")
+	{
+		std::stringstream ss(m_reason);
+		ss << "Unable to open output file " << path;
+		m_reason = ss.str();
+	}
+
+	/**********************************************************************/
+	DecompilationCanceled::DecompilationCanceled(std::string reason)
+		: Error(std::move(reason))
+	{}
+
+	/**********************************************************************/
+	DecompilationCanceled::DecompilationCanceled()
+		: Error("Decompilation canceled")
+	{}
+
+	/**********************************************************************/
+	DecompilationTimeout::DecompilationTimeout(std::string reason)
+		: DecompilationCanceled(std::move(reason))
+	{}
+
+	/**********************************************************************/
+	DecompilationTimeout::DecompilationTimeout()
+		: DecompilationTimeout("Decompilation stopped, time budget exceeded")
+	{}
+
+	/**********************************************************************/
+	AnalysisLimitExceeded::AnalysisLimitExceeded()
+		: DecompilationTimeout("Decompilation stopped, pass limit of large functions exceeded")
+	{}
+
+	/**********************************************************************/
+	LargeFunction::LargeFunction(size_t ops)
+		: Error("Large function of " + std::to_string(ops) + " ops")
+	{}
+
+	/**********************************************************************/
+	InvalidExport::InvalidExport(const std::string& reason)
+		: Error("")
+	{
+		std::stringstream ss(m_reason);
+		ss << "Invalid export : " << reason;
+		m_reason = ss.str();
+	}
+
+	/**********************************************************************/
+	InvalidRegressionRun::InvalidRegressionRun(const std::string& path)
+		: Error("")
+	{
+		std::stringstream ss(m_reason);
+		ss << "Invalid regression run " << path;
+		m_reason = ss.str();
+	}
 } // end of namespace yagi
@@ -0,0 +1,470 @@
+#include "exportdatabase.hh"
+#include "exportformat.hh"
+#include "exception.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace yagi
+{
+	using namespace exportformat;
+
+	/*!
+	 * \brief	Max number of segment bytes written at once
+	 */
+	static const size_t EXPORT_CHUNK_SIZE = 0x100000;
+
+	/*!
+	 * \brief	Deduplicated strings of the export
+	 */
+	class StringPool
+	{
+	protected:
+		std::vector<uint8_t> m_data;
+		std::unordered_map<std::string, StringRef> m_refs;
+
+	public:
+		StringRef add(const std::string& value)
+		{
+			auto known = m_refs.find(value);
+			if (known != m_refs.end())
+			{
+				return known->second;
+			}
+
+			// references are 32 bits offsets into the pool
+			if (value.size() > std::numeric_limits<uint32_t>::max() - m_data.size())
+			{
+				throw InvalidExport("strings exceed 4 GiB");
+			}
+
+			StringRef ref{ static_cast<uint32_t>(m_data.size()), static_cast<uint32_t>(value.size()) };
+			m_data.insert(m_data.end(), value.begin(), value.end());
+			m_refs.emplace(value, ref);
+			return ref;
+		}
+
+		const std::vector<uint8_t>& data() const noexcept
+		{
+			return m_data;
+		}
+	};
+
+	/*!
+	 * \brief	Records of a section
+	 */
+	class SectionBuffer
+	{
+	protected:
+		std::vector<uint8_t> m_data;
+		uint64_t m_count = 0;
+
+	public:
+		template<typename T>
+		void push(const T& record)
+		{
+			auto offset = m_data.size();
+			m_data.resize(offset + sizeof(T));
+			std::memcpy(m_data.data() + offset, &record, sizeof(T));
+			m_count++;
+		}
+
+		uint32_t count() const noexcept
+		{
+			return static_cast<uint32_t>(m_count);
+		}
+
+		const std::vector<uint8_t>& data() const noexcept
+		{
+			return m_data;
+		}
+	};
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Pad a section of this size to the record alignment
+	 */
+	static void _WritePadding(std::ostream& stream, uint64_t size)
+	{
+		static const char padding[8] = { 0 };
+		stream.write(padding, align(size) - size);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Write a whole section
+	 */
+	static void _WriteSection(std::ostream& stream, const std::vector<uint8_t>& data)
+	{
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+		_WritePadding(stream, data.size());
+	}
+
+	/**********************************************************************/
+	ExportDatabase::ExportDatabase(const Compiler& compiler)
+		: m_compiler{ compiler }
+	{}
+
+	/**********************************************************************/
+	const Compiler& ExportDatabase::getCompiler() const noexcept
+	{
+		return m_compiler;
+	}
+
+	/**********************************************************************/
+	MemoryImage& ExportDatabase::getImage() noexcept
+	{
+		return m_image;
+	}
+
+	/**********************************************************************/
+	const MemoryImage& ExportDatabase::getImage() const noexcept
+	{
+		return m_image;
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::addSegment(Segment segment)
+	{
+		auto start = segment.start;
+		m_segments[start] = std::move(segment);
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::addImport(uint64_t ea, Import import)
+	{
+		m_imports[ea] = std::move(import);
+	}
+
+	/**********************************************************************/
+	ExportDatabase::TypeIndex ExportDatabase::addType(const TypeInfo& type)
+	{
+		auto name = type.getName();
+		if (!name.empty())
+		{
+			auto known = m_namedTypes.find(name);
+			if (known != m_namedTypes.end())
+			{
+				return known->second;
+			}
+		}
+
+		// registered before nested types, a struct can point to itself
+		auto index = static_cast<TypeIndex>(m_types.size());
+		m_types.emplace_back();
+		if (!name.empty())
+		{
+			m_namedTypes.emplace(name, index);
+		}
+
+		Type result;
+		result.name = name;
+		result.size = type.getSize();
+		result.flags = (type.isInt() ? TYPE_INT : 0)
+			| (type.isBool() ? TYPE_BOOL : 0)
+			| (type.isFloat() ? TYPE_FLOAT : 0)
+			| (type.isVoid() ? TYPE_VOID : 0)
+			| (type.isConst() ? TYPE_CONST : 0)
+			| (type.isChar() ? TYPE_CHAR : 0)
+			| (type.isUnicode() ? TYPE_UNICODE : 0);
+
+		// nested types are added first, m_types may grow meanwhile
+		auto func = type.toFunc();
+		auto structure = type.toStruct();
+		auto ptr = type.toPtr();
+		auto array = type.toArray();
+		if (func.has_value())
+		{
+			auto& info = *func.value();
+			Func part;
+			part.dotDotDot = info.isDotDotDot();
+			try
+			{
+				part.callingConv = info.getCallingConv();
+			}
+			catch (UnknownCallingConvention&) {}
+
+			for (auto& param : info.getFuncPrototype())
+			{
+				part.prototype.push_back(addType(*param));
+			}
+			part.paramNames = info.getFuncParamName();
+			part.name = info.getName();
+			result.func = std::move(part);
+		}
+		else if (structure.has_value())
+		{
+			std::vector<Field> fields;
+			for (auto& field : structure.value()->getFields())
+			{
+				fields.push_back(Field{ field.offset, field.name, addType(*field.type) });
+			}
+			result.fields = std::move(fields);
+		}
+		else if (ptr.has_value())
+		{
+			result.pointed = addType(*ptr.value()->getPointedObject());
+		}
+		else if (array.has_value())
+		{
+			auto element = addType(*array.value()->getPointedObject());
+			result.array = Array{ element, array.value()->getSize() };
+		}
+
+		m_types[index] = std::move(result);
+		return index;
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::addTypeAt(uint64_t ea, const TypeInfo& type)
+	{
+		m_typesByAddress[ea] = addType(type);
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::addSymbol(const SymbolInfo& symbol)
+	{
+		Symbol result;
+		result.name = symbol.getName();
+		result.flags = (symbol.isFunction() ? SYMBOL_FUNCTION : 0)
+			| (symbol.isLabel() ? SYMBOL_LABEL : 0)
+			| (symbol.isImport() ? SYMBOL_IMPORT : 0);
+		m_symbols[symbol.getAddress()] = std::move(result);
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::addFunction(FunctionSymbolInfo& function, const std::map<uint64_t, std::string>& stackVars)
+	{
+		auto& symbol = function.getSymbol();
+
+		Function result;
+		result.ea = symbol.getAddress();
+		result.size = symbol.getFunctionSize();
+		result.name = symbol.getName();
+		result.contentHash = function.getContentHash();
+		result.cloneHash = function.getCloneHash();
+		result.library = function.isLibrary();
+		result.stackVars = stackVars;
+
+		auto overrides = function.findLocalOverrides();
+		for (auto& name : overrides.names)
+		{
+			result.names.emplace_back(name.first, name.second);
+		}
+		for (auto& type : overrides.types)
+		{
+			result.types.push_back(LocalType{ type.first, type.second.space, type.second.offset, addType(*type.second.type) });
+		}
+
+		m_functions[result.ea] = std::move(result);
+	}
+
+	/**********************************************************************/
+	const std::map<uint64_t, ExportDatabase::Function>& ExportDatabase::getFunctions() const noexcept
+	{
+		return m_functions;
+	}
+
+	/**********************************************************************/
+	void ExportDatabase::write(std::ostream& stream) const
+	{
+		if (!isHostSupported())
+		{
+			throw InvalidExport("big endian hosts are not supported");
+		}
+
+		StringPool strings;
+		SectionBuffer sections[SECTION_COUNT];
+
+		// bytes are streamed from the image, only their layout is computed here
+		uint64_t nbBytes = 0;
+		for (auto& entry : m_segments)
+		{
+			auto& segment = entry.second;
+			exportformat::Segment record{ segment.start, segment.end, NO_DATA, strings.add(segment.name), segment.perm, 0 };
+			if (segment.loaded)
+			{
+				record.data = nbBytes;
+				nbBytes += align(segment.end - segment.start);
+			}
+			sections[SECTION_SEGMENTS].push(record);
+		}
+
+		for (auto& symbol : m_symbols)
+		{
+			sections[SECTION_SYMBOLS].push(exportformat::Symbol{ symbol.first, strings.add(symbol.second.name), symbol.second.flags, 0 });
+		}
+
+		for (auto& import : m_imports)
+		{
+			sections[SECTION_IMPORTS].push(exportformat::Import{ import.first, strings.add(import.second.module), strings.add(import.second.name) });
+		}
+
+		for (auto& entry : m_functions)
+		{
+			auto& function = entry.second;
+			exportformat::Function record{};
+			record.ea = function.ea;
+			record.size = function.size;
+			record.contentHash = function.contentHash;
+			record.cloneHash = function.cloneHash;
+			record.flags = function.library ? FUNCTION_LIBRARY : 0;
+			record.name = strings.add(function.name);
+
+			record.firstStackVar = sections[SECTION_STACK_VARS].count();
+			for (auto& var : function.stackVars)
+			{
+				sections[SECTION_STACK_VARS].push(StackVar{ var.first, strings.add(var.second) });
+			}
+			record.stackVarCount = sections[SECTION_STACK_VARS].count() - record.firstStackVar;
+
+			record.firstName = sections[SECTION_NAMES].count();
+			for (auto& name : function.names)
+			{
+				sections[SECTION_NAMES].push(Name{ name.first, name.second.offset, strings.add(name.second.space), strings.add(name.second.name) });
+			}
+			record.nameCount = sections[SECTION_NAMES].count() - record.firstName;
+
+			record.firstLocalType = sections[SECTION_LOCAL_TYPES].count();
+			for (auto& type : function.types)
+			{
+				sections[SECTION_LOCAL_TYPES].push(exportformat::LocalType{ type.pc, type.offset, strings.add(type.space), type.type, 0 });
+			}
+			record.localTypeCount = sections[SECTION_LOCAL_TYPES].count() - record.firstLocalType;
+
+			sections[SECTION_FUNCTIONS].push(record);
+		}
+
+		for (auto& type : m_types)
+		{
+			exportformat::Type record{};
+			record.size = type.size;
+			record.name = strings.add(type.name);
+			record.flags = type.flags;
+			record.kind = KIND_NONE;
+			record.first = NO_TYPE;
+
+			if (type.func.has_value())
+			{
+				auto& func = type.func.value();
+				exportformat::Func part{};
+				part.name = strings.add(func.name);
+				part.callingConv = strings.add(func.callingConv.value_or(""));
+				part.hasCallingConv = func.callingConv.has_value();
+				part.dotDotDot = func.dotDotDot;
+
+				part.firstParam = sections[SECTION_TYPE_REFS].count();
+				for (auto param : func.prototype)
+				{
+					sections[SECTION_TYPE_REFS].push(param);
+				}
+				part.paramCount = static_cast<uint32_t>(func.prototype.size());
+
+				part.firstParamName = sections[SECTION_PARAM_NAMES].count();
+				for (auto& name : func.paramNames)
+				{
+					sections[SECTION_PARAM_NAMES].push(strings.add(name));
+				}
+				part.paramNameCount = static_cast<uint32_t>(func.paramNames.size());
+
+				record.kind = KIND_FUNC;
+				record.first = sections[SECTION_FUNCS].count();
+				sections[SECTION_FUNCS].push(part);
+			}
+			else if (type.fields.has_value())
+			{
+				record.kind = KIND_STRUCT;
+				record.first = sections[SECTION_FIELDS].count();
+				for (auto& field : type.fields.value())
+				{
+					sections[SECTION_FIELDS].push(exportformat::Field{ field.offset, strings.add(field.name), field.type, 0 });
+				}
+				record.count = type.fields.value().size();
+			}
+			else if (type.pointed.has_value())
+			{
+				record.kind = KIND_PTR;
+				record.first = type.pointed.value();
+			}
+			else if (type.array.has_value())
+			{
+				record.kind = KIND_ARRAY;
+				record.first = type.array.value().element;
+				record.count = type.array.value().count;
+			}
+
+			sections[SECTION_TYPES].push(record);
+		}
+
+		// sorted by name for a binary search in place
+		std::vector<std::pair<std::string, TypeIndex>> namedTypes(m_namedTypes.begin(), m_namedTypes.end());
+		std::sort(namedTypes.begin(), namedTypes.end());
+		for (auto& named : namedTypes)
+		{
+			sections[SECTION_NAMED_TYPES].push(NamedType{ strings.add(named.first), named.second, 0 });
+		}
+
+		for (auto& typed : m_typesByAddress)
+		{
+			sections[SECTION_TYPED_ADDRESSES].push(TypedAddress{ typed.first, typed.second, 0 });
+		}
+
+		// all strings are known
+		Header header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.language = static_cast<uint32_t>(m_compiler.language);
+		header.endianess = static_cast<uint32_t>(m_compiler.endianess);
+		header.mode = static_cast<uint32_t>(m_compiler.mode);
+		header.isa = static_cast<uint32_t>(m_compiler.isa);
+
+		uint64_t offset = sizeof(Header);
+		for (uint32_t i = 0; i < SECTION_COUNT; i++)
+		{
+			uint64_t size = sections[i].data().size();
+			uint64_t count = sections[i].count();
+			if (i == SECTION_STRINGS)
+			{
+				size = count = strings.data().size();
+			}
+			else if (i == SECTION_BYTES)
+			{
+				size = count = nbBytes;
+			}
+
+			header.sections[i] = exportformat::Section{ offset, count };
+			offset += align(size);
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		_WriteSection(stream, strings.data());
+
+		std::vector<uint8_t> buffer(EXPORT_CHUNK_SIZE);
+		for (auto& entry : m_segments)
+		{
+			auto& segment = entry.second;
+			if (!segment.loaded)
+			{
+				continue;
+			}
+
+			auto ea = segment.start;
+			auto size = segment.end - segment.start;
+			while (size > 0)
+			{
+				auto chunk = std::min<uint64_t>(size, buffer.size());
+				m_image.read(ea, buffer.data(), chunk);
+				stream.write(reinterpret_cast<const char*>(buffer.data()), chunk);
+				ea += chunk;
+				size -= chunk;
+			}
+			_WritePadding(stream, segment.end - segment.start);
+		}
+
+		for (uint32_t i = SECTION_BYTES + 1; i < SECTION_COUNT; i++)
+		{
+			_WriteSection(stream, sections[i].data());
+		}
+	}
+} // end of namespace yagi
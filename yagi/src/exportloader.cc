@@ -0,0 +1,40 @@
+#include "exportloader.hh"
+
+#define EXPORT_LOADER	"export"
+
+namespace yagi 
+{
+	/**********************************************************************/
+	ExportLoader::ExportLoader(std::shared_ptr<const ExportView> view)
+		: LoadImage(EXPORT_LOADER), m_view{ std::move(view) }
+	{}
+
+	/**********************************************************************/
+	std::string ExportLoader::getArchType(void) const
+	{
+		return EXPORT_LOADER;
+	}
+
+	/**********************************************************************/
+	void ExportLoader::loadFill(uint1* ptr, int4 size, const Address& addr)
+	{
+		m_view->read(addr.getOffset(), ptr, size);
+	}
+
+	/**********************************************************************/
+	void ExportLoader::adjustVma(long adjust)
+	{
+		throw LowlevelError("Cannot adjust YAGI virtual memory");
+	}
+
+	/**********************************************************************/
+	ExportLoaderFactory::ExportLoaderFactory(std::shared_ptr<const ExportView> view)
+		: m_view{ std::move(view) }
+	{}
+
+	/**********************************************************************/
+	LoadImage* ExportLoaderFactory::build()
+	{
+		return new ExportLoader(m_view);
+	}
+} // end of namespace yagi
@@ -0,0 +1,276 @@
+#include "exportsymbol.hh"
+#include "exporttype.hh"
+#include "exception.hh"
+
+#include <algorithm>
+
+namespace yagi
+{
+	using namespace exportformat;
+
+	/**********************************************************************/
+	ExportSymbolInfo::ExportSymbolInfo(std::shared_ptr<const ExportView> view, std::shared_ptr<const SegmentIndex> segments, uint64_t ea, std::string name, uint32_t flags)
+		: SymbolInfo(ea, std::move(name)), m_view{ std::move(view) }, m_segments{ std::move(segments) }, m_flags{ flags }
+	{}
+
+	/**********************************************************************/
+	uint64_t ExportSymbolInfo::getFunctionSize() const
+	{
+		auto function = m_view->findFunction(m_ea);
+		if (function == nullptr || function->ea != m_ea)
+		{
+			throw SymbolIsNotAFunction(m_name);
+		}
+		return function->size;
+	}
+
+	/**********************************************************************/
+	bool ExportSymbolInfo::isFunction() const noexcept
+	{
+		return (m_flags & SYMBOL_FUNCTION) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportSymbolInfo::isLabel() const noexcept
+	{
+		return (m_flags & SYMBOL_LABEL) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportSymbolInfo::isImport() const noexcept
+	{
+		return (m_flags & SYMBOL_IMPORT) != 0 || m_view->findImport(m_ea) != nullptr;
+	}
+
+	/**********************************************************************/
+	bool ExportSymbolInfo::isReadOnly() const noexcept
+	{
+		return m_segments->isReadOnly(m_ea);
+	}
+
+	/**********************************************************************/
+	ExportFunctionSymbolInfo::ExportFunctionSymbolInfo(std::shared_ptr<const ExportView> view, std::shared_ptr<const SegmentIndex> segments, const Function& function)
+		: FunctionSymbolInfo{ std::make_unique<ExportSymbolInfo>(view, std::move(segments), function.ea, std::string(view->getString(function.name)), SYMBOL_FUNCTION) },
+		m_view{ std::move(view) }, m_function{ &function }
+	{}
+
+	/**********************************************************************/
+	std::optional<std::string> ExportFunctionSymbolInfo::findStackVar(uint64_t offset, uint32_t addrSize)
+	{
+		auto stackVars = m_view->getStackVars(*m_function);
+		auto iter = std::lower_bound(stackVars.begin(), stackVars.end(), offset, [](const StackVar& var, uint64_t value) {
+			return var.offset < value;
+		});
+		if (iter != stackVars.end() && iter->offset == offset)
+		{
+			return std::string(m_view->getString(iter->name));
+		}
+
+		if (addrSize != 4)
+		{
+			return std::nullopt;
+		}
+
+		// Ghidra use 32 bits stack offset even for sign extended one
+		// first member in frame order wins, as in IDA
+		for (auto& var : stackVars)
+		{
+			if (static_cast<uint32_t>(var.offset) == static_cast<uint32_t>(offset))
+			{
+				return std::string(m_view->getString(var.name));
+			}
+		}
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::string> ExportFunctionSymbolInfo::findName(uint64_t pc, const std::string& space, uint64_t& offset)
+	{
+		for (auto& name : m_view->getNames(*m_function))
+		{
+			if (name.pc == pc && m_view->getString(name.space) == space)
+			{
+				offset = name.offset;
+				return std::string(m_view->getString(name.name));
+			}
+		}
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	void ExportFunctionSymbolInfo::saveName(const MemoryLocation& loc, const std::string& space)
+	{
+		// the export is read only
+	}
+
+	/**********************************************************************/
+	void ExportFunctionSymbolInfo::saveType(const MemoryLocation& loc, const TypeInfo& newType)
+	{
+		// the export is read only
+	}
+
+	/**********************************************************************/
+	bool ExportFunctionSymbolInfo::clearType(const MemoryLocation& loc)
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> ExportFunctionSymbolInfo::findType(uint64_t pc, const std::string& from, uint64_t& offset)
+	{
+		for (auto& type : m_view->getLocalTypes(*m_function))
+		{
+			if (type.pc == pc && m_view->getString(type.space) == from)
+			{
+				offset = type.offset;
+				return std::make_unique<ExportTypeInfo>(m_view, type.type);
+			}
+		}
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	LocalOverrides ExportFunctionSymbolInfo::findLocalOverrides()
+	{
+		LocalOverrides overrides;
+		for (auto& name : m_view->getNames(*m_function))
+		{
+			overrides.names.emplace(name.pc, NameOverride{ std::string(m_view->getString(name.space)), name.offset, std::string(m_view->getString(name.name)) });
+		}
+		for (auto& type : m_view->getLocalTypes(*m_function))
+		{
+			overrides.types.emplace(type.pc, TypeOverride{ std::string(m_view->getString(type.space)), type.offset, std::make_unique<ExportTypeInfo>(m_view, type.type) });
+		}
+		return overrides;
+	}
+
+	/**********************************************************************/
+	FlowHints ExportFunctionSymbolInfo::findFlowHints()
+	{
+		FlowHints hints;
+		hints.chunks.emplace_back(m_function->ea, m_function->ea + m_function->size);
+		return hints;
+	}
+
+	/**********************************************************************/
+	uint64_t ExportFunctionSymbolInfo::getContentHash()
+	{
+		return m_function->contentHash;
+	}
+
+	/**********************************************************************/
+	uint64_t ExportFunctionSymbolInfo::getCloneHash()
+	{
+		return m_function->cloneHash;
+	}
+
+	/**********************************************************************/
+	bool ExportFunctionSymbolInfo::isLibrary()
+	{
+		return (m_function->flags & FUNCTION_LIBRARY) != 0;
+	}
+
+	/**********************************************************************/
+	ExportSymbolInfoFactory::ExportSymbolInfoFactory(std::shared_ptr<const ExportView> view, std::unordered_set<std::string> readOnlyNames)
+		: m_view{ std::move(view) }
+	{
+		auto segments = std::make_shared<SegmentIndex>(std::move(readOnlyNames));
+		for (auto& segment : m_view->getSegments())
+		{
+			segments->add(segment.start, segment.end, std::string(m_view->getString(segment.name)), segment.perm);
+		}
+		m_segments = std::move(segments);
+	}
+
+	/**********************************************************************/
+	std::optional<ExportSymbolInfo> ExportSymbolInfoFactory::findSymbol(uint64_t ea) const
+	{
+		auto symbol = m_view->findSymbol(ea);
+		if (symbol != nullptr)
+		{
+			return ExportSymbolInfo(m_view, m_segments, ea, std::string(m_view->getString(symbol->name)), symbol->flags);
+		}
+
+		auto function = m_view->findFunction(ea);
+		if (function != nullptr && function->ea == ea && function->name.size != 0)
+		{
+			return ExportSymbolInfo(m_view, m_segments, ea, std::string(m_view->getString(function->name)), SYMBOL_FUNCTION);
+		}
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<SymbolInfo>> ExportSymbolInfoFactory::find(uint64_t ea)
+	{
+		auto symbol = findSymbol(ea);
+		if (!symbol.has_value())
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportSymbolInfo>(std::move(symbol.value()));
+	}
+
+	/**********************************************************************/
+	std::optional<SymbolRecord> ExportSymbolInfoFactory::find_record(uint64_t ea)
+	{
+		auto symbol = findSymbol(ea);
+		if (!symbol.has_value())
+		{
+			return std::nullopt;
+		}
+		return SymbolRecord(symbol.value());
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FunctionSymbolInfo>> ExportSymbolInfoFactory::find_function(uint64_t ea)
+	{
+		auto function = m_view->findFunction(ea);
+		if (function == nullptr)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportFunctionSymbolInfo>(m_view, m_segments, *function);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Name without its leading underscores
+	 */
+	static std::string_view _TrimUnderscores(std::string_view name)
+	{
+		auto first = name.find_first_not_of('_');
+		return first == std::string_view::npos ? std::string_view() : name.substr(first);
+	}
+
+	/**********************************************************************/
+	std::unordered_map<std::string, uint64_t> ExportSymbolInfoFactory::find_addresses(const std::vector<std::string>& names)
+	{
+		std::unordered_map<std::string_view, const std::string*> wanted;
+		for (auto& name : names)
+		{
+			wanted.emplace(_TrimUnderscores(name), &name);
+		}
+
+		std::unordered_map<std::string, uint64_t> result;
+		auto match = [&](uint64_t ea, std::string_view name) {
+			auto found = wanted.find(_TrimUnderscores(name));
+			if (found != wanted.end())
+			{
+				result.emplace(*found->second, ea);
+			}
+		};
+
+		for (auto& symbol : m_view->getSymbols())
+		{
+			match(symbol.ea, m_view->getString(symbol.name));
+		}
+		for (auto& function : m_view->getFunctions())
+		{
+			if (function.name.size != 0)
+			{
+				match(function.ea, m_view->getString(function.name));
+			}
+		}
+		return result;
+	}
+} // end of namespace yagi
@@ -0,0 +1,249 @@
+#include "exporttype.hh"
+#include "exception.hh"
+
+namespace yagi
+{
+	using namespace exportformat;
+
+	/**********************************************************************/
+	ExportTypeInfo::ExportTypeInfo(std::shared_ptr<const ExportView> view, uint32_t index)
+		: m_view{ std::move(view) }, m_index{ index }
+	{}
+
+	/**********************************************************************/
+	const Type& ExportTypeInfo::get() const
+	{
+		return m_view->getType(m_index);
+	}
+
+	/**********************************************************************/
+	size_t ExportTypeInfo::getSize() const
+	{
+		return get().size;
+	}
+
+	/**********************************************************************/
+	std::string ExportTypeInfo::getName() const
+	{
+		return std::string(m_view->getString(get().name));
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isInt() const
+	{
+		return (get().flags & TYPE_INT) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isBool() const
+	{
+		return (get().flags & TYPE_BOOL) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isFloat() const
+	{
+		return (get().flags & TYPE_FLOAT) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isVoid() const
+	{
+		return (get().flags & TYPE_VOID) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isConst() const
+	{
+		return (get().flags & TYPE_CONST) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isChar() const
+	{
+		return (get().flags & TYPE_CHAR) != 0;
+	}
+
+	/**********************************************************************/
+	bool ExportTypeInfo::isUnicode() const
+	{
+		return (get().flags & TYPE_UNICODE) != 0;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FuncInfo>> ExportTypeInfo::toFunc() const
+	{
+		auto& type = get();
+		if (type.kind != KIND_FUNC)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportFuncInfo>(m_view, m_view->getFunc(type));
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<StructInfo>> ExportTypeInfo::toStruct() const
+	{
+		auto& type = get();
+		if (type.kind != KIND_STRUCT)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportStructInfo>(m_view, m_view->getFields(type));
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<PtrInfo>> ExportTypeInfo::toPtr() const
+	{
+		auto& type = get();
+		if (type.kind != KIND_PTR)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportPtrInfo>(m_view, type.first);
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<ArrayInfo>> ExportTypeInfo::toArray() const
+	{
+		auto& type = get();
+		if (type.kind != KIND_ARRAY)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportArrayInfo>(m_view, type.first, type.count);
+	}
+
+	/**********************************************************************/
+	ExportFuncInfo::ExportFuncInfo(std::shared_ptr<const ExportView> view, const Func& func)
+		: m_view{ std::move(view) }, m_func{ &func }
+	{}
+
+	/**********************************************************************/
+	bool ExportFuncInfo::isDotDotDot() const
+	{
+		return m_func->dotDotDot != 0;
+	}
+
+	/**********************************************************************/
+	std::vector<std::unique_ptr<TypeInfo>> ExportFuncInfo::getFuncPrototype() const
+	{
+		auto params = m_view->getParams(*m_func);
+		std::vector<std::unique_ptr<TypeInfo>> result;
+		result.reserve(params.size());
+		for (auto index : params)
+		{
+			result.push_back(std::make_unique<ExportTypeInfo>(m_view, index));
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	std::vector<std::string> ExportFuncInfo::getFuncParamName() const
+	{
+		auto names = m_view->getParamNames(*m_func);
+		std::vector<std::string> result;
+		result.reserve(names.size());
+		for (auto& name : names)
+		{
+			result.emplace_back(m_view->getString(name));
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	std::string ExportFuncInfo::getCallingConv() const
+	{
+		if (m_func->hasCallingConv == 0)
+		{
+			throw UnknownCallingConvention(getName());
+		}
+		return std::string(m_view->getString(m_func->callingConv));
+	}
+
+	/**********************************************************************/
+	std::string ExportFuncInfo::getName() const
+	{
+		return std::string(m_view->getString(m_func->name));
+	}
+
+	/**********************************************************************/
+	ExportStructInfo::ExportStructInfo(std::shared_ptr<const ExportView> view, ExportView::Table<Field> fields)
+		: m_view{ std::move(view) }, m_fields{ fields }
+	{}
+
+	/**********************************************************************/
+	std::vector<TypeStructField> ExportStructInfo::getFields() const
+	{
+		std::vector<TypeStructField> result;
+		result.reserve(m_fields.size());
+		for (auto& field : m_fields)
+		{
+			result.push_back(TypeStructField{ field.offset, std::string(m_view->getString(field.name)), std::make_unique<ExportTypeInfo>(m_view, field.type) });
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	ExportPtrInfo::ExportPtrInfo(std::shared_ptr<const ExportView> view, uint32_t pointed)
+		: m_view{ std::move(view) }, m_pointed{ pointed }
+	{}
+
+	/**********************************************************************/
+	std::unique_ptr<TypeInfo> ExportPtrInfo::getPointedObject() const
+	{
+		return std::make_unique<ExportTypeInfo>(m_view, m_pointed);
+	}
+
+	/**********************************************************************/
+	ExportArrayInfo::ExportArrayInfo(std::shared_ptr<const ExportView> view, uint32_t element, uint64_t count)
+		: m_view{ std::move(view) }, m_element{ element }, m_count{ count }
+	{}
+
+	/**********************************************************************/
+	std::unique_ptr<TypeInfo> ExportArrayInfo::getPointedObject() const
+	{
+		return std::make_unique<ExportTypeInfo>(m_view, m_element);
+	}
+
+	/**********************************************************************/
+	uint64_t ExportArrayInfo::getSize() const
+	{
+		return m_count;
+	}
+
+	/**********************************************************************/
+	ExportTypeInfoFactory::ExportTypeInfoFactory(std::shared_ptr<const ExportView> view)
+		: m_view{ std::move(view) }
+	{}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> ExportTypeInfoFactory::build(const std::string& name)
+	{
+		auto index = m_view->findType(std::string_view(name));
+		if (!index.has_value())
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportTypeInfo>(m_view, index.value());
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> ExportTypeInfoFactory::build(uint64_t ea)
+	{
+		auto index = m_view->findType(ea);
+		if (!index.has_value())
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<ExportTypeInfo>(m_view, index.value());
+	}
+
+	/**********************************************************************/
+	void ExportTypeInfoFactory::invalidate(const std::string& name)
+	{}
+
+	/**********************************************************************/
+	void ExportTypeInfoFactory::invalidateAll()
+	{}
+} // end of namespace yagi
@@ -0,0 +1,471 @@
+#include "exportview.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yagi
+{
+	using namespace exportformat;
+
+	/*!
+	 * \brief	Size of a record of each section, 1 for byte sections
+	 */
+	static const size_t RECORD_SIZES[SECTION_COUNT] = {
+		1,						// SECTION_STRINGS
+		1,						// SECTION_BYTES
+		sizeof(Segment),		// SECTION_SEGMENTS
+		sizeof(Symbol),			// SECTION_SYMBOLS
+		sizeof(Import),			// SECTION_IMPORTS
+		sizeof(Function),		// SECTION_FUNCTIONS
+		sizeof(StackVar),		// SECTION_STACK_VARS
+		sizeof(Name),			// SECTION_NAMES
+		sizeof(LocalType),		// SECTION_LOCAL_TYPES
+		sizeof(Type),			// SECTION_TYPES
+		sizeof(Func),			// SECTION_FUNCS
+		sizeof(Field),			// SECTION_FIELDS
+		sizeof(uint32_t),		// SECTION_TYPE_REFS
+		sizeof(StringRef),		// SECTION_PARAM_NAMES
+		sizeof(NamedType),		// SECTION_NAMED_TYPES
+		sizeof(TypedAddress)	// SECTION_TYPED_ADDRESSES
+	};
+
+	/*!
+	 * \brief	A read only mapping of a whole file
+	 *			Unmapped when the last view is released
+	 */
+	class FileMapping
+	{
+	protected:
+		void* m_data = nullptr;
+		size_t m_size = 0;
+
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#endif
+
+	public:
+		explicit FileMapping(const std::filesystem::path& path)
+		{
+#ifdef _WIN32
+			m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_file == INVALID_HANDLE_VALUE)
+			{
+				throw InvalidExport("unable to open " + path.string());
+			}
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size))
+			{
+				CloseHandle(m_file);
+				throw InvalidExport("unable to read the size of " + path.string());
+			}
+			m_size = static_cast<size_t>(size.QuadPart);
+
+			// an empty file cannot be mapped, it is rejected by the view
+			if (m_size == 0)
+			{
+				return;
+			}
+
+			m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			m_data = m_mapping == nullptr ? nullptr : MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (m_data == nullptr)
+			{
+				if (m_mapping != nullptr)
+				{
+					CloseHandle(m_mapping);
+				}
+				CloseHandle(m_file);
+				throw InvalidExport("unable to map " + path.string());
+			}
+#else
+			auto fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				throw InvalidExport("unable to open " + path.string());
+			}
+
+			struct stat info;
+			if (fstat(fd, &info) != 0)
+			{
+				::close(fd);
+				throw InvalidExport("unable to read the size of " + path.string());
+			}
+			m_size = static_cast<size_t>(info.st_size);
+
+			if (m_size != 0)
+			{
+				m_data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+
+			// the mapping stays valid once the file is closed
+			::close(fd);
+			if (m_data == MAP_FAILED)
+			{
+				m_data = nullptr;
+				throw InvalidExport("unable to map " + path.string());
+			}
+#endif
+		}
+
+		~FileMapping()
+		{
+#ifdef _WIN32
+			if (m_data != nullptr)
+			{
+				UnmapViewOfFile(m_data);
+				CloseHandle(m_mapping);
+			}
+			CloseHandle(m_file);
+#else
+			if (m_data != nullptr)
+			{
+				munmap(m_data, m_size);
+			}
+#endif
+		}
+
+		FileMapping(const FileMapping&) = delete;
+		FileMapping& operator=(const FileMapping&) = delete;
+
+		const uint8_t* data() const noexcept
+		{
+			return static_cast<const uint8_t*>(m_data);
+		}
+
+		size_t size() const noexcept
+		{
+			return m_size;
+		}
+	};
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Binary search of the record starting at an address
+	 */
+	template<typename T>
+	static const T* _FindAt(const ExportView::Table<T>& table, uint64_t ea)
+	{
+		auto iter = std::lower_bound(table.begin(), table.end(), ea, [](const T& record, uint64_t value) {
+			return record.ea < value;
+		});
+		if (iter == table.end() || iter->ea != ea)
+		{
+			return nullptr;
+		}
+		return iter;
+	}
+
+	/**********************************************************************/
+	ExportView::ExportView(std::shared_ptr<const void> storage, const uint8_t* data, size_t size)
+		: m_storage{ std::move(storage) }, m_data{ data }, m_size{ size }
+	{
+		if (!isHostSupported())
+		{
+			throw InvalidExport("big endian hosts are not supported");
+		}
+
+		if (data == nullptr || size < sizeof(Header))
+		{
+			throw InvalidExport("not a Yagi export");
+		}
+
+		// the start of a mapping is page aligned, buffers come from the allocator
+		if (reinterpret_cast<uintptr_t>(data) % 8 != 0)
+		{
+			throw InvalidExport("unaligned export");
+		}
+
+		auto& header = *reinterpret_cast<const Header*>(data);
+		if (header.magic != MAGIC)
+		{
+			throw InvalidExport("not a Yagi export");
+		}
+
+		if (header.version != VERSION)
+		{
+			throw InvalidExport("unsupported version " + std::to_string(header.version));
+		}
+
+		if (header.language > static_cast<uint32_t>(Compiler::Language::Z80)
+			|| header.endianess > static_cast<uint32_t>(Compiler::Endianess::LE)
+			|| header.mode > static_cast<uint32_t>(Compiler::Mode::M64)
+			|| header.isa > static_cast<uint32_t>(Compiler::Isa::Mips16))
+		{
+			throw InvalidExport("unknown compiler");
+		}
+
+		for (uint32_t i = 0; i < SECTION_COUNT; i++)
+		{
+			auto& section = header.sections[i];
+			if (section.offset % 8 != 0 || section.offset > size
+				|| section.count > (size - section.offset) / RECORD_SIZES[i])
+			{
+				throw InvalidExport("section " + std::to_string(i) + " out of bounds");
+			}
+			m_sections[i] = std::make_pair(data + section.offset, static_cast<size_t>(section.count));
+		}
+
+		// string references are checked on access, only 32 bits offsets are used
+		if (m_sections[SECTION_STRINGS].second > UINT32_MAX)
+		{
+			throw InvalidExport("string pool is too large");
+		}
+	}
+
+	/**********************************************************************/
+	std::shared_ptr<const ExportView> ExportView::open(const std::filesystem::path& path)
+	{
+		auto mapping = std::make_shared<const FileMapping>(path);
+		auto data = mapping->data();
+		auto size = mapping->size();
+		return std::shared_ptr<const ExportView>(new ExportView(std::move(mapping), data, size));
+	}
+
+	/**********************************************************************/
+	std::shared_ptr<const ExportView> ExportView::fromBuffer(std::vector<uint8_t> buffer)
+	{
+		auto storage = std::make_shared<const std::vector<uint8_t>>(std::move(buffer));
+		auto data = storage->data();
+		auto size = storage->size();
+		return std::shared_ptr<const ExportView>(new ExportView(std::move(storage), data, size));
+	}
+
+	/**********************************************************************/
+	Compiler ExportView::getCompiler() const noexcept
+	{
+		auto& header = *reinterpret_cast<const Header*>(m_data);
+		return Compiler(
+			static_cast<Compiler::Language>(header.language),
+			static_cast<Compiler::Endianess>(header.endianess),
+			static_cast<Compiler::Mode>(header.mode),
+			static_cast<Compiler::Isa>(header.isa)
+		);
+	}
+
+	/**********************************************************************/
+	std::string_view ExportView::getString(const StringRef& ref) const
+	{
+		auto& strings = m_sections[SECTION_STRINGS];
+		if (ref.offset > strings.second || ref.size > strings.second - ref.offset)
+		{
+			throw InvalidExport("string out of bounds");
+		}
+		return std::string_view(reinterpret_cast<const char*>(strings.first) + ref.offset, ref.size);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<Segment> ExportView::getSegments() const noexcept
+	{
+		return table<Segment>(SECTION_SEGMENTS);
+	}
+
+	/**********************************************************************/
+	const Segment* ExportView::findSegment(uint64_t ea) const
+	{
+		auto segments = getSegments();
+		auto iter = std::upper_bound(segments.begin(), segments.end(), ea, [](uint64_t value, const Segment& segment) {
+			return value < segment.start;
+		});
+		if (iter == segments.begin())
+		{
+			return nullptr;
+		}
+
+		--iter;
+		if (ea >= iter->end)
+		{
+			return nullptr;
+		}
+		return iter;
+	}
+
+	/**********************************************************************/
+	size_t ExportView::read(uint64_t ea, uint8_t* buffer, size_t size) const
+	{
+		auto& bytes = m_sections[SECTION_BYTES];
+		size_t result = 0;
+		while (size > 0)
+		{
+			auto segment = findSegment(ea);
+			if (segment == nullptr)
+			{
+				// up to the next segment or the end of the request
+				auto segments = getSegments();
+				auto next = std::upper_bound(segments.begin(), segments.end(), ea, [](uint64_t value, const Segment& segment) {
+					return value < segment.start;
+				});
+				auto chunk = next == segments.end() ? size : static_cast<size_t>(std::min<uint64_t>(size, next->start - ea));
+				std::memset(buffer, 0, chunk);
+				buffer += chunk;
+				ea += chunk;
+				size -= chunk;
+				continue;
+			}
+
+			auto chunk = static_cast<size_t>(std::min<uint64_t>(size, segment->end - ea));
+			auto offset = segment->data + (ea - segment->start);
+			if (segment->data == NO_DATA || offset > bytes.second || chunk > bytes.second - offset)
+			{
+				std::memset(buffer, 0, chunk);
+			}
+			else
+			{
+				std::memcpy(buffer, bytes.first + offset, chunk);
+				result += chunk;
+			}
+			buffer += chunk;
+			ea += chunk;
+			size -= chunk;
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	ExportView::Table<Symbol> ExportView::getSymbols() const noexcept
+	{
+		return table<Symbol>(SECTION_SYMBOLS);
+	}
+
+	/**********************************************************************/
+	const Symbol* ExportView::findSymbol(uint64_t ea) const
+	{
+		return _FindAt(table<Symbol>(SECTION_SYMBOLS), ea);
+	}
+
+	/**********************************************************************/
+	const Import* ExportView::findImport(uint64_t ea) const
+	{
+		return _FindAt(table<Import>(SECTION_IMPORTS), ea);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<Function> ExportView::getFunctions() const noexcept
+	{
+		return table<Function>(SECTION_FUNCTIONS);
+	}
+
+	/**********************************************************************/
+	const Function* ExportView::findFunction(uint64_t ea) const
+	{
+		auto functions = getFunctions();
+		auto iter = std::upper_bound(functions.begin(), functions.end(), ea, [](uint64_t value, const Function& function) {
+			return value < function.ea;
+		});
+		if (iter == functions.begin())
+		{
+			return nullptr;
+		}
+
+		--iter;
+
+		// a function without body only holds its entry point
+		if (iter->size == 0 ? ea != iter->ea : ea - iter->ea >= iter->size)
+		{
+			return nullptr;
+		}
+		return iter;
+	}
+
+	/**********************************************************************/
+	ExportView::Table<StackVar> ExportView::getStackVars(const Function& function) const
+	{
+		return table<StackVar>(SECTION_STACK_VARS).slice(function.firstStackVar, function.stackVarCount);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<Name> ExportView::getNames(const Function& function) const
+	{
+		return table<Name>(SECTION_NAMES).slice(function.firstName, function.nameCount);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<LocalType> ExportView::getLocalTypes(const Function& function) const
+	{
+		return table<LocalType>(SECTION_LOCAL_TYPES).slice(function.firstLocalType, function.localTypeCount);
+	}
+
+	/**********************************************************************/
+	const Type& ExportView::getType(uint32_t index) const
+	{
+		auto types = table<Type>(SECTION_TYPES);
+		if (index >= types.size())
+		{
+			throw UnableToFindType(index);
+		}
+		return types[index];
+	}
+
+	/**********************************************************************/
+	const Func& ExportView::getFunc(const Type& type) const
+	{
+		if (type.kind != KIND_FUNC)
+		{
+			throw InvalidExport("type is not a function");
+		}
+		return table<Func>(SECTION_FUNCS).slice(type.first, 1)[0];
+	}
+
+	/**********************************************************************/
+	ExportView::Table<uint32_t> ExportView::getParams(const Func& func) const
+	{
+		return table<uint32_t>(SECTION_TYPE_REFS).slice(func.firstParam, func.paramCount);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<StringRef> ExportView::getParamNames(const Func& func) const
+	{
+		return table<StringRef>(SECTION_PARAM_NAMES).slice(func.firstParamName, func.paramNameCount);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<Field> ExportView::getFields(const Type& type) const
+	{
+		if (type.kind != KIND_STRUCT)
+		{
+			throw InvalidExport("type is not a structure");
+		}
+		return table<Field>(SECTION_FIELDS).slice(type.first, type.count);
+	}
+
+	/**********************************************************************/
+	ExportView::Table<NamedType> ExportView::getNamedTypes() const noexcept
+	{
+		return table<NamedType>(SECTION_NAMED_TYPES);
+	}
+
+	/**********************************************************************/
+	std::optional<uint32_t> ExportView::findType(std::string_view name) const
+	{
+		auto named = table<NamedType>(SECTION_NAMED_TYPES);
+		auto iter = std::lower_bound(named.begin(), named.end(), name, [this](const NamedType& record, std::string_view value) {
+			return getString(record.name) < value;
+		});
+		if (iter == named.end() || getString(iter->name) != name)
+		{
+			return std::nullopt;
+		}
+		return iter->type;
+	}
+
+	/**********************************************************************/
+	std::optional<uint32_t> ExportView::findType(uint64_t ea) const
+	{
+		auto typed = _FindAt(table<TypedAddress>(SECTION_TYPED_ADDRESSES), ea);
+		if (typed == nullptr)
+		{
+			return std::nullopt;
+		}
+		return typed->type;
+	}
+} // end of namespace yagi
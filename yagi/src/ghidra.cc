@@ -2,12 +2,26 @@
 #include "exception.hh"
 
 #include <libdecomp.hh>
+#include <mutex>
+#include <set>
 
 namespace yagi 
 {
 	/**********************************************************************/
 	void ghidra::init(const std::string& ghidraPath)
 	{
+		// processors are scanned again on each call
+		// but the library state is kept by the process
+		static std::mutex initMutex;
+		static std::set<std::string> initialized;
+
+		std::lock_guard<std::mutex> lock(initMutex);
+		if (initialized.find(ghidraPath) != initialized.end())
+		{
+			return;
+		}
+
 		startDecompilerLibrary(ghidraPath.c_str());
+		initialized.insert(ghidraPath);
 	}
 } // end of namespace yagi
\ No newline at end of file
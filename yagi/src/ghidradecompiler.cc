@@ -2,25 +2,138 @@
 #include "architecture.hh"
 #include "scope.hh"
 #include "typeinfo.hh"
+#include "typemanager.hh"
 #include "symbolinfo.hh"
 #include "exception.hh"
-#include "idaloader.hh"
 #include "print.hh"
 #include "base.hh"
 #include "yagiaction.hh"
 #include "yagirule.hh"
+#include "profile.hh"
+#include "memory.hh"
+#include "prototype.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory_resource>
+#include <set>
+#include <sstream>
+#include <vector>
 
 namespace yagi 
 {
+	/*!
+	 * \brief	First block of the arena of an op index
+	 *			enough for most functions
+	 */
+	static const size_t OP_INDEX_ARENA_SIZE = 0x10000;
+
+	/*!
+	 * \brief	First line of the output of a function analyzed
+	 *			in large function mode
+	 */
+	static const char* const LARGE_FUNCTION_HEADER = "// Yagi: large function, simplified analysis";
+
+	/*!
+	 * \brief	Percentage of the memory limit under which caches
+	 *			can be released again
+	 */
+	static const size_t MEMORY_LOW_WATERMARK = 75;
+
+	/*!
+	 * \brief	Minimal delay between two reports of released caches
+	 */
+	static const std::chrono::seconds MEMORY_LOG_INTERVAL(60);
+
+	/**********************************************************************/
+	GhidraDecompiler::GhidraDecompiler(std::unique_ptr<YagiArchitecture> architecture, ResultCache cache, size_t memoryLimit)
+		: m_architecture(std::move(architecture)), m_cache(std::move(cache)), m_stale{ false }, m_memoryLimit{ memoryLimit }
+	{
+
+	}
+
 	/**********************************************************************/
-	GhidraDecompiler::GhidraDecompiler(std::unique_ptr<YagiArchitecture> architecture)
-		: m_architecture(std::move(architecture))
+	void GhidraDecompiler::setTokenStream(bool enabled) noexcept
 	{
+		m_tokenStream = enabled;
+	}
+
+	/**********************************************************************/
+	struct GhidraDecompiler::OpIndex
+	{
+		/*!
+		 * \brief	address of ops reading each storage location
+		 */
+		std::pmr::map<Address, std::pmr::vector<uint64_t>> uses;
+
+		/*!
+		 * \brief	constants that are address of a RAM symbol
+		 *			indexed by their printed value
+		 */
+		std::pmr::map<std::string, MemoryLocation> constants;
+
+		/*!
+		 * \brief	every container is allocated from the arena
+		 */
+		explicit OpIndex(std::pmr::memory_resource* arena)
+			: uses{ arena }, constants{ arena }
+		{}
+
+		std::pmr::memory_resource* getArena() const
+		{
+			return uses.get_allocator().resource();
+		}
+	};
+
+	/**********************************************************************/
+	void GhidraDecompiler::indexOps(const Funcdata& data, OpIndex& index, bool uses) const
+	{
+		auto arch = static_cast<YagiArchitecture*>(data.getArch());
+		auto codeSpace = arch->getDefaultCodeSpace();
+
+		// the symbol database is only queried once per value
+		std::pmr::set<uint64_t> visited(index.getArena());
 
+		auto iter = data.beginOp(data.getAddress());
+		while (iter != data.endOp(data.getAddress() + data.getSize()))
+		{
+			auto op = iter->second;
+			for (auto i = 0; i < op->numInput(); i++)
+			{
+				auto varnode = op->getIn(i);
+				if (uses)
+				{
+					index.uses[varnode->getAddr()].push_back(op->getAddr().getOffset());
+				}
+
+				// only pointer sized constants can be an address
+				if (!varnode->isConstant() || varnode->getSize() != codeSpace->getAddrSize())
+				{
+					continue;
+				}
+
+				auto value = varnode->getOffset();
+				if (value == 0 || !visited.insert(value).second)
+				{
+					continue;
+				}
+
+				if (arch->findSymbol(value) != nullptr)
+				{
+					index.constants.emplace(
+						to_hex(value),
+						MemoryLocation("ram", value, codeSpace->getAddrSize())
+					);
+				}
+			}
+			iter++;
+		}
 	}
 
 	/**********************************************************************/
-	void GhidraDecompiler::findVarSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const
+	void GhidraDecompiler::findVarSymbols(const Funcdata& data, const OpIndex& index, SymbolIndex& symbols) const
 	{
 		auto iter = data.beginDef();
 		while (iter != data.endDef())
@@ -31,7 +144,8 @@ namespace yagi
 				if (
 					varnode->getHigh() != nullptr &&
 					varnode->getHigh()->getSymbol() != nullptr &&
-					varnode->getHigh()->getNameRepresentative() != nullptr 
+					varnode->getHigh()->getNameRepresentative() != nullptr &&
+					!symbols.hasVariable(varnode->getHigh()->getSymbol())
 					)
 				{
 					auto high = varnode->getHigh();
@@ -47,9 +161,7 @@ namespace yagi
 							nameRepr->getAddr().getAddrSize()
 						);
 						loc.pc.push_back(def->getAddr().getOffset());
-						symbols.emplace(sym->getName(),
-							loc
-						);
+						symbols.addVariable(sym, std::move(loc));
 					}
 					else {
 						MemoryLocation loc(
@@ -59,23 +171,12 @@ namespace yagi
 						);
 
 						// no name representative, so const (merge multiple variable)
-						auto itOp = data.beginOp(data.getAddress());
-						while (itOp != data.endOp(data.getAddress() + data.getSize()))
+						auto found = index.uses.find(varnode->getAddr());
+						if (found != index.uses.end())
 						{
-							auto op = itOp->second;
-							for (auto i = 0; i < op->numInput(); i++)
-							{
-								auto tmpVn = op->getIn(i);
-								if (varnode->getAddr() == tmpVn->getAddr())
-								{
-									loc.pc.push_back(op->getAddr().getOffset());
-								}
-							}
-							++itOp;
+							loc.pc.assign(found->second.begin(), found->second.end());
 						}
-						symbols.emplace(sym->getName(),
-							loc
-						);
+						symbols.addVariable(sym, std::move(loc));
 					}
 				}
 			}
@@ -85,10 +186,10 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	void GhidraDecompiler::findFunctionSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const
+	void GhidraDecompiler::findFunctionSymbols(const Funcdata& data, SymbolIndex& symbols) const
 	{
 		// first we add the local function symbol
-		symbols.emplace(data.getName(),
+		symbols.addNamed(data.getName(),
 			MemoryLocation(
 				"ram",
 				data.getAddress().getOffset(),
@@ -111,7 +212,7 @@ namespace yagi
 				name = name.substr(SymbolInfo::IMPORT_PREFIX.length(), name.length() - SymbolInfo::IMPORT_PREFIX.length());
 			}
 
-			symbols.emplace(name,
+			symbols.addNamed(name,
 				MemoryLocation(
 					"ram", 
 					call->getEntryAddress().getOffset(), 
@@ -122,32 +223,77 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	void GhidraDecompiler::findConstantSymbols(const Funcdata& data, std::map<std::string, MemoryLocation>& symbols) const
+	void GhidraDecompiler::findConstantSymbols(const OpIndex& index, SymbolIndex& symbols) const
 	{
-		auto iter = data.beginOp(data.getAddress());
-		while (iter != data.endOp(data.getAddress() + data.getSize()))
+		// variables and functions keep precedence over raw values
+		for (auto& constant : index.constants)
 		{
-			auto op = iter->second;
-			for (auto i = 0; i < op->numInput(); i++)
-			{
-				auto varnode = op->getIn(i);
-				if (varnode->isConstant())
-				{
-					MemoryLocation loc(
-						varnode->getAddr().getSpace()->getName(),
-						varnode->getAddr().getOffset(),
-						varnode->getAddr().getSpace()->getAddrSize()
-					);
-					loc.pc.push_back(op->getAddr().getOffset());
-					
-				}
-			}
-			iter++;
+			symbols.addNamed(constant.first, constant.second);
+		}
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::findSymbols(const Funcdata& data, SymbolIndex& symbols, bool uses) const
+	{
+		// the walk allocates many small nodes, all freed at once
+		std::pmr::monotonic_buffer_resource arena(OP_INDEX_ARENA_SIZE);
+		OpIndex index(&arena);
+		indexOps(data, index, uses);
+
+		findVarSymbols(data, index, symbols);
+		findFunctionSymbols(data, symbols);
+		findConstantSymbols(index, symbols);
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> GhidraDecompiler::profiled(uint64_t funcAddress, const std::function<std::optional<Result>()>& run)
+	{
+		// nested calls are accounted into the running profile
+		if (m_profile == nullptr || Profile::current() != nullptr)
+		{
+			return run();
+		}
+
+		Profile profile(funcAddress);
+		std::optional<Result> result;
+		{
+			ProfileSession session(profile);
+			result = run();
+		}
+		profile.close();
+
+		if (result.has_value())
+		{
+			profile.setName(result.value().name);
+		}
+
+		try
+		{
+			m_profile->write(profile);
+		}
+		catch (Error& e)
+		{
+			m_architecture->getLogger().error(e.what());
 		}
+		return result;
 	}
 
 	/**********************************************************************/
 	std::optional<Decompiler::Result> GhidraDecompiler::decompile(uint64_t funcAddress)
+	{
+		auto result = profiled(funcAddress, [this, funcAddress]() { return analyze(funcAddress); });
+		checkMemory();
+		return result;
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> GhidraDecompiler::refreshNames(uint64_t funcAddress)
+	{
+		return profiled(funcAddress, [this, funcAddress]() { return refresh(funcAddress); });
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> GhidraDecompiler::analyze(uint64_t funcAddress)
 	{
 		try
 		{
@@ -159,46 +305,98 @@ namespace yagi
 				return nullopt;
 			}
 
-			auto scope = m_architecture->symboltab->getGlobalScope();
-			// clear scope to update all symbols
-			scope->clear();
+			// actions of this decompilation read the function from here
+			auto& function = m_architecture->setContext(std::move(funcSym.value())).getFunction();
 
-			// clear type factory
-			m_architecture->types->clearNoncore();
+			// nothing changed since the last decompilation
+			std::optional<uint64_t> hash;
+			if (m_cache.isEnabled())
+			{
+				hash = function.getContentHash();
+				auto cached = m_cache.find(function.getSymbol().getAddress(), hash.value());
+				if (cached.has_value())
+				{
+					return cached;
+				}
+			}
 
-			auto func = scope->findFunction(
+			auto address = function.getSymbol().getAddress();
+			prepareScope(address);
+
+			// translated types are kept until one of them change
+			{
+				ProfileScope scope("types", "TypeManager::sync");
+				static_cast<TypeManager*>(m_architecture->types)->sync();
+			}
+
+			auto func = m_architecture->symboltab->getGlobalScope()->findFunction(
 				Address(
 					m_architecture->getDefaultCodeSpace(), 
-					funcSym.value()->getSymbol().getAddress()
+					address
 				)
 			);
 
+			m_analyzed.erase(address);
 			m_architecture->clearAnalysis(func);
-			m_architecture->performActions(*func);
+			m_architecture->setDeadline(true);
 
-			// now we compute symbols
-			std::map<std::string, MemoryLocation> symbols;
-			findVarSymbols(*func, symbols);
-			findFunctionSymbols(*func, symbols);
-			findConstantSymbols(*func, symbols);
-			
-			m_architecture->setPrintLanguage("yagi-c-language");
+			auto seeded = m_architecture->seedFlow(*func);
+			if (seeded != 0)
+			{
+				m_architecture->getLogger().debug("Jump tables resolved by the backend: ", seeded);
+			}
+
+			auto large = m_architecture->isLargeFunction(function.getSymbol().getFunctionSize());
+			try
+			{
+				if (!large)
+				{
+					try
+					{
+						m_architecture->performActions(*func);
+					}
+					catch (LargeFunction& e)
+					{
+						// the op count is only known once the flow is built
+						m_architecture->getLogger().info(e.what(), " at ", to_hex(funcAddress));
+						m_architecture->clearAnalysis(func);
+						large = true;
+					}
+				}
 
-			stringstream ss;
-			m_architecture->print->setIndentIncrement(3);
-			m_architecture->print->setOutputStream(&ss);
+				if (large)
+				{
+					m_architecture->getLogger().info("Large function, simplified analysis of ", to_hex(funcAddress));
+					m_architecture->performLargeActions(*func);
+				}
 
-			//print as C
-			m_architecture->print->docFunction(func);
+				// symbol lookups of the printer must not discard the analysis
+				m_architecture->setDeadline(false);
+			}
+			catch (DecompilationTimeout& e)
+			{
+				// show something rather than nothing
+				// never cached and never refreshed, not added to m_analyzed
+				m_architecture->getLogger().info(e.what(), ", simplified output for ", to_hex(funcAddress));
+				m_architecture->clearAnalysis(func);
+				m_architecture->performFallbackActions(*func);
 
-			// get back context information
+				// parameters are not recovered by the simplified analysis
+				auto result = print(function, *func, std::nullopt, large);
+				result.prototype.reset();
+				m_architecture->clearAnalysis(func);
+				return result;
+			}
+			catch (DecompilationCanceled&)
+			{
+				// the scope may be kept, don't hold an incomplete dataflow
+				m_architecture->clearAnalysis(func);
+				throw;
+			}
 
-			return Decompiler::Result(
-				funcSym.value()->getSymbol().getName(), 
-				funcSym.value()->getSymbol().getAddress(),
-				ss.str(), 
-				symbols
-			);
+			auto result = print(function, *func, hash, large);
+			m_analyzed[address] = { result.dependencies, large };
+			return result;
 		}
 		
 		catch (LowlevelError& e)
@@ -206,6 +404,12 @@ namespace yagi
 			m_architecture->getLogger().error(e.explain);
 			return nullopt;
 		}
+		catch (DecompilationCanceled& e)
+		{
+			// the analysis is incomplete, not added to m_analyzed
+			m_architecture->getLogger().info(e.what(), to_hex(funcAddress));
+			return nullopt;
+		}
 		catch (Error& e)
 		{
 			m_architecture->getLogger().error(e.what());
@@ -218,6 +422,442 @@ namespace yagi
 		}
 	}
 
+	/**********************************************************************/
+	std::optional<Decompiler::Result> GhidraDecompiler::refresh(uint64_t funcAddress)
+	{
+		try
+		{
+			auto funcSym = m_architecture->getSymbolDatabase().find_function(funcAddress);
+			if (!funcSym.has_value())
+			{
+				m_architecture->getLogger().info("Unable to find a function at ", to_hex(funcAddress));
+				return nullopt;
+			}
+
+			// dataflow of another function, or no dataflow at all
+			auto analyzed = m_analyzed.find(funcSym.value()->getSymbol().getAddress());
+			if (analyzed == m_analyzed.end())
+			{
+				return decompile(funcAddress);
+			}
+
+			auto func = m_architecture->symboltab->getGlobalScope()->findFunction(
+				Address(
+					m_architecture->getDefaultCodeSpace(),
+					funcSym.value()->getSymbol().getAddress()
+				)
+			);
+
+			if (func == nullptr)
+			{
+				return decompile(funcAddress);
+			}
+
+			// stored names are read again by rename actions
+			// symbols resolved by the analysis are not looked up again
+			auto& context = m_architecture->setContext(std::move(funcSym.value()));
+			context.addDependencies(analyzed->second.dependencies);
+			auto& function = context.getFunction();
+
+			std::optional<uint64_t> hash;
+			if (m_cache.isEnabled())
+			{
+				hash = function.getContentHash();
+			}
+
+			m_architecture->performRenameActions(*func);
+			return print(function, *func, hash, analyzed->second.large);
+		}
+		catch (LowlevelError& e)
+		{
+			m_architecture->getLogger().error(e.explain);
+			return nullopt;
+		}
+		catch (DecompilationCanceled& e)
+		{
+			// the rename pass is incomplete, the next refresh runs it again
+			m_architecture->getLogger().info(e.what(), to_hex(funcAddress));
+			return nullopt;
+		}
+		catch (Error& e)
+		{
+			m_architecture->getLogger().error(e.what());
+			return nullopt;
+		}
+		catch (std::exception& e)
+		{
+			m_architecture->getLogger().error(e.what());
+			return nullopt;
+		}
+	}
+
+	/**********************************************************************/
+	static std::shared_ptr<const RecoveredTypeInfo> _RecoverType(Datatype* type, uint32_t depth)
+	{
+		auto size = static_cast<size_t>(type->getSize());
+		auto named = !type->getName().empty() && !type->isCoreType();
+
+		switch (type->getMetatype())
+		{
+		case TYPE_PTR:
+		{
+			// pointers to pointers are cut, cycles are possible through typedefs
+			auto pointed = depth < 4
+				? _RecoverType(static_cast<TypePointer*>(type)->getPtrTo(), depth + 1)
+				: std::make_shared<const RecoveredTypeInfo>("void", 0, RecoveredTypeInfo::VOID);
+			return std::make_shared<const RecoveredTypeInfo>(named ? type->getName() : pointed->getName() + " *", size, 0, pointed);
+		}
+		case TYPE_VOID:
+		case TYPE_CODE:
+			return std::make_shared<const RecoveredTypeInfo>("void", 0, RecoveredTypeInfo::VOID);
+		case TYPE_BOOL:
+			return std::make_shared<const RecoveredTypeInfo>(named ? type->getName() : "bool", size, RecoveredTypeInfo::BOOL);
+		case TYPE_FLOAT:
+			return std::make_shared<const RecoveredTypeInfo>(
+				named ? type->getName() : (size == 4 ? "float" : (size == 8 ? "double" : "long double")),
+				size, RecoveredTypeInfo::FLOAT
+			);
+		case TYPE_INT:
+		case TYPE_UINT:
+			if (type->isCharPrint() && size == 1)
+			{
+				return std::make_shared<const RecoveredTypeInfo>(named ? type->getName() : "char", size, RecoveredTypeInfo::CHAR);
+			}
+			if (type->isCharPrint() && size == 2)
+			{
+				return std::make_shared<const RecoveredTypeInfo>(named ? type->getName() : "wchar_t", size, RecoveredTypeInfo::UNICODE);
+			}
+			return std::make_shared<const RecoveredTypeInfo>(
+				named ? type->getName() : std::string(type->getMetatype() == TYPE_UINT ? "unsigned " : "") + "__int" + std::to_string(size * 8),
+				size, RecoveredTypeInfo::INT
+			);
+		case TYPE_UNKNOWN:
+			if (!named)
+			{
+				// same names as the IDA output
+				switch (size)
+				{
+				case 1: return std::make_shared<const RecoveredTypeInfo>("_BYTE", size, 0);
+				case 2: return std::make_shared<const RecoveredTypeInfo>("_WORD", size, 0);
+				case 4: return std::make_shared<const RecoveredTypeInfo>("_DWORD", size, 0);
+				case 8: return std::make_shared<const RecoveredTypeInfo>("_QWORD", size, 0);
+				case 16: return std::make_shared<const RecoveredTypeInfo>("_OWORD", size, 0);
+				default: return nullptr;
+				}
+			}
+			return std::make_shared<const RecoveredTypeInfo>(type->getName(), size, 0);
+		default:
+			// structures and arrays are found again by name
+			if (!named)
+			{
+				return nullptr;
+			}
+			return std::make_shared<const RecoveredTypeInfo>(type->getName(), size, 0);
+		}
+	}
+
+	/**********************************************************************/
+	static std::shared_ptr<const Prototype> _RecoverPrototype(const std::string& name, Funcdata& func)
+	{
+		auto& proto = func.getFuncProto();
+		auto prototype = std::make_shared<Prototype>();
+		prototype->name = name;
+		prototype->dotDotDot = proto.isDotdotdot();
+
+		auto model = proto.getModelName();
+		if (model == "__cdecl" || model == "__stdcall" || model == "__fastcall" || model == "__thiscall")
+		{
+			prototype->callingConv = model;
+		}
+
+		// a prototype is only useful if all its parts can be expressed
+		auto output = _RecoverType(proto.getOutputType(), 0);
+		if (output == nullptr)
+		{
+			return nullptr;
+		}
+		prototype->types.push_back(*output);
+		prototype->names.push_back("");
+
+		for (int4 i = 0; i < proto.numParams(); i++)
+		{
+			auto param = proto.getParam(i);
+			auto type = _RecoverType(param->getType(), 0);
+			if (type == nullptr)
+			{
+				return nullptr;
+			}
+			prototype->types.push_back(*type);
+			prototype->names.push_back(param->getName().empty() ? "param_" + std::to_string(i + 1) : param->getName());
+		}
+		return prototype;
+	}
+
+	/**********************************************************************/
+	Decompiler::Result GhidraDecompiler::print(FunctionSymbolInfo& funcSym, Funcdata& func, const std::optional<uint64_t>& hash, bool large)
+	{
+		// now we compute symbols
+		// use addresses of large functions are too many to be collected
+		SymbolIndex symbols;
+		{
+			ProfileScope scope("output", "findSymbols");
+			findSymbols(func, symbols, !large);
+		}
+		ProfileScope scope("output", "print");
+		
+		m_architecture->setPrintLanguage("yagi-c-language");
+		auto& emitter = static_cast<IdaPrint*>(m_architecture->print)->getEmitter();
+		emitter.setSymbolIndex(&symbols);
+
+		// the emitter writes directly into the result
+		std::string code;
+		StringBuffer buffer(code);
+		std::ostream stream(&buffer);
+		m_architecture->print->setIndentIncrement(3);
+		m_architecture->print->setOutputStream(&stream);
+
+		// written before the function so tokens are located on the whole output
+		if (large)
+		{
+			stream << LARGE_FUNCTION_HEADER << "\n";
+		}
+
+		//print as C
+		m_architecture->print->docFunction(&func);
+		m_architecture->print->setOutputStream(nullptr);
+
+		// tokens are located once the whole output is flushed
+		auto tokens = indexTokens(code, emitter.getTags(), m_tokenStream);
+		emitter.setSymbolIndex(nullptr);
+
+		// get back context information
+		Decompiler::Result result(
+			funcSym.getSymbol().getName(), 
+			funcSym.getSymbol().getAddress(),
+			std::move(code), 
+			symbols.release(),
+			std::move(tokens)
+		);
+		result.prototype = _RecoverPrototype(funcSym.getSymbol().getName(), func);
+
+		auto context = m_architecture->findContext(funcSym.getSymbol().getAddress());
+		if (context != nullptr)
+		{
+			result.dependencies = context->getDependencies();
+		}
+
+		if (hash.has_value())
+		{
+			m_cache.insert(hash.value(), result);
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::checkMemory()
+	{
+		if (m_memoryLimit == 0)
+		{
+			return;
+		}
+
+		auto usage = getProcessMemory();
+		if (!usage.has_value())
+		{
+			return;
+		}
+
+		if (usage.value() < m_memoryLimit / 100 * MEMORY_LOW_WATERMARK)
+		{
+			m_memoryReleased = 0;
+		}
+
+		// freed pages kept by the allocator are not a reason to release again
+		if (usage.value() <= m_memoryLimit || (m_memoryReleased != 0 && usage.value() <= m_memoryReleased + m_memoryLimit / 100 * (100 - MEMORY_LOW_WATERMARK)))
+		{
+			return;
+		}
+		m_memoryReleased = usage.value();
+
+		// the next refresh runs a full decompilation
+		m_analyzed.clear();
+		m_architecture->symboltab->getGlobalScope()->clear();
+		m_architecture->clearSymbolCache();
+		m_architecture->clearLiftCache();
+
+		// translated types are dropped by the next sync
+		static_cast<TypeManager*>(m_architecture->types)->invalidateAll();
+
+		auto now = std::chrono::steady_clock::now();
+		if (m_memoryLogged != std::chrono::steady_clock::time_point() && now - m_memoryLogged < MEMORY_LOG_INTERVAL)
+		{
+			m_memoryUnlogged++;
+			return;
+		}
+
+		m_architecture->getLogger().info("Memory limit reached (", formatMemory(usage.value()), "), cached symbols, types and translations released ", m_memoryUnlogged + 1, " time(s)");
+		m_memoryLogged = now;
+		m_memoryUnlogged = 0;
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::prepareScope(uint64_t funcAddress)
+	{
+		auto types = static_cast<TypeManager*>(m_architecture->types);
+		auto shown = std::any_of(m_analyzed.begin(), m_analyzed.end(), [this, funcAddress](const auto& analyzed) {
+			return analyzed.first != funcAddress && m_retained.find(analyzed.first) != m_retained.end();
+		});
+
+		// kept analyses point to symbols and types of the scope
+		if (m_stale || types->isStale() || !shown)
+		{
+			m_analyzed.clear();
+			m_architecture->symboltab->getGlobalScope()->clear();
+			m_stale = false;
+			return;
+		}
+
+		std::vector<uint64_t> hidden;
+		for (auto& [ea, analysis] : m_analyzed)
+		{
+			if (m_retained.find(ea) == m_retained.end())
+			{
+				hidden.push_back(ea);
+			}
+		}
+
+		for (auto ea : hidden)
+		{
+			releaseAnalysis(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::releaseAnalysis(uint64_t funcAddress)
+	{
+		if (m_analyzed.erase(funcAddress) == 0)
+		{
+			return;
+		}
+
+		// only look into the scope, never load a new function
+		auto scope = static_cast<YagiScope*>(m_architecture->symboltab->getGlobalScope());
+		auto func = scope->getProxy()->findFunction(Address(m_architecture->getDefaultCodeSpace(), funcAddress));
+		if (func != nullptr)
+		{
+			m_architecture->clearAnalysis(func);
+		}
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::invalidate(uint64_t funcAddress)
+	{
+		m_cache.invalidate(funcAddress);
+		releaseAnalysis(funcAddress);
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::invalidateDependents(uint64_t ea)
+	{
+		m_cache.invalidateDependents(ea);
+		m_architecture->invalidateSymbol(ea);
+
+		// the old symbol is still held by the global scope
+		m_analyzed.clear();
+		m_stale = true;
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::invalidateCode(uint64_t ea)
+	{
+		m_architecture->invalidateCode(ea);
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::clearCache()
+	{
+		m_cache.clear();
+		m_architecture->clearSymbolCache();
+		m_architecture->clearLiftCache();
+
+		// kept analyses read the old database, the scope is cleared by the next one
+		m_analyzed.clear();
+		m_stale = true;
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::retain(uint64_t funcAddress)
+	{
+		m_retained[funcAddress]++;
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::release(uint64_t funcAddress)
+	{
+		auto iter = m_retained.find(funcAddress);
+		if (iter == m_retained.end())
+		{
+			return;
+		}
+
+		if (--iter->second == 0)
+		{
+			m_retained.erase(iter);
+			releaseAnalysis(funcAddress);
+		}
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::invalidateType(const std::string& name)
+	{
+		auto types = static_cast<TypeManager*>(m_architecture->types);
+		m_architecture->getTypeInfoFactory().invalidate(name);
+		types->invalidate(name);
+		m_cache.invalidateType(name);
+
+		// kept analyses point to types dropped by the next sync
+		if (types->isStale())
+		{
+			m_analyzed.clear();
+		}
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::invalidateTypes()
+	{
+		m_architecture->getTypeInfoFactory().invalidateAll();
+		static_cast<TypeManager*>(m_architecture->types)->invalidateAll();
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::setCancelToken(std::shared_ptr<const CancelToken> token)
+	{
+		m_architecture->setCancelToken(std::move(token));
+	}
+
+	/**********************************************************************/
+	void GhidraDecompiler::setProfileOutput(std::shared_ptr<ProfileOutput> output)
+	{
+		m_profile = std::move(output);
+	}
+
+	/**********************************************************************/
+	size_t GhidraDecompiler::prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names)
+	{
+		ProfileScope scope("types", "GhidraDecompiler::prewarmTypes");
+		auto types = static_cast<TypeManager*>(m_architecture->types);
+
+		// same as a decompilation, changed types are dropped before
+		if (types->isStale())
+		{
+			m_analyzed.clear();
+			m_architecture->symboltab->getGlobalScope()->clear();
+		}
+		types->sync();
+
+		return types->prewarm(source, names);
+	}
+
 	/**********************************************************************/
 	std::string GhidraDecompiler::compute_sleigh_id(const Compiler& compilerType) noexcept {
 
@@ -338,6 +978,24 @@ namespace yagi
 		return language + ":" + endianess + ":" + mode + ":" + languageMeta;
 	}
 
+	/**********************************************************************/
+	std::string GhidraDecompiler::compute_architecture_key(const Compiler& compilerType) noexcept
+	{
+		auto key = compute_sleigh_id(compilerType);
+		switch (compilerType.isa)
+		{
+		case Compiler::Isa::Thumb:
+			key += ":thumb";
+			break;
+		case Compiler::Isa::Mips16:
+			key += ":mips16";
+			break;
+		default:
+			break;
+		}
+		return key;
+	}
+
 	/**********************************************************************/
 	std::string GhidraDecompiler::compute_default_cc(const Compiler& compilerType)
 	{
@@ -357,21 +1015,44 @@ namespace yagi
 		throw NoDefaultCallingConvention();
 	}
 
+	/**********************************************************************/
+	static void _LogStartup(Logger& logger, const YagiArchitecture::StartupTimings& timings, std::chrono::steady_clock::time_point start)
+	{
+		auto total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::stringstream message;
+		message << std::fixed << std::setprecision(1)
+			<< "architecture loaded in " << total << " ms ("
+			<< "spec files " << timings.specFiles << " ms, "
+			<< "parse " << timings.specParse << " ms in background, "
+			<< "loader " << timings.loader << " ms, "
+			<< "core types " << timings.types << " ms, "
+			<< "waiting for the parse " << timings.specWait << " ms, "
+			<< "actions " << timings.actions << " ms)";
+		logger.info(message.str());
+	}
+
 	/**********************************************************************/
 	std::optional<std::unique_ptr<Decompiler>> GhidraDecompiler::build(
 		const Compiler& compilerType,
+		const Options& options,
+		std::unique_ptr<LoaderFactory> loaderFactory,
 		std::unique_ptr<Logger> logger, 
 		std::unique_ptr<SymbolInfoFactory> symbolDatabase, 
-		std::unique_ptr<TypeInfoFactory> typeDatabase
+		std::unique_ptr<TypeInfoFactory> typeDatabase,
+		std::unique_ptr<ResultStore> resultStore
 	) noexcept
 	{
 		auto sleighId = compute_sleigh_id(compilerType);
-		logger->info("load compiler with sleigh id : " + sleighId);
+		logger->info("load compiler with sleigh id : " + compute_architecture_key(compilerType));
 
+		// spec files are parsed into the store by a background thread of init
+		// it must outlive the architecture if init fails
+		DocumentStorage store;
 		auto architecture = std::make_unique<YagiArchitecture>(
 			"", 
 			sleighId,
-			std::make_unique<IdaLoaderFactory>(),
+			std::move(loaderFactory),
 			std::move(logger), 
 			std::move(symbolDatabase), 
 			std::move(typeDatabase),
@@ -385,7 +1066,11 @@ namespace yagi
 		case Compiler::Language::X86_GCC:
 		case Compiler::Language::X86_WINDOWS:
 			architecture->addInjection("alloca_probe", "alloca_probe");
-			architecture->extra_pool_rules.push_back(new RuleWindowsControlFlowGuard("analysis", "guard_dispatch_icall_fptr"));
+			if (compilerType.mode == Compiler::Mode::M64)
+			{
+				architecture->addCallWrapper({ "guard_dispatch_icall_fptr", "RAX" });
+			}
+			architecture->extra_pool_rules.push_back(new RuleCallWrapper("analysis"));
 			break;
 		case Compiler::Language::MIPS:
 			architecture->addArchAction(new ActionMIPST9Optimization("t9optim"));
@@ -394,9 +1079,37 @@ namespace yagi
 
 		try
 		{
-			DocumentStorage store;
+			auto start = std::chrono::steady_clock::now();
 			architecture->init(store);
-			return std::make_unique<GhidraDecompiler>(std::move(architecture));
+			_LogStartup(architecture->getLogger(), architecture->getStartupTimings(), start);
+
+			// the whole architecture decodes the alternate instruction set
+			switch (compilerType.isa)
+			{
+			case Compiler::Isa::Thumb:
+				architecture->context->setVariableDefault("TMode", 1);
+				break;
+			case Compiler::Isa::Mips16:
+				architecture->context->setVariableDefault("ISA_MODE", 1);
+				break;
+			default:
+				break;
+			}
+
+			architecture->setLargeFunctionLimits({
+				options.largeFunctionSize,
+				options.largeFunctionOps,
+				options.largeFunctionPasses
+			});
+			architecture->setFlowSeeding(options.seedFlow);
+
+			auto decompiler = std::make_unique<GhidraDecompiler>(
+				std::move(architecture), 
+				ResultCache(options.cacheSize, std::move(resultStore)),
+				options.memoryLimit * 1024 * 1024
+			);
+			decompiler->setTokenStream(options.tokenStream);
+			return decompiler;
 		}
 		catch (LowlevelError& e)
 		{
@@ -404,4 +1117,4 @@ namespace yagi
 			return std::nullopt;
 		}
 	}
-} // end of namespace yagi
\ No newline at end of file
+} // end of namespace yagi
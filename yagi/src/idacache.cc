@@ -0,0 +1,108 @@
+#include "idacache.hh"
+#include <idp.hpp>
+#include <netnode.hpp>
+
+#define YAGI_RESULT_NODE	"$ yagi.packed"
+#define YAGI_RESULT_TAG		'Z'
+#define YAGI_HASH_TAG		'H'
+#define YAGI_DEPENDENCY_TAG	'D'
+
+// uncompressed results of previous versions, without index
+#define YAGI_LEGACY_RESULT_NODE	"$ yagi.results"
+
+namespace yagi 
+{
+	/**********************************************************************/
+	std::unordered_map<uint64_t, ResultBlobs::IndexEntry> IdaResultBlobs::readIndex()
+	{
+		netnode legacy(YAGI_LEGACY_RESULT_NODE);
+		if (legacy != BADNODE)
+		{
+			legacy.kill();
+		}
+
+		std::unordered_map<uint64_t, IndexEntry> index;
+		netnode n(YAGI_RESULT_NODE);
+		if (n == BADNODE)
+		{
+			return index;
+		}
+
+		// without dependencies a result could never be invalidated
+		std::vector<nodeidx_t> outdated;
+		for (auto ea = n.supfirst(YAGI_HASH_TAG); ea != BADNODE; ea = n.supnext(ea, YAGI_HASH_TAG))
+		{
+			uint64_t hash;
+			bytevec_t blob;
+			if (n.supval(ea, &hash, sizeof(hash), YAGI_HASH_TAG) != sizeof(hash) || n.getblob(&blob, ea, YAGI_DEPENDENCY_TAG) < 0)
+			{
+				outdated.push_back(ea);
+				continue;
+			}
+
+			auto dependencies = deserializeDependencies(std::vector<uint8_t>(blob.begin(), blob.end()));
+			if (!dependencies.has_value())
+			{
+				outdated.push_back(ea);
+				continue;
+			}
+			index.emplace(ea, IndexEntry{ hash, std::move(dependencies.value()) });
+		}
+
+		for (auto ea : outdated)
+		{
+			n.delblob(ea, YAGI_RESULT_TAG);
+			n.delblob(ea, YAGI_DEPENDENCY_TAG);
+			n.supdel(ea, YAGI_HASH_TAG);
+		}
+		return index;
+	}
+
+	/**********************************************************************/
+	std::optional<std::vector<uint8_t>> IdaResultBlobs::read(uint64_t ea)
+	{
+		netnode n(YAGI_RESULT_NODE);
+		if (n == BADNODE)
+		{
+			return std::nullopt;
+		}
+
+		bytevec_t blob;
+		if (n.getblob(&blob, ea, YAGI_RESULT_TAG) <= 0)
+		{
+			return std::nullopt;
+		}
+		return std::vector<uint8_t>(blob.begin(), blob.end());
+	}
+
+	/**********************************************************************/
+	void IdaResultBlobs::write(const std::vector<Entry>& entries)
+	{
+		netnode n(YAGI_RESULT_NODE, 0, true);
+		for (auto& entry : entries)
+		{
+			if (entry.data.empty())
+			{
+				n.delblob(entry.ea, YAGI_RESULT_TAG);
+				n.delblob(entry.ea, YAGI_DEPENDENCY_TAG);
+				n.supdel(entry.ea, YAGI_HASH_TAG);
+				continue;
+			}
+
+			auto dependencies = serializeDependencies(entry.dependencies);
+			n.setblob(entry.data.data(), entry.data.size(), entry.ea, YAGI_RESULT_TAG);
+			n.setblob(dependencies.data(), dependencies.size(), entry.ea, YAGI_DEPENDENCY_TAG);
+			n.supset(entry.ea, &entry.hash, sizeof(entry.hash), YAGI_HASH_TAG);
+		}
+	}
+
+	/**********************************************************************/
+	void IdaResultBlobs::clear()
+	{
+		netnode n(YAGI_RESULT_NODE);
+		if (n != BADNODE)
+		{
+			n.kill();
+		}
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "idaexport.hh"
+#include "idaimage.hh"
+#include "idasymbol.hh"
+#include "idatype.hh"
+#include "exception.hh"
+
+#include <idp.hpp>
+#include <bytes.hpp>
+#include <funcs.hpp>
+#include <segment.hpp>
+#include <typeinf.hpp>
+#include <nalt.hpp>
+
+#include <sstream>
+
+namespace yagi
+{
+	/*!
+	 * \brief	State of the import enumeration of a module
+	 */
+	struct ImportContext
+	{
+		ExportDatabase& database;
+		std::string module;
+	};
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Export segments with their permissions
+	 *			IDA permissions use the same bits as exportformat::SegmentPerm
+	 */
+	static void _ExportSegments(ExportDatabase& database)
+	{
+		for (int i = 0; i < get_segm_qty(); i++)
+		{
+			auto seg = getnseg(i);
+			if (seg == nullptr)
+			{
+				continue;
+			}
+
+			qstring name;
+			get_segm_name(&name, seg);
+
+			ExportDatabase::Segment segment;
+			segment.start = seg->start_ea;
+			segment.end = seg->end_ea;
+			segment.name = name.c_str();
+			segment.perm = seg->perm & (SEGPERM_EXEC | SEGPERM_WRITE | SEGPERM_READ);
+			segment.loaded = seg->type != SEG_BSS;
+			database.addSegment(std::move(segment));
+		}
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Export the import table, module by module
+	 */
+	static void _ExportImports(ExportDatabase& database)
+	{
+		for (uint i = 0; i < get_import_module_qty(); i++)
+		{
+			qstring module;
+			get_import_module_name(&module, i);
+
+			ImportContext context{ database, module.c_str() };
+			enum_import_names(i,
+				[](ea_t ea, const char* name, uval_t ord, void* param) {
+					// imports by ordinal have no name
+					if (name != nullptr)
+					{
+						auto context = static_cast<ImportContext*>(param);
+						context->database.addImport(ea, ExportDatabase::Import{ context->module, name });
+					}
+					return 1;
+				}, &context
+			);
+		}
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Export every type of the local type library
+	 */
+	static void _ExportLocalTypes(ExportDatabase& database, IdaTypeInfoFactory& types)
+	{
+		auto til = get_idati();
+		for (uint32 ordinal = 1; ordinal < get_ordinal_qty(til); ordinal++)
+		{
+			tinfo_t idaType;
+			if (!idaType.get_numbered_type(til, ordinal))
+			{
+				continue;
+			}
+
+			try
+			{
+				auto type = types.build(idaType);
+				if (type.has_value())
+				{
+					database.addType(*type.value());
+				}
+			}
+			catch (Error&) {}
+		}
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Export prototypes of imported functions with the types they use
+	 */
+	static void _ExportImportTypes(ExportDatabase& database, IdaTypeInfoFactory& types)
+	{
+		std::vector<ea_t> imports;
+		for (uint i = 0; i < get_import_module_qty(); i++)
+		{
+			enum_import_names(i,
+				[](ea_t ea, const char* name, uval_t ord, void* param) {
+					static_cast<std::vector<ea_t>*>(param)->push_back(ea);
+					return 1;
+				}, &imports
+			);
+		}
+
+		for (auto ea : imports)
+		{
+			try
+			{
+				auto type = types.build(ea);
+				if (type.has_value())
+				{
+					database.addTypeAt(ea, *type.value());
+				}
+			}
+			catch (Error&) {}
+		}
+	}
+
+	/**********************************************************************/
+	void exportIdaDatabase(std::shared_ptr<IdaImportIndex> imports, ExportDatabase& database)
+	{
+		captureIdaImage(database.getImage());
+		_ExportSegments(database);
+		_ExportImports(database);
+
+		// read only state is computed again from exported segments
+		IdaSymbolInfoFactory symbols(imports, std::make_shared<IdaSegmentIndex>(), std::make_shared<IdaNameCache>());
+		IdaTypeInfoFactory types;
+
+		// every named head, dummy names included, as get_name would return them
+		for (int i = 0; i < get_segm_qty(); i++)
+		{
+			auto seg = getnseg(i);
+			if (seg == nullptr)
+			{
+				continue;
+			}
+
+			for (ea_t ea = seg->start_ea; ea != BADADDR && ea < seg->end_ea; ea = next_head(ea, seg->end_ea))
+			{
+				if (!has_any_name(get_flags(ea)))
+				{
+					continue;
+				}
+
+				try
+				{
+					auto symbol = symbols.find(ea);
+					if (symbol.has_value())
+					{
+						database.addSymbol(*symbol.value());
+					}
+
+					auto type = types.build(ea);
+					if (type.has_value())
+					{
+						database.addTypeAt(ea, *type.value());
+					}
+				}
+				catch (Error&)
+				{
+					// the symbol is left to the default analysis of Ghidra
+				}
+			}
+		}
+
+		for (size_t i = 0; i < get_func_qty(); i++)
+		{
+			auto func = getn_func(i);
+			if (func == nullptr)
+			{
+				continue;
+			}
+
+			try
+			{
+				auto function = symbols.find_function(func->start_ea);
+				if (!function.has_value())
+				{
+					continue;
+				}
+
+				// created by the IDA factory
+				auto idaFunction = static_cast<IdaFunctionSymbolInfo*>(function.value().get());
+				database.addFunction(*idaFunction, idaFunction->getStackVarNames());
+
+				auto type = types.build(func->start_ea);
+				if (type.has_value())
+				{
+					database.addTypeAt(func->start_ea, *type.value());
+				}
+			}
+			catch (Error&)
+			{
+				// the function is not exported
+			}
+		}
+
+		// local types not reachable from a symbol can still be named by a user type
+		_ExportLocalTypes(database, types);
+	}
+
+	/**********************************************************************/
+	std::shared_ptr<const ExportView> snapshotIdaDatabase(std::shared_ptr<IdaImportIndex> imports, const Compiler& compiler)
+	{
+		std::string content;
+		{
+			ExportDatabase database(compiler);
+			exportIdaDatabase(std::move(imports), database);
+
+			std::stringstream stream;
+			database.write(stream);
+			content = stream.str();
+		}
+		return ExportView::fromBuffer(std::vector<uint8_t>(content.begin(), content.end()));
+	}
+
+	/**********************************************************************/
+	std::shared_ptr<const ExportView> snapshotIdaTypes(const Compiler& compiler)
+	{
+		std::string content;
+		{
+			ExportDatabase database(compiler);
+			IdaTypeInfoFactory types;
+			_ExportImportTypes(database, types);
+			_ExportLocalTypes(database, types);
+
+			std::stringstream stream;
+			database.write(stream);
+			content = stream.str();
+		}
+		return ExportView::fromBuffer(std::vector<uint8_t>(content.begin(), content.end()));
+	}
+} // end of namespace yagi
@@ -0,0 +1,58 @@
+#include "idaimage.hh"
+#include <idp.hpp>
+#include <segment.hpp>
+#include <bytes.hpp>
+#include <algorithm>
+
+/*!
+ * \brief	Max number of bytes read at once
+ */
+#define CAPTURE_CHUNK_SIZE	0x100000
+
+namespace yagi 
+{
+	/**********************************************************************/
+	void captureIdaImage(MemoryImage& image)
+	{
+		image.clear();
+
+		size_t total = 0;
+		for (int i = 0; i < get_segm_qty(); i++)
+		{
+			auto seg = getnseg(i);
+			if (seg != nullptr && seg->type != SEG_BSS)
+			{
+				total += seg->size();
+			}
+		}
+		image.reserve(total);
+
+		for (int i = 0; i < get_segm_qty(); i++)
+		{
+			auto seg = getnseg(i);
+			if (seg == nullptr || seg->type == SEG_BSS)
+			{
+				continue;
+			}
+			updateIdaImage(image, seg->start_ea, seg->size());
+		}
+	}
+
+	/**********************************************************************/
+	void updateIdaImage(MemoryImage& image, uint64_t ea, size_t size)
+	{
+		std::vector<uint8_t> buffer(std::min<size_t>(size, CAPTURE_CHUNK_SIZE));
+		while (size > 0)
+		{
+			auto chunk = std::min<size_t>(size, buffer.size());
+			auto read = get_bytes(buffer.data(), chunk, ea);
+			if (read > 0)
+			{
+				image.write(ea, buffer.data(), read);
+			}
+
+			ea += chunk;
+			size -= chunk;
+		}
+	}
+} // end of namespace yagi
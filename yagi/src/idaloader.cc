@@ -10,6 +10,9 @@
 
 extern "C" int64_t __stdcall get_bytes(void* buf, int64_t size, uint64_t ea, int gmb_flags = 0, void* mask = NULL);
 
+// from bytes.hpp, don't stop at the first uninitialized byte
+#define GMB_READALL 0x01
+
 #define IDA_LOADER	"ida"
 
 namespace yagi 
@@ -28,7 +31,8 @@ namespace yagi
 	/**********************************************************************/
 	void IdaLoader::loadFill(uint1* ptr, int4 size, const Address& addr)
 	{
-		::get_bytes(ptr, size, addr.getOffset());
+		// whole pages are read by CachedLoader, they may start before a segment
+		::get_bytes(ptr, size, addr.getOffset(), GMB_READALL);
 	}
 
 	/**********************************************************************/
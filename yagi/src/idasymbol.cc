@@ -7,84 +7,240 @@
 #include <frame.hpp>
 #include <struct.hpp>
 #include <name.hpp>
+#include <bytes.hpp>
+#include <funcs.hpp>
+#include <nalt.hpp>
+#include <segment.hpp>
+#include <typeinf.hpp>
+#include <ua.hpp>
+#include <xref.hpp>
 #include <sstream>
+#include <algorithm>
 
 namespace yagi 
 {
 	/**********************************************************************/
-	std::optional<std::unique_ptr<SymbolInfo>> IdaSymbolInfoFactory::find(uint64_t ea)
+	const ImportIndex& IdaImportIndex::get()
 	{
-		qstring name;
-		if (get_name(&name, ea) == 0 || name.size() == 0)
+		if (m_isBuilt)
 		{
-			return std::nullopt;
+			return m_index;
 		}
-		return std::make_unique<IdaSymbolInfo>(ea, name.c_str());
+
+		m_index.clear();
+		for (uint i = 0; i < get_import_module_qty(); i++)
+		{
+			enum_import_names(i,
+				[](ea_t ea, const char* name, uval_t ord, void* param) {
+					// imports by ordinal have no name
+					if (name != nullptr)
+					{
+						static_cast<ImportIndex*>(param)->add(ea, name);
+					}
+					return 1;
+				}, &m_index
+			);
+		}
+		m_isBuilt = true;
+		return m_index;
 	}
 
 	/**********************************************************************/
-	std::optional<std::unique_ptr<FunctionSymbolInfo>> IdaSymbolInfoFactory::find_function(uint64_t ea)
+	void IdaImportIndex::invalidate() noexcept
 	{
-		auto idaFunc = get_func(ea);
-		if (idaFunc == nullptr)
+		m_isBuilt = false;
+	}
+
+	/**********************************************************************/
+	IdaSegmentIndex::IdaSegmentIndex(std::unordered_set<std::string> readOnlyNames)
+		: m_index{ std::move(readOnlyNames) }
+	{}
+
+	/**********************************************************************/
+	const SegmentIndex& IdaSegmentIndex::get()
+	{
+		if (m_isBuilt)
 		{
-			return std::nullopt;
+			return m_index;
 		}
 
-		qstring idaName;
-		get_short_name(&idaName, idaFunc->start_ea);
-		auto beginParameter = idaName.find("(");
-		auto functionName = split(idaName.substr(0, beginParameter).c_str(), ' ').back();
+		m_index.clear();
+		for (int i = 0; i < get_segm_qty(); i++)
+		{
+			auto seg = getnseg(i);
+			if (seg == nullptr)
+			{
+				continue;
+			}
 
-		return std::make_unique<IdaFunctionSymbolInfo>(std::make_unique<IdaSymbolInfo>(idaFunc->start_ea, functionName));
+			qstring name;
+			get_segm_name(&name, seg);
+			m_index.add(seg->start_ea, seg->end_ea, name.c_str(), seg->perm);
+		}
+		m_isBuilt = true;
+		return m_index;
 	}
 
 	/**********************************************************************/
-	IdaSymbolInfo::IdaSymbolInfo(uint64_t ea, std::string name)
-		: SymbolInfo(ea, name) 
+	void IdaSegmentIndex::invalidate() noexcept
+	{
+		m_isBuilt = false;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Cleaned and demangled name of a symbol
+	 */
+	static std::string _DisplayName(uint64_t ea, const std::string& name, bool isImport)
+	{
+		qstring pname;
+		if (name.substr(0, 4) == "sub_" || !cleanup_name(&pname, ea, name.c_str()))
+		{
+			pname = name.c_str();
+		}
+
+		qstring idaName = demangle_name(pname.c_str(), 0x0EA3BE67);
+		if (idaName != "")
+		{
+			auto pp = idaName.find('(', 0);
+			if (pp == qstring::npos)
+			{
+				pp = idaName.size();
+			}
+
+			pname = idaName.substr(0, pp);
+		}
+
+		// Mark import symbol with IDA convention
+		if (isImport) {
+			return SymbolInfo::IMPORT_PREFIX + pname.c_str();
+		}
+
+		return pname.c_str();
+	}
+
+	/**********************************************************************/
+	const std::string& IdaNameCache::getDisplayName(uint64_t ea, const std::string& name, bool isImport)
+	{
+		auto& entry = m_entries[ea];
+		if (!entry.displayName.has_value() || entry.name != name)
+		{
+			entry.name = name;
+			entry.displayName = _DisplayName(ea, name, isImport);
+		}
+		return entry.displayName.value();
+	}
+
+	/**********************************************************************/
+	const std::string& IdaNameCache::getFunctionName(uint64_t ea)
+	{
+		auto& entry = m_entries[ea];
+		if (!entry.functionName.has_value())
+		{
+			qstring idaName;
+			get_short_name(&idaName, ea);
+			auto beginParameter = idaName.find("(");
+			entry.functionName = split(idaName.substr(0, beginParameter).c_str(), ' ').back();
+		}
+		return entry.functionName.value();
+	}
+
+	/**********************************************************************/
+	void IdaNameCache::invalidate(uint64_t ea) noexcept
+	{
+		m_entries.erase(ea);
+	}
+
+	/**********************************************************************/
+	void IdaNameCache::invalidateAll() noexcept
+	{
+		m_entries.clear();
+	}
+
+	/**********************************************************************/
+	IdaSymbolInfoFactory::IdaSymbolInfoFactory()
+		: m_imports{ std::make_shared<IdaImportIndex>() }, m_segments{ std::make_shared<IdaSegmentIndex>() }, m_names{ std::make_shared<IdaNameCache>() }
 	{}
 
 	/**********************************************************************/
-	bool IdaSymbolInfo::isFunction() const noexcept
+	IdaSymbolInfoFactory::IdaSymbolInfoFactory(std::shared_ptr<IdaImportIndex> imports, std::shared_ptr<IdaSegmentIndex> segments, std::shared_ptr<IdaNameCache> names)
+		: m_imports{ std::move(imports) }, m_segments{ std::move(segments) }, m_names{ std::move(names) }
+	{}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<SymbolInfo>> IdaSymbolInfoFactory::find(uint64_t ea)
 	{
-		auto idaFunc = get_func(m_ea);
-		return idaFunc != nullptr && idaFunc->start_ea == m_ea;
+		qstring name;
+		if (get_name(&name, ea) == 0 || name.size() == 0)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<IdaSymbolInfo>(ea, name.c_str(), *m_imports, *m_segments, *m_names);
 	}
 
 	/**********************************************************************/
-	bool IdaSymbolInfo::isImport() const noexcept
+	std::optional<SymbolRecord> IdaSymbolInfoFactory::find_record(uint64_t ea)
 	{
-		std::string importName = m_name;
-		if (importName.length() > 6 && importName.substr(0, 6) == IMPORT_PREFIX)
+		qstring name;
+		if (get_name(&name, ea) == 0 || name.size() == 0)
 		{
-			importName = importName.substr(6, importName.length() - 6);
+			return std::nullopt;
 		}
+		return SymbolRecord(IdaSymbolInfo(ea, name.c_str(), *m_imports, *m_segments, *m_names));
+	}
 
-		for (uint i = 0; i < get_import_module_qty(); i++)
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FunctionSymbolInfo>> IdaSymbolInfoFactory::find_function(uint64_t ea)
+	{
+		auto idaFunc = get_func(ea);
+		if (idaFunc == nullptr)
 		{
-			auto found = enum_import_names(i,
-				[](ea_t ea, const char* name, uval_t ord, void* param) {
-					if (name != nullptr && *static_cast<std::string*>(param) == name)
-					{
-						return 0;
-					}
-					return 1;
-				}, &importName
-			);
+			return std::nullopt;
+		}
+
+		auto& functionName = m_names->getFunctionName(idaFunc->start_ea);
+		return std::make_unique<IdaFunctionSymbolInfo>(std::make_unique<IdaSymbolInfo>(idaFunc->start_ea, functionName, *m_imports, *m_segments, *m_names));
+	}
+
+	/**********************************************************************/
+	std::unordered_map<std::string, uint64_t> IdaSymbolInfoFactory::find_addresses(const std::vector<std::string>& names)
+	{
+		static const char* const PREFIXES[] = { "", "_", "__" };
 
-			if (found != -1 && found != 1)
+		std::unordered_map<std::string, uint64_t> result;
+		for (auto& name : names)
+		{
+			for (auto prefix : PREFIXES)
 			{
-				return true;
+				auto ea = get_name_ea(BADADDR, (prefix + name).c_str());
+				if (ea != BADADDR)
+				{
+					result.emplace(name, ea);
+					break;
+				}
 			}
 		}
-		return false;
+		return result;
 	}
 
 	/**********************************************************************/
-	bool IdaSymbolInfo::isLabel() const noexcept
+	/*!
+	 * \brief	Is there a function starting at this address
+	 */
+	static bool _IsFunction(uint64_t ea)
+	{
+		auto idaFunc = get_func(ea);
+		return idaFunc != nullptr && idaFunc->start_ea == ea;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Is this address the target of a jump
+	 */
+	static bool _IsLabel(uint64_t ea)
 	{
 		xrefblk_t xr;
-		for (bool success = xr.first_to((ea_t)m_ea, XREF_ALL); success; success = xr.next_to()) {
+		for (bool success = xr.first_to((ea_t)ea, XREF_ALL); success; success = xr.next_to()) {
 			if (xr.iscode == 0) {
 				break;
 			}
@@ -98,20 +254,58 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	bool IdaSymbolInfo::isReadOnly() const noexcept
+	/*!
+	 * \brief	Is this address or this name an import
+	 */
+	static bool _IsImport(IdaImportIndex& index, uint64_t ea, const std::string& name)
 	{
-		auto seg = getseg(m_ea);
-		qstring idaName;
-		if (get_segm_name(&idaName, seg))
+		auto& imports = index.get();
+		if (imports.find(ea).has_value())
 		{
-			// assuming that .data segment are read only to improve static analysis
-			if (idaName == ".data")
-			{
-				return true;
-			}
+			return true;
 		}
 
-		return seg->perm == SEGPERM_READ || seg->perm == SEGPERM_READ + SEGPERM_EXEC;
+		std::string importName = name;
+		if (importName.length() > 6 && importName.substr(0, 6) == SymbolInfo::IMPORT_PREFIX)
+		{
+			importName = importName.substr(6, importName.length() - 6);
+		}
+		return imports.contains(importName);
+	}
+
+	/**********************************************************************/
+	IdaSymbolInfo::IdaSymbolInfo(uint64_t ea, std::string name, IdaImportIndex& imports, IdaSegmentIndex& segments, IdaNameCache& names)
+		: SymbolInfo(ea, name),
+		m_isFunction{ _IsFunction(ea) },
+		m_isLabel{ _IsLabel(ea) },
+		m_isImport{ _IsImport(imports, ea, name) },
+		m_isReadOnly{ segments.get().isReadOnly(ea) }
+	{
+		m_displayName = names.getDisplayName(ea, m_name, m_isImport);
+	}
+
+	/**********************************************************************/
+	bool IdaSymbolInfo::isFunction() const noexcept
+	{
+		return m_isFunction;
+	}
+
+	/**********************************************************************/
+	bool IdaSymbolInfo::isImport() const noexcept
+	{
+		return m_isImport;
+	}
+
+	/**********************************************************************/
+	bool IdaSymbolInfo::isLabel() const noexcept
+	{
+		return m_isLabel;
+	}
+
+	/**********************************************************************/
+	bool IdaSymbolInfo::isReadOnly() const noexcept
+	{
+		return m_isReadOnly;
 	}
 
 	/**********************************************************************/
@@ -129,171 +323,716 @@ namespace yagi
 	/**********************************************************************/
 	std::string IdaSymbolInfo::getName() const
 	{
-		qstring pname;
-		if (m_name.substr(0, 4) == "sub_" || !cleanup_name(&pname, m_ea, m_name.c_str()))
+		return m_displayName;
+	}
+
+	/**********************************************************************/
+	const IdaFunctionSymbolInfo::StackVarIndex& IdaFunctionSymbolInfo::getStackVars()
+	{
+		if (m_stackVars.has_value())
 		{
-			pname = m_name.c_str();
+			return m_stackVars.value();
 		}
 
-		qstring idaName = demangle_name(pname.c_str(), 0x0EA3BE67);
-		if (idaName != "")
+		m_stackVars.emplace();
+		auto idaFunc = get_func(m_symbol->getAddress());
+		auto frame = get_frame(idaFunc);
+		if (frame == nullptr)
 		{
-			auto pp = idaName.find('(', 0);
-			if (pp == qstring::npos)
+			return m_stackVars.value();
+		}
+
+		auto& index = m_stackVars.value();
+		index.byOffset.reserve(frame->memqty);
+		index.byOffset32.reserve(frame->memqty);
+		for (uint32_t i = 0; i < frame->memqty; i++)
+		{
+			auto member = frame->members[i];
+			auto name = std::string(get_struc_name(member.id, STRNFL_REGEX).c_str());
+			auto pp = name.find(".");
+			if (pp != std::string::npos)
 			{
-				pp = idaName.size();
+				name = name.substr(pp + 1);
 			}
 
-			pname = idaName.substr(0, pp);
+			// first member in frame order wins, as a linear search would
+			uint64_t sofset = member.get_soff() - (idaFunc->frsize + idaFunc->frregs);
+			if (index.byOffset.emplace(sofset, std::move(name)).second)
+			{
+				index.byOffset32.emplace(static_cast<uint32_t>(sofset), sofset);
+			}
 		}
+		return index;
+	}
 
-		// Mark import symbol with IDA convention
-		if (isImport()) {
-			return IMPORT_PREFIX + pname.c_str();
+	/**********************************************************************/
+	std::optional<std::string> IdaFunctionSymbolInfo::findStackVar(uint64_t offset, uint32_t addrSize)
+	{
+		auto& index = getStackVars();
+		auto iter = index.byOffset.find(offset);
+		if (iter != index.byOffset.end())
+		{
+			return iter->second;
 		}
 
-		return pname.c_str();
+		if (addrSize != 4)
+		{
+			return std::nullopt;
+		}
+
+		auto truncated = index.byOffset32.find(static_cast<uint32_t>(offset));
+		if (truncated == index.byOffset32.end())
+		{
+			return std::nullopt;
+		}
+		return index.byOffset.at(truncated->second);
 	}
 
 	/**********************************************************************/
-	std::optional<std::string> IdaFunctionSymbolInfo::findStackVar(uint64_t offset, uint32_t addrSize)
+	std::map<uint64_t, std::string> IdaFunctionSymbolInfo::getStackVarNames()
 	{
-		auto idaFunc = get_func(m_symbol->getAddress());
-		auto frame = get_frame(idaFunc);
-		if (frame == nullptr)
+		auto& index = getStackVars();
+		return std::map<uint64_t, std::string>(index.byOffset.begin(), index.byOffset.end());
+	}
+
+	/*!
+	 * \brief	supval tags of the per function netnode
+	 *			supval index is the pcode address
+	 */
+	static const uchar YAGI_NAME_TAG = 'N';
+	static const uchar YAGI_TYPE_TAG = 'T';
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Name of the netnode storing names and types of a function
+	 */
+	static std::string _LocalNodeName(uint64_t ea)
+	{
+		std::stringstream ss;
+		ss << "$ " << to_hex(ea) << ".yagilocal";
+		return ss.str();
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Read all entries stored at a pc, one for each space
+	 *			Each line of the supval is "space|offset|value"
+	 */
+	static std::vector<NameOverride> _ReadEntries(netnode& n, nodeidx_t pc, uchar tag)
+	{
+		std::vector<NameOverride> result;
+		qstring res;
+		if (n.supstr(&res, pc, tag) <= 0)
+		{
+			return result;
+		}
+
+		for (auto& line : split(res.c_str(), '\n'))
+		{
+			auto pb = line.find('|');
+			if (pb == std::string::npos)
+			{
+				continue;
+			}
+			auto pe = line.find('|', pb + 1);
+			if (pe == std::string::npos)
+			{
+				continue;
+			}
+
+			try
+			{
+				result.push_back(NameOverride{
+					line.substr(0, pb),
+					std::stoull(line.substr(pb + 1, pe - pb - 1), nullptr, 16),
+					line.substr(pe + 1)
+				});
+			}
+			catch (std::exception&)
+			{
+				// malformed entry, skip it
+			}
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Write all entries of a pc, the supval is removed if empty
+	 */
+	static void _WriteEntries(netnode& n, nodeidx_t pc, uchar tag, const std::vector<NameOverride>& entries)
+	{
+		if (entries.empty())
+		{
+			n.supdel(pc, tag);
+			return;
+		}
+
+		std::stringstream ss;
+		for (auto& entry : entries)
+		{
+			ss << entry.space << "|" << to_hex(entry.offset) << "|" << entry.name << "\n";
+		}
+		n.supset(pc, ss.str().c_str(), 0, tag);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Find the entry of a space stored at a pc
+	 */
+	static std::optional<NameOverride> _FindEntry(uint64_t ea, uint64_t pc, uchar tag, const std::string& space)
+	{
+		netnode n(_LocalNodeName(ea).c_str());
+		if (n == BADNODE)
 		{
 			return std::nullopt;
 		}
 
-		for (uint32_t i = 0; i < frame->memqty; i++)
+		for (auto& entry : _ReadEntries(n, pc, tag))
 		{
-			auto member = frame->members[i];
-			auto name = std::string(get_struc_name(member.id, STRNFL_REGEX).c_str());
-			auto sofset = member.get_soff() - (idaFunc->frsize + idaFunc->frregs);
-			if (sofset == offset || (addrSize == 4 && ((uint32_t)sofset == (uint32_t)offset)))
+			if (entry.space == space)
 			{
-				auto pp = name.find(".");
-				if (pp != std::string::npos)
-				{
-					return name.substr(pp + 1);
-				}
-				return name;
+				return entry;
 			}
 		}
 		return std::nullopt;
 	}
 
 	/**********************************************************************/
-	std::optional<std::string> IdaFunctionSymbolInfo::findName(uint64_t pc, const std::string& space, uint64_t& offset)
+	/*!
+	 * \brief	Increment the revision of names and types of a function
+	 *			Any change on them must call it to invalidate cached results
+	 */
+	static void _BumpRevision(uint64_t ea)
 	{
 		std::stringstream ss;
-		ss << "$ " << to_hex(m_symbol->getAddress()) << ".yagireg." << space << "." << to_hex(pc);
+		ss << "$ " << to_hex(ea) << ".yagirev";
 		netnode n(ss.str().c_str(), 0, true);
+		n.altset(0, n.altval(0) + 1);
+	}
 
-		qstring res;
-		auto size = n.valstr(&res);
+	/**********************************************************************/
+	IdaLocalTransaction::IdaLocalTransaction(uint64_t ea)
+		: m_ea{ ea }
+	{}
 
-		if (res.size() == 0)
+	/**********************************************************************/
+	void IdaLocalTransaction::add(uint8_t tag, const MemoryLocation& loc, const std::string& value, bool remove)
+	{
+		for (uint64_t pc : loc.pc)
 		{
-			return std::nullopt;
+			m_edits.push_back(Edit{ tag, pc, NameOverride{ loc.spaceName, loc.offset, value }, remove });
 		}
+	}
+
+	/**********************************************************************/
+	void IdaLocalTransaction::saveName(const MemoryLocation& loc, const std::string& name)
+	{
+		add(YAGI_NAME_TAG, loc, name, false);
+	}
 
-		auto pb = res.find('|');
-		if (pb == qstring::npos)
+	/**********************************************************************/
+	void IdaLocalTransaction::saveType(const MemoryLocation& loc, const TypeInfo& newType)
+	{
+		add(YAGI_TYPE_TAG, loc, newType.getName(), false);
+		m_hasTypes = true;
+	}
+
+	/**********************************************************************/
+	void IdaLocalTransaction::clearType(const MemoryLocation& loc)
+	{
+		add(YAGI_TYPE_TAG, loc, std::string(), true);
+		m_hasTypes = true;
+	}
+
+	/**********************************************************************/
+	bool IdaLocalTransaction::empty() const noexcept
+	{
+		return m_edits.empty();
+	}
+
+	/**********************************************************************/
+	bool IdaLocalTransaction::hasTypes() const noexcept
+	{
+		return m_hasTypes;
+	}
+
+	/**********************************************************************/
+	size_t IdaLocalTransaction::commit()
+	{
+		auto edits = std::move(m_edits);
+		m_edits.clear();
+		m_hasTypes = false;
+
+		// the netnode is only created to add entries
+		auto create = std::any_of(edits.begin(), edits.end(), [](const Edit& edit) { return !edit.remove; });
+		netnode n(_LocalNodeName(m_ea).c_str(), 0, create);
+		if (n == BADNODE)
 		{
-			return std::nullopt;
+			return 0;
 		}
 
-		std::string name = res.substr(0, pb).c_str();
-		offset = std::stoull(res.substr(pb + 1).c_str(), nullptr, 16);
+		// edits of a pc are applied on entries read once
+		std::map<std::pair<uint8_t, uint64_t>, std::vector<const Edit*>> byPc;
+		for (auto& edit : edits)
+		{
+			byPc[std::make_pair(edit.tag, edit.pc)].push_back(&edit);
+		}
+
+		size_t changed = 0;
+		for (auto& [key, pcEdits] : byPc)
+		{
+			auto entries = _ReadEntries(n, key.second, key.first);
+			bool modified = false;
+			for (auto edit : pcEdits)
+			{
+				auto iter = std::find_if(entries.begin(), entries.end(), [&](const NameOverride& entry) {
+					return entry.space == edit->entry.space;
+				});
+
+				if (edit->remove)
+				{
+					if (iter != entries.end())
+					{
+						entries.erase(iter);
+						modified = true;
+					}
+				}
+				else if (iter == entries.end())
+				{
+					entries.push_back(edit->entry);
+					modified = true;
+				}
+				else if (iter->offset != edit->entry.offset || iter->name != edit->entry.name)
+				{
+					*iter = edit->entry;
+					modified = true;
+				}
+			}
+
+			if (modified)
+			{
+				_WriteEntries(n, key.second, key.first, entries);
+				changed++;
+			}
+		}
 
-		return name;
+		if (changed != 0)
+		{
+			_BumpRevision(m_ea);
+		}
+		return changed;
 	}
 
 	/**********************************************************************/
-	void IdaFunctionSymbolInfo::saveName(const MemoryLocation& loc, const std::string& value)
+	std::optional<std::string> IdaFunctionSymbolInfo::findName(uint64_t pc, const std::string& space, uint64_t& offset)
 	{
-		for (uint64_t pc : loc.pc)
+		auto entry = _FindEntry(m_symbol->getAddress(), pc, YAGI_NAME_TAG, space);
+		if (!entry.has_value())
 		{
-			saveName(loc.offset, loc.spaceName, pc, value);
+			return std::nullopt;
 		}
+
+		offset = entry.value().offset;
+		return entry.value().name;
 	}
 
 	/**********************************************************************/
-	void IdaFunctionSymbolInfo::saveName(uint64_t address, const std::string& space, uint64_t pc, const std::string& value)
+	void IdaFunctionSymbolInfo::saveName(const MemoryLocation& loc, const std::string& value)
 	{
-		std::stringstream ss, os;
-		ss << "$ " << to_hex(m_symbol->getAddress()) << ".yagireg." << space << "." << to_hex(pc);
-		netnode n(ss.str().c_str(), 0, true);
+		IdaLocalTransaction transaction(m_symbol->getAddress());
+		transaction.saveName(loc, value);
+		transaction.commit();
+	}
 
-		os << value << "|" << to_hex(address);
-		n.set(os.str().c_str());
+	/**********************************************************************/
+	void IdaFunctionSymbolInfo::saveName(uint64_t address, const std::string& space, uint64_t pc, const std::string& value)
+	{
+		MemoryLocation loc(space, address, 0);
+		loc.pc.push_back(pc);
+		saveName(loc, value);
 	}
 
 	/**********************************************************************/
 	void IdaFunctionSymbolInfo::saveType(const MemoryLocation& loc, const TypeInfo& newType)
 	{
-		for (uint64_t pc : loc.pc)
+		IdaLocalTransaction transaction(m_symbol->getAddress());
+		transaction.saveType(loc, newType);
+		transaction.commit();
+	}
+
+	/**********************************************************************/
+	void IdaFunctionSymbolInfo::saveType(uint64_t address, const std::string& space, uint64_t pc, const TypeInfo& newType)
+	{
+		MemoryLocation loc(space, address, 0);
+		loc.pc.push_back(pc);
+		saveType(loc, newType);
+	}
+
+	/**********************************************************************/
+	bool IdaFunctionSymbolInfo::clearType(const MemoryLocation& loc)
+	{
+		IdaLocalTransaction transaction(m_symbol->getAddress());
+		transaction.clearType(loc);
+		return transaction.commit() != 0;
+	}
+
+	/**********************************************************************/
+	bool IdaFunctionSymbolInfo::clearType(const std::string& space, uint64_t pc)
+	{
+		MemoryLocation loc(space, 0, 0);
+		loc.pc.push_back(pc);
+		return clearType(loc);
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> IdaFunctionSymbolInfo::findType(uint64_t pc, const std::string& from, uint64_t& offset)
+	{
+		auto entry = _FindEntry(m_symbol->getAddress(), pc, YAGI_TYPE_TAG, from);
+		if (!entry.has_value())
 		{
-			saveType(loc.offset, loc.spaceName, pc, newType);
+			return std::nullopt;
 		}
+
+		offset = entry.value().offset;
+		return IdaTypeInfoFactory().build_decl(entry.value().name);
 	}
 
 	/**********************************************************************/
-	void IdaFunctionSymbolInfo::saveType(uint64_t address, const std::string& space, uint64_t pc, const TypeInfo& newType)
+	LocalOverrides IdaFunctionSymbolInfo::findLocalOverrides()
 	{
-		std::stringstream ss, os;
-		ss << "$ " << to_hex(m_symbol->getAddress()) << ".yagitype." << space << "." << to_hex(pc);
-		netnode n(ss.str().c_str(), 0, true);
+		LocalOverrides overrides;
+		netnode n(_LocalNodeName(m_symbol->getAddress()).c_str());
+		if (n == BADNODE)
+		{
+			return overrides;
+		}
 
-		os << newType.getName() << "|" << to_hex(address);
-		n.set(os.str().c_str());
+		for (auto pc = n.supfirst(YAGI_NAME_TAG); pc != BADNODE; pc = n.supnext(pc, YAGI_NAME_TAG))
+		{
+			for (auto& entry : _ReadEntries(n, pc, YAGI_NAME_TAG))
+			{
+				overrides.names.emplace(pc, std::move(entry));
+			}
+		}
+
+		IdaTypeInfoFactory factory;
+		for (auto pc = n.supfirst(YAGI_TYPE_TAG); pc != BADNODE; pc = n.supnext(pc, YAGI_TYPE_TAG))
+		{
+			for (auto& entry : _ReadEntries(n, pc, YAGI_TYPE_TAG))
+			{
+				auto type = factory.build_decl(entry.name);
+				if (type.has_value())
+				{
+					overrides.types.emplace(pc, TypeOverride{ entry.space, entry.offset, std::move(type.value()) });
+				}
+			}
+		}
+		return overrides;
 	}
 
 	/**********************************************************************/
-	bool IdaFunctionSymbolInfo::clearType(const MemoryLocation& loc)
+	FlowHints IdaFunctionSymbolInfo::findFlowHints()
 	{
-		bool result = false;
-		for (uint64_t pc : loc.pc)
+		FlowHints hints;
+		auto idaFunc = get_func(m_symbol->getAddress());
+		if (idaFunc == nullptr)
 		{
-			result |= clearType(loc.spaceName, pc);
+			return hints;
 		}
-		return result;
+
+		func_tail_iterator_t fti(idaFunc);
+		for (bool ok = fti.main(); ok; ok = fti.next())
+		{
+			auto& chunk = fti.chunk();
+			hints.chunks.emplace_back(chunk.start_ea, chunk.end_ea);
+
+			for (auto ea = chunk.start_ea; ea != BADADDR && ea < chunk.end_ea; ea = next_head(ea, chunk.end_ea))
+			{
+				switch_info_t si;
+				if (get_switch_info(&si, ea) <= 0)
+				{
+					continue;
+				}
+
+				casevec_t cases;
+				eavec_t targets;
+				if (!calc_switch_cases(&cases, &targets, ea, si) || targets.empty())
+				{
+					continue;
+				}
+
+				auto& table = hints.jumpTables[ea];
+				for (size_t i = 0; i < targets.size() && i < cases.size(); i++)
+				{
+					if (targets[i] == BADADDR)
+					{
+						table.clear();
+						break;
+					}
+
+					// the default target has no case value
+					for (auto value : cases[i])
+					{
+						table[value] = targets[i];
+					}
+				}
+
+				if (table.empty())
+				{
+					hints.jumpTables.erase(ea);
+				}
+			}
+		}
+		return hints;
 	}
 
 	/**********************************************************************/
-	bool IdaFunctionSymbolInfo::clearType(const std::string& space, uint64_t pc)
+	void migrateLegacyOverrides()
 	{
-		std::stringstream ss, os;
-		ss << "$ " << to_hex(m_symbol->getAddress()) << ".yagitype." << space << "." << to_hex(pc);
-		netnode n(ss.str().c_str(), 0, true);
-		return n.delvalue() == 1;
+		// version of the storage layout
+		netnode version("$ yagi.locals", 0, true);
+		if (version.altval(0) >= 1)
+		{
+			return;
+		}
+
+		// legacy names are "$ <function>.yagireg.<space>.<pc>"
+		// and "$ <function>.yagitype.<space>.<pc>"
+		std::vector<std::pair<nodeidx_t, std::vector<std::string>>> legacy;
+		netnode n;
+		for (bool ok = n.start(); ok; ok = n.next())
+		{
+			qstring name;
+			if (n.get_name(&name) <= 0 || name.substr(0, 2) != "$ ")
+			{
+				continue;
+			}
+
+			auto parts = split(name.substr(2).c_str(), '.');
+			if (parts.size() == 4 && (parts[1] == "yagireg" || parts[1] == "yagitype"))
+			{
+				legacy.emplace_back(n, parts);
+			}
+		}
+
+		for (auto& [node, parts] : legacy)
+		{
+			netnode oldNode(node);
+			qstring res;
+			oldNode.valstr(&res);
+
+			auto pb = res.find('|');
+			try
+			{
+				if (pb != qstring::npos)
+				{
+					_SetEntry(
+						std::stoull(parts[0], nullptr, 16),
+						std::stoull(parts[3], nullptr, 16),
+						parts[1] == "yagireg" ? YAGI_NAME_TAG : YAGI_TYPE_TAG,
+						NameOverride{ parts[2], std::stoull(res.substr(pb + 1).c_str(), nullptr, 16), res.substr(0, pb).c_str() }
+					);
+				}
+			}
+			catch (std::exception&)
+			{
+				// malformed entry, nothing to migrate
+			}
+			oldNode.kill();
+		}
+
+		version.altset(0, 1);
 	}
 
 	/**********************************************************************/
-	std::optional<std::unique_ptr<TypeInfo>> IdaFunctionSymbolInfo::findType(uint64_t pc, const std::string& from, uint64_t& offset)
+	uint64_t IdaFunctionSymbolInfo::getContentHash()
 	{
+		auto ea = m_symbol->getAddress();
+		auto hash = fnv1a_string(m_symbol->getName());
+
+		auto idaFunc = get_func(ea);
+		if (idaFunc == nullptr)
+		{
+			return hash;
+		}
+
+		// bytes of every chunks
+		std::vector<uint8_t> buffer;
+		func_tail_iterator_t fti(idaFunc);
+		for (bool ok = fti.main(); ok; ok = fti.next())
+		{
+			auto& chunk = fti.chunk();
+			uint64_t start = chunk.start_ea;
+			buffer.resize(chunk.size());
+			::get_bytes(buffer.data(), chunk.size(), chunk.start_ea);
+			hash = fnv1a(&start, sizeof(start), hash);
+			hash = fnv1a(buffer.data(), buffer.size(), hash);
+		}
+
+		// prototype
+		tinfo_t prototype;
+		if (get_tinfo(&prototype, ea))
+		{
+			qstring decl;
+			prototype.print(&decl, nullptr, PRTYPE_1LINE);
+			hash = fnv1a_string(decl.c_str(), hash);
+		}
+
+		// frame members are used to name stack variables
+		auto frame = get_frame(idaFunc);
+		if (frame != nullptr)
+		{
+			for (uint32_t i = 0; i < frame->memqty; i++)
+			{
+				auto& member = frame->members[i];
+				uint64_t soff = member.get_soff();
+				hash = fnv1a(&soff, sizeof(soff), hash);
+				hash = fnv1a_string(get_struc_name(member.id).c_str(), hash);
+			}
+		}
+
+		// revision of names and types stored in netnode
 		std::stringstream ss;
-		ss << "$ " << to_hex(m_symbol->getAddress()) << ".yagitype." << from << "." << to_hex(pc);
-		netnode n(ss.str().c_str(), 0, true);
+		ss << "$ " << to_hex(ea) << ".yagirev";
+		netnode n(ss.str().c_str());
+		uint64_t revision = n == BADNODE ? 0 : n.altval(0);
+		return fnv1a(&revision, sizeof(revision), hash);
+	}
 
-		qstring res;
-		auto size = n.valstr(&res);
+	/**********************************************************************/
+	/*!
+	 * \brief	Continue a clone hash with a referenced address
+	 *			Addresses into the function are hashed relative to its start
+	 *			others by the name of the item
+	 */
+	static uint64_t _HashReference(func_t* func, ea_t target, uint64_t hash)
+	{
+		if (func_contains(func, target))
+		{
+			uint64_t offset = target - func->start_ea;
+			hash = fnv1a("+", 1, hash);
+			return fnv1a(&offset, sizeof(offset), hash);
+		}
 
-		if (res.size() == 0)
+		// an item without name is only equal to itself
+		qstring name;
+		if (get_name(&name, target) <= 0 || name.empty())
 		{
-			return std::nullopt;
+			uint64_t address = target;
+			hash = fnv1a("@", 1, hash);
+			return fnv1a(&address, sizeof(address), hash);
 		}
+		return fnv1a_string(name.c_str(), hash);
+	}
 
-		auto pb = res.find('|');
-		if (pb == qstring::npos)
+	/**********************************************************************/
+	uint64_t IdaFunctionSymbolInfo::getCloneHash()
+	{
+		auto ea = m_symbol->getAddress();
+		auto idaFunc = get_func(ea);
+		if (idaFunc == nullptr)
 		{
-			return std::nullopt;
+			return 0;
+		}
+
+		// stored names and types are indexed by use address
+		netnode locals(_LocalNodeName(ea).c_str());
+		if (locals != BADNODE && (locals.supfirst(YAGI_NAME_TAG) != BADNODE || locals.supfirst(YAGI_TYPE_TAG) != BADNODE))
+		{
+			return 0;
+		}
+
+		uint64_t hash = FNV1A_SEED;
+		std::vector<uint8_t> bytes;
+		func_tail_iterator_t fti(idaFunc);
+		for (bool ok = fti.main(); ok; ok = fti.next())
+		{
+			auto& chunk = fti.chunk();
+			uint64_t bounds[] = { chunk.start_ea - idaFunc->start_ea, chunk.size() };
+			hash = fnv1a(bounds, sizeof(bounds), hash);
+
+			for (auto head = chunk.start_ea; head != BADADDR && head < chunk.end_ea; head = next_head(head, chunk.end_ea))
+			{
+				insn_t insn;
+				auto size = is_code(get_flags(head)) ? decode_insn(&insn, head) : 0;
+				if (size <= 0)
+				{
+					// data into the function
+					auto end = std::min<ea_t>(next_head(head, chunk.end_ea), chunk.end_ea);
+					bytes.resize(end - head);
+					::get_bytes(bytes.data(), bytes.size(), head);
+					hash = fnv1a(bytes.data(), bytes.size(), hash);
+					continue;
+				}
+
+				bytes.resize(size);
+				::get_bytes(bytes.data(), bytes.size(), head);
+
+				// the encoding of referencing operands depends on the address
+				// offb is 0 when the operand is not byte aligned, bytes are kept
+				auto flags = get_flags(head);
+				for (int i = 0; i < UA_MAXOP && insn.ops[i].type != o_void; i++)
+				{
+					auto& op = insn.ops[i];
+					auto referencing = op.type == o_mem || op.type == o_near || op.type == o_far || is_off(flags, i);
+					if (!referencing || op.offb == 0)
+					{
+						continue;
+					}
+
+					size_t end = size;
+					for (int j = 0; j < UA_MAXOP && insn.ops[j].type != o_void; j++)
+					{
+						if (insn.ops[j].offb > op.offb && insn.ops[j].offb < end)
+						{
+							end = insn.ops[j].offb;
+						}
+					}
+					std::fill(bytes.begin() + op.offb, bytes.begin() + end, 0);
+				}
+				hash = fnv1a(bytes.data(), bytes.size(), hash);
+
+				// masked operands are replaced by what they reference
+				for (auto target = get_first_fcref_from(head); target != BADADDR; target = get_next_fcref_from(head, target))
+				{
+					hash = _HashReference(idaFunc, target, hash);
+				}
+				for (auto target = get_first_dref_from(head); target != BADADDR; target = get_next_dref_from(head, target))
+				{
+					hash = _HashReference(idaFunc, target, hash);
+				}
+			}
+		}
+
+		tinfo_t prototype;
+		if (get_tinfo(&prototype, ea))
+		{
+			qstring decl;
+			prototype.print(&decl, nullptr, PRTYPE_1LINE);
+			hash = fnv1a_string(decl.c_str(), hash);
+		}
+
+		auto frame = get_frame(idaFunc);
+		if (frame != nullptr)
+		{
+			for (uint32_t i = 0; i < frame->memqty; i++)
+			{
+				auto& member = frame->members[i];
+				uint64_t soff = member.get_soff();
+				hash = fnv1a(&soff, sizeof(soff), hash);
+				hash = fnv1a_string(get_struc_name(member.id).c_str(), hash);
+			}
 		}
 
-		std::string typeName = res.substr(0, pb).c_str();
-		offset = std::stoull(res.substr(pb + 1).c_str(), nullptr, 16);
+		// 0 is reserved for functions that are never deduplicated
+		return hash != 0 ? hash : 1;
+	}
 
-		return IdaTypeInfoFactory().build_decl(typeName);
+	/**********************************************************************/
+	bool IdaFunctionSymbolInfo::isLibrary()
+	{
+		auto idaFunc = get_func(m_symbol->getAddress());
+		return idaFunc != nullptr && (idaFunc->flags & FUNC_LIB) != 0;
 	}
 } // end of namespace yagi
\ No newline at end of file
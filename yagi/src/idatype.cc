@@ -25,20 +25,20 @@ namespace yagi
 	std::vector<std::unique_ptr<TypeInfo>> IdaFuncInfo::getFuncPrototype() const
 	{
 		std::vector<std::unique_ptr<TypeInfo>> result;
-		func_type_data_t funcInfo;
-		if (!m_info.m_type.get_func_details(&funcInfo, GTD_CALC_ARGLOCS))
+		auto funcInfo = m_info.getFuncDetails();
+		if (funcInfo == nullptr)
 		{
 			// not found return empty signature
 			return result;
 		}
 
-		result.push_back(std::make_unique<IdaTypeInfo>(funcInfo.rettype));
+		result.push_back(m_info.nested(funcInfo->rettype));
 
 		idatool::transform<funcarg_t, std::unique_ptr<IdaTypeInfo>>(
-			funcInfo, std::back_insert_iterator(result),
+			*funcInfo, std::back_insert_iterator(result),
 			[this](const funcarg_t& arg) -> std::unique_ptr<IdaTypeInfo>
 			{
-				return std::make_unique<IdaTypeInfo>(arg.type);
+				return m_info.nested(arg.type);
 			}
 		);
 
@@ -49,15 +49,15 @@ namespace yagi
 	std::vector<std::string> IdaFuncInfo::getFuncParamName() const
 	{
 		std::vector<std::string> result;
-		func_type_data_t funcInfo;
-		if (!m_info.m_type.is_func() || !m_info.m_type.get_func_details(&funcInfo))
+		auto funcInfo = m_info.getFuncDetails();
+		if (!m_info.m_type.is_func() || funcInfo == nullptr)
 		{
 			return result;
 		}
 
 		uint16_t index = 0;
 		idatool::transform<funcarg_t, std::string>(
-			funcInfo, std::back_insert_iterator(result),
+			*funcInfo, std::back_insert_iterator(result),
 			[&index](const funcarg_t& arg) -> std::string
 			{
 				index++;
@@ -81,13 +81,13 @@ namespace yagi
 	/**********************************************************************/
 	std::string IdaFuncInfo::getCallingConv() const
 	{
-		func_type_data_t funcInfo;
-		if (!m_info.m_type.get_func_details(&funcInfo))
+		auto funcInfo = m_info.getFuncDetails();
+		if (funcInfo == nullptr)
 		{
 			throw UnknownCallingConvention(m_info.getName());
 		}
 
-		switch (funcInfo.get_cc())
+		switch (funcInfo->get_cc())
 		{
 		case CM_CC_FASTCALL:
 			return "__fastcall";
@@ -126,15 +126,18 @@ namespace yagi
 	/**********************************************************************/
 	std::vector<TypeStructField> IdaStructInfo::getFields() const
 	{
-		udt_type_data_t attributes;
-		m_info.m_type.get_udt_details(&attributes);
 		std::vector<TypeStructField> result;
+		auto attributes = m_info.getUdtDetails();
+		if (attributes == nullptr)
+		{
+			return result;
+		}
 
 		idatool::transform<udt_member_t, TypeStructField>(
-			attributes, std::back_insert_iterator(result),
+			*attributes, std::back_insert_iterator(result),
 			[this](const udt_member_t& arg) -> TypeStructField
 			{
-				return TypeStructField{ arg.offset / 8, arg.name.c_str(), std::make_unique<IdaTypeInfo>(arg.type) };
+				return TypeStructField{ arg.offset / 8, arg.name.c_str(), m_info.nested(arg.type) };
 			}
 		);
 
@@ -163,7 +166,7 @@ namespace yagi
 	/**********************************************************************/
 	std::unique_ptr<TypeInfo> IdaPtrInfo::getPointedObject() const
 	{
-		return std::make_unique<IdaTypeInfo>(m_info.m_type.get_pointed_object());
+		return m_info.nested(m_info.m_type.get_pointed_object());
 	}
 
 	/**********************************************************************/
@@ -181,7 +184,7 @@ namespace yagi
 	/**********************************************************************/
 	std::unique_ptr<TypeInfo> IdaArrayInfo::getPointedObject() const
 	{
-		return std::make_unique<IdaTypeInfo>(m_info.m_type.get_array_element());
+		return m_info.nested(m_info.m_type.get_array_element());
 	}
 
 	/**********************************************************************/
@@ -191,10 +194,69 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	IdaTypeInfo::IdaTypeInfo(tinfo_t id)
-		: m_type{ id }
+	std::shared_ptr<IdaTypeLayout> IdaTypeCache::find(const tinfo_t& type)
+	{
+		// qualifiers are part of the printed name
+		qstring name;
+		if (type.is_const() || type.is_volatile() || !type.get_type_name(&name))
+		{
+			return std::make_shared<IdaTypeLayout>();
+		}
+
+		auto& layout = m_layouts[name.c_str()];
+		if (layout == nullptr)
+		{
+			layout = std::make_shared<IdaTypeLayout>();
+		}
+		return layout;
+	}
+
+	/**********************************************************************/
+	void IdaTypeCache::invalidate(const std::string& name)
+	{
+		m_layouts.erase(name);
+	}
+
+	/**********************************************************************/
+	void IdaTypeCache::clear()
+	{
+		m_layouts.clear();
+	}
+
+	/**********************************************************************/
+	IdaTypeInfo::IdaTypeInfo(tinfo_t id, std::shared_ptr<IdaTypeCache> cache)
+		: m_type{ id }, m_cache{ cache },
+		m_layout{ cache != nullptr ? cache->find(m_type) : std::make_shared<IdaTypeLayout>() }
+	{
+
+	}
+
+	/**********************************************************************/
+	std::unique_ptr<IdaTypeInfo> IdaTypeInfo::nested(const tinfo_t& type) const
 	{
+		return std::make_unique<IdaTypeInfo>(type, m_cache);
+	}
 
+	/**********************************************************************/
+	const func_type_data_t* IdaTypeInfo::getFuncDetails() const
+	{
+		if (!m_layout->funcLoaded)
+		{
+			m_layout->hasFunc = m_type.get_func_details(&m_layout->func, GTD_CALC_ARGLOCS);
+			m_layout->funcLoaded = true;
+		}
+		return m_layout->hasFunc ? &m_layout->func : nullptr;
+	}
+
+	/**********************************************************************/
+	const udt_type_data_t* IdaTypeInfo::getUdtDetails() const
+	{
+		if (!m_layout->udtLoaded)
+		{
+			m_layout->hasUdt = m_type.get_udt_details(&m_layout->udt);
+			m_layout->udtLoaded = true;
+		}
+		return m_layout->hasUdt ? &m_layout->udt : nullptr;
 	}
 
 	/**********************************************************************/
@@ -212,9 +274,13 @@ namespace yagi
 	/**********************************************************************/
 	std::string IdaTypeInfo::getName() const
 	{
-		qstring name;
-		m_type.print(&name);
-		return name.c_str();
+		if (!m_layout->name.has_value())
+		{
+			qstring name;
+			m_type.print(&name);
+			m_layout->name = name.c_str();
+		}
+		return m_layout->name.value();
 	}
 
 	/**********************************************************************/
@@ -314,6 +380,11 @@ namespace yagi
 		return std::make_unique<IdaArrayInfo>(*this);
 	}
 
+	/**********************************************************************/
+	IdaTypeInfoFactory::IdaTypeInfoFactory()
+		: m_cache{ std::make_shared<IdaTypeCache>() }
+	{}
+
 	/**********************************************************************/
 	std::optional<std::unique_ptr<TypeInfo>> IdaTypeInfoFactory::build(const std::string& name)
 	{
@@ -324,7 +395,7 @@ namespace yagi
 			return std::nullopt;
 		}
 
-		return std::make_unique<IdaTypeInfo>(idaTypeInfo);
+		return std::make_unique<IdaTypeInfo>(idaTypeInfo, m_cache);
 	}
 
 	/**********************************************************************/
@@ -337,13 +408,13 @@ namespace yagi
 			return std::nullopt;
 		}
 
-		return std::make_unique<IdaTypeInfo>(idaTypeInfo);
+		return std::make_unique<IdaTypeInfo>(idaTypeInfo, m_cache);
 	}
 
 	/**********************************************************************/
 	std::optional<std::unique_ptr<TypeInfo>> IdaTypeInfoFactory::build(tinfo_t info)
 	{
-		return std::make_unique<IdaTypeInfo>(info);
+		return std::make_unique<IdaTypeInfo>(info, m_cache);
 	}
 
 	/**********************************************************************/
@@ -359,7 +430,19 @@ namespace yagi
 			return std::nullopt;
 		}
 
-		return std::make_unique<IdaTypeInfo>(idaTypeInfo);
+		return std::make_unique<IdaTypeInfo>(idaTypeInfo, m_cache);
+	}
+
+	/**********************************************************************/
+	void IdaTypeInfoFactory::invalidate(const std::string& name)
+	{
+		m_cache->invalidate(name);
+	}
+
+	/**********************************************************************/
+	void IdaTypeInfoFactory::invalidateAll()
+	{
+		m_cache->clear();
 	}
 
 } // end of namespace yagi
\ No newline at end of file
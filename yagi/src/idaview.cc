@@ -0,0 +1,183 @@
+#include "idaview.hh"
+#include <loader.hpp>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	id given by IDA to the place class
+	 */
+	static int s_placeId = -1;
+
+	/**********************************************************************/
+	static const LineStore& _GetStore(void* ud)
+	{
+		return *static_cast<const LineStore*>(ud);
+	}
+
+	/**********************************************************************/
+	void LinePlace::registerClass()
+	{
+		if (s_placeId != -1)
+		{
+			return;
+		}
+
+		static const LinePlace tmplate;
+		s_placeId = register_place_class(&tmplate, PCF_MAKEPLACE_ALLOCATES, &PLUGIN);
+	}
+
+	/**********************************************************************/
+	void idaapi LinePlace::print(qstring* out_buf, void* ud) const
+	{
+		out_buf->sprnt("%" FMT_EA "u", n);
+	}
+
+	/**********************************************************************/
+	uval_t idaapi LinePlace::touval(void* ud) const
+	{
+		return n;
+	}
+
+	/**********************************************************************/
+	place_t* idaapi LinePlace::clone(void) const
+	{
+		return new LinePlace(*this);
+	}
+
+	/**********************************************************************/
+	void idaapi LinePlace::copyfrom(const place_t* from)
+	{
+		auto other = static_cast<const LinePlace*>(from);
+		n = other->n;
+		lnnum = other->lnnum;
+	}
+
+	/**********************************************************************/
+	place_t* idaapi LinePlace::makeplace(void* ud, uval_t x, int lnnum) const
+	{
+		auto place = new LinePlace(x);
+		place->lnnum = lnnum;
+		return place;
+	}
+
+	/**********************************************************************/
+	int idaapi LinePlace::compare(const place_t* t2) const
+	{
+		auto other = static_cast<const LinePlace*>(t2);
+		return n < other->n ? -1 : (n > other->n ? 1 : 0);
+	}
+
+	/**********************************************************************/
+	void idaapi LinePlace::adjust(void* ud)
+	{
+		auto size = _GetStore(ud).size();
+		if (n >= size)
+		{
+			n = size - 1;
+			lnnum = 0;
+		}
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::prev(void* ud)
+	{
+		if (n == 0)
+		{
+			return false;
+		}
+		n--;
+		return true;
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::next(void* ud)
+	{
+		if (n + 1 >= _GetStore(ud).size())
+		{
+			return false;
+		}
+		n++;
+		return true;
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::beginning(void* ud) const
+	{
+		return n == 0;
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::ending(void* ud) const
+	{
+		return n + 1 >= _GetStore(ud).size();
+	}
+
+	/**********************************************************************/
+	int idaapi LinePlace::generate(qstrvec_t* out, int* out_deflnnum, color_t* out_pfx_color, bgcolor_t* out_bgcolor, void* ud, int maxsize) const
+	{
+		auto& store = _GetStore(ud);
+		if (maxsize <= 0 || n >= store.size())
+		{
+			return 0;
+		}
+
+		// the only line built for this place
+		auto line = store.getLine(n);
+		out->push_back(qstring(line.data(), line.size()));
+		*out_deflnnum = 0;
+		return 1;
+	}
+
+	/**********************************************************************/
+	void idaapi LinePlace::serialize(bytevec_t* out) const
+	{
+		place_t__serialize(this, out);
+		out->pack_ea(n);
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::deserialize(const uchar** pptr, const uchar* end)
+	{
+		if (!place_t__deserialize(this, pptr, end) || *pptr >= end)
+		{
+			return false;
+		}
+		n = unpack_ea(pptr, end);
+		return true;
+	}
+
+	/**********************************************************************/
+	int idaapi LinePlace::id() const
+	{
+		return s_placeId;
+	}
+
+	/**********************************************************************/
+	const char* idaapi LinePlace::name() const
+	{
+		return "yagi_line_place_t";
+	}
+
+	/**********************************************************************/
+	ea_t idaapi LinePlace::toea() const
+	{
+		return BADADDR;
+	}
+
+	/**********************************************************************/
+	bool idaapi LinePlace::rebase(const segm_move_infos_t&)
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	place_t* idaapi LinePlace::enter(uint32*) const
+	{
+		return nullptr;
+	}
+
+	/**********************************************************************/
+	void idaapi LinePlace::leave(uint32) const
+	{}
+} // end of namespace yagi
\ No newline at end of file
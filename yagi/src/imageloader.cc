@@ -0,0 +1,40 @@
+#include "imageloader.hh"
+
+#define IMAGE_LOADER	"image"
+
+namespace yagi 
+{
+	/**********************************************************************/
+	ImageLoader::ImageLoader(std::shared_ptr<const MemoryImage> image)
+		: LoadImage(IMAGE_LOADER), m_image{ std::move(image) }
+	{}
+
+	/**********************************************************************/
+	std::string ImageLoader::getArchType(void) const
+	{
+		return IMAGE_LOADER;
+	}
+
+	/**********************************************************************/
+	void ImageLoader::loadFill(uint1* ptr, int4 size, const Address& addr)
+	{
+		m_image->read(addr.getOffset(), ptr, size);
+	}
+
+	/**********************************************************************/
+	void ImageLoader::adjustVma(long adjust)
+	{
+		throw LowlevelError("Cannot adjust YAGI virtual memory");
+	}
+
+	/**********************************************************************/
+	ImageLoaderFactory::ImageLoaderFactory(std::shared_ptr<const MemoryImage> image)
+		: m_image{ std::move(image) }
+	{}
+
+	/**********************************************************************/
+	LoadImage* ImageLoaderFactory::build()
+	{
+		return new ImageLoader(m_image);
+	}
+} // end of namespace yagi
@@ -0,0 +1,41 @@
+#include "importindex.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	void ImportIndex::add(uint64_t ea, const std::string& name)
+	{
+		m_names[ea] = name;
+		m_imports.insert(name);
+	}
+
+	/**********************************************************************/
+	void ImportIndex::clear()
+	{
+		m_names.clear();
+		m_imports.clear();
+	}
+
+	/**********************************************************************/
+	std::optional<std::string> ImportIndex::find(uint64_t ea) const
+	{
+		auto iter = m_names.find(ea);
+		if (iter == m_names.end())
+		{
+			return std::nullopt;
+		}
+		return iter->second;
+	}
+
+	/**********************************************************************/
+	bool ImportIndex::contains(const std::string& name) const
+	{
+		return m_imports.find(name) != m_imports.end();
+	}
+
+	/**********************************************************************/
+	size_t ImportIndex::size() const noexcept
+	{
+		return m_names.size();
+	}
+} // end of namespace yagi
@@ -0,0 +1,104 @@
+#include "library.hh"
+#include "resultcache.hh"
+#include "print.hh"
+#include "base.hh"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Characters of a signature name kept in file names
+	 */
+	static bool _IsPathChar(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+	}
+
+	/**********************************************************************/
+	LibraryStore::LibraryStore(std::filesystem::path directory)
+		: m_directory{ std::move(directory) }
+	{}
+
+	/**********************************************************************/
+	std::filesystem::path LibraryStore::getPath(const LibraryFunction& function) const
+	{
+		// names of several functions may be cleaned the same way
+		// the stored name is checked on load
+		std::string name;
+		for (auto c : function.name.substr(0, 64))
+		{
+			name.push_back(_IsPathChar(c) ? c : '_');
+		}
+		return m_directory / (name + "-" + to_hex(function.hash) + "-" + to_hex(function.size) + ".result");
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> LibraryStore::load(uint64_t ea, const LibraryFunction& function) const
+	{
+		std::ifstream stream(getPath(function), std::ios::binary);
+		if (!stream.is_open())
+		{
+			return std::nullopt;
+		}
+
+		std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		auto result = deserializeResult(buffer, function.hash);
+		if (!result.has_value() || result.value().name != function.name)
+		{
+			return std::nullopt;
+		}
+
+		// the name is the same, only addresses move
+		return rebaseResult(result.value(), result.value().ea, function.size, ea, function.name);
+	}
+
+	/**********************************************************************/
+	bool LibraryStore::save(const LibraryFunction& function, const Decompiler::Result& result) const
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+
+		// the store is shared, the file is renamed once complete
+		auto path = getPath(function);
+		auto temporary = path;
+		temporary += "." + to_hex(std::hash<std::thread::id>()(std::this_thread::get_id()) ^ std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+
+		auto buffer = serializeResult(function.hash, result);
+		{
+			std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+			if (!stream.is_open() || !stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()))
+			{
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+		return true;
+	}
+
+	/**********************************************************************/
+	LibraryBatchOutput::LibraryBatchOutput(BatchOutput& next, const LibraryStore& store, std::unordered_map<uint64_t, LibraryFunction> functions)
+		: m_next{ next }, m_store{ store }, m_functions{ std::move(functions) }
+	{}
+
+	/**********************************************************************/
+	void LibraryBatchOutput::write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration)
+	{
+		auto function = m_functions.find(ea);
+		if (result.has_value() && function != m_functions.end())
+		{
+			m_store.save(function->second, result.value());
+		}
+		m_next.write(ea, result, duration);
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "liftcache.hh"
+#include "profile.hh"
+
+#include <algorithm>
+
+namespace yagi 
+{
+	/**********************************************************************/
+	LiftCache::LiftCache(size_t maxCount)
+		: m_maxCount{ maxCount }
+	{}
+
+	/**********************************************************************/
+	const LiftCache::Lift* LiftCache::find(uint64_t ea, const uintm* context, int4 contextSize) const
+	{
+		auto iter = m_lifts.find(ea);
+		if (iter == m_lifts.end())
+		{
+			return nullptr;
+		}
+
+		for (auto& lift : iter->second)
+		{
+			if (lift.context.size() == static_cast<size_t>(contextSize) && std::equal(lift.context.begin(), lift.context.end(), context))
+			{
+				return &lift;
+			}
+		}
+		return nullptr;
+	}
+
+	/**********************************************************************/
+	void LiftCache::insert(uint64_t ea, Lift lift)
+	{
+		if (m_count >= m_maxCount)
+		{
+			clear();
+		}
+
+		m_maxLength = std::max(m_maxLength, lift.length);
+		m_lifts[ea].push_back(std::move(lift));
+		m_count++;
+	}
+
+	/**********************************************************************/
+	void LiftCache::invalidate(uint64_t ea)
+	{
+		// translations starting before the byte may cover it
+		auto start = ea >= static_cast<uint64_t>(m_maxLength) ? ea - m_maxLength + 1 : 0;
+		auto iter = m_lifts.lower_bound(start);
+		while (iter != m_lifts.end() && iter->first <= ea)
+		{
+			auto covers = std::any_of(iter->second.begin(), iter->second.end(), [&iter, ea](const Lift& lift) {
+				return iter->first + lift.length > ea;
+			});
+
+			if (!covers)
+			{
+				++iter;
+				continue;
+			}
+			m_count -= iter->second.size();
+			iter = m_lifts.erase(iter);
+		}
+	}
+
+	/**********************************************************************/
+	void LiftCache::clear()
+	{
+		m_lifts.clear();
+		m_count = 0;
+		m_maxLength = 0;
+	}
+
+	/**********************************************************************/
+	size_t LiftCache::size() const noexcept
+	{
+		return m_count;
+	}
+
+	/**********************************************************************/
+	int4 LiftCache::replay(const Lift& lift, PcodeEmit& emit)
+	{
+		// emitters take mutable varnodes, cached ones are copied
+		std::vector<VarnodeData> inputs;
+		for (auto& op : lift.ops)
+		{
+			auto output = op.output;
+			auto first = lift.inputs.begin() + op.firstInput;
+			inputs.assign(first, first + op.inputCount);
+			emit.dump(op.address, op.opcode, op.hasOutput ? &output : nullptr, inputs.data(), op.inputCount);
+		}
+		return lift.length;
+	}
+
+	/**********************************************************************/
+	LiftRecorder::LiftRecorder(PcodeEmit& inner, LiftCache::Lift& lift)
+		: m_inner{ inner }, m_lift{ lift }
+	{}
+
+	/**********************************************************************/
+	void LiftRecorder::dump(const Address& addr, OpCode opc, VarnodeData* outvar, VarnodeData* vars, int4 isize)
+	{
+		LiftCache::Op op{ addr, opc, outvar != nullptr, {}, m_lift.inputs.size(), isize };
+		if (outvar != nullptr)
+		{
+			op.output = *outvar;
+		}
+		m_lift.inputs.insert(m_lift.inputs.end(), vars, vars + isize);
+		m_lift.ops.push_back(op);
+
+		m_inner.dump(addr, opc, outvar, vars, isize);
+	}
+
+	/**********************************************************************/
+	CachedSleigh::CachedSleigh(LoadImage* loader, ContextDatabase* context, LiftCache& cache)
+		: Sleigh(loader, context), m_cache{ cache }, m_context{ context }
+	{}
+
+	/**********************************************************************/
+	int4 CachedSleigh::oneInstruction(PcodeEmit& emit, const Address& baseaddr) const
+	{
+		auto context = m_context->getContext(baseaddr);
+		auto contextSize = m_context->getContextSize();
+
+		auto cached = m_cache.find(baseaddr.getOffset(), context, contextSize);
+		if (cached != nullptr)
+		{
+			return LiftCache::replay(*cached, emit);
+		}
+
+		ProfileScope scope("translate", "Sleigh::oneInstruction");
+
+		// the key is read before the translation commits context changes
+		LiftCache::Lift lift;
+		lift.context.assign(context, context + contextSize);
+
+		// nothing is recorded if the instruction can't be translated
+		LiftRecorder recorder(emit, lift);
+		auto length = Sleigh::oneInstruction(recorder, baseaddr);
+		lift.length = length;
+		m_cache.insert(baseaddr.getOffset(), std::move(lift));
+		return length;
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "linestore.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	LineStore::LineStore(std::string text)
+		: m_text{ std::move(text) }
+	{
+		m_starts.push_back(0);
+		for (auto end = m_text.find('\n'); end != std::string::npos; end = m_text.find('\n', end + 1))
+		{
+			if (end + 1 < m_text.size())
+			{
+				m_starts.push_back(end + 1);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	size_t LineStore::size() const noexcept
+	{
+		return m_starts.size();
+	}
+
+	/**********************************************************************/
+	std::string_view LineStore::getLine(size_t index) const noexcept
+	{
+		auto start = m_starts[index];
+		auto end = m_text.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = m_text.size();
+		}
+		return std::string_view(m_text).substr(start, end - start);
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "memory.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace yagi
+{
+	/**********************************************************************/
+	std::optional<size_t> getProcessMemory() noexcept
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return std::nullopt;
+		}
+		return static_cast<size_t>(counters.WorkingSetSize);
+#else
+		// total and resident pages
+		std::ifstream statm("/proc/self/statm");
+		size_t total = 0, resident = 0;
+		if (!(statm >> total >> resident))
+		{
+			return std::nullopt;
+		}
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	/**********************************************************************/
+	std::string formatMemory(size_t bytes)
+	{
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(1) << (static_cast<double>(bytes) / (1024.0 * 1024.0)) << " MiB";
+		return ss.str();
+	}
+} // end of namespace yagi
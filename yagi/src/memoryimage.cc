@@ -0,0 +1,100 @@
+#include "memoryimage.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace yagi
+{
+	/**********************************************************************/
+	size_t MemoryImage::mapPage(uint64_t page)
+	{
+		auto iter = m_pages.find(page);
+		if (iter != m_pages.end())
+		{
+			return iter->second;
+		}
+
+		auto offset = m_data.size();
+		m_data.resize(offset + PAGE_SIZE, 0);
+		m_pages.emplace(page, offset);
+		return offset;
+	}
+
+	/**********************************************************************/
+	void MemoryImage::reserve(size_t size)
+	{
+		m_data.reserve(m_data.size() + size + PAGE_SIZE);
+	}
+
+	/**********************************************************************/
+	void MemoryImage::write(uint64_t ea, const uint8_t* data, size_t size)
+	{
+		while (size > 0)
+		{
+			auto page = ea & ~(PAGE_SIZE - 1);
+			auto delta = ea - page;
+			auto chunk = std::min<uint64_t>(size, PAGE_SIZE - delta);
+
+			auto offset = mapPage(page);
+			std::memcpy(m_data.data() + offset + delta, data, chunk);
+
+			ea += chunk;
+			data += chunk;
+			size -= chunk;
+		}
+	}
+
+	/**********************************************************************/
+	size_t MemoryImage::read(uint64_t ea, uint8_t* buffer, size_t size) const
+	{
+		size_t result = 0;
+		while (size > 0)
+		{
+			auto page = ea & ~(PAGE_SIZE - 1);
+			auto delta = ea - page;
+			auto chunk = std::min<uint64_t>(size, PAGE_SIZE - delta);
+
+			auto iter = m_pages.find(page);
+			if (iter != m_pages.end())
+			{
+				std::memcpy(buffer, m_data.data() + iter->second + delta, chunk);
+				result += chunk;
+			}
+			else
+			{
+				std::memset(buffer, 0, chunk);
+			}
+
+			ea += chunk;
+			buffer += chunk;
+			size -= chunk;
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	void MemoryImage::clear()
+	{
+		m_data.clear();
+		m_pages.clear();
+	}
+
+	/**********************************************************************/
+	size_t MemoryImage::size() const noexcept
+	{
+		return m_data.size();
+	}
+
+	/**********************************************************************/
+	std::vector<uint64_t> MemoryImage::pages() const
+	{
+		std::vector<uint64_t> result;
+		result.reserve(m_pages.size());
+		for (auto& page : m_pages)
+		{
+			result.push_back(page.first);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+} // end of namespace yagi
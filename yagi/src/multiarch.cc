@@ -0,0 +1,209 @@
+#include "multiarch.hh"
+#include "ghidradecompiler.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	MultiArchDecompiler::MultiArchDecompiler(
+		const Compiler& compiler,
+		std::unique_ptr<Decompiler> decompiler,
+		Selector selector,
+		Builder builder,
+		std::unique_ptr<Logger> logger
+	) : m_defaultKey{ GhidraDecompiler::compute_architecture_key(compiler) },
+		m_selector{ std::move(selector) },
+		m_builder{ std::move(builder) },
+		m_logger{ std::move(logger) }
+	{
+		m_decompilers.emplace(m_defaultKey, std::move(decompiler));
+	}
+
+	/**********************************************************************/
+	Decompiler* MultiArchDecompiler::select(uint64_t funcAddress)
+	{
+		auto compiler = m_selector(funcAddress);
+		auto key = GhidraDecompiler::compute_architecture_key(compiler);
+
+		auto iter = m_decompilers.find(key);
+		if (iter != m_decompilers.end())
+		{
+			return iter->second.get();
+		}
+
+		m_logger->info("Build decompiler for ", key);
+		auto decompiler = m_builder(compiler);
+		if (!decompiler.has_value())
+		{
+			// never try again
+			m_logger->error("Unable to build decompiler for ", key);
+			m_decompilers.emplace(key, nullptr);
+			return nullptr;
+		}
+
+		auto result = decompiler.value().get();
+		result->setCancelToken(m_cancel);
+		result->setProfileOutput(m_profile);
+		m_decompilers.emplace(key, std::move(decompiler.value()));
+		return result;
+	}
+
+	/**********************************************************************/
+	size_t MultiArchDecompiler::size() const noexcept
+	{
+		return m_decompilers.size();
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> MultiArchDecompiler::decompile(uint64_t funcAddress)
+	{
+		auto decompiler = select(funcAddress);
+		if (decompiler == nullptr)
+		{
+			return std::nullopt;
+		}
+		return decompiler->decompile(funcAddress);
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> MultiArchDecompiler::refreshNames(uint64_t funcAddress)
+	{
+		auto decompiler = select(funcAddress);
+		if (decompiler == nullptr)
+		{
+			return std::nullopt;
+		}
+		return decompiler->refreshNames(funcAddress);
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::invalidate(uint64_t funcAddress)
+	{
+		// the instruction set of the function may have changed
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->invalidate(funcAddress);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::invalidateDependents(uint64_t ea)
+	{
+		// a function of any instruction set may read the item
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->invalidateDependents(ea);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::invalidateCode(uint64_t ea)
+	{
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->invalidateCode(ea);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::clearCache()
+	{
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->clearCache();
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::invalidateType(const std::string& name)
+	{
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->invalidateType(name);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::invalidateTypes()
+	{
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->invalidateTypes();
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::retain(uint64_t funcAddress)
+	{
+		// the instruction set of the function may change while it is shown
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->retain(funcAddress);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::release(uint64_t funcAddress)
+	{
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->release(funcAddress);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::setCancelToken(std::shared_ptr<const CancelToken> token)
+	{
+		m_cancel = std::move(token);
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->setCancelToken(m_cancel);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void MultiArchDecompiler::setProfileOutput(std::shared_ptr<ProfileOutput> output)
+	{
+		m_profile = std::move(output);
+		for (auto& [key, decompiler] : m_decompilers)
+		{
+			if (decompiler != nullptr)
+			{
+				decompiler->setProfileOutput(m_profile);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	size_t MultiArchDecompiler::prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names)
+	{
+		auto& decompiler = m_decompilers.at(m_defaultKey);
+		return decompiler != nullptr ? decompiler->prewarmTypes(source, names) : 0;
+	}
+} // end of namespace yagi
@@ -0,0 +1,207 @@
+#include "options.hh"
+#include "base.hh"
+
+#include <algorithm>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Parse a boolean option value
+	 */
+	static bool _ParseBool(std::string value, bool defaultValue)
+	{
+		std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+		if (value == "1" || value == "true" || value == "yes" || value == "on")
+		{
+			return true;
+		}
+		if (value == "0" || value == "false" || value == "no" || value == "off")
+		{
+			return false;
+		}
+		return defaultValue;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Parse a size option value
+	 */
+	static size_t _ParseSize(const std::string& value, size_t defaultValue)
+	{
+		try
+		{
+			return std::stoull(value, nullptr, 0);
+		}
+		catch (std::exception&)
+		{
+			return defaultValue;
+		}
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Parse a log level option value
+	 */
+	static LogLevel _ParseLogLevel(std::string value, LogLevel defaultValue)
+	{
+		std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+		if (value == "trace")
+		{
+			return LogLevel::Trace;
+		}
+		if (value == "debug")
+		{
+			return LogLevel::Debug;
+		}
+		if (value == "info")
+		{
+			return LogLevel::Info;
+		}
+		if (value == "error")
+		{
+			return LogLevel::Error;
+		}
+		if (value == "off")
+		{
+			return LogLevel::Off;
+		}
+		return defaultValue;
+	}
+
+	/**********************************************************************/
+	Options Options::parse(const std::string& options)
+	{
+		Options result;
+		for (auto& option : split(options, ','))
+		{
+			auto pos = option.find('=');
+			if (pos == std::string::npos)
+			{
+				continue;
+			}
+
+			auto key = option.substr(0, pos);
+			auto value = option.substr(pos + 1);
+
+			if (key == "cache_size")
+			{
+				result.cacheSize = _ParseSize(value, result.cacheSize);
+			}
+			else if (key == "persist_cache")
+			{
+				result.persistCache = _ParseBool(value, result.persistCache);
+			}
+			else if (key == "batch_workers")
+			{
+				result.batchWorkers = _ParseSize(value, result.batchWorkers);
+			}
+			else if (key == "batch_snapshot")
+			{
+				result.batchSnapshot = _ParseBool(value, result.batchSnapshot);
+			}
+			else if (key == "batch_propagate")
+			{
+				result.batchPropagate = _ParseBool(value, result.batchPropagate);
+			}
+			else if (key == "batch_dedup")
+			{
+				result.batchDedup = _ParseBool(value, result.batchDedup);
+			}
+			else if (key == "library_skip")
+			{
+				result.librarySkip = _ParseBool(value, result.librarySkip);
+			}
+			else if (key == "library_dir")
+			{
+				result.libraryDir = value;
+			}
+			else if (key == "loader")
+			{
+				if (value == "ida")
+				{
+					result.loader = Options::Loader::Ida;
+				}
+				else if (value == "snapshot")
+				{
+					result.loader = Options::Loader::Snapshot;
+				}
+			}
+			else if (key == "readonly_segments")
+			{
+				auto names = split(value, ';');
+				result.readOnlySegments = std::unordered_set<std::string>(names.begin(), names.end());
+				result.readOnlySegments.erase("");
+			}
+			else if (key == "log_level")
+			{
+				result.logLevel = _ParseLogLevel(value, result.logLevel);
+			}
+			else if (key == "log_rate")
+			{
+				result.logRate = _ParseSize(value, result.logRate);
+			}
+			else if (key == "decompile_budget")
+			{
+				result.decompileBudget = _ParseSize(value, result.decompileBudget);
+			}
+			else if (key == "memory_limit")
+			{
+				result.memoryLimit = _ParseSize(value, result.memoryLimit);
+			}
+			else if (key == "large_function_size")
+			{
+				result.largeFunctionSize = _ParseSize(value, result.largeFunctionSize);
+			}
+			else if (key == "large_function_ops")
+			{
+				result.largeFunctionOps = _ParseSize(value, result.largeFunctionOps);
+			}
+			else if (key == "large_function_passes")
+			{
+				result.largeFunctionPasses = _ParseSize(value, result.largeFunctionPasses);
+			}
+			else if (key == "seed_flow")
+			{
+				result.seedFlow = _ParseBool(value, result.seedFlow);
+			}
+			else if (key == "token_stream")
+			{
+				result.tokenStream = _ParseBool(value, result.tokenStream);
+			}
+			else if (key == "service_port")
+			{
+				result.servicePort = _ParseSize(value, result.servicePort);
+			}
+			else if (key == "service_timeout")
+			{
+				result.serviceTimeout = _ParseSize(value, result.serviceTimeout);
+			}
+			else if (key == "prefetch")
+			{
+				result.prefetch = _ParseSize(value, result.prefetch);
+			}
+			else if (key == "prefetch_callers")
+			{
+				result.prefetchCallers = _ParseBool(value, result.prefetchCallers);
+			}
+			else if (key == "prewarm_types")
+			{
+				result.prewarmTypes = _ParseBool(value, result.prewarmTypes);
+			}
+			else if (key == "background_cpu")
+			{
+				result.backgroundCpu = _ParseSize(value, result.backgroundCpu);
+			}
+			else if (key == "profile_dir")
+			{
+				result.profileDir = value;
+			}
+			else if (key == "profile_sample")
+			{
+				result.profileSample = _ParseSize(value, result.profileSample);
+			}
+		}
+		return result;
+	}
+} // end of namespace yagi
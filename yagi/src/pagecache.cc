@@ -0,0 +1,138 @@
+#include "pagecache.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Copy the part of a range of bytes inside the requested range
+	 */
+	static void _CopyOverlap(uint64_t start, const uint8_t* data, size_t length, uint64_t ea, uint8_t* buffer, size_t size)
+	{
+		auto low = std::max<uint64_t>(start, ea);
+		auto high = std::min<uint64_t>(start + length, ea + size);
+		if (low < high)
+		{
+			std::memcpy(buffer + (low - ea), data + (low - start), high - low);
+		}
+	}
+
+	/**********************************************************************/
+	PageCache::PageCache(size_t maxPages)
+		: m_maxPages{ maxPages }
+	{}
+
+	/**********************************************************************/
+	void PageCache::read(const Fetch& fetch, uint64_t ea, uint8_t* buffer, size_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		auto first = ea & ~(PAGE_SIZE - 1);
+		auto last = (ea + size - 1) & ~(PAGE_SIZE - 1);
+
+		std::vector<uint64_t> missing;
+		uint64_t generation;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			generation = m_generation;
+			for (auto page = first; ; page += PAGE_SIZE)
+			{
+				auto iter = m_pages.find(page);
+				if (iter == m_pages.end())
+				{
+					missing.push_back(page);
+				}
+				else
+				{
+					_CopyOverlap(page, iter->second.data(), PAGE_SIZE, ea, buffer, size);
+				}
+
+				if (page == last)
+				{
+					break;
+				}
+			}
+		}
+
+		// consecutive missing pages are fetched by a single read
+		size_t start = 0;
+		while (start < missing.size())
+		{
+			auto end = start + 1;
+			while (end < missing.size() && missing[end] == missing[end - 1] + PAGE_SIZE)
+			{
+				end++;
+			}
+			fetchPages(fetch, missing[start], end - start, ea, buffer, size, generation);
+			start = end;
+		}
+	}
+
+	/**********************************************************************/
+	void PageCache::fetchPages(const Fetch& fetch, uint64_t first, size_t count, uint64_t ea, uint8_t* buffer, size_t size, uint64_t generation)
+	{
+		std::vector<uint8_t> data(count * PAGE_SIZE, 0);
+		fetch(first, data.data(), data.size());
+		_CopyOverlap(first, data.data(), data.size(), ea, buffer, size);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// bytes may have been patched during the fetch
+		if (generation != m_generation || count > m_maxPages)
+		{
+			return;
+		}
+
+		if (m_pages.size() + count > m_maxPages)
+		{
+			m_pages.clear();
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			auto begin = data.begin() + i * PAGE_SIZE;
+			m_pages.try_emplace(first + i * PAGE_SIZE, begin, begin + PAGE_SIZE);
+		}
+	}
+
+	/**********************************************************************/
+	void PageCache::invalidate(uint64_t ea, size_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto last = (ea + size - 1) & ~(PAGE_SIZE - 1);
+		for (auto page = ea & ~(PAGE_SIZE - 1); ; page += PAGE_SIZE)
+		{
+			m_pages.erase(page);
+			if (page == last)
+			{
+				break;
+			}
+		}
+		m_generation++;
+	}
+
+	/**********************************************************************/
+	void PageCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pages.clear();
+		m_generation++;
+	}
+
+	/**********************************************************************/
+	size_t PageCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pages.size();
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -17,22 +17,70 @@
 #include "idatype.hh"
 #include "idasymbol.hh"
 #include "idalogger.hh"
+#include "idaloader.hh"
+#include "idaimage.hh"
+#include "idaexport.hh"
+#include "imageloader.hh"
+#include "exportloader.hh"
+#include "exportsymbol.hh"
+#include "exporttype.hh"
+#include "ghidradecompiler.hh"
+#include "batch.hh"
+#include "callgraph.hh"
+#include "library.hh"
+#include "prototype.hh"
+#include "sync.hh"
+#include "base.hh"
+#include "memory.hh"
+#include "idaview.hh"
 #include <kernwin.hpp>
 #include <loader.hpp>
+#include <funcs.hpp>
+#include <struct.hpp>
+#include <xref.hpp>
+#include <typeinf.hpp>
+#include <expr.hpp>
 #include <sstream>
 #include <algorithm>
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+#define YAGI_DECOMPILE_ALL_ACTION	"yagi:decompile_all"
+
+// title of the table of profiled functions
+#define YAGI_HOTSPOTS_TITLE		"Yagi hotspots"
+
+// IDC functions for scripts, decompile a list of functions and edit local variables
+#define YAGI_DECOMPILE_FUNC		"yagi_decompile"
+#define YAGI_EDIT_LOCALS_FUNC	"yagi_edit_locals"
+
+// time given to backend requests on each timer call, in milliseconds
+#define YAGI_PUMP_SLICE		15
+
+// number of local types translated by a background job
+// a slice is short enough to not delay a user request
+#define YAGI_PREWARM_SLICE	64
+
+// delay left to the UI between two time slices, in milliseconds
+#define YAGI_PUMP_INTERVAL	5
 
 namespace yagi 
 {
 	/**********************************************************************/
-	static void _RunYagi()
+	/*!
+	 * \brief	Run again the plugin on the current function
+	 * \param	command	how the function is decompiled
+	 */
+	static void _RunYagi(Plugin::Command command = Plugin::Command::Decompile)
 	{
 		auto plugins = get_plugins();
 		while (plugins != nullptr)
 		{
 			if (plugins->name == std::string("yagi"))
 			{
-				run_plugin(plugins->entry, 0);
+				run_plugin(plugins->entry, static_cast<size_t>(command));
 				break;
 			}
 			plugins = plugins->next;
@@ -91,57 +139,17 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	static std::optional<std::string> _ComputeKeyword(TWidget* w)
+	static const CompactResult::Symbol* _FindSymbol(TWidget* w, const CompactResult& code)
 	{
+		// x is the column without color tags
 		int x, y;
-		if (get_custom_viewer_place(w, false, &x, &y) == NULL) 
-		{
-			return std::nullopt;
-		}
-
-		auto cursor = get_custom_viewer_curline(w, false);
-		qstring result(cursor);
-
-		char* start = result.begin();
-		while (x > 0)
-		{
-			if (*start == COLOR_ON)
-			{
-				start += 2;
-				continue;
-			}
-			
-			if (*start == COLOR_OFF)
-			{
-				start += 2;
-				continue;
-			}
-
-			start++;
-			x--;
-		}
-
-		char* end = start;
-
-		while (end <= result.end() && *end != COLOR_OFF && *end != COLOR_ON && *end != '\0') {
-			end++;
-		}
-
-		while (start >= result.begin() && !(*start == COLOR_ON && !qisalnum(*(start+1)))) {
-			start--;
-		}
-
-		if (start + 2 >= end)
-		{
-			return std::nullopt;
-		}
-
-		if (start >= result.end())
+		auto place = static_cast<LinePlace*>(get_custom_viewer_place(w, false, &x, &y));
+		if (place == nullptr || x < 0)
 		{
-			return std::nullopt;
+			return nullptr;
 		}
 
-		return std::string(start + 2, end - start - 2);
+		return code.findSymbol(static_cast<uint32_t>(place->n), static_cast<uint32_t>(x));
 	}
 
 	/**********************************************************************/
@@ -152,38 +160,44 @@ namespace yagi
 			return false;
 		}
 
-		auto keyword = _ComputeKeyword(w);
-
-		if (!keyword.has_value())
+		auto viewer = static_cast<Viewer*>(ud);
+		if (key == IK_ESCAPE)
 		{
-			return false;
+			// nothing to cancel, IDA closes the view
+			if (viewer->plugin == nullptr || !viewer->plugin->isBusy())
+			{
+				return false;
+			}
+
+			_RunYagi(Plugin::Command::Cancel);
+			return true;
 		}
 
-		auto code = static_cast<Decompiler::Result*>(ud);
-		auto addr = code->symbolAddress.find(keyword.value());
+		auto code = &viewer->code;
+		auto symbol = _FindSymbol(w, *code);
 
-		if (addr == code->symbolAddress.end())
+		if (symbol == nullptr)
 		{
 			return false;
 		}
 
-		auto functionSymbolInfo = IdaSymbolInfoFactory().find_function(code->ea);
+		auto functionSymbolInfo = IdaSymbolInfoFactory().find_function(code->getEa());
 
 		switch (key)
 		{
 		case 'X':
 			// RAM xref
-			if (addr->second.spaceName == "ram")
+			if (symbol->space == SpaceId::Ram)
 			{
-				open_xrefs_window(addr->second.offset);
+				open_xrefs_window(symbol->offset);
 			}
 			break;
 		case 'N':
 			{
 				// RAM rename
-				if (addr->second.spaceName == "ram")
+				if (symbol->space == SpaceId::Ram)
 				{
-					auto symbolInfo = IdaSymbolInfoFactory().find(addr->second.offset);
+					auto symbolInfo = IdaSymbolInfoFactory().find(symbol->offset);
 					if (!symbolInfo.has_value())
 					{
 						return false;
@@ -192,7 +206,7 @@ namespace yagi
 					auto name = qstring(symbolInfo.value()->getName().c_str());
 					if (ask_str(&name, HIST_IDENT, "Please enter item name"))
 					{
-						set_name(addr->second.offset, name.c_str());
+						set_name(symbol->offset, name.c_str());
 						_RunYagi();
 					}
 				}
@@ -203,11 +217,12 @@ namespace yagi
 						return false;
 					}
 
-					auto name = qstring(keyword.value().c_str());
+					auto name = qstring(std::string(code->getSymbolName(*symbol)).c_str());
 					if (ask_str(&name, HIST_IDENT, "Please enter item name"))
 					{
-						functionSymbolInfo.value()->saveName(addr->second, name.c_str());
-						_RunYagi();
+						functionSymbolInfo.value()->saveName(code->getLocation(*symbol), name.c_str());
+						// only names changed, dataflow can be kept
+						_RunYagi(Plugin::Command::RefreshNames);
 					}
 				}
 			}
@@ -215,12 +230,12 @@ namespace yagi
 		case 'Y':
 			{
 				// RAM retype
-				if (addr->second.spaceName == "ram")
+				if (symbol->space == SpaceId::Ram)
 				{
-					auto typeInfo = IdaTypeInfoFactory().build(addr->second.offset);
+					auto typeInfo = IdaTypeInfoFactory().build(symbol->offset);
 					if (typeInfo.has_value())
 					{
-						auto name = qstring(_PrintDeclType(keyword.value(), *typeInfo.value().get()).c_str());
+						auto name = qstring(_PrintDeclType(std::string(code->getSymbolName(*symbol)), *typeInfo.value().get()).c_str());
 
 						if (ask_str(&name, HIST_TYPE, "Please enter the type declaration"))
 						{
@@ -228,7 +243,7 @@ namespace yagi
 							qstring parsedName;
 							if (parse_decl(&idaTypeInfo, &parsedName, nullptr, name.c_str(), PT_TYP))
 							{
-								set_tinfo(addr->second.offset, &idaTypeInfo);
+								set_tinfo(symbol->offset, &idaTypeInfo);
 								_RunYagi();
 							}
 						}
@@ -244,7 +259,7 @@ namespace yagi
 						if (parse_decl(&idaTypeInfo, &parsedName, nullptr, name.c_str(), PT_TYP))
 						{
 							auto typeInfo = IdaTypeInfoFactory().build(idaTypeInfo);
-							functionSymbolInfo.value()->saveType(addr->second, *(typeInfo.value()));
+							functionSymbolInfo.value()->saveType(code->getLocation(*symbol), *(typeInfo.value()));
 							_RunYagi();
 						}
 					}
@@ -252,9 +267,9 @@ namespace yagi
 			}
 			break;
 		case 'C':
-			if (functionSymbolInfo.value()->clearType(addr->second))
+			if (functionSymbolInfo.value()->clearType(code->getLocation(*symbol)))
 			{
-				IdaLogger().info("Clear type for symbol : ", addr->first);
+				IdaLogger().info("Clear type for symbol : ", std::string(code->getSymbolName(*symbol)));
 				_RunYagi();
 			}
 			break;
@@ -266,39 +281,36 @@ namespace yagi
 	/**********************************************************************/
 	static void idaapi _Close(TWidget* cv, void* ud)
 	{
-		auto code = static_cast<Decompiler::Result*>(ud);
-		delete code;
+		auto viewer = static_cast<Viewer*>(ud);
+		if (viewer->plugin != nullptr)
+		{
+			viewer->plugin->close(*viewer);
+		}
+		delete viewer;
 	}
 
 	/**********************************************************************/
 	static bool idaapi _DoubleClickCallback(TWidget* w, int shift, void* ud) 
 	{
-		auto code = static_cast<Decompiler::Result*>(ud);
-		auto keyword = _ComputeKeyword(w);
-		if (!keyword.has_value())
-		{
-			return false;
-		}
+		auto code = &static_cast<Viewer*>(ud)->code;
+		auto symbol = _FindSymbol(w, *code);
 
-		auto addr = code->symbolAddress.find(keyword.value());
-
-		if (addr == code->symbolAddress.end())
+		if (symbol == nullptr)
 		{
-			IdaLogger().info("Symbol not found : ", keyword.value());
 			return false;
 		}
 
-		if (addr->second.spaceName == "ram")
+		if (symbol->space == SpaceId::Ram)
 		{
-			return jumpto(addr->second.offset);
+			return jumpto(symbol->offset);
 		}
-		else if (addr->second.spaceName == "stack" || addr->second.spaceName == "const")
+		else if (symbol->space == SpaceId::Stack || symbol->space == SpaceId::Const)
 		{
-			auto idaFunc = get_func(code->ea);
-			auto offset = addr->second.offset;
+			auto idaFunc = get_func(code->getEa());
+			auto offset = symbol->offset;
 			// As ghidra handle 32 bit address even in 64 bits
 			// and stack address cound be negative
-			if (addr->second.addrSize == 4 && (int32_t)addr->second.offset < 0)
+			if (symbol->addrSize == 4 && (int32_t)symbol->offset < 0)
 			{
 				offset = 0xFFFFFFFF00000000 | offset;
 			}
@@ -309,6 +321,167 @@ namespace yagi
 		return false;
 	}
 
+	/**********************************************************************/
+	static void _CloseViewer(const std::string& name)
+	{
+		auto widget = find_widget(name.c_str());
+		if (widget != nullptr)
+		{
+			close_widget(widget, 0);
+		}
+	}
+
+	/**********************************************************************/
+	static int idaapi _PumpCallback(void* ud)
+	{
+		return static_cast<Plugin*>(ud)->pump();
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	plugin answering yagi_decompile, null when unloaded
+	 */
+	static Plugin* s_scriptPlugin = nullptr;
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Parse addresses separated by spaces or commas
+	 * \param	text	decimal or 0x prefixed addresses
+	 * \return	nullopt if an address is malformed
+	 */
+	static std::optional<std::vector<uint64_t>> _ParseAddresses(const std::string& text)
+	{
+		auto normalized = text;
+		std::replace(normalized.begin(), normalized.end(), ',', ' ');
+
+		std::vector<uint64_t> addresses;
+		std::istringstream stream(normalized);
+		std::string token;
+		while (stream >> token)
+		{
+			size_t end = 0;
+			try
+			{
+				addresses.push_back(std::stoull(token, &end, 0));
+			}
+			catch (std::exception&)
+			{
+				return std::nullopt;
+			}
+
+			if (end != token.size())
+			{
+				return std::nullopt;
+			}
+		}
+		return addresses;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	yagi_decompile("0x401000 0x402000")
+	 *			Return a JSON array of results, see JsonBatchOutput
+	 *			or 0 if the addresses are malformed or the decompiler is unavailable
+	 */
+	static error_t idaapi _IdcDecompile(idc_value_t* argv, idc_value_t* res)
+	{
+		res->set_long(0);
+
+		auto addresses = _ParseAddresses(argv[0].c_str());
+		if (!addresses.has_value())
+		{
+			IdaLogger().error("Malformed address list", argv[0].c_str());
+			return eOk;
+		}
+
+		std::ostringstream json;
+		JsonBatchOutput output(json);
+		if (s_scriptPlugin != nullptr && s_scriptPlugin->decompileFunctions(addresses.value(), output))
+		{
+			output.close();
+			res->set_string(json.str().c_str());
+		}
+		return eOk;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	yagi_edit_locals("0x401000", "uVar1=count\nlocal_10:char *")
+	 *			One edit per line, = renames and : retypes a variable
+	 *			Return the number of edits applied
+	 */
+	static error_t idaapi _IdcEditLocals(idc_value_t* argv, idc_value_t* res)
+	{
+		res->set_long(0);
+
+		auto addresses = _ParseAddresses(argv[0].c_str());
+		if (!addresses.has_value() || addresses.value().size() != 1)
+		{
+			IdaLogger().error("Malformed function address", argv[0].c_str());
+			return eOk;
+		}
+
+		std::vector<LocalEdit> edits;
+		for (auto& line : split(argv[1].c_str(), '\n'))
+		{
+			auto separator = line.find_first_of("=:");
+			if (separator == std::string::npos)
+			{
+				continue;
+			}
+
+			auto name = line.substr(0, separator);
+			auto value = line.substr(separator + 1);
+			name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+			value.erase(0, value.find_first_not_of(' '));
+			if (name.empty() || value.empty())
+			{
+				continue;
+			}
+
+			if (line[separator] == '=')
+			{
+				edits.push_back(LocalEdit{ name, value, "" });
+			}
+			else
+			{
+				edits.push_back(LocalEdit{ name, "", value });
+			}
+		}
+
+		if (s_scriptPlugin != nullptr)
+		{
+			res->set_long(s_scriptPlugin->editLocals(addresses.value().front(), edits));
+		}
+		return eOk;
+	}
+
+	/**********************************************************************/
+	static const char _IdcDecompileArgs[] = { VT_STR, 0 };
+
+	/**********************************************************************/
+	static const ext_idcfunc_t _IdcDecompileDesc = {
+		YAGI_DECOMPILE_FUNC,
+		_IdcDecompile,
+		_IdcDecompileArgs,
+		nullptr,
+		0,
+		0
+	};
+
+	/**********************************************************************/
+	static const char _IdcEditLocalsArgs[] = { VT_STR, VT_STR, 0 };
+
+	/**********************************************************************/
+	static const ext_idcfunc_t _IdcEditLocalsDesc = {
+		YAGI_EDIT_LOCALS_FUNC,
+		_IdcEditLocals,
+		_IdcEditLocalsArgs,
+		nullptr,
+		0,
+		0
+	};
+
 	/**********************************************************************/
 	static const custom_viewer_handlers_t _ViewHandlers(
 		_KeyboardCallback,
@@ -323,46 +496,1417 @@ namespace yagi
 	);
 
 	/**********************************************************************/
-	Plugin::Plugin(std::unique_ptr<Decompiler> decompiler)
-		: m_decompiler(std::move(decompiler))
-	{}
+	/*!
+	 * \brief	Database events that can change decompilation output
+	 *			of any function (callee renamed, global retyped, etc...)
+	 *			Changes of a single item only forget results that read it
+	 */
+	static ssize_t idaapi _IdbCallback(void* ud, int code, va_list va)
+	{
+		auto plugin = static_cast<Plugin*>(ud);
+		switch (code)
+		{
+		case idb_event::byte_patched:
+			{
+				auto ea = va_arg(va, ea_t);
+				plugin->updateImage(ea, 1);
+				plugin->invalidateCode(ea);
+				// the patched function is found by its content hash
+				plugin->invalidateDependents(get_item_head(ea));
+			}
+			break;
+		case idb_event::segm_added:
+		case idb_event::segm_deleted:
+		case idb_event::segm_start_changed:
+		case idb_event::segm_end_changed:
+		case idb_event::segm_moved:
+			// import segments can be created or removed
+			plugin->invalidateImports();
+			plugin->invalidateSegments();
+			plugin->invalidateNames();
+			plugin->reloadImage();
+			plugin->clearCache();
+			break;
+		case idb_event::segm_name_changed:
+		case idb_event::segm_attrs_updated:
+			// read only state of globals may change
+			plugin->invalidateSegments();
+			plugin->clearCache();
+			break;
+		case idb_event::renamed:
+			{
+				auto ea = va_arg(va, ea_t);
+				plugin->invalidateName(ea);
+				plugin->invalidateImports();
+				plugin->invalidateDependents(ea);
+			}
+			break;
+		case idb_event::local_types_changed:
+#if IDA_SDK_VERSION >= 830
+			{
+				va_arg(va, int); // local_type_change_t
+				va_arg(va, uint32);
+				auto name = va_arg(va, const char*);
+				if (name != nullptr)
+				{
+					plugin->invalidateType(name);
+				}
+				else
+				{
+					plugin->invalidateTypes();
+					plugin->clearCache();
+				}
+			}
+#else
+			plugin->invalidateTypes();
+			plugin->clearCache();
+#endif
+			break;
+		case idb_event::struc_member_renamed:
+		case idb_event::struc_member_changed:
+			{
+				auto sptr = va_arg(va, struc_t*);
+				plugin->invalidateType(get_struc_name(sptr->id).c_str());
+			}
+			break;
+		case idb_event::ti_changed:
+			plugin->invalidateDependents(va_arg(va, ea_t));
+			break;
+		case idb_event::make_data:
+			// a cached miss may now be a global
+			plugin->invalidateDependents(va_arg(va, ea_t));
+			break;
+		case idb_event::make_code:
+			plugin->invalidateDependents(va_arg(va, const insn_t*)->ea);
+			break;
+		case idb_event::func_added:
+		case idb_event::func_updated:
+		case idb_event::set_func_start:
+		case idb_event::set_func_end:
+		case idb_event::deleting_func:
+			plugin->clearCache();
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
 
 	/**********************************************************************/
-	bool idaapi Plugin::run(size_t)
+	/*!
+	 * \brief	Ask the user where to write the result of a batch
+	 * \return	the output or nullptr if canceled
+	 */
+	static std::unique_ptr<BatchOutput> _AskBatchOutput()
 	{
-		auto func_address = get_screen_ea();
+		try
+		{
+			switch (ask_buttons("~F~ile", "~D~irectory", "~C~ancel", ASKBTN_YES, "Save decompiled functions into a single file or a directory?"))
+			{
+			case ASKBTN_YES:
+				{
+					auto path = ask_file(true, "*.c", "Save decompiled functions");
+					if (path == nullptr)
+					{
+						return nullptr;
+					}
+					return std::make_unique<FileBatchOutput>(path);
+				}
+			case ASKBTN_NO:
+				{
+					qstring path;
+					if (!ask_str(&path, HIST_DIR, "Please enter the output directory"))
+					{
+						return nullptr;
+					}
+					return std::make_unique<DirectoryBatchOutput>(path.c_str());
+				}
+			default:
+				return nullptr;
+			}
+		}
+		catch (Error& e)
+		{
+			IdaLogger().error(e.what());
+			return nullptr;
+		}
+	}
 
-		auto decompilerResult = m_decompiler->decompile(func_address);
-		if (decompilerResult.has_value())
+	/**********************************************************************/
+	/*!
+	 * \brief	Directory of profiling reports
+	 *			profile_dir option or a yagi_profile directory next to the database
+	 */
+	static std::filesystem::path _ProfileDirectory(const Options& options)
+	{
+		if (!options.profileDir.empty())
 		{
-			view(decompilerResult.value().name, decompilerResult.value());
+			return options.profileDir;
 		}
-		
-		return true;
+		return std::filesystem::path(get_path(PATH_TYPE_IDB)).parent_path() / "yagi_profile";
 	}
 
 	/**********************************************************************/
-	void Plugin::view(const std::string& name, const Decompiler::Result& code) const
+	/*!
+	 * \brief	Drop results of a batch only run for its profiles
+	 */
+	class _DiscardBatchOutput : public BatchOutput
+	{
+	public:
+		void write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration) override {}
+	};
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Signature of a library function identified by FLIRT
+	 * \param	ea	address of the function
+	 * \return	nullopt if not a library function or if it can't be shared
+	 */
+	static std::optional<LibraryFunction> _FindLibraryFunction(IdaSymbolInfoFactory& factory, uint64_t ea)
 	{
-		strvec_t* sv = new strvec_t();
-		std::istringstream iss(code.cCode);
-		for (std::string line; std::getline(iss, line); )
+		auto function = factory.find_function(ea);
+		if (!function.has_value() || !function.value()->isLibrary())
 		{
-			sv->push_back(simpleline_t(line.c_str()));
+			return std::nullopt;
 		}
 
-		simpleline_place_t s1;
-		simpleline_place_t s2((int)(sv->size() - 1));
-		auto oldWidget = find_widget(name.c_str());
-		if (oldWidget != nullptr)
+		// local names or types saved by the user
+		auto hash = function.value()->getCloneHash();
+		if (hash == 0)
 		{
-			close_widget(oldWidget, 0);
+			return std::nullopt;
 		}
+		return LibraryFunction{ function.value()->getName(), hash, function.value()->getFunctionSize() };
+	}
 
-		auto w = create_custom_viewer(name.c_str(), &s1, &s2,
-			&s1, nullptr, sv, &_ViewHandlers, new Decompiler::Result(code));
-		TWidget* code_view = create_code_viewer(w);
-		set_code_viewer_is_source(code_view);
-		display_widget(code_view, WOPN_DP_TAB);
+	/**********************************************************************/
+	/*!
+	 * \brief	Calls between functions, through call and jump references
+	 * \param	functions	start address of all functions
+	 */
+	static CallGraph _BuildCallGraph(const std::vector<uint64_t>& functions)
+	{
+		CallGraph graph;
+		for (auto ea : functions)
+		{
+			graph.addFunction(ea);
+
+			xrefblk_t xr;
+			for (bool success = xr.first_to((ea_t)ea, XREF_FAR); success; success = xr.next_to()) {
+				if (xr.iscode == 0) {
+					break;
+				}
+				auto caller = get_func(xr.from);
+				if (caller != nullptr) {
+					graph.addCall(caller->start_ea, ea);
+				}
+			}
+		}
+		return graph;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Store a recovered prototype into the database
+	 *			Types set by the user are never replaced
+	 * \return	true if the prototype was applied
+	 */
+	static bool _ApplyPrototype(uint64_t ea, const Prototype& prototype)
+	{
+		if (is_userti((ea_t)ea))
+		{
+			return false;
+		}
+
+		// demangled names are not valid identifiers
+		auto declaration = prototype;
+		declaration.name = "sub_" + to_hex(ea);
+
+		tinfo_t idaTypeInfo;
+		qstring parsedName;
+		if (!parse_decl(&idaTypeInfo, &parsedName, nullptr, (declaration.toDeclaration() + ";").c_str(), PT_TYP | PT_SIL))
+		{
+			return false;
+		}
+		return apply_tinfo((ea_t)ea, idaTypeInfo, TINFO_GUESSED);
+	}
+
+	/**********************************************************************/
+	DecompileAllHandler::DecompileAllHandler(Plugin& plugin)
+		: m_plugin{ plugin }
+	{}
+
+	/**********************************************************************/
+	int idaapi DecompileAllHandler::activate(action_activation_ctx_t* ctx)
+	{
+		m_plugin.decompileAll();
+		return 1;
+	}
+
+	/**********************************************************************/
+	action_state_t idaapi DecompileAllHandler::update(action_update_ctx_t* ctx)
+	{
+		return AST_ENABLE_ALWAYS;
+	}
+
+	/**********************************************************************/
+	static const int _HotspotWidths[] = { 16, 32, 10, 10, 8, 8, 8, 10, 8 };
+	static const char* const _HotspotHeader[] = { "Address", "Name", "Time (ms)", "Memory (KiB)", "Ops", "Varnodes", "Blocks", "Applied", "IDA calls" };
+
+	/**********************************************************************/
+	ProfileChooser::ProfileChooser(std::vector<SummaryProfileOutput::Row> rows)
+		: chooser_t(0, qnumber(_HotspotWidths), _HotspotWidths, _HotspotHeader, YAGI_HOTSPOTS_TITLE), m_rows{ std::move(rows) }
+	{}
+
+	/**********************************************************************/
+	size_t idaapi ProfileChooser::get_count() const
+	{
+		return m_rows.size();
+	}
+
+	/**********************************************************************/
+	void idaapi ProfileChooser::get_row(qstrvec_t* cols, int* icon, chooser_item_attrs_t* attrs, size_t n) const
+	{
+		auto& row = m_rows[n];
+		std::stringstream time;
+		time << std::fixed << std::setprecision(2) << row.milliseconds;
+
+		(*cols)[0] = to_hex(row.ea).c_str();
+		(*cols)[1] = row.name.c_str();
+		(*cols)[2] = time.str().c_str();
+		(*cols)[3] = std::to_string(row.memory / 1024).c_str();
+		(*cols)[4] = std::to_string(row.ops).c_str();
+		(*cols)[5] = std::to_string(row.varnodes).c_str();
+		(*cols)[6] = std::to_string(row.blocks).c_str();
+		(*cols)[7] = std::to_string(row.applied).c_str();
+		(*cols)[8] = std::to_string(row.backend).c_str();
+	}
+
+	/**********************************************************************/
+	ea_t idaapi ProfileChooser::get_ea(size_t n) const
+	{
+		return static_cast<ea_t>(m_rows[n].ea);
+	}
+
+	/**********************************************************************/
+	chooser_t::cbret_t idaapi ProfileChooser::enter(size_t n)
+	{
+		jumpto(get_ea(n));
+		return cbret_t(n);
+	}
+
+	/**********************************************************************/
+	Plugin::Plugin(std::shared_ptr<RequestQueue> queue, std::unique_ptr<DeferredDecompiler> decompiler, Compiler compiler, Options options, std::shared_ptr<MemoryImage> image, std::shared_ptr<PageCache> pages, std::shared_ptr<IdaImportIndex> imports, std::shared_ptr<IdaSegmentIndex> segments, std::shared_ptr<IdaNameCache> names)
+		: m_queue(std::move(queue)), m_decompiler(std::move(decompiler)), m_async(*m_decompiler), m_compiler(compiler), m_options(options), m_image(std::move(image)), m_pages(std::move(pages)), m_imports(std::move(imports)), m_segments(std::move(segments)), m_names(std::move(names)),
+		m_prefetcher(m_options.cacheSize != 0 ? m_options.prefetch : 0), m_scheduler(m_options.backgroundCpu / 100.0), m_decompileAllHandler(*this)
+	{
+		if (!m_options.libraryDir.empty())
+		{
+			m_library = std::make_unique<LibraryStore>(m_options.libraryDir);
+		}
+
+		// a waiting script or command resumes as soon as the job ends
+		m_async.setNotify([queue = m_queue]() { queue->wake(); });
+
+		LinePlace::registerClass();
+		hook_to_notification_point(HT_IDB, _IdbCallback, this);
+
+		const action_desc_t decompileAll = ACTION_DESC_LITERAL_PLUGMOD(
+			YAGI_DECOMPILE_ALL_ACTION,
+			"Create C file with Yagi...",
+			&m_decompileAllHandler,
+			this,
+			nullptr,
+			"Decompile all functions using Yagi",
+			-1
+		);
+		register_action(decompileAll);
+		attach_action_to_menu("File/Produce file/", YAGI_DECOMPILE_ALL_ACTION, SETMENU_APP);
+
+		s_scriptPlugin = this;
+		add_idc_func(_IdcDecompileDesc);
+		add_idc_func(_IdcEditLocalsDesc);
+
+		// the build may wait for backend requests
+		m_timer = register_timer(YAGI_PUMP_INTERVAL, _PumpCallback, this);
+
+		if (!m_options.profileDir.empty())
+		{
+			toggleProfile();
+		}
+	}
+
+	/**********************************************************************/
+	Plugin::~Plugin()
+	{
+		// the job and the build may wait for the queue
+		stop();
+		if (m_timer != nullptr)
+		{
+			unregister_timer(m_timer);
+		}
+
+		// viewers may be closed after the plugin
+		for (auto viewer : m_viewers)
+		{
+			viewer->plugin = nullptr;
+		}
+
+		del_idc_func(YAGI_DECOMPILE_FUNC);
+		del_idc_func(YAGI_EDIT_LOCALS_FUNC);
+		s_scriptPlugin = nullptr;
+
+		detach_action_from_menu("File/Produce file/", YAGI_DECOMPILE_ALL_ACTION);
+		unregister_action(YAGI_DECOMPILE_ALL_ACTION);
+		unhook_from_notification_point(HT_IDB, _IdbCallback, this);
+	}
+
+	/**********************************************************************/
+	void Plugin::clearCache()
+	{
+		m_async.clearCache();
+		m_prefetcher.reset();
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateDependents(uint64_t ea)
+	{
+		m_async.invalidateDependents(ea);
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateCode(uint64_t ea)
+	{
+		m_async.invalidateCode(ea);
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateImports()
+	{
+		m_imports->invalidate();
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateSegments()
+	{
+		m_segments->invalidate();
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateName(uint64_t ea)
+	{
+		m_names->invalidate(ea);
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateNames()
+	{
+		m_names->invalidateAll();
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateType(const std::string& name)
+	{
+		m_async.invalidateType(name);
+		dropPrewarm();
+
+		// typedefs are translated under their own name
+		auto til = get_idati();
+		for (uint32 ordinal = 1; ordinal < get_ordinal_qty(til); ordinal++)
+		{
+			tinfo_t type;
+			qstring finalName, typedefName;
+			if (type.get_numbered_type(til, ordinal)
+				&& type.is_typeref()
+				&& type.get_final_type_name(&finalName)
+				&& name == finalName.c_str()
+				&& type.get_type_name(&typedefName))
+			{
+				m_async.invalidateType(typedefName.c_str());
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void Plugin::invalidateTypes()
+	{
+		m_async.invalidateTypes();
+		dropPrewarm();
+	}
+
+	/**********************************************************************/
+	void Plugin::updateImage(uint64_t ea, size_t size)
+	{
+		// the image is read by the running job without lock
+		if (m_image != nullptr)
+		{
+			m_async.defer([image = m_image, ea, size]() { updateIdaImage(*image, ea, size); });
+		}
+		if (m_pages != nullptr)
+		{
+			m_pages->invalidate(ea, size);
+		}
+	}
+
+	/**********************************************************************/
+	void Plugin::reloadImage()
+	{
+		if (m_image != nullptr)
+		{
+			m_async.defer([image = m_image]() { captureIdaImage(*image); });
+		}
+		if (m_pages != nullptr)
+		{
+			m_pages->clear();
+		}
+	}
+
+	/**********************************************************************/
+	void Plugin::toggleProfile()
+	{
+		if (m_profile != nullptr)
+		{
+			m_profile.reset();
+			m_async.setProfileOutput(nullptr);
+			IdaLogger().info("Profiling disabled");
+			return;
+		}
+
+		auto output = std::make_shared<DirectoryProfileOutput>(_ProfileDirectory(m_options));
+		m_profile = output;
+		m_async.setProfileOutput(m_profile);
+		IdaLogger().info("Profiling enabled, reports are written into ", output->getDirectory().string());
+	}
+
+	/**********************************************************************/
+	void Plugin::showMemory() const
+	{
+		auto usage = getProcessMemory();
+		if (!usage.has_value())
+		{
+			IdaLogger().error("Unable to read the memory of the process");
+			return;
+		}
+
+		std::stringstream ss;
+		ss << formatMemory(usage.value());
+		if (m_options.memoryLimit != 0)
+		{
+			ss << " (limit " << formatMemory(m_options.memoryLimit * 1024 * 1024) << ")";
+		}
+		IdaLogger().info("Memory used by IDA :", ss.str());
+	}
+
+	/**********************************************************************/
+	void Plugin::showScheduler()
+	{
+		auto slices = m_prewarmSource != nullptr ? (m_prewarmNames.size() - m_prewarmNext + YAGI_PREWARM_SLICE - 1) / YAGI_PREWARM_SLICE : 0;
+		m_scheduler.setPending(JobScheduler::Priority::Interactive, m_next.has_value() ? 1 : 0);
+		m_scheduler.setPending(JobScheduler::Priority::Prefetch, m_prefetcher.size());
+		m_scheduler.setPending(JobScheduler::Priority::Background, slices);
+		IdaLogger().info("Jobs :", m_scheduler.getSummary());
+	}
+
+	/**********************************************************************/
+	bool idaapi Plugin::run(size_t arg)
+	{
+		switch (static_cast<Command>(arg))
+		{
+		case Command::DecompileAll:
+			decompileAll();
+			return true;
+		case Command::Cancel:
+			m_next.reset();
+			m_prefetcher.clear();
+			m_async.cancel();
+			return true;
+		case Command::ToggleProfile:
+			toggleProfile();
+			return true;
+		case Command::Export:
+			exportDatabase();
+			return true;
+		case Command::Memory:
+			showMemory();
+			return true;
+		case Command::Scheduler:
+			showScheduler();
+			return true;
+		case Command::Hotspots:
+			profileAll();
+			return true;
+		default:
+			break;
+		}
+
+		auto func_address = get_screen_ea();
+		auto command = static_cast<Command>(arg) == Command::RefreshNames
+			? AsyncDecompiler::Command::RefreshNames
+			: AsyncDecompiler::Command::Decompile;
+
+		request(func_address, command);
+		return true;
+	}
+
+	/**********************************************************************/
+	void Plugin::request(uint64_t ea, AsyncDecompiler::Command command)
+	{
+		m_submitted = JobScheduler::Clock::now();
+
+		// the last request wins, started once the running job stopped
+		// prefetches are stopped the same way
+		if (m_async.isBusy())
+		{
+			m_next = std::make_pair(ea, command);
+			m_scheduler.preempt(JobScheduler::Priority::Interactive);
+			m_async.cancel();
+			return;
+		}
+
+		start(ea, command);
+	}
+
+	/**********************************************************************/
+	void Plugin::start(uint64_t ea, AsyncDecompiler::Command command)
+	{
+		// shared results are moved to the function, nothing to decompile
+		if (m_library != nullptr && command == AsyncDecompiler::Command::Decompile)
+		{
+			IdaSymbolInfoFactory factory(m_imports, m_segments, m_names);
+			auto library = _FindLibraryFunction(factory, ea);
+			auto result = library.has_value() ? m_library->load(ea, library.value()) : std::nullopt;
+			if (result.has_value())
+			{
+				prefetch(result.value());
+				view(std::move(result.value()));
+				return;
+			}
+		}
+
+		if (!m_async.start(ea, command, std::chrono::milliseconds(m_options.decompileBudget)))
+		{
+			return;
+		}
+		m_scheduler.start(JobScheduler::Priority::Interactive, m_submitted, JobScheduler::Clock::now());
+		m_prefetching = false;
+		m_prewarming = false;
+
+		// names are refreshed fast enough to keep the current view
+		if (command == AsyncDecompiler::Command::Decompile)
+		{
+			qstring name;
+			if (get_func_name(&name, ea) <= 0)
+			{
+				name = to_hex(ea).c_str();
+			}
+			m_placeholder = name.c_str();
+			view(Decompiler::Result(m_placeholder, ea, "// Yagi: decompiling... (Esc to cancel)", {}));
+		}
+
+		if (m_timer == nullptr)
+		{
+			m_timer = register_timer(YAGI_PUMP_INTERVAL, _PumpCallback, this);
+		}
+	}
+
+	/**********************************************************************/
+	void Plugin::show(AsyncDecompiler::Outcome outcome)
+	{
+		auto placeholder = std::move(m_placeholder);
+		m_placeholder.clear();
+
+		// the result replaces the placeholder of the same name
+		if (outcome.result.has_value() && outcome.result.value().name != placeholder && !placeholder.empty())
+		{
+			_CloseViewer(placeholder);
+		}
+
+		if (outcome.result.has_value())
+		{
+			prefetch(outcome.result.value());
+		}
+
+		switch (outcome.status)
+		{
+		case AsyncDecompiler::Status::Done:
+			view(std::move(outcome.result.value()));
+			break;
+		case AsyncDecompiler::Status::Expired:
+			if (outcome.result.has_value())
+			{
+				IdaLogger().info("Time budget exceeded, simplified output of", to_hex(outcome.ea));
+				view(std::move(outcome.result.value()));
+			}
+			else if (!placeholder.empty())
+			{
+				view(Decompiler::Result(placeholder, outcome.ea, "// Yagi: time budget exceeded", {}));
+			}
+			break;
+		case AsyncDecompiler::Status::Canceled:
+			// the next request show its own placeholder
+			if (!placeholder.empty() && !m_next.has_value())
+			{
+				view(Decompiler::Result(placeholder, outcome.ea, "// Yagi: decompilation canceled", {}));
+			}
+			break;
+		case AsyncDecompiler::Status::Failed:
+			// errors are reported by the decompiler
+			if (!placeholder.empty())
+			{
+				_CloseViewer(placeholder);
+			}
+			break;
+		}
+	}
+
+	/**********************************************************************/
+	void Plugin::prefetch(const Decompiler::Result& result)
+	{
+		m_prefetcher.schedule(result, [this](uint64_t ea) {
+			auto func = get_func(ea);
+			return func != nullptr && func->start_ea == ea && (!m_options.librarySkip || (func->flags & FUNC_LIB) == 0);
+		});
+
+		if (!m_options.prefetchCallers)
+		{
+			return;
+		}
+
+		size_t count = 0;
+		for (auto ref = get_first_cref_to(result.ea); ref != BADADDR && count < m_options.prefetch; ref = get_next_cref_to(result.ea, ref))
+		{
+			auto caller = get_func(ref);
+			if (caller != nullptr && (!m_options.librarySkip || (caller->flags & FUNC_LIB) == 0) && m_prefetcher.push(caller->start_ea))
+			{
+				count++;
+			}
+		}
+	}
+
+	/**********************************************************************/
+	bool Plugin::startBackground()
+	{
+		auto now = JobScheduler::Clock::now();
+		if (m_async.isBusy() || !m_decompiler->isBuilt() || !m_scheduler.mayStart(JobScheduler::Priority::Prefetch, now))
+		{
+			return false;
+		}
+
+		// pending prefetches are submitted with the last result
+		if (auto ea = m_prefetcher.next())
+		{
+			m_prefetching = m_async.start(ea.value(), AsyncDecompiler::Command::Decompile, std::chrono::milliseconds(m_options.decompileBudget));
+			if (m_prefetching)
+			{
+				m_scheduler.start(JobScheduler::Priority::Prefetch, now, now);
+			}
+			return m_prefetching;
+		}
+
+		// types are read on the main thread, once
+		// the decompiler thread translates them from the snapshot
+		if (m_options.prewarmTypes && !m_prewarmTaken)
+		{
+			m_prewarmTaken = true;
+			auto view = snapshotIdaTypes(m_compiler);
+			if (view != nullptr)
+			{
+				for (auto& named : view->getNamedTypes())
+				{
+					m_prewarmNames.emplace_back(view->getString(named.name));
+				}
+				m_prewarmSource = std::make_shared<ExportTypeInfoFactory>(view);
+			}
+		}
+
+		if (m_prewarmSource == nullptr || m_prewarmNext >= m_prewarmNames.size())
+		{
+			dropPrewarm();
+			return false;
+		}
+
+		auto last = std::min(m_prewarmNext + YAGI_PREWARM_SLICE, m_prewarmNames.size());
+		std::vector<std::string> slice(m_prewarmNames.begin() + m_prewarmNext, m_prewarmNames.begin() + last);
+		m_prewarming = m_async.startPrewarm(m_prewarmSource, std::move(slice));
+		if (m_prewarming)
+		{
+			m_scheduler.start(JobScheduler::Priority::Background, now, now);
+		}
+		return m_prewarming;
+	}
+
+	/**********************************************************************/
+	bool Plugin::isBusy() const noexcept
+	{
+		return m_async.isBusy();
+	}
+
+	/**********************************************************************/
+	bool Plugin::hasBackground() const noexcept
+	{
+		return !m_prefetcher.empty()
+			|| (m_options.prewarmTypes && !m_prewarmTaken)
+			|| (m_prewarmSource != nullptr && m_prewarmNext < m_prewarmNames.size());
+	}
+
+	/**********************************************************************/
+	bool Plugin::end(const AsyncDecompiler::Outcome& outcome)
+	{
+		m_scheduler.end(JobScheduler::Clock::now());
+
+		if (m_prewarming)
+		{
+			// a canceled slice is started again once idle
+			m_prewarming = false;
+			if (outcome.status != AsyncDecompiler::Status::Canceled)
+			{
+				m_prewarmNext = std::min(m_prewarmNext + YAGI_PREWARM_SLICE, m_prewarmNames.size());
+			}
+			return true;
+		}
+
+		auto prefetching = m_prefetching;
+		m_prefetching = false;
+
+		// a canceled prefetch is not cached, the callee can be scheduled again
+		if (prefetching && outcome.status == AsyncDecompiler::Status::Canceled)
+		{
+			m_prefetcher.forget(outcome.ea);
+		}
+		return prefetching;
+	}
+
+	/**********************************************************************/
+	void Plugin::dropPrewarm()
+	{
+		m_prewarmSource.reset();
+		m_prewarmNames.clear();
+		m_prewarmNext = 0;
+	}
+
+	/**********************************************************************/
+	int Plugin::pump()
+	{
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(YAGI_PUMP_SLICE);
+		while (m_async.isBusy() || !m_decompiler->isBuilt() || startBackground())
+		{
+			auto now = std::chrono::steady_clock::now();
+			if (now >= end)
+			{
+				return YAGI_PUMP_INTERVAL;
+			}
+			m_queue->process(std::chrono::duration_cast<std::chrono::milliseconds>(end - now));
+
+			auto outcome = m_async.poll();
+			if (!outcome.has_value())
+			{
+				continue;
+			}
+
+			// prefetched results are already into the cache
+			if (!end(outcome.value()))
+			{
+				show(std::move(outcome.value()));
+			}
+
+			if (m_next.has_value())
+			{
+				auto next = m_next.value();
+				m_next.reset();
+				start(next.first, next.second);
+			}
+			else
+			{
+				startBackground();
+			}
+		}
+
+		// flush posted requests (log messages)
+		m_queue->process(std::chrono::milliseconds(0));
+
+		// background jobs wait for their share of the decompiler
+		if (m_decompiler->isBuilt() && hasBackground())
+		{
+			auto delay = m_scheduler.getDelay(JobScheduler::Clock::now()).count();
+			return static_cast<int>(std::max<int64_t>(delay, YAGI_PUMP_INTERVAL));
+		}
+
+		m_timer = nullptr;
+		return -1;
+	}
+
+	/**********************************************************************/
+	std::optional<AsyncDecompiler::Outcome> Plugin::stop()
+	{
+		m_next.reset();
+		m_prefetcher.clear();
+		m_async.cancel();
+
+		std::optional<AsyncDecompiler::Outcome> result;
+		while (m_async.isBusy() || !m_decompiler->isBuilt())
+		{
+			m_queue->process(std::chrono::milliseconds(50));
+			auto outcome = m_async.poll();
+			if (outcome.has_value() && !end(outcome.value()))
+			{
+				result = std::move(outcome);
+			}
+		}
+		m_queue->process(std::chrono::milliseconds(0));
+		return result;
+	}
+
+	/**********************************************************************/
+	void Plugin::decompileAll()
+	{
+		auto output = _AskBatchOutput();
+		if (output == nullptr)
+		{
+			return;
+		}
+
+		std::vector<uint64_t> functions;
+		for (size_t i = 0; i < get_func_qty(); i++)
+		{
+			auto func = getn_func(i);
+			if (func != nullptr)
+			{
+				functions.push_back(func->start_ea);
+			}
+		}
+
+		// library functions are skipped or served from the shared results
+		// the others are saved there once decompiled
+		size_t served = 0, skipped = 0;
+		std::unordered_map<uint64_t, LibraryFunction> libraryFunctions;
+		if (m_library != nullptr || m_options.librarySkip)
+		{
+			IdaSymbolInfoFactory factory(m_imports, m_segments, m_names);
+			std::vector<uint64_t> remaining;
+			for (auto ea : functions)
+			{
+				auto func = get_func(ea);
+				if ((func->flags & FUNC_LIB) == 0)
+				{
+					remaining.push_back(ea);
+					continue;
+				}
+
+				auto library = m_library != nullptr ? _FindLibraryFunction(factory, ea) : std::nullopt;
+				auto result = library.has_value() ? m_library->load(ea, library.value()) : std::nullopt;
+				if (result.has_value())
+				{
+					output->write(ea, result, 0);
+					served++;
+				}
+				else if (m_options.librarySkip)
+				{
+					skipped++;
+				}
+				else
+				{
+					if (library.has_value())
+					{
+						libraryFunctions.emplace(ea, std::move(library.value()));
+					}
+					remaining.push_back(ea);
+				}
+			}
+			functions = std::move(remaining);
+		}
+
+		BatchOutput* target = output.get();
+		std::unique_ptr<LibraryBatchOutput> libraryOutput;
+		if (!libraryFunctions.empty())
+		{
+			libraryOutput = std::make_unique<LibraryBatchOutput>(*output, *m_library, std::move(libraryFunctions));
+			target = libraryOutput.get();
+		}
+
+		size_t nbWorkers = m_options.batchWorkers;
+		if (nbWorkers == 0)
+		{
+			nbWorkers = std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+		nbWorkers = std::min(nbWorkers, std::max<size_t>(1, functions.size()));
+
+		// IDA API is only available from the main thread
+		// every backend access of workers goes through the queue
+		RequestQueue queue;
+
+		// prototypes recovered by a wave are used by the next ones
+		// without being translated again from the database
+		std::shared_ptr<PrototypeStore> prototypes;
+		if (m_options.batchPropagate)
+		{
+			prototypes = std::make_shared<PrototypeStore>();
+		}
+
+		// symbols and types are read from a snapshot of the whole database
+		// so workers never wait for the main thread
+		std::shared_ptr<const ExportView> snapshot;
+		std::shared_ptr<const MemoryImage> image = m_image;
+		if (m_options.batchSnapshot)
+		{
+			show_wait_box("HIDECANCEL\nYagi: capturing database");
+			snapshot = snapshotIdaDatabase(m_imports, m_compiler);
+			hide_wait_box();
+		}
+		else if (image == nullptr)
+		{
+			// bytes are read from a snapshot, without going through the queue
+			show_wait_box("HIDECANCEL\nYagi: capturing segments");
+			auto capture = std::make_shared<MemoryImage>();
+			captureIdaImage(*capture);
+			image = capture;
+			hide_wait_box();
+		}
+
+		// architectures are initialized sequentially from the main thread
+		// because the Ghidra spec parser use a global state
+		// so the interactive decompiler must be fully built and idle
+		auto canceled = stop();
+		if (canceled.has_value())
+		{
+			show(std::move(canceled.value()));
+		}
+
+		if (!m_decompiler->wait())
+		{
+			return;
+		}
+
+		show_wait_box("HIDECANCEL\nYagi: loading decompilers");
+		auto workers = loadWorkers(nbWorkers, queue, snapshot, image, prototypes, m_profile);
+		hide_wait_box();
+
+		if (workers.empty())
+		{
+			IdaLogger().error("Unable to load decompilers for the batch");
+			return;
+		}
+
+		BatchDecompiler batch(queue, std::move(workers));
+		if (m_options.batchDedup)
+		{
+			// keys are computed before each wave on the main thread
+			batch.setCloneKey([this](uint64_t ea) -> std::optional<BatchDecompiler::CloneKey> {
+				auto function = IdaSymbolInfoFactory(m_imports, m_segments, m_names).find_function(ea);
+				if (!function.has_value())
+				{
+					return std::nullopt;
+				}
+
+				auto hash = function.value()->getCloneHash();
+				if (hash == 0)
+				{
+					return std::nullopt;
+				}
+				return BatchDecompiler::CloneKey{ hash, function.value()->getFunctionSize(), function.value()->getName() };
+			});
+		}
+
+		auto progress = [](size_t done, size_t total) {
+			replace_wait_box("Yagi: %" FMT_Z " / %" FMT_Z " functions decompiled", done, total);
+			return !user_cancelled();
+		};
+
+		show_wait_box("Yagi: decompiling functions");
+		BatchDecompiler::Report report;
+		size_t applied = 0;
+		if (prototypes != nullptr)
+		{
+			// callees are decompiled before their callers
+			auto waves = _BuildCallGraph(functions).getWaves();
+			report = batch.run(waves, *target, progress, [&](const std::vector<std::pair<uint64_t, std::shared_ptr<const Prototype>>>& recovered) {
+				// workers are idle between waves
+				for (auto& prototype : recovered)
+				{
+					// callers of a function typed by the user keep using its type
+					if (is_userti((ea_t)prototype.first))
+					{
+						continue;
+					}
+
+					prototypes->add(prototype.first, prototype.second);
+					if (_ApplyPrototype(prototype.first, *prototype.second))
+					{
+						applied++;
+					}
+				}
+			});
+		}
+		else
+		{
+			report = batch.run(functions, *target, progress);
+		}
+		hide_wait_box();
+
+		std::stringstream ss;
+		ss << report.decompiled << " functions decompiled, " << report.failed << " failed in " << (report.duration / 1000.0) << "s";
+		if (report.reused != 0)
+		{
+			ss << ", " << report.reused << " identical functions reused";
+		}
+		if (served != 0 || skipped != 0)
+		{
+			ss << ", " << served << " library functions served and " << skipped << " skipped";
+		}
+		if (prototypes != nullptr)
+		{
+			ss << ", " << applied << " prototypes stored";
+		}
+		if (report.canceled)
+		{
+			ss << " (canceled)";
+		}
+		IdaLogger().info("Batch", ss.str());
+	}
+
+	/**********************************************************************/
+	void Plugin::profileAll()
+	{
+		std::vector<uint64_t> functions;
+		for (size_t i = 0; i < get_func_qty(); i++)
+		{
+			auto func = getn_func(i);
+			if (func != nullptr)
+			{
+				functions.push_back(func->start_ea);
+			}
+		}
+
+		// the sample is spread over the whole database
+		auto sample = m_options.profileSample;
+		if (sample != 0 && sample < functions.size())
+		{
+			std::vector<uint64_t> sampled;
+			for (size_t i = 0; i < sample; i++)
+			{
+				sampled.push_back(functions[i * functions.size() / sample]);
+			}
+			functions = std::move(sampled);
+		}
+
+		std::shared_ptr<const MemoryImage> image = m_image;
+		if (image == nullptr)
+		{
+			show_wait_box("HIDECANCEL\nYagi: capturing segments");
+			auto capture = std::make_shared<MemoryImage>();
+			captureIdaImage(*capture);
+			image = capture;
+			hide_wait_box();
+		}
+
+		// see decompileAll, worker architectures are initialized from the main thread
+		auto canceled = stop();
+		if (canceled.has_value())
+		{
+			show(std::move(canceled.value()));
+		}
+
+		if (!m_decompiler->wait())
+		{
+			return;
+		}
+
+		// a single worker without cache nor snapshot
+		// so every function is analyzed, requests to IDA are counted
+		// and the memory growth of the process is its own
+		RequestQueue queue;
+		auto summary = std::make_shared<SummaryProfileOutput>(m_profile);
+		show_wait_box("HIDECANCEL\nYagi: loading decompilers");
+		auto workers = loadWorkers(1, queue, nullptr, image, nullptr, summary);
+		hide_wait_box();
+
+		if (workers.empty())
+		{
+			IdaLogger().error("Unable to load a decompiler for the profile");
+			return;
+		}
+
+		BatchDecompiler batch(queue, std::move(workers));
+		_DiscardBatchOutput output;
+		show_wait_box("Yagi: profiling functions");
+		auto report = batch.run(functions, output, [](size_t done, size_t total) {
+			replace_wait_box("Yagi: %" FMT_Z " / %" FMT_Z " functions profiled", done, total);
+			return !user_cancelled();
+		});
+		hide_wait_box();
+
+		auto path = _ProfileDirectory(m_options) / "hotspots.csv";
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+		std::ofstream csv(path);
+		if (csv.is_open())
+		{
+			summary->writeCsv(csv, SummaryProfileOutput::Column::Time);
+
+			std::stringstream ss;
+			ss << report.decompiled << " functions profiled, " << report.failed << " failed";
+			if (report.canceled)
+			{
+				ss << " (canceled)";
+			}
+			ss << ", report written into " << path.string();
+			IdaLogger().info("Profile", ss.str());
+		}
+		else
+		{
+			IdaLogger().error("Unable to write", path.string());
+		}
+
+		// the table is deleted by IDA once closed
+		close_chooser(YAGI_HOTSPOTS_TITLE);
+		(new ProfileChooser(summary->getRows(SummaryProfileOutput::Column::Time)))->choose();
+	}
+
+	/**********************************************************************/
+	std::vector<std::unique_ptr<Decompiler>> Plugin::loadWorkers(size_t count, RequestQueue& queue, std::shared_ptr<const ExportView> snapshot, std::shared_ptr<const MemoryImage> image, std::shared_ptr<PrototypeStore> prototypes, std::shared_ptr<ProfileOutput> profile)
+	{
+		// workers are only used during the batch, no need to cache results
+		auto workerOptions = m_options;
+		workerOptions.cacheSize = 0;
+
+		std::vector<std::unique_ptr<Decompiler>> workers;
+		for (size_t i = 0; i < count; i++)
+		{
+			std::unique_ptr<LoaderFactory> loader;
+			std::unique_ptr<SymbolInfoFactory> symbols;
+			std::unique_ptr<TypeInfoFactory> types;
+			if (snapshot != nullptr)
+			{
+				loader = std::make_unique<ExportLoaderFactory>(snapshot);
+				symbols = std::make_unique<ExportSymbolInfoFactory>(snapshot, m_options.readOnlySegments);
+				types = std::make_unique<ExportTypeInfoFactory>(snapshot);
+			}
+			else
+			{
+				loader = std::make_unique<ImageLoaderFactory>(image);
+				symbols = std::make_unique<SyncSymbolInfoFactory>(queue, std::make_unique<IdaSymbolInfoFactory>(m_imports, m_segments, m_names));
+				types = std::make_unique<SyncTypeInfoFactory>(queue, std::make_unique<IdaTypeInfoFactory>());
+			}
+
+			if (prototypes != nullptr)
+			{
+				types = std::make_unique<PrototypeTypeInfoFactory>(std::move(types), prototypes);
+			}
+
+			// messages are always printed from the main thread
+			auto worker = GhidraDecompiler::build(
+				m_compiler,
+				workerOptions,
+				std::move(loader),
+				std::make_unique<SyncLogger>(queue, std::make_unique<IdaLogger>(m_options.logLevel)),
+				std::move(symbols),
+				std::move(types),
+				nullptr
+			);
+
+			if (!worker.has_value())
+			{
+				break;
+			}
+			worker.value()->setProfileOutput(profile);
+			workers.push_back(std::move(worker.value()));
+		}
+		return workers;
+	}
+
+	/**********************************************************************/
+	bool Plugin::decompileFunctions(const std::vector<uint64_t>& functions, BatchOutput& output)
+	{
+		// the interactive decompiler is reused with its cache
+		auto canceled = stop();
+		if (canceled.has_value())
+		{
+			show(std::move(canceled.value()));
+		}
+
+		if (!m_decompiler->wait())
+		{
+			return false;
+		}
+
+		// no wait box, the UI must not run the pump while results are collected
+		for (auto ea : functions)
+		{
+			// the simplified output of an expired budget is still returned
+			auto outcome = wait(ea, AsyncDecompiler::Command::Decompile);
+			output.write(ea, outcome.result, outcome.duration);
+		}
+
+		// flush posted requests (log messages)
+		m_queue->process(std::chrono::milliseconds(0));
+		return true;
+	}
+
+	/**********************************************************************/
+	AsyncDecompiler::Outcome Plugin::wait(uint64_t ea, AsyncDecompiler::Command command)
+	{
+		auto now = JobScheduler::Clock::now();
+		m_async.start(ea, command, std::chrono::milliseconds(m_options.decompileBudget));
+		m_scheduler.start(JobScheduler::Priority::Interactive, now, now);
+
+		// the queue is woken at the end of the job, see setNotify
+		auto outcome = m_async.poll();
+		while (!outcome.has_value())
+		{
+			m_queue->process(std::chrono::milliseconds(50));
+			outcome = m_async.poll();
+		}
+		m_scheduler.end(JobScheduler::Clock::now());
+		return std::move(outcome.value());
+	}
+
+	/**********************************************************************/
+	size_t Plugin::editLocals(uint64_t ea, const std::vector<LocalEdit>& edits)
+	{
+		auto func = get_func(ea);
+		if (func == nullptr)
+		{
+			IdaLogger().error("No function at ", to_hex(ea));
+			return 0;
+		}
+
+		// variables are found by their printed name, the viewer shows it
+		auto viewer = std::find_if(m_viewers.begin(), m_viewers.end(), [func](const Viewer* open) {
+			return open->code.getEa() == func->start_ea;
+		});
+
+		std::optional<CompactResult> waited;
+		const CompactResult* code = nullptr;
+		if (viewer != m_viewers.end())
+		{
+			code = &(*viewer)->code;
+		}
+		else
+		{
+			auto canceled = stop();
+			if (canceled.has_value())
+			{
+				show(std::move(canceled.value()));
+			}
+			if (!m_decompiler->wait())
+			{
+				return 0;
+			}
+			auto result = wait(func->start_ea, AsyncDecompiler::Command::Decompile).result;
+			m_queue->process(std::chrono::milliseconds(0));
+			if (result.has_value())
+			{
+				code = &waited.emplace(std::move(result.value()));
+			}
+		}
+
+		if (code == nullptr)
+		{
+			return 0;
+		}
+
+		IdaLocalTransaction transaction(func->start_ea);
+		size_t applied = 0;
+		for (auto& edit : edits)
+		{
+			auto symbol = code->findSymbol(edit.name);
+			if (symbol == nullptr || symbol->space == SpaceId::Ram)
+			{
+				IdaLogger().error("Unknown local variable ", edit.name);
+				continue;
+			}
+
+			if (!edit.type.empty())
+			{
+				tinfo_t idaTypeInfo;
+				qstring parsedName;
+				std::optional<std::unique_ptr<TypeInfo>> typeInfo;
+				if (parse_decl(&idaTypeInfo, &parsedName, nullptr, edit.type.c_str(), PT_TYP))
+				{
+					typeInfo = IdaTypeInfoFactory().build(idaTypeInfo);
+				}
+				if (!typeInfo.has_value())
+				{
+					IdaLogger().error("Malformed type declaration ", edit.type);
+					continue;
+				}
+				transaction.saveType(code->getLocation(*symbol), *(typeInfo.value()));
+			}
+
+			if (!edit.newName.empty())
+			{
+				transaction.saveName(code->getLocation(*symbol), edit.newName);
+			}
+			applied++;
+		}
+
+		// only names changed, dataflow can be kept
+		auto command = transaction.hasTypes() ? AsyncDecompiler::Command::Decompile : AsyncDecompiler::Command::RefreshNames;
+		if (transaction.commit() != 0 && viewer != m_viewers.end())
+		{
+			request(func->start_ea, command);
+		}
+		return applied;
+	}
+
+	/**********************************************************************/
+	void Plugin::exportDatabase()
+	{
+		auto path = ask_file(true, "*.yagi", "Export database for the headless decompiler");
+		if (path == nullptr)
+		{
+			return;
+		}
+
+		std::string filename = path;
+		std::ofstream stream(filename, std::ios::binary);
+		if (!stream.is_open())
+		{
+			IdaLogger().error("Unable to open output file", filename);
+			return;
+		}
+
+		show_wait_box("HIDECANCEL\nYagi: exporting database");
+		ExportDatabase database(m_compiler);
+		exportIdaDatabase(m_imports, database);
+		database.write(stream);
+		hide_wait_box();
+
+		IdaLogger().info("Database exported into", filename, ":", database.getFunctions().size(), "functions");
+	}
+
+	/**********************************************************************/
+	void Plugin::view(Decompiler::Result code)
+	{
+		// only lines on screen are built, the code is moved into the store
+		CompactResult compact(std::move(code));
+		LineStore lines(compact.takeCode());
+
+		auto name = compact.getName();
+
+		LinePlace s1;
+		LinePlace s2(lines.size() - 1);
+		auto oldWidget = find_widget(name.c_str());
+		if (oldWidget != nullptr)
+		{
+			close_widget(oldWidget, 0);
+		}
+
+		// the analysis is kept for renames while the function is shown
+		auto viewer = new Viewer{ this, std::move(compact), std::move(lines) };
+		m_viewers.insert(viewer);
+		m_async.retain(viewer->code.getEa());
+
+		auto w = create_custom_viewer(name.c_str(), &s1, &s2,
+			&s1, nullptr, &viewer->lines, &_ViewHandlers, viewer);
+		TWidget* code_view = create_code_viewer(w);
+		set_code_viewer_is_source(code_view);
+		display_widget(code_view, WOPN_DP_TAB);
+	}
+
+	/**********************************************************************/
+	void Plugin::close(Viewer& viewer)
+	{
+		m_viewers.erase(&viewer);
+		m_async.release(viewer.code.getEa());
 	}
 } // end of namespace yagi
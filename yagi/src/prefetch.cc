@@ -0,0 +1,101 @@
+#include "prefetch.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	Prefetcher::Prefetcher(size_t limit)
+		: m_limit{ limit }
+	{}
+
+	/**********************************************************************/
+	void Prefetcher::schedule(const Decompiler::Result& result, const Filter& isFunction)
+	{
+		clear();
+		m_seen.insert(result.ea);
+
+		// tokens are sorted by position
+		for (auto& token : result.tokens)
+		{
+			if (m_pending.size() >= m_limit)
+			{
+				break;
+			}
+
+			// the token stream also holds tokens without symbol
+			if (token.symbol >= result.symbols.size())
+			{
+				continue;
+			}
+
+			auto& location = result.symbols[token.symbol].location;
+			if (location.spaceName != "ram" || m_seen.count(location.offset) != 0)
+			{
+				continue;
+			}
+
+			if (isFunction(location.offset))
+			{
+				push(location.offset);
+			}
+		}
+	}
+
+	/**********************************************************************/
+	bool Prefetcher::push(uint64_t ea)
+	{
+		if (m_limit == 0 || !m_seen.insert(ea).second)
+		{
+			return false;
+		}
+		m_pending.push_back(ea);
+		return true;
+	}
+
+	/**********************************************************************/
+	std::optional<uint64_t> Prefetcher::next()
+	{
+		if (m_pending.empty())
+		{
+			return std::nullopt;
+		}
+
+		auto ea = m_pending.front();
+		m_pending.pop_front();
+		return ea;
+	}
+
+	/**********************************************************************/
+	bool Prefetcher::empty() const noexcept
+	{
+		return m_pending.empty();
+	}
+
+	/**********************************************************************/
+	size_t Prefetcher::size() const noexcept
+	{
+		return m_pending.size();
+	}
+
+	/**********************************************************************/
+	void Prefetcher::clear()
+	{
+		for (auto ea : m_pending)
+		{
+			m_seen.erase(ea);
+		}
+		m_pending.clear();
+	}
+
+	/**********************************************************************/
+	void Prefetcher::forget(uint64_t ea)
+	{
+		m_seen.erase(ea);
+	}
+
+	/**********************************************************************/
+	void Prefetcher::reset()
+	{
+		m_pending.clear();
+		m_seen.clear();
+	}
+} // end of namespace yagi
@@ -2,6 +2,12 @@
 #include "symbolinfo.hh"
 #include "varnode.hh"
 #include "funcdata.hh"
+#include "prototype.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
 
 
 #define COLOR_ON        '\1'     ///< Escape character (ON).
@@ -59,6 +65,98 @@ COLOR_FG_MAX = '\x28';         ///< Max color number
 
 namespace yagi 
 {
+	/**********************************************************************/
+	/*!
+	 * \brief	Kind of a token printed without more context
+	 */
+	static Decompiler::TokenKind _KindOf(EmitPrettyPrint::syntax_highlight hl)
+	{
+		switch (hl)
+		{
+		case EmitXml::keyword_color:
+			return Decompiler::TokenKind::Keyword;
+		case EmitXml::comment_color:
+			return Decompiler::TokenKind::Comment;
+		case EmitXml::type_color:
+			return Decompiler::TokenKind::Type;
+		case EmitXml::funcname_color:
+			return Decompiler::TokenKind::FunctionName;
+		case EmitXml::var_color:
+		case EmitXml::param_color:
+		case EmitXml::global_color:
+			return Decompiler::TokenKind::Variable;
+		case EmitXml::const_color:
+			return Decompiler::TokenKind::Constant;
+		default:
+			return Decompiler::TokenKind::Syntax;
+		}
+	}
+
+	/**********************************************************************/
+	void SymbolIndex::addVariable(const Symbol* symbol, MemoryLocation location)
+	{
+		if (m_variables.find(symbol) != m_variables.end())
+		{
+			return;
+		}
+
+		auto id = static_cast<uint32_t>(m_symbols.size());
+		m_variables.emplace(symbol, id);
+		// fallback for tokens printed without varnode (declarations)
+		m_names.emplace(symbol->getName(), id);
+		m_symbols.emplace_back(symbol->getName(), std::move(location));
+	}
+
+	/**********************************************************************/
+	void SymbolIndex::addNamed(const std::string& name, MemoryLocation location)
+	{
+		if (!m_names.emplace(name, static_cast<uint32_t>(m_symbols.size())).second)
+		{
+			return;
+		}
+		m_symbols.emplace_back(name, std::move(location));
+	}
+
+	/**********************************************************************/
+	bool SymbolIndex::hasVariable(const Symbol* symbol) const
+	{
+		return m_variables.find(symbol) != m_variables.end();
+	}
+
+	/**********************************************************************/
+	uint32_t SymbolIndex::find(const std::string& name, const Varnode* vn) const
+	{
+		if (vn != nullptr)
+		{
+			try
+			{
+				auto high = vn->getHigh();
+				auto iter = m_variables.find(high->getSymbol());
+				if (iter != m_variables.end())
+				{
+					return iter->second;
+				}
+			}
+			// constants have no high level variable
+			catch (LowlevelError&) {}
+		}
+
+		auto iter = m_names.find(name);
+		if (iter == m_names.end())
+		{
+			return NO_SYMBOL;
+		}
+		return iter->second;
+	}
+
+	/**********************************************************************/
+	std::vector<Decompiler::Symbol> SymbolIndex::release()
+	{
+		m_variables.clear();
+		m_names.clear();
+		return std::move(m_symbols);
+	}
+
 	/**********************************************************************/
 	// Constructing this registers the capability
 	IdaPrintCapability IdaPrintCapability::inst;
@@ -91,19 +189,50 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	void IdaEmit::startColorTag(char c)
+	IdaEmit& IdaPrint::getEmitter()
 	{
-		std::stringstream ss;
-		ss << COLOR_ON << c;
-		EmitPrettyPrint::print(ss.str().c_str());
+		return *static_cast<IdaEmit*>(emit);
+	}
+
+	/**********************************************************************/
+	void IdaEmit::setSymbolIndex(const SymbolIndex* index)
+	{
+		m_index = index;
+		m_tags.clear();
+	}
+
+	/**********************************************************************/
+	const std::vector<Decompiler::Token>& IdaEmit::getTags() const
+	{
+		return m_tags;
+	}
+
+	/**********************************************************************/
+	uint32_t IdaEmit::findSymbol(const std::string& name, const Varnode* vn) const
+	{
+		if (m_index == nullptr)
+		{
+			return SymbolIndex::NO_SYMBOL;
+		}
+		return m_index->find(name, vn);
+	}
+
+	/**********************************************************************/
+	void IdaEmit::startColorTag(char c, Decompiler::TokenKind kind, syntax_highlight hl, uint32_t symbol)
+	{
+		// tags reach the output in emission order
+		m_tags.push_back({ 0, 0, 0, symbol, kind, static_cast<uint8_t>(hl) });
+
+		// called for every token, keep it off the heap
+		const char tag[] = { COLOR_ON, c, '\0' };
+		EmitPrettyPrint::print(tag);
 	}
 
 	/**********************************************************************/
 	void IdaEmit::endColorTag(char c)
 	{
-		std::stringstream ss;
-		ss << COLOR_OFF << c;
-		EmitPrettyPrint::print(ss.str().c_str());
+		const char tag[] = { COLOR_OFF, c, '\0' };
+		EmitPrettyPrint::print(tag);
 	}
 
 	/**********************************************************************/
@@ -115,21 +244,23 @@ namespace yagi
 	/**********************************************************************/
 	int4 IdaEmit::openParen(char o, int4 id)
 	{
-		EmitColorGuard guard(*this, COLOR_KEYWORD);
+		EmitColorGuard guard(*this, COLOR_KEYWORD, Decompiler::TokenKind::Syntax, no_color);
 		return EmitPrettyPrint::openParen(o, id);
 	}
 
 	/**********************************************************************/
 	void IdaEmit::closeParen(char c, int4 id)
 	{
-		EmitColorGuard guard(*this, COLOR_KEYWORD);
+		EmitColorGuard guard(*this, COLOR_KEYWORD, Decompiler::TokenKind::Syntax, no_color);
 		return EmitPrettyPrint::closeParen(c, id);
 	}
 
 	/**********************************************************************/
 	void IdaEmit::tagOp(const char* ptr, syntax_highlight hl, const PcodeOp* op)
 	{
-		EmitColorGuard guard(*this, COLOR_KEYWORD);
+		// keywords like return or sizeof are printed as operators
+		auto kind = hl == syntax_highlight::keyword_color ? Decompiler::TokenKind::Keyword : Decompiler::TokenKind::Operator;
+		EmitColorGuard guard(*this, COLOR_KEYWORD, kind, hl);
 		EmitPrettyPrint::tagOp(ptr, hl, op);
 	}
 
@@ -146,32 +277,37 @@ namespace yagi
 			name = name.substr(SymbolInfo::IMPORT_PREFIX.length(), name.length() - SymbolInfo::IMPORT_PREFIX.length());
 		}
 
+		// constants are also printed as variables
+		auto kind = hl == syntax_highlight::const_color ? Decompiler::TokenKind::Constant : Decompiler::TokenKind::Variable;
+
 		// case of variable declaration
 		if (op == nullptr)
 		{
 			hl = syntax_highlight::keyword_color;
 		}
 
+		auto symbol = findSymbol(name, vn);
+
 		if (isImport)
 		{
-			EmitColorGuard guard(*this, COLOR_IMPNAME);
+			EmitColorGuard guard(*this, COLOR_IMPNAME, kind, hl, symbol);
 			EmitPrettyPrint::tagVariable(name.c_str(), hl, vn, op);
 		}
 		// Constant string
 		else if (*ptr == '\"' || *ptr == '\'')
 		{
-			EmitColorGuard guard(*this, COLOR_DSTR);
+			EmitColorGuard guard(*this, COLOR_DSTR, Decompiler::TokenKind::Constant, hl, symbol);
 			EmitPrettyPrint::tagVariable(name.c_str(), hl, vn, op);
 		}
 		// unicode string
 		else if (*ptr == 'L' && ptr[1] != '\0' && (ptr[1] == '\"' || ptr[1] == '\''))
 		{
-			EmitColorGuard guard(*this, COLOR_DSTR);
+			EmitColorGuard guard(*this, COLOR_DSTR, Decompiler::TokenKind::Constant, hl, symbol);
 			EmitPrettyPrint::tagVariable(name.c_str(), hl, vn, op);
 		}
 		else
 		{
-			EmitColorGuard guard(*this, hl);
+			EmitColorGuard guard(*this, hl, kind, symbol);
 			EmitPrettyPrint::tagVariable(name.c_str(), hl, vn, op);
 		}
 	}
@@ -188,14 +324,16 @@ namespace yagi
 			name = name.substr(SymbolInfo::IMPORT_PREFIX.length(), name.length() - SymbolInfo::IMPORT_PREFIX.length());
 		}
 		
+		auto symbol = findSymbol(name, nullptr);
+
 		if (isImport)
 		{
-			EmitColorGuard guard(*this, COLOR_IMPNAME);
+			EmitColorGuard guard(*this, COLOR_IMPNAME, Decompiler::TokenKind::FunctionName, hl, symbol);
 			EmitPrettyPrint::tagFuncName(name.c_str(), hl, fd, op);
 		}
 		else
 		{
-			EmitColorGuard guard(*this, hl);
+			EmitColorGuard guard(*this, hl, Decompiler::TokenKind::FunctionName, symbol);
 			EmitPrettyPrint::tagFuncName(name.c_str(), hl, fd, op);
 		}
 	}
@@ -203,20 +341,35 @@ namespace yagi
 	/**********************************************************************/
 	void IdaEmit::tagField(const char* ptr, syntax_highlight hl, const Datatype* ct, int4 off)
 	{
-		EmitColorGuard guard(*this, COLOR_KEYWORD);
+		EmitColorGuard guard(*this, COLOR_KEYWORD, Decompiler::TokenKind::Field, hl);
 		EmitPrettyPrint::tagField(ptr, hl, ct, off);
 	}
 
 	void IdaEmit::tagLabel(const char* ptr, syntax_highlight hl, const AddrSpace* spc, uintb off)
 	{
-		EmitColorGuard guard(*this, COLOR_KEYWORD);
+		EmitColorGuard guard(*this, COLOR_KEYWORD, Decompiler::TokenKind::Label, hl);
 		EmitPrettyPrint::tagLabel(ptr, hl, spc, off);
 	}
 
+	/**********************************************************************/
+	void IdaEmit::tagComment(const char* ptr, syntax_highlight hl, const AddrSpace* spc, uintb off)
+	{
+		EmitColorGuard guard(*this, hl, Decompiler::TokenKind::Comment);
+		EmitPrettyPrint::tagComment(ptr, hl, spc, off);
+	}
+
+	/**********************************************************************/
+	void IdaEmit::tagCaseLabel(const char* ptr, syntax_highlight hl, const PcodeOp* op, uintb value)
+	{
+		EmitColorGuard guard(*this, hl, Decompiler::TokenKind::Constant);
+		EmitPrettyPrint::tagCaseLabel(ptr, hl, op, value);
+	}
+
 	/**********************************************************************/
 	void IdaEmit::print(const char* str, syntax_highlight hl)
 	{
 		// handle C synthax token
+		auto kind = Decompiler::TokenKind::Syntax;
 		switch (str[0])
 		{
 		case '{':
@@ -224,30 +377,32 @@ namespace yagi
 		case ';':
 		case ',':
 			hl = syntax_highlight::keyword_color;
+			break;
 		default:
+			kind = _KindOf(hl);
 			break;
 		}
 
-		EmitColorGuard guard(*this, hl);
+		EmitColorGuard guard(*this, hl, kind);
 		EmitPrettyPrint::print(str, hl);
 	}
 
 	/**********************************************************************/
 	void IdaEmit::tagType(const char* ptr, syntax_highlight hl, const Datatype* ct)
 	{
-		EmitColorGuard guard(*this, hl);
+		EmitColorGuard guard(*this, hl, Decompiler::TokenKind::Type);
 		EmitPrettyPrint::tagType(ptr, hl, ct);
 	}
 
 	/**********************************************************************/
-	EmitColorGuard::EmitColorGuard(IdaEmit& emitter, char color)
+	EmitColorGuard::EmitColorGuard(IdaEmit& emitter, char color, Decompiler::TokenKind kind, EmitPrettyPrint::syntax_highlight hl, uint32_t symbol)
 		: m_emitter(emitter), m_color(color)
 	{
-		m_emitter.startColorTag(m_color);
+		m_emitter.startColorTag(m_color, kind, hl, symbol);
 	}
 
 	/**********************************************************************/
-	EmitColorGuard::EmitColorGuard(IdaEmit& emitter, EmitPrettyPrint::syntax_highlight color)
+	EmitColorGuard::EmitColorGuard(IdaEmit& emitter, EmitPrettyPrint::syntax_highlight color, Decompiler::TokenKind kind, uint32_t symbol)
 		: m_emitter(emitter)
 	{
 		switch (color)
@@ -284,7 +439,7 @@ namespace yagi
 			break;
 		}
 
-		m_emitter.startColorTag(m_color);
+		m_emitter.startColorTag(m_color, kind, color, symbol);
 	}
 
 	/**********************************************************************/
@@ -292,4 +447,299 @@ namespace yagi
 	{
 		m_emitter.endColorTag(m_color);
 	}
+
+	/**********************************************************************/
+	std::string removeColorTags(const std::string& code)
+	{
+		std::string result;
+		result.reserve(code.size());
+		for (size_t i = 0; i < code.size(); i++)
+		{
+			switch (code[i])
+			{
+			case COLOR_ON:
+			case COLOR_OFF:
+				// skip the color code
+				i++;
+				break;
+			case COLOR_ESC:
+				if (i + 1 < code.size())
+				{
+					result.push_back(code[++i]);
+				}
+				break;
+			case COLOR_INV:
+				break;
+			default:
+				result.push_back(code[i]);
+				break;
+			}
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	std::vector<Decompiler::Token> indexTokens(const std::string& code, const std::vector<Decompiler::Token>& tags, bool all)
+	{
+		std::vector<Decompiler::Token> tokens;
+
+		// opened tags, tags are not nested by the emitter
+		// but a stack keeps the walk in sync if they ever are
+		std::vector<Decompiler::Token> opened;
+		uint32_t line = 0, column = 0;
+		size_t tag = 0;
+		for (size_t i = 0; i < code.size(); i++)
+		{
+			switch (code[i])
+			{
+			case COLOR_ON:
+				{
+					Decompiler::Token token;
+					if (tag < tags.size())
+					{
+						token = tags[tag];
+					}
+					else
+					{
+						token.symbol = SymbolIndex::NO_SYMBOL;
+					}
+					token.line = line;
+					token.start = column;
+					token.end = column;
+					opened.push_back(token);
+					tag++;
+					i++;
+				}
+				break;
+			case COLOR_OFF:
+				if (!opened.empty())
+				{
+					auto token = opened.back();
+					opened.pop_back();
+					if ((all || token.symbol != SymbolIndex::NO_SYMBOL) && token.line == line && column > token.start)
+					{
+						token.end = column;
+						tokens.push_back(token);
+					}
+				}
+				i++;
+				break;
+			case COLOR_ESC:
+				i++;
+				column++;
+				break;
+			case COLOR_INV:
+				break;
+			case '\n':
+				line++;
+				column = 0;
+				break;
+			default:
+				column++;
+				break;
+			}
+		}
+		return tokens;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Prefixes of names that Ghidra builds from an address
+	 *			the address follows in hexadecimal
+	 */
+	static const char* const ADDRESS_NAME_PREFIXES[] = { "LAB_", "switchD_", "switchdataD_", "code_r0x", "joined_r0x" };
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Is a character part of an identifier
+	 */
+	static bool _IsWordChar(char c)
+	{
+		return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Move an address into the rebased function
+	 */
+	static uint64_t _RebaseAddress(uint64_t ea, uint64_t from, uint64_t size, uint64_t to)
+	{
+		return ea - from < size ? ea - from + to : ea;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Rename an identifier of the rebased function
+	 *			Names built from an address into the function are moved
+	 *			with the same number of digits and the same case
+	 *			hexadecimal constants into the function are moved too
+	 */
+	static std::string _RebaseWord(const std::string& word, uint64_t from, uint64_t size, uint64_t to, const std::string& fromName, const std::string& toName)
+	{
+		if (word == fromName)
+		{
+			return toName;
+		}
+
+		// constants are masked by the clone hash when they point into the function
+		if (word.size() > 2 && word.size() <= 18 && word[0] == '0' && (word[1] == 'x' || word[1] == 'X'))
+		{
+			auto digits = word.substr(2);
+			if (!std::all_of(digits.begin(), digits.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; }))
+			{
+				return word;
+			}
+
+			auto ea = std::stoull(digits, nullptr, 16);
+			if (ea - from >= size)
+			{
+				return word;
+			}
+
+			auto upper = std::any_of(digits.begin(), digits.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)) != 0; });
+			std::stringstream ss;
+			ss << word.substr(0, 2) << (upper ? std::uppercase : std::nouppercase) << std::hex << _RebaseAddress(ea, from, size, to);
+			return ss.str();
+		}
+
+		for (auto prefix : ADDRESS_NAME_PREFIXES)
+		{
+			auto length = std::char_traits<char>::length(prefix);
+			if (word.compare(0, length, prefix) != 0 || word.size() == length || word.size() - length > 16)
+			{
+				continue;
+			}
+
+			auto digits = word.substr(length);
+			if (!std::all_of(digits.begin(), digits.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; }))
+			{
+				return word;
+			}
+
+			auto ea = std::stoull(digits, nullptr, 16);
+			if (ea - from >= size)
+			{
+				return word;
+			}
+
+			auto upper = std::any_of(digits.begin(), digits.end(), [](char c) { return std::isupper(static_cast<unsigned char>(c)) != 0; });
+			std::stringstream ss;
+			ss << prefix << (upper ? std::uppercase : std::nouppercase) << std::hex << std::setw(digits.size()) << std::setfill('0') << _RebaseAddress(ea, from, size, to);
+			return ss.str();
+		}
+		return word;
+	}
+
+	/**********************************************************************/
+	Decompiler::Result rebaseResult(const Decompiler::Result& result, uint64_t from, uint64_t size, uint64_t to, const std::string& name)
+	{
+		// renamed words of each line with the column after them, tokens behind them are moved
+		struct Shift
+		{
+			uint32_t line;
+			uint32_t end;
+			int64_t delta;
+		};
+		std::vector<Shift> shifts;
+
+		std::string code;
+		code.reserve(result.cCode.size() + 64);
+		uint32_t line = 0, column = 0;
+		for (size_t i = 0; i < result.cCode.size();)
+		{
+			auto c = result.cCode[i];
+			switch (c)
+			{
+			case COLOR_ON:
+			case COLOR_OFF:
+			case COLOR_ESC:
+				// escaped characters are printed but never part of a word
+				column += c == COLOR_ESC ? 1 : 0;
+				code.append(result.cCode, i, 2);
+				i += 2;
+				continue;
+			case '\n':
+				line++;
+				column = 0;
+				code.push_back(c);
+				i++;
+				continue;
+			default:
+				break;
+			}
+
+			if (!_IsWordChar(c))
+			{
+				column += c == COLOR_INV ? 0 : 1;
+				code.push_back(c);
+				i++;
+				continue;
+			}
+
+			auto end = i;
+			while (end < result.cCode.size() && _IsWordChar(result.cCode[end]))
+			{
+				end++;
+			}
+
+			auto word = result.cCode.substr(i, end - i);
+			auto rebased = _RebaseWord(word, from, size, to, result.name, name);
+			column += static_cast<uint32_t>(word.size());
+			if (rebased.size() != word.size())
+			{
+				shifts.push_back({ line, column, static_cast<int64_t>(rebased.size()) - static_cast<int64_t>(word.size()) });
+			}
+			code += rebased;
+			i = end;
+		}
+
+		auto move = [&shifts](uint32_t line, uint32_t column) {
+			int64_t moved = column;
+			for (auto& shift : shifts)
+			{
+				if (shift.line == line && shift.end <= column)
+				{
+					moved += shift.delta;
+				}
+			}
+			return static_cast<uint32_t>(moved);
+		};
+
+		auto tokens = result.tokens;
+		for (auto& token : tokens)
+		{
+			token.start = move(token.line, token.start);
+			token.end = move(token.line, token.end);
+		}
+
+		auto symbols = result.symbols;
+		for (auto& symbol : symbols)
+		{
+			symbol.name = _RebaseWord(symbol.name, from, size, to, result.name, name);
+			if (symbol.location.spaceName == "ram")
+			{
+				symbol.location.offset = _RebaseAddress(symbol.location.offset, from, size, to);
+			}
+			for (auto& pc : symbol.location.pc)
+			{
+				pc = _RebaseAddress(pc, from, size, to);
+			}
+		}
+
+		Decompiler::Result rebased(name, to, std::move(code), std::move(symbols), std::move(tokens));
+		if (result.prototype != nullptr)
+		{
+			auto prototype = std::make_shared<Prototype>(*result.prototype);
+			prototype->name = name;
+			rebased.prototype = prototype;
+		}
+
+		rebased.dependencies = result.dependencies;
+		for (auto& ea : rebased.dependencies.addresses)
+		{
+			ea = _RebaseAddress(ea, from, size, to);
+		}
+		std::sort(rebased.dependencies.addresses.begin(), rebased.dependencies.addresses.end());
+		return rebased;
+	}
 } // end of namespace ghidra
\ No newline at end of file
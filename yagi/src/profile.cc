@@ -0,0 +1,470 @@
+#include "profile.hh"
+#include "exception.hh"
+#include "base.hh"
+#include "memory.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+namespace yagi
+{
+	/*!
+	 * \brief	profile of each thread, see ProfileSession
+	 */
+	static thread_local Profile* s_current = nullptr;
+
+	/*!
+	 * \brief	installed by setAllocationCounter
+	 */
+	static std::atomic<Profile::AllocationCounter> s_allocationCounter{ nullptr };
+
+	/**********************************************************************/
+	const std::string Profile::ACTIONS = "actions";
+	const std::string Profile::BACKEND = "backend";
+	const std::string Profile::OPS = "ops";
+	const std::string Profile::VARNODES = "varnodes";
+	const std::string Profile::BLOCKS = "blocks";
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Milliseconds elapsed since a time point
+	 */
+	static double _Elapsed(std::chrono::steady_clock::time_point start)
+	{
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		return duration.count();
+	}
+
+	/**********************************************************************/
+	Profile::Profile(uint64_t ea)
+		: m_ea{ ea }, m_start{ std::chrono::steady_clock::now() }
+	{
+		if (auto counter = s_allocationCounter.load())
+		{
+			m_allocationStart = counter();
+		}
+		m_memoryStart = getProcessMemory();
+		m_memoryPeak = m_memoryStart;
+	}
+
+	/**********************************************************************/
+	uint64_t Profile::getAddress() const noexcept
+	{
+		return m_ea;
+	}
+
+	/**********************************************************************/
+	const std::string& Profile::getName() const noexcept
+	{
+		return m_name;
+	}
+
+	/**********************************************************************/
+	void Profile::setName(const std::string& name)
+	{
+		m_name = name;
+	}
+
+	/**********************************************************************/
+	void Profile::add(const std::string& category, const std::string& name, double milliseconds)
+	{
+		auto& timing = m_timings[category][name];
+		timing.calls++;
+		timing.milliseconds += milliseconds;
+	}
+
+	/**********************************************************************/
+	void Profile::mark(const std::string& name)
+	{
+		unmark();
+		sampleMemory();
+		m_mark = std::make_pair(name, std::chrono::steady_clock::now());
+	}
+
+	/**********************************************************************/
+	void Profile::unmark()
+	{
+		if (m_mark.has_value())
+		{
+			add(ACTIONS, m_mark.value().first, _Elapsed(m_mark.value().second));
+			m_mark.reset();
+		}
+	}
+
+	/**********************************************************************/
+	void Profile::sampleMemory() noexcept
+	{
+		auto usage = getProcessMemory();
+		if (usage.has_value() && m_memoryPeak.has_value())
+		{
+			m_memoryPeak = std::max(m_memoryPeak.value(), usage.value());
+		}
+	}
+
+	/**********************************************************************/
+	void Profile::setCounter(const std::string& name, uint64_t value)
+	{
+		auto& counter = m_counters[name];
+		counter = std::max(counter, value);
+	}
+
+	/**********************************************************************/
+	void Profile::close()
+	{
+		if (m_milliseconds.has_value())
+		{
+			return;
+		}
+
+		unmark();
+		sampleMemory();
+		m_milliseconds = _Elapsed(m_start);
+
+		auto counter = s_allocationCounter.load();
+		if (counter != nullptr && m_allocationStart.has_value())
+		{
+			m_allocations = counter() - m_allocationStart.value();
+		}
+	}
+
+	/**********************************************************************/
+	void Profile::addStatistics(std::istream& stream)
+	{
+		static const std::string TESTED = " Tested=";
+		static const std::string APPLIED = " Applied=";
+
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			auto tested = line.find(TESTED);
+			auto applied = line.find(APPLIED);
+			if (tested == std::string::npos || applied == std::string::npos || applied < tested)
+			{
+				continue;
+			}
+
+			try
+			{
+				auto& statistic = m_statistics[line.substr(0, tested)];
+				statistic.tested += std::stoull(line.substr(tested + TESTED.length(), applied - tested - TESTED.length()));
+				statistic.applied += std::stoull(line.substr(applied + APPLIED.length()));
+			}
+			catch (std::exception&) {}
+		}
+	}
+
+	/**********************************************************************/
+	const std::map<std::string, std::map<std::string, Profile::Timing>>& Profile::getTimings() const noexcept
+	{
+		return m_timings;
+	}
+
+	/**********************************************************************/
+	const std::map<std::string, Profile::Statistic>& Profile::getStatistics() const noexcept
+	{
+		return m_statistics;
+	}
+
+	/**********************************************************************/
+	const std::map<std::string, uint64_t>& Profile::getCounters() const noexcept
+	{
+		return m_counters;
+	}
+
+	/**********************************************************************/
+	std::optional<size_t> Profile::getMemoryGrowth() const noexcept
+	{
+		if (!m_memoryStart.has_value() || !m_memoryPeak.has_value())
+		{
+			return std::nullopt;
+		}
+		return m_memoryPeak.value() - m_memoryStart.value();
+	}
+
+	/**********************************************************************/
+	std::optional<double> Profile::getMilliseconds() const noexcept
+	{
+		return m_milliseconds;
+	}
+
+	/**********************************************************************/
+	std::optional<size_t> Profile::getAllocations() const noexcept
+	{
+		return m_allocations;
+	}
+
+	/**********************************************************************/
+	void Profile::writeJson(std::ostream& stream) const
+	{
+		stream << std::fixed << std::setprecision(3);
+		stream << "{" << std::endl;
+		stream << "\t\"address\": ";
+		writeJsonString(stream, to_hex(m_ea));
+		stream << "," << std::endl;
+		stream << "\t\"name\": ";
+		writeJsonString(stream, m_name);
+		stream << "," << std::endl;
+		stream << "\t\"milliseconds\": " << m_milliseconds.value_or(_Elapsed(m_start)) << "," << std::endl;
+		if (m_allocations.has_value())
+		{
+			stream << "\t\"allocations\": " << m_allocations.value() << "," << std::endl;
+		}
+		if (auto memory = getMemoryGrowth())
+		{
+			stream << "\t\"memory\": " << memory.value() << "," << std::endl;
+		}
+
+		stream << "\t\"counters\": {";
+		for (auto counter = m_counters.begin(); counter != m_counters.end(); counter++)
+		{
+			stream << (counter == m_counters.begin() ? " " : ", ");
+			writeJsonString(stream, counter->first);
+			stream << ": " << counter->second;
+		}
+		stream << (m_counters.empty() ? "" : " ") << "}," << std::endl;
+
+		stream << "\t\"timings\": {";
+		for (auto category = m_timings.begin(); category != m_timings.end(); category++)
+		{
+			stream << (category == m_timings.begin() ? "" : ",") << std::endl << "\t\t";
+			writeJsonString(stream, category->first);
+			stream << ": {";
+			for (auto timing = category->second.begin(); timing != category->second.end(); timing++)
+			{
+				stream << (timing == category->second.begin() ? "" : ",") << std::endl << "\t\t\t";
+				writeJsonString(stream, timing->first);
+				stream << ": { \"calls\": " << timing->second.calls << ", \"milliseconds\": " << timing->second.milliseconds << " }";
+			}
+			stream << std::endl << "\t\t}";
+		}
+		stream << std::endl << "\t}," << std::endl;
+
+		stream << "\t\"statistics\": {";
+		for (auto statistic = m_statistics.begin(); statistic != m_statistics.end(); statistic++)
+		{
+			stream << (statistic == m_statistics.begin() ? "" : ",") << std::endl << "\t\t";
+			writeJsonString(stream, statistic->first);
+			stream << ": { \"tested\": " << statistic->second.tested << ", \"applied\": " << statistic->second.applied << " }";
+		}
+		stream << std::endl << "\t}" << std::endl;
+		stream << "}" << std::endl;
+	}
+
+	/**********************************************************************/
+	Profile* Profile::current() noexcept
+	{
+		return s_current;
+	}
+
+	/**********************************************************************/
+	void Profile::setAllocationCounter(AllocationCounter counter) noexcept
+	{
+		s_allocationCounter = counter;
+	}
+
+	/**********************************************************************/
+	ProfileSession::ProfileSession(Profile& profile) noexcept
+		: m_previous{ s_current }
+	{
+		s_current = &profile;
+	}
+
+	/**********************************************************************/
+	ProfileSession::~ProfileSession()
+	{
+		s_current = m_previous;
+	}
+
+	/**********************************************************************/
+	ProfileScope::ProfileScope(const char* category, const char* name) noexcept
+		: m_profile{ s_current }, m_category{ category }, m_name{ name }
+	{
+		if (m_profile != nullptr)
+		{
+			m_start = std::chrono::steady_clock::now();
+		}
+	}
+
+	/**********************************************************************/
+	ProfileScope::ProfileScope(const char* category, const std::string& name) noexcept
+		: ProfileScope(category, name.c_str())
+	{}
+
+	/**********************************************************************/
+	ProfileScope::~ProfileScope()
+	{
+		if (m_profile != nullptr)
+		{
+			try
+			{
+				m_profile->add(m_category, m_name, _Elapsed(m_start));
+			}
+			catch (...) {}
+		}
+	}
+
+	/**********************************************************************/
+	DirectoryProfileOutput::DirectoryProfileOutput(const std::filesystem::path& directory)
+		: m_directory{ directory }
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+	}
+
+	/**********************************************************************/
+	const std::filesystem::path& DirectoryProfileOutput::getDirectory() const noexcept
+	{
+		return m_directory;
+	}
+
+	/**********************************************************************/
+	void DirectoryProfileOutput::write(const Profile& profile)
+	{
+		// function names are not always valid file names
+		auto path = m_directory / (to_hex(profile.getAddress()) + ".json");
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::ofstream stream(path);
+		if (!stream.is_open())
+		{
+			throw UnableToOpenOutput(path.string());
+		}
+		profile.writeJson(stream);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Quote a CSV field, function names may hold commas
+	 */
+	static void _WriteCsvString(std::ostream& stream, const std::string& value)
+	{
+		stream << '"';
+		for (auto c : value)
+		{
+			stream << c;
+			if (c == '"')
+			{
+				stream << c;
+			}
+		}
+		stream << '"';
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Value of a counter, 0 if not set
+	 */
+	static uint64_t _FindCounter(const Profile& profile, const std::string& name)
+	{
+		auto counter = profile.getCounters().find(name);
+		return counter != profile.getCounters().end() ? counter->second : 0;
+	}
+
+	/**********************************************************************/
+	SummaryProfileOutput::SummaryProfileOutput(std::shared_ptr<ProfileOutput> next)
+		: m_next{ std::move(next) }
+	{}
+
+	/**********************************************************************/
+	SummaryProfileOutput::Row SummaryProfileOutput::summarize(const Profile& profile)
+	{
+		Row row;
+		row.ea = profile.getAddress();
+		row.name = profile.getName();
+		row.milliseconds = profile.getMilliseconds().value_or(0);
+		row.memory = profile.getMemoryGrowth().value_or(0);
+		row.ops = _FindCounter(profile, Profile::OPS);
+		row.varnodes = _FindCounter(profile, Profile::VARNODES);
+		row.blocks = _FindCounter(profile, Profile::BLOCKS);
+
+		for (auto& statistic : profile.getStatistics())
+		{
+			row.applied += statistic.second.applied;
+		}
+
+		auto backend = profile.getTimings().find(Profile::BACKEND);
+		if (backend != profile.getTimings().end())
+		{
+			for (auto& timing : backend->second)
+			{
+				row.backend += timing.second.calls;
+			}
+		}
+		return row;
+	}
+
+	/**********************************************************************/
+	void SummaryProfileOutput::write(const Profile& profile)
+	{
+		auto row = summarize(profile);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_rows[row.ea] = std::move(row);
+		}
+
+		if (m_next != nullptr)
+		{
+			m_next->write(profile);
+		}
+	}
+
+	/**********************************************************************/
+	std::vector<SummaryProfileOutput::Row> SummaryProfileOutput::getRows(Column column) const
+	{
+		std::vector<Row> rows;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			rows.reserve(m_rows.size());
+			for (auto& row : m_rows)
+			{
+				rows.push_back(row.second);
+			}
+		}
+
+		// rows are already sorted by address, ties keep that order
+		std::stable_sort(rows.begin(), rows.end(), [column](const Row& left, const Row& right) {
+			switch (column)
+			{
+			case Column::Name:
+				return left.name < right.name;
+			case Column::Time:
+				return left.milliseconds > right.milliseconds;
+			case Column::Memory:
+				return left.memory > right.memory;
+			case Column::Ops:
+				return left.ops > right.ops;
+			case Column::Varnodes:
+				return left.varnodes > right.varnodes;
+			case Column::Blocks:
+				return left.blocks > right.blocks;
+			case Column::Applied:
+				return left.applied > right.applied;
+			case Column::Backend:
+				return left.backend > right.backend;
+			default:
+				return false;
+			}
+		});
+		return rows;
+	}
+
+	/**********************************************************************/
+	void SummaryProfileOutput::writeCsv(std::ostream& stream, Column column) const
+	{
+		stream << "address,name,milliseconds,memory,ops,varnodes,blocks,applied,backend" << std::endl;
+		for (auto& row : getRows(column))
+		{
+			stream << to_hex(row.ea) << ",";
+			_WriteCsvString(stream, row.name);
+			stream << "," << std::fixed << std::setprecision(3) << row.milliseconds
+				<< "," << row.memory
+				<< "," << row.ops
+				<< "," << row.varnodes
+				<< "," << row.blocks
+				<< "," << row.applied
+				<< "," << row.backend << std::endl;
+		}
+	}
+} // end of namespace yagi
@@ -0,0 +1,330 @@
+#include "prototype.hh"
+#include "exception.hh"
+
+#include <mutex>
+#include <sstream>
+
+namespace yagi
+{
+	/**********************************************************************/
+	RecoveredTypeInfo::RecoveredTypeInfo(std::string name, size_t size, uint32_t flags, std::shared_ptr<const RecoveredTypeInfo> pointed)
+		: m_name{ std::move(name) }, m_size{ size }, m_flags{ flags }, m_pointed{ std::move(pointed) }
+	{}
+
+	/**********************************************************************/
+	size_t RecoveredTypeInfo::getSize() const
+	{
+		return m_size;
+	}
+
+	/**********************************************************************/
+	std::string RecoveredTypeInfo::getName() const
+	{
+		return m_name;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isInt() const
+	{
+		return (m_flags & INT) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isBool() const
+	{
+		return (m_flags & BOOL) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isFloat() const
+	{
+		return (m_flags & FLOAT) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isVoid() const
+	{
+		return (m_flags & VOID) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isConst() const
+	{
+		return (m_flags & CONST) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isChar() const
+	{
+		return (m_flags & CHAR) != 0;
+	}
+
+	/**********************************************************************/
+	bool RecoveredTypeInfo::isUnicode() const
+	{
+		return (m_flags & UNICODE) != 0;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FuncInfo>> RecoveredTypeInfo::toFunc() const
+	{
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<StructInfo>> RecoveredTypeInfo::toStruct() const
+	{
+		// structures are only referenced by name
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<PtrInfo>> RecoveredTypeInfo::toPtr() const
+	{
+		if (m_pointed == nullptr)
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<RecoveredPtrInfo>(m_pointed);
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<ArrayInfo>> RecoveredTypeInfo::toArray() const
+	{
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	RecoveredPtrInfo::RecoveredPtrInfo(std::shared_ptr<const RecoveredTypeInfo> pointed)
+		: m_pointed{ std::move(pointed) }
+	{}
+
+	/**********************************************************************/
+	std::unique_ptr<TypeInfo> RecoveredPtrInfo::getPointedObject() const
+	{
+		return std::make_unique<RecoveredTypeInfo>(*m_pointed);
+	}
+
+	/**********************************************************************/
+	std::string Prototype::toDeclaration() const
+	{
+		std::stringstream ss;
+		ss << (types.empty() ? std::string("void") : types.front().getName()) << " ";
+		if (callingConv.has_value())
+		{
+			ss << callingConv.value() << " ";
+		}
+		ss << name << "(";
+
+		for (size_t i = 1; i < types.size(); i++)
+		{
+			if (i > 1)
+			{
+				ss << ", ";
+			}
+			ss << types[i].getName();
+			if (i < names.size() && !names[i].empty())
+			{
+				ss << " " << names[i];
+			}
+		}
+
+		if (dotDotDot)
+		{
+			ss << (types.size() > 1 ? ", ..." : "...");
+		}
+		else if (types.size() <= 1)
+		{
+			ss << "void";
+		}
+		ss << ")";
+		return ss.str();
+	}
+
+	/**********************************************************************/
+	PrototypeTypeInfo::PrototypeTypeInfo(std::shared_ptr<const Prototype> prototype)
+		: m_prototype{ std::move(prototype) }
+	{}
+
+	/**********************************************************************/
+	size_t PrototypeTypeInfo::getSize() const
+	{
+		return 1;
+	}
+
+	/**********************************************************************/
+	std::string PrototypeTypeInfo::getName() const
+	{
+		return m_prototype->toDeclaration();
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isInt() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isBool() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isFloat() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isVoid() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isConst() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isChar() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	bool PrototypeTypeInfo::isUnicode() const
+	{
+		return false;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FuncInfo>> PrototypeTypeInfo::toFunc() const
+	{
+		return std::make_unique<PrototypeFuncInfo>(m_prototype);
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<StructInfo>> PrototypeTypeInfo::toStruct() const
+	{
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<PtrInfo>> PrototypeTypeInfo::toPtr() const
+	{
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<ArrayInfo>> PrototypeTypeInfo::toArray() const
+	{
+		return std::nullopt;
+	}
+
+	/**********************************************************************/
+	PrototypeFuncInfo::PrototypeFuncInfo(std::shared_ptr<const Prototype> prototype)
+		: m_prototype{ std::move(prototype) }
+	{}
+
+	/**********************************************************************/
+	bool PrototypeFuncInfo::isDotDotDot() const
+	{
+		return m_prototype->dotDotDot;
+	}
+
+	/**********************************************************************/
+	std::vector<std::unique_ptr<TypeInfo>> PrototypeFuncInfo::getFuncPrototype() const
+	{
+		std::vector<std::unique_ptr<TypeInfo>> result;
+		for (auto& type : m_prototype->types)
+		{
+			result.push_back(std::make_unique<RecoveredTypeInfo>(type));
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	std::vector<std::string> PrototypeFuncInfo::getFuncParamName() const
+	{
+		return m_prototype->names;
+	}
+
+	/**********************************************************************/
+	std::string PrototypeFuncInfo::getCallingConv() const
+	{
+		if (!m_prototype->callingConv.has_value())
+		{
+			throw UnknownCallingConvention(m_prototype->name);
+		}
+		return m_prototype->callingConv.value();
+	}
+
+	/**********************************************************************/
+	std::string PrototypeFuncInfo::getName() const
+	{
+		return m_prototype->toDeclaration();
+	}
+
+	/**********************************************************************/
+	void PrototypeStore::add(uint64_t ea, std::shared_ptr<const Prototype> prototype)
+	{
+		std::unique_lock<std::shared_mutex> lock(m_mutex);
+		m_prototypes[ea] = std::move(prototype);
+	}
+
+	/**********************************************************************/
+	std::shared_ptr<const Prototype> PrototypeStore::find(uint64_t ea) const
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto iter = m_prototypes.find(ea);
+		if (iter == m_prototypes.end())
+		{
+			return nullptr;
+		}
+		return iter->second;
+	}
+
+	/**********************************************************************/
+	size_t PrototypeStore::size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		return m_prototypes.size();
+	}
+
+	/**********************************************************************/
+	PrototypeTypeInfoFactory::PrototypeTypeInfoFactory(std::unique_ptr<TypeInfoFactory> inner, std::shared_ptr<const PrototypeStore> store)
+		: m_inner{ std::move(inner) }, m_store{ std::move(store) }
+	{}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> PrototypeTypeInfoFactory::build(const std::string& name)
+	{
+		return m_inner->build(name);
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> PrototypeTypeInfoFactory::build(uint64_t ea)
+	{
+		auto prototype = m_store->find(ea);
+		if (prototype != nullptr)
+		{
+			return std::make_unique<PrototypeTypeInfo>(prototype);
+		}
+		return m_inner->build(ea);
+	}
+
+	/**********************************************************************/
+	void PrototypeTypeInfoFactory::invalidate(const std::string& name)
+	{
+		m_inner->invalidate(name);
+	}
+
+	/**********************************************************************/
+	void PrototypeTypeInfoFactory::invalidateAll()
+	{
+		m_inner->invalidateAll();
+	}
+} // end of namespace yagi
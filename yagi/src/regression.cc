@@ -0,0 +1,207 @@
+#include "regression.hh"
+#include "exception.hh"
+#include "print.hh"
+#include "base.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace yagi
+{
+	/**********************************************************************/
+	void RegressionRun::save(const std::filesystem::path& path) const
+	{
+		std::ofstream stream(path);
+		if (!stream.is_open())
+		{
+			throw UnableToOpenOutput(path.string());
+		}
+
+		// names may contain commas, they are the last column
+		stream << "export,address,status,hash,milliseconds,name" << std::endl;
+		for (auto& entry : entries)
+		{
+			stream << entry.first.first << ","
+				<< to_hex(entry.first.second) << ","
+				<< (entry.second.decompiled ? "ok" : "failed") << ","
+				<< to_hex(entry.second.hash) << ","
+				<< std::fixed << std::setprecision(3) << entry.second.duration << ","
+				<< entry.second.name << std::endl;
+		}
+	}
+
+	/**********************************************************************/
+	RegressionRun RegressionRun::load(const std::filesystem::path& path)
+	{
+		std::ifstream stream(path);
+		std::string line;
+		if (!stream.is_open() || !std::getline(stream, line))
+		{
+			throw InvalidRegressionRun(path.string());
+		}
+
+		RegressionRun run;
+		while (std::getline(stream, line))
+		{
+			if (line.empty())
+			{
+				continue;
+			}
+
+			// first five columns, the name is the remaining of the line
+			std::vector<std::string> columns;
+			size_t start = 0;
+			while (columns.size() < 5)
+			{
+				auto end = line.find(',', start);
+				if (end == std::string::npos)
+				{
+					throw InvalidRegressionRun(path.string());
+				}
+				columns.push_back(line.substr(start, end - start));
+				start = end + 1;
+			}
+
+			try
+			{
+				Entry entry;
+				entry.decompiled = columns[2] == "ok";
+				entry.hash = std::stoull(columns[3], nullptr, 16);
+				entry.duration = std::stod(columns[4]);
+				entry.name = line.substr(start);
+				run.entries[Key(columns[0], std::stoull(columns[1], nullptr, 16))] = std::move(entry);
+			}
+			catch (std::logic_error&)
+			{
+				throw InvalidRegressionRun(path.string());
+			}
+		}
+		return run;
+	}
+
+	/**********************************************************************/
+	RegressionBatchOutput::RegressionBatchOutput(RegressionRun& run, std::string source, BatchOutput* next)
+		: m_run{ run }, m_source{ std::move(source) }, m_next{ next }
+	{}
+
+	/**********************************************************************/
+	void RegressionBatchOutput::write(uint64_t ea, const std::optional<Decompiler::Result>& result, double duration)
+	{
+		RegressionRun::Entry entry;
+		entry.duration = duration;
+		if (result.has_value())
+		{
+			entry.name = result.value().name;
+			entry.decompiled = true;
+			entry.hash = fnv1a_string(removeColorTags(result.value().cCode));
+		}
+		m_run.entries[RegressionRun::Key(m_source, ea)] = std::move(entry);
+
+		if (m_next != nullptr)
+		{
+			m_next->write(ea, result, duration);
+		}
+	}
+
+	/**********************************************************************/
+	RegressionDiff RegressionDiff::compare(const RegressionRun& baseline, const RegressionRun& current)
+	{
+		RegressionDiff diff;
+		for (auto& entry : baseline.entries)
+		{
+			auto other = current.entries.find(entry.first);
+			if (other == current.entries.end())
+			{
+				diff.removed.push_back(entry.first);
+				continue;
+			}
+
+			if (entry.second.decompiled && !other->second.decompiled)
+			{
+				diff.broken.push_back(entry.first);
+			}
+			else if (!entry.second.decompiled && other->second.decompiled)
+			{
+				diff.fixed.push_back(entry.first);
+			}
+			else if (entry.second.decompiled)
+			{
+				if (entry.second.hash != other->second.hash)
+				{
+					diff.changed.push_back(entry.first);
+				}
+				diff.latencies.push_back(Latency{ entry.first, entry.second.duration, other->second.duration });
+				diff.baselineDuration += entry.second.duration;
+				diff.currentDuration += other->second.duration;
+			}
+		}
+
+		for (auto& entry : current.entries)
+		{
+			if (baseline.entries.find(entry.first) == baseline.entries.end())
+			{
+				diff.added.push_back(entry.first);
+			}
+		}
+
+		std::stable_sort(diff.latencies.begin(), diff.latencies.end(), [](const Latency& a, const Latency& b) {
+			return (a.current - a.baseline) > (b.current - b.baseline);
+		});
+		return diff;
+	}
+
+	/**********************************************************************/
+	bool RegressionDiff::hasOutputChanges() const noexcept
+	{
+		return !changed.empty() || !broken.empty() || !fixed.empty();
+	}
+
+	/**********************************************************************/
+	static void _PrintKeys(std::ostream& stream, const char* title, const std::vector<RegressionRun::Key>& keys)
+	{
+		stream << title << " : " << keys.size() << std::endl;
+		for (auto& key : keys)
+		{
+			stream << "  " << key.first << " " << to_hex(key.second) << std::endl;
+		}
+	}
+
+	/**********************************************************************/
+	static void _PrintLatency(std::ostream& stream, const RegressionDiff::Latency& latency)
+	{
+		stream << "  " << latency.key.first << " " << to_hex(latency.key.second) << " "
+			<< std::fixed << std::setprecision(2) << latency.baseline << " ms -> " << latency.current << " ms ("
+			<< std::showpos << (latency.current - latency.baseline) << std::noshowpos << " ms)" << std::endl;
+	}
+
+	/**********************************************************************/
+	void RegressionDiff::print(std::ostream& stream, size_t top) const
+	{
+		_PrintKeys(stream, "changed", changed);
+		_PrintKeys(stream, "broken", broken);
+		_PrintKeys(stream, "fixed", fixed);
+		_PrintKeys(stream, "added", added);
+		_PrintKeys(stream, "removed", removed);
+
+		stream << "duration : " << std::fixed << std::setprecision(2) << baselineDuration << " ms -> " << currentDuration << " ms";
+		if (baselineDuration > 0)
+		{
+			stream << " (" << std::showpos << ((currentDuration - baselineDuration) * 100.0 / baselineDuration) << std::noshowpos << "%)";
+		}
+		stream << std::endl;
+
+		auto count = std::min(top, latencies.size());
+		stream << "slower :" << std::endl;
+		for (size_t i = 0; i < count && latencies[i].current > latencies[i].baseline; i++)
+		{
+			_PrintLatency(stream, latencies[i]);
+		}
+
+		stream << "faster :" << std::endl;
+		for (size_t i = 0; i < count && latencies[latencies.size() - 1 - i].current < latencies[latencies.size() - 1 - i].baseline; i++)
+		{
+			_PrintLatency(stream, latencies[latencies.size() - 1 - i]);
+		}
+	}
+} // end of namespace yagi
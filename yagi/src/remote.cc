@@ -0,0 +1,198 @@
+#include "remote.hh"
+#include "cancel.hh"
+#include "resultcache.hh"
+
+#include <filesystem>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Time given to the service on top of the decompilation budget
+	 *			to load an export and send the result
+	 */
+	static const std::chrono::milliseconds SERVICE_SLACK(10000);
+
+	/**********************************************************************/
+	RemoteDecompiler::RemoteDecompiler(uint16_t port, std::string base, Snapshot snapshot, ContentHash hash, uint32_t timeout, std::unique_ptr<Logger> logger)
+		: m_port{ port }, m_base{ std::move(base) }, m_snapshot{ std::move(snapshot) }, m_hash{ std::move(hash) }, m_timeout{ timeout }, m_logger{ std::move(logger) }
+	{}
+
+	/**********************************************************************/
+	RemoteDecompiler::~RemoteDecompiler()
+	{
+		if (!m_source.empty())
+		{
+			std::error_code error;
+			std::filesystem::remove(m_source, error);
+		}
+	}
+
+	/**********************************************************************/
+	bool RemoteDecompiler::updateSource()
+	{
+		if (!m_dirty && !m_source.empty())
+		{
+			return true;
+		}
+
+		// changes made during the export are seen by the next request
+		m_dirty = false;
+		auto path = m_base + "." + std::to_string(++m_generation) + ".yagi";
+		if (!m_snapshot(path))
+		{
+			m_dirty = true;
+			return false;
+		}
+
+		// the service may still map the previous export, removed when possible
+		if (!m_source.empty())
+		{
+			std::error_code error;
+			std::filesystem::remove(m_source, error);
+		}
+		m_source = path;
+		return true;
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> RemoteDecompiler::decompile(uint64_t funcAddress)
+	{
+		// names and types of the function were saved since its last request
+		// hashes are kept across exports, an older one is also out of date
+		auto hash = m_hash(funcAddress);
+		auto previous = m_hashes.find(funcAddress);
+		if (previous != m_hashes.end() && previous->second != hash)
+		{
+			m_dirty = true;
+		}
+		m_hashes[funcAddress] = hash;
+
+		if (!updateSource())
+		{
+			m_logger->error("Unable to export the database for the decompiler service");
+			return std::nullopt;
+		}
+
+		auto message = service::encode(service::Request{ m_base, m_source, funcAddress, m_timeout });
+
+		// the service may have been restarted since the last request
+		if (!m_socket.isValid() || !m_socket.send(message))
+		{
+			m_socket = LocalSocket::connect(m_port);
+			if (!m_socket.send(message))
+			{
+				m_logger->error("Decompiler service unavailable on port ", m_port);
+				return std::nullopt;
+			}
+		}
+
+		auto timeout = m_timeout != 0 ? std::chrono::milliseconds(m_timeout) + SERVICE_SLACK : std::chrono::milliseconds(0);
+		std::vector<uint8_t> buffer;
+		auto status = m_socket.receive(buffer, timeout, [this]() {
+			return m_cancel != nullptr && m_cancel->isCanceled();
+		});
+
+		switch (status)
+		{
+		case LocalSocket::Receive::Ok:
+			break;
+		case LocalSocket::Receive::Canceled:
+			// the late response must not be read by the next request
+			m_socket.close();
+			return std::nullopt;
+		case LocalSocket::Receive::Timeout:
+			m_socket.close();
+			m_logger->error("Decompiler service timeout");
+			return std::nullopt;
+		default:
+			m_logger->error("Decompiler service disconnected");
+			return std::nullopt;
+		}
+
+		service::Response response;
+		if (!service::decode(buffer, response))
+		{
+			m_socket.close();
+			m_logger->error("Malformed response of the decompiler service");
+			return std::nullopt;
+		}
+
+		switch (response.status)
+		{
+		case service::Status::Ok:
+			return deserializeResult(response.result, 0);
+		case service::Status::Error:
+			m_logger->error(response.message);
+			return std::nullopt;
+		default:
+			return std::nullopt;
+		}
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> RemoteDecompiler::refreshNames(uint64_t funcAddress)
+	{
+		return decompile(funcAddress);
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::invalidate(uint64_t funcAddress)
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::invalidateDependents(uint64_t ea)
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::invalidateCode(uint64_t ea)
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::clearCache()
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::invalidateType(const std::string& name)
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::invalidateTypes()
+	{
+		m_dirty = true;
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::retain(uint64_t funcAddress)
+	{}
+
+	/**********************************************************************/
+	void RemoteDecompiler::release(uint64_t funcAddress)
+	{}
+
+	/**********************************************************************/
+	void RemoteDecompiler::setCancelToken(std::shared_ptr<const CancelToken> token)
+	{
+		m_cancel = std::move(token);
+	}
+
+	/**********************************************************************/
+	void RemoteDecompiler::setProfileOutput(std::shared_ptr<ProfileOutput> output)
+	{}
+
+	/**********************************************************************/
+	size_t RemoteDecompiler::prewarmTypes(TypeInfoFactory& source, const std::vector<std::string>& names)
+	{
+		return 0;
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,436 @@
+#include "resultcache.hh"
+
+#include <cstring>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Magic and version of the serialized format
+	 *			Bump the version when the layout changes
+	 */
+	static const uint32_t RESULT_MAGIC = 0x49474159;	// "YAGI"
+	static const uint32_t RESULT_VERSION = 4;
+
+	/**********************************************************************/
+	template<typename T>
+	static void _Write(std::vector<uint8_t>& buffer, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); i++)
+		{
+			buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+	}
+
+	/**********************************************************************/
+	static void _WriteString(std::vector<uint8_t>& buffer, const std::string& value)
+	{
+		_Write<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+		buffer.insert(buffer.end(), value.begin(), value.end());
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Sequential reader over a serialized buffer
+	 *			Every read fails once the end of buffer is reached
+	 */
+	class _Reader
+	{
+	protected:
+		const std::vector<uint8_t>& m_buffer;
+		size_t m_pos;
+
+	public:
+		explicit _Reader(const std::vector<uint8_t>& buffer)
+			: m_buffer{ buffer }, m_pos{ 0 }
+		{}
+
+		template<typename T>
+		bool read(T& value)
+		{
+			if (m_buffer.size() - m_pos < sizeof(T))
+			{
+				return false;
+			}
+
+			uint64_t result = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				result |= static_cast<uint64_t>(m_buffer[m_pos + i]) << (i * 8);
+			}
+			value = static_cast<T>(result);
+			m_pos += sizeof(T);
+			return true;
+		}
+
+		bool readString(std::string& value)
+		{
+			uint32_t size;
+			if (!read(size) || m_buffer.size() - m_pos < size)
+			{
+				return false;
+			}
+			value.assign(reinterpret_cast<const char*>(m_buffer.data() + m_pos), size);
+			m_pos += size;
+			return true;
+		}
+	};
+
+	/**********************************************************************/
+	static void _WriteDependencies(std::vector<uint8_t>& buffer, const Decompiler::Dependencies& dependencies)
+	{
+		_Write<uint32_t>(buffer, static_cast<uint32_t>(dependencies.addresses.size()));
+		for (auto ea : dependencies.addresses)
+		{
+			_Write<uint64_t>(buffer, ea);
+		}
+
+		_Write<uint32_t>(buffer, static_cast<uint32_t>(dependencies.types.size()));
+		for (auto& type : dependencies.types)
+		{
+			_WriteString(buffer, type);
+		}
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Read dependencies written by _WriteDependencies
+	 *			sorted when written
+	 */
+	static bool _ReadDependencies(_Reader& reader, Decompiler::Dependencies& dependencies)
+	{
+		uint32_t nbAddresses;
+		if (!reader.read(nbAddresses))
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < nbAddresses; i++)
+		{
+			uint64_t address;
+			if (!reader.read(address))
+			{
+				return false;
+			}
+			dependencies.addresses.push_back(address);
+		}
+
+		uint32_t nbTypes;
+		if (!reader.read(nbTypes))
+		{
+			return false;
+		}
+		for (uint32_t i = 0; i < nbTypes; i++)
+		{
+			std::string type;
+			if (!reader.readString(type))
+			{
+				return false;
+			}
+			dependencies.types.push_back(std::move(type));
+		}
+		return true;
+	}
+
+	/**********************************************************************/
+	std::vector<uint8_t> serializeResult(uint64_t hash, const Decompiler::Result& result)
+	{
+		std::vector<uint8_t> buffer;
+		buffer.reserve(result.cCode.size() + result.name.size() + 64 * (result.symbols.size() + 1) + 18 * result.tokens.size());
+
+		_Write<uint32_t>(buffer, RESULT_MAGIC);
+		_Write<uint32_t>(buffer, RESULT_VERSION);
+		_Write<uint64_t>(buffer, hash);
+		_Write<uint64_t>(buffer, result.ea);
+		_WriteString(buffer, result.name);
+		_WriteString(buffer, result.cCode);
+
+		_Write<uint32_t>(buffer, static_cast<uint32_t>(result.symbols.size()));
+		for (auto& symbol : result.symbols)
+		{
+			_WriteString(buffer, symbol.name);
+			_WriteString(buffer, symbol.location.spaceName);
+			_Write<uint64_t>(buffer, symbol.location.offset);
+			_Write<uint32_t>(buffer, symbol.location.addrSize);
+			_Write<uint32_t>(buffer, static_cast<uint32_t>(symbol.location.pc.size()));
+			for (auto pc : symbol.location.pc)
+			{
+				_Write<uint64_t>(buffer, pc);
+			}
+		}
+
+		_Write<uint32_t>(buffer, static_cast<uint32_t>(result.tokens.size()));
+		for (auto& token : result.tokens)
+		{
+			_Write<uint32_t>(buffer, token.line);
+			_Write<uint32_t>(buffer, token.start);
+			_Write<uint32_t>(buffer, token.end);
+			_Write<uint32_t>(buffer, token.symbol);
+			_Write<uint8_t>(buffer, static_cast<uint8_t>(token.kind));
+			_Write<uint8_t>(buffer, token.highlight);
+		}
+
+		_WriteDependencies(buffer, result.dependencies);
+		return buffer;
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> deserializeResult(const std::vector<uint8_t>& buffer, uint64_t hash)
+	{
+		_Reader reader(buffer);
+
+		uint32_t magic, version;
+		uint64_t savedHash, ea;
+		std::string name, cCode;
+		if (!reader.read(magic) || magic != RESULT_MAGIC ||
+			!reader.read(version) || version != RESULT_VERSION ||
+			!reader.read(savedHash) || savedHash != hash ||
+			!reader.read(ea) ||
+			!reader.readString(name) ||
+			!reader.readString(cCode))
+		{
+			return std::nullopt;
+		}
+
+		uint32_t nbSymbols;
+		if (!reader.read(nbSymbols))
+		{
+			return std::nullopt;
+		}
+
+		std::vector<Decompiler::Symbol> symbols;
+		for (uint32_t i = 0; i < nbSymbols; i++)
+		{
+			std::string symbolName, spaceName;
+			uint64_t offset;
+			uint32_t addrSize, nbPc;
+			if (!reader.readString(symbolName) ||
+				!reader.readString(spaceName) ||
+				!reader.read(offset) ||
+				!reader.read(addrSize) ||
+				!reader.read(nbPc))
+			{
+				return std::nullopt;
+			}
+
+			MemoryLocation loc(spaceName, offset, addrSize);
+			for (uint32_t j = 0; j < nbPc; j++)
+			{
+				uint64_t pc;
+				if (!reader.read(pc))
+				{
+					return std::nullopt;
+				}
+				loc.pc.push_back(pc);
+			}
+			symbols.emplace_back(std::move(symbolName), std::move(loc));
+		}
+
+		uint32_t nbTokens;
+		if (!reader.read(nbTokens))
+		{
+			return std::nullopt;
+		}
+
+		// the count is not trusted, the buffer ends the loop
+		std::vector<Decompiler::Token> tokens;
+		for (uint32_t i = 0; i < nbTokens; i++)
+		{
+			Decompiler::Token token;
+			if (!reader.read(token.line) ||
+				!reader.read(token.start) ||
+				!reader.read(token.end) ||
+				!reader.read(token.symbol) ||
+				!reader.read(token.kind) ||
+				!reader.read(token.highlight))
+			{
+				return std::nullopt;
+			}
+			tokens.push_back(token);
+		}
+
+		Decompiler::Dependencies dependencies;
+		if (!_ReadDependencies(reader, dependencies))
+		{
+			return std::nullopt;
+		}
+
+		Decompiler::Result result(std::move(name), ea, std::move(cCode), std::move(symbols), std::move(tokens));
+		result.dependencies = std::move(dependencies);
+		return result;
+	}
+
+	/**********************************************************************/
+	std::vector<uint8_t> serializeDependencies(const Decompiler::Dependencies& dependencies)
+	{
+		std::vector<uint8_t> buffer;
+		_WriteDependencies(buffer, dependencies);
+		return buffer;
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Dependencies> deserializeDependencies(const std::vector<uint8_t>& buffer)
+	{
+		_Reader reader(buffer);
+		Decompiler::Dependencies dependencies;
+		if (!_ReadDependencies(reader, dependencies))
+		{
+			return std::nullopt;
+		}
+		return dependencies;
+	}
+
+	/**********************************************************************/
+	ResultCache::ResultCache(size_t capacity, std::unique_ptr<ResultStore> store)
+		: m_capacity{ capacity }, m_store{ std::move(store) }
+	{}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> ResultCache::find(uint64_t ea, uint64_t hash)
+	{
+		auto iter = m_index.find(ea);
+		if (iter != m_index.end())
+		{
+			if (iter->second->hash == hash)
+			{
+				// mark as most recently used
+				m_entries.splice(m_entries.begin(), m_entries, iter->second);
+				return iter->second->result.toResult();
+			}
+
+			// function has changed since the last decompilation
+			m_entries.erase(iter->second);
+			m_index.erase(iter);
+		}
+
+		if (m_store == nullptr)
+		{
+			return std::nullopt;
+		}
+
+		auto stored = m_store->load(ea, hash);
+		if (stored.has_value())
+		{
+			emplace(hash, stored.value());
+		}
+		return stored;
+	}
+
+	/**********************************************************************/
+	void ResultCache::insert(uint64_t hash, const Decompiler::Result& result)
+	{
+		if (m_store != nullptr)
+		{
+			m_store->save(hash, result);
+		}
+
+		emplace(hash, result);
+	}
+
+	/**********************************************************************/
+	void ResultCache::emplace(uint64_t hash, const Decompiler::Result& result)
+	{
+		if (m_capacity == 0)
+		{
+			return;
+		}
+
+		auto iter = m_index.find(result.ea);
+		if (iter != m_index.end())
+		{
+			m_entries.erase(iter->second);
+		}
+
+		m_entries.push_front(Entry{ hash, CompactResult(result) });
+		m_index[result.ea] = m_entries.begin();
+
+		// evict least recently used results
+		while (m_entries.size() > m_capacity)
+		{
+			m_index.erase(m_entries.back().result.getEa());
+			m_entries.pop_back();
+		}
+	}
+
+	/**********************************************************************/
+	void ResultCache::invalidate(uint64_t ea)
+	{
+		auto iter = m_index.find(ea);
+		if (iter != m_index.end())
+		{
+			m_entries.erase(iter->second);
+			m_index.erase(iter);
+		}
+
+		if (m_store != nullptr)
+		{
+			m_store->remove(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void ResultCache::invalidateIf(const std::function<bool(const CompactResult&)>& predicate)
+	{
+		for (auto iter = m_entries.begin(); iter != m_entries.end();)
+		{
+			if (predicate(iter->result))
+			{
+				m_index.erase(iter->result.getEa());
+				iter = m_entries.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	/**********************************************************************/
+	void ResultCache::invalidateDependents(uint64_t ea)
+	{
+		invalidateIf([ea](const CompactResult& result) {
+			return result.getEa() == ea || result.getDependencies().dependsOn(ea);
+		});
+
+		if (m_store != nullptr)
+		{
+			m_store->removeDependents(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void ResultCache::invalidateType(const std::string& name)
+	{
+		invalidateIf([&name](const CompactResult& result) {
+			return result.getDependencies().dependsOn(name);
+		});
+
+		if (m_store != nullptr)
+		{
+			m_store->removeType(name);
+		}
+	}
+
+	/**********************************************************************/
+	void ResultCache::clear()
+	{
+		m_entries.clear();
+		m_index.clear();
+
+		if (m_store != nullptr)
+		{
+			m_store->clear();
+		}
+	}
+
+	/**********************************************************************/
+	size_t ResultCache::size() const noexcept
+	{
+		return m_entries.size();
+	}
+
+	/**********************************************************************/
+	bool ResultCache::isEnabled() const noexcept
+	{
+		return m_capacity > 0 || m_store != nullptr;
+	}
+} // end of namespace yagi
@@ -0,0 +1,165 @@
+#include "resultstore.hh"
+#include "compress.hh"
+
+#include <algorithm>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Parse a compressed result
+	 */
+	static std::optional<Decompiler::Result> _Unpack(const std::vector<uint8_t>& data, uint64_t hash)
+	{
+		auto buffer = decompressBuffer(data);
+		if (!buffer.has_value())
+		{
+			return std::nullopt;
+		}
+		return deserializeResult(buffer.value(), hash);
+	}
+
+	/**********************************************************************/
+	PackedResultStore::PackedResultStore(std::unique_ptr<ResultBlobs> blobs, size_t batch)
+		: m_blobs{ std::move(blobs) }, m_batch{ std::max<size_t>(batch, 1) }
+	{}
+
+	/**********************************************************************/
+	PackedResultStore::~PackedResultStore()
+	{
+		try
+		{
+			flush();
+		}
+		catch (...) {}
+	}
+
+	/**********************************************************************/
+	std::unordered_map<uint64_t, ResultBlobs::IndexEntry>& PackedResultStore::getIndex()
+	{
+		if (!m_index.has_value())
+		{
+			m_index = m_blobs->readIndex();
+		}
+		return m_index.value();
+	}
+
+	/**********************************************************************/
+	std::optional<Decompiler::Result> PackedResultStore::load(uint64_t ea, uint64_t hash)
+	{
+		auto pending = m_pending.find(ea);
+		if (pending != m_pending.end())
+		{
+			if (pending->second.data.empty() || pending->second.hash != hash)
+			{
+				return std::nullopt;
+			}
+			return _Unpack(pending->second.data, hash);
+		}
+
+		// an outdated result is not read
+		auto& index = getIndex();
+		auto entry = index.find(ea);
+		if (entry == index.end() || entry->second.hash != hash)
+		{
+			return std::nullopt;
+		}
+
+		auto data = m_blobs->read(ea);
+		if (!data.has_value())
+		{
+			index.erase(entry);
+			return std::nullopt;
+		}
+		return _Unpack(data.value(), hash);
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::save(uint64_t hash, const Decompiler::Result& result)
+	{
+		getIndex()[result.ea] = ResultBlobs::IndexEntry{ hash, result.dependencies };
+		m_pending[result.ea] = ResultBlobs::Entry{ result.ea, hash, compressBuffer(serializeResult(hash, result)), result.dependencies };
+		if (m_pending.size() >= m_batch)
+		{
+			flush();
+		}
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::remove(uint64_t ea)
+	{
+		auto& index = getIndex();
+		auto entry = index.find(ea);
+		if (entry == index.end())
+		{
+			return;
+		}
+
+		index.erase(entry);
+		m_pending[ea] = ResultBlobs::Entry{ ea, 0, {}, {} };
+		if (m_pending.size() >= m_batch)
+		{
+			flush();
+		}
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::removeIf(const std::function<bool(uint64_t, const ResultBlobs::IndexEntry&)>& predicate)
+	{
+		std::vector<uint64_t> removed;
+		for (auto& entry : getIndex())
+		{
+			if (predicate(entry.first, entry.second))
+			{
+				removed.push_back(entry.first);
+			}
+		}
+
+		for (auto ea : removed)
+		{
+			remove(ea);
+		}
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::removeDependents(uint64_t ea)
+	{
+		removeIf([ea](uint64_t function, const ResultBlobs::IndexEntry& entry) {
+			return function == ea || entry.dependencies.dependsOn(ea);
+		});
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::removeType(const std::string& name)
+	{
+		removeIf([&name](uint64_t, const ResultBlobs::IndexEntry& entry) {
+			return entry.dependencies.dependsOn(name);
+		});
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::clear()
+	{
+		m_pending.clear();
+		m_index.emplace();
+		m_blobs->clear();
+	}
+
+	/**********************************************************************/
+	void PackedResultStore::flush()
+	{
+		if (m_pending.empty())
+		{
+			return;
+		}
+
+		std::vector<ResultBlobs::Entry> entries;
+		entries.reserve(m_pending.size());
+		for (auto& pending : m_pending)
+		{
+			entries.push_back(std::move(pending.second));
+		}
+		m_pending.clear();
+		m_blobs->write(entries);
+	}
+} // end of namespace yagi
\ No newline at end of file
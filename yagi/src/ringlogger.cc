@@ -0,0 +1,74 @@
+#include "ringlogger.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	RingLogger::RingLogger(std::unique_ptr<Logger> inner, size_t capacity, size_t rate)
+		: m_inner{ std::move(inner) }, m_capacity{ capacity }, m_rate{ rate }, m_windowStart{ std::chrono::steady_clock::now() }
+	{
+		if (m_inner != nullptr)
+		{
+			m_level = m_inner->getLevel();
+		}
+		m_messages.reserve(m_capacity);
+	}
+
+	/**********************************************************************/
+	void RingLogger::print(const std::string& message)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_capacity > 0)
+		{
+			if (m_messages.size() < m_capacity)
+			{
+				m_messages.push_back(message);
+			}
+			else
+			{
+				m_messages[m_next] = message;
+				m_next = (m_next + 1) % m_capacity;
+			}
+		}
+
+		if (m_inner == nullptr)
+		{
+			return;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (now - m_windowStart >= std::chrono::seconds(1))
+		{
+			if (m_suppressed > 0)
+			{
+				m_inner->print("[Yagi] INFO :  " + std::to_string(m_suppressed) + " messages suppressed\n");
+			}
+			m_windowStart = now;
+			m_forwarded = 0;
+			m_suppressed = 0;
+		}
+
+		if (m_rate != 0 && m_forwarded >= m_rate)
+		{
+			m_suppressed++;
+			return;
+		}
+
+		m_forwarded++;
+		m_inner->print(message);
+	}
+
+	/**********************************************************************/
+	std::vector<std::string> RingLogger::recent() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		std::vector<std::string> result;
+		result.reserve(m_messages.size());
+		for (size_t i = 0; i < m_messages.size(); i++)
+		{
+			result.push_back(m_messages[(m_next + i) % m_messages.size()]);
+		}
+		return result;
+	}
+} // end of namespace yagi
@@ -0,0 +1,133 @@
+#include "scheduler.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace yagi
+{
+	/**********************************************************************/
+	/*!
+	 * \brief	Name of priority classes into the summary
+	 */
+	static const char* PRIORITY_NAMES[JobScheduler::PRIORITY_COUNT] = { "interactive", "prefetch", "background" };
+
+	/**********************************************************************/
+	double JobScheduler::Stats::getLatency() const noexcept
+	{
+		return done == 0 ? 0 : totalLatency / done;
+	}
+
+	/**********************************************************************/
+	JobScheduler::JobScheduler(double backgroundShare)
+		: m_share{ std::clamp(backgroundShare, 0.01, 1.0) }
+	{}
+
+	/**********************************************************************/
+	bool JobScheduler::mayStart(Priority priority, Clock::time_point now) const noexcept
+	{
+		return priority == Priority::Interactive || now >= m_resume;
+	}
+
+	/**********************************************************************/
+	std::chrono::milliseconds JobScheduler::getDelay(Clock::time_point now) const noexcept
+	{
+		if (now >= m_resume)
+		{
+			return std::chrono::milliseconds(0);
+		}
+		return std::chrono::ceil<std::chrono::milliseconds>(m_resume - now);
+	}
+
+	/**********************************************************************/
+	void JobScheduler::start(Priority priority, Clock::time_point submitted, Clock::time_point now)
+	{
+		m_running = priority;
+		m_submitted = submitted;
+		m_started = now;
+		m_preempted = false;
+	}
+
+	/**********************************************************************/
+	bool JobScheduler::preempt(Priority priority) noexcept
+	{
+		// a prefetch never stops a user request
+		if (!m_running.has_value() || priority > m_running.value())
+		{
+			return false;
+		}
+		m_preempted = true;
+		return true;
+	}
+
+	/**********************************************************************/
+	void JobScheduler::end(Clock::time_point now)
+	{
+		if (!m_running.has_value())
+		{
+			return;
+		}
+
+		auto& stats = m_stats[static_cast<size_t>(m_running.value())];
+		if (m_preempted)
+		{
+			stats.preempted++;
+		}
+		else
+		{
+			std::chrono::duration<double, std::milli> latency = now - m_submitted;
+			stats.done++;
+			stats.totalLatency += latency.count();
+			stats.maxLatency = std::max(stats.maxLatency, latency.count());
+		}
+
+		// the decompiler is left idle long enough to keep the share
+		if (m_running.value() != Priority::Interactive)
+		{
+			auto run = std::chrono::duration_cast<Clock::duration>((now - m_started) * ((1 - m_share) / m_share));
+			m_resume = now + run;
+		}
+		m_running.reset();
+	}
+
+	/**********************************************************************/
+	std::optional<JobScheduler::Priority> JobScheduler::getRunning() const noexcept
+	{
+		return m_running;
+	}
+
+	/**********************************************************************/
+	void JobScheduler::setPending(Priority priority, size_t count) noexcept
+	{
+		m_stats[static_cast<size_t>(priority)].pending = count;
+	}
+
+	/**********************************************************************/
+	const JobScheduler::Stats& JobScheduler::getStats(Priority priority) const noexcept
+	{
+		return m_stats[static_cast<size_t>(priority)];
+	}
+
+	/**********************************************************************/
+	std::string JobScheduler::getSummary() const
+	{
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(0);
+		for (size_t i = 0; i < PRIORITY_COUNT; i++)
+		{
+			auto& stats = m_stats[i];
+			if (i != 0)
+			{
+				ss << ", ";
+			}
+			ss << PRIORITY_NAMES[i] << " " << stats.pending << " pending " << stats.done << " done " << stats.preempted << " preempted"
+				<< " (mean " << stats.getLatency() << " ms, max " << stats.maxLatency << " ms)";
+		}
+
+		if (m_running.has_value())
+		{
+			ss << ", running " << PRIORITY_NAMES[static_cast<size_t>(m_running.value())];
+		}
+		return ss.str();
+	}
+} // end of namespace yagi
\ No newline at end of file
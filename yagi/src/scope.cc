@@ -26,30 +26,33 @@ namespace yagi
 		auto proxy = yagiScope->getProxy();
 		auto archi = static_cast<YagiArchitecture*>(glb);
 
+		// a miss also depends on the address, a function may be created there
+		archi->addDependency(addr.getOffset());
+
 		auto result = proxy->findFunction(addr);
 		if (result != nullptr)
 		{
 			return result;
 		}
 
-		auto data = archi->getSymbolDatabase().find(addr.getOffset());
+		auto data = archi->findSymbol(addr.getOffset());
 
-		if (!data.has_value())
+		if (data == nullptr)
 		{
 			return nullptr;
 		}
 
 		// found a function
-		auto sym = proxy->addFunction(addr, data.value()->getName());
+		auto sym = proxy->addFunction(addr, data->name);
 		auto funcData = sym->getFunction();
 
 		// Apply injection if available
 		// Perform injection first
-		auto injection = archi->findInjection(funcData->getName());
+		auto injection = archi->findInjection(addr.getOffset(), funcData->getName());
 		if (injection.has_value())
 		{
-			archi->getLogger().info("Perform injection ", injection.value());
-			yagiScope->setInjectAttribute(*funcData, injection.value());
+			archi->getLogger().debug("Perform injection ", funcData->getName());
+			funcData->getFuncProto().setInjectId(injection.value());
 		}
 
 		// Try to set model type
@@ -58,23 +61,6 @@ namespace yagi
 		return funcData;
 	}
 
-	/**********************************************************************/
-	void YagiScope::setInjectAttribute(Funcdata& fd, std::string inject_name)
-	{
-		// inject interface is only available through
-		// XML API...
-		std::stringstream ss;
-		fd.getFuncProto().saveXml(ss);
-
-		auto document = xml_tree(ss);
-		Element inject(document->getRoot());
-		inject.setName("inject");
-		inject.addContent(inject_name.c_str(), 0, inject_name.length());
-
-		document->getRoot()->addChild(&inject);
-		fd.getFuncProto().restoreXml(document->getRoot(), glb);
-	}
-
 	/**********************************************************************/
 	SymbolEntry* YagiScope::findAddr(const Address& addr, const Address& usepoint) const
 	{
@@ -91,34 +77,38 @@ namespace yagi
 		auto result = proxy->findContainer(addr, size, usepoint);
 		if (result != nullptr)
 		{
+			// symbols are kept by the scope across decompilations
+			archi->addDependency(result->getAddr().getOffset());
 			return result;
 		}
 
-		std::optional<std::unique_ptr<SymbolInfo>> data = nullopt;
+		const SymbolRecord* data = nullptr;
 
 		if (addr.getSpace() == glb->getDefaultCodeSpace())
 		{
-			data = archi->getSymbolDatabase().find(addr.getOffset());
+			// an unnamed item may be named later
+			archi->addDependency(addr.getOffset());
+			data = archi->findSymbol(addr.getOffset());
 		}
 		
-		if (data.has_value())
+		if (data != nullptr)
 		{
 			auto scope = glb->symboltab->getGlobalScope();
-			auto name = data.value()->getName();
+			auto& name = data->name;
 			Symbol* symbol = nullptr;
 
-			switch (data.value()->getType())
+			switch (data->getType())
 			{
 			case SymbolInfo::Type::Function:
-				archi->getLogger().info("Found function symbol ", name);
+				archi->getLogger().trace("Found function symbol ", name);
 				symbol = proxy->addFunction(addr, name);
 				break;
 			case SymbolInfo::Type::Import:
-				archi->getLogger().info("Found import symbol ", name);
+				archi->getLogger().trace("Found import symbol ", name);
 				symbol = proxy->addExternalRef(addr, addr, name);
 				break;
 			case SymbolInfo::Type::Label:
-				archi->getLogger().info("Found label symbol ", name);
+				archi->getLogger().trace("Found label symbol ", name);
 				symbol = proxy->addCodeLabel(addr, name);
 				break;
 			case SymbolInfo::Type::Other:
@@ -126,12 +116,12 @@ namespace yagi
 				auto type = archi->getTypeInfoFactory().build(addr.getOffset());
 				if (type.has_value())
 				{
-					archi->getLogger().info("Found type", type.value()->getName(),  std::string("for"), name);
+					archi->getLogger().trace("Found type", type.value()->getName(),  std::string("for"), name);
 					symbol = proxy->addSymbol(name, static_cast<TypeManager*>(glb->types)->findByTypeInfo(*(type.value())));
 				}
 				else 
 				{
-					archi->getLogger().info("Unknown type for ", name);
+					archi->getLogger().trace("Unknown type for ", name);
 					symbol = proxy->addSymbol(name, static_cast<TypeManager*>(glb->types)->getBase(size, TYPE_UNKNOWN));
 				}
 				break;
@@ -140,13 +130,16 @@ namespace yagi
 				return nullptr;
 			}
 
-			if (data.value()->isReadOnly())
+			if (data->isReadOnly)
 			{
-				archi->getLogger().info("Apply readonly type for ", name);
+				archi->getLogger().trace("Apply readonly type for ", name);
 				proxy->setAttribute(symbol, Varnode::readonly);
 			}
 
-			archi->getLogger().info("Found symbol ", name, std::string(" at "), to_hex(addr.getOffset()));
+			if (archi->getLogger().isEnabled(LogLevel::Trace))
+			{
+				archi->getLogger().trace("Found symbol ", name, std::string(" at "), to_hex(addr.getOffset()));
+			}
 			return proxy->addMapPoint(symbol, addr, usepoint);
 		}
 
@@ -166,20 +159,22 @@ namespace yagi
 		auto proxy = yagiScope->getProxy();
 		auto archi = static_cast<YagiArchitecture*>(glb);
 
+		archi->addDependency(addr.getOffset());
+
 		auto result = proxy->findExternalRef(addr);
 		if (result != nullptr)
 		{
 			return result;
 		}
 
-		auto data = archi->getSymbolDatabase().find(addr.getOffset());
-		if (!data.has_value() || !data.value()->isImport())
+		auto data = archi->findSymbol(addr.getOffset());
+		if (data == nullptr || !data->isImport)
 		{
 			return nullptr;
 		}
 
-		archi->getLogger().info("Find external ref ", data.value()->getName());
-		return proxy->addExternalRef(addr, addr, data.value()->getName());
+		archi->getLogger().trace("Find external ref ", data->name);
+		return proxy->addExternalRef(addr, addr, data->name);
 	}
 
 	/**********************************************************************/
@@ -189,19 +184,21 @@ namespace yagi
 		auto proxy = yagiScope->getProxy();
 		auto archi = static_cast<YagiArchitecture*>(glb);
 
+		archi->addDependency(addr.getOffset());
+
 		auto result = proxy->findCodeLabel(addr);
 		if (result != nullptr)
 		{
 			return result;
 		}
 
-		auto data = archi->getSymbolDatabase().find(addr.getOffset());
-		if (!data.has_value() || !data.value()->isLabel())
+		auto data = archi->findSymbol(addr.getOffset());
+		if (data == nullptr || !data->isLabel)
 		{
 			return nullptr;
 			
 		}
-		return proxy->addCodeLabel(addr, data.value()->getName());
+		return proxy->addCodeLabel(addr, data->name);
 	}
 
 	/**********************************************************************/
@@ -217,10 +214,11 @@ namespace yagi
 		auto proxy = yagiScope->getProxy();
 		auto archi = static_cast<YagiArchitecture*>(glb);
 
-		auto data = static_cast<YagiArchitecture*>(glb)->getSymbolDatabase().find(sym->getRefAddr().getOffset());
-		if (data.has_value())
+		archi->addDependency(sym->getRefAddr().getOffset());
+		auto data = archi->findSymbol(sym->getRefAddr().getOffset());
+		if (data != nullptr)
 		{
-			auto funcData = proxy->addFunction(sym->getRefAddr(), data.value()->getName())->getFunction();
+			auto funcData = proxy->addFunction(sym->getRefAddr(), data->name)->getFunction();
 
 			// Try to set model type
 			try
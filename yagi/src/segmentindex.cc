@@ -0,0 +1,56 @@
+#include "segmentindex.hh"
+
+#include <algorithm>
+
+namespace yagi
+{
+	/**********************************************************************/
+	// assuming that .data segment are read only to improve static analysis
+	const std::unordered_set<std::string> SegmentIndex::DEFAULT_READ_ONLY = { ".data" };
+
+	/**********************************************************************/
+	SegmentIndex::SegmentIndex(std::unordered_set<std::string> readOnlyNames)
+		: m_readOnlyNames{ std::move(readOnlyNames) }
+	{}
+
+	/**********************************************************************/
+	void SegmentIndex::add(uint64_t start, uint64_t end, const std::string& name, uint32_t perm)
+	{
+		perm &= PERM_EXEC | PERM_WRITE | PERM_READ;
+		bool readOnly = m_readOnlyNames.count(name) != 0
+			|| perm == PERM_READ
+			|| perm == (PERM_READ | PERM_EXEC);
+
+		auto iter = std::upper_bound(m_intervals.begin(), m_intervals.end(), start, [](uint64_t value, const Interval& interval) {
+			return value < interval.start;
+		});
+		m_intervals.insert(iter, Interval{ start, end, readOnly });
+	}
+
+	/**********************************************************************/
+	void SegmentIndex::clear()
+	{
+		m_intervals.clear();
+	}
+
+	/**********************************************************************/
+	bool SegmentIndex::isReadOnly(uint64_t ea) const noexcept
+	{
+		auto iter = std::upper_bound(m_intervals.begin(), m_intervals.end(), ea, [](uint64_t value, const Interval& interval) {
+			return value < interval.start;
+		});
+		if (iter == m_intervals.begin())
+		{
+			return false;
+		}
+
+		--iter;
+		return ea < iter->end && iter->readOnly;
+	}
+
+	/**********************************************************************/
+	size_t SegmentIndex::size() const noexcept
+	{
+		return m_intervals.size();
+	}
+} // end of namespace yagi
@@ -0,0 +1,442 @@
+#include "service.hh"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <mutex>
+
+namespace yagi
+{
+#ifdef _WIN32
+	using NativeSocket = SOCKET;
+	static const NativeSocket NO_SOCKET = INVALID_SOCKET;
+	static const int SEND_FLAGS = 0;
+
+	/**********************************************************************/
+	static int _Poll(NativeSocket handle, int timeout)
+	{
+		WSAPOLLFD fd = { handle, POLLRDNORM, 0 };
+		return WSAPoll(&fd, 1, timeout);
+	}
+
+	/**********************************************************************/
+	static void _CloseNative(NativeSocket handle)
+	{
+		closesocket(handle);
+	}
+#else
+	using NativeSocket = int;
+	static const NativeSocket NO_SOCKET = -1;
+
+	// a lost peer must not raise SIGPIPE in the host process
+#ifdef MSG_NOSIGNAL
+	static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+	static const int SEND_FLAGS = 0;
+#endif
+
+	/**********************************************************************/
+	static int _Poll(NativeSocket handle, int timeout)
+	{
+		pollfd fd = { handle, POLLIN, 0 };
+		return poll(&fd, 1, timeout);
+	}
+
+	/**********************************************************************/
+	static void _CloseNative(NativeSocket handle)
+	{
+		::close(handle);
+	}
+#endif
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Winsock must be started once per process
+	 */
+	static void _InitSockets()
+	{
+#ifdef _WIN32
+		static std::once_flag once;
+		std::call_once(once, []() {
+			WSADATA data;
+			WSAStartup(MAKEWORD(2, 2), &data);
+		});
+#endif
+	}
+
+	/**********************************************************************/
+	static NativeSocket _Native(intptr_t handle)
+	{
+		return handle == -1 ? NO_SOCKET : static_cast<NativeSocket>(handle);
+	}
+
+	/**********************************************************************/
+	static sockaddr_in _Loopback(uint16_t port)
+	{
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		return addr;
+	}
+
+	/**********************************************************************/
+	static void _SetOptions(NativeSocket handle)
+	{
+		// requests and responses are single writes
+		int enabled = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enabled), sizeof(enabled));
+#ifdef SO_NOSIGPIPE
+		setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+	}
+
+	namespace service
+	{
+		/**********************************************************************/
+		template<typename T>
+		static void _Write(std::vector<uint8_t>& buffer, T value)
+		{
+			for (size_t i = 0; i < sizeof(T); i++)
+			{
+				buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+			}
+		}
+
+		/**********************************************************************/
+		static void _WriteBytes(std::vector<uint8_t>& buffer, const void* data, size_t size)
+		{
+			_Write<uint32_t>(buffer, static_cast<uint32_t>(size));
+			auto bytes = static_cast<const uint8_t*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+		}
+
+		/**********************************************************************/
+		/*!
+		 * \brief	Sequential reader over a message
+		 *			Every read fails once the end of the message is reached
+		 */
+		class _Reader
+		{
+		protected:
+			const std::vector<uint8_t>& m_buffer;
+			size_t m_pos = 0;
+
+		public:
+			explicit _Reader(const std::vector<uint8_t>& buffer)
+				: m_buffer{ buffer }
+			{}
+
+			template<typename T>
+			bool read(T& value)
+			{
+				if (m_buffer.size() - m_pos < sizeof(T))
+				{
+					return false;
+				}
+
+				uint64_t result = 0;
+				for (size_t i = 0; i < sizeof(T); i++)
+				{
+					result |= static_cast<uint64_t>(m_buffer[m_pos + i]) << (i * 8);
+				}
+				value = static_cast<T>(result);
+				m_pos += sizeof(T);
+				return true;
+			}
+
+			template<typename Container>
+			bool readBytes(Container& value)
+			{
+				uint32_t size;
+				if (!read(size) || m_buffer.size() - m_pos < size)
+				{
+					return false;
+				}
+				value.assign(m_buffer.begin() + m_pos, m_buffer.begin() + m_pos + size);
+				m_pos += size;
+				return true;
+			}
+
+			bool isDone() const noexcept
+			{
+				return m_pos == m_buffer.size();
+			}
+		};
+
+		/**********************************************************************/
+		std::vector<uint8_t> encode(const Request& request)
+		{
+			std::vector<uint8_t> buffer;
+			_WriteBytes(buffer, request.client.data(), request.client.size());
+			_WriteBytes(buffer, request.source.data(), request.source.size());
+			_Write<uint64_t>(buffer, request.ea);
+			_Write<uint32_t>(buffer, request.timeout);
+			return buffer;
+		}
+
+		/**********************************************************************/
+		bool decode(const std::vector<uint8_t>& buffer, Request& request)
+		{
+			_Reader reader(buffer);
+			return reader.readBytes(request.client)
+				&& reader.readBytes(request.source)
+				&& reader.read(request.ea)
+				&& reader.read(request.timeout)
+				&& reader.isDone();
+		}
+
+		/**********************************************************************/
+		std::vector<uint8_t> encode(const Response& response)
+		{
+			std::vector<uint8_t> buffer;
+			_Write<uint32_t>(buffer, static_cast<uint32_t>(response.status));
+			_WriteBytes(buffer, response.result.data(), response.result.size());
+			_WriteBytes(buffer, response.message.data(), response.message.size());
+			return buffer;
+		}
+
+		/**********************************************************************/
+		bool decode(const std::vector<uint8_t>& buffer, Response& response)
+		{
+			_Reader reader(buffer);
+			uint32_t status;
+			if (!reader.read(status) || status > static_cast<uint32_t>(Status::Error))
+			{
+				return false;
+			}
+			response.status = static_cast<Status>(status);
+			return reader.readBytes(response.result)
+				&& reader.readBytes(response.message)
+				&& reader.isDone();
+		}
+	} // end of namespace service
+
+	/**********************************************************************/
+	LocalSocket::LocalSocket(intptr_t handle)
+		: m_handle{ handle }
+	{}
+
+	/**********************************************************************/
+	LocalSocket::~LocalSocket()
+	{
+		close();
+	}
+
+	/**********************************************************************/
+	LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+		: m_handle{ other.m_handle }
+	{
+		other.m_handle = -1;
+	}
+
+	/**********************************************************************/
+	LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			m_handle = other.m_handle;
+			other.m_handle = -1;
+		}
+		return *this;
+	}
+
+	/**********************************************************************/
+	LocalSocket LocalSocket::connect(uint16_t port)
+	{
+		_InitSockets();
+		auto handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (handle == NO_SOCKET)
+		{
+			return LocalSocket();
+		}
+
+		auto addr = _Loopback(port);
+		if (::connect(handle, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+		{
+			_CloseNative(handle);
+			return LocalSocket();
+		}
+
+		_SetOptions(handle);
+		return LocalSocket(static_cast<intptr_t>(handle));
+	}
+
+	/**********************************************************************/
+	bool LocalSocket::isValid() const noexcept
+	{
+		return m_handle != -1;
+	}
+
+	/**********************************************************************/
+	bool LocalSocket::send(const std::vector<uint8_t>& message)
+	{
+		if (!isValid() || message.size() > service::MAX_MESSAGE_SIZE)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> buffer;
+		buffer.reserve(message.size() + sizeof(uint32_t));
+		service::_Write<uint32_t>(buffer, static_cast<uint32_t>(message.size()));
+		buffer.insert(buffer.end(), message.begin(), message.end());
+
+		size_t sent = 0;
+		while (sent < buffer.size())
+		{
+			auto size = ::send(_Native(m_handle), reinterpret_cast<const char*>(buffer.data() + sent), static_cast<int>(buffer.size() - sent), SEND_FLAGS);
+			if (size <= 0)
+			{
+				close();
+				return false;
+			}
+			sent += static_cast<size_t>(size);
+		}
+		return true;
+	}
+
+	/**********************************************************************/
+	LocalSocket::Receive LocalSocket::receive(std::vector<uint8_t>& message, std::chrono::milliseconds timeout, const CancelCheck& canceled)
+	{
+		// waits are sliced to poll the cancellation
+		const int slice = 50;
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		std::vector<uint8_t> header;
+		std::vector<uint8_t>* target = &header;
+		size_t expected = sizeof(uint32_t);
+		target->resize(expected);
+		size_t received = 0;
+
+		while (isValid())
+		{
+			if (received == expected)
+			{
+				if (target == &message)
+				{
+					return Receive::Ok;
+				}
+
+				uint32_t size = 0;
+				for (size_t i = 0; i < sizeof(uint32_t); i++)
+				{
+					size |= static_cast<uint32_t>(header[i]) << (i * 8);
+				}
+				if (size > service::MAX_MESSAGE_SIZE)
+				{
+					close();
+					return Receive::Closed;
+				}
+
+				target = &message;
+				expected = size;
+				target->resize(expected);
+				received = 0;
+				continue;
+			}
+
+			if (canceled && canceled())
+			{
+				return Receive::Canceled;
+			}
+
+			if (timeout.count() != 0 && std::chrono::steady_clock::now() >= deadline)
+			{
+				return Receive::Timeout;
+			}
+
+			auto ready = _Poll(_Native(m_handle), slice);
+			if (ready < 0)
+			{
+				close();
+				return Receive::Closed;
+			}
+			if (ready == 0)
+			{
+				continue;
+			}
+
+			auto size = ::recv(_Native(m_handle), reinterpret_cast<char*>(target->data() + received), static_cast<int>(expected - received), 0);
+			if (size <= 0)
+			{
+				close();
+				return Receive::Closed;
+			}
+			received += static_cast<size_t>(size);
+		}
+		return Receive::Closed;
+	}
+
+	/**********************************************************************/
+	void LocalSocket::close()
+	{
+		if (isValid())
+		{
+			_CloseNative(_Native(m_handle));
+			m_handle = -1;
+		}
+	}
+
+	/**********************************************************************/
+	bool LocalServer::listen(uint16_t port)
+	{
+		_InitSockets();
+		auto handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (handle == NO_SOCKET)
+		{
+			return false;
+		}
+		m_socket = LocalSocket(static_cast<intptr_t>(handle));
+
+		auto addr = _Loopback(port);
+		if (::bind(handle, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(handle, SOMAXCONN) != 0)
+		{
+			m_socket.close();
+			return false;
+		}
+
+		socklen_t size = sizeof(addr);
+		getsockname(handle, reinterpret_cast<sockaddr*>(&addr), &size);
+		m_port = ntohs(addr.sin_port);
+		return true;
+	}
+
+	/**********************************************************************/
+	uint16_t LocalServer::getPort() const noexcept
+	{
+		return m_port;
+	}
+
+	/**********************************************************************/
+	LocalSocket LocalServer::accept(std::chrono::milliseconds timeout)
+	{
+		if (!m_socket.isValid())
+		{
+			return LocalSocket();
+		}
+
+		auto handle = _Native(m_socket.m_handle);
+		if (_Poll(handle, static_cast<int>(timeout.count())) <= 0)
+		{
+			return LocalSocket();
+		}
+
+		auto client = ::accept(handle, nullptr, nullptr);
+		if (client == NO_SOCKET)
+		{
+			return LocalSocket();
+		}
+		_SetOptions(client);
+		return LocalSocket(static_cast<intptr_t>(client));
+	}
+} // end of namespace yagi
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "servicehost.hh"
+#include "cancel.hh"
+#include "resultcache.hh"
+
+#include <algorithm>
+#include <thread>
+
+namespace yagi
+{
+	/**********************************************************************/
+	ServiceHost::ServiceHost(Factory factory, size_t workers)
+		: m_factory{ std::move(factory) }, m_workers{ std::max<size_t>(1, workers) }
+	{}
+
+	/**********************************************************************/
+	std::unique_ptr<Decompiler> ServiceHost::acquire(const service::Request& request, std::shared_ptr<Pool>& pool)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;)
+			{
+				// a new export replaces every decompiler of the client
+				auto& current = m_pools[request.client];
+				if (current == nullptr || current->source != request.source)
+				{
+					current = std::make_shared<Pool>();
+					current->source = request.source;
+				}
+				pool = current;
+
+				if (!pool->idle.empty())
+				{
+					auto decompiler = std::move(pool->idle.back());
+					pool->idle.pop_back();
+					return decompiler;
+				}
+
+				if (pool->built < m_workers)
+				{
+					pool->built++;
+					break;
+				}
+
+				m_released.wait(lock);
+			}
+		}
+
+		// loading an export is long, other clients are not blocked
+		auto decompiler = m_factory(request.source);
+		if (decompiler == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pool->built--;
+			m_released.notify_all();
+		}
+		return decompiler;
+	}
+
+	/**********************************************************************/
+	void ServiceHost::release(std::shared_ptr<Pool> pool, std::unique_ptr<Decompiler> decompiler)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pool->idle.push_back(std::move(decompiler));
+		}
+		m_released.notify_all();
+	}
+
+	/**********************************************************************/
+	service::Response ServiceHost::handle(const service::Request& request)
+	{
+		std::shared_ptr<Pool> pool;
+		auto decompiler = acquire(request, pool);
+		if (decompiler == nullptr)
+		{
+			return service::Response{ service::Status::Error, {}, "Unable to load " + request.source };
+		}
+
+		service::Response response{ service::Status::NotFound, {}, "" };
+		try
+		{
+			// past the budget the decompiler falls back to a simplified output
+			decompiler->setCancelToken(std::make_shared<CancelToken>(std::chrono::milliseconds(request.timeout)));
+			auto result = decompiler->decompile(request.ea);
+			decompiler->setCancelToken(nullptr);
+
+			if (result.has_value())
+			{
+				response.status = service::Status::Ok;
+				response.result = serializeResult(0, result.value());
+			}
+		}
+		catch (std::exception& e)
+		{
+			response = service::Response{ service::Status::Error, {}, e.what() };
+		}
+
+		release(std::move(pool), std::move(decompiler));
+		return response;
+	}
+
+	/**********************************************************************/
+	void ServiceHost::serve(LocalServer& server, const std::atomic<bool>& stop)
+	{
+		struct Connection
+		{
+			std::thread thread;
+			std::shared_ptr<std::atomic<bool>> done;
+		};
+
+		std::vector<Connection> connections;
+		while (!stop)
+		{
+			// threads of disconnected clients
+			connections.erase(std::remove_if(connections.begin(), connections.end(), [](Connection& connection) {
+				if (!connection.done->load())
+				{
+					return false;
+				}
+				connection.thread.join();
+				return true;
+			}), connections.end());
+
+			auto socket = server.accept(std::chrono::milliseconds(200));
+			if (!socket.isValid())
+			{
+				continue;
+			}
+
+			auto done = std::make_shared<std::atomic<bool>>(false);
+			std::thread thread([this, &stop, done](LocalSocket socket) {
+				std::vector<uint8_t> message;
+				while (socket.receive(message, std::chrono::milliseconds(0), [&stop]() { return stop.load(); }) == LocalSocket::Receive::Ok)
+				{
+					service::Request request;
+					if (!service::decode(message, request) || !socket.send(service::encode(handle(request))))
+					{
+						break;
+					}
+				}
+				*done = true;
+			}, std::move(socket));
+			connections.push_back(Connection{ std::move(thread), done });
+		}
+
+		for (auto& connection : connections)
+		{
+			connection.thread.join();
+		}
+	}
+
+	/**********************************************************************/
+	size_t ServiceHost::getClientCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pools.size();
+	}
+} // end of namespace yagi
\ No newline at end of file
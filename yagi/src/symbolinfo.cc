@@ -26,6 +26,45 @@ namespace yagi
 		return m_name;
 	}
 
+	/**********************************************************************/
+	SymbolRecord::SymbolRecord(const SymbolInfo& symbol)
+		: ea{ symbol.getAddress() }, name{ symbol.getName() },
+		isFunction{ symbol.isFunction() },
+		isLabel{ symbol.isLabel() },
+		isImport{ symbol.isImport() },
+		isReadOnly{ symbol.isReadOnly() }
+	{}
+
+	/**********************************************************************/
+	SymbolInfo::Type SymbolRecord::getType() const noexcept
+	{
+		if (isFunction)
+		{
+			return SymbolInfo::Type::Function;
+		}
+		if (isLabel)
+		{
+			return SymbolInfo::Type::Label;
+		}
+		if (isImport)
+		{
+			return SymbolInfo::Type::Import;
+		}
+
+		return SymbolInfo::Type::Other;
+	}
+
+	/**********************************************************************/
+	std::optional<SymbolRecord> SymbolInfoFactory::find_record(uint64_t ea)
+	{
+		auto symbol = find(ea);
+		if (!symbol.has_value())
+		{
+			return std::nullopt;
+		}
+		return SymbolRecord(*symbol.value());
+	}
+
 	/**********************************************************************/
 	SymbolInfo::Type SymbolInfo::getType() const noexcept
 	{
@@ -0,0 +1,736 @@
+#include "sync.hh"
+#include "exception.hh"
+#include "profile.hh"
+
+namespace yagi
+{
+	/**********************************************************************/
+	RequestQueue::RequestQueue()
+		: m_owner{ std::this_thread::get_id() }, m_woken{ false }
+	{}
+
+	/**********************************************************************/
+	bool RequestQueue::isOwner() const noexcept
+	{
+		return std::this_thread::get_id() == m_owner;
+	}
+
+	/**********************************************************************/
+	void RequestQueue::push(std::shared_ptr<Request> request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests.push_back(std::move(request));
+		}
+		m_pending.notify_one();
+	}
+
+	/**********************************************************************/
+	void RequestQueue::execute(const std::function<void()>& task)
+	{
+		if (isOwner())
+		{
+			task();
+			return;
+		}
+
+		auto request = std::make_shared<Request>();
+		request->task = task;
+		push(request);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_completed.wait(lock, [&request]() { return request->done; });
+
+		if (request->error)
+		{
+			std::rethrow_exception(request->error);
+		}
+	}
+
+	/**********************************************************************/
+	void RequestQueue::post(std::function<void()> task)
+	{
+		if (isOwner())
+		{
+			try
+			{
+				task();
+			}
+			catch (...) {}
+			return;
+		}
+
+		auto request = std::make_shared<Request>();
+		request->task = std::move(task);
+		push(std::move(request));
+	}
+
+	/**********************************************************************/
+	size_t RequestQueue::process(std::chrono::milliseconds timeout)
+	{
+		std::deque<std::shared_ptr<Request>> requests;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_pending.wait_for(lock, timeout, [this]() { return !m_requests.empty() || m_woken; });
+			requests.swap(m_requests);
+			m_woken = false;
+		}
+
+		for (auto& request : requests)
+		{
+			try
+			{
+				request->task();
+			}
+			catch (...)
+			{
+				request->error = std::current_exception();
+			}
+		}
+
+		if (!requests.empty())
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (auto& request : requests)
+				{
+					request->done = true;
+				}
+			}
+			m_completed.notify_all();
+		}
+
+		return requests.size();
+	}
+
+	/**********************************************************************/
+	void RequestQueue::wake()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_woken = true;
+		}
+		m_pending.notify_one();
+	}
+
+	/**********************************************************************/
+	SyncLoader::SyncLoader(RequestQueue& queue, std::unique_ptr<LoadImage> inner)
+		: LoadImage(inner->getFileName()), m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncLoader::~SyncLoader()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::string SyncLoader::getArchType(void) const
+	{
+		ProfileScope scope("backend", "Loader::getArchType");
+		return m_queue.call([this]() { return m_inner->getArchType(); });
+	}
+
+	/**********************************************************************/
+	void SyncLoader::loadFill(uint1* ptr, int4 size, const Address& addr)
+	{
+		ProfileScope scope("backend", "Loader::loadFill");
+		m_queue.execute([&]() { m_inner->loadFill(ptr, size, addr); });
+	}
+
+	/**********************************************************************/
+	void SyncLoader::adjustVma(long adjust)
+	{
+		ProfileScope scope("backend", "Loader::adjustVma");
+		m_queue.execute([&]() { m_inner->adjustVma(adjust); });
+	}
+
+	/**********************************************************************/
+	SyncLoaderFactory::SyncLoaderFactory(RequestQueue& queue, std::unique_ptr<LoaderFactory> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncLoaderFactory::~SyncLoaderFactory()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	LoadImage* SyncLoaderFactory::build()
+	{
+		ProfileScope scope("backend", "LoaderFactory::build");
+		return m_queue.call([this]() -> LoadImage* {
+			return new SyncLoader(m_queue, std::unique_ptr<LoadImage>(m_inner->build()));
+		});
+	}
+
+	/**********************************************************************/
+	SyncLogger::SyncLogger(RequestQueue& queue, std::unique_ptr<Logger> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{
+		// filter on the worker side, before anything is posted
+		m_level = m_inner->getLevel();
+	}
+
+	/**********************************************************************/
+	SyncLogger::~SyncLogger()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	void SyncLogger::print(const std::string& message)
+	{
+		// pending messages keep the inner logger alive
+		auto inner = m_inner;
+		m_queue.post([inner, message]() { inner->print(message); });
+	}
+
+	/**********************************************************************/
+	SyncSymbolInfo::SyncSymbolInfo(const SymbolInfo& symbol)
+		: SymbolInfo(symbol.getAddress(), symbol.getName()),
+		m_isFunction{ symbol.isFunction() },
+		m_isLabel{ symbol.isLabel() },
+		m_isImport{ symbol.isImport() },
+		m_isReadOnly{ symbol.isReadOnly() }
+	{
+		if (m_isFunction)
+		{
+			try
+			{
+				m_functionSize = symbol.getFunctionSize();
+			}
+			catch (SymbolIsNotAFunction&) {}
+		}
+	}
+
+	/**********************************************************************/
+	uint64_t SyncSymbolInfo::getFunctionSize() const
+	{
+		if (!m_functionSize.has_value())
+		{
+			throw SymbolIsNotAFunction(m_name);
+		}
+		return m_functionSize.value();
+	}
+
+	/**********************************************************************/
+	bool SyncSymbolInfo::isFunction() const noexcept
+	{
+		return m_isFunction;
+	}
+
+	/**********************************************************************/
+	bool SyncSymbolInfo::isLabel() const noexcept
+	{
+		return m_isLabel;
+	}
+
+	/**********************************************************************/
+	bool SyncSymbolInfo::isImport() const noexcept
+	{
+		return m_isImport;
+	}
+
+	/**********************************************************************/
+	bool SyncSymbolInfo::isReadOnly() const noexcept
+	{
+		return m_isReadOnly;
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Wrap an optional type built on the owner thread
+	 */
+	static std::optional<std::unique_ptr<TypeInfo>> _WrapType(RequestQueue& queue, std::optional<std::unique_ptr<TypeInfo>> type)
+	{
+		if (!type.has_value())
+		{
+			return std::nullopt;
+		}
+		return std::make_unique<SyncTypeInfo>(queue, std::move(type.value()));
+	}
+
+	/**********************************************************************/
+	SyncFunctionSymbolInfo::SyncFunctionSymbolInfo(RequestQueue& queue, std::unique_ptr<FunctionSymbolInfo> inner)
+		: FunctionSymbolInfo(std::make_unique<SyncSymbolInfo>(inner->getSymbol())),
+		m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncFunctionSymbolInfo::~SyncFunctionSymbolInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::string> SyncFunctionSymbolInfo::findStackVar(uint64_t offset, uint32_t addrSize)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::findStackVar");
+		return m_queue.call([&]() { return m_inner->findStackVar(offset, addrSize); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::string> SyncFunctionSymbolInfo::findName(uint64_t pc, const std::string& space, uint64_t& offset)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::findName");
+		return m_queue.call([&]() { return m_inner->findName(pc, space, offset); });
+	}
+
+	/**********************************************************************/
+	void SyncFunctionSymbolInfo::saveName(const MemoryLocation& loc, const std::string& name)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::saveName");
+		m_queue.execute([&]() { m_inner->saveName(loc, name); });
+	}
+
+	/**********************************************************************/
+	void SyncFunctionSymbolInfo::saveType(const MemoryLocation& loc, const TypeInfo& newType)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::saveType");
+		m_queue.execute([&]() { m_inner->saveType(loc, newType); });
+	}
+
+	/**********************************************************************/
+	bool SyncFunctionSymbolInfo::clearType(const MemoryLocation& loc)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::clearType");
+		return m_queue.call([&]() { return m_inner->clearType(loc); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> SyncFunctionSymbolInfo::findType(uint64_t pc, const std::string& from, uint64_t& offset)
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::findType");
+		return m_queue.call([&]() { return _WrapType(m_queue, m_inner->findType(pc, from, offset)); });
+	}
+
+	/**********************************************************************/
+	LocalOverrides SyncFunctionSymbolInfo::findLocalOverrides()
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::findLocalOverrides");
+		return m_queue.call([this]() {
+			auto overrides = m_inner->findLocalOverrides();
+			for (auto& entry : overrides.types)
+			{
+				entry.second.type = std::make_unique<SyncTypeInfo>(m_queue, std::move(entry.second.type));
+			}
+			return overrides;
+		});
+	}
+
+	/**********************************************************************/
+	FlowHints SyncFunctionSymbolInfo::findFlowHints()
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::findFlowHints");
+		return m_queue.call([this]() { return m_inner->findFlowHints(); });
+	}
+
+	/**********************************************************************/
+	uint64_t SyncFunctionSymbolInfo::getContentHash()
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::getContentHash");
+		return m_queue.call([this]() { return m_inner->getContentHash(); });
+	}
+
+	/**********************************************************************/
+	uint64_t SyncFunctionSymbolInfo::getCloneHash()
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::getCloneHash");
+		return m_queue.call([this]() { return m_inner->getCloneHash(); });
+	}
+
+	/**********************************************************************/
+	bool SyncFunctionSymbolInfo::isLibrary()
+	{
+		ProfileScope scope("backend", "FunctionSymbolInfo::isLibrary");
+		return m_queue.call([this]() { return m_inner->isLibrary(); });
+	}
+
+	/**********************************************************************/
+	SyncSymbolInfoFactory::SyncSymbolInfoFactory(RequestQueue& queue, std::unique_ptr<SymbolInfoFactory> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncSymbolInfoFactory::~SyncSymbolInfoFactory()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<SymbolInfo>> SyncSymbolInfoFactory::find(uint64_t ea)
+	{
+		ProfileScope scope("backend", "SymbolInfoFactory::find");
+		return m_queue.call([&]() -> std::optional<std::unique_ptr<SymbolInfo>> {
+			auto symbol = m_inner->find(ea);
+			if (!symbol.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncSymbolInfo>(*symbol.value());
+		});
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FunctionSymbolInfo>> SyncSymbolInfoFactory::find_function(uint64_t ea)
+	{
+		ProfileScope scope("backend", "SymbolInfoFactory::find_function");
+		return m_queue.call([&]() -> std::optional<std::unique_ptr<FunctionSymbolInfo>> {
+			auto function = m_inner->find_function(ea);
+			if (!function.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncFunctionSymbolInfo>(m_queue, std::move(function.value()));
+		});
+	}
+
+	/**********************************************************************/
+	std::optional<SymbolRecord> SyncSymbolInfoFactory::find_record(uint64_t ea)
+	{
+		ProfileScope scope("backend", "SymbolInfoFactory::find_record");
+		return m_queue.call([&]() { return m_inner->find_record(ea); });
+	}
+
+	/**********************************************************************/
+	std::unordered_map<std::string, uint64_t> SyncSymbolInfoFactory::find_addresses(const std::vector<std::string>& names)
+	{
+		ProfileScope scope("backend", "SymbolInfoFactory::find_addresses");
+		return m_queue.call([&]() { return m_inner->find_addresses(names); });
+	}
+
+	/**********************************************************************/
+	SyncTypeInfo::SyncTypeInfo(RequestQueue& queue, std::unique_ptr<TypeInfo> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) },
+		m_size{ m_inner->getSize() },
+		m_name{ m_inner->getName() },
+		m_isInt{ m_inner->isInt() },
+		m_isBool{ m_inner->isBool() },
+		m_isFloat{ m_inner->isFloat() },
+		m_isVoid{ m_inner->isVoid() },
+		m_isConst{ m_inner->isConst() },
+		m_isChar{ m_inner->isChar() },
+		m_isUnicode{ m_inner->isUnicode() }
+	{}
+
+	/**********************************************************************/
+	SyncTypeInfo::~SyncTypeInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	size_t SyncTypeInfo::getSize() const
+	{
+		return m_size;
+	}
+
+	/**********************************************************************/
+	std::string SyncTypeInfo::getName() const
+	{
+		return m_name;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isInt() const
+	{
+		return m_isInt;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isBool() const
+	{
+		return m_isBool;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isFloat() const
+	{
+		return m_isFloat;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isVoid() const
+	{
+		return m_isVoid;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isConst() const
+	{
+		return m_isConst;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isChar() const
+	{
+		return m_isChar;
+	}
+
+	/**********************************************************************/
+	bool SyncTypeInfo::isUnicode() const
+	{
+		return m_isUnicode;
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<FuncInfo>> SyncTypeInfo::toFunc() const
+	{
+		ProfileScope scope("backend", "TypeInfo::toFunc");
+		return m_queue.call([this]() -> std::optional<std::unique_ptr<FuncInfo>> {
+			auto func = m_inner->toFunc();
+			if (!func.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncFuncInfo>(m_queue, std::move(func.value()));
+		});
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<StructInfo>> SyncTypeInfo::toStruct() const
+	{
+		ProfileScope scope("backend", "TypeInfo::toStruct");
+		return m_queue.call([this]() -> std::optional<std::unique_ptr<StructInfo>> {
+			auto structure = m_inner->toStruct();
+			if (!structure.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncStructInfo>(m_queue, std::move(structure.value()));
+		});
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<PtrInfo>> SyncTypeInfo::toPtr() const
+	{
+		ProfileScope scope("backend", "TypeInfo::toPtr");
+		return m_queue.call([this]() -> std::optional<std::unique_ptr<PtrInfo>> {
+			auto ptr = m_inner->toPtr();
+			if (!ptr.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncPtrInfo>(m_queue, std::move(ptr.value()));
+		});
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<ArrayInfo>> SyncTypeInfo::toArray() const
+	{
+		ProfileScope scope("backend", "TypeInfo::toArray");
+		return m_queue.call([this]() -> std::optional<std::unique_ptr<ArrayInfo>> {
+			auto array = m_inner->toArray();
+			if (!array.has_value())
+			{
+				return std::nullopt;
+			}
+			return std::make_unique<SyncArrayInfo>(m_queue, std::move(array.value()));
+		});
+	}
+
+	/**********************************************************************/
+	SyncFuncInfo::SyncFuncInfo(RequestQueue& queue, std::unique_ptr<FuncInfo> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncFuncInfo::~SyncFuncInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	bool SyncFuncInfo::isDotDotDot() const
+	{
+		ProfileScope scope("backend", "FuncInfo::isDotDotDot");
+		return m_queue.call([this]() { return m_inner->isDotDotDot(); });
+	}
+
+	/**********************************************************************/
+	std::vector<std::unique_ptr<TypeInfo>> SyncFuncInfo::getFuncPrototype() const
+	{
+		ProfileScope scope("backend", "FuncInfo::getFuncPrototype");
+		return m_queue.call([this]() {
+			std::vector<std::unique_ptr<TypeInfo>> result;
+			for (auto& type : m_inner->getFuncPrototype())
+			{
+				result.push_back(std::make_unique<SyncTypeInfo>(m_queue, std::move(type)));
+			}
+			return result;
+		});
+	}
+
+	/**********************************************************************/
+	std::vector<std::string> SyncFuncInfo::getFuncParamName() const
+	{
+		ProfileScope scope("backend", "FuncInfo::getFuncParamName");
+		return m_queue.call([this]() { return m_inner->getFuncParamName(); });
+	}
+
+	/**********************************************************************/
+	std::string SyncFuncInfo::getCallingConv() const
+	{
+		ProfileScope scope("backend", "FuncInfo::getCallingConv");
+		return m_queue.call([this]() { return m_inner->getCallingConv(); });
+	}
+
+	/**********************************************************************/
+	std::string SyncFuncInfo::getName() const
+	{
+		ProfileScope scope("backend", "FuncInfo::getName");
+		return m_queue.call([this]() { return m_inner->getName(); });
+	}
+
+	/**********************************************************************/
+	SyncStructInfo::SyncStructInfo(RequestQueue& queue, std::unique_ptr<StructInfo> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncStructInfo::~SyncStructInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::vector<TypeStructField> SyncStructInfo::getFields() const
+	{
+		ProfileScope scope("backend", "StructInfo::getFields");
+		return m_queue.call([this]() {
+			auto fields = m_inner->getFields();
+			for (auto& field : fields)
+			{
+				field.type = std::make_unique<SyncTypeInfo>(m_queue, std::move(field.type));
+			}
+			return fields;
+		});
+	}
+
+	/**********************************************************************/
+	SyncPtrInfo::SyncPtrInfo(RequestQueue& queue, std::unique_ptr<PtrInfo> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncPtrInfo::~SyncPtrInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::unique_ptr<TypeInfo> SyncPtrInfo::getPointedObject() const
+	{
+		ProfileScope scope("backend", "PtrInfo::getPointedObject");
+		return m_queue.call([this]() -> std::unique_ptr<TypeInfo> {
+			return std::make_unique<SyncTypeInfo>(m_queue, m_inner->getPointedObject());
+		});
+	}
+
+	/**********************************************************************/
+	SyncArrayInfo::SyncArrayInfo(RequestQueue& queue, std::unique_ptr<ArrayInfo> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncArrayInfo::~SyncArrayInfo()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::unique_ptr<TypeInfo> SyncArrayInfo::getPointedObject() const
+	{
+		ProfileScope scope("backend", "ArrayInfo::getPointedObject");
+		return m_queue.call([this]() -> std::unique_ptr<TypeInfo> {
+			return std::make_unique<SyncTypeInfo>(m_queue, m_inner->getPointedObject());
+		});
+	}
+
+	/**********************************************************************/
+	uint64_t SyncArrayInfo::getSize() const
+	{
+		ProfileScope scope("backend", "ArrayInfo::getSize");
+		return m_queue.call([this]() { return m_inner->getSize(); });
+	}
+
+	/**********************************************************************/
+	SyncTypeInfoFactory::SyncTypeInfoFactory(RequestQueue& queue, std::unique_ptr<TypeInfoFactory> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncTypeInfoFactory::~SyncTypeInfoFactory()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> SyncTypeInfoFactory::build(const std::string& name)
+	{
+		ProfileScope scope("backend", "TypeInfoFactory::build");
+		return m_queue.call([&]() { return _WrapType(m_queue, m_inner->build(name)); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::unique_ptr<TypeInfo>> SyncTypeInfoFactory::build(uint64_t ea)
+	{
+		ProfileScope scope("backend", "TypeInfoFactory::build");
+		return m_queue.call([&]() { return _WrapType(m_queue, m_inner->build(ea)); });
+	}
+
+	/**********************************************************************/
+	void SyncTypeInfoFactory::invalidate(const std::string& name)
+	{
+		ProfileScope scope("backend", "TypeInfoFactory::invalidate");
+		m_queue.execute([&]() { m_inner->invalidate(name); });
+	}
+
+	/**********************************************************************/
+	void SyncTypeInfoFactory::invalidateAll()
+	{
+		ProfileScope scope("backend", "TypeInfoFactory::invalidateAll");
+		m_queue.execute([&]() { m_inner->invalidateAll(); });
+	}
+
+	/**********************************************************************/
+	SyncResultBlobs::SyncResultBlobs(RequestQueue& queue, std::unique_ptr<ResultBlobs> inner)
+		: m_queue{ queue }, m_inner{ std::move(inner) }
+	{}
+
+	/**********************************************************************/
+	SyncResultBlobs::~SyncResultBlobs()
+	{
+		m_queue.execute([this]() { m_inner.reset(); });
+	}
+
+	/**********************************************************************/
+	std::unordered_map<uint64_t, ResultBlobs::IndexEntry> SyncResultBlobs::readIndex()
+	{
+		ProfileScope scope("backend", "ResultBlobs::readIndex");
+		return m_queue.call([&]() { return m_inner->readIndex(); });
+	}
+
+	/**********************************************************************/
+	std::optional<std::vector<uint8_t>> SyncResultBlobs::read(uint64_t ea)
+	{
+		ProfileScope scope("backend", "ResultBlobs::read");
+		return m_queue.call([&]() { return m_inner->read(ea); });
+	}
+
+	/**********************************************************************/
+	void SyncResultBlobs::write(const std::vector<Entry>& entries)
+	{
+		// requests are processed in order, a later read sees the write
+		m_queue.post([this, entries]() { m_inner->write(entries); });
+	}
+
+	/**********************************************************************/
+	void SyncResultBlobs::clear()
+	{
+		ProfileScope scope("backend", "ResultBlobs::clear");
+		m_queue.execute([this]() { m_inner->clear(); });
+	}
+} // end of namespace yagi
@@ -1,7 +1,9 @@
 #include "typemanager.hh"
 #include "base.hh"
 #include "exception.hh"
+#include "profile.hh"
 
+#include <algorithm>
 #include <regex>
 
 namespace yagi 
@@ -16,23 +18,76 @@ namespace yagi
 	/**********************************************************************/
 	Datatype* TypeManager::findById(const string& n, uint8 id, int4 sz)
 	{
-		auto cached = findByIdLocal(n, id);
+		// entry point of Ghidra, nested translations are accounted here
+		ProfileScope scope("types", "TypeManager::findById");
+		auto result = tryFindById(n, id);
+		if (result == nullptr)
+		{
+			throw UnknownTypeError(n);
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	Datatype* TypeManager::tryFindById(const std::string& name, uint8 id)
+	{
+		if (!m_parsing.empty())
+		{
+			m_nested[m_parsing.back()].insert(name);
+		}
+		addDependency(name);
+
+		auto cached = findByIdLocal(name, id);
 
 		if (cached != nullptr)
 		{
 			return cached;
 		}
 
-		auto type = m_archi->getTypeInfoFactory().build(n);
+		std::optional<std::unique_ptr<TypeInfo>> type;
+		if (m_source != nullptr)
+		{
+			type = m_source->build(name);
+		}
+		if (!type.has_value())
+		{
+			type = m_archi->getTypeInfoFactory().build(name);
+		}
 		
 		if (!type.has_value())
 		{
-			throw UnknownTypeError(n);
+			return nullptr;
 		}
 
 		return parseTypeInfo(*(type.value()));
 	}
 
+	/**********************************************************************/
+	void TypeManager::addDependency(const std::string& name)
+	{
+		if (!m_archi->addDependency(name))
+		{
+			return;
+		}
+
+		auto iter = m_nested.find(name);
+		if (iter == m_nested.end())
+		{
+			return;
+		}
+
+		for (auto& nested : iter->second)
+		{
+			addDependency(nested);
+		}
+	}
+
+	/**********************************************************************/
+	Datatype* TypeManager::tryFindByName(const std::string& name)
+	{
+		return tryFindById(name, 0);
+	}
+
 	/**********************************************************************/
 	TypeCode* TypeManager::parseFunc(const FuncInfo& typeInfo)
 	{
@@ -71,7 +126,7 @@ namespace yagi
 			{
 				cc = (*m_archi->protoModels.begin()).first;
 			}
-			m_archi->getLogger().info("use ", cc, std::string("as default calling convention for "), typeInfo.getName());
+			m_archi->getLogger().debug("use ", cc, std::string("as default calling convention for "), typeInfo.getName());
 		}
 
 		auto newType = getTypeCode(glb->getModel(cc), retType, paramType, typeInfo.isDotDotDot());
@@ -81,8 +136,27 @@ namespace yagi
 
 	/**********************************************************************/
 	Datatype* TypeManager::parseTypeInfo(const TypeInfo& typeInfo)
+	{
+		// types looked up meanwhile are nested into this one
+		m_parsing.push_back(typeInfo.getName());
+		try
+		{
+			auto result = translate(typeInfo);
+			m_parsing.pop_back();
+			return result;
+		}
+		catch (...)
+		{
+			m_parsing.pop_back();
+			throw;
+		}
+	}
+
+	/**********************************************************************/
+	Datatype* TypeManager::translate(const TypeInfo& typeInfo)
 	{
 		auto name = typeInfo.getName();
+		m_translated.insert(name);
 
 		auto ptrType = typeInfo.toPtr();
 		if (ptrType.has_value())
@@ -195,18 +269,74 @@ namespace yagi
 	/**********************************************************************/
 	Datatype* TypeManager::findByTypeInfo(const TypeInfo& typeInfo)
 	{
-		try
+		auto result = tryFindByName(typeInfo.getName());
+		if (result != nullptr)
 		{
-			return findByName(typeInfo.getName());
+			return result;
 		}
-		catch (UnknownTypeError&) {}
 
 		return parseTypeInfo(typeInfo);
 	}
 
+	/**********************************************************************/
+	/*!
+	 * \brief	Read types from a source for the lifetime of the guard
+	 *			even if the translation raises
+	 */
+	class TypeSourceGuard
+	{
+	protected:
+		TypeInfoFactory*& m_source;
+
+	public:
+		TypeSourceGuard(TypeInfoFactory*& slot, TypeInfoFactory& source)
+			: m_source{ slot }
+		{
+			m_source = &source;
+		}
+
+		~TypeSourceGuard()
+		{
+			m_source = nullptr;
+		}
+
+		TypeSourceGuard(const TypeSourceGuard&) = delete;
+		TypeSourceGuard& operator=(const TypeSourceGuard&) = delete;
+	};
+
+	/**********************************************************************/
+	size_t TypeManager::prewarm(TypeInfoFactory& source, const std::vector<std::string>& names)
+	{
+		TypeSourceGuard guard(m_source, source);
+		size_t count = 0;
+		for (auto& name : names)
+		{
+			if (m_archi->isCanceled())
+			{
+				break;
+			}
+
+			try
+			{
+				tryFindByName(name);
+			}
+			catch (Error& e)
+			{
+				m_archi->getLogger().debug("Unable to prewarm type ", name, " : ", e.what());
+			}
+			catch (LowlevelError& e)
+			{
+				m_archi->getLogger().debug("Unable to prewarm type ", name, " : ", e.explain);
+			}
+			count++;
+		}
+		return count;
+	}
+
 	/**********************************************************************/
 	void TypeManager::update(Funcdata& func)
 	{
+		ProfileScope scope("types", "TypeManager::update");
 		auto typeInfo = m_archi->getTypeInfoFactory().build(func.getAddress().getOffset());
 		if (!typeInfo.has_value())
 		{
@@ -243,4 +373,48 @@ namespace yagi
 			func.getFuncProto().setPieces(pieces);
 		}
 	}
+
+	/**********************************************************************/
+	void TypeManager::invalidate(const std::string& name)
+	{
+		m_changed.insert(name);
+	}
+
+	/**********************************************************************/
+	void TypeManager::invalidateAll()
+	{
+		m_changedAll = true;
+	}
+
+	/**********************************************************************/
+	bool TypeManager::isStale() const
+	{
+		if (m_translated.empty())
+		{
+			return false;
+		}
+
+		return m_changedAll || std::any_of(m_changed.begin(), m_changed.end(),
+			[this](const std::string& name)
+			{
+				return m_translated.find(name) != m_translated.end();
+			}
+		);
+	}
+
+	/**********************************************************************/
+	void TypeManager::sync()
+	{
+		auto stale = isStale();
+
+		m_changed.clear();
+		m_changedAll = false;
+
+		if (stale)
+		{
+			clearNoncore();
+			m_translated.clear();
+			m_nested.clear();
+		}
+	}
 } // end of namespace yagi
\ No newline at end of file
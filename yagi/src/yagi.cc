@@ -12,11 +12,13 @@
 
 #include <sstream>
 #include <filesystem>
+#include <fstream>
 
 #include <loader.hpp>
 #include <ida.hpp>
 #include <idp.hpp>
 #include <diskio.hpp>
+#include <segregs.hpp>
 #include <plugin.hh>
 #include "decompiler.hh"
 #include "ghidradecompiler.hh"
@@ -24,7 +26,29 @@
 #include "idatype.hh"
 #include "idasymbol.hh"
 #include "idalogger.hh"
+#include "idacache.hh"
+#include "cachedloader.hh"
+#include "idaloader.hh"
+#include "idaimage.hh"
+#include "idaexport.hh"
+#include "exportdatabase.hh"
+#include "imageloader.hh"
 #include "loader.hh"
+#include "options.hh"
+#include "ringlogger.hh"
+#include "deferred.hh"
+#include "multiarch.hh"
+#include "remote.hh"
+#include "sync.hh"
+
+// number of decompiler messages kept in memory
+#define YAGI_LOG_HISTORY 1024
+
+// number of pages read from IDA kept in memory (16 MiB)
+#define YAGI_PAGE_CACHE_SIZE 4096
+
+// number of results saved into the database at once
+#define YAGI_RESULT_BATCH 32
 
 
 static int processor_id() {
@@ -110,6 +134,153 @@ static yagi::Compiler compute_compiler() {
 	);
 }
 
+/*!
+ * \brief	compute the compiler of a function
+ *			from the segment registers selecting the instruction set
+ * \param	compiler	compiler of the database
+ * \param	ea			address of the function
+ */
+static yagi::Compiler compute_function_compiler(const yagi::Compiler& compiler, uint64_t ea) {
+	auto result = compiler;
+	switch (compiler.language)
+	{
+	case yagi::Compiler::Language::ARM:
+		{
+			static const int thumb = str2reg("T");
+			if (compiler.mode != yagi::Compiler::Mode::M64 && thumb >= 0 && get_sreg(ea, thumb) == 1)
+			{
+				result.isa = yagi::Compiler::Isa::Thumb;
+			}
+		}
+		break;
+	case yagi::Compiler::Language::MIPS:
+		{
+			static const int mips16 = str2reg("mips16");
+			if (mips16 >= 0 && get_sreg(ea, mips16) == 1)
+			{
+				result.isa = yagi::Compiler::Isa::Mips16;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	return result;
+}
+
+/*!
+ * \brief	build a decompiler using IDA backends
+ *			Decompilations run out of the main thread,
+ *			so every IDA backend goes through the queue
+ * \param	queue		requests processed by the main thread
+ * \param	compiler	compiler to load
+ * \param	options		user configuration
+ * \param	image		snapshot to read bytes from, null to read from IDA
+ * \param	pages		pages read from IDA, shared by decompilers, used without snapshot
+ * \param	imports		import index shared with the plugin
+ * \param	segments	segment index shared with the plugin
+ * \param	names		name cache shared with the plugin
+ * \param	resultBlobs	optional persistent storage of results
+ */
+static std::optional<std::unique_ptr<yagi::Decompiler>> build_decompiler(
+	yagi::RequestQueue& queue,
+	const yagi::Compiler& compiler,
+	const yagi::Options& options,
+	std::shared_ptr<yagi::MemoryImage> image,
+	std::shared_ptr<yagi::PageCache> pages,
+	std::shared_ptr<yagi::IdaImportIndex> imports,
+	std::shared_ptr<yagi::IdaSegmentIndex> segments,
+	std::shared_ptr<yagi::IdaNameCache> names,
+	std::unique_ptr<yagi::ResultBlobs> resultBlobs
+) {
+	std::unique_ptr<yagi::LoaderFactory> loaderFactory;
+	if (image != nullptr)
+	{
+		loaderFactory = std::make_unique<yagi::ImageLoaderFactory>(image);
+	}
+	else
+	{
+		// Ghidra reads a few bytes at a time, each read would be a request to the main thread
+		loaderFactory = std::make_unique<yagi::CachedLoaderFactory>(
+			pages,
+			std::make_unique<yagi::SyncLoaderFactory>(queue, std::make_unique<yagi::IdaLoaderFactory>())
+		);
+	}
+
+	// results are compressed by the decompiler thread, the main thread only copies blobs
+	std::unique_ptr<yagi::ResultStore> resultStore;
+	if (resultBlobs != nullptr)
+	{
+		resultStore = std::make_unique<yagi::PackedResultStore>(
+			std::make_unique<yagi::SyncResultBlobs>(queue, std::move(resultBlobs)),
+			YAGI_RESULT_BATCH
+		);
+	}
+
+	// last messages are kept in memory, the output window is rate limited
+	auto decompilerLogger = std::make_unique<yagi::RingLogger>(
+		std::make_unique<yagi::SyncLogger>(queue, std::make_unique<yagi::IdaLogger>(options.logLevel)),
+		YAGI_LOG_HISTORY,
+		options.logRate
+	);
+
+	return yagi::GhidraDecompiler::build(
+		compiler,
+		options,
+		std::move(loaderFactory),
+		std::move(decompilerLogger),
+		std::make_unique<yagi::SyncSymbolInfoFactory>(queue, std::make_unique<yagi::IdaSymbolInfoFactory>(imports, segments, names)),
+		std::make_unique<yagi::SyncTypeInfoFactory>(queue, std::make_unique<yagi::IdaTypeInfoFactory>()),
+		std::move(resultStore)
+	);
+}
+
+/*!
+ * \brief	build a decompiler running into the decompiler service
+ *			The service decompiles from exports written next to the database
+ * \param	queue		requests processed by the main thread
+ * \param	compiler	compiler of the database
+ * \param	options		user configuration
+ * \param	imports		import index shared with the plugin
+ * \param	segments	segment index shared with the plugin
+ * \param	names		name cache shared with the plugin
+ */
+static std::unique_ptr<yagi::Decompiler> build_remote_decompiler(
+	std::shared_ptr<yagi::RequestQueue> queue,
+	const yagi::Compiler& compiler,
+	const yagi::Options& options,
+	std::shared_ptr<yagi::IdaImportIndex> imports,
+	std::shared_ptr<yagi::IdaSegmentIndex> segments,
+	std::shared_ptr<yagi::IdaNameCache> names
+) {
+	// exports are written from the main thread, the service reads them
+	auto snapshot = [queue, compiler, imports](const std::string& path) {
+		return queue->call([&]() {
+			yagi::ExportDatabase database(compiler);
+			yagi::exportIdaDatabase(imports, database);
+			std::ofstream stream(path, std::ios::binary);
+			database.write(stream);
+			return stream.good();
+		});
+	};
+
+	auto hash = [queue, imports, segments, names](uint64_t ea) {
+		return queue->call([&]() -> uint64_t {
+			auto function = yagi::IdaSymbolInfoFactory(imports, segments, names).find_function(ea);
+			return function.has_value() ? function.value()->getContentHash() : 0;
+		});
+	};
+
+	return std::make_unique<yagi::RemoteDecompiler>(
+		static_cast<uint16_t>(options.servicePort),
+		std::string(get_path(PATH_TYPE_IDB)) + ".service",
+		snapshot,
+		hash,
+		static_cast<uint32_t>(options.serviceTimeout),
+		std::make_unique<yagi::SyncLogger>(*queue, std::make_unique<yagi::IdaLogger>(options.logLevel))
+	);
+}
+
 /*
  *	\brief init function called from IDA directly
  */
@@ -133,20 +304,81 @@ static plugmod_t* idaapi yagi_init(void)
 
 		// Remove "/Ghidra" in the path
 		std::filesystem::path ghidraPath = paths_list.at(0).c_str();
-		yagi::ghidra::init(ghidraPath.parent_path().string());
+		auto ghidraRoot = ghidraPath.parent_path().string();
+
+		// names and types saved by previous versions
+		yagi::migrateLegacyOverrides();
 
 		auto compilerId = compute_compiler();
 
-		auto decompiler = yagi::GhidraDecompiler::build(
-			compilerId,
-			std::move(logger),
-			std::make_unique<yagi::IdaSymbolInfoFactory>(),
-			std::make_unique<yagi::IdaTypeInfoFactory>()
-		);
-		if (decompiler.has_value())
+		// user options from the command line (-Oyagi:key=value,...)
+		auto pluginOptions = get_plugin_options("yagi");
+		auto options = yagi::Options::parse(pluginOptions != nullptr ? pluginOptions : "");
+
+		// segments are captured from the main thread
+		// or pages read from IDA on demand
+		std::shared_ptr<yagi::MemoryImage> image;
+		std::shared_ptr<yagi::PageCache> pages;
+		if (options.loader == yagi::Options::Loader::Snapshot)
 		{
-			return new yagi::Plugin(std::move(decompiler.value()));
+			image = std::make_shared<yagi::MemoryImage>();
+			yagi::captureIdaImage(*image);
 		}
+		else
+		{
+			pages = std::make_shared<yagi::PageCache>(YAGI_PAGE_CACHE_SIZE);
+		}
+
+		// shared with the plugin which invalidate it on database events
+		auto imports = std::make_shared<yagi::IdaImportIndex>();
+		auto segments = std::make_shared<yagi::IdaSegmentIndex>(options.readOnlySegments);
+		auto names = std::make_shared<yagi::IdaNameCache>();
+
+		// built on the main thread, which become the owner of the queue
+		auto queue = std::make_shared<yagi::RequestQueue>();
+
+		// spec files are parsed by a background thread to not block IDA
+		// IDA API is reached through the queue, processed by the plugin
+		auto decompiler = std::make_unique<yagi::DeferredDecompiler>(
+			[queue, ghidraRoot, compilerId, options, image, pages, imports, segments, names]() -> std::unique_ptr<yagi::Decompiler> {
+				// architectures are loaded by the shared service
+				if (options.servicePort != 0)
+				{
+					return build_remote_decompiler(queue, compilerId, options, imports, segments, names);
+				}
+
+				yagi::ghidra::init(ghidraRoot);
+
+				std::unique_ptr<yagi::ResultBlobs> resultBlobs;
+				if (options.persistCache)
+				{
+					resultBlobs = std::make_unique<yagi::IdaResultBlobs>();
+				}
+
+				auto decompiler = build_decompiler(*queue, compilerId, options, image, pages, imports, segments, names, std::move(resultBlobs));
+				if (!decompiler.has_value())
+				{
+					return nullptr;
+				}
+
+				// other instruction sets are built by the decompilation thread on first use
+				// results are only persisted for the main one
+				return std::make_unique<yagi::MultiArchDecompiler>(
+					compilerId,
+					std::move(decompiler.value()),
+					[queue, compilerId](uint64_t ea) {
+						return queue->call([&]() { return compute_function_compiler(compilerId, ea); });
+					},
+					[queue, options, image, pages, imports, segments, names](const yagi::Compiler& compiler) {
+						return build_decompiler(*queue, compiler, options, image, pages, imports, segments, names, nullptr);
+					},
+					std::make_unique<yagi::SyncLogger>(*queue, std::make_unique<yagi::IdaLogger>(options.logLevel))
+				);
+			},
+			std::make_unique<yagi::SyncLogger>(*queue, std::make_unique<yagi::IdaLogger>(options.logLevel))
+		);
+
+		return new yagi::Plugin(queue, std::move(decompiler), compilerId, options, image, pages, imports, segments, names);
 	}
 	catch (yagi::Error& e)
 	{
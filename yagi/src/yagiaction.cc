@@ -2,6 +2,7 @@
 #include "yagiarchitecture.hh"
 #include "typemanager.hh"
 #include "base.hh"
+#include "profile.hh"
 
 namespace yagi 
 {
@@ -11,15 +12,22 @@ namespace yagi
 	 */
 	int4 ActionSyncStackVar::apply(Funcdata& data)
 	{
+		ProfileScope scope("yagi", "ActionSyncStackVar");
 		auto arch = static_cast<YagiArchitecture*>(data.getArch());
-		auto funcSym = arch->getSymbolDatabase().find_function(data.getAddress().getOffset());
+		auto context = arch->findContext(data.getAddress().getOffset());
+		if (context == nullptr)
+		{
+			return 0;
+		}
+
+		auto& function = context->getFunction();
 		auto iter = data.getScopeLocal()->begin();
 		while (iter != data.getScopeLocal()->end())
 		{
 			auto sym = *iter;
 			if (sym->getAddr().getSpace()->getName() == "stack")
 			{
-				auto name = funcSym.value()->findStackVar(
+				auto name = function.findStackVar(
 					sym->getAddr().getOffset(), 
 					sym->getAddr().getSpace()->getAddrSize()
 				);
@@ -29,12 +37,12 @@ namespace yagi
 					auto high = data.findHigh(sym->getSymbol()->getName());
 					if (high != nullptr)
 					{
-						arch->getLogger().info("Apply stack name override from frame ", high->getSymbol()->getName(), name.value());
+						arch->getLogger().debug("Apply stack name override from frame ", high->getSymbol()->getName(), name.value());
 						data.getScopeLocal()->renameSymbol(high->getSymbol(), name.value());
 					}
 					else
 					{
-						arch->getLogger().info("Apply stack name override from frame ", sym->getSymbol()->getName(), name.value());
+						arch->getLogger().debug("Apply stack name override from frame ", sym->getSymbol()->getName(), name.value());
 						data.getScopeLocal()->renameSymbol(sym->getSymbol(), name.value());
 					}
 				}
@@ -44,36 +52,62 @@ namespace yagi
 		return 0;
 	}
 
+	/**********************************************************************/
+	/*!
+	 * \brief	Space where a stored override is declared
+	 *			const space is used for stack variables
+	 */
+	static AddrSpace* _LocalSpace(YagiArchitecture* arch, const std::string& name)
+	{
+		if (name == "const")
+		{
+			return arch->getSpaceByName("stack");
+		}
+		return arch->getSpaceByName(name);
+	}
+
 	/**********************************************************************/
 	/*!
 	 *	\brief	apply data sync with netnode for registry
 	 */
 	int4 ActionRenameVar::apply(Funcdata& data)
 	{
+		ProfileScope scope("yagi", "ActionRenameVar");
 		auto arch = static_cast<YagiArchitecture*>(data.getArch());
-		auto funcSym = arch->getSymbolDatabase().find_function(data.getAddress().getOffset());
+		auto context = arch->findContext(data.getAddress().getOffset());
+		if (context == nullptr)
+		{
+			return 0;
+		}
+
+		auto& overrides = context->getOverrides();
+		if (overrides.names.empty())
+		{
+			return 0;
+		}
 
 		auto iter = data.beginOpAll();
 		while (iter != data.endOpAll())
 		{
 			auto op = iter->second;
 
-			uint64_t offset;
-			auto newName = funcSym.value()->findName(op->getAddr().getOffset(), m_space, offset);
-
-			auto space = m_space;
-			if (space == "const")
+			auto range = overrides.names.equal_range(op->getAddr().getOffset());
+			for (auto entry = range.first; entry != range.second; entry++)
 			{
-				space = "stack";
-			}
-
-			auto symEntry = data.getScopeLocal()->findAddr(Address(arch->getSpaceByName(space), offset), op->getAddr());
+				auto& newName = entry->second;
+				auto space = _LocalSpace(arch, newName.space);
+				if (space == nullptr)
+				{
+					continue;
+				}
 
-			if (newName.has_value() && symEntry != nullptr)
-			{
-				auto sym = symEntry->getSymbol();
-				data.getScopeLocal()->renameSymbol(sym,  newName.value());
-				data.getScopeLocal()->setAttribute(sym, Varnode::namelock);
+				auto symEntry = data.getScopeLocal()->findAddr(Address(space, newName.offset), op->getAddr());
+				if (symEntry != nullptr)
+				{
+					auto sym = symEntry->getSymbol();
+					data.getScopeLocal()->renameSymbol(sym, newName.name);
+					data.getScopeLocal()->setAttribute(sym, Varnode::namelock);
+				}
 			}
 			iter++;
 		}
@@ -83,47 +117,55 @@ namespace yagi
 	/**********************************************************************/
 	int4 ActionLoadLocalScope::apply(Funcdata& data)
 	{
+		ProfileScope scope("yagi", "ActionLoadLocalScope");
 		auto arch = static_cast<YagiArchitecture*>(data.getArch());
-		auto funcSym = arch->getSymbolDatabase().find_function(data.getAddress().getOffset());
+		auto context = arch->findContext(data.getAddress().getOffset());
+		if (context == nullptr)
+		{
+			return 0;
+		}
+
+		auto& overrides = context->getOverrides();
+		if (overrides.types.empty())
+		{
+			return 0;
+		}
 
 		auto iter = data.beginOpAll();
 		while (iter != data.endOpAll())
 		{
 			auto op = iter->second;
 
-			uint64_t offset;
-			auto newType = funcSym.value()->findType(op->getAddr().getOffset(), m_space, offset);
-
-			auto space = m_space;
-			if (space == "const")
+			auto range = overrides.types.equal_range(op->getAddr().getOffset());
+			for (auto entry = range.first; entry != range.second; entry++)
 			{
-				space = "stack";
-			}
-			
-			auto opAddr = op->getAddr();
+				auto& newType = entry->second;
+				auto space = _LocalSpace(arch, newType.space);
+				if (space == nullptr)
+				{
+					continue;
+				}
 
-			// for stack based symbol
-			// we didn't specify any usepoint
-			if (space == "stack")
-			{
-				opAddr = Address();
-			}
+				auto opAddr = op->getAddr();
 
-			auto symEntry = data.getScopeLocal()->findAddr(Address(arch->getSpaceByName(space), offset), opAddr);
+				// for stack based symbol
+				// we didn't specify any usepoint
+				if (space->getName() == "stack")
+				{
+					opAddr = Address();
+				}
 
-			if (newType.has_value() && data.getScopeLocal()->findAddr(Address(arch->getSpaceByName(space), offset), opAddr) == nullptr)
-			{
+				auto symEntry = data.getScopeLocal()->findAddr(Address(space, newType.offset), opAddr);
 				if (symEntry == nullptr)
 				{
 					auto sym = data.getScopeLocal()->addSymbol(
 						"",
-						static_cast<TypeManager*>(arch->types)->findByTypeInfo(*(newType.value())),
-						Address(arch->getSpaceByName(space), offset),
+						static_cast<TypeManager*>(arch->types)->findByTypeInfo(*(newType.type)),
+						Address(space, newType.offset),
 						opAddr
 					)->getSymbol();
 
 					data.getScopeLocal()->setAttribute(sym, Varnode::typelock);
-					//sym->setIsolated(true);
 				}
 			}
 			iter++;
@@ -134,6 +176,7 @@ namespace yagi
 	/**********************************************************************/
 	int4 ActionMIPST9Optimization::apply(Funcdata& data)
 	{
+		ProfileScope scope("yagi", "ActionMIPST9Optimization");
 		auto arch = static_cast<YagiArchitecture*>(data.getArch());
 		auto funcAddr = data.getAddress();
 		auto addrSize = data.getArch()->getDefaultCodeSpace()->getAddrSize();
@@ -158,4 +201,72 @@ namespace yagi
 		data.warningHeader("Yagi : setting t9 register value with address of the current function");
 		return 0;
 	}
+
+	/**********************************************************************/
+	void ActionStage::reset(Funcdata& data)
+	{
+		Action::reset(data);
+		m_stage.reset(data);
+	}
+
+	/**********************************************************************/
+	int4 ActionStage::apply(Funcdata& data)
+	{
+		static_cast<YagiArchitecture*>(data.getArch())->checkCanceled();
+
+		auto start = std::chrono::steady_clock::now();
+		auto res = m_stage.perform(data);
+		m_elapsed += std::chrono::steady_clock::now() - start;
+		m_calls++;
+
+		if (res < 0)
+		{
+			return res;
+		}
+		count += res;
+		return 0;
+	}
+
+	/**********************************************************************/
+	size_t ActionStage::getCalls() const noexcept
+	{
+		return m_calls;
+	}
+
+	/**********************************************************************/
+	double ActionStage::getMilliseconds() const noexcept
+	{
+		return std::chrono::duration<double, std::milli>(m_elapsed).count();
+	}
+
+	/**********************************************************************/
+	void ActionStage::resetTimings() noexcept
+	{
+		m_calls = 0;
+		m_elapsed = std::chrono::steady_clock::duration::zero();
+	}
+
+	/**********************************************************************/
+	int4 ActionMark::apply(Funcdata& data)
+	{
+		if (auto profile = Profile::current())
+		{
+			profile->mark(m_next);
+		}
+		return 0;
+	}
+
+	/**********************************************************************/
+	int4 ActionCheckLimits::apply(Funcdata& data)
+	{
+		static_cast<YagiArchitecture*>(data.getArch())->checkLimits(data);
+		return 0;
+	}
+
+	/**********************************************************************/
+	int4 ActionCountPass::apply(Funcdata& data)
+	{
+		static_cast<YagiArchitecture*>(data.getArch())->countPass();
+		return 0;
+	}
 } // end of namespace yagi
\ No newline at end of file
@@ -4,9 +4,53 @@
 #include "scope.hh"
 #include "typemanager.hh"
 #include "coreaction.hh"
+#include "exception.hh"
+#include "profile.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
 
 namespace yagi 
 {
+	const char* const YagiArchitecture::LARGE_ACTION = "yagi-large";
+	const char* const YagiArchitecture::FALLBACK_ACTION = "yagi-fallback";
+
+	/*!
+	 * \brief	Number of translated instructions kept between decompilations
+	 */
+	static const size_t LIFT_CACHE_SIZE = 0x40000;
+
+	/*!
+	 * \brief	Rule groups skipped in large function mode
+	 *			Their rules are the slowest ones on big functions
+	 *			and only improve the readability of the output
+	 */
+	static const char* const LARGE_FUNCTION_SKIPPED_GROUPS[] = {
+		"conditionalexe",
+		"constsequence",
+		"doubleload",
+		"doubleprecis",
+		"floatprecision",
+		"nodejoin",
+		"splitcopy",
+		"splitpointer",
+		"subvar"
+	};
+
+	/*!
+	 * \brief	Rule groups also skipped by the fallback analysis
+	 *			merge, blockrecovery and casts are kept to print the function
+	 */
+	static const char* const FALLBACK_SKIPPED_GROUPS[] = {
+		"analysis",
+		"deindirect",
+		"returnsplit",
+		"segment",
+		"typerecovery"
+	};
+
 	/**********************************************************************/
 	YagiArchitecture::YagiArchitecture(
 		const std::string& name,
@@ -17,6 +61,8 @@ namespace yagi
 		std::unique_ptr<TypeInfoFactory> type,
 		std::string defaultCC
 	) : SleighArchitecture(name, sleighId, &m_err),
+		m_lifts{ LIFT_CACHE_SIZE },
+		m_sleighId{ sleighId },
 		m_loaderFactory{ std::move(loaderFactory)},
 		m_logger{ std::move(logger) }, 
 		m_symbols{ std::move(symbols) }, 
@@ -28,19 +74,111 @@ namespace yagi
 	{
 	}
 
+	/**********************************************************************/
+	static double _Milliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Paths of the processor, compiler and sla files of a language
+	 *			Same lookup as SleighArchitecture::buildSpecFile
+	 * \param	sleighId	language id followed by the compiler id
+	 */
+	static std::vector<std::string> _FindSpecFiles(const std::string& sleighId)
+	{
+		auto separator = sleighId.rfind(':');
+		auto languageId = sleighId.substr(0, separator);
+		auto compilerId = sleighId.substr(separator + 1);
+
+		auto& descriptions = SleighArchitecture::getDescriptions();
+		auto language = std::find_if(descriptions.begin(), descriptions.end(), [&languageId](const LanguageDescription& description) {
+			return description.getId() == languageId;
+		});
+		if (language == descriptions.end())
+		{
+			throw LowlevelError("No sleigh specification for " + languageId);
+		}
+
+		std::vector<std::string> result(3);
+		SleighArchitecture::specpaths.findFile(result[0], language->getProcessorSpec());
+		SleighArchitecture::specpaths.findFile(result[1], language->getCompiler(compilerId).getSpec());
+		SleighArchitecture::specpaths.findFile(result[2], language->getSlaFile());
+		return result;
+	}
+
 	/**********************************************************************/
 	void YagiArchitecture::buildLoader(DocumentStorage& store)
 	{
+		auto start = std::chrono::steady_clock::now();
 		std::stringstream error;
 		collectSpecFiles(error);
 		if (error.str().length() > 0) {
 			m_logger->error("spec files loading", error.str());
 		}
-		loader = m_loaderFactory->build();
+		auto files = _FindSpecFiles(m_sleighId);
+		m_startup.specFiles = _Milliseconds(start);
+
+		// spec files only depend on the language, the store is not touched
+		// by init until buildSpecFile waits for the parse
+		m_specParse = std::async(std::launch::async, [&store, files]() {
+			// the XML parser of Ghidra keeps its state into globals
+			static std::mutex parseMutex;
+			std::lock_guard<std::mutex> lock(parseMutex);
+
+			auto start = std::chrono::steady_clock::now();
+			for (auto& file : files)
+			{
+				try
+				{
+					store.registerTag(store.openDocument(file)->getRoot());
+				}
+				catch (LowlevelError& e)
+				{
+					throw LowlevelError("Error reading spec file " + file + "\n " + e.explain);
+				}
+			}
+			return _Milliseconds(start);
+		});
+
+		try
+		{
+			start = std::chrono::steady_clock::now();
+			loader = m_loaderFactory->build();
+			m_startup.loader = _Milliseconds(start);
+
+			start = std::chrono::steady_clock::now();
+			setupCoreTypes();
+			m_startup.types = _Milliseconds(start);
+		}
+		catch (...)
+		{
+			// the store may be released by the caller
+			m_specParse.wait();
+			throw;
+		}
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::buildSpecFile(DocumentStorage& store)
+	{
+		auto start = std::chrono::steady_clock::now();
+		m_startup.specParse = m_specParse.get();
+		m_startup.specWait = _Milliseconds(start);
 	}
 
 	/**********************************************************************/
 	void YagiArchitecture::buildTypegrp(DocumentStorage& store)
+	{
+		if (types == nullptr)
+		{
+			setupCoreTypes();
+		}
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::setupCoreTypes()
 	{
 		types = new TypeManager(this);
 		types->setCoreType("void", 1, TYPE_VOID, false);
@@ -77,58 +215,379 @@ namespace yagi
 	/**********************************************************************/
 	Translate* YagiArchitecture::buildTranslator(DocumentStorage& store)
 	{
-		m_translate = SleighArchitecture::buildTranslator(store);
-		return m_translate;
+		// never registered into the shared translators of SleighArchitecture
+		// so the sla file is always loaded into the store by buildSpecFile
+		m_translate = std::make_unique<CachedSleigh>(loader, context, m_lifts);
+		return m_translate.get();
 	}
 
 	/**********************************************************************/
 	void YagiArchitecture::buildAction(DocumentStorage& store)
 	{
+		auto start = std::chrono::steady_clock::now();
 		SleighArchitecture::buildAction(store);
 		// by default we will map name use in the frame view
 		m_renameAction.addAction(new ActionSyncStackVar("yagi"));
 
-		m_renameAction.addAction(new ActionRenameVar("yagi", "register"));
-		m_renameAction.addAction(new ActionRenameVar("yagi", "stack"));
-		m_renameAction.addAction(new ActionRenameVar("yagi", "unique"));
-		m_renameAction.addAction(new ActionRenameVar("yagi", "const"));
+		// user names and types of all spaces are applied in a single pass
+		m_renameAction.addAction(new ActionRenameVar("yagi"));
+		m_retypeAction.addAction(new ActionLoadLocalScope("yagi"));
+		m_archSpecific.addAction(new ActionCheckLimits("yagi"));
+
+		// large function mode is derived before stages are inserted
+		auto current = allacts.getCurrentName();
+		allacts.cloneGroup(current, LARGE_ACTION);
+		for (auto group : LARGE_FUNCTION_SKIPPED_GROUPS)
+		{
+			allacts.removeFromGroup(LARGE_ACTION, group);
+		}
+
+		allacts.cloneGroup(LARGE_ACTION, FALLBACK_ACTION);
+		for (auto group : FALLBACK_SKIPPED_GROUPS)
+		{
+			allacts.removeFromGroup(FALLBACK_ACTION, group);
+		}
+
+		insertStages();
+		insertMarks();
+
+		allacts.setCurrent(LARGE_ACTION);
+		insertPassCounter();
+		insertStages();
+		insertMarks();
+
+		// user types and arch specific actions are kept by the fallback
+		// limits are not checked there, see checkLimits
+		allacts.setCurrent(FALLBACK_ACTION);
+		insertStages();
+		insertMarks();
+		allacts.setCurrent(current);
+		m_startup.actions = _Milliseconds(start);
+	}
+
+	/**********************************************************************/
+	/*!
+	 * \brief	Access to the actions of a group
+	 *			Ghidra has no API to insert an action into a built group
+	 */
+	struct ActionGroupAccess : public ActionGroup
+	{
+		static std::vector<Action*>& actions(ActionGroup& group)
+		{
+			return group.*(&ActionGroupAccess::list);
+		}
+	};
+
+	/**********************************************************************/
+	void YagiArchitecture::insertStages()
+	{
+		auto root = dynamic_cast<ActionGroup*>(allacts.getCurrent());
+		if (root == nullptr)
+		{
+			throw LowlevelError("Unexpected universal action");
+		}
+
+		// same point as the former break on constbase, just after the CFG is built
+		auto& actions = ActionGroupAccess::actions(*root);
+		auto pos = std::find_if(actions.begin(), actions.end(), [](Action* action) {
+			return action->getName() == "constbase";
+		});
+		if (pos == actions.end())
+		{
+			throw LowlevelError("Unable to find the constbase action");
+		}
+
+		auto archSpecific = new ActionStage("archspecific", m_archSpecific, "yagi");
+		auto retype = new ActionStage("retype", m_retypeAction, "yagi");
+		auto rename = new ActionStage("rename", m_renameAction, "yagi");
+
+		pos = actions.insert(pos, retype);
+		actions.insert(pos, archSpecific);
+		actions.push_back(rename);
+
+		m_stages.insert(m_stages.end(), { archSpecific, retype, rename });
+	}
+
+	/**********************************************************************/
+	static ActionGroup* _FindGroup(ActionGroup& root, const std::string& name)
+	{
+		for (auto action : ActionGroupAccess::actions(root))
+		{
+			auto group = dynamic_cast<ActionGroup*>(action);
+			if (group == nullptr)
+			{
+				continue;
+			}
+
+			if (group->getName() == name)
+			{
+				return group;
+			}
+
+			if (auto found = _FindGroup(*group, name))
+			{
+				return found;
+			}
+		}
+		return nullptr;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::insertPassCounter()
+	{
+		auto root = dynamic_cast<ActionGroup*>(allacts.getCurrent());
+		auto mainloop = root == nullptr ? nullptr : _FindGroup(*root, "mainloop");
+		if (mainloop == nullptr)
+		{
+			throw LowlevelError("Unable to find the mainloop action");
+		}
 
-		m_retypeAction.addAction(new ActionLoadLocalScope("yagi", "register"));
-		m_retypeAction.addAction(new ActionLoadLocalScope("yagi", "stack"));
-		m_retypeAction.addAction(new ActionLoadLocalScope("yagi", "unique"));
-		m_retypeAction.addAction(new ActionLoadLocalScope("yagi", "const"));
+		auto& actions = ActionGroupAccess::actions(*mainloop);
+		actions.insert(actions.begin(), new ActionCountPass("yagi"));
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::insertMarks()
+	{
+		auto& actions = ActionGroupAccess::actions(*static_cast<ActionGroup*>(allacts.getCurrent()));
+		std::vector<Action*> marked;
+		marked.reserve(actions.size() * 2);
+		for (auto action : actions)
+		{
+			marked.push_back(new ActionMark(action->getName(), "yagi"));
+			marked.push_back(action);
+		}
+		actions.swap(marked);
 	}
 
 	/**********************************************************************/
 	int4 YagiArchitecture::performActions(Funcdata& data)
 	{
-		allacts.getCurrent()->reset(data);
-		m_archSpecific.reset(data);
+		// Yagi groups are reset and performed as stages (see insertStages)
+		auto root = allacts.getCurrent();
+		root->reset(data);
+		checkCanceled();
+
+		auto profile = Profile::current();
+		if (profile == nullptr)
+		{
+			return root->perform(data);
+		}
+
+		// counters of rules are only known by Ghidra
+		root->resetStats();
+		auto res = root->perform(data);
+		profile->unmark();
+
+		std::stringstream statistics;
+		root->printStatistics(statistics);
+		profile->addStatistics(statistics);
+
+		// sizes of the function, to compare with its timings
+		profile->setCounter(Profile::OPS, static_cast<uint64_t>(std::distance(data.beginOpAll(), data.endOpAll())));
+		profile->setCounter(Profile::VARNODES, static_cast<uint64_t>(data.numVarnodes()));
+		profile->setCounter(Profile::BLOCKS, static_cast<uint64_t>(data.getBasicBlocks().getSize()));
+		return res;
+	}
+
+	/**********************************************************************/
+	const YagiArchitecture::StartupTimings& YagiArchitecture::getStartupTimings() const noexcept
+	{
+		return m_startup;
+	}
+
+	/**********************************************************************/
+	std::vector<YagiArchitecture::StageTiming> YagiArchitecture::getStageTimings() const
+	{
+		// stages of all universal actions are merged by name
+		std::vector<StageTiming> result;
+		result.reserve(m_stages.size());
+		for (auto stage : m_stages)
+		{
+			auto timing = std::find_if(result.begin(), result.end(), [stage](const StageTiming& timing) {
+				return timing.name == stage->getName();
+			});
+			if (timing == result.end())
+			{
+				result.push_back({ stage->getName(), stage->getCalls(), stage->getMilliseconds() });
+				continue;
+			}
+			timing->calls += stage->getCalls();
+			timing->milliseconds += stage->getMilliseconds();
+		}
+		return result;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::resetStageTimings()
+	{
+		for (auto stage : m_stages)
+		{
+			stage->resetTimings();
+		}
+	}
+
+	/**********************************************************************/
+	int4 YagiArchitecture::performRenameActions(Funcdata& data)
+	{
 		m_renameAction.reset(data);
-		m_retypeAction.reset(data);
+		return m_renameAction.perform(data);
+	}
+
+	/**********************************************************************/
+	int4 YagiArchitecture::performFallbackActions(Funcdata& data)
+	{
+		// budget already exceeded, only a cancel can stop us now
+		m_fallback = true;
+
+		auto current = allacts.getCurrentName();
+		allacts.setCurrent(FALLBACK_ACTION);
+		int4 res = 0;
+		try
+		{
+			allacts.getCurrent()->reset(data);
+			res = allacts.getCurrent()->perform(data);
+		}
+		catch (...)
+		{
+			allacts.setCurrent(current);
+			throw;
+		}
+		allacts.setCurrent(current);
+		return res;
+	}
+
+	/**********************************************************************/
+	int4 YagiArchitecture::performLargeActions(Funcdata& data)
+	{
+		auto current = allacts.getCurrentName();
+		allacts.setCurrent(LARGE_ACTION);
+		m_large = true;
+		m_passes = 0;
+
+		int4 res = 0;
+		try
+		{
+			res = performActions(data);
+		}
+		catch (...)
+		{
+			m_large = false;
+			allacts.setCurrent(current);
+			throw;
+		}
+		m_large = false;
+		allacts.setCurrent(current);
+		return res;
+	}
 
+	/**********************************************************************/
+	void YagiArchitecture::setLargeFunctionLimits(const LargeFunctionLimits& limits) noexcept
+	{
+		m_largeLimits = limits;
+	}
+
+	/**********************************************************************/
+	bool YagiArchitecture::isLargeFunction(uint64_t size) const noexcept
+	{
+		return m_largeLimits.size != 0 && size > m_largeLimits.size;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::checkLimits(const Funcdata& data) const
+	{
+		if (m_large || m_fallback || m_largeLimits.ops == 0)
+		{
+			return;
+		}
 
-		// Break just after start action
-		// to have the CFG built
-		allacts.getCurrent()->setBreakPoint(Action::break_start, "constbase");
+		auto ops = static_cast<size_t>(std::distance(data.beginOpAll(), data.endOpAll()));
+		if (ops > m_largeLimits.ops)
+		{
+			throw LargeFunction(ops);
+		}
+	}
 
-		auto res = allacts.getCurrent()->perform(data);
+	/**********************************************************************/
+	void YagiArchitecture::countPass()
+	{
+		if (!m_large || m_largeLimits.passes == 0)
+		{
+			return;
+		}
 
-		// perform Arch specific action
-		m_archSpecific.perform(data);
+		if (++m_passes > m_largeLimits.passes)
+		{
+			throw AnalysisLimitExceeded();
+		}
+	}
 
-		// provisionning of type action
-		m_retypeAction.perform(data);
+	/**********************************************************************/
+	void YagiArchitecture::setFlowSeeding(bool enabled) noexcept
+	{
+		m_seedFlow = enabled;
+	}
 
-		allacts.getCurrent()->clearBreakPoints();
-		res = allacts.getCurrent()->perform(data);
+	/**********************************************************************/
+	static bool _IsInChunks(const FlowHints& hints, uint64_t ea)
+	{
+		return std::any_of(hints.chunks.begin(), hints.chunks.end(), [ea](const auto& chunk) {
+			return ea >= chunk.first && ea < chunk.second;
+		});
+	}
 
-		if (res < 0)
+	/**********************************************************************/
+	size_t YagiArchitecture::seedFlow(Funcdata& data)
+	{
+		if (!m_seedFlow || m_context == nullptr)
 		{
-			return res;
+			return 0;
 		}
 
-		return res + m_renameAction.perform(data);
+		auto hints = m_context->getFunction().findFlowHints();
+		auto space = getDefaultCodeSpace();
+		size_t installed = 0;
+		for (auto& [ea, cases] : hints.jumpTables)
+		{
+			// a target outside of the function is not a confident answer
+			if (cases.empty() || !_IsInChunks(hints, ea) || !std::all_of(cases.begin(), cases.end(), [&hints](const auto& entry) { return _IsInChunks(hints, entry.second); }))
+			{
+				continue;
+			}
+
+			// the override is indexed from the first case value without holes
+			auto first = cases.begin()->first;
+			if (cases.rbegin()->first - first != static_cast<int64_t>(cases.size() - 1))
+			{
+				continue;
+			}
+
+			std::vector<Address> addresses;
+			for (auto& [value, target] : cases)
+			{
+				addresses.emplace_back(space, target);
+			}
+
+			// overrides are kept when the function is cleared
+			Address addr(space, ea);
+			JumpTable* table = nullptr;
+			for (int4 i = 0; i < data.numJumpTables(); i++)
+			{
+				if (data.getJumpTable(i)->getOpAddress() == addr)
+				{
+					table = data.getJumpTable(i);
+					break;
+				}
+			}
+
+			if (table == nullptr)
+			{
+				table = data.installJumpTable(addr);
+			}
+			table->setOverride(addresses, Address(), 0, static_cast<uintb>(first));
+			installed++;
+		}
+		return installed;
 	}
 
 	/**********************************************************************/
@@ -143,6 +602,132 @@ namespace yagi
 		return *m_symbols.get();
 	}
 
+	/**********************************************************************/
+	const SymbolRecord* YagiArchitecture::findSymbol(uint64_t ea)
+	{
+		auto iter = m_symbolCache.find(ea);
+		if (iter == m_symbolCache.end())
+		{
+			// misses go to the backend, which may be the slow part
+			checkCanceled();
+			iter = m_symbolCache.emplace(ea, m_symbols->find_record(ea)).first;
+		}
+		return iter->second.has_value() ? &iter->second.value() : nullptr;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::clearSymbolCache()
+	{
+		m_symbolCache.clear();
+		m_injectionCache.clear();
+		m_callWrapperIndex.reset();
+		m_context.reset();
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::invalidateSymbol(uint64_t ea)
+	{
+		m_symbolCache.erase(ea);
+		m_injectionCache.erase(ea);
+		m_callWrapperIndex.reset();
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::invalidateCode(uint64_t ea)
+	{
+		m_lifts.invalidate(ea);
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::clearLiftCache()
+	{
+		m_lifts.clear();
+	}
+
+	/**********************************************************************/
+	DecompileContext& YagiArchitecture::setContext(std::unique_ptr<FunctionSymbolInfo> function)
+	{
+		m_context = std::make_unique<DecompileContext>(std::move(function));
+		return *m_context;
+	}
+
+	/**********************************************************************/
+	DecompileContext* YagiArchitecture::findContext(uint64_t ea)
+	{
+		if (m_context != nullptr && m_context->getAddress() == ea)
+		{
+			return m_context.get();
+		}
+
+		auto function = m_symbols->find_function(ea);
+		if (!function.has_value())
+		{
+			return nullptr;
+		}
+		return &setContext(std::move(function.value()));
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::addDependency(uint64_t ea)
+	{
+		if (m_context != nullptr)
+		{
+			m_context->addDependency(ea);
+		}
+	}
+
+	/**********************************************************************/
+	bool YagiArchitecture::addDependency(const std::string& type)
+	{
+		return m_context != nullptr && m_context->addDependency(type);
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::setCancelToken(std::shared_ptr<const CancelToken> token)
+	{
+		m_cancel = std::move(token);
+		m_fallback = false;
+		m_deadline = true;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::checkCanceled() const
+	{
+		if (m_cancel == nullptr)
+		{
+			return;
+		}
+
+		if (m_fallback || !m_deadline)
+		{
+			if (m_cancel->isCanceled())
+			{
+				throw DecompilationCanceled();
+			}
+			return;
+		}
+
+		m_cancel->check();
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::setDeadline(bool enabled) noexcept
+	{
+		m_deadline = enabled;
+
+		// a new analysis is not a fallback analysis
+		if (enabled)
+		{
+			m_fallback = false;
+		}
+	}
+
+	/**********************************************************************/
+	bool YagiArchitecture::isCanceled() const noexcept
+	{
+		return m_cancel != nullptr && m_cancel->isCanceled();
+	}
+
 	/**********************************************************************/
 	TypeInfoFactory& YagiArchitecture::getTypeInfoFactory() const
 	{
@@ -168,14 +753,74 @@ namespace yagi
 	}
 
 	/**********************************************************************/
-	std::optional<std::string> YagiArchitecture::findInjection(const std::string& functionName)
+	std::optional<int4> YagiArchitecture::findInjection(uint64_t ea, const std::string& functionName)
 	{
-		auto iter = m_injectionMap.find(functionName);
-		if (iter == m_injectionMap.end())
+		auto cached = m_injectionCache.find(ea);
+		if (cached == m_injectionCache.end())
+		{
+			int4 id = -1;
+			auto iter = m_injectionMap.find(functionName);
+			if (iter != m_injectionMap.end())
+			{
+				// injections are declared before the payloads are loaded
+				id = pcodeinjectlib->getPayloadId(InjectPayload::CALLFIXUP_TYPE, iter->second);
+				if (id < 0)
+				{
+					getLogger().error("Unknown call fixup ", iter->second);
+				}
+			}
+			cached = m_injectionCache.emplace(ea, id).first;
+		}
+
+		if (cached->second < 0)
 		{
 			return nullopt;
 		}
-		return iter->second;
+		return cached->second;
+	}
+
+	/**********************************************************************/
+	void YagiArchitecture::addCallWrapper(CallWrapper wrapper)
+	{
+		m_callWrappers.push_back(std::move(wrapper));
+		m_callWrapperIndex.reset();
+	}
+
+	/**********************************************************************/
+	const CallWrapper* YagiArchitecture::findCallWrapper(uint64_t ea)
+	{
+		if (m_callWrappers.empty())
+		{
+			return nullptr;
+		}
+
+		if (!m_callWrapperIndex.has_value())
+		{
+			// a single backend request for all wrappers
+			std::vector<std::string> names;
+			for (auto& wrapper : m_callWrappers)
+			{
+				names.push_back(wrapper.name);
+			}
+			auto addresses = m_symbols->find_addresses(names);
+
+			m_callWrapperIndex.emplace();
+			for (size_t i = 0; i < m_callWrappers.size(); i++)
+			{
+				auto address = addresses.find(m_callWrappers[i].name);
+				if (address != addresses.end())
+				{
+					m_callWrapperIndex.value().emplace(address->second, i);
+				}
+			}
+		}
+
+		auto index = m_callWrapperIndex.value().find(ea);
+		if (index == m_callWrapperIndex.value().end())
+		{
+			return nullptr;
+		}
+		return &m_callWrappers[index->second];
 	}
 
 } // end of namespace yagi
\ No newline at end of file
@@ -2,37 +2,41 @@
 #include "yagiarchitecture.hh"
 #include "typemanager.hh"
 #include "base.hh"
+#include "profile.hh"
 
 namespace yagi 
 {
 	/**********************************************************************/
-	void RuleWindowsControlFlowGuard::getOpList(vector<uint4>& oplist) const
+	void RuleCallWrapper::getOpList(vector<uint4>& oplist) const
 	{
 		oplist.push_back(CPUI_CALLIND);
 	}
 
 	/**********************************************************************/
-	int4 RuleWindowsControlFlowGuard::applyOp(PcodeOp* op, Funcdata& data)
+	int4 RuleCallWrapper::applyOp(PcodeOp* op, Funcdata& data)
 	{
-		auto addrSize = data.getArch()->getDefaultCodeSpace()->getAddrSize();
+		ProfileScope scope("yagi", "RuleCallWrapper");
+		auto arch = static_cast<YagiArchitecture*>(data.getArch());
+		auto target = op->getIn(0);
 
-		auto sym = data.getArch()->symboltab->getGlobalScope()->findContainer(op->getIn(0)->getAddr(), addrSize, op->getAddr());
-		
-		// If the indirect call match the symbol name of the wrapped function
-		// We replace the input varnode from const space (with the associated symbol)
-		// with a register namespace
-		if (sym != nullptr && sym->getSymbol() != nullptr && sym->getSymbol()->getName() == m_cfgWrapperName)
+		// the called address, a pointer for an indirect call
+		if (target->getSpace() != arch->getDefaultCodeSpace())
 		{
-			auto raxAddr = data.getArch()->getDefaultCodeSpace()->getTrans()->getRegister("RAX").getAddr();
-			auto raxVn = data.newVarnode(
-				addrSize,
-				raxAddr
-			);
-			// Rewrite input with rax
-			data.opSetInput(op, raxVn, 0);
-			data.warningHeader("Yagi : Control Flow Guard patching");
+			return 0;
 		}
 
+		auto wrapper = arch->findCallWrapper(target->getOffset());
+		if (wrapper == nullptr)
+		{
+			return 0;
+		}
+
+		// We replace the input varnode from const space (with the associated symbol)
+		// with the register holding the real target
+		auto& reg = arch->translate->getRegister(wrapper->reg);
+		auto regVn = data.newVarnode(reg.size, reg.getAddr());
+		data.opSetInput(op, regVn, 0);
+		data.warningHeader("Yagi : Control Flow Guard patching");
 		return 0;
 	}
 